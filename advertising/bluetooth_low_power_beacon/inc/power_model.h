@@ -0,0 +1,110 @@
+/***************************************************************************//**
+ * @file power_model.h
+ * @brief Energy model and profile solver for the low-power beacon.
+ * @version 1.0.0
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#ifndef POWER_MODEL_H_
+#define POWER_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* The model has no stack dependencies, so it can be built and run on a PC to
+ * evaluate battery life figures before flashing. */
+
+/* Energy model of one advertising event, EFR32BG22 at 3 V. Calibrate these
+ * figures with the Energy Profiler for other parts or boards. */
+#define POWER_MODEL_SLEEP_CURRENT_NA      1400  /* EM2 with RTC running */
+#define POWER_MODEL_WAKEUP_CHARGE_NC      2500  /* Wake-up, HF clock startup and stack processing */
+#define POWER_MODEL_CHANNEL_SWITCH_NC     150   /* Synthesizer settling per channel */
+#define POWER_MODEL_RAMP_US               140   /* PA ramp and TX setup per packet */
+#define POWER_MODEL_PDU_OVERHEAD_BYTES    16    /* Preamble, access address, header, AdvA, CRC */
+#define POWER_MODEL_RX_CURRENT_UA         3600
+#define POWER_MODEL_RX_WINDOW_US          200   /* Listening for requests after a connectable PDU */
+
+/* Share of the nominal battery capacity the budget is computed from. */
+#define POWER_MODEL_BATTERY_DERATING_PERCENT  80
+
+/* Advertising channel map bits */
+#define POWER_MODEL_CHANNEL_37            0x01
+#define POWER_MODEL_CHANNEL_38            0x02
+#define POWER_MODEL_CHANNEL_39            0x04
+
+/* Advertising configuration computed for a profile */
+typedef struct {
+  uint16_t interval_ms;
+  uint8_t channel_map;
+  int16_t tx_power;          /* 0.1 dBm */
+  uint8_t payload_len;
+  bool connectable;
+} power_model_adv_config_t;
+
+/* Advertising profile. Fixed profiles use their fastest, strongest settings
+ * regardless of the budget; the others are solved from the budget. */
+typedef struct {
+  const char *name;
+  uint16_t min_interval_ms;
+  uint16_t max_interval_ms;
+  int16_t max_tx_power;      /* 0.1 dBm */
+  uint16_t duration_s;       /* 0: until another profile is selected */
+  bool connectable;
+  bool fixed;
+} power_model_profile_t;
+
+/* Set the battery capacity and the battery life to be reached. Fixed
+ * profiles with a duration are accounted for with the expected number of
+ * activations per day. */
+void power_model_set_budget(uint32_t battery_mah,
+                            uint32_t target_days,
+                            const power_model_profile_t *burst_profile,
+                            uint16_t bursts_per_day);
+
+/* Average current the remaining profiles may draw, in nA */
+uint32_t power_model_get_budget_na(void);
+
+/* Charge drawn by one advertising event, in nC */
+uint32_t power_model_event_charge_nc(const power_model_adv_config_t *config);
+
+/* Estimated average current of an advertising configuration, in nA */
+uint32_t power_model_average_current_na(const power_model_adv_config_t *config);
+
+/* Compute the advertising configuration of a profile. Returns false if even
+ * the most economical configuration exceeds the budget; the most economical
+ * configuration is returned in that case. */
+bool power_model_solve(const power_model_profile_t *profile,
+                       uint8_t payload_len,
+                       power_model_adv_config_t *config);
+
+#endif
@@ -46,9 +46,43 @@
 
 #include "app.h"
 
+#include "em_gpio.h"
+#include "gpiointerrupt.h"
+#include "hal-config.h"
+#include "power_model.h"
+
+/* Battery the deep idle profile is sized for: CR2032, 3 years */
+#define BATTERY_CAPACITY_MAH      220
+#define TARGET_BATTERY_LIFE_DAYS  1095
+/* Expected number of button presses per day */
+#define FAST_BURSTS_PER_DAY       4
+
+#define BUTTON_SIGNAL             0x1
+#define PROFILE_TIMER_HANDLE      1
+
+enum {
+  PROFILE_FAST_CONNECTABLE,
+  PROFILE_DEEP_IDLE
+};
+
+/* Fast connectable runs for 30 s after a button press at fixed settings.
+ * Deep idle is computed from what is left of the energy budget. */
+static const power_model_profile_t profiles[] = {
+  [PROFILE_FAST_CONNECTABLE] = { "fast connectable", 100, 100, 0, 30, true, true },
+  [PROFILE_DEEP_IDLE] = { "deep idle", 1000, 10240, 0, 0, false, false },
+};
+
+static const uint8_t adv_payload[] = { 3, 9, 'D', 'T' };
+
 /* Print boot message */
 static void bootMessage(struct gecko_msg_system_boot_evt_t *bootevt);
 
+/* Compute and apply the advertising settings of a profile */
+static void applyProfile(uint8_t profile_id);
+
+/* Button 0 selects the fast connectable profile */
+static void initButton(void);
+
 /* Flag for indicating DFU Reset must be performed */
 static uint8_t boot_to_dfu = 0;
 
@@ -88,30 +122,36 @@ void appMain(gecko_configuration_t *pconfig)
         bootMessage(&(evt->data.evt_system_boot));
         printLog("boot event - starting advertising\r\n");
 
-        /* Set adv on channel 37 only */
-        gecko_cmd_le_gap_set_advertise_channel_map(0, 1);
-
-        /* Set advertising parameters. 1000ms advertisement interval.
-         * The next two parameters are minimum and maximum advertising interval, both in
-         * units of (milliseconds * 1.6).
-         * The last two parameters are duration and maxevents left as default. */
-        gecko_cmd_le_gap_set_advertise_timing(0, 1600, 1600, 0, 0);
-
-        /* Set tx power to 0dBm */
+        /* Set the global maximum tx power to 0dBm, profiles may go lower */
         gecko_cmd_system_set_tx_power(0);
 
-        /* Set the adv payload to 0 length */
-        //gecko_cmd_le_gap_bt5_set_adv_data(0, 0, 0, NULL);
+        /* Size the energy budget and start in the deep idle profile */
+        power_model_set_budget(BATTERY_CAPACITY_MAH,
+                               TARGET_BATTERY_LIFE_DAYS,
+                               &profiles[PROFILE_FAST_CONNECTABLE],
+                               FAST_BURSTS_PER_DAY);
+        printLog("energy budget: %lu nA\r\n", (unsigned long)power_model_get_budget_na());
+        applyProfile(PROFILE_DEEP_IDLE);
+        initButton();
 
-        uint8_t name[] = { 3, 9, 'D', 'T' };
-        gecko_cmd_le_gap_bt5_set_adv_data(0, 0, 4, name);
+        break;
 
-        /* Start general advertising and enable connections. */
-        //gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
+      case gecko_evt_system_external_signal_id:
 
-        /* Start advertising and disable connections. */
-        gecko_cmd_le_gap_start_advertising(0, le_gap_user_data, le_gap_non_connectable);
+        if (evt->data.evt_system_external_signal.extsignals & BUTTON_SIGNAL) {
+          applyProfile(PROFILE_FAST_CONNECTABLE);
+          /* Fall back to deep idle when the fast profile has run its time */
+          gecko_cmd_hardware_set_soft_timer(32768 * profiles[PROFILE_FAST_CONNECTABLE].duration_s,
+                                            PROFILE_TIMER_HANDLE,
+                                            1);
+        }
+        break;
+
+      case gecko_evt_hardware_soft_timer_id:
 
+        if (evt->data.evt_hardware_soft_timer.handle == PROFILE_TIMER_HANDLE) {
+          applyProfile(PROFILE_DEEP_IDLE);
+        }
         break;
 
       case gecko_evt_le_connection_opened_id:
@@ -129,8 +169,8 @@ void appMain(gecko_configuration_t *pconfig)
           /* Enter to OTA DFU mode */
           gecko_cmd_system_reset(2);
         } else {
-          /* Restart advertising after client has disconnected */
-          gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
+          /* Return to beaconing after client has disconnected */
+          applyProfile(PROFILE_DEEP_IDLE);
         }
         break;
 
@@ -180,3 +220,59 @@ static void bootMessage(struct gecko_msg_system_boot_evt_t *bootevt)
   printLog("%2.2x\r\n", local_addr.addr[0]);
 #endif
 }
+
+static void applyProfile(uint8_t profile_id)
+{
+  power_model_adv_config_t config;
+
+  if (!power_model_solve(&profiles[profile_id], sizeof(adv_payload), &config)) {
+    printLog("profile %s: over budget, using the most economical settings\r\n",
+             profiles[profile_id].name);
+  }
+
+  gecko_cmd_le_gap_stop_advertising(0);
+
+  /* The profile decides on channels, interval and tx power.
+   * Advertising interval is in units of (milliseconds * 1.6). */
+  gecko_cmd_le_gap_set_advertise_channel_map(0, config.channel_map);
+  gecko_cmd_le_gap_set_advertise_timing(0,
+                                        config.interval_ms * 16 / 10,
+                                        config.interval_ms * 16 / 10,
+                                        0,
+                                        0);
+  gecko_cmd_le_gap_set_advertise_tx_power(0, config.tx_power);
+
+  if (config.connectable) {
+    /* Start general advertising and enable connections. */
+    gecko_cmd_le_gap_start_advertising(0, le_gap_general_discoverable, le_gap_connectable_scannable);
+  } else {
+    /* Start advertising the short payload and disable connections. */
+    gecko_cmd_le_gap_bt5_set_adv_data(0, 0, sizeof(adv_payload), adv_payload);
+    gecko_cmd_le_gap_start_advertising(0, le_gap_user_data, le_gap_non_connectable);
+  }
+
+  printLog("profile %s: interval %u ms, channel map 0x%x, tx power %d, estimated %lu nA\r\n",
+           profiles[profile_id].name,
+           config.interval_ms,
+           config.channel_map,
+           config.tx_power,
+           (unsigned long)power_model_average_current_na(&config));
+}
+
+#if defined(BSP_BUTTON0_PORT) && defined(BSP_BUTTON0_PIN)
+static void buttonCallback(uint8_t pin)
+{
+  (void)pin;
+  gecko_external_signal(BUTTON_SIGNAL);
+}
+#endif
+
+static void initButton(void)
+{
+#if defined(BSP_BUTTON0_PORT) && defined(BSP_BUTTON0_PIN)
+  GPIO_PinModeSet(BSP_BUTTON0_PORT, BSP_BUTTON0_PIN, gpioModeInputPullFilter, 1);
+  GPIOINT_Init();
+  GPIOINT_CallbackRegister(BSP_BUTTON0_PIN, buttonCallback);
+  GPIO_ExtIntConfig(BSP_BUTTON0_PORT, BSP_BUTTON0_PIN, BSP_BUTTON0_PIN, false, true, true);
+#endif
+}
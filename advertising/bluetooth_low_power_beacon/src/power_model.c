@@ -0,0 +1,196 @@
+/***************************************************************************//**
+ * @file power_model.c
+ * @brief Energy model and profile solver for the low-power beacon.
+ * @version 1.0.0
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+#include <stddef.h>
+#include "power_model.h"
+
+#define SECONDS_PER_DAY   86400UL
+
+/* TX current versus output power, EFR32BG22 at 3 V. Sorted by power. */
+static const struct {
+  int16_t tx_power;    /* 0.1 dBm */
+  uint16_t current_ua;
+} tx_current_table[] = {
+  { -200, 2400 },
+  { -100, 2800 },
+  { -50, 3300 },
+  { 0, 4100 },
+  { 30, 5600 },
+  { 60, 8200 },
+};
+
+#define TX_LEVELS   (sizeof(tx_current_table) / sizeof(tx_current_table[0]))
+
+static uint32_t budget_na = 0;
+
+/* TX current of the strongest table entry not above the given power */
+static uint16_t tx_current_ua(int16_t tx_power)
+{
+  uint16_t current = tx_current_table[0].current_ua;
+
+  for (uint8_t i = 0; i < TX_LEVELS; i++) {
+    if (tx_current_table[i].tx_power <= tx_power) {
+      current = tx_current_table[i].current_ua;
+    }
+  }
+  return current;
+}
+
+static uint8_t channel_count(uint8_t channel_map)
+{
+  return ((channel_map & POWER_MODEL_CHANNEL_37) ? 1 : 0)
+         + ((channel_map & POWER_MODEL_CHANNEL_38) ? 1 : 0)
+         + ((channel_map & POWER_MODEL_CHANNEL_39) ? 1 : 0);
+}
+
+uint32_t power_model_event_charge_nc(const power_model_adv_config_t *config)
+{
+  /* 1 Mbit/s: 8 us per byte. uA * us = pC. */
+  uint32_t airtime_us = (POWER_MODEL_PDU_OVERHEAD_BYTES + config->payload_len) * 8
+                        + POWER_MODEL_RAMP_US;
+  uint32_t channel_pc = tx_current_ua(config->tx_power) * airtime_us;
+
+  if (config->connectable) {
+    channel_pc += POWER_MODEL_RX_CURRENT_UA * POWER_MODEL_RX_WINDOW_US;
+  }
+
+  return POWER_MODEL_WAKEUP_CHARGE_NC
+         + channel_count(config->channel_map)
+         * (channel_pc / 1000 + POWER_MODEL_CHANNEL_SWITCH_NC);
+}
+
+uint32_t power_model_average_current_na(const power_model_adv_config_t *config)
+{
+  /* nC per ms is uA, hence the factor 1000 to get nA */
+  return POWER_MODEL_SLEEP_CURRENT_NA
+         + (uint32_t)(((uint64_t)power_model_event_charge_nc(config) * 1000)
+                      / config->interval_ms);
+}
+
+/* Fixed profiles advertise as fast and strong as they are allowed to. */
+static void fixed_config(const power_model_profile_t *profile,
+                         uint8_t payload_len,
+                         power_model_adv_config_t *config)
+{
+  config->interval_ms = profile->min_interval_ms;
+  config->channel_map = POWER_MODEL_CHANNEL_37 | POWER_MODEL_CHANNEL_38
+                        | POWER_MODEL_CHANNEL_39;
+  config->tx_power = profile->max_tx_power;
+  config->payload_len = payload_len;
+  config->connectable = profile->connectable;
+}
+
+void power_model_set_budget(uint32_t battery_mah,
+                            uint32_t target_days,
+                            const power_model_profile_t *burst_profile,
+                            uint16_t bursts_per_day)
+{
+  uint64_t total_na;
+  uint64_t burst_na = 0;
+
+  /* mAh / h = mA, times 10^6 for nA */
+  total_na = ((uint64_t)battery_mah * 1000000 * POWER_MODEL_BATTERY_DERATING_PERCENT / 100)
+             / ((uint64_t)target_days * 24);
+
+  if (burst_profile != NULL && bursts_per_day != 0) {
+    power_model_adv_config_t burst;
+
+    fixed_config(burst_profile, 0, &burst);
+    /* Extra charge of the bursts, spread over the day */
+    burst_na = ((uint64_t)(power_model_average_current_na(&burst)
+                           - POWER_MODEL_SLEEP_CURRENT_NA)
+                * burst_profile->duration_s * bursts_per_day)
+               / SECONDS_PER_DAY;
+  }
+
+  budget_na = (total_na > burst_na) ? (uint32_t)(total_na - burst_na) : 0;
+}
+
+uint32_t power_model_get_budget_na(void)
+{
+  return budget_na;
+}
+
+bool power_model_solve(const power_model_profile_t *profile,
+                       uint8_t payload_len,
+                       power_model_adv_config_t *config)
+{
+  static const uint8_t channel_maps[] = {
+    POWER_MODEL_CHANNEL_37 | POWER_MODEL_CHANNEL_38 | POWER_MODEL_CHANNEL_39,
+    POWER_MODEL_CHANNEL_37 | POWER_MODEL_CHANNEL_38,
+    POWER_MODEL_CHANNEL_37,
+  };
+
+  if (profile->fixed) {
+    fixed_config(profile, payload_len, config);
+    return power_model_average_current_na(config) <= budget_na;
+  }
+
+  config->payload_len = payload_len;
+  config->connectable = profile->connectable;
+
+  /* Prefer more channels, then more TX power, and take the shortest interval
+   * the budget allows. */
+  if (budget_na > POWER_MODEL_SLEEP_CURRENT_NA) {
+    uint32_t available_na = budget_na - POWER_MODEL_SLEEP_CURRENT_NA;
+
+    for (uint8_t c = 0; c < sizeof(channel_maps); c++) {
+      for (int8_t p = TX_LEVELS - 1; p >= 0; p--) {
+        uint32_t interval_ms;
+
+        if (tx_current_table[p].tx_power > profile->max_tx_power) {
+          continue;
+        }
+        config->channel_map = channel_maps[c];
+        config->tx_power = tx_current_table[p].tx_power;
+        interval_ms = (power_model_event_charge_nc(config) * 1000
+                       + available_na - 1) / available_na;
+        if (interval_ms <= profile->max_interval_ms) {
+          config->interval_ms = (interval_ms < profile->min_interval_ms)
+                                ? profile->min_interval_ms : (uint16_t)interval_ms;
+          return true;
+        }
+      }
+    }
+  }
+
+  /* Over budget: fall back to the most economical configuration */
+  config->channel_map = POWER_MODEL_CHANNEL_37;
+  config->tx_power = tx_current_table[0].tx_power;
+  config->interval_ms = profile->max_interval_ms;
+  return false;
+}
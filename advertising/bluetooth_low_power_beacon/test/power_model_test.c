@@ -0,0 +1,268 @@
+/***************************************************************************//**
+ * @file power_model_test.c
+ * @brief Host test of the profile transitions of the low-power beacon.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ *******************************************************************************
+ * # Experimental Quality
+ * This code has not been formally tested and is provided as-is. It is not
+ * suitable for production environments. In addition, this code will not be
+ * maintained and there may be no bug maintenance planned for these resources.
+ * Silicon Labs may update projects from time to time.
+ ******************************************************************************/
+
+/* Replays days of the beacon on a PC: deep idle beaconing interrupted by
+ * button presses, each switching to the fast connectable profile for its
+ * duration and back, as app.c does. The charge of every profile period is
+ * summed from the model, and the projected battery life is compared with
+ * the target. Build and run on a PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I../inc power_model_test.c ../src/power_model.c -o power_model_test
+ *   ./power_model_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "power_model.h"
+
+/* Same settings and profiles as app.c */
+#define BATTERY_CAPACITY_MAH      220
+#define TARGET_BATTERY_LIFE_DAYS  1095
+#define FAST_BURSTS_PER_DAY       4
+#define PAYLOAD_LEN               4
+
+#define SECONDS_PER_DAY           86400UL
+
+enum {
+  PROFILE_FAST_CONNECTABLE,
+  PROFILE_DEEP_IDLE
+};
+
+static const power_model_profile_t profiles[] = {
+  [PROFILE_FAST_CONNECTABLE] = { "fast connectable", 100, 100, 0, 30, true, true },
+  [PROFILE_DEEP_IDLE] = { "deep idle", 1000, 10240, 0, 0, false, false },
+};
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+/* State of the replayed beacon */
+typedef struct {
+  uint8_t profile;
+  power_model_adv_config_t config;
+  bool within_budget;
+  uint32_t since_s;          /* Start of the current profile */
+  double charge_nc;          /* Charge drawn so far */
+  unsigned transitions;
+} beacon_t;
+
+/* Close the current profile period and apply a new profile, as
+ * applyProfile() of app.c does. */
+static void apply_profile(beacon_t *beacon, uint8_t profile, uint32_t now_s)
+{
+  beacon->charge_nc += (double)power_model_average_current_na(&beacon->config)
+                       * (now_s - beacon->since_s) / 1000.0;
+  beacon->profile = profile;
+  beacon->within_budget = power_model_solve(&profiles[profile], PAYLOAD_LEN,
+                                            &beacon->config);
+  beacon->since_s = now_s;
+  beacon->transitions++;
+}
+
+static void boot(beacon_t *beacon, uint32_t battery_mah, uint16_t budgeted_bursts)
+{
+  memset(beacon, 0, sizeof(*beacon));
+  power_model_set_budget(battery_mah, TARGET_BATTERY_LIFE_DAYS,
+                         &profiles[PROFILE_FAST_CONNECTABLE], budgeted_bursts);
+  beacon->within_budget = power_model_solve(&profiles[PROFILE_DEEP_IDLE],
+                                            PAYLOAD_LEN, &beacon->config);
+  beacon->profile = PROFILE_DEEP_IDLE;
+}
+
+/* Replay one day with the given number of button presses, spread evenly.
+ * Each press switches to fast connectable, and its timer back to deep
+ * idle. Returns the average current of the day in nA. */
+static double replay_day(beacon_t *beacon, uint16_t presses)
+{
+  const uint32_t fast_s = profiles[PROFILE_FAST_CONNECTABLE].duration_s;
+  power_model_adv_config_t idle = beacon->config;
+  double start_nc = beacon->charge_nc;
+
+  beacon->since_s = 0;
+  for (uint16_t i = 0; i < presses; i++) {
+    uint32_t press_s = (uint32_t)((uint64_t)SECONDS_PER_DAY * i / presses);
+
+    CHECK(beacon->profile == PROFILE_DEEP_IDLE);
+    apply_profile(beacon, PROFILE_FAST_CONNECTABLE, press_s);
+    CHECK(beacon->config.interval_ms == 100);
+    CHECK(beacon->config.connectable);
+    CHECK(beacon->config.channel_map == (POWER_MODEL_CHANNEL_37
+                                         | POWER_MODEL_CHANNEL_38
+                                         | POWER_MODEL_CHANNEL_39));
+    apply_profile(beacon, PROFILE_DEEP_IDLE, press_s + fast_s);
+    /* Back to exactly the settings before the press */
+    CHECK(memcmp(&beacon->config, &idle, sizeof(idle)) == 0);
+  }
+  /* Close the last period at the end of the day */
+  apply_profile(beacon, PROFILE_DEEP_IDLE, SECONDS_PER_DAY);
+  return (beacon->charge_nc - start_nc) * 1000.0 / SECONDS_PER_DAY;
+}
+
+static double life_days(uint32_t battery_mah, double average_na)
+{
+  return battery_mah * 1e6 * POWER_MODEL_BATTERY_DERATING_PERCENT / 100
+         / (average_na * 24);
+}
+
+/* The day budgeted for meets the target, and the idle profile is the same
+ * after every burst. */
+static void test_budgeted_day(void)
+{
+  beacon_t beacon;
+  double average_na;
+
+  boot(&beacon, BATTERY_CAPACITY_MAH, FAST_BURSTS_PER_DAY);
+  CHECK(beacon.within_budget);
+  CHECK(power_model_average_current_na(&beacon.config)
+        <= power_model_get_budget_na());
+  CHECK(!beacon.config.connectable);
+  CHECK(beacon.config.interval_ms >= 1000 && beacon.config.interval_ms <= 10240);
+
+  for (int day = 0; day < 7; day++) {
+    average_na = replay_day(&beacon, FAST_BURSTS_PER_DAY);
+    CHECK(life_days(BATTERY_CAPACITY_MAH, average_na) >= TARGET_BATTERY_LIFE_DAYS);
+  }
+  CHECK(beacon.transitions == 7 * (2 * FAST_BURSTS_PER_DAY + 1));
+  printf("budgeted day: idle %u ms, map 0x%x, tx %d, %.0f nA, life %.0f days\n",
+         beacon.config.interval_ms, beacon.config.channel_map,
+         beacon.config.tx_power, average_na,
+         life_days(BATTERY_CAPACITY_MAH, average_na));
+}
+
+/* More presses than budgeted shorten the life, fewer lengthen it. The
+ * fast bursts do not depend on the budget. */
+static void test_unbudgeted_presses(void)
+{
+  double previous_days = 1e12;
+
+  printf("presses/day  average[nA]  life[days]\n");
+  for (uint16_t presses = 0; presses <= 64; presses = presses ? presses * 2 : 1) {
+    beacon_t beacon;
+    double average_na;
+    double days;
+
+    boot(&beacon, BATTERY_CAPACITY_MAH, FAST_BURSTS_PER_DAY);
+    average_na = replay_day(&beacon, presses);
+    days = life_days(BATTERY_CAPACITY_MAH, average_na);
+    printf("%11u  %11.0f  %10.0f\n", presses, average_na, days);
+    CHECK(days < previous_days);
+    if (presses <= FAST_BURSTS_PER_DAY) {
+      CHECK(days >= TARGET_BATTERY_LIFE_DAYS);
+    } else {
+      CHECK(days < TARGET_BATTERY_LIFE_DAYS);
+    }
+    previous_days = days;
+  }
+}
+
+/* A larger battery never gives a less capable idle profile, and the idle
+ * profile stays within its budget whenever the solver says so. */
+static void test_budget_sweep(void)
+{
+  power_model_adv_config_t previous = { 0 };
+  int previous_channels = 0;
+  bool first = true;
+
+  for (uint32_t mah = 20; mah <= 4000; mah += 20) {
+    beacon_t beacon;
+    int channels;
+
+    boot(&beacon, mah, FAST_BURSTS_PER_DAY);
+    channels = ((beacon.config.channel_map & POWER_MODEL_CHANNEL_37) != 0)
+               + ((beacon.config.channel_map & POWER_MODEL_CHANNEL_38) != 0)
+               + ((beacon.config.channel_map & POWER_MODEL_CHANNEL_39) != 0);
+    if (beacon.within_budget) {
+      CHECK(power_model_average_current_na(&beacon.config)
+            <= power_model_get_budget_na());
+      if (!first) {
+        CHECK(channels >= previous_channels);
+        if (channels == previous_channels
+            && beacon.config.tx_power == previous.tx_power) {
+          CHECK(beacon.config.interval_ms <= previous.interval_ms);
+        }
+      }
+      previous = beacon.config;
+      previous_channels = channels;
+      first = false;
+    } else {
+      /* Most economical configuration */
+      CHECK(first);
+      CHECK(beacon.config.channel_map == POWER_MODEL_CHANNEL_37);
+      CHECK(beacon.config.interval_ms == profiles[PROFILE_DEEP_IDLE].max_interval_ms);
+    }
+  }
+  CHECK(!first);
+}
+
+/* A budget eaten up by the bursts leaves the idle profile over budget,
+ * while the fast profile keeps its fixed settings. */
+static void test_starved_budget(void)
+{
+  beacon_t beacon;
+
+  boot(&beacon, 10, 200);
+  CHECK(power_model_get_budget_na() == 0);
+  CHECK(!beacon.within_budget);
+  CHECK(beacon.config.channel_map == POWER_MODEL_CHANNEL_37);
+  CHECK(beacon.config.interval_ms == profiles[PROFILE_DEEP_IDLE].max_interval_ms);
+  apply_profile(&beacon, PROFILE_FAST_CONNECTABLE, 0);
+  CHECK(!beacon.within_budget);
+  CHECK(beacon.config.interval_ms == 100);
+}
+
+int main(void)
+{
+  test_budgeted_day();
+  test_unbudgeted_presses();
+  test_budget_sweep();
+  test_starved_budget();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
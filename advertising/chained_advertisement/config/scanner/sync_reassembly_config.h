@@ -0,0 +1,36 @@
+/***************************************************************************//**
+ * @file sync_reassembly_config.h
+ * @brief Configuration of the reassembly of chained periodic advertising reports.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef SYNC_REASSEMBLY_CONFIG_H
+#define SYNC_REASSEMBLY_CONFIG_H
+
+// <<< Use Configuration Wizard in Context Menu >>>
+
+// <o SYNC_REASSEMBLY_MAX_SYNCS> Number of reassembly buffers <1..64>
+// <i> Periodic syncs that can be reassembled concurrently. Should equal the
+// <i> maximum number of periodic advertising syncs of the stack.
+// <i> Default: 4
+#define SYNC_REASSEMBLY_MAX_SYNCS     4
+
+// <o SYNC_REASSEMBLY_BUFFER_SIZE> Buffer size [bytes] <31..1650>
+// <i> Largest advertising data a chain can carry.
+// <i> Default: 1650
+#define SYNC_REASSEMBLY_BUFFER_SIZE   1650
+
+// <<< end of configuration section >>>
+
+#endif // SYNC_REASSEMBLY_CONFIG_H
@@ -0,0 +1,135 @@
+/***************************************************************************//**
+ * @file sync_reassembly.h
+ * @brief Reassembly of chained periodic advertising reports.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef SYNC_REASSEMBLY_H
+#define SYNC_REASSEMBLY_H
+
+#include <stdint.h>
+#include "sl_status.h"
+#include "sync_reassembly_config.h"
+
+// Values of the data_status field of sl_bt_evt_periodic_sync_report.
+#define SYNC_REASSEMBLY_DATA_COMPLETE     0
+#define SYNC_REASSEMBLY_DATA_INCOMPLETE   1
+#define SYNC_REASSEMBLY_DATA_TRUNCATED    2
+
+/***************************************************************************//**
+ * @brief Outcome of a reassembled chain
+ ******************************************************************************/
+typedef enum {
+  sync_reassembly_complete,   // All fragments received, data is valid
+  sync_reassembly_truncated,  // Controller reported missing fragments
+  sync_reassembly_overflow    // Chain exceeded SYNC_REASSEMBLY_BUFFER_SIZE
+} sync_reassembly_result_t;
+
+/***************************************************************************//**
+ * @brief Per-sync reassembly counters
+ ******************************************************************************/
+typedef struct {
+  uint32_t complete;
+  uint32_t truncated;
+  uint32_t overflow;
+  uint32_t fragments;
+} sync_reassembly_stats_t;
+
+/***************************************************************************//**
+ *
+ * Called once per finished chain.
+ *
+ * For sync_reassembly_complete @p data points to @p len bytes of reassembled
+ * advertising data. For the error results @p data holds the bytes collected
+ * before the error and must not be trusted. The buffer is only valid until
+ * the callback returns.
+ *
+ ******************************************************************************/
+typedef void (*sync_reassembly_callback_t)(uint16_t sync,
+                                           sync_reassembly_result_t result,
+                                           const uint8_t *data,
+                                           uint16_t len);
+
+/***************************************************************************//**
+ *
+ * Reset the buffer pool and register the completion callback.
+ *
+ * @param[in] callback Function called when a chain is finished
+ *
+ ******************************************************************************/
+void sync_reassembly_init(sync_reassembly_callback_t callback);
+
+/***************************************************************************//**
+ *
+ * Assign a reassembly buffer to a sync.
+ *
+ * SL_STATUS_NO_MORE_RESOURCE will be returned if all buffers are in use,
+ * SL_STATUS_ALREADY_EXISTS if the sync already owns a buffer.
+ *
+ * @param[in] sync Sync handle
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t sync_reassembly_open(uint16_t sync);
+
+/***************************************************************************//**
+ *
+ * Release the buffer of a sync. A partially received chain is dropped
+ * without a callback.
+ *
+ * @param[in] sync Sync handle
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND otherwise.
+ *
+ ******************************************************************************/
+sl_status_t sync_reassembly_close(uint16_t sync);
+
+/***************************************************************************//**
+ *
+ * Feed one periodic sync report fragment.
+ *
+ * A sync that has not been opened is assigned a buffer on its first fragment.
+ * Bytes beyond SYNC_REASSEMBLY_BUFFER_SIZE are never written; the chain is
+ * reported as overflowed when its last fragment arrives.
+ *
+ * @param[in] sync Sync handle
+ * @param[in] data_status data_status field of the report
+ * @param[in] data Fragment data
+ * @param[in] len Length of @p data
+ *
+ * @return SL_STATUS_OK if the fragment was consumed,
+ *         SL_STATUS_NO_MORE_RESOURCE if no buffer is available,
+ *         SL_STATUS_INVALID_PARAMETER for an unknown @p data_status.
+ *
+ ******************************************************************************/
+sl_status_t sync_reassembly_push(uint16_t sync,
+                                 uint8_t data_status,
+                                 const uint8_t *data,
+                                 uint16_t len);
+
+/***************************************************************************//**
+ *
+ * Retrieve the counters of a sync.
+ *
+ * @param[in] sync Sync handle
+ * @param[out] stats Counters of the sync
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND otherwise.
+ *
+ ******************************************************************************/
+sl_status_t sync_reassembly_get_stats(uint16_t sync,
+                                      sync_reassembly_stats_t *stats);
+
+#endif // SYNC_REASSEMBLY_H
@@ -22,10 +22,153 @@
 
 #include "sl_bt_api.h"
 #include "app_log.h"
+#include "sl_sleeptimer.h"
+#include "sync_reassembly.h"
+#include "sync_manager.h"
+
+// Update rate required by the application. The sync manager listens to the
+// periodic advertising no more often than every SYNC_MIN_UPDATE_MS, and
+// less often when the data changes slowly, down to every SYNC_MAX_UPDATE_MS.
+#define SYNC_MIN_UPDATE_MS    1000
+#define SYNC_MAX_UPDATE_MS    10000
+
+// Time the scanner looks for new periodic trains after boot, and after a
+// train was lost. Afterwards it only scans while a sync is being
+// (re)established.
+#define DISCOVERY_TIMEOUT_MS  10000
+
+// External signal of the end of the discovery window.
+#define DISCOVERY_SIGNAL      0x01
+
+// Log the sync manager statistics every this many complete chains.
+#define CHAINS_PER_SUMMARY    10
 
 // This constant is UUID of periodic synchronous service
 const uint8_t periodicSyncService[16] = { 0x81, 0xc2, 0x00, 0x2d, 0x31, 0xf4, 0xb0, 0xbf, 0x2b, 0x42, 0x49, 0x68, 0xc7, 0x25, 0x71, 0x41 };
 
+// Number of syncs currently open
+static uint8_t open_syncs = 0;
+
+// New trains are looked for
+static bool discovering = false;
+static sl_sleeptimer_timer_handle_t discovery_timer;
+
+// Fletcher-16 of the chain. The data ID of the advertiser is not reported
+// with the periodic data, so the content identifies itself.
+static uint16_t data_id(const uint8_t *data, uint16_t len)
+{
+  uint16_t sum1 = 0;
+  uint16_t sum2 = 0;
+
+  for (uint16_t i = 0; i < len; i++) {
+    sum1 = (sum1 + data[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return (uint16_t)((sum2 << 8) | sum1);
+}
+
+static void log_sync_manager(uint16_t sync)
+{
+  sync_manager_stats_t stats;
+  sync_manager_sync_info_t info;
+
+  sync_manager_get_stats(&stats);
+  if (sync_manager_get_sync_info(sync, &info) == SL_STATUS_OK) {
+    app_log_info("sync %d: skip %d, timeout %lu ms, data change every %lu ms\r\n",
+                 sync,
+                 info.skip,
+                 (unsigned long)info.timeout_ms,
+                 (unsigned long)info.change_ms);
+  }
+  app_log_info("syncs: %lu events received, %lu skipped, %lu retunes, %lu losses, "
+               "radio-on time saved %lu ms, scanning %lu ms\r\n",
+               (unsigned long)stats.events_received,
+               (unsigned long)stats.events_skipped,
+               (unsigned long)stats.retunes,
+               (unsigned long)stats.losses,
+               (unsigned long)stats.radio_saved_ms,
+               (unsigned long)stats.scan_ms);
+}
+
+static void discovery_timer_callback(sl_sleeptimer_timer_handle_t *handle,
+                                     void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(DISCOVERY_SIGNAL);
+}
+
+// Scan for new trains for DISCOVERY_TIMEOUT_MS.
+static void start_discovery(void)
+{
+  sl_status_t sc;
+
+  discovering = true;
+  sl_sleeptimer_restart_timer_ms(&discovery_timer,
+                                 DISCOVERY_TIMEOUT_MS,
+                                 discovery_timer_callback,
+                                 NULL,
+                                 0,
+                                 0);
+  sc = sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m,
+                           sl_bt_scanner_discover_observation);
+  // The scanner may already run for the sync manager or the last discovery
+  if (sc != SL_STATUS_INVALID_STATE) {
+    app_assert_status(sc);
+  }
+}
+
+// Stop scanning once the discovery is over, or every reassembly buffer is
+// taken, unless the sync manager is still (re)establishing a sync.
+static void update_scanning(void)
+{
+  if (discovering && open_syncs >= SYNC_REASSEMBLY_MAX_SYNCS) {
+    discovering = false;
+    sl_sleeptimer_stop_timer(&discovery_timer);
+  }
+  if (!discovering && sync_manager_get_opening() == 0) {
+    sl_bt_scanner_stop();
+  }
+}
+
+// Called by the sync manager when an advertiser cannot be synced to again.
+static void on_train_lost(const bd_addr *address, uint8_t sid)
+{
+  (void)address;
+  app_log_info("periodic train SID %d lost, restarting discovery\r\n", sid);
+  start_discovery();
+}
+
+// Called by the reassembly engine when a chain is finished.
+static void on_chain_reassembled(uint16_t sync,
+                                 sync_reassembly_result_t result,
+                                 const uint8_t *data,
+                                 uint16_t len)
+{
+  static uint32_t chains = 0;
+
+  switch (result) {
+    case sync_reassembly_complete:
+      if (sync_manager_report(sync, data_id(data, len), len)) {
+        app_log_info("sync %d: complete, %d bytes received.\r\n", sync, len);
+      }
+      if (++chains % CHAINS_PER_SUMMARY == 0) {
+        log_sync_manager(sync);
+      }
+      break;
+    case sync_reassembly_truncated:
+      app_log_info("sync %d: data truncated after %d bytes, discard entire chain\r\n",
+                   sync,
+                   len);
+      break;
+    case sync_reassembly_overflow:
+      app_log_info("sync %d: chain exceeds %d bytes, discard entire chain\r\n",
+                   sync,
+                   SYNC_REASSEMBLY_BUFFER_SIZE);
+      break;
+  }
+}
+
 // Parse advertisements looking for advertised periodicSync Service.
 static uint8_t find_service_in_advertisement(uint8_t *data, uint8_t len)
 {
@@ -56,6 +199,8 @@ static uint8_t find_service_in_advertisement(uint8_t *data, uint8_t len)
  *****************************************************************************/
 SL_WEAK void app_init(void)
 {
+  sync_reassembly_init(on_chain_reassembled);
+  sync_manager_set_lost_callback(on_train_lost);
   /////////////////////////////////////////////////////////////////////////////
   // Put your additional application init code here!                         //
   // This is called once during start-up.                                    //
@@ -87,8 +232,6 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   uint8_t address_type;
   uint8_t system_id[8];
 
-  static uint16_t sync;
-
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
     // This event indicates the device has started and the radio is ready.
@@ -130,8 +273,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 
       // periodic scanner setting
       sl_bt_scanner_set_parameters(sl_bt_scanner_scan_mode_passive, 200, 200);
-      sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m,
-                          sl_bt_scanner_discover_observation);
+      start_discovery();
 
       break;
 
@@ -141,61 +283,62 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
                    evt->data.evt_scanner_extended_advertisement_report.tx_power);
       if (find_service_in_advertisement(&(evt->data.evt_scanner_extended_advertisement_report.data.data[0]),
                                         evt->data.evt_scanner_extended_advertisement_report.data.len) != 0) {
-        app_log_info("found periodic sync service, attempting to open sync\r\n");
-
-        sc = sl_bt_sync_scanner_open(evt->data.evt_scanner_extended_advertisement_report.address,
-                                     evt->data.evt_scanner_extended_advertisement_report.address_type,
-                                     evt->data.evt_scanner_extended_advertisement_report.adv_sid,
-                                     &sync);
-        app_log_info("cmd_sync_open() sync = 0x%4lX\r\n", sc);
+        sc = sync_manager_add(evt->data.evt_scanner_extended_advertisement_report.address,
+                              evt->data.evt_scanner_extended_advertisement_report.address_type,
+                              evt->data.evt_scanner_extended_advertisement_report.adv_sid,
+                              SYNC_MIN_UPDATE_MS,
+                              SYNC_MAX_UPDATE_MS);
+        if (sc != SL_STATUS_ALREADY_EXISTS) {
+          app_log_info("found periodic sync service, attempting to open sync\r\n");
+          app_log_info("sync_manager_add() sc = 0x%4lX\r\n", sc);
+        }
       }
       break;
 
     case sl_bt_evt_periodic_sync_opened_id:
-      /* now that sync is open, we can stop scanning*/
-      app_log_info("evt_sync_opened\r\n");
-      sl_bt_scanner_stop();
+      app_log_info("evt_sync_opened, sync handle %d\r\n",
+                   evt->data.evt_periodic_sync_opened.sync);
+      sc = sync_reassembly_open(evt->data.evt_periodic_sync_opened.sync);
+      if (sc == SL_STATUS_OK) {
+        open_syncs++;
+      } else if (sc == SL_STATUS_NO_MORE_RESOURCE) {
+        app_log_info("no reassembly buffer left, closing sync\r\n");
+        sl_bt_sync_close(evt->data.evt_periodic_sync_opened.sync);
+      }
+      update_scanning();
       break;
 
     case sl_bt_evt_sync_closed_id:
       app_log_info("periodic sync closed. reason 0x%2X, sync handle %d",
                    evt->data.evt_sync_closed.reason,
                    evt->data.evt_sync_closed.sync);
-      /* restart discovery */
-      sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m,
-                          sl_bt_scanner_discover_observation);
+      if (sync_reassembly_close(evt->data.evt_sync_closed.sync) == SL_STATUS_OK) {
+        open_syncs--;
+      }
+      // The sync manager reopens the sync, scanning until it is opened, or
+      // gives the train up and the discovery is restarted.
+      update_scanning();
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & DISCOVERY_SIGNAL) {
+        app_log_info("discovery finished, %d syncs open\r\n", open_syncs);
+        discovering = false;
+        update_scanning();
+      }
       break;
 
     case sl_bt_evt_periodic_sync_report_id:
-    {
-      static uint16_t sync_data_index = 0;
-      static uint8_t sync_rx_buffer[1650];
-      uint16_t len = evt->data.evt_periodic_sync_report.data.len;
-
-      switch (evt->data.evt_periodic_sync_report.data_status) {
-        case 0:
-          app_log_info("complete sync %d bytes received.\r\n",
-                       evt->data.evt_periodic_sync_report.data.len);
-          memcpy(&sync_rx_buffer[sync_data_index], evt->data.evt_periodic_sync_report.data.data, len);
-          sync_data_index = 0;
-          break;
-        case 1:
-          /* */
-          app_log_info("sync data received, %d bytes, more to come\r\n",
-                       evt->data.evt_periodic_sync_report.data.len);
-          memcpy(&sync_rx_buffer[sync_data_index], evt->data.evt_periodic_sync_report.data.data, len);
-          sync_data_index += len;
-          break;
-        case 2:
-          app_log_info("data corrupted, discard entire sync. sync_data_index was %d and %d bytes received in this event\r\n",
-                       sync_data_index,
-                       len);
-          memset(sync_rx_buffer, 0, sizeof(sync_rx_buffer));
-          sync_data_index = 0;
-          break;
+      sc = sync_reassembly_push(evt->data.evt_periodic_sync_report.sync,
+                                evt->data.evt_periodic_sync_report.data_status,
+                                evt->data.evt_periodic_sync_report.data.data,
+                                evt->data.evt_periodic_sync_report.data.len);
+      if (sc != SL_STATUS_OK) {
+        app_log_info("sync %d: report dropped, status 0x%04lx\r\n",
+                     evt->data.evt_periodic_sync_report.sync,
+                     sc);
       }
-    }
-    break;
+      break;
 
     ///////////////////////////////////////////////////////////////////////////
     // Add additional event handlers here as your application requires!      //
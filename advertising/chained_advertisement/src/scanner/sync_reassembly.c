@@ -0,0 +1,164 @@
+/***************************************************************************//**
+ * @file sync_reassembly.c
+ * @brief Reassembly of chained periodic advertising reports.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdbool.h>
+#include <string.h>
+#include "sync_reassembly.h"
+
+typedef struct {
+  bool in_use;
+  bool overflow;
+  uint16_t sync;
+  uint16_t offset;
+  sync_reassembly_stats_t stats;
+  uint8_t data[SYNC_REASSEMBLY_BUFFER_SIZE];
+} reassembly_buffer_t;
+
+static reassembly_buffer_t buffers[SYNC_REASSEMBLY_MAX_SYNCS];
+static sync_reassembly_callback_t complete_callback = NULL;
+
+static reassembly_buffer_t *find_buffer(uint16_t sync)
+{
+  for (uint8_t i = 0; i < SYNC_REASSEMBLY_MAX_SYNCS; i++) {
+    if (buffers[i].in_use && buffers[i].sync == sync) {
+      return &buffers[i];
+    }
+  }
+  return NULL;
+}
+
+static reassembly_buffer_t *allocate_buffer(uint16_t sync)
+{
+  for (uint8_t i = 0; i < SYNC_REASSEMBLY_MAX_SYNCS; i++) {
+    if (!buffers[i].in_use) {
+      memset(&buffers[i].stats, 0, sizeof(buffers[i].stats));
+      buffers[i].in_use = true;
+      buffers[i].overflow = false;
+      buffers[i].sync = sync;
+      buffers[i].offset = 0;
+      return &buffers[i];
+    }
+  }
+  return NULL;
+}
+
+// Report the chain held in the buffer and rewind it for the next one.
+static void finish_chain(reassembly_buffer_t *buf,
+                         sync_reassembly_result_t result)
+{
+  switch (result) {
+    case sync_reassembly_complete:
+      buf->stats.complete++;
+      break;
+    case sync_reassembly_truncated:
+      buf->stats.truncated++;
+      break;
+    case sync_reassembly_overflow:
+      buf->stats.overflow++;
+      break;
+  }
+  if (complete_callback != NULL) {
+    complete_callback(buf->sync, result, buf->data, buf->offset);
+  }
+  buf->offset = 0;
+  buf->overflow = false;
+}
+
+void sync_reassembly_init(sync_reassembly_callback_t callback)
+{
+  memset(buffers, 0, sizeof(buffers));
+  complete_callback = callback;
+}
+
+sl_status_t sync_reassembly_open(uint16_t sync)
+{
+  if (find_buffer(sync) != NULL) {
+    return SL_STATUS_ALREADY_EXISTS;
+  }
+  if (allocate_buffer(sync) == NULL) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sync_reassembly_close(uint16_t sync)
+{
+  reassembly_buffer_t *buf = find_buffer(sync);
+
+  if (buf == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  buf->in_use = false;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sync_reassembly_push(uint16_t sync,
+                                 uint8_t data_status,
+                                 const uint8_t *data,
+                                 uint16_t len)
+{
+  reassembly_buffer_t *buf;
+
+  if (data_status > SYNC_REASSEMBLY_DATA_TRUNCATED) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  buf = find_buffer(sync);
+  if (buf == NULL) {
+    buf = allocate_buffer(sync);
+    if (buf == NULL) {
+      return SL_STATUS_NO_MORE_RESOURCE;
+    }
+  }
+
+  buf->stats.fragments++;
+
+  // Once a chain overflowed, the rest of it is dropped until its last report.
+  if (!buf->overflow) {
+    if (len > SYNC_REASSEMBLY_BUFFER_SIZE - buf->offset) {
+      buf->overflow = true;
+    } else {
+      memcpy(&buf->data[buf->offset], data, len);
+      buf->offset += len;
+    }
+  }
+
+  switch (data_status) {
+    case SYNC_REASSEMBLY_DATA_COMPLETE:
+      finish_chain(buf, buf->overflow ? sync_reassembly_overflow
+                   : sync_reassembly_complete);
+      break;
+    case SYNC_REASSEMBLY_DATA_TRUNCATED:
+      finish_chain(buf, buf->overflow ? sync_reassembly_overflow
+                   : sync_reassembly_truncated);
+      break;
+    default:
+      break;
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sync_reassembly_get_stats(uint16_t sync,
+                                      sync_reassembly_stats_t *stats)
+{
+  reassembly_buffer_t *buf = find_buffer(sync);
+
+  if (buf == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  *stats = buf->stats;
+  return SL_STATUS_OK;
+}
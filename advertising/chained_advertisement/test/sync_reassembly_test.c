@@ -0,0 +1,331 @@
+/***************************************************************************//**
+ * @file sync_reassembly_test.c
+ * @brief Host replay test of the reassembly of chained periodic reports.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/* Replays streams of periodic sync reports into the reassembly engine and
+ * checks every finished chain against what was sent: interleaved syncs,
+ * truncated and oversized chains, buffer exhaustion, and a long random
+ * stream compared with a reference model. Build and run on a PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I. -I../inc/scanner -I../config/scanner \
+ *       sync_reassembly_test.c ../src/scanner/sync_reassembly.c -o sync_reassembly_test
+ *   ./sync_reassembly_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "sync_reassembly.h"
+
+// Longest fragment of a periodic sync report.
+#define MAX_FRAGMENT_LEN    247
+
+// Random stream
+#define RANDOM_SYNCS        SYNC_REASSEMBLY_MAX_SYNCS
+#define RANDOM_REPORTS      200000
+
+typedef struct {
+  uint16_t sync;
+  sync_reassembly_result_t result;
+  uint16_t len;
+  uint8_t data[SYNC_REASSEMBLY_BUFFER_SIZE];
+} chain_t;
+
+// Chains reported by the engine since the last reset
+static chain_t chains[8];
+static uint32_t chain_count = 0;
+static uint32_t failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+static void on_chain(uint16_t sync,
+                     sync_reassembly_result_t result,
+                     const uint8_t *data,
+                     uint16_t len)
+{
+  chain_t *chain = &chains[chain_count % (sizeof(chains) / sizeof(chains[0]))];
+
+  chain_count++;
+  chain->sync = sync;
+  chain->result = result;
+  chain->len = len;
+  // The engine must never report more than its buffer holds.
+  CHECK(len <= SYNC_REASSEMBLY_BUFFER_SIZE);
+  if (len <= SYNC_REASSEMBLY_BUFFER_SIZE) {
+    memcpy(chain->data, data, len);
+  }
+}
+
+static void reset(void)
+{
+  sync_reassembly_init(on_chain);
+  chain_count = 0;
+}
+
+// Deterministic content of the byte at offset of a chain
+static uint8_t pattern(uint16_t sync, uint32_t chain, uint32_t offset)
+{
+  return (uint8_t)(sync * 31u + chain * 7u + offset);
+}
+
+static bool matches(const chain_t *c, uint32_t chain, uint16_t len)
+{
+  if (c->len != len) {
+    return false;
+  }
+  for (uint16_t i = 0; i < len; i++) {
+    if (c->data[i] != pattern(c->sync, chain, i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Send bytes [offset, offset + len) of a chain as one fragment
+static sl_status_t push(uint16_t sync, uint32_t chain, uint32_t offset,
+                        uint16_t len, uint8_t data_status)
+{
+  uint8_t fragment[MAX_FRAGMENT_LEN];
+
+  for (uint16_t i = 0; i < len; i++) {
+    fragment[i] = pattern(sync, chain, offset + i);
+  }
+  return sync_reassembly_push(sync, data_status, fragment, len);
+}
+
+// Two syncs whose fragments alternate. Each chain must only hold its own.
+static void test_interleaved(void)
+{
+  reset();
+  CHECK(sync_reassembly_open(1) == SL_STATUS_OK);
+  CHECK(sync_reassembly_open(2) == SL_STATUS_OK);
+  CHECK(sync_reassembly_open(2) == SL_STATUS_ALREADY_EXISTS);
+
+  for (uint32_t offset = 0; offset < 4 * 200; offset += 200) {
+    uint8_t status = (offset == 3 * 200) ? SYNC_REASSEMBLY_DATA_COMPLETE
+                     : SYNC_REASSEMBLY_DATA_INCOMPLETE;
+
+    CHECK(push(1, 0, offset, 200, status) == SL_STATUS_OK);
+    CHECK(push(2, 0, offset, 200, status) == SL_STATUS_OK);
+  }
+  CHECK(chain_count == 2);
+  CHECK(chains[0].sync == 1 && chains[0].result == sync_reassembly_complete);
+  CHECK(chains[1].sync == 2 && chains[1].result == sync_reassembly_complete);
+  CHECK(matches(&chains[0], 0, 800));
+  CHECK(matches(&chains[1], 0, 800));
+
+  // A single-fragment chain right after, reusing the buffer
+  CHECK(push(1, 1, 0, 31, SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 3);
+  CHECK(matches(&chains[2], 1, 31));
+}
+
+// The controller gives up on a chain. The bytes received so far are
+// reported as truncated, and the next chain starts from an empty buffer.
+static void test_truncated(void)
+{
+  sync_reassembly_stats_t stats;
+
+  reset();
+  CHECK(push(5, 0, 0, 247, SYNC_REASSEMBLY_DATA_INCOMPLETE) == SL_STATUS_OK);
+  CHECK(push(5, 0, 247, 100, SYNC_REASSEMBLY_DATA_TRUNCATED) == SL_STATUS_OK);
+  CHECK(chain_count == 1);
+  CHECK(chains[0].result == sync_reassembly_truncated);
+  CHECK(matches(&chains[0], 0, 347));
+
+  // Truncated with no data in the last report
+  CHECK(push(5, 1, 0, 0, SYNC_REASSEMBLY_DATA_TRUNCATED) == SL_STATUS_OK);
+  CHECK(chain_count == 2);
+  CHECK(chains[1].result == sync_reassembly_truncated && chains[1].len == 0);
+
+  CHECK(push(5, 2, 0, 120, SYNC_REASSEMBLY_DATA_INCOMPLETE) == SL_STATUS_OK);
+  CHECK(push(5, 2, 120, 10, SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 3);
+  CHECK(chains[2].result == sync_reassembly_complete);
+  CHECK(matches(&chains[2], 2, 130));
+
+  CHECK(sync_reassembly_get_stats(5, &stats) == SL_STATUS_OK);
+  CHECK(stats.truncated == 2 && stats.complete == 1 && stats.overflow == 0);
+  CHECK(stats.fragments == 5);
+
+  // A chain closed before its end is dropped without a report.
+  CHECK(push(5, 3, 0, 200, SYNC_REASSEMBLY_DATA_INCOMPLETE) == SL_STATUS_OK);
+  CHECK(sync_reassembly_close(5) == SL_STATUS_OK);
+  CHECK(sync_reassembly_close(5) == SL_STATUS_NOT_FOUND);
+  CHECK(push(5, 4, 0, 50, SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 4);
+  CHECK(matches(&chains[3], 4, 50));
+}
+
+// Chains longer than the buffer, ending exactly at it, and past it by one
+// byte. The rest of an oversized chain is dropped, and the other syncs are
+// not affected.
+static void test_oversized(void)
+{
+  uint32_t offset = 0;
+
+  reset();
+  while (offset + MAX_FRAGMENT_LEN <= SYNC_REASSEMBLY_BUFFER_SIZE) {
+    CHECK(push(1, 0, offset, MAX_FRAGMENT_LEN, SYNC_REASSEMBLY_DATA_INCOMPLETE)
+          == SL_STATUS_OK);
+    offset += MAX_FRAGMENT_LEN;
+  }
+  // Exactly fills the buffer
+  CHECK(push(1, 0, offset, (uint16_t)(SYNC_REASSEMBLY_BUFFER_SIZE - offset),
+             SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 1);
+  CHECK(chains[0].result == sync_reassembly_complete);
+  CHECK(matches(&chains[0], 0, SYNC_REASSEMBLY_BUFFER_SIZE));
+
+  // One byte too many
+  CHECK(push(1, 1, 0, MAX_FRAGMENT_LEN, SYNC_REASSEMBLY_DATA_INCOMPLETE) == SL_STATUS_OK);
+  for (offset = MAX_FRAGMENT_LEN;
+       offset + MAX_FRAGMENT_LEN <= SYNC_REASSEMBLY_BUFFER_SIZE;
+       offset += MAX_FRAGMENT_LEN) {
+    CHECK(push(1, 1, offset, MAX_FRAGMENT_LEN, SYNC_REASSEMBLY_DATA_INCOMPLETE)
+          == SL_STATUS_OK);
+    // Another sync in between
+    CHECK(push(2, 0, offset, 10, SYNC_REASSEMBLY_DATA_INCOMPLETE) == SL_STATUS_OK);
+  }
+  CHECK(push(1, 1, offset, (uint16_t)(SYNC_REASSEMBLY_BUFFER_SIZE - offset + 1),
+             SYNC_REASSEMBLY_DATA_INCOMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 1);
+  // Far beyond the buffer, ending with a truncation
+  for (uint8_t i = 0; i < 20; i++) {
+    CHECK(push(1, 1, 0, MAX_FRAGMENT_LEN, SYNC_REASSEMBLY_DATA_INCOMPLETE) == SL_STATUS_OK);
+  }
+  CHECK(push(1, 1, 0, 1, SYNC_REASSEMBLY_DATA_TRUNCATED) == SL_STATUS_OK);
+  CHECK(chain_count == 2);
+  CHECK(chains[1].result == sync_reassembly_overflow);
+  CHECK(chains[1].len == offset);
+  CHECK(matches(&chains[1], 1, (uint16_t)offset));
+
+  // The interleaved sync is intact, and sync 1 works again.
+  CHECK(push(2, 0, 0, 5, SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 3);
+  CHECK(chains[2].sync == 2 && chains[2].result == sync_reassembly_complete);
+  CHECK(chains[2].len == 5 + 10 * (offset / MAX_FRAGMENT_LEN - 1));
+  CHECK(push(1, 2, 0, 40, SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 4);
+  CHECK(matches(&chains[3], 2, 40));
+}
+
+// Every buffer taken. Reports of another sync are refused until one is
+// released. Unknown data status values are refused.
+static void test_exhaustion(void)
+{
+  reset();
+  for (uint16_t sync = 0; sync < SYNC_REASSEMBLY_MAX_SYNCS; sync++) {
+    CHECK(sync_reassembly_open(sync) == SL_STATUS_OK);
+  }
+  CHECK(sync_reassembly_open(100) == SL_STATUS_NO_MORE_RESOURCE);
+  CHECK(push(100, 0, 0, 10, SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_NO_MORE_RESOURCE);
+  CHECK(chain_count == 0);
+  CHECK(sync_reassembly_close(0) == SL_STATUS_OK);
+  CHECK(push(100, 0, 0, 10, SYNC_REASSEMBLY_DATA_COMPLETE) == SL_STATUS_OK);
+  CHECK(chain_count == 1 && chains[0].sync == 100);
+  CHECK(push(1, 0, 0, 10, 3) == SL_STATUS_INVALID_PARAMETER);
+  CHECK(chain_count == 1);
+}
+
+static uint32_t random_state = 12345;
+
+static uint32_t random_next(void)
+{
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return random_state;
+}
+
+// Random fragments of random syncs, with random truncations, compared with
+// what a reference model expects of every chain.
+static void test_random(void)
+{
+  uint32_t offset[RANDOM_SYNCS] = { 0 };
+  uint32_t chain[RANDOM_SYNCS] = { 0 };
+  uint32_t counts[3] = { 0 };
+
+  reset();
+  for (uint32_t n = 0; n < RANDOM_REPORTS; n++) {
+    uint16_t sync = (uint16_t)(random_next() % RANDOM_SYNCS);
+    uint16_t len = (uint16_t)(random_next() % (MAX_FRAGMENT_LEN + 1));
+    uint32_t r = random_next() % 100;
+    uint8_t status = (r < 10) ? SYNC_REASSEMBLY_DATA_COMPLETE
+                     : (r < 12) ? SYNC_REASSEMBLY_DATA_TRUNCATED
+                     : SYNC_REASSEMBLY_DATA_INCOMPLETE;
+    uint32_t before = chain_count;
+    sync_reassembly_result_t expected;
+
+    CHECK(push(sync, chain[sync], offset[sync], len, status) == SL_STATUS_OK);
+    offset[sync] += len;
+    if (status == SYNC_REASSEMBLY_DATA_INCOMPLETE) {
+      CHECK(chain_count == before);
+      continue;
+    }
+
+    if (offset[sync] > SYNC_REASSEMBLY_BUFFER_SIZE) {
+      expected = sync_reassembly_overflow;
+    } else if (status == SYNC_REASSEMBLY_DATA_COMPLETE) {
+      expected = sync_reassembly_complete;
+    } else {
+      expected = sync_reassembly_truncated;
+    }
+    CHECK(chain_count == before + 1);
+    if (chain_count == before + 1) {
+      const chain_t *c = &chains[before % (sizeof(chains) / sizeof(chains[0]))];
+
+      CHECK(c->sync == sync && c->result == expected);
+      if (expected == sync_reassembly_overflow) {
+        // Only the fragments that fitted are kept.
+        CHECK(matches(c, chain[sync], c->len));
+      } else {
+        CHECK(matches(c, chain[sync], (uint16_t)offset[sync]));
+      }
+      counts[expected]++;
+    }
+    chain[sync]++;
+    offset[sync] = 0;
+  }
+  printf("random: %lu complete, %lu truncated, %lu overflowed chains\n",
+         (unsigned long)counts[sync_reassembly_complete],
+         (unsigned long)counts[sync_reassembly_truncated],
+         (unsigned long)counts[sync_reassembly_overflow]);
+}
+
+int main(void)
+{
+  test_interleaved();
+  test_truncated();
+  test_oversized();
+  test_exhaustion();
+  test_random();
+  if (failures != 0) {
+    printf("%lu checks failed\n", (unsigned long)failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,100 @@
+/***************************************************************************//**
+ * @file eddystone.h
+ * @brief Multi-frame Eddystone beacon engine.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef EDDYSTONE_H
+#define EDDYSTONE_H
+
+#include <stdint.h>
+#include "sl_bluetooth.h"
+#include "eddystone_config.h"
+
+// TLM temperature value meaning "not supported".
+#define EDDYSTONE_TLM_TEMPERATURE_UNKNOWN  ((int16_t)0x8000)
+
+/***************************************************************************//**
+ *
+ * Precompute the URL, UID, EID and TLM frames. EDDYSTONE_URL is encoded
+ * into the URL frame.
+ *
+ * @param[in] address Identity address, used as the UID instance
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_INVALID_PARAMETER if
+ *         EDDYSTONE_URL has an unknown scheme or a character that cannot be
+ *         sent, SL_STATUS_WOULD_OVERFLOW if it is too long once encoded.
+ *         Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t eddystone_init(const bd_addr *address);
+
+/***************************************************************************//**
+ *
+ * Create the advertising set(s) and start broadcasting.
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t eddystone_start(void);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler of the engine. Must be called from
+ * sl_bt_on_event().
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ ******************************************************************************/
+void eddystone_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Advance the beacon clock. Call it once per second; it patches the TLM
+ * counters in place and rotates the EID when its period elapses.
+ *
+ ******************************************************************************/
+void eddystone_tick(void);
+
+/***************************************************************************//**
+ *
+ * Called right before each update of the TLM frame. The application can
+ * implement it to measure the battery voltage and the temperature and set
+ * them with eddystone_tlm_set_battery() and eddystone_tlm_set_temperature().
+ * The default implementation does nothing.
+ *
+ ******************************************************************************/
+void eddystone_tlm_on_update(void);
+
+/***************************************************************************//**
+ *
+ * Set the battery voltage reported in TLM frames.
+ *
+ * @param[in] millivolts Battery voltage, 0 if not supported
+ *
+ ******************************************************************************/
+void eddystone_tlm_set_battery(uint16_t millivolts);
+
+/***************************************************************************//**
+ *
+ * Set the temperature reported in TLM frames.
+ *
+ * @param[in] temperature Temperature in signed 8.8 fixed point degrees
+ *                        Celsius, EDDYSTONE_TLM_TEMPERATURE_UNKNOWN if not
+ *                        supported
+ *
+ ******************************************************************************/
+void eddystone_tlm_set_temperature(int16_t temperature);
+
+#endif // EDDYSTONE_H
@@ -0,0 +1,86 @@
+/***************************************************************************//**
+ * @file eddystone_config.h
+ * @brief Eddystone beacon configuration.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef EDDYSTONE_CONFIG_H
+#define EDDYSTONE_CONFIG_H
+
+// Frame types, used in EDDYSTONE_SCHEDULE.
+#define EDDYSTONE_FRAME_URL         0
+#define EDDYSTONE_FRAME_UID         1
+#define EDDYSTONE_FRAME_EID         2
+#define EDDYSTONE_FRAME_TLM         3
+
+// Advertised URL. It is encoded by eddystone_init(), and must start with
+// http:// or https:// and take at most 17 bytes after the scheme once the
+// common suffixes are replaced by their one-byte codes.
+#ifndef EDDYSTONE_URL
+#define EDDYSTONE_URL               "https://silabs.com"
+#endif
+
+// Calibrated TX power at 0 m, in dBm.
+#ifndef EDDYSTONE_TX_POWER_0M
+#define EDDYSTONE_TX_POWER_0M       0
+#endif
+
+// Eddystone-UID namespace (10 bytes). The 6-byte instance is taken from the
+// Bluetooth identity address.
+#define EDDYSTONE_UID_NAMESPACE     0x53, 0x69, 0x4C, 0x61, 0x62, 0x73, 0x42, 0x54, 0x53, 0x46
+
+// Eddystone-EID identity key (16 bytes) and rotation period exponent.
+// The EID changes every 2^K seconds.
+#define EDDYSTONE_EID_IDENTITY_KEY  0x9E, 0x4B, 0x1F, 0x21, 0x73, 0xC6, 0x0A, 0xD5, \
+                                    0x38, 0x44, 0xE1, 0x6F, 0x02, 0x9B, 0xA7, 0x5C
+#ifndef EDDYSTONE_EID_ROTATION_EXPONENT
+#define EDDYSTONE_EID_ROTATION_EXPONENT  10
+#endif
+
+// 1: all frames share one advertising set and take turns in time slices
+//    following EDDYSTONE_SCHEDULE.
+// 0: every frame type with a non-zero interval gets its own advertising set.
+//    Requires SL_BT_CONFIG_USER_ADVERTISERS to cover all of them.
+#ifndef EDDYSTONE_TIME_SLICE
+#define EDDYSTONE_TIME_SLICE        1
+#endif
+
+// Time slice mode: order in which frames take turns, the advertising
+// interval (units of 0.625 ms) and the number of events per slice.
+#define EDDYSTONE_SCHEDULE          EDDYSTONE_FRAME_URL, EDDYSTONE_FRAME_UID, \
+                                    EDDYSTONE_FRAME_URL, EDDYSTONE_FRAME_EID, \
+                                    EDDYSTONE_FRAME_URL, EDDYSTONE_FRAME_TLM
+#ifndef EDDYSTONE_SLICE_INTERVAL
+#define EDDYSTONE_SLICE_INTERVAL    160
+#endif
+#ifndef EDDYSTONE_EVENTS_PER_SLICE
+#define EDDYSTONE_EVENTS_PER_SLICE  5
+#endif
+
+// Separate set mode: advertising interval of each frame type, in units of
+// 0.625 ms. 0 disables the frame.
+#ifndef EDDYSTONE_URL_INTERVAL
+#define EDDYSTONE_URL_INTERVAL      160
+#endif
+#ifndef EDDYSTONE_UID_INTERVAL
+#define EDDYSTONE_UID_INTERVAL      800
+#endif
+#ifndef EDDYSTONE_EID_INTERVAL
+#define EDDYSTONE_EID_INTERVAL      800
+#endif
+#ifndef EDDYSTONE_TLM_INTERVAL
+#define EDDYSTONE_TLM_INTERVAL      1600
+#endif
+
+#endif // EDDYSTONE_CONFIG_H
@@ -20,22 +20,86 @@
 #include "gatt_db.h"
 #include "app.h"
 #include "app_log.h"
+#include "em_emu.h"
+#if defined(IADC_PRESENT)
+#include "em_cmu.h"
+#include "em_iadc.h"
+#endif
+#include "sl_sleeptimer.h"
+#include "eddystone.h"
+
+#define TICK_SIGNAL       0x1
+#define TICK_PERIOD_MS    1000
+
+#if defined(IADC_PRESENT)
+// IADC clocks, and the internal reference the supply is measured against.
+#define IADC_SRC_CLK_FREQ 20000000
+#define IADC_CLK_FREQ     10000000
+#define IADC_VREF_MV      1210
+// The IADC sees AVDD divided by 4.
+#define IADC_AVDD_DIVIDER 4
+#endif
+
+static sl_sleeptimer_timer_handle_t tick_timer;
+
+#if defined(IADC_PRESENT)
+// Set the IADC up for single conversions of the supply voltage.
+static void supply_voltage_init(void)
+{
+  IADC_Init_t init = IADC_INIT_DEFAULT;
+  IADC_AllConfigs_t all_configs = IADC_ALLCONFIGS_DEFAULT;
+  IADC_InitSingle_t init_single = IADC_INITSINGLE_DEFAULT;
+  IADC_SingleInput_t input = IADC_SINGLEINPUT_DEFAULT;
+
+  CMU_ClockEnable(cmuClock_IADC0, true);
+  CMU_ClockSelectSet(cmuClock_IADCCLK, cmuSelect_FSRCO);
+
+  init.srcClkPrescale = IADC_calcSrcClkPrescale(IADC0, IADC_SRC_CLK_FREQ, 0);
+  all_configs.configs[0].reference = iadcCfgReferenceInt1V2;
+  all_configs.configs[0].vRef = IADC_VREF_MV;
+  all_configs.configs[0].adcClkPrescale =
+    IADC_calcAdcClkPrescale(IADC0, IADC_CLK_FREQ, 0, iadcCfgModeNormal,
+                            init.srcClkPrescale);
+  input.posInput = iadcPosInputAvdd;
+  input.negInput = iadcNegInputGnd;
+
+  IADC_init(IADC0, &init, &all_configs);
+  IADC_initSingle(IADC0, &init_single, &input);
+}
+
+// Measure the supply voltage, in mV. The conversion takes a few
+// microseconds.
+static uint16_t supply_voltage_get(void)
+{
+  uint32_t sample;
+
+  IADC_command(IADC0, iadcCmdStartSingle);
+  while ((IADC_getStatus(IADC0) & IADC_STATUS_SINGLEFIFODV) == 0) {
+  }
+  sample = IADC_pullSingleFifoResult(IADC0).data;
+  return (uint16_t)(sample * IADC_AVDD_DIVIDER * IADC_VREF_MV / 0xFFF);
+}
+#endif
+
+// Called by the Eddystone engine right before each TLM frame update.
+void eddystone_tlm_on_update(void)
+{
+#if defined(IADC_PRESENT)
+  eddystone_tlm_set_battery(supply_voltage_get());
+#endif
+#if defined(_EMU_TEMP_TEMP_MASK)
+  // Temperature in 8.8 fixed point.
+  eddystone_tlm_set_temperature((int16_t)(EMU_TemperatureGet() * 256.0f));
+#endif
+}
+
+static void tick_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
 
-// The advertising set handle allocated from Bluetooth stack.
-static uint8_t advertising_set_handle = 0xff;
-
-static const uint8_t eddystone_data[] = {
-  0x03,          // Length of service list
-  0x03,          // Service list
-  0xAA, 0xFE,    // Eddystone ID
-  0x10,          // Length of service data
-  0x16,          // Service data
-  0xAA, 0xFE,    // Eddystone ID
-  0x10,          // Frame type Eddystone-URL
-  0x00,          // Tx power
-  0x01,          // 0x00=http://www., 0x01=https://www.
-  's', 'i', 'l', 'a', 'b', 's', '.', 'c', 'o', 'm'
-};
+  sl_bt_external_signal(TICK_SIGNAL);
+}
 
 /**************************************************************************//**
  * Application Init.
@@ -119,12 +183,6 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
                  "[E: 0x%04x] Failed to write attribute\n",
                  (int)sc);
 
-      // Create an advertising set.
-      sc = sl_bt_advertiser_create_set(&advertising_set_handle);
-      app_assert(sc == SL_STATUS_OK,
-                 "[E: 0x%04x] Failed to create advertising set\n",
-                 (int)sc);
-
       // Set 0 dBm Transmit Power.
       sc = sl_bt_system_set_tx_power(0, 0, &ret_min_power, &ret_max_power);
       app_assert(sc == SL_STATUS_OK,
@@ -133,36 +191,46 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       (void)ret_min_power;
       (void)ret_max_power;
 
-      // Set custom advertising data.
-      sc = sl_bt_legacy_advertiser_set_data(advertising_set_handle,
-                                            0,
-                                            sizeof(eddystone_data),
-                                            eddystone_data);
-      app_assert(sc == SL_STATUS_OK,
-                 "[E: 0x%04x] Failed to set advertiser data\n",
-                 (int)sc);
+#if defined(IADC_PRESENT)
+      // The supply voltage is reported as the battery voltage in TLM frames.
+      supply_voltage_init();
+#endif
 
-      // Set advertising parameters. 100ms advertisement interval.
-      sc = sl_bt_advertiser_set_timing(
-        advertising_set_handle,
-        160, // min. adv. interval (milliseconds * 1.6)
-        160, // max. adv. interval (milliseconds * 1.6)
-        0,   // adv. duration
-        0);  // max. num. adv. events
+      // Precompute the URL, UID, EID and TLM frames.
+      sc = eddystone_init(&address);
       app_assert(sc == SL_STATUS_OK,
-                 "[E: 0x%04x] Failed to set advertising timing\n",
+                 "[E: 0x%04x] Failed to initialize Eddystone frames\n",
                  (int)sc);
 
-      // Start advertising in user mode and disable connections.
-      sc = sl_bt_legacy_advertiser_start(
-        advertising_set_handle,
-        sl_bt_advertiser_non_connectable);
+      // Start advertising the frames, non-connectable.
+      sc = eddystone_start();
       app_assert(sc == SL_STATUS_OK,
                  "[E: 0x%04x] Failed to start advertising\n",
                  (int)sc);
+
+      // The beacon clock drives the TLM counters and the EID rotation.
+      sc = sl_sleeptimer_start_periodic_timer_ms(&tick_timer,
+                                                 TICK_PERIOD_MS,
+                                                 tick_timer_callback,
+                                                 NULL,
+                                                 0,
+                                                 0);
+      app_assert_status(sc);
       app_log("boot event - starting advertising\r\n");
       break;
 
+    // -------------------------------
+    // A time slice of the Eddystone schedule is over.
+    case sl_bt_evt_advertiser_timeout_id:
+      eddystone_on_event(evt);
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & TICK_SIGNAL) {
+        eddystone_tick();
+      }
+      break;
+
     ///////////////////////////////////////////////////////////////////////////
     // Add additional event handlers here as your application requires!      //
     ///////////////////////////////////////////////////////////////////////////
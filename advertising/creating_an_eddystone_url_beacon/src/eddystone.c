@@ -0,0 +1,438 @@
+/***************************************************************************//**
+ * @file eddystone.c
+ * @brief Multi-frame Eddystone beacon engine.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "em_common.h"
+#include "sl_bluetooth.h"
+#include "sl_sleeptimer.h"
+#include "psa/crypto.h"
+#include "eddystone.h"
+
+#define EDDYSTONE_FRAME_COUNT       4
+
+// Flags and complete list of 16-bit service UUIDs, common to all frames.
+#define EDDYSTONE_HEADER            0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE
+#define EDDYSTONE_SERVICE_DATA      0x16, 0xAA, 0xFE
+
+// Longest URL a frame can carry after the scheme.
+#define URL_MAX_LEN                 17
+
+// Offsets of the fields patched at runtime.
+#define URL_SERVICE_DATA_LEN_OFFSET 7
+#define URL_SCHEME_OFFSET           13
+#define UID_INSTANCE_OFFSET         23
+#define EID_OFFSET                  13
+#define TLM_VBATT_OFFSET            13
+#define TLM_TEMP_OFFSET             15
+#define TLM_ADV_CNT_OFFSET          17
+#define TLM_SEC_CNT_OFFSET          21
+
+// URL scheme prefixes and expansion codes of the Eddystone-URL
+// specification, indexed by their code. A prefix of another one comes after
+// it, so that the longest match is found first.
+static const char *const url_schemes[] = {
+  "http://www.", "https://www.", "http://", "https://"
+};
+static const char *const url_suffixes[] = {
+  ".com/", ".org/", ".edu/", ".net/", ".info/", ".biz/", ".gov/",
+  ".com", ".org", ".edu", ".net", ".info", ".biz", ".gov"
+};
+
+// All frames are laid out at build time; only the marked fields are patched.
+static uint8_t url_frame[URL_SCHEME_OFFSET + 1 + URL_MAX_LEN] = {
+  EDDYSTONE_HEADER,
+  0,                              // Length of service data, set with the URL
+  EDDYSTONE_SERVICE_DATA,
+  0x10,                           // Frame type Eddystone-URL
+  (uint8_t)EDDYSTONE_TX_POWER_0M,
+  // Scheme and URL, encoded by eddystone_init()
+};
+
+static uint8_t uid_frame[] = {
+  EDDYSTONE_HEADER,
+  0x17,                           // Length of service data
+  EDDYSTONE_SERVICE_DATA,
+  0x00,                           // Frame type Eddystone-UID
+  (uint8_t)EDDYSTONE_TX_POWER_0M,
+  EDDYSTONE_UID_NAMESPACE,
+  0, 0, 0, 0, 0, 0,               // Instance, patched by eddystone_init()
+  0, 0                            // Reserved
+};
+
+static uint8_t eid_frame[] = {
+  EDDYSTONE_HEADER,
+  0x0D,                           // Length of service data
+  EDDYSTONE_SERVICE_DATA,
+  0x30,                           // Frame type Eddystone-EID
+  (uint8_t)EDDYSTONE_TX_POWER_0M,
+  0, 0, 0, 0, 0, 0, 0, 0          // Ephemeral ID, patched on rotation
+};
+
+static uint8_t tlm_frame[] = {
+  EDDYSTONE_HEADER,
+  0x11,                           // Length of service data
+  EDDYSTONE_SERVICE_DATA,
+  0x20,                           // Frame type Eddystone-TLM
+  0x00,                           // Unencrypted TLM version
+  0x00, 0x00,                     // Battery voltage [mV]
+  0x80, 0x00,                     // Temperature, 8.8 fixed point
+  0x00, 0x00, 0x00, 0x00,         // Advertising PDU count
+  0x00, 0x00, 0x00, 0x00          // Time since power-on [0.1 s]
+};
+
+// The length of the URL frame is set when the URL is encoded.
+static struct {
+  const uint8_t *data;
+  uint8_t len;
+  uint16_t interval;
+} frames[EDDYSTONE_FRAME_COUNT] = {
+  [EDDYSTONE_FRAME_URL] = { url_frame, sizeof(url_frame), EDDYSTONE_URL_INTERVAL },
+  [EDDYSTONE_FRAME_UID] = { uid_frame, sizeof(uid_frame), EDDYSTONE_UID_INTERVAL },
+  [EDDYSTONE_FRAME_EID] = { eid_frame, sizeof(eid_frame), EDDYSTONE_EID_INTERVAL },
+  [EDDYSTONE_FRAME_TLM] = { tlm_frame, sizeof(tlm_frame), EDDYSTONE_TLM_INTERVAL },
+};
+
+static const uint8_t eid_identity_key[16] = { EDDYSTONE_EID_IDENTITY_KEY };
+
+#if EDDYSTONE_TIME_SLICE
+static const uint8_t schedule[] = { EDDYSTONE_SCHEDULE };
+static uint8_t schedule_index = 0;
+static uint8_t advertising_set_handle = SL_BT_INVALID_ADVERTISING_SET_HANDLE;
+static uint32_t slices_sent = 0;
+#else
+static uint8_t advertising_set_handles[EDDYSTONE_FRAME_COUNT];
+#endif
+
+static uint64_t start_tick = 0;
+static uint32_t eid_period = UINT32_MAX;
+
+static void put_be16(uint8_t *dst, uint16_t value)
+{
+  dst[0] = (uint8_t)(value >> 8);
+  dst[1] = (uint8_t)value;
+}
+
+static void put_be32(uint8_t *dst, uint32_t value)
+{
+  dst[0] = (uint8_t)(value >> 24);
+  dst[1] = (uint8_t)(value >> 16);
+  dst[2] = (uint8_t)(value >> 8);
+  dst[3] = (uint8_t)value;
+}
+
+static uint32_t uptime_ms(void)
+{
+  uint64_t ms = 0;
+
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64() - start_tick, &ms);
+  return (uint32_t)ms;
+}
+
+static sl_status_t aes128_ecb_encrypt(const uint8_t key[16],
+                                      const uint8_t input[16],
+                                      uint8_t output[16])
+{
+  psa_key_attributes_t attributes = PSA_KEY_ATTRIBUTES_INIT;
+  psa_key_id_t key_id;
+  psa_status_t status;
+  size_t output_len;
+
+  psa_set_key_type(&attributes, PSA_KEY_TYPE_AES);
+  psa_set_key_bits(&attributes, 128);
+  psa_set_key_usage_flags(&attributes, PSA_KEY_USAGE_ENCRYPT);
+  psa_set_key_algorithm(&attributes, PSA_ALG_ECB_NO_PADDING);
+  status = psa_import_key(&attributes, key, 16, &key_id);
+  if (status != PSA_SUCCESS) {
+    return SL_STATUS_FAIL;
+  }
+  status = psa_cipher_encrypt(key_id, PSA_ALG_ECB_NO_PADDING,
+                              input, 16, output, 16, &output_len);
+  psa_destroy_key(key_id);
+  return (status == PSA_SUCCESS) ? SL_STATUS_OK : SL_STATUS_FAIL;
+}
+
+/***************************************************************************//**
+ * Compute the ephemeral ID for the given beacon time, as defined by the
+ * Eddystone-EID specification.
+ ******************************************************************************/
+static sl_status_t compute_eid(uint32_t time, uint8_t eid[8])
+{
+  uint8_t block[16] = { 0 };
+  uint8_t temporary_key[16];
+  uint8_t output[16];
+  sl_status_t sc;
+
+  block[11] = 0xFF;
+  block[14] = (uint8_t)(time >> 24);
+  block[15] = (uint8_t)(time >> 16);
+  sc = aes128_ecb_encrypt(eid_identity_key, block, temporary_key);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+
+  time &= ~((1UL << EDDYSTONE_EID_ROTATION_EXPONENT) - 1);
+  memset(block, 0, sizeof(block));
+  block[11] = EDDYSTONE_EID_ROTATION_EXPONENT;
+  put_be32(&block[12], time);
+  sc = aes128_ecb_encrypt(temporary_key, block, output);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  memcpy(eid, output, 8);
+  return SL_STATUS_OK;
+}
+
+// Advertising events sent since start.
+static uint32_t adv_count(void)
+{
+#if EDDYSTONE_TIME_SLICE
+  return slices_sent * EDDYSTONE_EVENTS_PER_SLICE;
+#else
+  // Estimated from the nominal interval of each set.
+  uint32_t elapsed = uptime_ms();
+  uint32_t count = 0;
+
+  for (uint8_t i = 0; i < EDDYSTONE_FRAME_COUNT; i++) {
+    if (frames[i].interval != 0) {
+      count += (uint32_t)(((uint64_t)elapsed * 8) / (frames[i].interval * 5));
+    }
+  }
+  return count;
+#endif
+}
+
+// Refresh the TLM counters in place, after the application has updated the
+// measured fields.
+static void patch_tlm(void)
+{
+  eddystone_tlm_on_update();
+  put_be32(&tlm_frame[TLM_ADV_CNT_OFFSET], adv_count());
+  put_be32(&tlm_frame[TLM_SEC_CNT_OFFSET], uptime_ms() / 100);
+}
+
+static sl_status_t set_frame_data(uint8_t handle, uint8_t frame)
+{
+  return sl_bt_legacy_advertiser_set_data(handle,
+                                          sl_bt_advertiser_advertising_data_packet,
+                                          frames[frame].len,
+                                          frames[frame].data);
+}
+
+#if EDDYSTONE_TIME_SLICE
+static sl_status_t start_slice(void)
+{
+  sl_status_t sc;
+  uint8_t frame = schedule[schedule_index];
+
+  if (frame == EDDYSTONE_FRAME_TLM) {
+    patch_tlm();
+  }
+  sc = set_frame_data(advertising_set_handle, frame);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  return sl_bt_legacy_advertiser_start(advertising_set_handle,
+                                       sl_bt_legacy_advertiser_non_connectable);
+}
+#endif
+
+// Match one of the strings of a table at the start of the URL. Returns its
+// index, or count if none matches.
+static uint8_t match_url_code(const char *url,
+                              const char *const *table,
+                              uint8_t count,
+                              size_t *match_len)
+{
+  for (uint8_t code = 0; code < count; code++) {
+    *match_len = strlen(table[code]);
+    if (strncmp(url, table[code], *match_len) == 0) {
+      return code;
+    }
+  }
+  return count;
+}
+
+// Encode the URL into the URL frame, replacing the scheme and the common
+// suffixes by their one-byte codes.
+static sl_status_t encode_url(const char *url)
+{
+  uint8_t *out = &url_frame[URL_SCHEME_OFFSET];
+  const uint8_t scheme_count = sizeof(url_schemes) / sizeof(url_schemes[0]);
+  const uint8_t suffix_count = sizeof(url_suffixes) / sizeof(url_suffixes[0]);
+  uint8_t len = 0;
+  size_t match_len;
+  uint8_t code;
+
+  code = match_url_code(url, url_schemes, scheme_count, &match_len);
+  if (code == scheme_count) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  *out++ = code;
+  url += match_len;
+
+  while (*url != '\0') {
+    if (len == URL_MAX_LEN) {
+      return SL_STATUS_WOULD_OVERFLOW;
+    }
+    code = match_url_code(url, url_suffixes, suffix_count, &match_len);
+    if (code < suffix_count) {
+      url += match_len;
+    } else if (*url > ' ' && *url < 0x7F) {
+      // Other characters are sent as they are. The codes below 0x21 and
+      // above 0x7E are reserved.
+      code = (uint8_t)*url++;
+    } else {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    out[len++] = code;
+  }
+
+  url_frame[URL_SERVICE_DATA_LEN_OFFSET] = 6 + len;
+  frames[EDDYSTONE_FRAME_URL].len = URL_SCHEME_OFFSET + 1 + len;
+  return SL_STATUS_OK;
+}
+
+sl_status_t eddystone_init(const bd_addr *address)
+{
+  sl_status_t sc;
+
+  sc = encode_url(EDDYSTONE_URL);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+
+  // The instance is the identity address, most significant byte first.
+  for (uint8_t i = 0; i < 6; i++) {
+    uid_frame[UID_INSTANCE_OFFSET + i] = address->addr[5 - i];
+  }
+
+  start_tick = sl_sleeptimer_get_tick_count64();
+  eid_period = 0;
+  if (psa_crypto_init() != PSA_SUCCESS) {
+    return SL_STATUS_FAIL;
+  }
+  return compute_eid(0, &eid_frame[EID_OFFSET]);
+}
+
+sl_status_t eddystone_start(void)
+{
+  sl_status_t sc;
+
+#if EDDYSTONE_TIME_SLICE
+  sc = sl_bt_advertiser_create_set(&advertising_set_handle);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  // Every slice stops after EDDYSTONE_EVENTS_PER_SLICE events.
+  sc = sl_bt_advertiser_set_timing(advertising_set_handle,
+                                   EDDYSTONE_SLICE_INTERVAL,
+                                   EDDYSTONE_SLICE_INTERVAL,
+                                   0,
+                                   EDDYSTONE_EVENTS_PER_SLICE);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  schedule_index = 0;
+  slices_sent = 0;
+  return start_slice();
+#else
+  for (uint8_t i = 0; i < EDDYSTONE_FRAME_COUNT; i++) {
+    advertising_set_handles[i] = SL_BT_INVALID_ADVERTISING_SET_HANDLE;
+    if (frames[i].interval == 0) {
+      continue;
+    }
+    sc = sl_bt_advertiser_create_set(&advertising_set_handles[i]);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+    sc = sl_bt_advertiser_set_timing(advertising_set_handles[i],
+                                     frames[i].interval,
+                                     frames[i].interval,
+                                     0,
+                                     0);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+    sc = set_frame_data(advertising_set_handles[i], i);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+    sc = sl_bt_legacy_advertiser_start(advertising_set_handles[i],
+                                       sl_bt_legacy_advertiser_non_connectable);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+  }
+  return SL_STATUS_OK;
+#endif
+}
+
+void eddystone_on_event(sl_bt_msg_t *evt)
+{
+#if EDDYSTONE_TIME_SLICE
+  if (SL_BT_MSG_ID(evt->header) == sl_bt_evt_advertiser_timeout_id
+      && evt->data.evt_advertiser_timeout.handle == advertising_set_handle) {
+    // The slice is over, hand the set to the next frame of the schedule.
+    slices_sent++;
+    schedule_index = (schedule_index + 1) % sizeof(schedule);
+    start_slice();
+  }
+#else
+  (void)evt;
+#endif
+}
+
+void eddystone_tick(void)
+{
+  uint32_t seconds = uptime_ms() / 1000;
+
+  if ((seconds >> EDDYSTONE_EID_ROTATION_EXPONENT) != eid_period) {
+    eid_period = seconds >> EDDYSTONE_EID_ROTATION_EXPONENT;
+    if (compute_eid(seconds, &eid_frame[EID_OFFSET]) == SL_STATUS_OK) {
+#if !EDDYSTONE_TIME_SLICE
+      if (advertising_set_handles[EDDYSTONE_FRAME_EID]
+          != SL_BT_INVALID_ADVERTISING_SET_HANDLE) {
+        set_frame_data(advertising_set_handles[EDDYSTONE_FRAME_EID],
+                       EDDYSTONE_FRAME_EID);
+      }
+#endif
+    }
+  }
+
+#if !EDDYSTONE_TIME_SLICE
+  // A dedicated TLM set is refreshed in place while it keeps running.
+  if (advertising_set_handles[EDDYSTONE_FRAME_TLM]
+      != SL_BT_INVALID_ADVERTISING_SET_HANDLE) {
+    patch_tlm();
+    set_frame_data(advertising_set_handles[EDDYSTONE_FRAME_TLM],
+                   EDDYSTONE_FRAME_TLM);
+  }
+#endif
+}
+
+SL_WEAK void eddystone_tlm_on_update(void)
+{
+}
+
+void eddystone_tlm_set_battery(uint16_t millivolts)
+{
+  put_be16(&tlm_frame[TLM_VBATT_OFFSET], millivolts);
+}
+
+void eddystone_tlm_set_temperature(int16_t temperature)
+{
+  put_be16(&tlm_frame[TLM_TEMP_OFFSET], (uint16_t)temperature);
+}
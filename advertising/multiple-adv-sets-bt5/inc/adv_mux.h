@@ -0,0 +1,160 @@
+/***************************************************************************//**
+ * @file adv_mux.h
+ * @brief Logical advertising set multiplexer.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef ADV_MUX_H
+#define ADV_MUX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Maximum number of logical advertising sets.
+#ifndef ADV_MUX_MAX_LOGICAL_SETS
+#define ADV_MUX_MAX_LOGICAL_SETS    20
+#endif
+
+// Number of stack advertising sets the logical sets are rotated over.
+// Must leave room for other sets within SL_BT_CONFIG_USER_ADVERTISERS.
+#ifndef ADV_MUX_PHYSICAL_SETS
+#define ADV_MUX_PHYSICAL_SETS       2
+#endif
+
+// Advertising interval of a physical set while a logical set has its turn,
+// in units of 0.625 ms.
+#ifndef ADV_MUX_SLOT_INTERVAL
+#define ADV_MUX_SLOT_INTERVAL       160
+#endif
+
+// Number of advertising events a logical set sends per turn.
+#ifndef ADV_MUX_EVENTS_PER_TURN
+#define ADV_MUX_EVENTS_PER_TURN     3
+#endif
+
+// Delay before a physical set left idle by failed starts is tried again.
+#ifndef ADV_MUX_RETRY_MS
+#define ADV_MUX_RETRY_MS            100
+#endif
+
+// External signal used by the retry timer. Must not collide with the signals
+// of the application.
+#ifndef ADV_MUX_SIGNAL
+#define ADV_MUX_SIGNAL              0x80
+#endif
+
+// Legacy advertising payload size.
+#define ADV_MUX_MAX_DATA_LEN        31
+
+#define ADV_MUX_INVALID_ID          0xFF
+
+/***************************************************************************//**
+ * @brief Configuration of a logical advertising set
+ ******************************************************************************/
+typedef struct {
+  uint32_t target_interval_ms; // Desired interval between advertising events
+  uint8_t weight;              // Share of airtime when the schedule is overloaded
+  int16_t tx_power;            // TX power in units of 0.1 dBm
+  uint8_t len;                 // Length of data
+  const uint8_t *data;         // Advertising payload, copied on add
+} adv_mux_set_config_t;
+
+/***************************************************************************//**
+ * @brief Scheduling statistics of a logical advertising set
+ ******************************************************************************/
+typedef struct {
+  uint32_t turns;                // Number of turns the set has had
+  uint32_t events;               // Advertising events sent
+  uint32_t failures;             // Turns the stack refused to start
+  uint32_t achieved_interval_ms; // Mean interval between advertising events
+  int16_t tx_power;              // TX power selected by the stack
+} adv_mux_stats_t;
+
+/***************************************************************************//**
+ *
+ * Clear all logical sets.
+ *
+ ******************************************************************************/
+void adv_mux_init(void);
+
+/***************************************************************************//**
+ *
+ * Register a logical advertising set.
+ *
+ * SL_STATUS_NO_MORE_RESOURCE will be returned if ADV_MUX_MAX_LOGICAL_SETS are
+ * already in use, SL_STATUS_INVALID_PARAMETER if the payload is too long or
+ * the interval or weight is zero.
+ *
+ * @param[in] config Set configuration
+ * @param[out] id Identifier of the new logical set
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t adv_mux_add_set(const adv_mux_set_config_t *config, uint8_t *id);
+
+/***************************************************************************//**
+ *
+ * Replace the payload of a logical set. If the set currently has its turn,
+ * the new payload is pushed to the stack immediately.
+ *
+ * @param[in] id Logical set identifier
+ * @param[in] len Length of @p data
+ * @param[in] data New payload
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t adv_mux_set_data(uint8_t id, uint8_t len, const uint8_t *data);
+
+/***************************************************************************//**
+ *
+ * Create the physical advertising sets and start the rotation.
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t adv_mux_start(void);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler of the multiplexer. Must be called from
+ * sl_bt_on_event() with the advertiser timeout and external signal events.
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ ******************************************************************************/
+void adv_mux_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Retrieve the scheduling statistics of a logical set.
+ *
+ * @param[in] id Logical set identifier
+ * @param[out] stats Statistics of the set
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_INVALID_INDEX otherwise.
+ *
+ ******************************************************************************/
+sl_status_t adv_mux_get_stats(uint8_t id, adv_mux_stats_t *stats);
+
+/***************************************************************************//**
+ *
+ * Retrieve the number of registered logical sets.
+ *
+ ******************************************************************************/
+uint8_t adv_mux_get_set_count(void);
+
+#endif // ADV_MUX_H
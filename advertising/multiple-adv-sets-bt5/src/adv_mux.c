@@ -0,0 +1,321 @@
+/***************************************************************************//**
+ * @file adv_mux.c
+ * @brief Logical advertising set multiplexer.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "sl_bluetooth.h"
+#include "sl_sleeptimer.h"
+#include "adv_mux.h"
+
+typedef struct {
+  uint8_t data[ADV_MUX_MAX_DATA_LEN];
+  uint8_t len;
+  uint8_t weight;
+  int16_t tx_power;
+  int16_t set_power;
+  uint32_t target_interval_ms;
+  uint32_t start_ms;
+  uint32_t turns;
+  uint32_t events;
+  uint32_t failures;
+  bool active;
+} logical_set_t;
+
+typedef struct {
+  uint8_t handle;
+  uint8_t current; // Logical set having its turn, ADV_MUX_INVALID_ID if idle
+} physical_set_t;
+
+static logical_set_t logical_sets[ADV_MUX_MAX_LOGICAL_SETS];
+static uint8_t logical_set_count = 0;
+static physical_set_t physical_sets[ADV_MUX_PHYSICAL_SETS];
+static bool running = false;
+static sl_sleeptimer_timer_handle_t retry_timer;
+
+static uint32_t now_ms(void)
+{
+  uint64_t ms = 0;
+
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+  return (uint32_t)ms;
+}
+
+/***************************************************************************//**
+ * Pick the logical set that is furthest behind its target.
+ *
+ * Each set is owed (elapsed / target_interval) advertising events since it
+ * was started. The set with the largest weighted deficit, that is not
+ * currently on air, gets the next turn. When the schedule is overloaded the
+ * airtime is shared in proportion to the weights; spare airtime is handed to
+ * the sets that are least ahead of their target.
+ ******************************************************************************/
+static uint8_t select_next_set(uint32_t now)
+{
+  uint8_t best = ADV_MUX_INVALID_ID;
+  int64_t best_score = INT64_MIN;
+
+  for (uint8_t i = 0; i < logical_set_count; i++) {
+    logical_set_t *set = &logical_sets[i];
+    int64_t owed_milli;
+    int64_t score;
+
+    if (set->active) {
+      continue;
+    }
+    owed_milli = ((int64_t)(uint32_t)(now - set->start_ms) * 1000)
+                 / set->target_interval_ms;
+    score = owed_milli - (int64_t)set->events * 1000;
+    // Weights favour a set both when it is behind and when it is ahead.
+    score = (score >= 0) ? score * set->weight : score / set->weight;
+    if (score > best_score) {
+      best_score = score;
+      best = i;
+    }
+  }
+  return best;
+}
+
+// Load the payload of a logical set into a physical set and start it.
+static sl_status_t start_turn(physical_set_t *phy, uint8_t id)
+{
+  sl_status_t sc;
+  logical_set_t *set = &logical_sets[id];
+
+  sc = sl_bt_legacy_advertiser_set_data(phy->handle,
+                                        sl_bt_advertiser_advertising_data_packet,
+                                        set->len,
+                                        set->data);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  sc = sl_bt_advertiser_set_tx_power(phy->handle, set->tx_power, &set->set_power);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  sc = sl_bt_advertiser_set_timing(phy->handle,
+                                   ADV_MUX_SLOT_INTERVAL,
+                                   ADV_MUX_SLOT_INTERVAL,
+                                   0,
+                                   ADV_MUX_EVENTS_PER_TURN);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  sc = sl_bt_legacy_advertiser_start(phy->handle,
+                                     sl_bt_legacy_advertiser_non_connectable);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  set->active = true;
+  phy->current = id;
+  return SL_STATUS_OK;
+}
+
+static void retry_timer_callback(sl_sleeptimer_timer_handle_t *handle,
+                                 void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(ADV_MUX_SIGNAL);
+}
+
+// Close the turn of the current logical set and hand the physical set over.
+// A set the stack refuses to start is passed over for the next one in line.
+// If none can be started, the physical set stays idle and is tried again
+// after ADV_MUX_RETRY_MS, as no timeout event would ever come for it.
+static void rotate(physical_set_t *phy)
+{
+  uint8_t failed[ADV_MUX_MAX_LOGICAL_SETS];
+  uint8_t failed_count = 0;
+  uint32_t now = now_ms();
+  uint8_t next;
+
+  if (phy->current != ADV_MUX_INVALID_ID) {
+    logical_sets[phy->current].active = false;
+    logical_sets[phy->current].turns++;
+    logical_sets[phy->current].events += ADV_MUX_EVENTS_PER_TURN;
+    phy->current = ADV_MUX_INVALID_ID;
+  }
+
+  while ((next = select_next_set(now)) != ADV_MUX_INVALID_ID) {
+    if (start_turn(phy, next) == SL_STATUS_OK) {
+      break;
+    }
+    logical_sets[next].failures++;
+    // Marked active so that select_next_set() passes over it this time.
+    logical_sets[next].active = true;
+    failed[failed_count++] = next;
+  }
+  for (uint8_t i = 0; i < failed_count; i++) {
+    logical_sets[failed[i]].active = false;
+  }
+
+  if (phy->current == ADV_MUX_INVALID_ID && failed_count > 0) {
+    sl_sleeptimer_restart_timer_ms(&retry_timer,
+                                   ADV_MUX_RETRY_MS,
+                                   retry_timer_callback,
+                                   NULL,
+                                   0,
+                                   0);
+  }
+}
+
+void adv_mux_init(void)
+{
+  memset(logical_sets, 0, sizeof(logical_sets));
+  logical_set_count = 0;
+  for (uint8_t i = 0; i < ADV_MUX_PHYSICAL_SETS; i++) {
+    physical_sets[i].handle = SL_BT_INVALID_ADVERTISING_SET_HANDLE;
+    physical_sets[i].current = ADV_MUX_INVALID_ID;
+  }
+  running = false;
+}
+
+sl_status_t adv_mux_add_set(const adv_mux_set_config_t *config, uint8_t *id)
+{
+  logical_set_t *set;
+
+  if (logical_set_count >= ADV_MUX_MAX_LOGICAL_SETS) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  if (config->len > ADV_MUX_MAX_DATA_LEN
+      || config->target_interval_ms == 0
+      || config->weight == 0) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  set = &logical_sets[logical_set_count];
+  memcpy(set->data, config->data, config->len);
+  set->len = config->len;
+  set->weight = config->weight;
+  set->tx_power = config->tx_power;
+  set->set_power = config->tx_power;
+  set->target_interval_ms = config->target_interval_ms;
+  set->start_ms = now_ms();
+  *id = logical_set_count++;
+
+  // A set added while running may find an idle physical set.
+  if (running) {
+    for (uint8_t i = 0; i < ADV_MUX_PHYSICAL_SETS; i++) {
+      if (physical_sets[i].current == ADV_MUX_INVALID_ID) {
+        rotate(&physical_sets[i]);
+        break;
+      }
+    }
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t adv_mux_set_data(uint8_t id, uint8_t len, const uint8_t *data)
+{
+  if (id >= logical_set_count) {
+    return SL_STATUS_INVALID_INDEX;
+  }
+  if (len > ADV_MUX_MAX_DATA_LEN) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  memcpy(logical_sets[id].data, data, len);
+  logical_sets[id].len = len;
+
+  if (logical_sets[id].active) {
+    for (uint8_t i = 0; i < ADV_MUX_PHYSICAL_SETS; i++) {
+      if (physical_sets[i].current == id) {
+        return sl_bt_legacy_advertiser_set_data(physical_sets[i].handle,
+                                                sl_bt_advertiser_advertising_data_packet,
+                                                len,
+                                                data);
+      }
+    }
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t adv_mux_start(void)
+{
+  sl_status_t sc;
+  uint32_t now = now_ms();
+
+  for (uint8_t i = 0; i < logical_set_count; i++) {
+    logical_sets[i].start_ms = now;
+  }
+
+  for (uint8_t i = 0; i < ADV_MUX_PHYSICAL_SETS; i++) {
+    sc = sl_bt_advertiser_create_set(&physical_sets[i].handle);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+  }
+
+  running = true;
+  for (uint8_t i = 0; i < ADV_MUX_PHYSICAL_SETS; i++) {
+    rotate(&physical_sets[i]);
+  }
+  return SL_STATUS_OK;
+}
+
+void adv_mux_on_event(sl_bt_msg_t *evt)
+{
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_advertiser_timeout_id:
+      // The physical set sent all events of the turn and stopped.
+      for (uint8_t i = 0; i < ADV_MUX_PHYSICAL_SETS; i++) {
+        if (physical_sets[i].handle == evt->data.evt_advertiser_timeout.handle) {
+          rotate(&physical_sets[i]);
+          break;
+        }
+      }
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      if (!running
+          || !(evt->data.evt_system_external_signal.extsignals & ADV_MUX_SIGNAL)) {
+        break;
+      }
+      // Try again the physical sets left idle by failed starts.
+      for (uint8_t i = 0; i < ADV_MUX_PHYSICAL_SETS; i++) {
+        if (physical_sets[i].current == ADV_MUX_INVALID_ID) {
+          rotate(&physical_sets[i]);
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+sl_status_t adv_mux_get_stats(uint8_t id, adv_mux_stats_t *stats)
+{
+  logical_set_t *set;
+
+  if (id >= logical_set_count) {
+    return SL_STATUS_INVALID_INDEX;
+  }
+
+  set = &logical_sets[id];
+  stats->turns = set->turns;
+  stats->events = set->events;
+  stats->failures = set->failures;
+  stats->achieved_interval_ms = set->events
+                                ? (now_ms() - set->start_ms) / set->events
+                                : 0;
+  stats->tx_power = set->set_power;
+  return SL_STATUS_OK;
+}
+
+uint8_t adv_mux_get_set_count(void)
+{
+  return logical_set_count;
+}
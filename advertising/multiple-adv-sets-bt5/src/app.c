@@ -21,14 +21,21 @@
 #include "app.h"
 #include "app_log.h"
 #include "sl_simple_led_instances.h"
+#include "sl_sleeptimer.h"
+#include "adv_mux.h"
 
 #define UINT16_TO_BYTES(n) ((uint8_t)(n)), ((uint8_t)((n) >> 8))
 #define UINT16_TO_BYTE0(n) ((uint8_t)(n))
 #define UINT16_TO_BYTE1(n) ((uint8_t)((n) >> 8))
+#define STATS_SIGNAL            0x1
+#define STATS_PERIOD_MS         10000
+#define SERVICE_BEACON_COUNT    8
 // The advertising set handle allocated from Bluetooth stack.
-static uint8_t handle_ibeacon;
 static uint8_t handle_demo;
+static sl_sleeptimer_timer_handle_t stats_timer;
 void bcnSetupAdvBeaconing(void);
+static void stats_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void log_adv_mux_stats(void);
 /**************************************************************************/ /**
  * Application Init.
  *****************************************************************************/
@@ -140,7 +147,16 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_log("\r\nFirst connectable advertising set started.\r\n");
       app_log("  Conected-> LED0 ON else LED0->OFF\r\n");
       bcnSetupAdvBeaconing();
-      app_log("\r\nSecond non-connectable advertising set started.\r\n");
+      app_log("\r\n%d logical beacon sets rotating over %d advertising sets.\r\n",
+              adv_mux_get_set_count(),
+              ADV_MUX_PHYSICAL_SETS);
+      sc = sl_sleeptimer_start_periodic_timer_ms(&stats_timer,
+                                                 STATS_PERIOD_MS,
+                                                 stats_timer_callback,
+                                                 NULL,
+                                                 0,
+                                                 0);
+      app_assert_status(sc);
       break;
 
     // -------------------------------
@@ -170,6 +186,19 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
                  (int)sc);
       break;
 
+    // -------------------------------
+    // A logical beacon set finished its turn.
+    case sl_bt_evt_advertiser_timeout_id:
+      adv_mux_on_event(evt);
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      adv_mux_on_event(evt);
+      if (evt->data.evt_system_external_signal.extsignals & STATS_SIGNAL) {
+        log_adv_mux_stats();
+      }
+      break;
+
     ///////////////////////////////////////////////////////////////////////////
     // Add additional event handlers here as your application requires!      //
     ///////////////////////////////////////////////////////////////////////////
@@ -184,8 +213,10 @@ void bcnSetupAdvBeaconing(void)
 {
   sl_status_t sc;
 
-  /* This function sets up a custom advertisement package according to iBeacon specifications.
-   * The advertisement package is 30 bytes long. See the iBeacon specification for further details.
+  /* This function registers a number of logical beacon sets with the advertising
+   * set multiplexer, which rotates them over a few physical advertising sets.
+   * The first one is an iBeacon package; it is 30 bytes long. See the iBeacon
+   * specification for further details.
    */
 
   static struct {
@@ -235,38 +266,101 @@ void bcnSetupAdvBeaconing(void)
     0xC3
   };
 
-  //
-  uint8_t len = sizeof(bcnBeaconAdvData);
-  uint8_t *pData = (uint8_t *)(&bcnBeaconAdvData);
+  /* Eddystone-URL frame for https://www.silabs.com */
+  static const uint8_t eddystone_url[] = {
+    0x02, 0x01, 0x06,             /* Flags */
+    0x03, 0x03, 0xAA, 0xFE,       /* Complete list of 16-bit UUIDs: Eddystone */
+    0x0D, 0x16, 0xAA, 0xFE,       /* Service data: Eddystone */
+    0x10,                         /* Frame type: URL */
+    0x00,                         /* TX power at 0 m */
+    0x03,                         /* URL scheme: https:// */
+    's', 'i', 'l', 'a', 'b', 's',
+    0x07                          /* .com */
+  };
 
-  /* Set custom advertising data */
-  sc = sl_bt_advertiser_create_set(&handle_ibeacon);
-  app_assert(sc == SL_STATUS_OK,
-             "[E: 0x%04x] Failed to create advertising set\n",
-             (int)sc);
+  /* Manufacturer specific data, 0x02FF = Silicon Labs */
+  static const uint8_t manufacturer_data[] = {
+    0x02, 0x01, 0x06,
+    0x07, 0xFF, UINT16_TO_BYTES(0x02FF), 'D', 'E', 'M', 'O'
+  };
 
-  sl_bt_extended_advertiser_set_data(handle_ibeacon, len, pData);
-  app_assert(sc == SL_STATUS_OK,
-             "[E: 0x%04x] Failed to set user-defined data\n",
-             (int)sc);
+  /* Service beacons carrying one byte of service data each */
+  uint8_t service_beacon[] = {
+    0x02, 0x01, 0x06,
+    0x04, 0x16, UINT16_TO_BYTES(0x181A), 0x00
+  };
 
-  /* Set 8 dBm Transmit Power */
-  sl_bt_advertiser_set_tx_power(handle_ibeacon, 80, NULL);
-  app_assert(sc == SL_STATUS_OK,
-             "[E: 0x%04x] Failed to limit the maximum advertising TX power\n",
-             (int)sc);
+  adv_mux_set_config_t config;
+  uint8_t id;
+
+  adv_mux_init();
+
+  /* iBeacon, 200 ms, 8 dBm */
+  config.target_interval_ms = 200;
+  config.weight = 4;
+  config.tx_power = 80;
+  config.len = sizeof(bcnBeaconAdvData);
+  config.data = (const uint8_t *)&bcnBeaconAdvData;
+  sc = adv_mux_add_set(&config, &id);
+  app_assert_status(sc);
+
+  /* Eddystone-URL, 500 ms, 0 dBm */
+  config.target_interval_ms = 500;
+  config.weight = 2;
+  config.tx_power = 0;
+  config.len = sizeof(eddystone_url);
+  config.data = eddystone_url;
+  sc = adv_mux_add_set(&config, &id);
+  app_assert_status(sc);
+
+  /* Manufacturer data, 1 s, 0 dBm */
+  config.target_interval_ms = 1000;
+  config.weight = 1;
+  config.len = sizeof(manufacturer_data);
+  config.data = manufacturer_data;
+  sc = adv_mux_add_set(&config, &id);
+  app_assert_status(sc);
+
+  /* Service beacons, 2 s, -10 dBm */
+  config.target_interval_ms = 2000;
+  config.tx_power = -100;
+  config.len = sizeof(service_beacon);
+  config.data = service_beacon;
+  for (uint8_t i = 0; i < SERVICE_BEACON_COUNT; i++) {
+    service_beacon[sizeof(service_beacon) - 1] = i;
+    sc = adv_mux_add_set(&config, &id);
+    app_assert_status(sc);
+  }
 
-  /* Set advertising parameters. 200ms (320/1.6) advertisement interval. All channels used.
-   * The first two parameters are minimum and maximum advertising interval, both in
-   * units of (milliseconds * 1.6).  */
-  sc = sl_bt_advertiser_set_timing(handle_ibeacon, 320, 320, 0, 0);
+  /* Start rotating the logical sets */
+  sc = adv_mux_start();
   app_assert(sc == SL_STATUS_OK,
-             "[E: 0x%04x] Failed to set advertising timing\n",
+             "[E: 0x%04x] Failed to start advertising set multiplexer\n",
              (int)sc);
+}
 
-  /* Start advertising in user mode */
-  sc = sl_bt_extended_advertiser_start(handle_ibeacon, sl_bt_advertiser_non_connectable, 0);
-  app_assert(sc == SL_STATUS_OK,
-             "[E: 0x%04x] Failed to start advertising\n",
-             (int)sc);
+static void stats_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  sl_bt_external_signal(STATS_SIGNAL);
+}
+
+static void log_adv_mux_stats(void)
+{
+  adv_mux_stats_t stats;
+
+  app_log("\r\nset  turns  events  interval[ms]  tx[0.1dBm]  failures\r\n");
+  for (uint8_t i = 0; i < adv_mux_get_set_count(); i++) {
+    if (adv_mux_get_stats(i, &stats) == SL_STATUS_OK) {
+      app_log("%3d  %5lu  %6lu  %12lu  %10d  %8lu\r\n",
+              i,
+              (unsigned long)stats.turns,
+              (unsigned long)stats.events,
+              (unsigned long)stats.achieved_interval_ms,
+              stats.tx_power,
+              (unsigned long)stats.failures);
+    }
+  }
 }
@@ -0,0 +1,137 @@
+/***************************************************************************//**
+ * @file pa_update.h
+ * @brief Periodic advertising data update scheduler.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef PA_UPDATE_H
+#define PA_UPDATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Size of the application state carried by the periodic advertisement.
+#ifndef PA_UPDATE_STATE_SIZE
+#define PA_UPDATE_STATE_SIZE          186
+#endif
+
+// Number of periodic advertising events each update is sent in. Values
+// above 1 let scanners miss an event without losing a delta.
+#ifndef PA_UPDATE_EVENTS_PER_UPDATE
+#define PA_UPDATE_EVENTS_PER_UPDATE   1
+#endif
+
+// Send a key frame (the full state) every this many updates, so scanners
+// that have just synced, or missed a delta, can rebuild the state.
+#ifndef PA_UPDATE_KEY_FRAME_INTERVAL
+#define PA_UPDATE_KEY_FRAME_INTERVAL  10
+#endif
+
+// External signal used by the update timer. Must not collide with the
+// signals of the application.
+#ifndef PA_UPDATE_SIGNAL
+#define PA_UPDATE_SIGNAL              0x80
+#endif
+
+// Payload format. The payload is one manufacturer specific AD structure:
+//   len, 0xFF, company ID (2 bytes), frame type, sequence number, body
+// Key frame body: the whole state.
+// Delta body: runs of changed bytes, each as offset, count, bytes. Runs hold
+// absolute values, so applying a delta twice is harmless.
+#define PA_UPDATE_COMPANY_ID          0x02FF
+#define PA_UPDATE_FRAME_KEY           0x01
+#define PA_UPDATE_FRAME_DELTA         0x02
+#define PA_UPDATE_HEADER_SIZE         6
+#define PA_UPDATE_MAX_PAYLOAD_SIZE    (PA_UPDATE_HEADER_SIZE + PA_UPDATE_STATE_SIZE)
+
+/***************************************************************************//**
+ * @brief Payload format of the scheduler
+ ******************************************************************************/
+typedef enum {
+  pa_update_format_full,  // Every update carries the whole state
+  pa_update_format_delta  // Deltas between periodic key frames
+} pa_update_format_t;
+
+/***************************************************************************//**
+ * @brief Producer callback
+ *
+ * Called once per update, aligned to the periodic advertising interval.
+ * Update the state in place; the scheduler detects what changed.
+ *
+ * @param[in] update Number of the update, counted from 0
+ * @param[in,out] state Application state, PA_UPDATE_STATE_SIZE bytes
+ ******************************************************************************/
+typedef void (*pa_update_produce_t)(uint32_t update, uint8_t *state);
+
+/***************************************************************************//**
+ * @brief Scheduler statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t updates;         // Producer calls
+  uint32_t unchanged;       // Updates that did not change the payload
+  uint32_t key_frames;      // Key frames pushed to the stack
+  uint32_t delta_frames;    // Deltas pushed to the stack
+  uint32_t payload_bytes;   // Total bytes pushed to the stack
+  uint8_t last_len;         // Length of the last payload
+} pa_update_stats_t;
+
+/***************************************************************************//**
+ *
+ * Start periodic advertising on an advertising set and the update timer
+ * with the same interval, so that each update is sent in a fixed number of
+ * periodic advertising events.
+ *
+ * The extended advertising of the set must be configured beforehand.
+ *
+ * @param[in] advertising_set Advertising set handle
+ * @param[in] interval Periodic advertising interval, in units of 1.25 ms
+ * @param[in] format Payload format
+ * @param[in] produce Producer callback
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pa_update_start(uint8_t advertising_set,
+                            uint16_t interval,
+                            pa_update_format_t format,
+                            pa_update_produce_t produce);
+
+/***************************************************************************//**
+ *
+ * Stop the update timer and periodic advertising.
+ *
+ ******************************************************************************/
+void pa_update_stop(void);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler of the scheduler. Must be called from
+ * sl_bt_on_event().
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ ******************************************************************************/
+void pa_update_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Retrieve the scheduler statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void pa_update_get_stats(pa_update_stats_t *stats);
+
+#endif // PA_UPDATE_H
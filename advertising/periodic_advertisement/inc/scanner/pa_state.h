@@ -0,0 +1,104 @@
+/***************************************************************************//**
+ * @file pa_state.h
+ * @brief Rebuilds the advertiser state from delta encoded periodic data.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef PA_STATE_H
+#define PA_STATE_H
+
+#include <stdint.h>
+
+// Payload format, must match pa_update.h of the advertiser.
+#define PA_STATE_SIZE                 186
+#define PA_STATE_COMPANY_ID           0x02FF
+#define PA_STATE_FRAME_KEY            0x01
+#define PA_STATE_FRAME_DELTA          0x02
+#define PA_STATE_HEADER_SIZE          6
+
+/***************************************************************************//**
+ * @brief Outcome of processing one periodic advertising report
+ ******************************************************************************/
+typedef enum {
+  pa_state_key_frame,    // State replaced by a key frame
+  pa_state_delta,        // Delta applied to the state
+  pa_state_duplicate,    // Same payload as the previous report
+  pa_state_out_of_sync,  // A delta was missed, waiting for a key frame
+  pa_state_invalid       // Not a payload of this format
+} pa_state_result_t;
+
+/***************************************************************************//**
+ * @brief Decoder statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t reports;
+  uint32_t key_frames;
+  uint32_t deltas;
+  uint32_t duplicates;
+  uint32_t out_of_sync;
+  uint32_t invalid;
+} pa_state_stats_t;
+
+/***************************************************************************//**
+ *
+ * Forget the state, e.g. when the sync is lost.
+ *
+ ******************************************************************************/
+void pa_state_reset(void);
+
+/***************************************************************************//**
+ *
+ * Process the data of a complete periodic advertising report.
+ *
+ * @param[in] data Report data
+ * @param[in] len Length of @p data
+ *
+ * @return Outcome of processing the report
+ *
+ ******************************************************************************/
+pa_state_result_t pa_state_process(const uint8_t *data, uint8_t len);
+
+/***************************************************************************//**
+ *
+ * Retrieve the rebuilt state.
+ *
+ * @return PA_STATE_SIZE bytes of state, NULL if no key frame has been
+ *         received since the last loss of sync.
+ *
+ ******************************************************************************/
+const uint8_t *pa_state_get(void);
+
+/***************************************************************************//**
+ *
+ * Retrieve the version of the rebuilt state.
+ *
+ * Unlike the sequence number of the payload, which changes with every key
+ * frame, the version only changes when a key frame or a delta changes the
+ * content of the state.
+ *
+ * @return Version of the state
+ *
+ ******************************************************************************/
+uint16_t pa_state_get_version(void);
+
+/***************************************************************************//**
+ *
+ * Retrieve the decoder statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void pa_state_get_stats(pa_state_stats_t *stats);
+
+#endif // PA_STATE_H
@@ -14,6 +14,7 @@
  * sections of the MSLA applicable to Source Code.
  *
  ******************************************************************************/
+#include <stdlib.h>
 #include "em_common.h"
 #include "app_assert.h"
 #include "sl_bluetooth.h"
@@ -22,15 +23,18 @@
 
 #include "sl_bt_api.h"
 #include "app_log.h"
+#include "pa_update.h"
 
-#define SIGNAL_REFRESH_DATA   1
-#define TICKS_PER_SECOND      32768
+// Periodic advertising interval, in units of 1.25 ms: 200 ms.
+#define PERIODIC_INTERVAL     160
+
+// Log a summary every 50 updates: 10 s.
+#define UPDATES_PER_SUMMARY   50
 
 // The advertising set handle allocated from Bluetooth stack.
 static uint8_t advertising_set_handle = 0xff;
 
-sl_sleeptimer_timer_handle_t sleep_timer_handle;
-void sleeptimer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void produce_data(uint32_t update, uint8_t *state);
 /**************************************************************************//**
  * Application Init.
  *****************************************************************************/
@@ -67,7 +71,6 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   uint8_t address_type;
   uint8_t system_id[8];
 
-  static uint8_t periodic_adv_data[191];
   int16_t result;
 
   switch (SL_BT_MSG_ID(evt->header)) {
@@ -132,19 +135,12 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 
       app_assert_status(sc);
 
-      // Start periodic advertising with periodic interval 200ms
-      sc = sl_bt_periodic_advertiser_start(advertising_set_handle, 160, 160,
-                                           SL_BT_PERIODIC_ADVERTISER_AUTO_START_EXTENDED_ADVERTISING);
-      app_assert_status(sc);
-
-      // Set the advertising data
-      sc = sl_bt_periodic_advertiser_set_data(advertising_set_handle, sizeof(periodic_adv_data), periodic_adv_data);
-
-      app_assert_status(sc);
-
-      // Start a timer to change advertising data every 1s
-      sc = sl_sleeptimer_start_periodic_timer(&sleep_timer_handle, TICKS_PER_SECOND, sleeptimer_callback, (void*)NULL, 0, 0);
-
+      // Start periodic advertising with periodic interval 200ms. The data is
+      // updated once per periodic advertising event, delta encoded.
+      sc = pa_update_start(advertising_set_handle,
+                           PERIODIC_INTERVAL,
+                           pa_update_format_delta,
+                           produce_data);
       app_assert_status(sc);
       break;
 
@@ -154,18 +150,9 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       break;
 
     case sl_bt_evt_system_external_signal_id:
-      if (evt->data.evt_system_external_signal.extsignals == SIGNAL_REFRESH_DATA) {
-        app_log("\r\n");
-        for (int i = 0; i < 190; i++) {
-          periodic_adv_data[i] = rand() % 9;
-          app_log(" %X", periodic_adv_data[i]);
-        }
-        app_log("\r\n");
-
-        sc = sl_bt_periodic_advertiser_set_data(advertising_set_handle, sizeof(periodic_adv_data), periodic_adv_data);
-        app_assert_status(sc);
-      }
+      pa_update_on_event(evt);
       break;
+
     ///////////////////////////////////////////////////////////////////////////
     // Add additional event handlers here as your application requires!      //
     ///////////////////////////////////////////////////////////////////////////
@@ -178,17 +165,35 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 }
 
 /***************************************************************************//**
- * Sleeptimer callback
+ * Produce the periodic advertising data of the next event.
  *
- * Note: This function is called from interrupt context
+ * The state simulates a table of slowly changing readings: an update counter
+ * and a few entries that change per update. Only the changed bytes are sent.
  *
- * @param[in] handle Handle of the sleeptimer instance
- * @param[in] data  Callback data
+ * @param[in] update Number of the update
+ * @param[in,out] state State carried by the periodic advertisement
  ******************************************************************************/
-void sleeptimer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+static void produce_data(uint32_t update, uint8_t *state)
 {
-  (void)handle;
-  (void)data;
+  pa_update_stats_t stats;
+
+  state[0] = (uint8_t)update;
+  state[1] = (uint8_t)(update >> 8);
+  state[2] = (uint8_t)(update >> 16);
+  state[3] = (uint8_t)(update >> 24);
+  for (uint8_t i = 0; i < 3; i++) {
+    state[4 + rand() % (PA_UPDATE_STATE_SIZE - 4)] = rand() % 9;
+  }
 
-  sl_bt_external_signal(SIGNAL_REFRESH_DATA);
+  if (update != 0 && update % UPDATES_PER_SUMMARY == 0) {
+    pa_update_get_stats(&stats);
+    app_log_info("updates %lu, unchanged %lu, key frames %lu, deltas %lu, "
+                 "avg payload %lu bytes\r\n",
+                 (unsigned long)stats.updates,
+                 (unsigned long)stats.unchanged,
+                 (unsigned long)stats.key_frames,
+                 (unsigned long)stats.delta_frames,
+                 (unsigned long)(stats.payload_bytes
+                                 / (stats.key_frames + stats.delta_frames)));
+  }
 }
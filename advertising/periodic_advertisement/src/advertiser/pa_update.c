@@ -0,0 +1,240 @@
+/***************************************************************************//**
+ * @file pa_update.c
+ * @brief Periodic advertising data update scheduler.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "pa_update.h"
+
+_Static_assert(PA_UPDATE_MAX_PAYLOAD_SIZE - 1 <= 255,
+               "PA_UPDATE_STATE_SIZE does not fit in one AD structure");
+_Static_assert(PA_UPDATE_EVENTS_PER_UPDATE > 0,
+               "PA_UPDATE_EVENTS_PER_UPDATE must be at least 1");
+
+// A run header costs two bytes, so gaps up to this size are cheaper to send
+// as part of the surrounding runs.
+#define RUN_MERGE_GAP   2
+
+static uint8_t advertising_handle = 0xff;
+static pa_update_format_t update_format;
+static pa_update_produce_t produce_cb;
+static bool running = false;
+
+static uint8_t state[PA_UPDATE_STATE_SIZE];
+static uint8_t sent_state[PA_UPDATE_STATE_SIZE];
+static uint8_t payload[PA_UPDATE_MAX_PAYLOAD_SIZE];
+static uint8_t sequence = 0;
+static uint32_t updates_since_key_frame = 0;
+static bool sent_valid = false;
+
+static pa_update_stats_t stats;
+
+// Update deadlines are computed from the start tick, so the fractional tick
+// part of the period does not accumulate into a drift against the radio.
+static sl_sleeptimer_timer_handle_t update_timer;
+static uint64_t start_tick;
+static uint64_t period_numerator;   // Period in ticks is numerator / 4000
+static uint32_t timer_updates;
+
+static void update_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+static void schedule_next_update(void)
+{
+  uint64_t deadline = start_tick
+                      + ((uint64_t)(timer_updates + 1) * period_numerator) / 4000;
+  uint64_t now = sl_sleeptimer_get_tick_count64();
+  uint32_t delay = (deadline > now) ? (uint32_t)(deadline - now) : 0;
+
+  sl_sleeptimer_start_timer(&update_timer,
+                            delay,
+                            update_timer_callback,
+                            NULL,
+                            0,
+                            0);
+}
+
+// Encode the changes since the last pushed payload. Returns the body length,
+// or 0 if nothing changed or the delta would not be smaller than a key frame.
+static uint8_t encode_delta(uint8_t *body, bool *changed)
+{
+  uint16_t len = 0;
+  uint16_t i = 0;
+
+  *changed = false;
+  while (i < PA_UPDATE_STATE_SIZE) {
+    uint16_t start;
+    uint16_t end;
+
+    if (state[i] == sent_state[i]) {
+      i++;
+      continue;
+    }
+    *changed = true;
+    start = i;
+    end = i + 1;
+    for (uint16_t j = end; j < PA_UPDATE_STATE_SIZE && j - end <= RUN_MERGE_GAP; j++) {
+      if (state[j] != sent_state[j]) {
+        end = j + 1;
+      }
+    }
+    if (len + 2 + (end - start) >= PA_UPDATE_STATE_SIZE) {
+      return 0;
+    }
+    body[len++] = (uint8_t)start;
+    body[len++] = (uint8_t)(end - start);
+    memcpy(&body[len], &state[start], end - start);
+    len += end - start;
+    i = end;
+  }
+  return (uint8_t)len;
+}
+
+static sl_status_t push_payload(uint8_t frame_type, uint8_t body_len)
+{
+  sl_status_t sc;
+  uint8_t len = PA_UPDATE_HEADER_SIZE + body_len;
+
+  payload[0] = len - 1;
+  payload[1] = 0xFF;
+  payload[2] = (uint8_t)(PA_UPDATE_COMPANY_ID & 0xFF);
+  payload[3] = (uint8_t)(PA_UPDATE_COMPANY_ID >> 8);
+  payload[4] = frame_type;
+  payload[5] = sequence + 1;
+
+  sc = sl_bt_periodic_advertiser_set_data(advertising_handle, len, payload);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+
+  sequence++;
+  memcpy(sent_state, state, sizeof(state));
+  sent_valid = true;
+  stats.payload_bytes += len;
+  stats.last_len = len;
+  if (frame_type == PA_UPDATE_FRAME_KEY) {
+    stats.key_frames++;
+    updates_since_key_frame = 0;
+  } else {
+    stats.delta_frames++;
+  }
+  return SL_STATUS_OK;
+}
+
+static void process_update(void)
+{
+  uint8_t body_len;
+  bool changed;
+
+  produce_cb(stats.updates, state);
+  stats.updates++;
+  updates_since_key_frame++;
+
+  body_len = encode_delta(&payload[PA_UPDATE_HEADER_SIZE], &changed);
+
+  if (!sent_valid
+      || (update_format == pa_update_format_delta
+          && updates_since_key_frame >= PA_UPDATE_KEY_FRAME_INTERVAL)) {
+    memcpy(&payload[PA_UPDATE_HEADER_SIZE], state, sizeof(state));
+    (void)push_payload(PA_UPDATE_FRAME_KEY, PA_UPDATE_STATE_SIZE);
+  } else if (!changed) {
+    // Keep the payload already in the stack; scanners receive it again.
+    stats.unchanged++;
+  } else if (update_format == pa_update_format_delta && body_len != 0) {
+    (void)push_payload(PA_UPDATE_FRAME_DELTA, body_len);
+  } else {
+    memcpy(&payload[PA_UPDATE_HEADER_SIZE], state, sizeof(state));
+    (void)push_payload(PA_UPDATE_FRAME_KEY, PA_UPDATE_STATE_SIZE);
+  }
+}
+
+sl_status_t pa_update_start(uint8_t advertising_set,
+                            uint16_t interval,
+                            pa_update_format_t format,
+                            pa_update_produce_t produce)
+{
+  sl_status_t sc;
+
+  if (produce == NULL || interval < 6) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (running) {
+    return SL_STATUS_INVALID_STATE;
+  }
+
+  advertising_handle = advertising_set;
+  update_format = format;
+  produce_cb = produce;
+  memset(&stats, 0, sizeof(stats));
+  sent_valid = false;
+
+  // Produce the first state before the train starts, so the first periodic
+  // event already carries data.
+  process_update();
+
+  sc = sl_bt_periodic_advertiser_start(advertising_set,
+                                       interval,
+                                       interval,
+                                       SL_BT_PERIODIC_ADVERTISER_AUTO_START_EXTENDED_ADVERTISING);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+
+  // One periodic interval is 1.25 ms = 5/4000 s
+  period_numerator = (uint64_t)interval * PA_UPDATE_EVENTS_PER_UPDATE * 5
+                     * sl_sleeptimer_get_timer_frequency();
+  start_tick = sl_sleeptimer_get_tick_count64();
+  timer_updates = 0;
+  running = true;
+  schedule_next_update();
+
+  return SL_STATUS_OK;
+}
+
+void pa_update_stop(void)
+{
+  if (!running) {
+    return;
+  }
+  running = false;
+  sl_sleeptimer_stop_timer(&update_timer);
+  (void)sl_bt_periodic_advertiser_stop(advertising_handle);
+}
+
+void pa_update_on_event(sl_bt_msg_t *evt)
+{
+  if (SL_BT_MSG_ID(evt->header) != sl_bt_evt_system_external_signal_id
+      || !(evt->data.evt_system_external_signal.extsignals & PA_UPDATE_SIGNAL)
+      || !running) {
+    return;
+  }
+  process_update();
+}
+
+void pa_update_get_stats(pa_update_stats_t *out)
+{
+  *out = stats;
+}
+
+static void update_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  timer_updates++;
+  if (running) {
+    schedule_next_update();
+  }
+  sl_bt_external_signal(PA_UPDATE_SIGNAL);
+}
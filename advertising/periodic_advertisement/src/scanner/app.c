@@ -22,6 +22,17 @@
 
 #include "sl_bt_api.h"
 #include "app_log.h"
+#include "pa_state.h"
+#include "sync_manager.h"
+
+// Log a summary every 10 received reports.
+#define REPORTS_PER_SUMMARY   10
+
+// Update rate required by the application. The deltas of the advertiser
+// must be received in every periodic event, so the sync manager keeps the
+// skip at 0 and only tunes the sync timeout.
+#define SYNC_MIN_UPDATE_MS    0
+#define SYNC_MAX_UPDATE_MS    0
 
 // This constant is UUID of periodic synchronous service
 const uint8_t periodicSyncService[16] = { 0x81, 0xc2, 0x00, 0x2d, 0x31, 0xf4, 0xb0, 0xbf, 0x2b, 0x42, 0x49, 0x68, 0xc7, 0x25, 0x71, 0x41 };
@@ -51,11 +62,43 @@ static uint8_t findServiceInAdvertisement(uint8_t *data, uint8_t len)
   return 0;
 }
 
+// Called by the sync manager when the advertiser cannot be synced to again.
+static void on_train_lost(const bd_addr *address, uint8_t sid)
+{
+  (void)address;
+  app_log("periodic train SID %d lost, restarting discovery\r\n", sid);
+  sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m,
+                      sl_bt_scanner_discover_observation);
+}
+
+static void log_sync_manager(uint16_t sync)
+{
+  sync_manager_stats_t stats;
+  sync_manager_sync_info_t info;
+
+  sync_manager_get_stats(&stats);
+  if (sync_manager_get_sync_info(sync, &info) == SL_STATUS_OK) {
+    app_log("sync: skip %d, timeout %lu ms, data change every %lu ms\r\n",
+            info.skip,
+            (unsigned long)info.timeout_ms,
+            (unsigned long)info.change_ms);
+  }
+  app_log("sync: %lu events received, %lu skipped, %lu retunes, %lu losses, "
+          "radio-on time saved %lu ms, scanning %lu ms\r\n",
+          (unsigned long)stats.events_received,
+          (unsigned long)stats.events_skipped,
+          (unsigned long)stats.retunes,
+          (unsigned long)stats.losses,
+          (unsigned long)stats.radio_saved_ms,
+          (unsigned long)stats.scan_ms);
+}
+
 /**************************************************************************//**
  * Application Init.
  *****************************************************************************/
 SL_WEAK void app_init(void)
 {
+  sync_manager_set_lost_callback(on_train_lost);
   /////////////////////////////////////////////////////////////////////////////
   // Put your additional application init code here!                         //
   // This is called once during start-up.                                    //
@@ -87,7 +130,9 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   uint8_t address_type;
   uint8_t system_id[8];
 
-  static uint16_t sync;
+  pa_state_stats_t stats;
+  pa_state_result_t result;
+  const uint8_t *state;
 
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
@@ -132,12 +177,15 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
               evt->data.evt_scanner_extended_advertisement_report.tx_power);
 
       if (findServiceInAdvertisement(&(evt->data.evt_scanner_extended_advertisement_report.data.data[0]), evt->data.evt_scanner_extended_advertisement_report.data.len) != 0) {
-        app_log("found periodic sync service, attempting to open sync\r\n");
-        sc = sl_bt_sync_scanner_open(evt->data.evt_scanner_extended_advertisement_report.address,
-                                     evt->data.evt_scanner_extended_advertisement_report.address_type,
-                                     evt->data.evt_scanner_extended_advertisement_report.adv_sid,
-                                     &sync);
-        app_log_info("cmd_sync_open() sync = 0x%4lX\r\n", sc);
+        sc = sync_manager_add(evt->data.evt_scanner_extended_advertisement_report.address,
+                              evt->data.evt_scanner_extended_advertisement_report.address_type,
+                              evt->data.evt_scanner_extended_advertisement_report.adv_sid,
+                              SYNC_MIN_UPDATE_MS,
+                              SYNC_MAX_UPDATE_MS);
+        if (sc != SL_STATUS_ALREADY_EXISTS) {
+          app_log("found periodic sync service, attempting to open sync\r\n");
+          app_log_info("sync_manager_add() sc = 0x%4lX\r\n", sc);
+        }
       }
       break;
 
@@ -152,23 +200,50 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_log("periodic sync closed. reason 0x%2X, sync handle %d",
               evt->data.evt_sync_closed.reason,
               evt->data.evt_sync_closed.sync);
-      /* restart discovery */
-      sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m,
-                          sl_bt_scanner_discover_observation);
+      pa_state_reset();
+      /* the sync manager reopens the sync, or reports the train as lost */
       break;
 
     case sl_bt_evt_periodic_sync_report_id:
-
-      app_log("periodic sync handle %d\r\n", evt->data.evt_periodic_sync_report.sync);
-      app_log("got following sync data: \r\n ");
-      for (int i = 0; i < evt->data.evt_periodic_sync_report.data.len; i++) {
-        app_log(" %X", evt->data.evt_periodic_sync_report.data.data[i]);
+      // The payload fits in one report, partial data is not expected.
+      if (evt->data.evt_periodic_sync_report.data_status != 0) {
+        app_log("periodic data status %d\r\n", evt->data.evt_periodic_sync_report.data_status);
+        break;
+      }
+      result = pa_state_process(evt->data.evt_periodic_sync_report.data.data,
+                                evt->data.evt_periodic_sync_report.data.len);
+      if (result == pa_state_key_frame) {
+        app_log("periodic sync handle %d: key frame, state rebuilt\r\n",
+                evt->data.evt_periodic_sync_report.sync);
+      }
+      // The version of the rebuilt state changes with the data, as the data
+      // ID would. The sequence number of the payload would not do: it also
+      // changes with every key frame repeating the same state.
+      if (result != pa_state_invalid) {
+        (void)sync_manager_report(evt->data.evt_periodic_sync_report.sync,
+                                  pa_state_get_version(),
+                                  evt->data.evt_periodic_sync_report.data.len);
+      }
+      pa_state_get_stats(&stats);
+      if (stats.reports % REPORTS_PER_SUMMARY == 0) {
+        state = pa_state_get();
+        app_log("reports %lu: key frames %lu, deltas %lu, duplicates %lu, "
+                "out of sync %lu, invalid %lu\r\n",
+                (unsigned long)stats.reports,
+                (unsigned long)stats.key_frames,
+                (unsigned long)stats.deltas,
+                (unsigned long)stats.duplicates,
+                (unsigned long)stats.out_of_sync,
+                (unsigned long)stats.invalid);
+        if (state != NULL) {
+          app_log("advertiser update counter %lu, RSSI %d\r\n",
+                  (unsigned long)(state[0] | (state[1] << 8)
+                                  | (state[2] << 16)
+                                  | ((uint32_t)state[3] << 24)),
+                  evt->data.evt_periodic_sync_report.rssi);
+        }
+        log_sync_manager(evt->data.evt_periodic_sync_report.sync);
       }
-      app_log("\r\n");
-      app_log("periodic sync RSSI %d and Tx power %d\r\n",
-              evt->data.evt_periodic_sync_report.rssi,
-              evt->data.evt_periodic_sync_report.tx_power);
-      app_log("periodic data status %d\r\n", evt->data.evt_periodic_sync_report.data_status);
       break;
 
     ///////////////////////////////////////////////////////////////////////////
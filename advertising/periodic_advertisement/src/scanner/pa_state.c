@@ -0,0 +1,130 @@
+/***************************************************************************//**
+ * @file pa_state.c
+ * @brief Rebuilds the advertiser state from delta encoded periodic data.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "pa_state.h"
+
+static uint8_t state[PA_STATE_SIZE];
+static bool state_valid = false;
+static bool sequence_valid = false;
+static uint8_t last_sequence;
+static uint16_t version = 0;
+static pa_state_stats_t stats;
+
+// Check that all runs of a delta are within the state before applying any.
+static bool delta_is_valid(const uint8_t *body, uint8_t len)
+{
+  uint8_t i = 0;
+
+  while (i < len) {
+    if (len - i < 2 || body[i + 1] == 0
+        || body[i] + body[i + 1] > PA_STATE_SIZE
+        || body[i + 1] > len - i - 2) {
+      return false;
+    }
+    i += 2 + body[i + 1];
+  }
+  return true;
+}
+
+void pa_state_reset(void)
+{
+  state_valid = false;
+  sequence_valid = false;
+}
+
+pa_state_result_t pa_state_process(const uint8_t *data, uint8_t len)
+{
+  const uint8_t *body = &data[PA_STATE_HEADER_SIZE];
+  uint8_t body_len;
+  uint8_t sequence;
+
+  stats.reports++;
+
+  if (len < PA_STATE_HEADER_SIZE
+      || data[0] != len - 1
+      || data[1] != 0xFF
+      || data[2] != (uint8_t)(PA_STATE_COMPANY_ID & 0xFF)
+      || data[3] != (uint8_t)(PA_STATE_COMPANY_ID >> 8)) {
+    stats.invalid++;
+    return pa_state_invalid;
+  }
+  body_len = len - PA_STATE_HEADER_SIZE;
+  sequence = data[5];
+
+  if (sequence_valid && sequence == last_sequence) {
+    stats.duplicates++;
+    return pa_state_duplicate;
+  }
+
+  switch (data[4]) {
+    case PA_STATE_FRAME_KEY:
+      if (body_len != PA_STATE_SIZE) {
+        break;
+      }
+      if (memcmp(state, body, PA_STATE_SIZE) != 0) {
+        memcpy(state, body, PA_STATE_SIZE);
+        version++;
+      }
+      state_valid = true;
+      sequence_valid = true;
+      last_sequence = sequence;
+      stats.key_frames++;
+      return pa_state_key_frame;
+
+    case PA_STATE_FRAME_DELTA:
+      if (!delta_is_valid(body, body_len)) {
+        break;
+      }
+      if (!state_valid || sequence != (uint8_t)(last_sequence + 1)) {
+        state_valid = false;
+        stats.out_of_sync++;
+        return pa_state_out_of_sync;
+      }
+      for (uint8_t i = 0; i < body_len; i += 2 + body[i + 1]) {
+        if (memcmp(&state[body[i]], &body[i + 2], body[i + 1]) != 0) {
+          memcpy(&state[body[i]], &body[i + 2], body[i + 1]);
+          version++;
+        }
+      }
+      last_sequence = sequence;
+      stats.deltas++;
+      return pa_state_delta;
+
+    default:
+      break;
+  }
+
+  stats.invalid++;
+  return pa_state_invalid;
+}
+
+const uint8_t *pa_state_get(void)
+{
+  return state_valid ? state : NULL;
+}
+
+uint16_t pa_state_get_version(void)
+{
+  return version;
+}
+
+void pa_state_get_stats(pa_state_stats_t *out)
+{
+  *out = stats;
+}
@@ -0,0 +1,207 @@
+/***************************************************************************//**
+ * @file pawr_collector.h
+ * @brief PAwR response collector.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef PAWR_COLLECTOR_H
+#define PAWR_COLLECTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "pawr_slots.h"
+
+// Statistics are kept per slot, within the capacity of pawr_slots.h. Each
+// slot takes 14 bytes of RAM.
+
+// A responder is reported silent after this many consecutive missed
+// responses. Keep it below PAWR_SLOTS_RECLAIM_MISSES to be warned before
+// the slot is reclaimed.
+#ifndef PAWR_COLLECTOR_SILENT_EVENTS
+#define PAWR_COLLECTOR_SILENT_EVENTS    5
+#endif
+
+// Export format version
+#define PAWR_COLLECTOR_EXPORT_VERSION   1
+
+// Size of the export header, of the round bitmap header of a subevent and
+// of one responder record. See pawr_collector_export().
+#define PAWR_COLLECTOR_EXPORT_HEADER_LEN   5
+#define PAWR_COLLECTOR_EXPORT_ROUND_LEN    5
+#define PAWR_COLLECTOR_EXPORT_RECORD_LEN   13
+
+/***************************************************************************//**
+ * @brief Statistics of a responder
+ ******************************************************************************/
+typedef struct {
+  uint8_t history_len;          // Events covered by the loss rate, up to 32
+  uint8_t loss_percent;         // Missed responses in the last history_len events
+  int8_t rssi;                  // Average RSSI of the responses, dBm
+  uint16_t consecutive_misses;  // Events since the last response
+  uint8_t delivery_latency;     // Average events to deliver a downlink message
+  uint8_t max_delivery_latency; // Longest delivery, in events
+  bool silent;                  // Reported silent
+} pawr_collector_slot_stats_t;
+
+/***************************************************************************//**
+ * @brief Summary of the network
+ ******************************************************************************/
+typedef struct {
+  uint16_t responders;          // Slots with an owner
+  uint16_t silent;              // Responders reported silent
+  uint8_t loss_percent;         // Average loss rate of the responders
+  int8_t rssi;                  // Average RSSI of the responders
+} pawr_collector_summary_t;
+
+/***************************************************************************//**
+ * @brief Called when a responder goes silent, or answers again
+ *
+ * @param[in] slot Slot of the responder
+ * @param[in] silent true if the responder went silent
+ ******************************************************************************/
+typedef void (*pawr_collector_silence_cb_t)(pawr_slot_t slot, bool silent);
+
+/***************************************************************************//**
+ *
+ * Clear all statistics.
+ *
+ * @param[in] silence_cb Silence callback, may be NULL
+ *
+ ******************************************************************************/
+void pawr_collector_init(pawr_collector_silence_cb_t silence_cb);
+
+/***************************************************************************//**
+ *
+ * Clear the statistics of a slot. Call it when the slot gets a new owner.
+ *
+ * @param[in] slot The slot
+ *
+ ******************************************************************************/
+void pawr_collector_reset_slot(pawr_slot_t slot);
+
+/***************************************************************************//**
+ *
+ * Record a response report. Call it for every report, before passing it to
+ * pawr_slots_on_response(). A subevent round ends with the report of its
+ * last requested slot, or when the slots start over.
+ *
+ * @param[in] slot Slot of the report
+ * @param[in] received true if a response was received
+ * @param[in] rssi RSSI of the response
+ *
+ ******************************************************************************/
+void pawr_collector_on_report(pawr_slot_t slot, bool received, int8_t rssi);
+
+/***************************************************************************//**
+ *
+ * Record the delivery of a downlink message.
+ *
+ * @param[in] slot Slot of the responder
+ * @param[in] transmissions Number of events the message was sent in
+ *
+ ******************************************************************************/
+void pawr_collector_on_delivery(pawr_slot_t slot, uint8_t transmissions);
+
+/***************************************************************************//**
+ *
+ * Retrieve the statistics of a responder.
+ *
+ * @param[in] slot Slot of the responder
+ * @param[out] stats Statistics
+ *
+ * @return false if the slot has no owner
+ *
+ ******************************************************************************/
+bool pawr_collector_get_slot_stats(pawr_slot_t slot, pawr_collector_slot_stats_t *stats);
+
+/***************************************************************************//**
+ *
+ * Retrieve the received bitmap of the last complete round of a subevent.
+ * Bit n of byte n / 8 is set if a response was received in slot n.
+ *
+ * @param[in] subevent Subevent index
+ * @param[out] slot_count Number of slots covered by the bitmap
+ *
+ * @return The bitmap, NULL if the subevent is out of range
+ *
+ ******************************************************************************/
+const uint8_t *pawr_collector_get_round_bitmap(uint8_t subevent, uint8_t *slot_count);
+
+/***************************************************************************//**
+ *
+ * Summarize the state of the network.
+ *
+ * @param[out] summary Summary
+ *
+ ******************************************************************************/
+void pawr_collector_get_summary(pawr_collector_summary_t *summary);
+
+/***************************************************************************//**
+ *
+ * Retrieve the buffer size needed by pawr_collector_export().
+ *
+ ******************************************************************************/
+size_t pawr_collector_get_export_size(void);
+
+/***************************************************************************//**
+ *
+ * Export the state of the whole network into one buffer, little endian:
+ *
+ * - Header: version, number of subevents, slots per subevent, number of
+ *   responder records (2 bytes).
+ * - Per subevent: completed rounds (4 bytes), slot count of the last round,
+ *   and its received bitmap, one bit per slot.
+ * - Per responder: subevent, slot, address (6 bytes), loss percent, RSSI,
+ *   delivery latency, consecutive misses (2 bytes).
+ *
+ * @param[out] buffer Destination buffer
+ * @param[in] size Size of @p buffer
+ *
+ * @return Number of bytes written, 0 if the buffer is too small
+ *
+ ******************************************************************************/
+size_t pawr_collector_export(uint8_t *buffer, size_t size);
+
+/***************************************************************************//**
+ *
+ * Export a part of the state of the network, in the format of
+ * pawr_collector_export(), so that a large network is exported through a
+ * small buffer. The parts of one export must be taken without handling
+ * Bluetooth events in between, so that they belong to the same state.
+ *
+ * @param[in] offset Offset of the part in the export
+ * @param[out] buffer Destination buffer
+ * @param[in] size Size of @p buffer
+ *
+ * @return Number of bytes written, less than @p size for the last part and
+ *         0 past the end of the export
+ *
+ ******************************************************************************/
+size_t pawr_collector_export_part(size_t offset, uint8_t *buffer, size_t size);
+
+#endif // PAWR_COLLECTOR_H
@@ -0,0 +1,200 @@
+/***************************************************************************//**
+ * @file pawr_downlink.h
+ * @brief PAwR downlink message queue.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef PAWR_DOWNLINK_H
+#define PAWR_DOWNLINK_H
+
+#include <stdint.h>
+#include "sl_bluetooth.h"
+#include "pawr_slots.h"
+
+// Number of messages that can be queued.
+#ifndef PAWR_DOWNLINK_QUEUE_SIZE
+#define PAWR_DOWNLINK_QUEUE_SIZE        32
+#endif
+
+// Maximum length of one message.
+#ifndef PAWR_DOWNLINK_MAX_MESSAGE_LEN
+#define PAWR_DOWNLINK_MAX_MESSAGE_LEN   16
+#endif
+
+// Maximum subevent data length. The subevent data must be sent within the
+// response slot delay of the train. With PAWR_ENCRYPTION, the encryption
+// takes PAWR_CRYPTO_OVERHEAD bytes of it.
+#ifndef PAWR_DOWNLINK_MAX_SUBEVENT_DATA
+#define PAWR_DOWNLINK_MAX_SUBEVENT_DATA 128
+#endif
+
+// Subevent data format:
+//   message count, then per message: slot, sequence number, length, data
+// Only one message per slot is in flight at a time. Its sequence number
+// alternates between 1 and 2 from one message to the next, so a responder
+// can tell a new message from a retransmission.
+#define PAWR_DOWNLINK_MESSAGE_HEADER_LEN 3
+
+// Response data format: the first byte acknowledges the sequence number of
+// the last message received by the responder, 0 if none.
+#define PAWR_DOWNLINK_ACK_NONE          0
+
+// Sequence number of a revocation notice. Its data is the address of the
+// responder whose slot was reclaimed. That responder leaves the train
+// instead of answering in a slot that may be assigned to another one. A
+// notice is not acknowledged, it is sent in PAWR_DOWNLINK_REVOKE_TRANSMISSIONS
+// subevent data sets.
+#define PAWR_DOWNLINK_SEQUENCE_REVOKE   0xFF
+
+#ifndef PAWR_DOWNLINK_REVOKE_TRANSMISSIONS
+#define PAWR_DOWNLINK_REVOKE_TRANSMISSIONS 8
+#endif
+
+/***************************************************************************//**
+ * @brief Downlink statistics of a subevent
+ ******************************************************************************/
+typedef struct {
+  uint32_t tx_bytes;          // Message bytes sent, retransmissions included
+  uint32_t delivered_bytes;   // Message bytes acknowledged by the responders
+  uint32_t delivered;         // Messages acknowledged
+  uint32_t retransmissions;   // Messages sent again for lack of acknowledgement
+  uint32_t cancelled;         // Messages cancelled before acknowledgement
+  uint32_t revocations;       // Revocation notices queued
+} pawr_downlink_stats_t;
+
+/***************************************************************************//**
+ *
+ * Empty the queue and clear the statistics.
+ *
+ ******************************************************************************/
+void pawr_downlink_init(void);
+
+/***************************************************************************//**
+ *
+ * Queue a message for the responder owning a slot. Messages to the same slot
+ * are delivered in order.
+ *
+ * @param[in] slot Response slot of the responder
+ * @param[in] len Message length, at most PAWR_DOWNLINK_MAX_MESSAGE_LEN
+ * @param[in] data Message
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NO_MORE_RESOURCE if the
+ *         queue is full, SL_STATUS_INVALID_PARAMETER if the slot is free or
+ *         the message too long.
+ *
+ ******************************************************************************/
+sl_status_t pawr_downlink_send(pawr_slot_t slot, uint8_t len, const uint8_t *data);
+
+/***************************************************************************//**
+ *
+ * Drop the messages queued for a slot, e.g. when it is reclaimed.
+ *
+ * @param[in] slot Response slot
+ *
+ ******************************************************************************/
+void pawr_downlink_cancel(pawr_slot_t slot);
+
+/***************************************************************************//**
+ *
+ * Restart the message sequence of a slot when its responder is provisioned.
+ * The responder forgets the sequence number of its last message when it is
+ * provisioned, e.g. after a reset of the advertiser, which loses the
+ * sequence numbers of all slots. Both ends thus start over, and the first
+ * message is not taken for a retransmission. A message in flight is sent
+ * again as a new one.
+ *
+ * @param[in] slot Response slot of the responder
+ *
+ ******************************************************************************/
+void pawr_downlink_restart(pawr_slot_t slot);
+
+/***************************************************************************//**
+ *
+ * Drop the messages queued for a reclaimed slot and tell its former owner
+ * to leave the train. The notice is sent even if no other responder is left
+ * in the subevent.
+ *
+ * @param[in] slot The reclaimed slot
+ * @param[in] address Address of the former owner, 6 bytes
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NO_MORE_RESOURCE if the
+ *         queue is full.
+ *
+ ******************************************************************************/
+sl_status_t pawr_downlink_revoke(pawr_slot_t slot, const uint8_t *address);
+
+/***************************************************************************//**
+ *
+ * Build and set the data of all subevents requested by the stack. Call it
+ * from the sl_bt_evt_pawr_advertiser_subevent_data_request event.
+ *
+ * Subevents without responders or revocation notices are left empty. The
+ * others carry the queued messages, unacknowledged messages first.
+ *
+ * @param[in] request The subevent data request event
+ * @param[in] num_subevents Number of subevents of the train
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_downlink_on_data_request(const sl_bt_evt_pawr_advertiser_subevent_data_request_t *request,
+                                          uint8_t num_subevents);
+
+/***************************************************************************//**
+ *
+ * Process the acknowledgement in a response.
+ *
+ * @param[in] slot Slot the response was received in
+ * @param[in] len Length of the response data
+ * @param[in] data Response data
+ *
+ * @return Number of times the acknowledged message was sent, 0 if the
+ *         response acknowledged no message in flight.
+ *
+ ******************************************************************************/
+uint8_t pawr_downlink_on_response(pawr_slot_t slot, uint8_t len, const uint8_t *data);
+
+/***************************************************************************//**
+ *
+ * Retrieve the number of queued messages.
+ *
+ ******************************************************************************/
+uint8_t pawr_downlink_get_queued(void);
+
+/***************************************************************************//**
+ *
+ * Retrieve the downlink statistics of a subevent.
+ *
+ * @param[in] subevent Subevent index
+ * @param[out] stats Statistics
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_INVALID_INDEX otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_downlink_get_stats(uint8_t subevent, pawr_downlink_stats_t *stats);
+
+#endif // PAWR_DOWNLINK_H
@@ -0,0 +1,189 @@
+/***************************************************************************//**
+ * @file pawr_provisioning.h
+ * @brief Parallel provisioning of PAwR scanners.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef PAWR_PROVISIONING_H
+#define PAWR_PROVISIONING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+#include "pawr_slots.h"
+
+// Scanners provisioned in parallel. Limited by the number of connections
+// the stack is configured for.
+#ifndef PAWR_PROVISIONING_MAX_PEERS
+#ifdef SL_BT_CONFIG_MAX_CONNECTIONS
+#define PAWR_PROVISIONING_MAX_PEERS     SL_BT_CONFIG_MAX_CONNECTIONS
+#else
+#define PAWR_PROVISIONING_MAX_PEERS     4
+#endif
+#endif
+
+// A connection that is not established within this time is cancelled, and
+// a peer that stays longer than this in any later stage is disconnected.
+#ifndef PAWR_PROVISIONING_CONNECT_TIMEOUT_MS
+#define PAWR_PROVISIONING_CONNECT_TIMEOUT_MS  2000
+#endif
+#ifndef PAWR_PROVISIONING_STAGE_TIMEOUT_MS
+#define PAWR_PROVISIONING_STAGE_TIMEOUT_MS    5000
+#endif
+
+// A scanner closes the connection once the sync transfer succeeded, but a
+// closed connection is no proof of it. The scanner is provisioned only when
+// its first response is received in its slot, within this time from the
+// sync transfer. Must cover a few periodic advertising intervals.
+#ifndef PAWR_PROVISIONING_JOIN_TIMEOUT_MS
+#define PAWR_PROVISIONING_JOIN_TIMEOUT_MS     10000
+#endif
+
+// Scanners waiting for their first response, on top of the connected ones.
+// They hold no connection. Scanning pauses while the table is full.
+#ifndef PAWR_PROVISIONING_MAX_JOINING
+#define PAWR_PROVISIONING_MAX_JOINING         PAWR_PROVISIONING_MAX_PEERS
+#endif
+
+// A scanner that failed is retried after a backoff that doubles with every
+// failure, from the base up to the maximum.
+#ifndef PAWR_PROVISIONING_BACKOFF_BASE_MS
+#define PAWR_PROVISIONING_BACKOFF_BASE_MS     1000
+#endif
+#ifndef PAWR_PROVISIONING_BACKOFF_MAX_MS
+#define PAWR_PROVISIONING_BACKOFF_MAX_MS      60000
+#endif
+
+// Scanners remembered for the backoff. When the table is full the entry
+// that is due first is replaced.
+#ifndef PAWR_PROVISIONING_BACKOFF_ENTRIES
+#define PAWR_PROVISIONING_BACKOFF_ENTRIES     16
+#endif
+
+// External signal of the timeout timer
+#ifndef PAWR_PROVISIONING_SIGNAL
+#define PAWR_PROVISIONING_SIGNAL        0x02
+#endif
+
+/***************************************************************************//**
+ * @brief Provisioning stages timed by the pipeline
+ ******************************************************************************/
+typedef enum {
+  pawr_provisioning_stage_connect,        // Connection request to connection opened
+  pawr_provisioning_stage_security,       // Connection opened to encrypted
+  pawr_provisioning_stage_discovery,      // Service and characteristic discovery
+  pawr_provisioning_stage_slot_write,     // Writing the slot to the scanner
+  pawr_provisioning_stage_sync_transfer,  // PAST until the first response of the scanner
+  pawr_provisioning_stage_total,          // Connection request to the first response
+  PAWR_PROVISIONING_STAGE_COUNT
+} pawr_provisioning_stage_t;
+
+/***************************************************************************//**
+ * @brief Duration of a stage, over all successful passes
+ ******************************************************************************/
+typedef struct {
+  uint32_t count;
+  uint32_t total_ms;
+  uint32_t max_ms;
+} pawr_provisioning_stage_stats_t;
+
+/***************************************************************************//**
+ * @brief Provisioning statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t provisioned;         // Scanners that responded in their slot
+  uint32_t failures;            // Attempts that ended without a response
+  uint32_t timeouts;            // Failures caused by a stage timeout
+  uint32_t retries;             // Attempts on scanners that failed before
+  uint32_t per_minute;          // Provisioned scanners per minute since the first attempt
+  uint8_t active;               // Scanners being provisioned, joining included
+  pawr_provisioning_stage_stats_t stages[PAWR_PROVISIONING_STAGE_COUNT];
+} pawr_provisioning_stats_t;
+
+/***************************************************************************//**
+ * @brief Called when a scanner is assigned a response slot
+ *
+ * @param[in] slot The assigned slot
+ * @param[in] address Address of the scanner
+ ******************************************************************************/
+typedef void (*pawr_provisioning_assigned_cb_t)(pawr_slot_t slot, const bd_addr *address);
+
+/***************************************************************************//**
+ *
+ * Set up the pipeline. The security manager and the slot allocator must be
+ * configured before provisioning starts.
+ *
+ * @param[in] adv_handle Advertising set of the PAwR train
+ * @param[in] assigned_cb Slot assignment callback, may be NULL
+ *
+ ******************************************************************************/
+void pawr_provisioning_init(uint8_t adv_handle,
+                            pawr_provisioning_assigned_cb_t assigned_cb);
+
+/***************************************************************************//**
+ *
+ * Start scanning for scanners to provision. Up to
+ * PAWR_PROVISIONING_MAX_PEERS scanners are connected at a time, each one
+ * going through the stages on its own.
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_provisioning_start(void);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler of the pipeline. Must be called from
+ * sl_bt_on_event().
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ ******************************************************************************/
+void pawr_provisioning_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Report a response received in a slot. Must be called for every response
+ * accepted by the application. The first response of a scanner that was
+ * given the slot completes its provisioning.
+ *
+ * @param[in] slot Slot of the response
+ *
+ ******************************************************************************/
+void pawr_provisioning_on_response(pawr_slot_t slot);
+
+/***************************************************************************//**
+ *
+ * Get the provisioning statistics.
+ *
+ * @param[out] stats The statistics
+ *
+ ******************************************************************************/
+void pawr_provisioning_get_stats(pawr_provisioning_stats_t *stats);
+
+#endif // PAWR_PROVISIONING_H
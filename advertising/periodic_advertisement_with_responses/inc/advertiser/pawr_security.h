@@ -0,0 +1,162 @@
+/***************************************************************************//**
+ * @file pawr_security.h
+ * @brief Network key and replay protection of the PAwR advertiser.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef PAWR_SECURITY_H
+#define PAWR_SECURITY_H
+
+#include <stdint.h>
+#include "sl_status.h"
+#include "pawr_slots.h"
+#include "pawr_crypto.h"
+
+// NVM3 keys of the network key material and of the sequence number
+// reservation, after the keys reserved by pawr_slots.h
+#ifndef PAWR_SECURITY_NVM3_KEY_BASE
+#define PAWR_SECURITY_NVM3_KEY_BASE     0x01400
+#endif
+
+// Sequence numbers are reserved in NVM3 this many at a time, so a rebooted
+// advertiser never uses one twice and the flash is written rarely.
+#ifndef PAWR_SECURITY_SEQUENCE_RESERVE
+#define PAWR_SECURITY_SEQUENCE_RESERVE  4096
+#endif
+
+// A response is accepted if it answers one of the last
+// PAWR_SECURITY_SEQUENCE_WINDOW subevent data sets of its subevent, as the
+// stack requests the data a few events ahead.
+#ifndef PAWR_SECURITY_SEQUENCE_WINDOW
+#define PAWR_SECURITY_SEQUENCE_WINDOW   4
+#endif
+
+// Time allowed for opening the responses of one subevent in one event.
+// Responses beyond it are dropped, which bounds the work done per subevent.
+#ifndef PAWR_SECURITY_SUBEVENT_BUDGET_US
+#define PAWR_SECURITY_SUBEVENT_BUDGET_US  10000
+#endif
+
+/***************************************************************************//**
+ * @brief Security statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t sequence;            // Last sequence number used
+  uint32_t replays;             // Responses to unknown or old sequence numbers
+  uint32_t failures;            // Responses failing authentication
+  uint32_t revoked;             // Responses in slots without a member
+  uint32_t over_budget;         // Responses dropped, the subevent budget spent
+  uint32_t subevent_us_max;     // Longest time spent on the responses of a subevent
+  uint16_t slots_per_budget;    // Responses that fit in the budget at the average cost
+} pawr_security_stats_t;
+
+/***************************************************************************//**
+ *
+ * Load the network key material and the sequence number from NVM3, or
+ * create them on the first start.
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_security_init(void);
+
+/***************************************************************************//**
+ *
+ * Get the data a scanner needs to join the encrypted network, and make it
+ * the member answering in a slot. The scanner gets a new member ID, taken
+ * from the sequence numbers, so no two scanners ever seal with the same
+ * nonce source, even after one of them was given the slot of the other.
+ *
+ * @param[in] slot Slot assigned to the scanner
+ * @param[out] data PAWR_CRYPTO_PROVISIONING_LEN bytes
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_security_get_provisioning_data(pawr_slot_t slot, uint8_t *data);
+
+/***************************************************************************//**
+ *
+ * Stop accepting the responses of the member of a slot, e.g. when the slot
+ * is reclaimed. The slot accepts responses again once it is provisioned.
+ *
+ * @param[in] slot The slot
+ *
+ ******************************************************************************/
+void pawr_security_revoke(pawr_slot_t slot);
+
+/***************************************************************************//**
+ *
+ * Encrypt the data of a subevent under a new sequence number.
+ *
+ * @param[in] subevent The subevent
+ * @param[in] in The plaintext subevent data
+ * @param[in] len Length of the plaintext
+ * @param[out] out The encrypted data, len + PAWR_CRYPTO_OVERHEAD bytes
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_security_seal_subevent(uint8_t subevent,
+                                        const uint8_t *in,
+                                        uint8_t len,
+                                        uint8_t *out);
+
+/***************************************************************************//**
+ *
+ * Authenticate and decrypt a response with the member ID of the slot.
+ * Responses to sequence numbers that were not sent recently in the subevent,
+ * or that were already answered by the slot, are rejected as replays.
+ * Responses in a slot without a member are rejected.
+ *
+ * @param[in] slot Slot of the response
+ * @param[in] in The response data
+ * @param[in] len Length of the response data
+ * @param[out] out The plaintext, up to len - PAWR_CRYPTO_OVERHEAD bytes
+ * @param[out] out_len Length of the plaintext
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_security_open_response(pawr_slot_t slot,
+                                        const uint8_t *in,
+                                        uint8_t len,
+                                        uint8_t *out,
+                                        uint8_t *out_len);
+
+/***************************************************************************//**
+ *
+ * Get the security statistics. The cost of the operations themselves is
+ * given by pawr_crypto_get_stats().
+ *
+ * @param[out] stats The statistics
+ *
+ ******************************************************************************/
+void pawr_security_get_stats(pawr_security_stats_t *stats);
+
+#endif // PAWR_SECURITY_H
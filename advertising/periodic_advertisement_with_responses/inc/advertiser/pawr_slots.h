@@ -0,0 +1,202 @@
+/***************************************************************************//**
+ * @file pawr_slots.h
+ * @brief PAwR response slot allocator.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef PAWR_SLOTS_H
+#define PAWR_SLOTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Capacity of the allocator. The train may use fewer subevents and slots,
+// see pawr_slots_init(). Each slot takes 7 bytes of RAM.
+#ifndef PAWR_SLOTS_MAX_SUBEVENTS
+#define PAWR_SLOTS_MAX_SUBEVENTS        4
+#endif
+#ifndef PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT
+#define PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT 250
+#endif
+
+// A slot is reclaimed after this many consecutive missed responses.
+#ifndef PAWR_SLOTS_RECLAIM_MISSES
+#define PAWR_SLOTS_RECLAIM_MISSES       20
+#endif
+
+// Store the assignments in NVM3, so a rebooted advertiser gives returning
+// responders their old slots. Set to 0 to build the allocator without the
+// SDK, e.g. for the simulation.
+#ifndef PAWR_SLOTS_PERSIST
+#define PAWR_SLOTS_PERSIST              1
+#endif
+
+// Slots stored per NVM3 object, at most 32. An object holds the addresses of
+// a group of slots and exists only while one of them is occupied. With the
+// default capacity the assignments take at most 32 objects, read in as many
+// calls at boot, and an object is 196 bytes.
+#ifndef PAWR_SLOTS_NVM3_GROUP_SIZE
+#define PAWR_SLOTS_NVM3_GROUP_SIZE      32
+#endif
+
+// First NVM3 key of the assignments. One key per group of slots is reserved.
+#ifndef PAWR_SLOTS_NVM3_KEY_BASE
+#define PAWR_SLOTS_NVM3_KEY_BASE        0x01000
+#endif
+
+#define PAWR_SLOTS_ADDRESS_LEN          6
+
+/***************************************************************************//**
+ * @brief Response slot of a responder
+ ******************************************************************************/
+typedef struct {
+  uint8_t subevent;
+  uint8_t slot;
+} pawr_slot_t;
+
+/***************************************************************************//**
+ * @brief Allocator statistics
+ ******************************************************************************/
+typedef struct {
+  uint16_t allocated;         // Occupied slots
+  uint16_t subevents_in_use;  // Subevents with at least one occupied slot
+  uint32_t allocations;       // New assignments
+  uint32_t reassignments;     // Returning responders given their old slot
+  uint32_t frees;             // Slots freed by the application
+  uint32_t reclaims;          // Slots reclaimed after missed responses
+  uint32_t failures;          // Allocations refused because the train is full
+} pawr_slots_stats_t;
+
+/***************************************************************************//**
+ * @brief Called when a slot is reclaimed after missed responses
+ *
+ * @param[in] slot The reclaimed slot
+ * @param[in] address Address of the responder that owned it
+ ******************************************************************************/
+typedef void (*pawr_slots_reclaim_cb_t)(pawr_slot_t slot, const uint8_t *address);
+
+/***************************************************************************//**
+ *
+ * Set up the allocator for the geometry of the train and load the stored
+ * assignments.
+ *
+ * @param[in] num_subevents Number of subevents of the train
+ * @param[in] slots_per_subevent Number of response slots per subevent
+ * @param[in] reclaim_cb Reclaim callback, may be NULL
+ *
+ * @return false if the geometry exceeds the capacity of the allocator
+ *
+ ******************************************************************************/
+bool pawr_slots_init(uint8_t num_subevents,
+                     uint8_t slots_per_subevent,
+                     pawr_slots_reclaim_cb_t reclaim_cb);
+
+/***************************************************************************//**
+ *
+ * Assign a slot to a responder. A responder that already owns a slot gets
+ * the same one back. New responders are packed into the fullest subevent
+ * that still has room, at its lowest free slot, so traffic concentrates on
+ * as few subevents and as short response windows as possible.
+ *
+ * @param[in] address Address of the responder, 6 bytes
+ * @param[out] slot The assigned slot
+ *
+ * @return false if all slots are taken
+ *
+ ******************************************************************************/
+bool pawr_slots_allocate(const uint8_t *address, pawr_slot_t *slot);
+
+/***************************************************************************//**
+ *
+ * Free the slot of a responder that has left the network.
+ *
+ * @param[in] address Address of the responder, 6 bytes
+ *
+ * @return false if the responder owns no slot
+ *
+ ******************************************************************************/
+bool pawr_slots_free(const uint8_t *address);
+
+/***************************************************************************//**
+ *
+ * Find the slot owned by a responder.
+ *
+ * @param[in] address Address of the responder, 6 bytes
+ * @param[out] slot The slot of the responder
+ *
+ * @return false if the responder owns no slot
+ *
+ ******************************************************************************/
+bool pawr_slots_find(const uint8_t *address, pawr_slot_t *slot);
+
+/***************************************************************************//**
+ *
+ * Retrieve the owner of a slot.
+ *
+ * @param[in] slot The slot
+ *
+ * @return Address of the owner, NULL if the slot is free
+ *
+ ******************************************************************************/
+const uint8_t *pawr_slots_get_owner(pawr_slot_t slot);
+
+/***************************************************************************//**
+ *
+ * Record the outcome of a response slot. Call it for every slot requested in
+ * a subevent. Reclaims the slot after PAWR_SLOTS_RECLAIM_MISSES consecutive
+ * misses.
+ *
+ * @param[in] slot The slot
+ * @param[in] received true if a response was received in the slot
+ *
+ * @return true if the slot was reclaimed
+ *
+ ******************************************************************************/
+bool pawr_slots_on_response(pawr_slot_t slot, bool received);
+
+/***************************************************************************//**
+ *
+ * Retrieve the response slots to request in a subevent: from slot 0 up to
+ * the highest occupied slot.
+ *
+ * @param[in] subevent Subevent index
+ *
+ * @return Number of response slots, 0 if the subevent carries no traffic
+ *
+ ******************************************************************************/
+uint8_t pawr_slots_get_response_slot_count(uint8_t subevent);
+
+/***************************************************************************//**
+ *
+ * Retrieve the allocator statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void pawr_slots_get_stats(pawr_slots_stats_t *stats);
+
+#endif // PAWR_SLOTS_H
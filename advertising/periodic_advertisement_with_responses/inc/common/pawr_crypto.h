@@ -0,0 +1,149 @@
+/***************************************************************************//**
+ * @file pawr_crypto.h
+ * @brief Encrypted PAwR payloads.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef PAWR_CRYPTO_H
+#define PAWR_CRYPTO_H
+
+#include <stdint.h>
+#include "sl_status.h"
+#include "sl_bt_ead_core.h"
+
+// 1: the subevent data and the responses are encrypted and authenticated
+// in the Encrypted Data AD format, under a key shared by the network. Must
+// be set the same on the advertiser and the scanners.
+#ifndef PAWR_ENCRYPTION
+#define PAWR_ENCRYPTION                 0
+#endif
+
+// Bytes added to a payload: length, AD type, randomizer and MIC
+#define PAWR_CRYPTO_OVERHEAD            (2 + SL_BT_EAD_RANDOMIZER_SIZE + SL_BT_EAD_MIC_SIZE)
+
+// Provisioning data of a scanner: the key material of the network, the
+// current sequence number of the advertiser, then the member ID of the
+// scanner, 4 bytes little endian each
+#define PAWR_CRYPTO_PROVISIONING_LEN    (SL_BT_EAD_KEY_MATERIAL_SIZE + 8)
+
+// Source of a payload: the advertiser, or the member ID of a scanner. The
+// source is mixed into the nonce, so each one has its own nonce space under
+// the shared key. A member ID is given to a scanner each time it is
+// provisioned and never given again, unlike its response slot, which is
+// given to another scanner once reclaimed.
+#define PAWR_CRYPTO_SOURCE_ADVERTISER   0xFFFFFFFF
+
+/***************************************************************************//**
+ * @brief Cost of the cryptographic operations
+ ******************************************************************************/
+typedef struct {
+  uint32_t sealed;              // Payloads encrypted
+  uint32_t opened;              // Payloads decrypted and authenticated
+  uint32_t failures;            // Payloads malformed or failing authentication
+  uint32_t sealed_bytes;
+  uint32_t opened_bytes;
+  uint32_t seal_us_average;
+  uint32_t seal_us_max;
+  uint32_t open_us_average;
+  uint32_t open_us_max;
+} pawr_crypto_stats_t;
+
+/***************************************************************************//**
+ *
+ * Set the key material of the network and start the cycle counter used to
+ * time the operations. The key material replaces the one of a previous
+ * call; it is used directly by the EAD core, without any PSA key.
+ *
+ * @param[in] key_material Session key then IV, SL_BT_EAD_KEY_MATERIAL_SIZE
+ *                         bytes
+ *
+ ******************************************************************************/
+void pawr_crypto_init(const uint8_t *key_material);
+
+/***************************************************************************//**
+ *
+ * Encrypt a payload into an Encrypted Data AD structure. The sequence number
+ * is sent as the randomizer; the same sequence number must never be sealed
+ * twice by the same source.
+ *
+ * @param[in] source PAWR_CRYPTO_SOURCE_ADVERTISER or the member ID
+ * @param[in] sequence Sequence number
+ * @param[in] in The payload
+ * @param[in] len Length of the payload
+ * @param[out] out The AD structure, len + PAWR_CRYPTO_OVERHEAD bytes
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_crypto_seal(uint32_t source,
+                             uint32_t sequence,
+                             const uint8_t *in,
+                             uint8_t len,
+                             uint8_t *out);
+
+/***************************************************************************//**
+ *
+ * Authenticate and decrypt an Encrypted Data AD structure. Replays are not
+ * detected here: the caller checks the sequence number.
+ *
+ * @param[in] source PAWR_CRYPTO_SOURCE_ADVERTISER or the member ID
+ * @param[in] in The AD structure
+ * @param[in] len Length of the data holding the AD structure
+ * @param[out] out The payload, up to len - PAWR_CRYPTO_OVERHEAD bytes
+ * @param[out] out_len Length of the payload
+ * @param[out] sequence Sequence number the payload was sealed with
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_crypto_open(uint32_t source,
+                             const uint8_t *in,
+                             uint8_t len,
+                             uint8_t *out,
+                             uint8_t *out_len,
+                             uint32_t *sequence);
+
+/***************************************************************************//**
+ *
+ * Get the duration of the last seal or open operation.
+ *
+ * @return Duration in microseconds
+ *
+ ******************************************************************************/
+uint32_t pawr_crypto_get_last_us(void);
+
+/***************************************************************************//**
+ *
+ * Get the cost of the operations so far.
+ *
+ * @param[out] stats The statistics
+ *
+ ******************************************************************************/
+void pawr_crypto_get_stats(pawr_crypto_stats_t *stats);
+
+#endif // PAWR_CRYPTO_H
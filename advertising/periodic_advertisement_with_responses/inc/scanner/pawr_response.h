@@ -0,0 +1,143 @@
+/***************************************************************************//**
+ * @file pawr_response.h
+ * @brief Staged response data of a PAwR scanner.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+
+#ifndef PAWR_RESPONSE_H
+#define PAWR_RESPONSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+#include "pawr_crypto.h"
+
+// Longest response, acknowledgement and encryption included. The response
+// has to fit in the response slot: on the 1M PHY each byte takes 8 us on
+// air, on top of about 14 bytes of packet overhead. With the 0.375 ms slot
+// spacing of the sample advertiser, 30 bytes fit.
+#ifndef PAWR_RESPONSE_MAX_LEN
+#define PAWR_RESPONSE_MAX_LEN           30
+#endif
+
+// 1: the first byte of the response acknowledges the downlink message last
+// received, as expected by pawr_downlink.c of the advertiser.
+#ifndef PAWR_RESPONSE_INCLUDE_ACK
+#define PAWR_RESPONSE_INCLUDE_ACK       1
+#endif
+
+#if PAWR_ENCRYPTION
+#define PAWR_RESPONSE_PLAINTEXT_LEN     (PAWR_RESPONSE_MAX_LEN - PAWR_CRYPTO_OVERHEAD)
+#else
+#define PAWR_RESPONSE_PLAINTEXT_LEN     PAWR_RESPONSE_MAX_LEN
+#endif
+
+#if PAWR_RESPONSE_INCLUDE_ACK
+#define PAWR_RESPONSE_MAX_PAYLOAD_LEN   (PAWR_RESPONSE_PLAINTEXT_LEN - 1)
+#else
+#define PAWR_RESPONSE_MAX_PAYLOAD_LEN   PAWR_RESPONSE_PLAINTEXT_LEN
+#endif
+
+/***************************************************************************//**
+ * @brief Response statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t committed;           // Responses handed to the stack
+  uint32_t failures;            // Responses refused by the stack
+  uint32_t repeats;             // Responses sent again for lack of a new payload
+  uint32_t handler_us;          // Handler execution time of the last report
+  uint32_t handler_us_average;
+  uint32_t handler_us_max;
+} pawr_response_stats_t;
+
+/***************************************************************************//**
+ *
+ * Clear the buffers and the statistics, and start the cycle counter used to
+ * time the subevent report handler.
+ *
+ ******************************************************************************/
+void pawr_response_init(void);
+
+/***************************************************************************//**
+ *
+ * Stage the payload of the next response. It is copied into the staging
+ * buffer, and sent from the next subevent report on. Until a payload is
+ * staged again, the same payload is repeated in every response. Call it
+ * from the main loop, ahead of the subevent.
+ *
+ * @param[in] payload The payload
+ * @param[in] len Length of the payload, at most PAWR_RESPONSE_MAX_PAYLOAD_LEN
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_response_stage(const uint8_t *payload, uint8_t len);
+
+/***************************************************************************//**
+ *
+ * Mark the start of the subevent report handler. Call it first thing in the
+ * handler; the time until pawr_response_commit() returns is measured.
+ *
+ ******************************************************************************/
+void pawr_response_begin(void);
+
+/***************************************************************************//**
+ *
+ * Send the staged response in the slot of the scanner. Only the
+ * acknowledgement is written, the payload was prepared beforehand. With
+ * PAWR_ENCRYPTION, the response is encrypted under the sequence number of
+ * the subevent data it answers.
+ *
+ * @param[in] report The subevent report being handled
+ * @param[in] slot Response slot of the scanner
+ * @param[in] ack Sequence number of the downlink message to acknowledge,
+ *                ignored if PAWR_RESPONSE_INCLUDE_ACK is 0
+ * @param[in] member Member ID given at provisioning, the nonce source,
+ *                   ignored if PAWR_ENCRYPTION is 0
+ * @param[in] sequence Sequence number of the authenticated subevent data,
+ *                     ignored if PAWR_ENCRYPTION is 0
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t pawr_response_commit(const sl_bt_evt_pawr_sync_subevent_report_t *report,
+                                 uint8_t slot,
+                                 uint8_t ack,
+                                 uint32_t member,
+                                 uint32_t sequence);
+
+/***************************************************************************//**
+ *
+ * Get the response statistics.
+ *
+ * @param[out] stats The statistics
+ *
+ ******************************************************************************/
+void pawr_response_get_stats(pawr_response_stats_t *stats);
+
+#endif // PAWR_RESPONSE_H
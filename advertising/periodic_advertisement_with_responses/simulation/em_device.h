@@ -0,0 +1,58 @@
+/***************************************************************************//**
+ * @file em_device.h
+ * @brief Host stand-in for the device header of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only the cycle counter pawr_response.c times the handler with, so it
+ * builds on a PC. The simulation advances the counter itself. */
+
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+#include <stdint.h>
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern CoreDebug_Type sim_core_debug;
+extern DWT_Type sim_dwt;
+
+#define CoreDebug                     (&sim_core_debug)
+#define DWT                           (&sim_dwt)
+#define CoreDebug_DEMCR_TRCENA_Msk    (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk        (1UL << 0)
+
+uint32_t SystemCoreClockGet(void);
+
+#endif // EM_DEVICE_H
@@ -0,0 +1,646 @@
+/***************************************************************************//**
+ * @file pawr_provisioning_sim.c
+ * @brief Host simulation of the PAwR provisioning pipeline.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Runs the provisioning pipeline against a simulated stack and a population
+ * of scanners, on a simulated clock of one millisecond per step. Connections
+ * are not established, drop, stall in a GATT procedure, fail bonding, and
+ * scanners close the connection after the sync transfer without having
+ * synced. The simulation checks that the scanners are provisioned in
+ * parallel, that every failed attempt is counted and retried until all the
+ * scanners respond in the train, and that no scanner is counted as
+ * provisioned before it responds. Build and run on a PC:
+ *
+ *   gcc -std=c11 -DPAWR_SLOTS_PERSIST=0 -I. -I../inc/advertiser -I../inc/common \
+ *       pawr_provisioning_sim.c ../src/pawr_advertiser/pawr_provisioning.c \
+ *       ../src/pawr_advertiser/pawr_slots.c -o pawr_provisioning_sim
+ *   ./pawr_provisioning_sim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sl_bluetooth.h"
+#include "sl_sleeptimer.h"
+#include "pawr_slots.h"
+#include "pawr_provisioning.h"
+
+#define NUM_SCANNERS            40
+#define NUM_SUBEVENTS           4
+#define SLOTS_PER_SUBEVENT      250
+#define DURATION_MS             (20 * 60 * 1000)
+#define REPORT_INTERVAL_MS      (60 * 1000)
+#define ADV_INTERVAL_MS         100
+#define PAWR_INTERVAL_MS        3000    // Periodic advertising interval of the sample
+#define MAX_QUEUED_EVENTS       128
+
+// Durations of the simulated procedures
+#define CONNECT_MS              60
+#define SECURITY_MS             150
+#define GATT_MS                 40
+#define PAST_MS                 200
+#define CLOSE_MS                10
+
+// Faults, in parts per million
+#define CONNECT_FAIL_PPM        50000   // The connection is never established
+#define BONDING_FAIL_PPM        30000   // Bonding fails
+#define DROP_PPM                20000   // The connection drops, per procedure
+#define STALL_PPM               20000   // A GATT procedure never completes, per procedure
+#define SYNC_FAIL_PPM           150000  // The scanner closes after PAST without syncing
+#define MISS_PPM                50000   // A synced scanner misses its response
+
+#define SUPERVISION_TIMEOUT     0x1008
+#define LOCAL_TERMINATION       0x1016
+#define REMOTE_TERMINATION      0x1013
+
+#define NO_CONNECTION           0
+#define SERVICE_HANDLE          0x00010010
+#define CHARACTERISTIC_HANDLE   0x0012
+
+typedef enum {
+  scanner_advertising,
+  scanner_connecting,
+  scanner_connected,
+  scanner_synced
+} scanner_state_t;
+
+typedef struct {
+  bd_addr address;
+  scanner_state_t state;
+  uint8_t connection;
+  bool stalled;                 // Stopped answering on this connection
+  bool slot_written;
+  pawr_slot_t slot;
+  uint32_t next_adv_ms;
+} scanner_t;
+
+typedef enum {
+  action_event,                 // Deliver the message to the pipeline
+  action_sync                   // The scanner syncs to the train
+} action_t;
+
+typedef struct {
+  uint32_t time_ms;
+  uint32_t order;
+  action_t action;
+  uint8_t connection;
+  uint16_t scanner;
+  sl_bt_msg_t msg;
+} queued_event_t;
+
+static const uint8_t pawr_sync_service[2] = { 0xAA, 0xAA };
+static const uint8_t pawr_sync_char[2]    = { 0xBB, 0xBB };
+
+static scanner_t scanners[NUM_SCANNERS];
+static queued_event_t queue[MAX_QUEUED_EVENTS];
+static uint8_t queue_len = 0;
+static uint32_t queue_order = 0;
+static uint32_t now = 0;
+static bool scanning = false;
+static sl_sleeptimer_timer_handle_t *timer = NULL;
+
+// Scanner on each connection handle, from 1, and whether it is being closed
+static int16_t connection_owner[PAWR_PROVISIONING_MAX_PEERS + 1];
+static bool connection_closing[PAWR_PROVISIONING_MAX_PEERS + 1];
+static uint8_t connections_in_use = 0;
+static uint8_t max_connections_in_use = 0;
+
+static uint32_t attempts = 0;
+static uint32_t syncs = 0;
+static uint32_t counted_before_sync = 0;
+static uint32_t errors = 0;
+
+static bool chance(uint32_t ppm)
+{
+  return (uint32_t)(rand() % 1000000) < ppm;
+}
+
+static void check(bool condition, const char *what)
+{
+  if (!condition) {
+    printf("%8lu ms: %s\n", (unsigned long)now, what);
+    errors++;
+  }
+}
+
+static queued_event_t *queue_event(uint32_t delay_ms, uint8_t connection, uint32_t id)
+{
+  queued_event_t *event;
+
+  if (queue_len == MAX_QUEUED_EVENTS) {
+    printf("event queue full\n");
+    exit(1);
+  }
+  event = &queue[queue_len++];
+  memset(event, 0, sizeof(*event));
+  event->time_ms = now + delay_ms;
+  event->order = queue_order++;
+  event->action = action_event;
+  event->connection = connection;
+  event->msg.header = id;
+  return event;
+}
+
+// Drop what is pending on a connection that is being closed
+static void cancel_events(uint8_t connection)
+{
+  uint8_t i = 0;
+
+  while (i < queue_len) {
+    if (queue[i].connection == connection) {
+      queue[i] = queue[--queue_len];
+    } else {
+      i++;
+    }
+  }
+}
+
+static void queue_closed(uint8_t connection, uint32_t delay_ms, uint16_t reason)
+{
+  queued_event_t *event;
+
+  cancel_events(connection);
+  connection_closing[connection] = true;
+  event = queue_event(delay_ms, NO_CONNECTION, sl_bt_evt_connection_closed_id);
+  event->msg.data.evt_connection_closed.connection = connection;
+  event->msg.data.evt_connection_closed.reason = reason;
+}
+
+static scanner_t *scanner_on(uint8_t connection)
+{
+  if (connection == NO_CONNECTION || connection > PAWR_PROVISIONING_MAX_PEERS
+      || connection_owner[connection] < 0 || connection_closing[connection]) {
+    return NULL;
+  }
+  return &scanners[connection_owner[connection]];
+}
+
+// Faults common to the procedures of a connected scanner. Returns true if
+// the procedure goes on.
+static bool procedure_goes_on(uint8_t connection, scanner_t *scanner)
+{
+  if (scanner->stalled) {
+    return false;
+  }
+  if (chance(DROP_PPM)) {
+    queue_closed(connection, GATT_MS, SUPERVISION_TIMEOUT);
+    return false;
+  }
+  if (chance(STALL_PPM)) {
+    scanner->stalled = true;
+    return false;
+  }
+  return true;
+}
+
+static void queue_procedure_completed(uint8_t connection, uint32_t delay_ms)
+{
+  queued_event_t *event = queue_event(delay_ms, connection, sl_bt_evt_gatt_procedure_completed_id);
+
+  event->msg.data.evt_gatt_procedure_completed.connection = connection;
+  event->msg.data.evt_gatt_procedure_completed.result = 0;
+}
+
+/*******************************************************************************
+ * Simulated sleeptimer
+ ******************************************************************************/
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  return now;
+}
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms)
+{
+  *ms = tick;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                                  uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback,
+                                                  void *callback_data,
+                                                  uint8_t priority,
+                                                  uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+  handle->callback = callback;
+  handle->data = callback_data;
+  handle->period_ms = timeout_ms;
+  handle->next_ms = now + timeout_ms;
+  timer = handle;
+  return SL_STATUS_OK;
+}
+
+/*******************************************************************************
+ * Simulated stack
+ ******************************************************************************/
+
+sl_status_t sl_bt_external_signal(uint32_t signals)
+{
+  queued_event_t *event = queue_event(0, NO_CONNECTION, sl_bt_evt_system_external_signal_id);
+
+  event->msg.data.evt_system_external_signal.extsignals = signals;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_start(uint8_t scanning_phy, uint8_t discover_mode)
+{
+  (void)scanning_phy;
+  (void)discover_mode;
+  scanning = true;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_scanner_stop(void)
+{
+  scanning = false;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_open(bd_addr address,
+                                  uint8_t address_type,
+                                  uint8_t initiating_phy,
+                                  uint8_t *connection)
+{
+  uint16_t index = (uint16_t)(address.addr[0] | (address.addr[1] << 8));
+  scanner_t *scanner = &scanners[index];
+  queued_event_t *event;
+  uint8_t handle;
+
+  (void)address_type;
+  (void)initiating_phy;
+  check(scanner->state == scanner_advertising, "connection to a scanner that does not advertise");
+  for (handle = 1; handle <= PAWR_PROVISIONING_MAX_PEERS; handle++) {
+    if (connection_owner[handle] < 0) {
+      break;
+    }
+  }
+  if (handle > PAWR_PROVISIONING_MAX_PEERS) {
+    check(false, "more connections opened than PAWR_PROVISIONING_MAX_PEERS");
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  connection_owner[handle] = (int16_t)index;
+  connection_closing[handle] = false;
+  if (++connections_in_use > max_connections_in_use) {
+    max_connections_in_use = connections_in_use;
+  }
+  attempts++;
+  scanner->state = scanner_connecting;
+  scanner->connection = handle;
+  scanner->stalled = false;
+  scanner->slot_written = false;
+  *connection = handle;
+  // A failed connection is never opened, until the pipeline cancels it
+  if (!chance(CONNECT_FAIL_PPM)) {
+    event = queue_event(CONNECT_MS, handle, sl_bt_evt_connection_opened_id);
+    event->msg.data.evt_connection_opened.connection = handle;
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_connection_close(uint8_t connection)
+{
+  if (connection == NO_CONNECTION || connection > PAWR_PROVISIONING_MAX_PEERS
+      || connection_owner[connection] < 0 || connection_closing[connection]) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  queue_closed(connection, CLOSE_MS, LOCAL_TERMINATION);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_increase_security(uint8_t connection)
+{
+  scanner_t *scanner = scanner_on(connection);
+  queued_event_t *event;
+
+  if (scanner == NULL) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  if (chance(DROP_PPM)) {
+    queue_closed(connection, SECURITY_MS, SUPERVISION_TIMEOUT);
+  } else if (chance(BONDING_FAIL_PPM)) {
+    event = queue_event(SECURITY_MS, connection, sl_bt_evt_sm_bonding_failed_id);
+    event->msg.data.evt_sm_bonding_failed.connection = connection;
+  } else {
+    event = queue_event(SECURITY_MS, connection, sl_bt_evt_connection_parameters_id);
+    event->msg.data.evt_connection_parameters.connection = connection;
+    event->msg.data.evt_connection_parameters.security_mode = 1;
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_sm_bonding_confirm(uint8_t connection, uint8_t confirm)
+{
+  (void)connection;
+  (void)confirm;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_discover_primary_services_by_uuid(uint8_t connection,
+                                                         size_t uuid_len,
+                                                         const uint8_t *uuid)
+{
+  scanner_t *scanner = scanner_on(connection);
+  queued_event_t *event;
+
+  if (scanner == NULL) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  check(uuid_len == sizeof(pawr_sync_service)
+        && memcmp(uuid, pawr_sync_service, uuid_len) == 0,
+        "discovery of another service");
+  if (procedure_goes_on(connection, scanner)) {
+    event = queue_event(GATT_MS, connection, sl_bt_evt_gatt_service_id);
+    event->msg.data.evt_gatt_service.connection = connection;
+    event->msg.data.evt_gatt_service.service = SERVICE_HANDLE;
+    event->msg.data.evt_gatt_service.uuid.len = sizeof(pawr_sync_service);
+    memcpy(event->msg.data.evt_gatt_service.uuid.data, pawr_sync_service,
+           sizeof(pawr_sync_service));
+    queue_procedure_completed(connection, GATT_MS);
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_discover_characteristics_by_uuid(uint8_t connection,
+                                                        uint32_t service,
+                                                        size_t uuid_len,
+                                                        const uint8_t *uuid)
+{
+  scanner_t *scanner = scanner_on(connection);
+  queued_event_t *event;
+
+  if (scanner == NULL) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  check(service == SERVICE_HANDLE, "characteristic discovery in another service");
+  check(uuid_len == sizeof(pawr_sync_char)
+        && memcmp(uuid, pawr_sync_char, uuid_len) == 0,
+        "discovery of another characteristic");
+  if (procedure_goes_on(connection, scanner)) {
+    event = queue_event(GATT_MS, connection, sl_bt_evt_gatt_characteristic_id);
+    event->msg.data.evt_gatt_characteristic.connection = connection;
+    event->msg.data.evt_gatt_characteristic.characteristic = CHARACTERISTIC_HANDLE;
+    event->msg.data.evt_gatt_characteristic.uuid.len = sizeof(pawr_sync_char);
+    memcpy(event->msg.data.evt_gatt_characteristic.uuid.data, pawr_sync_char,
+           sizeof(pawr_sync_char));
+    queue_procedure_completed(connection, GATT_MS);
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_write_characteristic_value(uint8_t connection,
+                                                  uint16_t characteristic,
+                                                  size_t value_len,
+                                                  const uint8_t *value)
+{
+  scanner_t *scanner = scanner_on(connection);
+
+  if (scanner == NULL) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  check(characteristic == CHARACTERISTIC_HANDLE && value_len >= 2,
+        "slot written to another characteristic");
+  if (procedure_goes_on(connection, scanner)) {
+    scanner->slot.slot = value[0];
+    scanner->slot.subevent = value[1];
+    scanner->slot_written = true;
+    queue_procedure_completed(connection, GATT_MS);
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_advertiser_past_transfer(uint8_t connection,
+                                           uint16_t service_data,
+                                           uint8_t advertising_set)
+{
+  scanner_t *scanner = scanner_on(connection);
+  queued_event_t *event;
+
+  (void)service_data;
+  (void)advertising_set;
+  if (scanner == NULL) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  check(scanner->slot_written, "sync transfer before the slot is written");
+  if (!procedure_goes_on(connection, scanner)) {
+    return SL_STATUS_OK;
+  }
+  // Either way, the scanner closes the connection
+  if (!chance(SYNC_FAIL_PPM)) {
+    event = queue_event(PAST_MS, NO_CONNECTION, 0);
+    event->action = action_sync;
+    event->scanner = (uint16_t)(scanner - scanners);
+  }
+  queue_closed(connection, PAST_MS + CLOSE_MS, REMOTE_TERMINATION);
+  return SL_STATUS_OK;
+}
+
+/*******************************************************************************
+ * Simulation
+ ******************************************************************************/
+
+static void deliver(queued_event_t *event)
+{
+  uint8_t connection;
+  scanner_t *scanner;
+
+  if (event->action == action_sync) {
+    scanner = &scanners[event->scanner];
+    scanner->state = scanner_synced;
+    syncs++;
+    return;
+  }
+
+  if (SL_BT_MSG_ID(event->msg.header) == sl_bt_evt_connection_closed_id) {
+    connection = event->msg.data.evt_connection_closed.connection;
+    scanner = &scanners[connection_owner[connection]];
+    if (scanner->state != scanner_synced) {
+      scanner->state = scanner_advertising;
+      scanner->next_adv_ms = now + ADV_INTERVAL_MS;
+    }
+    scanner->connection = NO_CONNECTION;
+    connection_owner[connection] = -1;
+    connection_closing[connection] = false;
+    connections_in_use--;
+  } else if (SL_BT_MSG_ID(event->msg.header) == sl_bt_evt_connection_opened_id) {
+    scanners[connection_owner[event->connection]].state = scanner_connected;
+  }
+  pawr_provisioning_on_event(&event->msg);
+}
+
+// Earliest due event, in the order of queueing
+static bool pop_due_event(queued_event_t *out)
+{
+  int16_t first = -1;
+
+  for (uint8_t i = 0; i < queue_len; i++) {
+    if (queue[i].time_ms <= now
+        && (first < 0 || queue[i].time_ms < queue[first].time_ms
+            || (queue[i].time_ms == queue[first].time_ms
+                && queue[i].order < queue[first].order))) {
+      first = i;
+    }
+  }
+  if (first < 0) {
+    return false;
+  }
+  *out = queue[first];
+  queue[first] = queue[--queue_len];
+  return true;
+}
+
+static void advertise(scanner_t *scanner)
+{
+  static const uint8_t adv_data[] = { 0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xAA };
+  sl_bt_msg_t msg;
+
+  scanner->next_adv_ms = now + ADV_INTERVAL_MS + (uint32_t)(rand() % 10);
+  if (!scanning) {
+    return;
+  }
+  memset(&msg, 0, sizeof(msg));
+  msg.header = sl_bt_evt_scanner_legacy_advertisement_report_id;
+  msg.data.evt_scanner_legacy_advertisement_report.event_flags =
+    SL_BT_SCANNER_EVENT_FLAG_CONNECTABLE | SL_BT_SCANNER_EVENT_FLAG_SCANNABLE;
+  msg.data.evt_scanner_legacy_advertisement_report.address = scanner->address;
+  msg.data.evt_scanner_legacy_advertisement_report.data.len = sizeof(adv_data);
+  memcpy(msg.data.evt_scanner_legacy_advertisement_report.data.data, adv_data,
+         sizeof(adv_data));
+  pawr_provisioning_on_event(&msg);
+}
+
+// Responses of the synced scanners in one periodic advertising event
+static void periodic_event(void)
+{
+  for (uint16_t i = 0; i < NUM_SCANNERS; i++) {
+    if (scanners[i].state == scanner_synced && !chance(MISS_PPM)) {
+      pawr_provisioning_on_response(scanners[i].slot);
+    }
+  }
+}
+
+int main(void)
+{
+  pawr_provisioning_stats_t stats;
+  queued_event_t event;
+  uint32_t synced = 0;
+  static const char *stage_names[PAWR_PROVISIONING_STAGE_COUNT] = {
+    "connect", "security", "discovery", "slot write", "sync transfer", "total"
+  };
+
+  srand(1);
+  if (!pawr_slots_init(NUM_SUBEVENTS, SLOTS_PER_SUBEVENT, NULL)) {
+    printf("geometry exceeds the allocator capacity\n");
+    return 1;
+  }
+  for (uint16_t i = 0; i < NUM_SCANNERS; i++) {
+    memset(&scanners[i], 0, sizeof(scanners[i]));
+    scanners[i].address.addr[0] = (uint8_t)i;
+    scanners[i].address.addr[1] = (uint8_t)(i >> 8);
+    scanners[i].next_adv_ms = (uint32_t)(rand() % ADV_INTERVAL_MS);
+  }
+  for (uint8_t i = 0; i <= PAWR_PROVISIONING_MAX_PEERS; i++) {
+    connection_owner[i] = -1;
+  }
+
+  pawr_provisioning_init(0, NULL);
+  if (pawr_provisioning_start() != SL_STATUS_OK) {
+    printf("provisioning did not start\n");
+    return 1;
+  }
+
+  printf("%8s %11s %7s %6s %9s %8s %7s %11s\n",
+         "time_s", "provisioned", "synced", "active", "failures", "timeouts",
+         "retries", "connections");
+
+  for (now = 0; now <= DURATION_MS; now++) {
+    if (timer != NULL && now >= timer->next_ms) {
+      timer->next_ms += timer->period_ms;
+      timer->callback(timer, timer->data);
+    }
+    while (pop_due_event(&event)) {
+      deliver(&event);
+    }
+    for (uint16_t i = 0; i < NUM_SCANNERS; i++) {
+      if (scanners[i].state == scanner_advertising && now >= scanners[i].next_adv_ms) {
+        advertise(&scanners[i]);
+      }
+    }
+    if (now % PAWR_INTERVAL_MS == 0) {
+      periodic_event();
+    }
+
+    // A scanner counts only once it responded
+    pawr_provisioning_get_stats(&stats);
+    if (stats.provisioned > syncs + counted_before_sync) {
+      counted_before_sync = stats.provisioned - syncs;
+    }
+
+    if (now % REPORT_INTERVAL_MS == 0 && now > 0) {
+      printf("%8lu %11lu %7lu %6u %9lu %8lu %7lu %6u of %2u\n",
+             (unsigned long)(now / 1000),
+             (unsigned long)stats.provisioned,
+             (unsigned long)syncs,
+             stats.active,
+             (unsigned long)stats.failures,
+             (unsigned long)stats.timeouts,
+             (unsigned long)stats.retries,
+             max_connections_in_use,
+             (unsigned)PAWR_PROVISIONING_MAX_PEERS);
+    }
+  }
+
+  pawr_provisioning_get_stats(&stats);
+  for (uint16_t i = 0; i < NUM_SCANNERS; i++) {
+    synced += (scanners[i].state == scanner_synced);
+  }
+  printf("\nattempts %lu, synced %lu, %lu per minute\n",
+         (unsigned long)attempts, (unsigned long)syncs, (unsigned long)stats.per_minute);
+  for (uint8_t i = 0; i < PAWR_PROVISIONING_STAGE_COUNT; i++) {
+    if (stats.stages[i].count > 0) {
+      printf("  %s: average %lu ms, max %lu ms\n",
+             stage_names[i],
+             (unsigned long)(stats.stages[i].total_ms / stats.stages[i].count),
+             (unsigned long)stats.stages[i].max_ms);
+    }
+  }
+
+  check(counted_before_sync == 0, "scanners counted as provisioned before they synced");
+  check(synced == NUM_SCANNERS, "scanners left out of the train");
+  check(stats.active == 0, "scanners still being provisioned");
+  check(stats.provisioned == syncs, "provisioned scanners differ from the synced ones");
+  check(stats.failures == attempts - syncs, "failed attempts not all counted");
+  check(stats.retries > 0, "no failed scanner retried");
+  check(max_connections_in_use > 1, "scanners not provisioned in parallel");
+  printf("errors: %lu\n", (unsigned long)errors);
+  return (errors == 0) ? 0 : 1;
+}
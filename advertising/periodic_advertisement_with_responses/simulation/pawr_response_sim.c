@@ -0,0 +1,237 @@
+/***************************************************************************//**
+ * @file pawr_response_sim.c
+ * @brief Host simulation of the response staging of the PAwR scanner.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Feeds subevent reports to pawr_response.c, with payloads staged at random
+ * between them and a simulated cycle counter that the handler advances. The
+ * simulation checks that:
+ * - every response carries the acknowledgement and the last payload staged
+ *   before the report, or repeats the previous one;
+ * - staging never modifies the response last handed to the stack;
+ * - the handler time is measured from the cycle counter, across its wrap,
+ *   and the last, average and longest times and the counts add up.
+ * Build and run on a PC, also with -DPAWR_RESPONSE_INCLUDE_ACK=0:
+ *
+ *   gcc -std=c11 -I. -I../inc/scanner -I../inc/common pawr_response_sim.c \
+ *       ../src/pawr_scanner/pawr_response.c -o pawr_response_sim
+ *   ./pawr_response_sim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "em_device.h"
+#include "sl_bluetooth.h"
+#include "pawr_response.h"
+
+#define NUM_REPORTS             100000
+#define CLOCK_HZ                39000000
+#define RESPONSE_SLOT           7
+
+// Per report probabilities, in parts per million
+#define STAGE_PPM               600000  // A payload is staged before the report
+#define STAGE_AGAIN_PPM         200000  // Staged once more, replacing it
+#define REFUSE_PPM              10000   // The stack refuses the response
+#define WRAP_PPM                5000    // The cycle counter is about to wrap
+
+// Simulated handler cost, in cycles
+#define HANDLER_MIN_CYCLES      500
+#define HANDLER_MAX_CYCLES      40000
+#define SET_RESPONSE_CYCLES     2000
+
+#if PAWR_RESPONSE_INCLUDE_ACK
+#define PAYLOAD_OFFSET          1
+#else
+#define PAYLOAD_OFFSET          0
+#endif
+
+CoreDebug_Type sim_core_debug;
+DWT_Type sim_dwt;
+
+// Last response handed to the stack, accepted or not: where it was, and a
+// copy
+static const uint8_t *sent_data = NULL;
+static uint8_t sent_copy[PAWR_RESPONSE_MAX_LEN];
+static uint8_t sent_len = 0;
+static uint8_t sent_slot = 0;
+static bool refuse = false;
+static uint32_t errors = 0;
+
+static bool chance(uint32_t ppm)
+{
+  return (uint32_t)(rand() % 1000000) < ppm;
+}
+
+static void check(bool condition, uint32_t report, const char *what)
+{
+  if (!condition) {
+    if (errors < 10) {
+      printf("report %lu: %s\n", (unsigned long)report, what);
+    }
+    errors++;
+  }
+}
+
+uint32_t SystemCoreClockGet(void)
+{
+  return CLOCK_HZ;
+}
+
+sl_status_t sl_bt_pawr_sync_set_response_data(uint16_t sync,
+                                              uint16_t event,
+                                              uint8_t request_subevent,
+                                              uint8_t response_subevent,
+                                              uint8_t response_slot,
+                                              size_t response_data_len,
+                                              const uint8_t *response_data)
+{
+  (void)sync;
+  (void)event;
+  (void)request_subevent;
+  (void)response_subevent;
+  sim_dwt.CYCCNT += SET_RESPONSE_CYCLES;
+  sent_data = response_data;
+  sent_len = (uint8_t)response_data_len;
+  sent_slot = response_slot;
+  memcpy(sent_copy, response_data, response_data_len);
+  return refuse ? SL_STATUS_FAIL : SL_STATUS_OK;
+}
+
+int main(void)
+{
+  pawr_response_stats_t stats;
+  sl_bt_evt_pawr_sync_subevent_report_t report;
+  uint8_t payload[PAWR_RESPONSE_MAX_PAYLOAD_LEN];
+  // What the next response must carry after the acknowledgement
+  uint8_t expected[PAWR_RESPONSE_MAX_PAYLOAD_LEN];
+  uint8_t expected_len = 0;
+  bool new_payload;
+  uint8_t ack;
+  uint32_t cycles;
+  uint32_t expected_us;
+  uint32_t expected_max_us = 0;
+  uint64_t total_us = 0;
+  uint32_t committed = 0;
+  uint32_t refused = 0;
+  uint32_t repeats = 0;
+  uint32_t wraps = 0;
+  sl_status_t sc;
+
+  srand(1);
+  pawr_response_init();
+  check((sim_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk)
+        && (sim_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk),
+        0, "cycle counter not enabled");
+  check(pawr_response_stage(payload, PAWR_RESPONSE_MAX_PAYLOAD_LEN + 1)
+        == SL_STATUS_INVALID_PARAMETER,
+        0, "payload longer than PAWR_RESPONSE_MAX_PAYLOAD_LEN staged");
+  memset(&report, 0, sizeof(report));
+
+  for (uint32_t i = 1; i <= NUM_REPORTS; i++) {
+    // Main loop: stage the next payload, maybe replaced before the report
+    new_payload = false;
+    if (chance(STAGE_PPM)) {
+      do {
+        uint8_t len = (uint8_t)(rand() % (PAWR_RESPONSE_MAX_PAYLOAD_LEN + 1));
+
+        for (uint8_t j = 0; j < len; j++) {
+          payload[j] = (uint8_t)rand();
+        }
+        check(pawr_response_stage(payload, len) == SL_STATUS_OK, i, "payload not staged");
+        memcpy(expected, payload, len);
+        expected_len = len;
+        new_payload = true;
+        // The response being sent is untouched by staging
+        if (sent_data != NULL) {
+          check(memcmp(sent_data, sent_copy, sent_len) == 0, i,
+                "staging modified the response handed to the stack");
+        }
+      } while (chance(STAGE_AGAIN_PPM));
+    }
+
+    // Subevent report handler
+    if (chance(WRAP_PPM)) {
+      sim_dwt.CYCCNT = 0xFFFFFFFFu - (uint32_t)(rand() % 1000);
+      wraps++;
+    }
+    refuse = chance(REFUSE_PPM);
+    ack = (uint8_t)rand();
+    cycles = HANDLER_MIN_CYCLES
+             + (uint32_t)(rand() % (HANDLER_MAX_CYCLES - HANDLER_MIN_CYCLES));
+    report.event_counter = (uint16_t)i;
+    report.subevent = (uint8_t)(i % 4);
+
+    pawr_response_begin();
+    sim_dwt.CYCCNT += cycles;
+    sc = pawr_response_commit(&report, RESPONSE_SLOT, ack, 0, 0);
+
+    cycles += SET_RESPONSE_CYCLES;
+    expected_us = (uint32_t)((uint64_t)cycles * 1000000 / CLOCK_HZ);
+    total_us += expected_us;
+    if (expected_us > expected_max_us) {
+      expected_max_us = expected_us;
+    }
+    repeats += !new_payload;
+    if (refuse) {
+      refused++;
+      check(sc != SL_STATUS_OK, i, "refused response reported as sent");
+    } else {
+      committed++;
+      check(sc == SL_STATUS_OK, i, "response not committed");
+    }
+    check(sent_slot == RESPONSE_SLOT, i, "response sent in another slot");
+    check(sent_len == PAYLOAD_OFFSET + expected_len
+          && memcmp(&sent_copy[PAYLOAD_OFFSET], expected, expected_len) == 0,
+          i, "response is not the last staged payload");
+#if PAWR_RESPONSE_INCLUDE_ACK
+    check(sent_copy[0] == ack, i, "response does not acknowledge the last message");
+#endif
+
+    pawr_response_get_stats(&stats);
+    check(stats.handler_us == expected_us, i, "handler time not measured from the cycle counter");
+  }
+
+  pawr_response_get_stats(&stats);
+  check(stats.committed == committed, NUM_REPORTS, "committed responses miscounted");
+  check(stats.failures == refused, NUM_REPORTS, "refused responses miscounted");
+  check(stats.repeats == repeats, NUM_REPORTS, "repeated payloads miscounted");
+  check(stats.handler_us_max == expected_max_us, NUM_REPORTS, "longest handler time wrong");
+  check(stats.handler_us_average == (uint32_t)(total_us / NUM_REPORTS), NUM_REPORTS,
+        "average handler time wrong");
+
+  printf("reports %lu: committed %lu, refused %lu, repeats %lu, counter wraps %lu\n",
+         (unsigned long)NUM_REPORTS, (unsigned long)stats.committed,
+         (unsigned long)stats.failures, (unsigned long)stats.repeats,
+         (unsigned long)wraps);
+  printf("handler time at %lu MHz: last %lu us, average %lu us, max %lu us\n",
+         (unsigned long)(CLOCK_HZ / 1000000), (unsigned long)stats.handler_us,
+         (unsigned long)stats.handler_us_average, (unsigned long)stats.handler_us_max);
+  printf("errors: %lu\n", (unsigned long)errors);
+  return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+/***************************************************************************//**
+ * @file pawr_slots_sim.c
+ * @brief Host simulation of the PAwR response slot allocator.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Models a network of responders joining, leaving without notice and
+ * missing responses, and reports how well the allocator keeps the train
+ * packed. The responses are also fed to the statistics collector, whose
+ * export of the whole network is checked against the same export taken in
+ * parts through a small buffer. Build and run on a PC:
+ *
+ *   gcc -std=c11 -DPAWR_SLOTS_PERSIST=0 -I../inc/advertiser \
+ *       pawr_slots_sim.c ../src/pawr_advertiser/pawr_slots.c \
+ *       ../src/pawr_advertiser/pawr_collector.c -o pawr_slots_sim
+ *   ./pawr_slots_sim
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pawr_slots.h"
+#include "pawr_collector.h"
+
+#define NUM_SUBEVENTS           4
+#define SLOTS_PER_SUBEVENT      250
+#define NUM_RESPONDERS          500
+#define NUM_EVENTS              20000
+#define REPORT_INTERVAL         2000
+#define EXPORT_PART_LEN         100
+
+// Per periodic event probabilities, in parts per million
+#define JOIN_PPM                20000   // An absent responder joins
+#define LEAVE_PPM               200     // A member leaves without notice
+#define MISS_PPM                30000   // A member misses its response
+
+typedef struct {
+  uint8_t address[PAWR_SLOTS_ADDRESS_LEN];
+  bool member;
+  pawr_slot_t slot;
+} responder_t;
+
+static responder_t responders[NUM_RESPONDERS];
+static uint32_t false_reclaims = 0;
+static uint8_t export_full[PAWR_COLLECTOR_EXPORT_HEADER_LEN
+                          + NUM_SUBEVENTS * (PAWR_COLLECTOR_EXPORT_ROUND_LEN + (SLOTS_PER_SUBEVENT + 7) / 8)
+                          + NUM_SUBEVENTS * SLOTS_PER_SUBEVENT * PAWR_COLLECTOR_EXPORT_RECORD_LEN];
+static uint8_t export_parts[sizeof(export_full)];
+
+static bool chance(uint32_t ppm)
+{
+  return (uint32_t)(rand() % 1000000) < ppm;
+}
+
+static responder_t *find_responder(const uint8_t *address)
+{
+  uint16_t index = (uint16_t)(address[0] | (address[1] << 8));
+
+  return (index < NUM_RESPONDERS) ? &responders[index] : NULL;
+}
+
+// A reclaimed responder still in the network has to rejoin.
+static void on_reclaim(pawr_slot_t slot, const uint8_t *address)
+{
+  responder_t *responder = find_responder(address);
+
+  (void)slot;
+  if (responder == NULL) {
+    return;
+  }
+  if (responder->member) {
+    responder->member = false;
+    false_reclaims++;
+  }
+}
+
+// Export the network in parts, as the advertiser logs it, and compare with
+// one export into a buffer of the whole size
+static bool check_export(size_t *len)
+{
+  uint8_t part[EXPORT_PART_LEN];
+  size_t offset = 0;
+  size_t part_len;
+
+  *len = pawr_collector_export(export_full, sizeof(export_full));
+  if (*len == 0 || *len != pawr_collector_get_export_size()) {
+    return false;
+  }
+  while ((part_len = pawr_collector_export_part(offset, part, sizeof(part))) > 0) {
+    if (offset + part_len > sizeof(export_parts)) {
+      return false;
+    }
+    memcpy(&export_parts[offset], part, part_len);
+    offset += part_len;
+  }
+  return offset == *len && memcmp(export_full, export_parts, *len) == 0;
+}
+
+int main(void)
+{
+  pawr_slots_stats_t stats;
+  uint32_t responses = 0;
+  uint32_t requested_slots = 0;
+  uint32_t busy_subevents = 0;
+  uint32_t members = 0;
+  uint32_t stale = 0;
+  uint32_t export_errors = 0;
+  size_t export_len = 0;
+
+  srand(1);
+  pawr_collector_init(NULL);
+  if (!pawr_slots_init(NUM_SUBEVENTS, SLOTS_PER_SUBEVENT, on_reclaim)) {
+    printf("geometry exceeds the allocator capacity\n");
+    return 1;
+  }
+
+  for (uint16_t i = 0; i < NUM_RESPONDERS; i++) {
+    memset(&responders[i], 0, sizeof(responders[i]));
+    responders[i].address[0] = (uint8_t)i;
+    responders[i].address[1] = (uint8_t)(i >> 8);
+  }
+
+  printf("%6s %8s %9s %9s %8s %10s %12s\n",
+         "event", "members", "allocated", "subevents", "minimum", "reclaims",
+         "false_recl.");
+
+  for (uint32_t event = 1; event <= NUM_EVENTS; event++) {
+    // Joins and silent departures
+    for (uint16_t i = 0; i < NUM_RESPONDERS; i++) {
+      responder_t *responder = &responders[i];
+
+      if (!responder->member) {
+        if (chance(JOIN_PPM) && pawr_slots_allocate(responder->address, &responder->slot)) {
+          responder->member = true;
+          pawr_collector_reset_slot(responder->slot);
+        }
+      } else if (chance(LEAVE_PPM)) {
+        responder->member = false;
+      }
+    }
+
+    // Response slots of every subevent with traffic
+    for (uint8_t subevent = 0; subevent < NUM_SUBEVENTS; subevent++) {
+      uint8_t count = pawr_slots_get_response_slot_count(subevent);
+
+      if (count == 0) {
+        continue;
+      }
+      busy_subevents++;
+      requested_slots += count;
+      for (uint8_t slot = 0; slot < count; slot++) {
+        pawr_slot_t s = { subevent, slot };
+        const uint8_t *owner = pawr_slots_get_owner(s);
+        responder_t *responder;
+        bool received = false;
+
+        if (owner == NULL) {
+          pawr_collector_on_report(s, false, 0);
+          continue;
+        }
+        responder = find_responder(owner);
+        if (responder->member && !chance(MISS_PPM)) {
+          received = true;
+          responses++;
+        }
+        pawr_collector_on_report(s, received, (int8_t)(-40 - rand() % 50));
+        (void)pawr_slots_on_response(s, received);
+      }
+    }
+
+    if (event % REPORT_INTERVAL == 0) {
+      if (!check_export(&export_len)) {
+        export_errors++;
+      }
+      members = 0;
+      for (uint16_t i = 0; i < NUM_RESPONDERS; i++) {
+        members += responders[i].member;
+      }
+      pawr_slots_get_stats(&stats);
+      printf("%6lu %8lu %9u %9u %8u %10lu %12lu\n",
+             (unsigned long)event,
+             (unsigned long)members,
+             stats.allocated,
+             stats.subevents_in_use,
+             (unsigned)((stats.allocated + SLOTS_PER_SUBEVENT - 1) / SLOTS_PER_SUBEVENT),
+             (unsigned long)stats.reclaims,
+             (unsigned long)false_reclaims);
+    }
+  }
+
+  for (uint16_t i = 0; i < NUM_RESPONDERS; i++) {
+    pawr_slot_t slot;
+
+    if (!responders[i].member && pawr_slots_find(responders[i].address, &slot)) {
+      stale++;
+    }
+  }
+  pawr_slots_get_stats(&stats);
+  printf("\nallocations %lu, reassignments %lu, failures %lu\n",
+         (unsigned long)stats.allocations,
+         (unsigned long)stats.reassignments,
+         (unsigned long)stats.failures);
+  printf("departed responders still holding a slot: %lu\n",
+         (unsigned long)stale);
+  printf("average subevents with traffic per event: %.2f\n",
+         (double)busy_subevents / NUM_EVENTS);
+  printf("requested response slots used: %.1f%%\n",
+         requested_slots ? 100.0 * responses / requested_slots : 0.0);
+  printf("export of the last report: %lu bytes, exports differing in parts of %d bytes: %lu\n",
+         (unsigned long)export_len, EXPORT_PART_LEN, (unsigned long)export_errors);
+  return (export_errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/***************************************************************************//**
+ * @file sl_bluetooth.h
+ * @brief Host stand-in for the Bluetooth API of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only what pawr_provisioning.c and pawr_response.c use, so they build on a
+ * PC without the Simplicity SDK. The commands are implemented by the
+ * simulations. */
+
+#ifndef SL_BLUETOOTH_H
+#define SL_BLUETOOTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sl_status.h"
+
+#define SL_BT_MSG_ID(header)          ((header) & 0xffff00f8)
+
+#define sl_bt_evt_system_external_signal_id               0x030100a0
+#define sl_bt_evt_scanner_legacy_advertisement_report_id  0x000500a0
+#define sl_bt_evt_connection_opened_id                    0x000600a0
+#define sl_bt_evt_connection_parameters_id                0x020600a0
+#define sl_bt_evt_connection_closed_id                    0x010600a0
+#define sl_bt_evt_gatt_service_id                         0x010900a0
+#define sl_bt_evt_gatt_characteristic_id                  0x020900a0
+#define sl_bt_evt_gatt_procedure_completed_id             0x060900a0
+#define sl_bt_evt_sm_bonding_failed_id                    0x030f00a0
+#define sl_bt_evt_sm_confirm_bonding_id                   0x090f00a0
+
+#define SL_BT_SCANNER_EVENT_FLAG_CONNECTABLE  0x01
+#define SL_BT_SCANNER_EVENT_FLAG_SCANNABLE    0x02
+
+typedef enum {
+  sl_bt_scanner_scan_phy_1m = 0x1
+} sl_bt_scanner_scan_phy_t;
+
+typedef enum {
+  sl_bt_scanner_discover_generic = 0x1
+} sl_bt_scanner_discover_mode_t;
+
+typedef enum {
+  sl_bt_gap_phy_1m = 0x1
+} sl_bt_gap_phy_t;
+
+typedef struct {
+  uint8_t addr[6];
+} bd_addr;
+
+typedef struct {
+  uint8_t len;
+  uint8_t data[31];
+} uint8array;
+
+typedef struct {
+  uint8_t event_flags;
+  bd_addr address;
+  uint8_t address_type;
+  uint8array data;
+} sl_bt_evt_scanner_legacy_advertisement_report_t;
+
+typedef struct {
+  uint16_t sync;
+  int8_t tx_power;
+  int8_t rssi;
+  uint8_t cte_type;
+  uint16_t event_counter;
+  uint8_t subevent;
+  uint8_t data_status;
+  uint8array data;
+} sl_bt_evt_pawr_sync_subevent_report_t;
+
+typedef struct {
+  uint32_t header;
+  union {
+    struct {
+      uint32_t extsignals;
+    } evt_system_external_signal;
+    sl_bt_evt_scanner_legacy_advertisement_report_t evt_scanner_legacy_advertisement_report;
+    struct {
+      uint8_t connection;
+    } evt_connection_opened;
+    struct {
+      uint8_t connection;
+      uint8_t security_mode;
+    } evt_connection_parameters;
+    struct {
+      uint16_t reason;
+      uint8_t connection;
+    } evt_connection_closed;
+    struct {
+      uint8_t connection;
+      uint32_t service;
+      uint8array uuid;
+    } evt_gatt_service;
+    struct {
+      uint8_t connection;
+      uint16_t characteristic;
+      uint8_t properties;
+      uint8array uuid;
+    } evt_gatt_characteristic;
+    struct {
+      uint8_t connection;
+      uint16_t result;
+    } evt_gatt_procedure_completed;
+    struct {
+      uint8_t connection;
+      uint16_t reason;
+    } evt_sm_bonding_failed;
+    struct {
+      uint8_t connection;
+      int8_t bonding_handle;
+    } evt_sm_confirm_bonding;
+  } data;
+} sl_bt_msg_t;
+
+sl_status_t sl_bt_external_signal(uint32_t signals);
+sl_status_t sl_bt_scanner_start(uint8_t scanning_phy, uint8_t discover_mode);
+sl_status_t sl_bt_scanner_stop(void);
+sl_status_t sl_bt_connection_open(bd_addr address,
+                                  uint8_t address_type,
+                                  uint8_t initiating_phy,
+                                  uint8_t *connection);
+sl_status_t sl_bt_connection_close(uint8_t connection);
+sl_status_t sl_bt_sm_increase_security(uint8_t connection);
+sl_status_t sl_bt_sm_bonding_confirm(uint8_t connection, uint8_t confirm);
+sl_status_t sl_bt_gatt_discover_primary_services_by_uuid(uint8_t connection,
+                                                         size_t uuid_len,
+                                                         const uint8_t *uuid);
+sl_status_t sl_bt_gatt_discover_characteristics_by_uuid(uint8_t connection,
+                                                        uint32_t service,
+                                                        size_t uuid_len,
+                                                        const uint8_t *uuid);
+sl_status_t sl_bt_gatt_write_characteristic_value(uint8_t connection,
+                                                  uint16_t characteristic,
+                                                  size_t value_len,
+                                                  const uint8_t *value);
+sl_status_t sl_bt_advertiser_past_transfer(uint8_t connection,
+                                           uint16_t service_data,
+                                           uint8_t advertising_set);
+sl_status_t sl_bt_pawr_sync_set_response_data(uint16_t sync,
+                                              uint16_t event,
+                                              uint8_t request_subevent,
+                                              uint8_t response_subevent,
+                                              uint8_t response_slot,
+                                              size_t response_data_len,
+                                              const uint8_t *response_data);
+
+#endif // SL_BLUETOOTH_H
@@ -0,0 +1,41 @@
+/***************************************************************************//**
+ * @file sl_bt_ead_core.h
+ * @brief Host stand-in for the EAD core component of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only the sizes pawr_crypto.h uses, so the advertiser modules build on a PC
+ * with PAWR_ENCRYPTION set to 0. */
+
+#ifndef SL_BT_EAD_CORE_H
+#define SL_BT_EAD_CORE_H
+
+#define SL_BT_EAD_RANDOMIZER_SIZE     5
+#define SL_BT_EAD_MIC_SIZE            4
+#define SL_BT_EAD_KEY_MATERIAL_SIZE   24
+
+#endif // SL_BT_EAD_CORE_H
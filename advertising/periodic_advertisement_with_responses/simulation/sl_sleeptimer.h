@@ -0,0 +1,62 @@
+/***************************************************************************//**
+ * @file sl_sleeptimer.h
+ * @brief Host stand-in for the sleeptimer of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only what pawr_provisioning.c uses, so it builds on a PC without the
+ * Simplicity SDK. The functions are implemented by the simulation, on its
+ * simulated clock of one tick per millisecond. */
+
+#ifndef SL_SLEEPTIMER_H
+#define SL_SLEEPTIMER_H
+
+#include <stdint.h>
+#include "sl_status.h"
+
+typedef struct sl_sleeptimer_timer_handle sl_sleeptimer_timer_handle_t;
+
+typedef void (*sl_sleeptimer_timer_callback_t)(sl_sleeptimer_timer_handle_t *handle,
+                                               void *data);
+
+struct sl_sleeptimer_timer_handle {
+  sl_sleeptimer_timer_callback_t callback;
+  void *data;
+  uint32_t period_ms;
+  uint64_t next_ms;
+};
+
+uint64_t sl_sleeptimer_get_tick_count64(void);
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms);
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                                  uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback,
+                                                  void *callback_data,
+                                                  uint8_t priority,
+                                                  uint16_t option_flags);
+
+#endif // SL_SLEEPTIMER_H
@@ -0,0 +1,47 @@
+/***************************************************************************//**
+ * @file sl_status.h
+ * @brief Host stand-in for the status codes of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only the codes the simulated modules use, so they build on a PC without
+ * the Simplicity SDK. */
+
+#ifndef SL_STATUS_H
+#define SL_STATUS_H
+
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                  ((sl_status_t)0x0000)
+#define SL_STATUS_FAIL                ((sl_status_t)0x0001)
+#define SL_STATUS_INVALID_STATE       ((sl_status_t)0x0002)
+#define SL_STATUS_INVALID_PARAMETER   ((sl_status_t)0x0021)
+#define SL_STATUS_NO_MORE_RESOURCE    ((sl_status_t)0x0019)
+
+#endif // SL_STATUS_H
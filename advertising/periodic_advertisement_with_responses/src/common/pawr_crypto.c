@@ -0,0 +1,178 @@
+/***************************************************************************//**
+ * @file pawr_crypto.c
+ * @brief Encrypted PAwR payloads.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "em_device.h"
+#include "pawr_crypto.h"
+
+// AD structure: length, type, randomizer, encrypted payload, MIC
+#define RANDOMIZER_OFFSET   2
+#define PAYLOAD_OFFSET      (RANDOMIZER_OFFSET + SL_BT_EAD_RANDOMIZER_SIZE)
+
+// The randomizer carries the sequence number in its first 4 bytes. The
+// most significant bit of the last byte is the direction bit, set as for
+// any Encrypted Data AD structure.
+#define RANDOMIZER_LAST     0x80
+
+static struct sl_bt_ead_key_material_s key_material;
+static pawr_crypto_stats_t stats;
+static uint64_t seal_us_total = 0;
+static uint64_t open_us_total = 0;
+static uint32_t last_us = 0;
+
+static uint32_t elapsed_us(uint32_t start_cycles)
+{
+  return (uint32_t)((uint64_t)(DWT->CYCCNT - start_cycles) * 1000000 / SystemCoreClockGet());
+}
+
+static void record(uint32_t *max_us, uint64_t *total_us, uint32_t start_cycles)
+{
+  last_us = elapsed_us(start_cycles);
+  *total_us += last_us;
+  if (last_us > *max_us) {
+    *max_us = last_us;
+  }
+}
+
+// Nonce: the randomizer, then the IV of the network with the source mixed
+// into its first four bytes
+static void make_nonce(uint32_t source, uint32_t sequence, struct sl_bt_ead_nonce_s *nonce)
+{
+  nonce->randomizer[0] = (uint8_t)sequence;
+  nonce->randomizer[1] = (uint8_t)(sequence >> 8);
+  nonce->randomizer[2] = (uint8_t)(sequence >> 16);
+  nonce->randomizer[3] = (uint8_t)(sequence >> 24);
+  nonce->randomizer[4] = RANDOMIZER_LAST;
+  memcpy(nonce->iv, key_material.iv, SL_BT_EAD_IV_SIZE);
+  nonce->iv[0] ^= (uint8_t)source;
+  nonce->iv[1] ^= (uint8_t)(source >> 8);
+  nonce->iv[2] ^= (uint8_t)(source >> 16);
+  nonce->iv[3] ^= (uint8_t)(source >> 24);
+}
+
+void pawr_crypto_init(const uint8_t *key)
+{
+  memcpy(&key_material, key, SL_BT_EAD_KEY_MATERIAL_SIZE);
+  memset(&stats, 0, sizeof(stats));
+  seal_us_total = 0;
+  open_us_total = 0;
+  last_us = 0;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+sl_status_t pawr_crypto_seal(uint32_t source,
+                             uint32_t sequence,
+                             const uint8_t *in,
+                             uint8_t len,
+                             uint8_t *out)
+{
+  struct sl_bt_ead_nonce_s nonce;
+  uint32_t start = DWT->CYCCNT;
+  sl_status_t sc;
+
+  if (len > UINT8_MAX - PAWR_CRYPTO_OVERHEAD) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  make_nonce(source, sequence, &nonce);
+  out[0] = (uint8_t)(len + PAWR_CRYPTO_OVERHEAD - 1);
+  out[1] = SL_BT_ENCRYPTED_DATA_AD_TYPE;
+  memcpy(&out[RANDOMIZER_OFFSET], nonce.randomizer, SL_BT_EAD_RANDOMIZER_SIZE);
+  memcpy(&out[PAYLOAD_OFFSET], in, len);
+  // Encrypted in place, the MIC follows the payload
+  sc = sl_bt_ead_encrypt(&key_material, &nonce, len, &out[PAYLOAD_OFFSET],
+                         &out[PAYLOAD_OFFSET + len]);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+
+  stats.sealed++;
+  stats.sealed_bytes += len;
+  record(&stats.seal_us_max, &seal_us_total, start);
+  return SL_STATUS_OK;
+}
+
+sl_status_t pawr_crypto_open(uint32_t source,
+                             const uint8_t *in,
+                             uint8_t len,
+                             uint8_t *out,
+                             uint8_t *out_len,
+                             uint32_t *sequence)
+{
+  struct sl_bt_ead_nonce_s nonce;
+  sl_bt_ead_mic_t mic;
+  uint32_t start = DWT->CYCCNT;
+  uint8_t payload_len;
+  sl_status_t sc;
+
+  if (len < PAWR_CRYPTO_OVERHEAD
+      || in[0] + 1 > len
+      || in[0] + 1 < PAWR_CRYPTO_OVERHEAD
+      || in[1] != SL_BT_ENCRYPTED_DATA_AD_TYPE
+      || in[RANDOMIZER_OFFSET + SL_BT_EAD_RANDOMIZER_SIZE - 1] != RANDOMIZER_LAST) {
+    stats.failures++;
+    last_us = elapsed_us(start);
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  payload_len = (uint8_t)(in[0] + 1 - PAWR_CRYPTO_OVERHEAD);
+  *sequence = (uint32_t)in[RANDOMIZER_OFFSET]
+              | ((uint32_t)in[RANDOMIZER_OFFSET + 1] << 8)
+              | ((uint32_t)in[RANDOMIZER_OFFSET + 2] << 16)
+              | ((uint32_t)in[RANDOMIZER_OFFSET + 3] << 24);
+
+  make_nonce(source, *sequence, &nonce);
+  memcpy(out, &in[PAYLOAD_OFFSET], payload_len);
+  memcpy(mic, &in[PAYLOAD_OFFSET + payload_len], SL_BT_EAD_MIC_SIZE);
+  sc = sl_bt_ead_decrypt(&key_material, &nonce, mic, payload_len, out);
+  if (sc != SL_STATUS_OK) {
+    stats.failures++;
+    last_us = elapsed_us(start);
+    return SL_STATUS_SECURITY_DECRYPT_ERROR;
+  }
+
+  *out_len = payload_len;
+  stats.opened++;
+  stats.opened_bytes += payload_len;
+  record(&stats.open_us_max, &open_us_total, start);
+  return SL_STATUS_OK;
+}
+
+uint32_t pawr_crypto_get_last_us(void)
+{
+  return last_us;
+}
+
+void pawr_crypto_get_stats(pawr_crypto_stats_t *out)
+{
+  *out = stats;
+  out->seal_us_average = (stats.sealed > 0) ? (uint32_t)(seal_us_total / stats.sealed) : 0;
+  out->open_us_average = (stats.opened > 0) ? (uint32_t)(open_us_total / stats.opened) : 0;
+}
@@ -32,6 +32,11 @@
 #include "sl_bluetooth.h"
 #include "app.h"
 #include "sl_sleeptimer.h"
+#include "pawr_slots.h"
+#include "pawr_downlink.h"
+#include "pawr_collector.h"
+#include "pawr_provisioning.h"
+#include "pawr_security.h"
 
 #define PAWR_INT_MIN              2400
 #define PAWR_INT_MAX              2400
@@ -44,39 +49,41 @@
 #define PAWR_SLOT_SPACING     3
 #define LOG_BUFFER_ERRORS     0
 
-typedef enum {
-  scanning,
-  opening,
-  discover_services,
-  discover_characteristics,
-  provision,
-  sync_transfer,
-  running
-} conn_state_t;
-
-typedef struct {
-  uint8_t conn_handle;
-  uint32_t service_handle;
-  uint16_t char_handle;
-}conn_info_t;
-
-static conn_state_t conn_state;
-static conn_info_t  conn_info;
-
-static const uint8_t pawr_sync_service[2] = { 0xAA, 0xAA };
-static const uint8_t pawr_sync_char[2]    = { 0xBB, 0xBB };
-
-static uint8_t slot_number = 0;
+// Every 10 seconds, queue a message to each scanner and log the goodput and
+// the state of the network
+#define DOWNLINK_SIGNAL       0x01
+#define DOWNLINK_INTERVAL_MS  10000
+#define DOWNLINK_MESSAGE_LEN  8
+
+// Every 6 of these intervals, the state of the network is exported and
+// logged in hex, for a gateway or a PC tool to parse. The export of a full
+// train is about 13 KB, so it is taken in parts of EXPORT_PART_LEN bytes.
+#define EXPORT_INTERVALS      6
+#define EXPORT_PART_LEN       256
+#define EXPORT_BYTES_PER_LINE 32
+
 static const uint32_t pawr_flags = SL_BT_PERIODIC_ADVERTISER_INCLUDE_TX_POWER;
 static uint8_t adv_handle = 0xFF;
-static uint8_t subevent_data = 0;
+static uint8_t downlink_counter = 0;
+static sl_sleeptimer_timer_handle_t downlink_timer;
 
 #if LOG_BUFFER_ERRORS
 static uint32_t allocation_failures = 0;
 static uint32_t timestamp = 0;
 #endif
 
-static uint8_t find_service_in_advertisement(uint8_t *data, uint8_t len);
+static void on_slot_reclaimed(pawr_slot_t slot, const uint8_t *address);
+static void downlink_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void queue_downlink_messages(void);
+static void log_downlink_goodput(void);
+static void on_responder_silence(pawr_slot_t slot, bool silent);
+static void log_network_state(void);
+static void log_network_export(void);
+static void on_scanner_assigned(pawr_slot_t slot, const bd_addr *address);
+static void log_provisioning(void);
+#if PAWR_ENCRYPTION
+static void log_crypto_cost(void);
+#endif
 /**************************************************************************//**
  * Application Init.
  *****************************************************************************/
@@ -109,6 +116,18 @@ SL_WEAK void app_process_action(void)
 void sl_bt_on_event(sl_bt_msg_t *evt)
 {
   sl_status_t sc;
+  pawr_slot_t slot;
+  bool received;
+  uint8_t response_len;
+  const uint8_t *response;
+  // The last response report was not the last part of a response
+  static bool fragmented = false;
+#if PAWR_ENCRYPTION
+  static uint8_t plaintext[UINT8_MAX];
+#endif
+
+  // Scanners are provisioned in parallel, each over its own connection
+  pawr_provisioning_on_event(evt);
 
   switch (SL_BT_MSG_ID(evt->header)) {
     case sl_bt_evt_system_boot_id:
@@ -122,82 +141,52 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_assert_status(sc);
       sc = sl_bt_advertiser_create_set(&adv_handle);
       app_assert_status(sc);
+      // Restore the response slots assigned before the reset
+      app_assert(pawr_slots_init(PAWR_NUM_SUBEVENTS,
+                                 PAWR_NUM_MAX_SLOTS_PER_SUBEVENT,
+                                 on_slot_reclaimed),
+                 "Slot allocator capacity too small for the train\r\n");
+      pawr_downlink_init();
+#if PAWR_ENCRYPTION
+      // The network key is created on the first start and kept in NVM3
+      sc = pawr_security_init();
+      app_assert_status(sc);
+#endif
+      pawr_collector_init(on_responder_silence);
+      pawr_provisioning_init(adv_handle, on_scanner_assigned);
       app_log("Starting PAwR train\r\n");
       sc = sl_bt_pawr_advertiser_start(adv_handle, PAWR_INT_MIN, PAWR_INT_MAX, pawr_flags,
                                        PAWR_NUM_SUBEVENTS, PAWR_SUBEVENT_INTERVAL, PAWR_RESPONSE_SLOT_DELAY,
                                        PAWR_SLOT_SPACING, PAWR_NUM_MAX_SLOTS_PER_SUBEVENT);
       app_assert_status(sc);
 
-      sc = sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m, sl_bt_scanner_discover_generic);
+      sc = pawr_provisioning_start();
       app_assert_status(sc);
-      conn_state = scanning;
-      break;
-
-    case sl_bt_evt_scanner_legacy_advertisement_report_id:
-      //Ignore scan responses when a connection is being opened
-      if (conn_state == scanning) {
-        if (evt->data.evt_scanner_legacy_advertisement_report.event_flags
-            == (SL_BT_SCANNER_EVENT_FLAG_CONNECTABLE | SL_BT_SCANNER_EVENT_FLAG_SCANNABLE)) {
-          if (find_service_in_advertisement(&(evt->data.evt_scanner_legacy_advertisement_report.data.data[0]),
-                                            evt->data.evt_scanner_legacy_advertisement_report.data.len) != 0) {
-            sc = sl_bt_scanner_stop();
-            app_assert_status(sc);
-            sc = sl_bt_connection_open(evt->data.evt_scanner_legacy_advertisement_report.address,
-                                       evt->data.evt_scanner_legacy_advertisement_report.address_type,
-                                       sl_bt_gap_phy_1m,
-                                       &conn_info.conn_handle);
-            app_assert_status(sc);
-            conn_state = opening;
-          }
-        }
-      }
-      break;
 
-    // -------------------------------
-    // This event indicates that a new connection was opened.
-    case sl_bt_evt_connection_opened_id:
-      conn_info.conn_handle = evt->data.evt_connection_opened.connection;
-      sc = sl_bt_sm_increase_security(evt->data.evt_connection_opened.connection);
+      sc = sl_sleeptimer_start_periodic_timer_ms(&downlink_timer,
+                                                 DOWNLINK_INTERVAL_MS,
+                                                 downlink_timer_callback,
+                                                 NULL,
+                                                 0,
+                                                 0);
       app_assert_status(sc);
       break;
 
-    case sl_bt_evt_sm_confirm_bonding_id:
-      sl_bt_sm_bonding_confirm(evt->data.evt_sm_confirm_bonding.connection, 1);
-      break;
-
-    case sl_bt_evt_connection_parameters_id:
-      if (evt->data.evt_connection_parameters.security_mode > 0) {
-        sc = sl_bt_gatt_discover_primary_services_by_uuid(conn_info.conn_handle, sizeof(pawr_sync_service), pawr_sync_service);
-        app_assert_status(sc);
-        conn_state = discover_services;
-      }
-      break;
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & DOWNLINK_SIGNAL) {
+        static uint8_t intervals = 0;
 
-    case sl_bt_evt_gatt_service_id:
-      if (!memcmp(evt->data.evt_gatt_service.uuid.data, pawr_sync_service, sizeof(pawr_sync_service) )) {
-        conn_info.service_handle = evt->data.evt_gatt_service.service;
-      }
-      break;
-
-    case sl_bt_evt_gatt_procedure_completed_id:
-      if (discover_services == conn_state) {
-        sc = sl_bt_gatt_discover_characteristics_by_uuid(conn_info.conn_handle, conn_info.service_handle, sizeof(pawr_sync_char), pawr_sync_char);
-        app_assert_status(sc);
-        conn_state = discover_characteristics;
-      } else if (discover_characteristics == conn_state) {
-        conn_state = provision;
-        // assign a response slot number to the scanner
-        sc = sl_bt_gatt_write_characteristic_value(evt->data.evt_gatt_characteristic.connection,
-                                                   conn_info.char_handle, sizeof(slot_number), &slot_number);
-        app_assert_status(sc);
-        slot_number++;
-      } else if (provision == conn_state) {
-        app_log("Slot number written to the peripheral, result: %x\r\n", evt->data.evt_gatt_procedure_completed.result);
-        conn_state = sync_transfer;
-        // transfer the PAwR information to the scanner by using the PAST feature. Upon syncing to the train, the scanner will close the connection
-        sc = sl_bt_advertiser_past_transfer(conn_info.conn_handle, 0, adv_handle);
-        app_assert_status(sc);
-        app_log("PAST transfer initiated \r\n");
+        log_downlink_goodput();
+        log_network_state();
+        if (++intervals >= EXPORT_INTERVALS) {
+          intervals = 0;
+          log_network_export();
+        }
+        log_provisioning();
+#if PAWR_ENCRYPTION
+        log_crypto_cost();
+#endif
+        queue_downlink_messages();
       }
       break;
 
@@ -209,12 +198,6 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_log("Bonding failed, reason: %x\r\n", evt->data.evt_sm_bonding_failed.reason);
       break;
 
-    case sl_bt_evt_gatt_characteristic_id:
-      if (!memcmp(evt->data.evt_gatt_characteristic.uuid.data, pawr_sync_char, sizeof(pawr_sync_char))) {
-        conn_info.char_handle = evt->data.evt_gatt_characteristic.characteristic;
-      }
-      break;
-
     case sl_bt_evt_system_resource_exhausted_id:
 #if LOG_BUFFER_ERRORS
       allocation_failures += evt->data.evt_system_resource_exhausted.num_buffer_allocation_failures;
@@ -228,70 +211,245 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       break;
 
     case sl_bt_evt_pawr_advertiser_subevent_data_request_id:
-      uint8_t subevent = evt->data.evt_pawr_advertiser_subevent_data_request.subevent_start;
-      uint8_t subevents_left = evt->data.evt_pawr_advertiser_subevent_data_request.subevent_data_count;
-
-      while (subevents_left > 0) {
-        sc = sl_bt_pawr_advertiser_set_subevent_data(adv_handle, subevent, 0, slot_number, sizeof(subevent_data), &subevent_data);
-        app_assert_status(sc);
-
-        // Check if subevent roll-over is required
-        if (subevent == PAWR_NUM_SUBEVENTS - 1) {
-          subevent = 0;
-        } else {
-          subevent++;
-        }
-        subevents_left--;
-      }
-
-      subevent_data++;
+      // Queued messages are packed into the subevents, addressed by slot.
+      // Subevents without responders are left empty.
+      sc = pawr_downlink_on_data_request(&evt->data.evt_pawr_advertiser_subevent_data_request,
+                                         PAWR_NUM_SUBEVENTS);
+      app_assert_status(sc);
       break;
     case sl_bt_evt_pawr_advertiser_response_report_id:
-      if (evt->data.evt_pawr_advertiser_response_report.data_status != 255) {
-        app_log("Response received in slot: %d, data: %d, data status: %d\r\n",
-                evt->data.evt_pawr_advertiser_response_report.response_slot,
-                evt->data.evt_pawr_advertiser_response_report.data.data[0],
-                evt->data.evt_pawr_advertiser_response_report.data_status);
+      slot.subevent = evt->data.evt_pawr_advertiser_response_report.subevent;
+      slot.slot = evt->data.evt_pawr_advertiser_response_report.response_slot;
+      // Data status 0 is a complete response, 255 no response. A response
+      // split over several reports has status 1 until its last part, and 2
+      // if it was truncated. The parts are not reassembled, so such a
+      // response counts as missed, once, with its last report.
+      if (evt->data.evt_pawr_advertiser_response_report.data_status == 1) {
+        fragmented = true;
+        break;
+      }
+      received = (evt->data.evt_pawr_advertiser_response_report.data_status == 0
+                  && !fragmented);
+      fragmented = false;
+      response = evt->data.evt_pawr_advertiser_response_report.data.data;
+      response_len = evt->data.evt_pawr_advertiser_response_report.data.len;
+#if PAWR_ENCRYPTION
+      // A response that fails authentication or replays an old one counts
+      // as missed
+      if (received) {
+        received = (pawr_security_open_response(slot, response, response_len,
+                                                plaintext, &response_len) == SL_STATUS_OK);
+        response = plaintext;
+      }
+#endif
+      pawr_collector_on_report(slot,
+                               received,
+                               evt->data.evt_pawr_advertiser_response_report.rssi);
+      pawr_slots_on_response(slot, received);
+      if (received) {
+        // The first response of a new scanner completes its provisioning
+        pawr_provisioning_on_response(slot);
+        // The first byte of the response acknowledges the last message
+        pawr_collector_on_delivery(slot,
+                                   pawr_downlink_on_response(slot, response_len, response));
       }
       break;
-    // -------------------------------
-    // This event indicates that a connection was closed.
-    case sl_bt_evt_connection_closed_id:
-      app_log("Connection closed, start scanning for next\r\n");
-      conn_info.char_handle     = 0;
-      conn_info.service_handle  = 0;
-      conn_info.conn_handle     = 0;
-      sc = sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m, sl_bt_scanner_discover_generic);
-      app_assert_status(sc);
-      conn_state = scanning;
-      break;
-
     default:
       //app_log("Unhandled event: %lx\r\n", SL_BT_MSG_ID(evt->header));
       break;
   }
 }
 
-// Parse advertisements looking for advertised pawr sync service
-static uint8_t find_service_in_advertisement(uint8_t *data, uint8_t len)
+// A scanner that stopped responding has left the train, its slot is free.
+// In case it still listens, it is told to leave, so it does not answer in
+// the slot of the next owner.
+static void on_slot_reclaimed(pawr_slot_t slot, const uint8_t *address)
+{
+  sl_status_t sc;
+
+#if PAWR_ENCRYPTION
+  // Its responses are not accepted anymore, and the next owner seals with
+  // its own member ID
+  pawr_security_revoke(slot);
+#endif
+  sc = pawr_downlink_revoke(slot, address);
+  app_log("Slot %d in subevent %d reclaimed from %02X:%02X:%02X:%02X:%02X:%02X%s\r\n",
+          slot.slot, slot.subevent,
+          address[5], address[4], address[3], address[2], address[1], address[0],
+          (sc == SL_STATUS_OK) ? "" : ", revocation not queued");
+}
+
+// Queue a message to every scanner, as long as the queue has room
+static void queue_downlink_messages(void)
+{
+  uint8_t message[DOWNLINK_MESSAGE_LEN];
+  pawr_slot_t slot;
+
+  memset(message, downlink_counter, sizeof(message));
+  downlink_counter++;
+
+  for (slot.subevent = 0; slot.subevent < PAWR_NUM_SUBEVENTS; slot.subevent++) {
+    uint8_t count = pawr_slots_get_response_slot_count(slot.subevent);
+
+    for (slot.slot = 0; slot.slot < count; slot.slot++) {
+      if (pawr_slots_get_owner(slot) == NULL) {
+        continue;
+      }
+      message[0] = slot.slot;
+      if (pawr_downlink_send(slot, sizeof(message), message) == SL_STATUS_NO_MORE_RESOURCE) {
+        return;
+      }
+    }
+  }
+}
+
+// Log the downlink goodput of each subevent since the previous call
+static void log_downlink_goodput(void)
+{
+  static uint32_t last_delivered_bytes[PAWR_NUM_SUBEVENTS];
+  pawr_downlink_stats_t stats;
+
+  for (uint8_t subevent = 0; subevent < PAWR_NUM_SUBEVENTS; subevent++) {
+    if (pawr_downlink_get_stats(subevent, &stats) != SL_STATUS_OK
+        || stats.tx_bytes == 0) {
+      continue;
+    }
+    app_log("Subevent %d: goodput %lu B/s, delivered %lu, retransmissions %lu, efficiency %lu%%\r\n",
+            subevent,
+            (unsigned long)((stats.delivered_bytes - last_delivered_bytes[subevent])
+                            * 1000 / DOWNLINK_INTERVAL_MS),
+            (unsigned long)stats.delivered,
+            (unsigned long)stats.retransmissions,
+            (unsigned long)(stats.delivered_bytes * 100 / stats.tx_bytes));
+    last_delivered_bytes[subevent] = stats.delivered_bytes;
+  }
+  app_log("Downlink messages queued: %d\r\n", pawr_downlink_get_queued());
+}
+
+// A new or returning scanner got its response slot. It starts its downlink
+// sequence over, so does the advertiser.
+static void on_scanner_assigned(pawr_slot_t slot, const bd_addr *address)
+{
+  (void)address;
+  pawr_collector_reset_slot(slot);
+  pawr_downlink_restart(slot);
+  app_log("Assigning subevent %d, slot %d\r\n", slot.subevent, slot.slot);
+}
+
+// Log the provisioning rate and the average and longest time spent in each
+// stage
+static void log_provisioning(void)
 {
-  uint8_t ad_field_length;
-  uint8_t ad_field_type;
-  uint8_t i = 0;
-  uint8_t offset = sizeof(pawr_sync_service);
-  // Parse advertisement packet
-  while (i < len) {
-    ad_field_length = data[i];
-    ad_field_type = data[i + 1];
-    // Partial ($02) or complete ($03) list of 16-bit UUIDs
-    if (ad_field_type == 0x02 || ad_field_type == 0x03) {
-      // compare UUID to pawr sync service UUID
-      if (memcmp(&data[i + offset], pawr_sync_service, offset) == 0) {
-        return 1;
+  static const char *stage_names[PAWR_PROVISIONING_STAGE_COUNT] = {
+    "connect", "security", "discovery", "slot write", "sync transfer", "total"
+  };
+  pawr_provisioning_stats_t stats;
+
+  pawr_provisioning_get_stats(&stats);
+  if (stats.provisioned == 0 && stats.failures == 0) {
+    return;
+  }
+  app_log("Provisioning: %lu scanners, %lu per minute, %d in progress, %lu failures (%lu timeouts), %lu retries\r\n",
+          (unsigned long)stats.provisioned,
+          (unsigned long)stats.per_minute,
+          stats.active,
+          (unsigned long)stats.failures,
+          (unsigned long)stats.timeouts,
+          (unsigned long)stats.retries);
+  for (uint8_t i = 0; i < PAWR_PROVISIONING_STAGE_COUNT; i++) {
+    if (stats.stages[i].count == 0) {
+      continue;
+    }
+    app_log("  %s: average %lu ms, max %lu ms\r\n",
+            stage_names[i],
+            (unsigned long)(stats.stages[i].total_ms / stats.stages[i].count),
+            (unsigned long)stats.stages[i].max_ms);
+  }
+}
+
+#if PAWR_ENCRYPTION
+// Log the cost of the encryption, and how many responses of a subevent can
+// be opened within the budget at that cost
+static void log_crypto_cost(void)
+{
+  pawr_crypto_stats_t crypto;
+  pawr_security_stats_t security;
+
+  pawr_crypto_get_stats(&crypto);
+  pawr_security_get_stats(&security);
+  app_log("Crypto: seal %lu us (max %lu us, %lu B average), open %lu us (max %lu us, %lu B average)\r\n",
+          (unsigned long)crypto.seal_us_average,
+          (unsigned long)crypto.seal_us_max,
+          (unsigned long)(crypto.sealed > 0 ? crypto.sealed_bytes / crypto.sealed : 0),
+          (unsigned long)crypto.open_us_average,
+          (unsigned long)crypto.open_us_max,
+          (unsigned long)(crypto.opened > 0 ? crypto.opened_bytes / crypto.opened : 0));
+  app_log("Crypto: %d responses per subevent within %d us, longest subevent %lu us, %lu dropped over budget, %lu failed, %lu replays, %lu revoked\r\n",
+          security.slots_per_budget,
+          PAWR_SECURITY_SUBEVENT_BUDGET_US,
+          (unsigned long)security.subevent_us_max,
+          (unsigned long)security.over_budget,
+          (unsigned long)security.failures,
+          (unsigned long)security.replays,
+          (unsigned long)security.revoked);
+}
+#endif
+
+static void on_responder_silence(pawr_slot_t slot, bool silent)
+{
+  app_log("Scanner in subevent %d, slot %d %s\r\n",
+          slot.subevent, slot.slot, silent ? "went silent" : "answers again");
+}
+
+// Log the network summary and the received bitmap of the last round of
+// each subevent
+static void log_network_state(void)
+{
+  pawr_collector_summary_t summary;
+  const uint8_t *bitmap;
+  uint8_t slot_count;
+
+  pawr_collector_get_summary(&summary);
+  app_log("Network: %d scanners, %d silent, loss %d%%, RSSI %d dBm, export %d bytes\r\n",
+          summary.responders, summary.silent, summary.loss_percent, summary.rssi,
+          (int)pawr_collector_get_export_size());
+
+  for (uint8_t subevent = 0; subevent < PAWR_NUM_SUBEVENTS; subevent++) {
+    bitmap = pawr_collector_get_round_bitmap(subevent, &slot_count);
+    if (bitmap == NULL || slot_count == 0) {
+      continue;
+    }
+    app_log("Subevent %d responses:", subevent);
+    for (uint8_t i = 0; i < (slot_count + 7) / 8; i++) {
+      app_log(" %02X", bitmap[i]);
+    }
+    app_log("\r\n");
+  }
+}
+
+// Log the export of the network state, EXPORT_BYTES_PER_LINE bytes per line
+static void log_network_export(void)
+{
+  static uint8_t buffer[EXPORT_PART_LEN];
+  size_t offset = 0;
+  size_t len;
+
+  // Logged in one go, so no event changes the state between the parts
+  while ((len = pawr_collector_export_part(offset, buffer, sizeof(buffer))) > 0) {
+    for (size_t i = 0; i < len; i++) {
+      if ((offset + i) % EXPORT_BYTES_PER_LINE == 0) {
+        app_log("%sExport:", (offset + i > 0) ? "\r\n" : "");
       }
+      app_log(" %02X", buffer[i]);
     }
-    // advance to the next AD struct
-    i = i + ad_field_length + 1;
+    offset += len;
   }
-  return 0;
+  app_log("\r\n");
+}
+
+static void downlink_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(DOWNLINK_SIGNAL);
 }
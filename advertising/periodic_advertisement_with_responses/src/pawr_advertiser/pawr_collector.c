@@ -0,0 +1,392 @@
+/***************************************************************************//**
+ * @file pawr_collector.c
+ * @brief PAwR response collector.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "pawr_collector.h"
+
+#define NO_SLOT           0xFFFF
+#define BITMAP_LEN        ((PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT + 7) / 8)
+
+// Averages are exponential, with a weight of 1/8 for each new sample, and
+// kept in 1/16 units.
+#define AVERAGE_SHIFT     3
+#define FRACTION_BITS     4
+
+typedef struct {
+  uint32_t history;             // Bit 0 is the latest event, 1 if received
+  int16_t rssi;                 // 1/16 dBm
+  uint16_t delivery_latency;    // 1/16 events
+  uint16_t consecutive_misses;
+  uint8_t history_len;
+  uint8_t max_delivery_latency;
+  uint8_t flags;
+} slot_stats_t;
+
+#define FLAG_RSSI_VALID       0x01
+#define FLAG_LATENCY_VALID    0x02
+#define FLAG_SILENT           0x04
+
+typedef struct {
+  uint32_t rounds;
+  uint16_t last_slot;
+  uint8_t slot_count;
+  uint8_t last_slot_count;
+  uint8_t bitmap[BITMAP_LEN];
+  uint8_t last_bitmap[BITMAP_LEN];
+} subevent_round_t;
+
+static slot_stats_t slot_stats[PAWR_SLOTS_MAX_SUBEVENTS][PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT];
+static subevent_round_t rounds[PAWR_SLOTS_MAX_SUBEVENTS];
+static pawr_collector_silence_cb_t silence_callback = NULL;
+
+static int16_t average(int16_t avg, int16_t sample)
+{
+  return (int16_t)(avg + ((sample - avg) / (1 << AVERAGE_SHIFT)));
+}
+
+static uint8_t popcount32(uint32_t value)
+{
+  uint8_t count = 0;
+
+  while (value != 0) {
+    value &= value - 1;
+    count++;
+  }
+  return count;
+}
+
+static uint8_t loss_percent(const slot_stats_t *stats)
+{
+  uint32_t mask;
+
+  if (stats->history_len == 0) {
+    return 0;
+  }
+  mask = (stats->history_len >= 32) ? UINT32_MAX : ((1UL << stats->history_len) - 1);
+  return (uint8_t)(100 - popcount32(stats->history & mask) * 100 / stats->history_len);
+}
+
+static void finish_round(subevent_round_t *round)
+{
+  memcpy(round->last_bitmap, round->bitmap, BITMAP_LEN);
+  round->last_slot_count = round->slot_count;
+  memset(round->bitmap, 0, BITMAP_LEN);
+  round->slot_count = 0;
+  round->last_slot = NO_SLOT;
+  round->rounds++;
+}
+
+static bool in_range(pawr_slot_t slot)
+{
+  return slot.subevent < PAWR_SLOTS_MAX_SUBEVENTS
+         && slot.slot < PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT;
+}
+
+void pawr_collector_init(pawr_collector_silence_cb_t silence_cb)
+{
+  memset(slot_stats, 0, sizeof(slot_stats));
+  memset(rounds, 0, sizeof(rounds));
+  for (uint8_t i = 0; i < PAWR_SLOTS_MAX_SUBEVENTS; i++) {
+    rounds[i].last_slot = NO_SLOT;
+  }
+  silence_callback = silence_cb;
+}
+
+void pawr_collector_reset_slot(pawr_slot_t slot)
+{
+  if (in_range(slot)) {
+    memset(&slot_stats[slot.subevent][slot.slot], 0, sizeof(slot_stats_t));
+  }
+}
+
+void pawr_collector_on_report(pawr_slot_t slot, bool received, int8_t rssi)
+{
+  subevent_round_t *round;
+  slot_stats_t *stats;
+
+  if (!in_range(slot)) {
+    return;
+  }
+
+  // Reports of a subevent come in slot order, a lower slot starts a new round
+  round = &rounds[slot.subevent];
+  if (round->last_slot != NO_SLOT && slot.slot <= round->last_slot) {
+    finish_round(round);
+  }
+  if (received) {
+    round->bitmap[slot.slot / 8] |= (uint8_t)(1 << (slot.slot % 8));
+  }
+  round->last_slot = slot.slot;
+  round->slot_count = slot.slot + 1;
+
+  if (pawr_slots_get_owner(slot) != NULL) {
+    stats = &slot_stats[slot.subevent][slot.slot];
+    stats->history = (stats->history << 1) | (received ? 1 : 0);
+    if (stats->history_len < 32) {
+      stats->history_len++;
+    }
+
+    if (received) {
+      if (stats->flags & FLAG_RSSI_VALID) {
+        stats->rssi = average(stats->rssi, (int16_t)(rssi * (1 << FRACTION_BITS)));
+      } else {
+        stats->rssi = (int16_t)(rssi * (1 << FRACTION_BITS));
+        stats->flags |= FLAG_RSSI_VALID;
+      }
+      stats->consecutive_misses = 0;
+      if (stats->flags & FLAG_SILENT) {
+        stats->flags &= (uint8_t)~FLAG_SILENT;
+        if (silence_callback != NULL) {
+          silence_callback(slot, false);
+        }
+      }
+    } else {
+      if (stats->consecutive_misses < UINT16_MAX) {
+        stats->consecutive_misses++;
+      }
+      if (stats->consecutive_misses == PAWR_COLLECTOR_SILENT_EVENTS
+          && !(stats->flags & FLAG_SILENT)) {
+        stats->flags |= FLAG_SILENT;
+        if (silence_callback != NULL) {
+          silence_callback(slot, true);
+        }
+      }
+    }
+  }
+
+  if (slot.slot + 1 >= pawr_slots_get_response_slot_count(slot.subevent)) {
+    finish_round(round);
+  }
+}
+
+void pawr_collector_on_delivery(pawr_slot_t slot, uint8_t transmissions)
+{
+  slot_stats_t *stats;
+
+  if (!in_range(slot) || transmissions == 0) {
+    return;
+  }
+  stats = &slot_stats[slot.subevent][slot.slot];
+  if (stats->flags & FLAG_LATENCY_VALID) {
+    stats->delivery_latency = (uint16_t)average((int16_t)stats->delivery_latency,
+                                                (int16_t)(transmissions << FRACTION_BITS));
+  } else {
+    stats->delivery_latency = (uint16_t)(transmissions << FRACTION_BITS);
+    stats->flags |= FLAG_LATENCY_VALID;
+  }
+  if (transmissions > stats->max_delivery_latency) {
+    stats->max_delivery_latency = transmissions;
+  }
+}
+
+bool pawr_collector_get_slot_stats(pawr_slot_t slot, pawr_collector_slot_stats_t *out)
+{
+  const slot_stats_t *stats;
+
+  if (!in_range(slot) || pawr_slots_get_owner(slot) == NULL) {
+    return false;
+  }
+  stats = &slot_stats[slot.subevent][slot.slot];
+  out->history_len = stats->history_len;
+  out->loss_percent = loss_percent(stats);
+  out->rssi = (int8_t)(stats->rssi / (1 << FRACTION_BITS));
+  out->consecutive_misses = stats->consecutive_misses;
+  out->delivery_latency = (uint8_t)((stats->delivery_latency + (1 << (FRACTION_BITS - 1)))
+                                    >> FRACTION_BITS);
+  out->max_delivery_latency = stats->max_delivery_latency;
+  out->silent = (stats->flags & FLAG_SILENT) != 0;
+  return true;
+}
+
+const uint8_t *pawr_collector_get_round_bitmap(uint8_t subevent, uint8_t *slot_count)
+{
+  if (subevent >= PAWR_SLOTS_MAX_SUBEVENTS) {
+    return NULL;
+  }
+  *slot_count = rounds[subevent].last_slot_count;
+  return rounds[subevent].last_bitmap;
+}
+
+void pawr_collector_get_summary(pawr_collector_summary_t *summary)
+{
+  pawr_collector_slot_stats_t stats;
+  pawr_slot_t slot;
+  uint32_t loss_sum = 0;
+  int32_t rssi_sum = 0;
+  uint16_t rssi_count = 0;
+
+  memset(summary, 0, sizeof(*summary));
+  for (slot.subevent = 0; slot.subevent < PAWR_SLOTS_MAX_SUBEVENTS; slot.subevent++) {
+    uint8_t count = pawr_slots_get_response_slot_count(slot.subevent);
+
+    for (slot.slot = 0; slot.slot < count; slot.slot++) {
+      if (!pawr_collector_get_slot_stats(slot, &stats)) {
+        continue;
+      }
+      summary->responders++;
+      summary->silent += stats.silent ? 1 : 0;
+      loss_sum += stats.loss_percent;
+      if (slot_stats[slot.subevent][slot.slot].flags & FLAG_RSSI_VALID) {
+        rssi_sum += stats.rssi;
+        rssi_count++;
+      }
+    }
+  }
+  if (summary->responders > 0) {
+    summary->loss_percent = (uint8_t)(loss_sum / summary->responders);
+  }
+  if (rssi_count > 0) {
+    summary->rssi = (int8_t)(rssi_sum / rssi_count);
+  }
+}
+
+size_t pawr_collector_get_export_size(void)
+{
+  pawr_slots_stats_t slots;
+  size_t size = PAWR_COLLECTOR_EXPORT_HEADER_LEN;
+
+  for (uint8_t subevent = 0; subevent < PAWR_SLOTS_MAX_SUBEVENTS; subevent++) {
+    size += PAWR_COLLECTOR_EXPORT_ROUND_LEN + (rounds[subevent].last_slot_count + 7) / 8;
+  }
+  pawr_slots_get_stats(&slots);
+  return size + (size_t)slots.allocated * PAWR_COLLECTOR_EXPORT_RECORD_LEN;
+}
+
+// Part of the export being written: the bytes from offset to offset + size
+typedef struct {
+  uint8_t *buffer;
+  size_t offset;
+  size_t size;
+  size_t pos;                   // Position of the next byte of the export
+  size_t written;
+} export_window_t;
+
+static void emit(export_window_t *window, const uint8_t *data, size_t len)
+{
+  size_t skip = 0;
+  size_t end = window->offset + window->size;
+
+  if (window->pos < window->offset) {
+    skip = window->offset - window->pos;
+  }
+  if (skip < len && window->pos + skip < end) {
+    size_t copy = len - skip;
+
+    if (window->pos + skip + copy > end) {
+      copy = end - (window->pos + skip);
+    }
+    memcpy(&window->buffer[window->pos + skip - window->offset], &data[skip], copy);
+    window->written += copy;
+  }
+  window->pos += len;
+}
+
+static uint16_t count_records(void)
+{
+  pawr_collector_slot_stats_t stats;
+  pawr_slot_t slot;
+  uint16_t records = 0;
+
+  for (slot.subevent = 0; slot.subevent < PAWR_SLOTS_MAX_SUBEVENTS; slot.subevent++) {
+    uint8_t count = pawr_slots_get_response_slot_count(slot.subevent);
+
+    for (slot.slot = 0; slot.slot < count; slot.slot++) {
+      if (pawr_collector_get_slot_stats(slot, &stats)) {
+        records++;
+      }
+    }
+  }
+  return records;
+}
+
+size_t pawr_collector_export_part(size_t offset, uint8_t *buffer, size_t size)
+{
+  export_window_t window = { buffer, offset, size, 0, 0 };
+  pawr_collector_slot_stats_t stats;
+  pawr_slot_t slot;
+  uint8_t data[PAWR_COLLECTOR_EXPORT_RECORD_LEN];
+  uint16_t records = 0;
+
+  if (offset < PAWR_COLLECTOR_EXPORT_HEADER_LEN) {
+    records = count_records();
+  }
+  data[0] = PAWR_COLLECTOR_EXPORT_VERSION;
+  data[1] = PAWR_SLOTS_MAX_SUBEVENTS;
+  data[2] = PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT;
+  data[3] = (uint8_t)records;
+  data[4] = (uint8_t)(records >> 8);
+  emit(&window, data, PAWR_COLLECTOR_EXPORT_HEADER_LEN);
+
+  for (uint8_t subevent = 0; subevent < PAWR_SLOTS_MAX_SUBEVENTS; subevent++) {
+    const subevent_round_t *round = &rounds[subevent];
+
+    data[0] = (uint8_t)round->rounds;
+    data[1] = (uint8_t)(round->rounds >> 8);
+    data[2] = (uint8_t)(round->rounds >> 16);
+    data[3] = (uint8_t)(round->rounds >> 24);
+    data[4] = round->last_slot_count;
+    emit(&window, data, PAWR_COLLECTOR_EXPORT_ROUND_LEN);
+    emit(&window, round->last_bitmap, (round->last_slot_count + 7) / 8);
+  }
+
+  for (slot.subevent = 0; slot.subevent < PAWR_SLOTS_MAX_SUBEVENTS; slot.subevent++) {
+    uint8_t count = pawr_slots_get_response_slot_count(slot.subevent);
+
+    for (slot.slot = 0; slot.slot < count && window.pos < offset + size; slot.slot++) {
+      // Records before the part are only counted
+      if (window.pos + PAWR_COLLECTOR_EXPORT_RECORD_LEN <= offset) {
+        if (pawr_slots_get_owner(slot) != NULL) {
+          window.pos += PAWR_COLLECTOR_EXPORT_RECORD_LEN;
+        }
+        continue;
+      }
+      if (!pawr_collector_get_slot_stats(slot, &stats)) {
+        continue;
+      }
+      data[0] = slot.subevent;
+      data[1] = slot.slot;
+      memcpy(&data[2], pawr_slots_get_owner(slot), PAWR_SLOTS_ADDRESS_LEN);
+      data[8] = stats.loss_percent;
+      data[9] = (uint8_t)stats.rssi;
+      data[10] = stats.delivery_latency;
+      data[11] = (uint8_t)stats.consecutive_misses;
+      data[12] = (uint8_t)(stats.consecutive_misses >> 8);
+      emit(&window, data, PAWR_COLLECTOR_EXPORT_RECORD_LEN);
+    }
+  }
+  return window.written;
+}
+
+size_t pawr_collector_export(uint8_t *buffer, size_t size)
+{
+  if (size < pawr_collector_get_export_size()) {
+    return 0;
+  }
+  return pawr_collector_export_part(0, buffer, size);
+}
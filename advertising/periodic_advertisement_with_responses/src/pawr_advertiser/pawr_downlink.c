@@ -0,0 +1,334 @@
+/***************************************************************************//**
+ * @file pawr_downlink.c
+ * @brief PAwR downlink message queue.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "pawr_downlink.h"
+#include "pawr_security.h"
+
+// Room for the messages. Encrypted subevent data is wrapped in an
+// Encrypted Data AD structure.
+#if PAWR_ENCRYPTION
+#define PLAINTEXT_CAPACITY  (PAWR_DOWNLINK_MAX_SUBEVENT_DATA - PAWR_CRYPTO_OVERHEAD)
+#else
+#define PLAINTEXT_CAPACITY  PAWR_DOWNLINK_MAX_SUBEVENT_DATA
+#endif
+
+_Static_assert(PAWR_DOWNLINK_MESSAGE_HEADER_LEN + PAWR_DOWNLINK_MAX_MESSAGE_LEN + 1
+               <= PLAINTEXT_CAPACITY,
+               "A message does not fit in the subevent data");
+_Static_assert(PAWR_SLOTS_ADDRESS_LEN <= PAWR_DOWNLINK_MAX_MESSAGE_LEN,
+               "A revocation notice does not fit in a message");
+
+typedef enum {
+  message_free,
+  message_queued,     // Waiting for the previous message to the slot
+  message_in_flight,  // Sent, waiting for the acknowledgement
+  message_notice      // Revocation notice, sent a fixed number of times
+} message_state_t;
+
+typedef struct {
+  message_state_t state;
+  pawr_slot_t slot;
+  uint32_t order;
+  uint8_t sequence;
+  uint8_t transmissions;
+  uint8_t len;
+  uint8_t data[PAWR_DOWNLINK_MAX_MESSAGE_LEN];
+} message_t;
+
+static message_t queue[PAWR_DOWNLINK_QUEUE_SIZE];
+static uint32_t next_order = 0;
+static uint8_t queued_count = 0;
+
+// One bit per slot: the sequence number of the last message put in flight
+static uint8_t sequence_bits[PAWR_SLOTS_MAX_SUBEVENTS][(PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT + 7) / 8];
+
+static pawr_downlink_stats_t stats[PAWR_SLOTS_MAX_SUBEVENTS];
+
+static uint8_t subevent_data[PLAINTEXT_CAPACITY];
+#if PAWR_ENCRYPTION
+static uint8_t sealed_data[PAWR_DOWNLINK_MAX_SUBEVENT_DATA];
+#endif
+
+static bool same_slot(pawr_slot_t a, pawr_slot_t b)
+{
+  return a.subevent == b.subevent && a.slot == b.slot;
+}
+
+static uint8_t next_sequence(pawr_slot_t slot)
+{
+  uint8_t *bits = &sequence_bits[slot.subevent][slot.slot / 8];
+  uint8_t mask = (uint8_t)(1 << (slot.slot % 8));
+
+  *bits ^= mask;
+  return (*bits & mask) ? 2 : 1;
+}
+
+static void release(message_t *message)
+{
+  message->state = message_free;
+  queued_count--;
+}
+
+// Oldest message for the subevent that is not yet in the data, and may be
+// sent: in flight, a notice, or queued with no other message to its slot in
+// flight. A notice is for the former owner of the slot, it blocks nothing.
+static message_t *next_message(uint8_t subevent, const bool *packed)
+{
+  message_t *oldest = NULL;
+
+  for (uint8_t i = 0; i < PAWR_DOWNLINK_QUEUE_SIZE; i++) {
+    message_t *message = &queue[i];
+
+    if (message->state == message_free || packed[i]
+        || message->slot.subevent != subevent
+        || (oldest != NULL && message->order >= oldest->order)) {
+      continue;
+    }
+    if (message->state == message_queued) {
+      bool blocked = false;
+
+      for (uint8_t j = 0; j < PAWR_DOWNLINK_QUEUE_SIZE; j++) {
+        if (j != i && queue[j].state != message_free
+            && queue[j].state != message_notice
+            && same_slot(queue[j].slot, message->slot)
+            && (queue[j].state == message_in_flight || queue[j].order < message->order)) {
+          blocked = true;
+          break;
+        }
+      }
+      if (blocked) {
+        continue;
+      }
+    }
+    oldest = message;
+  }
+  return oldest;
+}
+
+static uint8_t build_subevent_data(uint8_t subevent)
+{
+  bool packed[PAWR_DOWNLINK_QUEUE_SIZE] = { false };
+  uint8_t len = 1;
+  message_t *message;
+
+  subevent_data[0] = 0;
+
+  while ((message = next_message(subevent, packed)) != NULL) {
+    packed[message - queue] = true;
+    if (len + PAWR_DOWNLINK_MESSAGE_HEADER_LEN + message->len > PLAINTEXT_CAPACITY) {
+      continue;
+    }
+    if (message->state == message_notice) {
+      message->transmissions++;
+    } else {
+      if (message->state == message_queued) {
+        message->state = message_in_flight;
+        message->sequence = next_sequence(message->slot);
+        message->transmissions = 0;
+      } else {
+        stats[subevent].retransmissions++;
+      }
+      if (message->transmissions < UINT8_MAX) {
+        message->transmissions++;
+      }
+      stats[subevent].tx_bytes += message->len;
+    }
+    subevent_data[len++] = message->slot.slot;
+    subevent_data[len++] = message->sequence;
+    subevent_data[len++] = message->len;
+    memcpy(&subevent_data[len], message->data, message->len);
+    len += message->len;
+    subevent_data[0]++;
+    if (message->state == message_notice
+        && message->transmissions >= PAWR_DOWNLINK_REVOKE_TRANSMISSIONS) {
+      release(message);
+    }
+  }
+  return len;
+}
+
+static bool has_notice(uint8_t subevent)
+{
+  for (uint8_t i = 0; i < PAWR_DOWNLINK_QUEUE_SIZE; i++) {
+    if (queue[i].state == message_notice && queue[i].slot.subevent == subevent) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void pawr_downlink_init(void)
+{
+  memset(queue, 0, sizeof(queue));
+  memset(sequence_bits, 0, sizeof(sequence_bits));
+  memset(stats, 0, sizeof(stats));
+  queued_count = 0;
+  next_order = 0;
+}
+
+sl_status_t pawr_downlink_send(pawr_slot_t slot, uint8_t len, const uint8_t *data)
+{
+  if (len > PAWR_DOWNLINK_MAX_MESSAGE_LEN || pawr_slots_get_owner(slot) == NULL) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+
+  for (uint8_t i = 0; i < PAWR_DOWNLINK_QUEUE_SIZE; i++) {
+    if (queue[i].state == message_free) {
+      queue[i].state = message_queued;
+      queue[i].slot = slot;
+      queue[i].order = next_order++;
+      queue[i].len = len;
+      memcpy(queue[i].data, data, len);
+      queued_count++;
+      return SL_STATUS_OK;
+    }
+  }
+  return SL_STATUS_NO_MORE_RESOURCE;
+}
+
+void pawr_downlink_cancel(pawr_slot_t slot)
+{
+  for (uint8_t i = 0; i < PAWR_DOWNLINK_QUEUE_SIZE; i++) {
+    if (queue[i].state != message_free && same_slot(queue[i].slot, slot)) {
+      if (queue[i].state != message_notice) {
+        stats[slot.subevent].cancelled++;
+      }
+      release(&queue[i]);
+    }
+  }
+}
+
+void pawr_downlink_restart(pawr_slot_t slot)
+{
+  sequence_bits[slot.subevent][slot.slot / 8] &= (uint8_t)~(1 << (slot.slot % 8));
+  for (uint8_t i = 0; i < PAWR_DOWNLINK_QUEUE_SIZE; i++) {
+    if (queue[i].state == message_in_flight && same_slot(queue[i].slot, slot)) {
+      queue[i].state = message_queued;
+    }
+  }
+}
+
+sl_status_t pawr_downlink_revoke(pawr_slot_t slot, const uint8_t *address)
+{
+  pawr_downlink_cancel(slot);
+
+  for (uint8_t i = 0; i < PAWR_DOWNLINK_QUEUE_SIZE; i++) {
+    if (queue[i].state == message_free) {
+      queue[i].state = message_notice;
+      queue[i].slot = slot;
+      queue[i].order = next_order++;
+      queue[i].sequence = PAWR_DOWNLINK_SEQUENCE_REVOKE;
+      queue[i].transmissions = 0;
+      queue[i].len = PAWR_SLOTS_ADDRESS_LEN;
+      memcpy(queue[i].data, address, PAWR_SLOTS_ADDRESS_LEN);
+      queued_count++;
+      stats[slot.subevent].revocations++;
+      return SL_STATUS_OK;
+    }
+  }
+  return SL_STATUS_NO_MORE_RESOURCE;
+}
+
+sl_status_t pawr_downlink_on_data_request(const sl_bt_evt_pawr_advertiser_subevent_data_request_t *request,
+                                          uint8_t num_subevents)
+{
+  sl_status_t sc;
+  uint8_t subevent = request->subevent_start;
+
+  // Set the data of all requested subevents back to back, within this event
+  for (uint8_t i = 0; i < request->subevent_data_count; i++) {
+    uint8_t response_slots = pawr_slots_get_response_slot_count(subevent);
+
+    if (response_slots > 0 || has_notice(subevent)) {
+      uint8_t len = build_subevent_data(subevent);
+      const uint8_t *data = subevent_data;
+
+#if PAWR_ENCRYPTION
+      // Every subevent data set gets a new sequence number. The cost is one
+      // encryption of at most PAWR_DOWNLINK_MAX_SUBEVENT_DATA bytes.
+      sc = pawr_security_seal_subevent(subevent, subevent_data, len, sealed_data);
+      if (sc != SL_STATUS_OK) {
+        return sc;
+      }
+      data = sealed_data;
+      len += PAWR_CRYPTO_OVERHEAD;
+#endif
+      sc = sl_bt_pawr_advertiser_set_subevent_data(request->advertising_set,
+                                                   subevent,
+                                                   0,
+                                                   response_slots,
+                                                   len,
+                                                   data);
+      if (sc != SL_STATUS_OK) {
+        return sc;
+      }
+    }
+    subevent = (subevent + 1 < num_subevents) ? subevent + 1 : 0;
+  }
+  return SL_STATUS_OK;
+}
+
+uint8_t pawr_downlink_on_response(pawr_slot_t slot, uint8_t len, const uint8_t *data)
+{
+  uint8_t transmissions;
+
+  if (len < 1 || data[0] == PAWR_DOWNLINK_ACK_NONE) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < PAWR_DOWNLINK_QUEUE_SIZE; i++) {
+    message_t *message = &queue[i];
+
+    if (message->state == message_in_flight
+        && same_slot(message->slot, slot)
+        && message->sequence == data[0]) {
+      stats[slot.subevent].delivered++;
+      stats[slot.subevent].delivered_bytes += message->len;
+      transmissions = message->transmissions;
+      release(message);
+      return transmissions;
+    }
+  }
+  return 0;
+}
+
+uint8_t pawr_downlink_get_queued(void)
+{
+  return queued_count;
+}
+
+sl_status_t pawr_downlink_get_stats(uint8_t subevent, pawr_downlink_stats_t *out)
+{
+  if (subevent >= PAWR_SLOTS_MAX_SUBEVENTS) {
+    return SL_STATUS_INVALID_INDEX;
+  }
+  *out = stats[subevent];
+  return SL_STATUS_OK;
+}
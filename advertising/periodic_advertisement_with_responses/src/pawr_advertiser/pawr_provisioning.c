@@ -0,0 +1,630 @@
+/***************************************************************************//**
+ * @file pawr_provisioning.c
+ * @brief Parallel provisioning of PAwR scanners.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "pawr_provisioning.h"
+#include "pawr_security.h"
+
+#define TIMER_INTERVAL_MS   250
+#define NO_STAGE            PAWR_PROVISIONING_STAGE_COUNT
+#define PEER_ENTRIES        (PAWR_PROVISIONING_MAX_PEERS + PAWR_PROVISIONING_MAX_JOINING)
+
+// Written to the scanner: slot, subevent, and the network key material and
+// sequence number if the network is encrypted
+#if PAWR_ENCRYPTION
+#define SLOT_INFO_LEN       (2 + PAWR_CRYPTO_PROVISIONING_LEN)
+#else
+#define SLOT_INFO_LEN       2
+#endif
+
+typedef enum {
+  peer_free,
+  peer_opening,
+  peer_securing,
+  peer_discovering_service,
+  peer_discovering_characteristic,
+  peer_writing_slot,
+  peer_transferring,
+  peer_joining                  // Disconnected, waiting for the first response
+} peer_state_t;
+
+typedef struct {
+  peer_state_t state;
+  uint8_t connection;
+  bool failed;                  // Being disconnected after a failure
+  bool joined;                  // Responded before closing the connection
+  bd_addr address;
+  pawr_slot_t slot;
+  uint32_t service_handle;
+  uint16_t char_handle;
+  uint32_t start_ms;            // Connection requested
+  uint32_t stage_ms;            // Current stage entered
+} peer_t;
+
+typedef struct {
+  bd_addr address;
+  uint8_t failures;
+  uint32_t retry_ms;
+} backoff_t;
+
+static const uint8_t pawr_sync_service[2] = { 0xAA, 0xAA };
+static const uint8_t pawr_sync_char[2]    = { 0xBB, 0xBB };
+
+static peer_t peers[PEER_ENTRIES];
+static backoff_t backoff[PAWR_PROVISIONING_BACKOFF_ENTRIES];
+static uint8_t backoff_count = 0;
+static pawr_provisioning_stats_t stats;
+static bool attempted = false;
+static uint32_t first_attempt_ms = 0;
+static uint32_t last_success_ms = 0;
+static uint8_t advertising_handle = 0xFF;
+static pawr_provisioning_assigned_cb_t assigned_callback = NULL;
+static bool running = false;
+static bool scanning = false;
+static sl_sleeptimer_timer_handle_t timeout_timer;
+
+static uint32_t now_ms(void)
+{
+  uint64_t ms = 0;
+
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+  return (uint32_t)ms;
+}
+
+static void timeout_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(PAWR_PROVISIONING_SIGNAL);
+}
+
+// Joining peers hold no connection, their handle may be reused
+static peer_t *find_peer(uint8_t connection)
+{
+  for (uint8_t i = 0; i < PEER_ENTRIES; i++) {
+    if (peers[i].state != peer_free && peers[i].state != peer_joining
+        && peers[i].connection == connection) {
+      return &peers[i];
+    }
+  }
+  return NULL;
+}
+
+static peer_t *find_peer_in_state(peer_state_t state)
+{
+  for (uint8_t i = 0; i < PEER_ENTRIES; i++) {
+    if (peers[i].state == state) {
+      return &peers[i];
+    }
+  }
+  return NULL;
+}
+
+// A free entry, if a connection can be opened for it
+static peer_t *find_free_peer(void)
+{
+  uint8_t connected = 0;
+
+  for (uint8_t i = 0; i < PEER_ENTRIES; i++) {
+    if (peers[i].state != peer_free && peers[i].state != peer_joining) {
+      connected++;
+    }
+  }
+  return (connected < PAWR_PROVISIONING_MAX_PEERS) ? find_peer_in_state(peer_free) : NULL;
+}
+
+static bool is_active(const bd_addr *address)
+{
+  for (uint8_t i = 0; i < PEER_ENTRIES; i++) {
+    if (peers[i].state != peer_free
+        && memcmp(&peers[i].address, address, sizeof(bd_addr)) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static backoff_t *find_backoff(const bd_addr *address)
+{
+  for (uint8_t i = 0; i < backoff_count; i++) {
+    if (memcmp(&backoff[i].address, address, sizeof(bd_addr)) == 0) {
+      return &backoff[i];
+    }
+  }
+  return NULL;
+}
+
+// Delay the next attempt on a scanner, twice as long as after the previous
+// failure
+static void add_backoff(const bd_addr *address)
+{
+  backoff_t *entry = find_backoff(address);
+  uint32_t delay = PAWR_PROVISIONING_BACKOFF_BASE_MS;
+
+  if (entry == NULL) {
+    if (backoff_count < PAWR_PROVISIONING_BACKOFF_ENTRIES) {
+      entry = &backoff[backoff_count++];
+    } else {
+      // Replace the entry that is due first
+      entry = &backoff[0];
+      for (uint8_t i = 1; i < backoff_count; i++) {
+        if ((int32_t)(backoff[i].retry_ms - entry->retry_ms) < 0) {
+          entry = &backoff[i];
+        }
+      }
+    }
+    entry->address = *address;
+    entry->failures = 0;
+  }
+
+  if (entry->failures < UINT8_MAX) {
+    entry->failures++;
+  }
+  for (uint8_t i = 1; i < entry->failures && delay < PAWR_PROVISIONING_BACKOFF_MAX_MS; i++) {
+    delay *= 2;
+  }
+  if (delay > PAWR_PROVISIONING_BACKOFF_MAX_MS) {
+    delay = PAWR_PROVISIONING_BACKOFF_MAX_MS;
+  }
+  entry->retry_ms = now_ms() + delay;
+}
+
+static void remove_backoff(const bd_addr *address)
+{
+  backoff_t *entry = find_backoff(address);
+
+  if (entry != NULL) {
+    *entry = backoff[--backoff_count];
+  }
+}
+
+static void record_stage(pawr_provisioning_stage_t stage, uint32_t start_ms, uint32_t end_ms)
+{
+  pawr_provisioning_stage_stats_t *stage_stats = &stats.stages[stage];
+  uint32_t duration = end_ms - start_ms;
+
+  stage_stats->count++;
+  stage_stats->total_ms += duration;
+  if (duration > stage_stats->max_ms) {
+    stage_stats->max_ms = duration;
+  }
+}
+
+// Move a peer to the next state, timing the stage it finished
+static void next_stage(peer_t *peer, peer_state_t state, pawr_provisioning_stage_t finished)
+{
+  uint32_t now = now_ms();
+
+  if (finished != NO_STAGE) {
+    record_stage(finished, peer->stage_ms, now);
+  }
+  peer->state = state;
+  peer->stage_ms = now;
+}
+
+static void on_failed(peer_t *peer)
+{
+  stats.failures++;
+  add_backoff(&peer->address);
+}
+
+static void on_joined(peer_t *peer)
+{
+  uint32_t now = now_ms();
+
+  record_stage(pawr_provisioning_stage_sync_transfer, peer->stage_ms, now);
+  record_stage(pawr_provisioning_stage_total, peer->start_ms, now);
+  stats.provisioned++;
+  last_success_ms = now;
+  remove_backoff(&peer->address);
+}
+
+// Disconnect a failed peer. It is accounted for when the connection closes.
+static void fail_peer(peer_t *peer, bool timeout)
+{
+  if (peer->failed) {
+    return;
+  }
+  peer->failed = true;
+  if (timeout) {
+    stats.timeouts++;
+  }
+  (void)sl_bt_connection_close(peer->connection);
+}
+
+// Scan while a connection can be opened. The scanner is stopped while a
+// connection is being opened, so only one request is pending at a time.
+static void update_scanning(void)
+{
+  bool scan = running
+              && find_peer_in_state(peer_opening) == NULL
+              && find_free_peer() != NULL;
+
+  if (scan && !scanning) {
+    scanning = (sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m,
+                                    sl_bt_scanner_discover_generic) == SL_STATUS_OK);
+  } else if (!scan && scanning) {
+    (void)sl_bt_scanner_stop();
+    scanning = false;
+  }
+}
+
+// Parse advertisements looking for advertised pawr sync service
+static bool find_service_in_advertisement(const uint8_t *data, uint8_t len)
+{
+  uint8_t ad_field_length;
+  uint8_t ad_field_type;
+  uint8_t i = 0;
+  uint8_t offset = sizeof(pawr_sync_service);
+  // Parse advertisement packet
+  while (i + 1 < len) {
+    ad_field_length = data[i];
+    ad_field_type = data[i + 1];
+    // Partial ($02) or complete ($03) list of 16-bit UUIDs
+    if ((ad_field_type == 0x02 || ad_field_type == 0x03)
+        && i + offset + sizeof(pawr_sync_service) <= len) {
+      // compare UUID to pawr sync service UUID
+      if (memcmp(&data[i + offset], pawr_sync_service, sizeof(pawr_sync_service)) == 0) {
+        return true;
+      }
+    }
+    // advance to the next AD struct
+    i = i + ad_field_length + 1;
+  }
+  return false;
+}
+
+static void on_advertisement(const sl_bt_evt_scanner_legacy_advertisement_report_t *report)
+{
+  peer_t *peer;
+  backoff_t *entry;
+  sl_status_t sc;
+
+  // Ignore reports queued before the scanner was stopped
+  if (!scanning
+      || report->event_flags != (SL_BT_SCANNER_EVENT_FLAG_CONNECTABLE
+                                 | SL_BT_SCANNER_EVENT_FLAG_SCANNABLE)
+      || !find_service_in_advertisement(report->data.data, report->data.len)
+      || is_active(&report->address)) {
+    return;
+  }
+  entry = find_backoff(&report->address);
+  if (entry != NULL && (int32_t)(now_ms() - entry->retry_ms) < 0) {
+    return;
+  }
+  peer = find_free_peer();
+  if (peer == NULL) {
+    return;
+  }
+
+  (void)sl_bt_scanner_stop();
+  scanning = false;
+  sc = sl_bt_connection_open(report->address,
+                             report->address_type,
+                             sl_bt_gap_phy_1m,
+                             &peer->connection);
+  if (sc != SL_STATUS_OK) {
+    update_scanning();
+    return;
+  }
+
+  if (!attempted) {
+    attempted = true;
+    first_attempt_ms = now_ms();
+  }
+  if (entry != NULL) {
+    stats.retries++;
+  }
+  peer->address = report->address;
+  peer->failed = false;
+  peer->joined = false;
+  peer->service_handle = 0;
+  peer->char_handle = 0;
+  next_stage(peer, peer_opening, NO_STAGE);
+  peer->start_ms = peer->stage_ms;
+}
+
+static void on_procedure_completed(peer_t *peer, uint16_t result)
+{
+  pawr_slot_t slot;
+  uint8_t slot_info[SLOT_INFO_LEN];
+  sl_status_t sc = SL_STATUS_FAIL;
+
+  switch (peer->state) {
+    case peer_discovering_service:
+      if (result == 0 && peer->service_handle != 0) {
+        sc = sl_bt_gatt_discover_characteristics_by_uuid(peer->connection,
+                                                         peer->service_handle,
+                                                         sizeof(pawr_sync_char),
+                                                         pawr_sync_char);
+        peer->state = peer_discovering_characteristic;
+      }
+      break;
+
+    case peer_discovering_characteristic:
+      // A scanner provisioned before gets its previous slot back. The slot
+      // stays assigned if a later stage fails; it is used again on the retry,
+      // or reclaimed if the scanner never joins the train.
+      if (result == 0 && peer->char_handle != 0
+          && pawr_slots_allocate(peer->address.addr, &slot)) {
+        next_stage(peer, peer_writing_slot, pawr_provisioning_stage_discovery);
+        peer->slot = slot;
+        if (assigned_callback != NULL) {
+          assigned_callback(slot, &peer->address);
+        }
+        slot_info[0] = slot.slot;
+        slot_info[1] = slot.subevent;
+#if PAWR_ENCRYPTION
+        sc = pawr_security_get_provisioning_data(slot, &slot_info[2]);
+        if (sc != SL_STATUS_OK) {
+          break;
+        }
+#endif
+        sc = sl_bt_gatt_write_characteristic_value(peer->connection,
+                                                   peer->char_handle,
+                                                   sizeof(slot_info),
+                                                   slot_info);
+      }
+      break;
+
+    case peer_writing_slot:
+      if (result == 0) {
+        next_stage(peer, peer_transferring, pawr_provisioning_stage_slot_write);
+        // Upon syncing to the train, the scanner closes the connection
+        sc = sl_bt_advertiser_past_transfer(peer->connection, 0, advertising_handle);
+      }
+      break;
+
+    default:
+      return;
+  }
+
+  if (sc != SL_STATUS_OK) {
+    fail_peer(peer, false);
+  }
+}
+
+// The scanner closes the connection after the sync transfer, whether it
+// synced or not. It is provisioned only once it responds in its slot.
+static void on_closed(peer_t *peer)
+{
+  if (!peer->failed && peer->state == peer_transferring && !peer->joined) {
+    peer->state = peer_joining;
+    update_scanning();
+    return;
+  }
+  if (!peer->joined) {
+    on_failed(peer);
+  }
+  peer->state = peer_free;
+  update_scanning();
+}
+
+static void check_timeouts(void)
+{
+  uint32_t now = now_ms();
+  uint32_t timeout;
+
+  for (uint8_t i = 0; i < PEER_ENTRIES; i++) {
+    if (peers[i].state == peer_free || peers[i].failed) {
+      continue;
+    }
+    if (peers[i].joined) {
+      // Provisioned, close again if the connection is still open
+      if (now - peers[i].stage_ms > PAWR_PROVISIONING_STAGE_TIMEOUT_MS) {
+        (void)sl_bt_connection_close(peers[i].connection);
+        peers[i].stage_ms = now;
+      }
+      continue;
+    }
+    if (peers[i].state == peer_joining) {
+      // Timed from the sync transfer; there is no connection to close
+      if (now - peers[i].stage_ms > PAWR_PROVISIONING_JOIN_TIMEOUT_MS) {
+        stats.timeouts++;
+        on_failed(&peers[i]);
+        peers[i].state = peer_free;
+        update_scanning();
+      }
+      continue;
+    }
+    timeout = (peers[i].state == peer_opening)
+              ? PAWR_PROVISIONING_CONNECT_TIMEOUT_MS
+              : PAWR_PROVISIONING_STAGE_TIMEOUT_MS;
+    if (now - peers[i].stage_ms > timeout) {
+      fail_peer(&peers[i], true);
+    }
+  }
+}
+
+void pawr_provisioning_init(uint8_t adv_handle,
+                            pawr_provisioning_assigned_cb_t assigned_cb)
+{
+  memset(peers, 0, sizeof(peers));
+  memset(&stats, 0, sizeof(stats));
+  backoff_count = 0;
+  attempted = false;
+  first_attempt_ms = 0;
+  last_success_ms = 0;
+  advertising_handle = adv_handle;
+  assigned_callback = assigned_cb;
+  running = false;
+  scanning = false;
+}
+
+sl_status_t pawr_provisioning_start(void)
+{
+  sl_status_t sc;
+
+  sc = sl_sleeptimer_start_periodic_timer_ms(&timeout_timer,
+                                             TIMER_INTERVAL_MS,
+                                             timeout_timer_callback,
+                                             NULL,
+                                             0,
+                                             0);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  running = true;
+  update_scanning();
+  return scanning ? SL_STATUS_OK : SL_STATUS_FAIL;
+}
+
+void pawr_provisioning_on_event(sl_bt_msg_t *evt)
+{
+  peer_t *peer;
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & PAWR_PROVISIONING_SIGNAL) {
+        check_timeouts();
+      }
+      break;
+
+    case sl_bt_evt_scanner_legacy_advertisement_report_id:
+      on_advertisement(&evt->data.evt_scanner_legacy_advertisement_report);
+      break;
+
+    case sl_bt_evt_connection_opened_id:
+      peer = find_peer(evt->data.evt_connection_opened.connection);
+      if (peer == NULL) {
+        break;
+      }
+      next_stage(peer, peer_securing, pawr_provisioning_stage_connect);
+      if (sl_bt_sm_increase_security(peer->connection) != SL_STATUS_OK) {
+        fail_peer(peer, false);
+      }
+      update_scanning();
+      break;
+
+    case sl_bt_evt_sm_confirm_bonding_id:
+      if (find_peer(evt->data.evt_sm_confirm_bonding.connection) != NULL) {
+        (void)sl_bt_sm_bonding_confirm(evt->data.evt_sm_confirm_bonding.connection, 1);
+      }
+      break;
+
+    case sl_bt_evt_sm_bonding_failed_id:
+      peer = find_peer(evt->data.evt_sm_bonding_failed.connection);
+      if (peer != NULL) {
+        fail_peer(peer, false);
+      }
+      break;
+
+    case sl_bt_evt_connection_parameters_id:
+      peer = find_peer(evt->data.evt_connection_parameters.connection);
+      if (peer != NULL && !peer->failed && peer->state == peer_securing
+          && evt->data.evt_connection_parameters.security_mode > 0) {
+        next_stage(peer, peer_discovering_service, pawr_provisioning_stage_security);
+        if (sl_bt_gatt_discover_primary_services_by_uuid(peer->connection,
+                                                         sizeof(pawr_sync_service),
+                                                         pawr_sync_service) != SL_STATUS_OK) {
+          fail_peer(peer, false);
+        }
+      }
+      break;
+
+    case sl_bt_evt_gatt_service_id:
+      peer = find_peer(evt->data.evt_gatt_service.connection);
+      if (peer != NULL
+          && evt->data.evt_gatt_service.uuid.len == sizeof(pawr_sync_service)
+          && memcmp(evt->data.evt_gatt_service.uuid.data, pawr_sync_service,
+                    sizeof(pawr_sync_service)) == 0) {
+        peer->service_handle = evt->data.evt_gatt_service.service;
+      }
+      break;
+
+    case sl_bt_evt_gatt_characteristic_id:
+      peer = find_peer(evt->data.evt_gatt_characteristic.connection);
+      if (peer != NULL
+          && evt->data.evt_gatt_characteristic.uuid.len == sizeof(pawr_sync_char)
+          && memcmp(evt->data.evt_gatt_characteristic.uuid.data, pawr_sync_char,
+                    sizeof(pawr_sync_char)) == 0) {
+        peer->char_handle = evt->data.evt_gatt_characteristic.characteristic;
+      }
+      break;
+
+    case sl_bt_evt_gatt_procedure_completed_id:
+      peer = find_peer(evt->data.evt_gatt_procedure_completed.connection);
+      if (peer != NULL && !peer->failed) {
+        on_procedure_completed(peer, evt->data.evt_gatt_procedure_completed.result);
+      }
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      peer = find_peer(evt->data.evt_connection_closed.connection);
+      if (peer != NULL) {
+        on_closed(peer);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void pawr_provisioning_on_response(pawr_slot_t slot)
+{
+  for (uint8_t i = 0; i < PEER_ENTRIES; i++) {
+    peer_t *peer = &peers[i];
+
+    if (peer->slot.subevent != slot.subevent || peer->slot.slot != slot.slot
+        || peer->joined
+        || (peer->state != peer_joining
+            && (peer->state != peer_transferring || peer->failed))) {
+      continue;
+    }
+    on_joined(peer);
+    if (peer->state == peer_joining) {
+      peer->state = peer_free;
+      update_scanning();
+    } else {
+      // Synced before closing the connection, which is no longer needed
+      peer->joined = true;
+      peer->stage_ms = last_success_ms;
+      (void)sl_bt_connection_close(peer->connection);
+    }
+    return;
+  }
+}
+
+void pawr_provisioning_get_stats(pawr_provisioning_stats_t *out)
+{
+  *out = stats;
+  out->active = 0;
+  for (uint8_t i = 0; i < PEER_ENTRIES; i++) {
+    if (peers[i].state != peer_free) {
+      out->active++;
+    }
+  }
+  out->per_minute = 0;
+  if (stats.provisioned > 0 && last_success_ms != first_attempt_ms) {
+    out->per_minute = (uint32_t)((uint64_t)stats.provisioned * 60000
+                                 / (last_success_ms - first_attempt_ms));
+  }
+}
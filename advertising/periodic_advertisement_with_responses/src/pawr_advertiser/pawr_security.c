@@ -0,0 +1,266 @@
+/***************************************************************************//**
+ * @file pawr_security.c
+ * @brief Network key and replay protection of the PAwR advertiser.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "nvm3.h"
+#include "nvm3_default.h"
+#include "psa/crypto.h"
+#include "pawr_security.h"
+
+#define NVM3_KEY_MATERIAL     (PAWR_SECURITY_NVM3_KEY_BASE)
+#define NVM3_KEY_SEQUENCE     (PAWR_SECURITY_NVM3_KEY_BASE + 1)
+#define NO_SLOT               0xFFFF
+#define NO_MEMBER             0
+
+// Sequence numbers of the last subevent data sets, and where the current
+// round of responses stands
+typedef struct {
+  uint32_t sequences[PAWR_SECURITY_SEQUENCE_WINDOW];
+  uint8_t next;
+  uint16_t last_slot;
+  uint32_t spent_us;
+} subevent_state_t;
+
+static uint8_t key_material[SL_BT_EAD_KEY_MATERIAL_SIZE];
+static uint32_t sequence = 0;
+static uint32_t sequence_limit = 0;
+static subevent_state_t subevents[PAWR_SLOTS_MAX_SUBEVENTS];
+
+// Sequence number last accepted from each slot, and member ID of the scanner
+// answering in it, NO_MEMBER if none. Takes 8 bytes of RAM per slot.
+static uint32_t slot_sequences[PAWR_SLOTS_MAX_SUBEVENTS][PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT];
+static uint32_t slot_members[PAWR_SLOTS_MAX_SUBEVENTS][PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT];
+
+static pawr_security_stats_t stats;
+
+static sl_status_t reserve_sequences(void)
+{
+  sequence_limit = sequence + PAWR_SECURITY_SEQUENCE_RESERVE;
+  if (nvm3_writeData(nvm3_defaultHandle, NVM3_KEY_SEQUENCE,
+                     &sequence_limit, sizeof(sequence_limit)) != ECODE_NVM3_OK) {
+    return SL_STATUS_FLASH_PROGRAM_FAILED;
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t pawr_security_init(void)
+{
+  sl_status_t sc;
+
+  memset(subevents, 0, sizeof(subevents));
+  memset(slot_sequences, 0, sizeof(slot_sequences));
+  // Members of the train before the reset are provisioned again
+  memset(slot_members, 0, sizeof(slot_members));
+  memset(&stats, 0, sizeof(stats));
+  for (uint8_t i = 0; i < PAWR_SLOTS_MAX_SUBEVENTS; i++) {
+    subevents[i].last_slot = NO_SLOT;
+  }
+
+  if (nvm3_readData(nvm3_defaultHandle, NVM3_KEY_MATERIAL,
+                    key_material, sizeof(key_material)) != ECODE_NVM3_OK) {
+    // First start: create the network key
+    if (psa_generate_random(key_material, sizeof(key_material)) != PSA_SUCCESS) {
+      return SL_STATUS_FAIL;
+    }
+    if (nvm3_writeData(nvm3_defaultHandle, NVM3_KEY_MATERIAL,
+                       key_material, sizeof(key_material)) != ECODE_NVM3_OK) {
+      return SL_STATUS_FLASH_PROGRAM_FAILED;
+    }
+  }
+
+  // Continue after all the sequence numbers reserved before the reset
+  if (nvm3_readData(nvm3_defaultHandle, NVM3_KEY_SEQUENCE,
+                    &sequence, sizeof(sequence)) != ECODE_NVM3_OK) {
+    sequence = 0;
+  }
+  sc = reserve_sequences();
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+
+  pawr_crypto_init(key_material);
+  return SL_STATUS_OK;
+}
+
+// Take the next sequence number, reserving more in NVM3 when needed
+static sl_status_t next_sequence(void)
+{
+  sl_status_t sc;
+
+  if (sequence + 1 >= sequence_limit) {
+    sc = reserve_sequences();
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+  }
+  sequence++;
+  return SL_STATUS_OK;
+}
+
+static void put_uint32(uint8_t *data, uint32_t value)
+{
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+  data[2] = (uint8_t)(value >> 16);
+  data[3] = (uint8_t)(value >> 24);
+}
+
+sl_status_t pawr_security_get_provisioning_data(pawr_slot_t slot, uint8_t *data)
+{
+  sl_status_t sc;
+
+  if (slot.subevent >= PAWR_SLOTS_MAX_SUBEVENTS
+      || slot.slot >= PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT) {
+    return SL_STATUS_INVALID_INDEX;
+  }
+  // The member ID is a sequence number never used for subevent data, so it
+  // is unique across resets too
+  sc = next_sequence();
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  slot_members[slot.subevent][slot.slot] = sequence;
+  slot_sequences[slot.subevent][slot.slot] = 0;
+
+  memcpy(data, key_material, SL_BT_EAD_KEY_MATERIAL_SIZE);
+  data += SL_BT_EAD_KEY_MATERIAL_SIZE;
+  put_uint32(&data[0], sequence);
+  put_uint32(&data[4], slot_members[slot.subevent][slot.slot]);
+  return SL_STATUS_OK;
+}
+
+void pawr_security_revoke(pawr_slot_t slot)
+{
+  if (slot.subevent < PAWR_SLOTS_MAX_SUBEVENTS
+      && slot.slot < PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT) {
+    slot_members[slot.subevent][slot.slot] = NO_MEMBER;
+  }
+}
+
+sl_status_t pawr_security_seal_subevent(uint8_t subevent,
+                                        const uint8_t *in,
+                                        uint8_t len,
+                                        uint8_t *out)
+{
+  subevent_state_t *state;
+  sl_status_t sc;
+
+  if (subevent >= PAWR_SLOTS_MAX_SUBEVENTS) {
+    return SL_STATUS_INVALID_INDEX;
+  }
+  sc = next_sequence();
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+
+  state = &subevents[subevent];
+  state->sequences[state->next] = sequence;
+  state->next = (state->next + 1) % PAWR_SECURITY_SEQUENCE_WINDOW;
+  stats.sequence = sequence;
+
+  return pawr_crypto_seal(PAWR_CRYPTO_SOURCE_ADVERTISER, sequence, in, len, out);
+}
+
+static bool in_window(const subevent_state_t *state, uint32_t response_sequence)
+{
+  for (uint8_t i = 0; i < PAWR_SECURITY_SEQUENCE_WINDOW; i++) {
+    if (state->sequences[i] != 0 && state->sequences[i] == response_sequence) {
+      return true;
+    }
+  }
+  return false;
+}
+
+sl_status_t pawr_security_open_response(pawr_slot_t slot,
+                                        const uint8_t *in,
+                                        uint8_t len,
+                                        uint8_t *out,
+                                        uint8_t *out_len)
+{
+  subevent_state_t *state;
+  uint32_t response_sequence;
+  uint32_t member;
+  sl_status_t sc;
+
+  if (slot.subevent >= PAWR_SLOTS_MAX_SUBEVENTS
+      || slot.slot >= PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT) {
+    return SL_STATUS_INVALID_INDEX;
+  }
+  state = &subevents[slot.subevent];
+  member = slot_members[slot.subevent][slot.slot];
+
+  // The slots of a subevent are reported in order, a lower slot starts the
+  // responses of the next event
+  if (state->last_slot == NO_SLOT || slot.slot <= state->last_slot) {
+    if (state->spent_us > stats.subevent_us_max) {
+      stats.subevent_us_max = state->spent_us;
+    }
+    state->spent_us = 0;
+  }
+  state->last_slot = slot.slot;
+
+  // A revoked scanner may still answer, its responses are not opened
+  if (member == NO_MEMBER) {
+    stats.revoked++;
+    return SL_STATUS_SECURITY_DECRYPT_ERROR;
+  }
+  if (state->spent_us >= PAWR_SECURITY_SUBEVENT_BUDGET_US) {
+    stats.over_budget++;
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  sc = pawr_crypto_open(member, in, len, out, out_len, &response_sequence);
+  state->spent_us += pawr_crypto_get_last_us();
+  if (sc != SL_STATUS_OK) {
+    stats.failures++;
+    return sc;
+  }
+
+  if (!in_window(state, response_sequence)
+      || response_sequence <= slot_sequences[slot.subevent][slot.slot]) {
+    stats.replays++;
+    return SL_STATUS_SECURITY_DECRYPT_ERROR;
+  }
+  slot_sequences[slot.subevent][slot.slot] = response_sequence;
+  return SL_STATUS_OK;
+}
+
+void pawr_security_get_stats(pawr_security_stats_t *out)
+{
+  pawr_crypto_stats_t crypto_stats;
+
+  *out = stats;
+  pawr_crypto_get_stats(&crypto_stats);
+  out->slots_per_budget = 0;
+  if (crypto_stats.open_us_average > 0) {
+    uint32_t slots = PAWR_SECURITY_SUBEVENT_BUDGET_US / crypto_stats.open_us_average;
+
+    out->slots_per_budget = (slots > UINT16_MAX) ? UINT16_MAX : (uint16_t)slots;
+  }
+}
@@ -0,0 +1,310 @@
+/***************************************************************************//**
+ * @file pawr_slots.c
+ * @brief PAwR response slot allocator.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <stddef.h>
+#include <string.h>
+#include "pawr_slots.h"
+#if PAWR_SLOTS_PERSIST
+#include "nvm3_default.h"
+#endif
+
+_Static_assert(PAWR_SLOTS_RECLAIM_MISSES > 0 && PAWR_SLOTS_RECLAIM_MISSES <= 255,
+               "PAWR_SLOTS_RECLAIM_MISSES must be within 1..255");
+_Static_assert(PAWR_SLOTS_NVM3_GROUP_SIZE > 0 && PAWR_SLOTS_NVM3_GROUP_SIZE <= 32,
+               "PAWR_SLOTS_NVM3_GROUP_SIZE must be within 1..32");
+
+#define GROUPS_PER_SUBEVENT \
+  ((PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT + PAWR_SLOTS_NVM3_GROUP_SIZE - 1) / PAWR_SLOTS_NVM3_GROUP_SIZE)
+
+// NVM3 object of a group of slots: one bit per occupied slot, and the
+// addresses of their owners
+typedef struct {
+  uint32_t occupied;
+  uint8_t addresses[PAWR_SLOTS_NVM3_GROUP_SIZE][PAWR_SLOTS_ADDRESS_LEN];
+} stored_group_t;
+
+typedef struct {
+  uint8_t address[PAWR_SLOTS_ADDRESS_LEN];
+  uint8_t missed;
+} slot_entry_t;
+
+static slot_entry_t slots[PAWR_SLOTS_MAX_SUBEVENTS][PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT];
+static uint8_t occupied[PAWR_SLOTS_MAX_SUBEVENTS][(PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT + 7) / 8];
+static uint8_t occupied_count[PAWR_SLOTS_MAX_SUBEVENTS];
+static uint8_t response_slot_count[PAWR_SLOTS_MAX_SUBEVENTS];
+
+static uint8_t subevent_count = 0;
+static uint8_t slot_count = 0;
+static pawr_slots_reclaim_cb_t reclaim_callback = NULL;
+static pawr_slots_stats_t stats;
+
+static bool is_occupied(uint8_t subevent, uint8_t slot)
+{
+  return (occupied[subevent][slot / 8] >> (slot % 8)) & 1;
+}
+
+static void mark_occupied(uint8_t subevent, uint8_t slot, const uint8_t *address)
+{
+  memcpy(slots[subevent][slot].address, address, PAWR_SLOTS_ADDRESS_LEN);
+  slots[subevent][slot].missed = 0;
+  occupied[subevent][slot / 8] |= (uint8_t)(1 << (slot % 8));
+  if (occupied_count[subevent]++ == 0) {
+    stats.subevents_in_use++;
+  }
+  stats.allocated++;
+  if (slot >= response_slot_count[subevent]) {
+    response_slot_count[subevent] = slot + 1;
+  }
+}
+
+#if PAWR_SLOTS_PERSIST
+static uint32_t nvm3_key(uint8_t subevent, uint8_t group)
+{
+  return PAWR_SLOTS_NVM3_KEY_BASE
+         + (uint32_t)subevent * GROUPS_PER_SUBEVENT + group;
+}
+
+// Write the assignments of a group of slots, or delete its object once the
+// group is empty
+static void store_group(uint8_t subevent, uint8_t group)
+{
+  stored_group_t stored;
+  uint16_t first = (uint16_t)group * PAWR_SLOTS_NVM3_GROUP_SIZE;
+
+  memset(&stored, 0, sizeof(stored));
+  for (uint8_t i = 0; i < PAWR_SLOTS_NVM3_GROUP_SIZE
+       && first + i < PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT; i++) {
+    if (is_occupied(subevent, (uint8_t)(first + i))) {
+      stored.occupied |= (uint32_t)1 << i;
+      memcpy(stored.addresses[i], slots[subevent][first + i].address,
+             PAWR_SLOTS_ADDRESS_LEN);
+    }
+  }
+  if (stored.occupied == 0) {
+    (void)nvm3_deleteObject(nvm3_defaultHandle, nvm3_key(subevent, group));
+  } else {
+    (void)nvm3_writeData(nvm3_defaultHandle, nvm3_key(subevent, group),
+                         &stored, sizeof(stored));
+  }
+}
+
+// Restore the assignments of a group of slots. Those outside the current
+// geometry are left over from a different configuration and are dropped.
+static void load_group(uint8_t subevent, uint8_t group)
+{
+  stored_group_t stored;
+  uint16_t first = (uint16_t)group * PAWR_SLOTS_NVM3_GROUP_SIZE;
+  bool dropped = false;
+  Ecode_t ret_code;
+
+  ret_code = nvm3_readData(nvm3_defaultHandle, nvm3_key(subevent, group),
+                           &stored, sizeof(stored));
+  if (ret_code != ECODE_NVM3_OK) {
+    // An object of another size is not ours
+    if (ret_code != ECODE_NVM3_ERR_KEY_NOT_FOUND) {
+      (void)nvm3_deleteObject(nvm3_defaultHandle, nvm3_key(subevent, group));
+    }
+    return;
+  }
+  for (uint8_t i = 0; i < PAWR_SLOTS_NVM3_GROUP_SIZE; i++) {
+    if (!(stored.occupied & ((uint32_t)1 << i))) {
+      continue;
+    }
+    if (subevent < subevent_count && first + i < slot_count) {
+      mark_occupied(subevent, (uint8_t)(first + i), stored.addresses[i]);
+    } else {
+      dropped = true;
+    }
+  }
+  if (dropped) {
+    store_group(subevent, group);
+  }
+}
+#endif
+
+static void release(uint8_t subevent, uint8_t slot)
+{
+  occupied[subevent][slot / 8] &= (uint8_t)~(1 << (slot % 8));
+  if (--occupied_count[subevent] == 0) {
+    stats.subevents_in_use--;
+  }
+  stats.allocated--;
+  while (response_slot_count[subevent] > 0
+         && !is_occupied(subevent, response_slot_count[subevent] - 1)) {
+    response_slot_count[subevent]--;
+  }
+#if PAWR_SLOTS_PERSIST
+  store_group(subevent, slot / PAWR_SLOTS_NVM3_GROUP_SIZE);
+#endif
+}
+
+bool pawr_slots_init(uint8_t num_subevents,
+                     uint8_t slots_per_subevent,
+                     pawr_slots_reclaim_cb_t reclaim_cb)
+{
+  if (num_subevents > PAWR_SLOTS_MAX_SUBEVENTS
+      || slots_per_subevent > PAWR_SLOTS_MAX_SLOTS_PER_SUBEVENT) {
+    return false;
+  }
+
+  subevent_count = num_subevents;
+  slot_count = slots_per_subevent;
+  reclaim_callback = reclaim_cb;
+  memset(occupied, 0, sizeof(occupied));
+  memset(occupied_count, 0, sizeof(occupied_count));
+  memset(response_slot_count, 0, sizeof(response_slot_count));
+  memset(&stats, 0, sizeof(stats));
+
+#if PAWR_SLOTS_PERSIST
+  // Restore the stored assignments
+  for (uint8_t subevent = 0; subevent < PAWR_SLOTS_MAX_SUBEVENTS; subevent++) {
+    for (uint8_t group = 0; group < GROUPS_PER_SUBEVENT; group++) {
+      load_group(subevent, group);
+    }
+  }
+#endif
+
+  return true;
+}
+
+bool pawr_slots_find(const uint8_t *address, pawr_slot_t *slot)
+{
+  for (uint8_t subevent = 0; subevent < subevent_count; subevent++) {
+    if (occupied_count[subevent] == 0) {
+      continue;
+    }
+    for (uint8_t i = 0; i < response_slot_count[subevent]; i++) {
+      if (is_occupied(subevent, i)
+          && memcmp(slots[subevent][i].address, address, PAWR_SLOTS_ADDRESS_LEN) == 0) {
+        slot->subevent = subevent;
+        slot->slot = i;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool pawr_slots_allocate(const uint8_t *address, pawr_slot_t *slot)
+{
+  int16_t best = -1;
+
+  if (pawr_slots_find(address, slot)) {
+    slots[slot->subevent][slot->slot].missed = 0;
+    stats.reassignments++;
+    return true;
+  }
+
+  // Fullest subevent with room left, lowest index on ties
+  for (uint8_t subevent = 0; subevent < subevent_count; subevent++) {
+    if (occupied_count[subevent] < slot_count
+        && (best < 0 || occupied_count[subevent] > occupied_count[best])) {
+      best = subevent;
+    }
+  }
+  if (best < 0) {
+    stats.failures++;
+    return false;
+  }
+
+  for (uint8_t i = 0; i < slot_count; i++) {
+    if (!is_occupied((uint8_t)best, i)) {
+      slot->subevent = (uint8_t)best;
+      slot->slot = i;
+      break;
+    }
+  }
+
+  mark_occupied(slot->subevent, slot->slot, address);
+  stats.allocations++;
+#if PAWR_SLOTS_PERSIST
+  store_group(slot->subevent, slot->slot / PAWR_SLOTS_NVM3_GROUP_SIZE);
+#endif
+  return true;
+}
+
+bool pawr_slots_free(const uint8_t *address)
+{
+  pawr_slot_t slot;
+
+  if (!pawr_slots_find(address, &slot)) {
+    return false;
+  }
+  release(slot.subevent, slot.slot);
+  stats.frees++;
+  return true;
+}
+
+const uint8_t *pawr_slots_get_owner(pawr_slot_t slot)
+{
+  if (slot.subevent >= subevent_count || slot.slot >= slot_count
+      || !is_occupied(slot.subevent, slot.slot)) {
+    return NULL;
+  }
+  return slots[slot.subevent][slot.slot].address;
+}
+
+bool pawr_slots_on_response(pawr_slot_t slot, bool received)
+{
+  slot_entry_t *entry;
+
+  if (slot.subevent >= subevent_count || slot.slot >= slot_count
+      || !is_occupied(slot.subevent, slot.slot)) {
+    return false;
+  }
+
+  entry = &slots[slot.subevent][slot.slot];
+  if (received) {
+    entry->missed = 0;
+    return false;
+  }
+  if (++entry->missed < PAWR_SLOTS_RECLAIM_MISSES) {
+    return false;
+  }
+
+  release(slot.subevent, slot.slot);
+  stats.reclaims++;
+  if (reclaim_callback != NULL) {
+    reclaim_callback(slot, entry->address);
+  }
+  return true;
+}
+
+uint8_t pawr_slots_get_response_slot_count(uint8_t subevent)
+{
+  if (subevent >= subevent_count) {
+    return 0;
+  }
+  return response_slot_count[subevent];
+}
+
+void pawr_slots_get_stats(pawr_slots_stats_t *out)
+{
+  *out = stats;
+}
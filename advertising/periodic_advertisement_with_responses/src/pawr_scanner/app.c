@@ -27,20 +27,61 @@
  * 3. This notice may not be removed or altered from any source distribution.
  *
  ******************************************************************************/
+#include <string.h>
 #include "em_common.h"
 #include "app_assert.h"
 #include "sl_bluetooth.h"
 #include "app.h"
 #include "gatt_db.h"
 #include "app_log.h"
+#include "sl_sleeptimer.h"
+#include "pawr_response.h"
 
 #define PAWR_MAX_SKIP   0
 #define PAWR_TIMEOUT    1000
 
+// Subevent data: message count, then per message slot, sequence number,
+// length and data. See pawr_downlink.h of the advertiser.
+#define DOWNLINK_MESSAGE_HEADER_LEN 3
+#define DOWNLINK_ACK_NONE           0
+#define DOWNLINK_MAX_MESSAGE_LEN    16
+// A message with this sequence number revokes the slot of the scanner whose
+// address is its data
+#define DOWNLINK_SEQUENCE_REVOKE    0xFF
+
+// A new sensor payload is staged every second, and the response statistics
+// are logged every 10 payloads
+#define SENSOR_SIGNAL         0x01
+#define DOWNLINK_SIGNAL       0x02
+#define REVOKE_SIGNAL         0x04
+#define SENSOR_INTERVAL_MS    1000
+#define STATS_LOG_INTERVAL    10
+
 static uint8_t advertising_set_handle = 0xff;
 static uint8_t pawr_slot_number = 0;
+static uint8_t pawr_subevent = 0;
 static uint8_t conn_handle;
-static uint8_t resp_data = 0;
+static uint16_t sync_handle;
+static bd_addr own_address;
+static bool revoked = false;
+static uint8_t last_sequence = DOWNLINK_ACK_NONE;
+static uint8_t downlink_message[DOWNLINK_MAX_MESSAGE_LEN];
+static uint8_t downlink_message_len = 0;
+static uint16_t sensor_samples = 0;
+static sl_sleeptimer_timer_handle_t sensor_timer;
+#if PAWR_ENCRYPTION
+// Sequence number of the last authenticated subevent data. Older ones are
+// replays and get no response.
+static uint32_t network_sequence = 0;
+// Member ID given at provisioning, the nonce source of the responses
+static uint32_t member_id = 0;
+static uint32_t rejected_downlinks = 0;
+#endif
+
+static void process_downlink(const uint8_t *data, uint8_t len);
+static void stage_sensor_payload(void);
+static void log_response_stats(void);
+static void sensor_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
 
 /**************************************************************************//**
  * Application Init.
@@ -94,6 +135,14 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_assert_status(sc);
       sc = sl_bt_sm_delete_bondings();
       app_assert_status(sc);
+      // The advertiser names the scanner by this address when it revokes
+      // its slot
+      {
+        uint8_t address_type;
+
+        sc = sl_bt_system_get_identity_address(&own_address, &address_type);
+        app_assert_status(sc);
+      }
 
       // Generate data for advertising
       sc = sl_bt_legacy_advertiser_generate_data(advertising_set_handle,
@@ -114,6 +163,37 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_assert_status(sc);
 
       app_log("Started advertising\r\n");
+
+      // Responses are prepared ahead of the subevents
+      pawr_response_init();
+      stage_sensor_payload();
+      sc = sl_sleeptimer_start_periodic_timer_ms(&sensor_timer,
+                                                 SENSOR_INTERVAL_MS,
+                                                 sensor_timer_callback,
+                                                 NULL,
+                                                 0,
+                                                 0);
+      app_assert_status(sc);
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & SENSOR_SIGNAL) {
+        stage_sensor_payload();
+        if (sensor_samples % STATS_LOG_INTERVAL == 0) {
+          log_response_stats();
+        }
+      }
+      if (evt->data.evt_system_external_signal.extsignals & DOWNLINK_SIGNAL) {
+        app_log("Downlink message received, %d bytes, first byte: %d\r\n",
+                downlink_message_len,
+                downlink_message_len > 0 ? downlink_message[0] : 0);
+      }
+      if (evt->data.evt_system_external_signal.extsignals & REVOKE_SIGNAL) {
+        // Leave the train, and advertise again to be provisioned anew
+        app_log("Response slot revoked, leaving the train\r\n");
+        sc = sl_bt_sync_close(sync_handle);
+        app_assert_status(sc);
+      }
       break;
 
     // -------------------------------
@@ -142,29 +222,92 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_gatt_server_attribute_value_id:
       if (gattdb_pawr_sync_char == evt->data.evt_gatt_server_attribute_value.attribute) {
         pawr_slot_number = evt->data.evt_gatt_server_attribute_value.value.data[0];
-        app_log("Response slot number received: %d\r\n", pawr_slot_number);
+        pawr_subevent = evt->data.evt_gatt_server_attribute_value.value.data[1];
+        app_log("Response slot received: subevent %d, slot %d\r\n", pawr_subevent, pawr_slot_number);
+        // Provisioning starts the downlink sequence over. The advertiser
+        // does the same, e.g. after its reset, so its first message is new.
+        last_sequence = DOWNLINK_ACK_NONE;
+#if PAWR_ENCRYPTION
+        // The network key material, the current sequence number and the
+        // member ID follow
+        if (evt->data.evt_gatt_server_attribute_value.value.len >= 2 + PAWR_CRYPTO_PROVISIONING_LEN) {
+          const uint8_t *sequence = &evt->data.evt_gatt_server_attribute_value.value.data[2 + SL_BT_EAD_KEY_MATERIAL_SIZE];
+          const uint8_t *member = sequence + 4;
+
+          pawr_crypto_init(&evt->data.evt_gatt_server_attribute_value.value.data[2]);
+          network_sequence = (uint32_t)sequence[0] | ((uint32_t)sequence[1] << 8)
+                             | ((uint32_t)sequence[2] << 16) | ((uint32_t)sequence[3] << 24);
+          member_id = (uint32_t)member[0] | ((uint32_t)member[1] << 8)
+                      | ((uint32_t)member[2] << 16) | ((uint32_t)member[3] << 24);
+        }
+#endif
       }
       break;
 
     case sl_bt_evt_pawr_sync_transfer_received_id:
       app_log("PAwR sync transfer received, closing connection \r\n");
+      sync_handle = evt->data.evt_pawr_sync_transfer_received.sync;
+      // Listen to the assigned subevent only
+      sc = sl_bt_pawr_sync_set_sync_subevents(evt->data.evt_pawr_sync_transfer_received.sync,
+                                              sizeof(pawr_subevent), &pawr_subevent);
+      app_assert_status(sc);
       sc = sl_bt_connection_close(conn_handle);
       app_assert_status(sc);
       break;
 
     case sl_bt_evt_pawr_sync_subevent_report_id:
-      app_log("PAwR subevent report. Data: %d\r\n", evt->data.evt_pawr_sync_subevent_report.data.data[0]);
-      sc = sl_bt_pawr_sync_set_response_data(evt->data.evt_pawr_sync_subevent_report.sync,
-                                             evt->data.evt_pawr_sync_subevent_report.event_counter,
-                                             evt->data.evt_pawr_sync_subevent_report.subevent,
-                                             evt->data.evt_pawr_sync_subevent_report.subevent,
-                                             pawr_slot_number, sizeof(resp_data), &resp_data);
-      app_assert_status(sc);
-      resp_data++;
+      // The response slot follows shortly: only pick up the message and
+      // commit the response staged beforehand. Anything slower is deferred.
+      pawr_response_begin();
+      if (revoked) {
+        break;
+      }
+#if PAWR_ENCRYPTION
+      {
+        static uint8_t plaintext[UINT8_MAX];
+        uint8_t plaintext_len;
+        uint32_t sequence;
+
+        // Answer only fresh, authenticated subevent data: the response is
+        // encrypted under its sequence number
+        if (pawr_crypto_open(PAWR_CRYPTO_SOURCE_ADVERTISER,
+                             evt->data.evt_pawr_sync_subevent_report.data.data,
+                             evt->data.evt_pawr_sync_subevent_report.data.len,
+                             plaintext, &plaintext_len, &sequence) != SL_STATUS_OK
+            || sequence <= network_sequence) {
+          rejected_downlinks++;
+          break;
+        }
+        network_sequence = sequence;
+        process_downlink(plaintext, plaintext_len);
+        if (revoked) {
+          break;
+        }
+        (void)pawr_response_commit(&evt->data.evt_pawr_sync_subevent_report,
+                                   pawr_slot_number,
+                                   last_sequence,
+                                   member_id,
+                                   sequence);
+      }
+#else
+      process_downlink(evt->data.evt_pawr_sync_subevent_report.data.data,
+                       evt->data.evt_pawr_sync_subevent_report.data.len);
+      if (revoked) {
+        break;
+      }
+      // A response that misses its slot is counted, not fatal
+      (void)pawr_response_commit(&evt->data.evt_pawr_sync_subevent_report,
+                                 pawr_slot_number,
+                                 last_sequence,
+                                 0,
+                                 0);
+#endif
       break;
 
     case sl_bt_evt_sync_closed_id:
       app_log("Sync lost, reason: %x\r\n", evt->data.evt_sync_closed.reason);
+      last_sequence = DOWNLINK_ACK_NONE;
+      revoked = false;
       sc = sl_bt_legacy_advertiser_generate_data(advertising_set_handle,
                                                  sl_bt_advertiser_general_discoverable);
       app_assert_status(sc);
@@ -183,3 +326,106 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       break;
   }
 }
+
+// Find the message addressed to our slot in the subevent data. A message
+// with the sequence number of the previous one is a retransmission, it is
+// acknowledged again but not processed twice. A new message is copied and
+// handed to the main loop, out of the subevent report handler. A revocation
+// notice naming our address means the slot was reclaimed: no more responses
+// are sent, and the main loop leaves the train. A notice naming another
+// scanner is for the former owner of the slot. The whole data is searched,
+// as the notice and a message to the next owner may share it.
+static void process_downlink(const uint8_t *data, uint8_t len)
+{
+  uint8_t count;
+  uint8_t i = 1;
+
+  if (len < 1) {
+    return;
+  }
+  count = data[0];
+
+  while (count-- > 0 && i + DOWNLINK_MESSAGE_HEADER_LEN <= len) {
+    uint8_t slot = data[i];
+    uint8_t sequence = data[i + 1];
+    uint8_t message_len = data[i + 2];
+
+    if (i + DOWNLINK_MESSAGE_HEADER_LEN + message_len > len) {
+      return;
+    }
+    if (slot == pawr_slot_number && sequence == DOWNLINK_SEQUENCE_REVOKE) {
+      if (message_len == sizeof(own_address.addr)
+          && memcmp(&data[i + DOWNLINK_MESSAGE_HEADER_LEN], own_address.addr,
+                    sizeof(own_address.addr)) == 0) {
+        revoked = true;
+        sl_bt_external_signal(REVOKE_SIGNAL);
+        return;
+      }
+    } else if (slot == pawr_slot_number) {
+      if (sequence != last_sequence) {
+        last_sequence = sequence;
+        downlink_message_len = (message_len < sizeof(downlink_message))
+                               ? message_len : sizeof(downlink_message);
+        memcpy(downlink_message, &data[i + DOWNLINK_MESSAGE_HEADER_LEN], downlink_message_len);
+        sl_bt_external_signal(DOWNLINK_SIGNAL);
+      }
+    }
+    i += DOWNLINK_MESSAGE_HEADER_LEN + message_len;
+  }
+}
+
+// Dummy sensor payload: sample counter and uptime in seconds. Replace it
+// with real measurements, up to PAWR_RESPONSE_MAX_PAYLOAD_LEN bytes.
+static void stage_sensor_payload(void)
+{
+  uint8_t payload[6];
+  uint32_t uptime = sl_sleeptimer_get_time();
+  sl_status_t sc;
+
+  sensor_samples++;
+  payload[0] = (uint8_t)sensor_samples;
+  payload[1] = (uint8_t)(sensor_samples >> 8);
+  payload[2] = (uint8_t)uptime;
+  payload[3] = (uint8_t)(uptime >> 8);
+  payload[4] = (uint8_t)(uptime >> 16);
+  payload[5] = (uint8_t)(uptime >> 24);
+  sc = pawr_response_stage(payload, sizeof(payload));
+  app_assert_status(sc);
+}
+
+static void log_response_stats(void)
+{
+  pawr_response_stats_t stats;
+
+  pawr_response_get_stats(&stats);
+  if (stats.committed + stats.failures == 0) {
+    return;
+  }
+  app_log("Responses: %lu sent, %lu failed, %lu repeated, handler %lu us (average %lu us, max %lu us)\r\n",
+          (unsigned long)stats.committed,
+          (unsigned long)stats.failures,
+          (unsigned long)stats.repeats,
+          (unsigned long)stats.handler_us,
+          (unsigned long)stats.handler_us_average,
+          (unsigned long)stats.handler_us_max);
+#if PAWR_ENCRYPTION
+  {
+    pawr_crypto_stats_t crypto;
+
+    pawr_crypto_get_stats(&crypto);
+    app_log("Crypto: open %lu us (max %lu us), seal %lu us (max %lu us), %lu subevents rejected\r\n",
+            (unsigned long)crypto.open_us_average,
+            (unsigned long)crypto.open_us_max,
+            (unsigned long)crypto.seal_us_average,
+            (unsigned long)crypto.seal_us_max,
+            (unsigned long)rejected_downlinks);
+  }
+#endif
+}
+
+static void sensor_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(SENSOR_SIGNAL);
+}
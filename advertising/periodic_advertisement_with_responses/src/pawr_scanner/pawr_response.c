@@ -0,0 +1,152 @@
+/***************************************************************************//**
+ * @file pawr_response.c
+ * @brief Staged response data of a PAwR scanner.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "em_device.h"
+#include "pawr_response.h"
+
+#if PAWR_RESPONSE_INCLUDE_ACK
+#define PAYLOAD_OFFSET    1
+#else
+#define PAYLOAD_OFFSET    0
+#endif
+
+// Two buffers: the app writes the staging one while the other one is being
+// sent. A commit switches over only when a new payload was staged.
+static uint8_t buffers[2][PAWR_RESPONSE_PLAINTEXT_LEN];
+static uint8_t lengths[2];
+#if PAWR_ENCRYPTION
+static uint8_t sealed[PAWR_RESPONSE_MAX_LEN];
+#endif
+static uint8_t committed_buffer = 0;
+static bool staged = false;
+static uint32_t begin_cycles = 0;
+static uint64_t total_us = 0;
+static pawr_response_stats_t stats;
+
+void pawr_response_init(void)
+{
+  memset(buffers, 0, sizeof(buffers));
+  memset(&stats, 0, sizeof(stats));
+  // An empty response carries the acknowledgement only
+  lengths[0] = PAYLOAD_OFFSET;
+  lengths[1] = PAYLOAD_OFFSET;
+  committed_buffer = 0;
+  staged = false;
+  total_us = 0;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+sl_status_t pawr_response_stage(const uint8_t *payload, uint8_t len)
+{
+  uint8_t staging = committed_buffer ^ 1;
+
+  if (len > PAWR_RESPONSE_MAX_PAYLOAD_LEN) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  memcpy(&buffers[staging][PAYLOAD_OFFSET], payload, len);
+  lengths[staging] = PAYLOAD_OFFSET + len;
+  staged = true;
+  return SL_STATUS_OK;
+}
+
+void pawr_response_begin(void)
+{
+  begin_cycles = DWT->CYCCNT;
+}
+
+sl_status_t pawr_response_commit(const sl_bt_evt_pawr_sync_subevent_report_t *report,
+                                 uint8_t slot,
+                                 uint8_t ack,
+                                 uint32_t member,
+                                 uint32_t sequence)
+{
+  uint8_t *buffer;
+  uint8_t len;
+  uint32_t cycles;
+  sl_status_t sc;
+
+  if (staged) {
+    committed_buffer ^= 1;
+    staged = false;
+  } else {
+    stats.repeats++;
+  }
+  buffer = buffers[committed_buffer];
+  len = lengths[committed_buffer];
+#if PAWR_RESPONSE_INCLUDE_ACK
+  buffer[0] = ack;
+#else
+  (void)ack;
+#endif
+
+#if PAWR_ENCRYPTION
+  // One encryption of at most PAWR_RESPONSE_PLAINTEXT_LEN bytes
+  sc = pawr_crypto_seal(member, sequence, buffer, len, sealed);
+  buffer = sealed;
+  len += PAWR_CRYPTO_OVERHEAD;
+#else
+  (void)member;
+  (void)sequence;
+  sc = SL_STATUS_OK;
+#endif
+
+  if (sc == SL_STATUS_OK) {
+    sc = sl_bt_pawr_sync_set_response_data(report->sync,
+                                           report->event_counter,
+                                           report->subevent,
+                                           report->subevent,
+                                           slot,
+                                           len,
+                                           buffer);
+  }
+  if (sc == SL_STATUS_OK) {
+    stats.committed++;
+  } else {
+    stats.failures++;
+  }
+
+  cycles = DWT->CYCCNT - begin_cycles;
+  stats.handler_us = (uint32_t)((uint64_t)cycles * 1000000 / SystemCoreClockGet());
+  if (stats.handler_us > stats.handler_us_max) {
+    stats.handler_us_max = stats.handler_us;
+  }
+  total_us += stats.handler_us;
+  return sc;
+}
+
+void pawr_response_get_stats(pawr_response_stats_t *out)
+{
+  uint32_t reports = stats.committed + stats.failures;
+
+  *out = stats;
+  out->handler_us_average = (reports > 0) ? (uint32_t)(total_us / reports) : 0;
+}
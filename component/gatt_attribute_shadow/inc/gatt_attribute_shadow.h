@@ -0,0 +1,175 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT Server Attribute Shadow
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef GATT_ATTRIBUTE_SHADOW_H
+#define GATT_ATTRIBUTE_SHADOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Number of attributes that can be shadowed.
+#ifndef GATT_ATTRIBUTE_SHADOW_MAX_ATTRIBUTES
+#define GATT_ATTRIBUTE_SHADOW_MAX_ATTRIBUTES   16
+#endif
+
+// Longest value of a shadowed attribute.
+#ifndef GATT_ATTRIBUTE_SHADOW_MAX_VALUE_LEN
+#define GATT_ATTRIBUTE_SHADOW_MAX_VALUE_LEN    32
+#endif
+
+// Subscribers tracked per attribute.
+#ifndef GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS
+#ifdef SL_BT_CONFIG_MAX_CONNECTIONS
+#define GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS  SL_BT_CONFIG_MAX_CONNECTIONS
+#else
+#define GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS  4
+#endif
+#endif
+
+/***************************************************************************//**
+ * @brief Statistics of the shadow
+ ******************************************************************************/
+typedef struct {
+  uint32_t sets;            // Calls of gatt_attribute_shadow_set()
+  uint32_t redundant;       // Sets with the value already in the shadow
+  uint32_t coalesced;       // Sets replaced by a later one before the flush
+  uint32_t writes;          // sl_bt_gatt_server_write_attribute_value() calls
+  uint32_t write_failures;  // Writes that failed, done again later
+  uint32_t notifications;   // Notification and indication calls
+  uint32_t retries;         // Notifications refused by the stack, sent again later
+} gatt_attribute_shadow_stats_t;
+
+void sli_gatt_attribute_shadow_init(void);
+void sli_gatt_attribute_shadow_on_event(sl_bt_msg_t *evt);
+void sli_gatt_attribute_shadow_process_action(void);
+bool sli_gatt_attribute_shadow_is_ok_to_sleep(void);
+
+/***************************************************************************//**
+ *
+ * Shadow an attribute of the local GATT database. Its current value is read
+ * from the database, so that setting the same value again is suppressed.
+ *
+ * If @p notify is set, the subscribed clients are notified or indicated of
+ * each new value. The attribute must then be a characteristic value with the
+ * notify or indicate property.
+ *
+ * SL_STATUS_NO_MORE_RESOURCE will be returned if
+ * GATT_ATTRIBUTE_SHADOW_MAX_ATTRIBUTES are already shadowed,
+ * SL_STATUS_INVALID_PARAMETER if the value is longer than
+ * GATT_ATTRIBUTE_SHADOW_MAX_VALUE_LEN.
+ *
+ * @param[in] attribute Attribute handle
+ * @param[in] notify Notify the subscribers of the new values
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_attribute_shadow_add(uint16_t attribute, bool notify);
+
+/***************************************************************************//**
+ *
+ * Set the value of an attribute. Nothing is done if the value is the one
+ * already in the shadow. Otherwise the value is copied, and written to the
+ * database and sent to the subscribers at the end of the main loop
+ * iteration: the values set several times in an iteration are written and
+ * sent once.
+ *
+ * @param[in] attribute Attribute handle
+ * @param[in] len Length of the value
+ * @param[in] value Value
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND if the attribute is
+ *         not shadowed, SL_STATUS_INVALID_PARAMETER if the value is too long.
+ *
+ ******************************************************************************/
+sl_status_t gatt_attribute_shadow_set(uint16_t attribute,
+                                      uint16_t len,
+                                      const uint8_t *value);
+
+/***************************************************************************//**
+ *
+ * Get the value of an attribute from the shadow, including a value set but
+ * not yet written to the database.
+ *
+ * @param[in] attribute Attribute handle
+ * @param[in] max_len Size of @p value
+ * @param[out] len Length of the value
+ * @param[out] value Value
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND if the attribute is
+ *         not shadowed, SL_STATUS_WOULD_OVERFLOW if @p value is too short.
+ *
+ ******************************************************************************/
+sl_status_t gatt_attribute_shadow_get(uint16_t attribute,
+                                      uint16_t max_len,
+                                      uint16_t *len,
+                                      uint8_t *value);
+
+/***************************************************************************//**
+ *
+ * Tell whether the value of an attribute changed since the subscriber was
+ * last sent it. A new subscriber has not got the value until it is sent one.
+ *
+ * @param[in] connection Connection handle of the subscriber
+ * @param[in] attribute Attribute handle
+ * @param[out] changed The subscriber has not got the current value
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND if the attribute is
+ *         not shadowed or the connection is not subscribed to it.
+ *
+ ******************************************************************************/
+sl_status_t gatt_attribute_shadow_changed_since(uint8_t connection,
+                                                uint16_t attribute,
+                                                bool *changed);
+
+/***************************************************************************//**
+ *
+ * Write the values set and send them to the subscribers now, instead of at
+ * the end of the main loop iteration.
+ *
+ * A value the database refuses is kept in the shadow and not sent. It is
+ * written again at the next main loop iteration.
+ *
+ * @return SL_STATUS_OK if all values were written, the error of the first
+ *         write that failed otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_attribute_shadow_flush(void);
+
+/***************************************************************************//**
+ *
+ * Retrieve the statistics of the shadow.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void gatt_attribute_shadow_get_stats(gatt_attribute_shadow_stats_t *stats);
+
+#endif // GATT_ATTRIBUTE_SHADOW_H
@@ -0,0 +1,412 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT Server Attribute Shadow
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "sl_bluetooth.h"
+#include "gatt_attribute_shadow.h"
+
+typedef struct {
+  bool used;
+  uint8_t connection;
+  bool indication;          // Indications, not notifications, are enabled
+  bool confirming;          // Indication sent, not yet confirmed
+  uint32_t version;         // Version of the last value sent
+} subscriber_t;
+
+typedef struct {
+  uint16_t attribute;
+  bool notify;
+  bool dirty;               // Value not yet written to the database
+  uint32_t version;         // Incremented at each new value
+  uint16_t len;
+  uint8_t value[GATT_ATTRIBUTE_SHADOW_MAX_VALUE_LEN];
+  subscriber_t subscribers[GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS];
+} shadow_t;
+
+static shadow_t shadows[GATT_ATTRIBUTE_SHADOW_MAX_ATTRIBUTES];
+static uint8_t shadow_count = 0;
+static bool pending = false;  // Values set, to write and send before sleeping
+static bool retry = false;    // Values to send again at the next iteration
+static gatt_attribute_shadow_stats_t stats;
+
+static shadow_t *find_shadow(uint16_t attribute)
+{
+  for (uint8_t i = 0; i < shadow_count; i++) {
+    if (shadows[i].attribute == attribute) {
+      return &shadows[i];
+    }
+  }
+  return NULL;
+}
+
+static subscriber_t *find_subscriber(shadow_t *s, uint8_t connection)
+{
+  for (uint8_t i = 0; i < GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS; i++) {
+    if (s->subscribers[i].used && s->subscribers[i].connection == connection) {
+      return &s->subscribers[i];
+    }
+  }
+  return NULL;
+}
+
+static subscriber_t *add_subscriber(shadow_t *s, uint8_t connection)
+{
+  subscriber_t *sub = find_subscriber(s, connection);
+
+  for (uint8_t i = 0; sub == NULL && i < GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS; i++) {
+    if (!s->subscribers[i].used) {
+      sub = &s->subscribers[i];
+      memset(sub, 0, sizeof(*sub));
+      sub->used = true;
+      sub->connection = connection;
+    }
+  }
+  return sub;
+}
+
+static bool is_stale(const shadow_t *s, const subscriber_t *sub)
+{
+  return sub->used && sub->version != s->version;
+}
+
+static sl_status_t send(const shadow_t *s, const subscriber_t *sub)
+{
+  if (sub->indication) {
+    return sl_bt_gatt_server_send_indication(sub->connection, s->attribute, s->len, s->value);
+  }
+  return sl_bt_gatt_server_send_notification(sub->connection, s->attribute, s->len, s->value);
+}
+
+static void sent(const shadow_t *s, subscriber_t *sub)
+{
+  sub->version = s->version;
+  sub->confirming = sub->indication;
+}
+
+// Send the current value to the subscribers that have not got it, with a
+// single call when all of them are behind
+static void send_value(shadow_t *s)
+{
+  uint8_t subscribed = 0;
+  uint8_t ready = 0;
+  sl_status_t sc;
+
+  for (uint8_t i = 0; i < GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS; i++) {
+    subscriber_t *sub = &s->subscribers[i];
+
+    if (sub->used) {
+      subscribed++;
+      if (is_stale(s, sub) && !sub->confirming) {
+        ready++;
+      }
+    }
+  }
+  if (ready == 0) {
+    return;
+  }
+
+  if (ready > 1 && ready == subscribed) {
+    stats.notifications++;
+    sc = sl_bt_gatt_server_notify_all(s->attribute, s->len, s->value);
+    if (sc == SL_STATUS_OK) {
+      for (uint8_t i = 0; i < GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS; i++) {
+        if (s->subscribers[i].used) {
+          sent(s, &s->subscribers[i]);
+        }
+      }
+      return;
+    }
+    if (sc == SL_STATUS_NO_MORE_RESOURCE) {
+      stats.retries++;
+      retry = true;
+      return;
+    }
+    // Another error may come from a single connection, e.g. one closing:
+    // the subscribers are sent the value one by one instead
+  }
+
+  for (uint8_t i = 0; i < GATT_ATTRIBUTE_SHADOW_MAX_CONNECTIONS; i++) {
+    subscriber_t *sub = &s->subscribers[i];
+
+    if (!is_stale(s, sub) || sub->confirming) {
+      continue;
+    }
+    stats.notifications++;
+    sc = send(s, sub);
+    if (sc == SL_STATUS_OK) {
+      sent(s, sub);
+    } else if (sc == SL_STATUS_NO_MORE_RESOURCE) {
+      // Sent again at the next iteration, without keeping the device awake
+      stats.retries++;
+      retry = true;
+    } else {
+      // The connection cannot take it, e.g. it is closing
+      sub->version = s->version;
+    }
+  }
+}
+
+sl_status_t gatt_attribute_shadow_flush(void)
+{
+  sl_status_t result = SL_STATUS_OK;
+  sl_status_t sc;
+
+  pending = false;
+  retry = false;
+  for (uint8_t i = 0; i < shadow_count; i++) {
+    shadow_t *s = &shadows[i];
+
+    if (s->dirty) {
+      stats.writes++;
+      sc = sl_bt_gatt_server_write_attribute_value(s->attribute, 0, s->len, s->value);
+      if (sc != SL_STATUS_OK) {
+        // Not sent either, as a client reading the attribute would not get
+        // it. Written again at the next iteration, without keeping the
+        // device awake.
+        stats.write_failures++;
+        retry = true;
+        if (result == SL_STATUS_OK) {
+          result = sc;
+        }
+        continue;
+      }
+      s->dirty = false;
+    }
+    if (s->notify) {
+      send_value(s);
+    }
+  }
+  return result;
+}
+
+void sli_gatt_attribute_shadow_init(void)
+{
+  memset(shadows, 0, sizeof(shadows));
+  memset(&stats, 0, sizeof(stats));
+  shadow_count = 0;
+  pending = false;
+  retry = false;
+}
+
+void sli_gatt_attribute_shadow_process_action(void)
+{
+  if (pending || retry) {
+    (void)gatt_attribute_shadow_flush();
+  }
+}
+
+bool sli_gatt_attribute_shadow_is_ok_to_sleep(void)
+{
+  return !pending;
+}
+
+sl_status_t gatt_attribute_shadow_add(uint16_t attribute, bool notify)
+{
+  shadow_t *s = find_shadow(attribute);
+  size_t len;
+  sl_status_t sc;
+
+  if (s == NULL) {
+    if (shadow_count == GATT_ATTRIBUTE_SHADOW_MAX_ATTRIBUTES) {
+      return SL_STATUS_NO_MORE_RESOURCE;
+    }
+    s = &shadows[shadow_count];
+    memset(s, 0, sizeof(*s));
+    s->attribute = attribute;
+    sc = sl_bt_gatt_server_read_attribute_value(attribute, 0, sizeof(s->value),
+                                                &len, s->value);
+    if (sc != SL_STATUS_OK) {
+      return sc;
+    }
+    if (len > sizeof(s->value)) {
+      return SL_STATUS_INVALID_PARAMETER;
+    }
+    s->len = (uint16_t)len;
+    shadow_count++;
+  }
+  s->notify = notify;
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_attribute_shadow_set(uint16_t attribute,
+                                      uint16_t len,
+                                      const uint8_t *value)
+{
+  shadow_t *s = find_shadow(attribute);
+
+  if (s == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  if (len > sizeof(s->value)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  stats.sets++;
+  if (len == s->len && memcmp(value, s->value, len) == 0) {
+    stats.redundant++;
+    return SL_STATUS_OK;
+  }
+  if (s->dirty) {
+    stats.coalesced++;
+  }
+  memcpy(s->value, value, len);
+  s->len = len;
+  s->version++;
+  s->dirty = true;
+  pending = true;
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_attribute_shadow_get(uint16_t attribute,
+                                      uint16_t max_len,
+                                      uint16_t *len,
+                                      uint8_t *value)
+{
+  shadow_t *s = find_shadow(attribute);
+
+  if (s == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  if (max_len < s->len) {
+    return SL_STATUS_WOULD_OVERFLOW;
+  }
+  memcpy(value, s->value, s->len);
+  *len = s->len;
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_attribute_shadow_changed_since(uint8_t connection,
+                                                uint16_t attribute,
+                                                bool *changed)
+{
+  shadow_t *s = find_shadow(attribute);
+  subscriber_t *sub;
+
+  if (s == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  sub = find_subscriber(s, connection);
+  if (sub == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  *changed = is_stale(s, sub);
+  return SL_STATUS_OK;
+}
+
+void gatt_attribute_shadow_get_stats(gatt_attribute_shadow_stats_t *out)
+{
+  *out = stats;
+}
+
+static void on_characteristic_status(sl_bt_evt_gatt_server_characteristic_status_t *status)
+{
+  shadow_t *s = find_shadow(status->characteristic);
+  subscriber_t *sub;
+
+  if (s == NULL) {
+    return;
+  }
+  if (status->status_flags == sl_bt_gatt_server_confirmation) {
+    sub = find_subscriber(s, status->connection);
+    if (sub != NULL) {
+      sub->confirming = false;
+      retry = retry || is_stale(s, sub);
+    }
+  } else if (status->status_flags == sl_bt_gatt_server_client_config) {
+    if (status->client_config_flags == sl_bt_gatt_server_disable) {
+      sub = find_subscriber(s, status->connection);
+      if (sub != NULL) {
+        sub->used = false;
+      }
+      return;
+    }
+    // Nothing tells that the client read the value before it subscribed,
+    // it is thus sent the current one
+    sub = add_subscriber(s, status->connection);
+    if (sub != NULL) {
+      sub->indication = (status->client_config_flags & sl_bt_gatt_server_indication) != 0;
+      sub->version = s->version - 1;
+      pending = pending || s->notify;
+    }
+  }
+}
+
+// A client wrote the attribute: the shadow takes the value of the database
+static void on_attribute_value(sl_bt_evt_gatt_server_attribute_value_t *write)
+{
+  shadow_t *s = find_shadow(write->attribute);
+  uint8_t value[GATT_ATTRIBUTE_SHADOW_MAX_VALUE_LEN];
+  subscriber_t *sub;
+  size_t len;
+
+  if (s == NULL
+      || sl_bt_gatt_server_read_attribute_value(write->attribute, 0, sizeof(value),
+                                                &len, value) != SL_STATUS_OK
+      || len > sizeof(value)) {
+    return;
+  }
+  s->dirty = false;
+  if (len == s->len && memcmp(value, s->value, len) == 0) {
+    return;
+  }
+  memcpy(s->value, value, len);
+  s->len = (uint16_t)len;
+  s->version++;
+  // The writer has the value, the other subscribers are sent it
+  sub = find_subscriber(s, write->connection);
+  if (sub != NULL) {
+    sub->version = s->version;
+  }
+  pending = pending || s->notify;
+}
+
+void sli_gatt_attribute_shadow_on_event(sl_bt_msg_t *evt)
+{
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_gatt_server_characteristic_status_id:
+      on_characteristic_status(&evt->data.evt_gatt_server_characteristic_status);
+      break;
+
+    case sl_bt_evt_gatt_server_attribute_value_id:
+      on_attribute_value(&evt->data.evt_gatt_server_attribute_value);
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      for (uint8_t i = 0; i < shadow_count; i++) {
+        subscriber_t *sub = find_subscriber(&shadows[i], evt->data.evt_connection_closed.connection);
+
+        if (sub != NULL) {
+          sub->used = false;
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+}
@@ -0,0 +1,626 @@
+/***************************************************************************//**
+ * @file gatt_attribute_shadow_test.c
+ * @brief Host test and benchmark of the GATT Server Attribute Shadow.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Runs gatt_attribute_shadow.c against a mocked GATT server, which keeps the
+ * database and the last value each client received. The main loop is played
+ * by calling the process action handler of the component. The checks cover
+ * redundant and coalesced sets, new subscribers, client writes, indications,
+ * notifications and database writes the stack refuses, then a random stream
+ * after which every subscriber must hold the current value. The benchmark
+ * counts the BGAPI calls of a bursty sensor workload, with and without the
+ * shadow. Build and run on a PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I. -I../inc gatt_attribute_shadow_test.c ../src/gatt_attribute_shadow.c -o gatt_attribute_shadow_test
+ *   ./gatt_attribute_shadow_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gatt_attribute_shadow.h"
+
+#define MAX_HANDLE        64
+#define CONNECTIONS       4
+#define VALUE_LEN         8
+
+#define RANDOM_STEPS      100000
+#define RANDOM_ATTRIBUTES 4
+
+#define BENCH_ATTRIBUTES  8
+#define BENCH_BURSTS      6000  // 10 minutes of 100 ms bursts
+#define BENCH_SAMPLES     10    // Per attribute and burst
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+// ---------------------------------------------------------------------------
+// GATT server
+
+typedef struct {
+  uint8_t len;
+  uint8_t data[VALUE_LEN];
+} value_t;
+
+static value_t db[MAX_HANDLE];
+static value_t received[CONNECTIONS][MAX_HANDLE];   // Last value of each client
+static uint16_t cccd[CONNECTIONS][MAX_HANDLE];
+static bool confirming[CONNECTIONS][MAX_HANDLE];    // Indication not confirmed
+
+static unsigned writes;
+static unsigned notifications;
+static unsigned notify_alls;
+static unsigned indications;
+static unsigned overlapping_indications;
+
+static sl_status_t write_error = SL_STATUS_OK;
+static sl_status_t notify_error = SL_STATUS_OK;
+static sl_status_t notify_all_error = SL_STATUS_OK;
+
+static void set_value(value_t *v, size_t len, const uint8_t *data)
+{
+  v->len = (uint8_t)len;
+  memcpy(v->data, data, len);
+}
+
+sl_status_t sl_bt_gatt_server_read_attribute_value(uint16_t attribute,
+                                                   uint16_t offset,
+                                                   size_t max_value_size,
+                                                   size_t *value_len,
+                                                   uint8_t *value)
+{
+  (void)offset;
+  *value_len = db[attribute].len;
+  memcpy(value, db[attribute].data,
+         db[attribute].len < max_value_size ? db[attribute].len : max_value_size);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_write_attribute_value(uint16_t attribute,
+                                                    uint16_t offset,
+                                                    size_t value_len,
+                                                    const uint8_t *value)
+{
+  (void)offset;
+  writes++;
+  if (write_error != SL_STATUS_OK) {
+    return write_error;
+  }
+  set_value(&db[attribute], value_len, value);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_notification(uint8_t connection,
+                                                uint16_t characteristic,
+                                                size_t value_len,
+                                                const uint8_t *value)
+{
+  if (notify_error != SL_STATUS_OK) {
+    return notify_error;
+  }
+  notifications++;
+  set_value(&received[connection][characteristic], value_len, value);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_indication(uint8_t connection,
+                                              uint16_t characteristic,
+                                              size_t value_len,
+                                              const uint8_t *value)
+{
+  if (notify_error != SL_STATUS_OK) {
+    return notify_error;
+  }
+  if (confirming[connection][characteristic]) {
+    overlapping_indications++;
+    return SL_STATUS_INVALID_STATE;
+  }
+  indications++;
+  confirming[connection][characteristic] = true;
+  set_value(&received[connection][characteristic], value_len, value);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_notify_all(uint16_t characteristic,
+                                         size_t value_len,
+                                         const uint8_t *value)
+{
+  if (notify_all_error != SL_STATUS_OK) {
+    return notify_all_error;
+  }
+  notify_alls++;
+  for (uint8_t c = 0; c < CONNECTIONS; c++) {
+    if (cccd[c][characteristic] == sl_bt_gatt_server_indication) {
+      if (confirming[c][characteristic]) {
+        overlapping_indications++;
+      }
+      confirming[c][characteristic] = true;
+    }
+    if (cccd[c][characteristic] != sl_bt_gatt_server_disable) {
+      set_value(&received[c][characteristic], value_len, value);
+    }
+  }
+  return SL_STATUS_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Events
+
+static sl_bt_msg_t evt;
+
+static void status_event(uint8_t connection, uint16_t characteristic,
+                         uint8_t status_flags, uint16_t flags)
+{
+  memset(&evt, 0, sizeof(evt));
+  evt.header = sl_bt_evt_gatt_server_characteristic_status_id;
+  evt.data.evt_gatt_server_characteristic_status.connection = connection;
+  evt.data.evt_gatt_server_characteristic_status.characteristic = characteristic;
+  evt.data.evt_gatt_server_characteristic_status.status_flags = status_flags;
+  evt.data.evt_gatt_server_characteristic_status.client_config_flags = flags;
+  sli_gatt_attribute_shadow_on_event(&evt);
+}
+
+static void confirm(uint8_t connection, uint16_t characteristic)
+{
+  confirming[connection][characteristic] = false;
+  status_event(connection, characteristic, sl_bt_gatt_server_confirmation, 0);
+}
+
+// A client confirms an indication before it writes the CCCD again
+static void subscribe(uint8_t connection, uint16_t characteristic, uint16_t flags)
+{
+  if (confirming[connection][characteristic]) {
+    confirm(connection, characteristic);
+  }
+  cccd[connection][characteristic] = flags;
+  status_event(connection, characteristic, sl_bt_gatt_server_client_config, flags);
+}
+
+static void client_write(uint8_t connection, uint16_t attribute, uint8_t value)
+{
+  db[attribute].len = 1;
+  db[attribute].data[0] = value;
+  received[connection][attribute] = db[attribute];
+  memset(&evt, 0, sizeof(evt));
+  evt.header = sl_bt_evt_gatt_server_attribute_value_id;
+  evt.data.evt_gatt_server_attribute_value.connection = connection;
+  evt.data.evt_gatt_server_attribute_value.attribute = attribute;
+  sli_gatt_attribute_shadow_on_event(&evt);
+}
+
+static void close_connection(uint8_t connection)
+{
+  for (uint16_t a = 0; a < MAX_HANDLE; a++) {
+    cccd[connection][a] = sl_bt_gatt_server_disable;
+    confirming[connection][a] = false;
+  }
+  memset(&evt, 0, sizeof(evt));
+  evt.header = sl_bt_evt_connection_closed_id;
+  evt.data.evt_connection_closed.connection = connection;
+  sli_gatt_attribute_shadow_on_event(&evt);
+}
+
+static bool same_value(const value_t *a, const value_t *b)
+{
+  return a->len == b->len && memcmp(a->data, b->data, a->len) == 0;
+}
+
+static bool changed_since(uint8_t connection, uint16_t attribute)
+{
+  bool changed = false;
+
+  CHECK(gatt_attribute_shadow_changed_since(connection, attribute, &changed) == SL_STATUS_OK);
+  return changed;
+}
+
+static void reset(void)
+{
+  memset(db, 0, sizeof(db));
+  memset(received, 0, sizeof(received));
+  memset(cccd, 0, sizeof(cccd));
+  memset(confirming, 0, sizeof(confirming));
+  writes = 0;
+  notifications = 0;
+  notify_alls = 0;
+  indications = 0;
+  overlapping_indications = 0;
+  write_error = SL_STATUS_OK;
+  notify_error = SL_STATUS_OK;
+  notify_all_error = SL_STATUS_OK;
+  sli_gatt_attribute_shadow_init();
+}
+
+static void clear_counts(void)
+{
+  writes = 0;
+  notifications = 0;
+  notify_alls = 0;
+  indications = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Checks
+
+// Redundant sets do nothing, the others are written and sent once
+static void test_sets(void)
+{
+  static const uint8_t same[2] = { 1, 2 };
+  gatt_attribute_shadow_stats_t stats;
+  uint8_t value[4];
+  uint16_t len;
+
+  reset();
+  set_value(&db[10], 2, same);
+  CHECK(gatt_attribute_shadow_add(10, true) == SL_STATUS_OK);
+  CHECK(gatt_attribute_shadow_add(11, false) == SL_STATUS_OK);
+  CHECK(gatt_attribute_shadow_set(12, 1, value) == SL_STATUS_NOT_FOUND);
+  CHECK(gatt_attribute_shadow_set(10, GATT_ATTRIBUTE_SHADOW_MAX_VALUE_LEN + 1, value)
+        == SL_STATUS_INVALID_PARAMETER);
+  CHECK(gatt_attribute_shadow_set(10, 2, same) == SL_STATUS_OK);
+  CHECK(sli_gatt_attribute_shadow_is_ok_to_sleep());
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(writes == 0);
+
+  for (uint8_t i = 0; i < 5; i++) {
+    uint8_t sample[2] = { i, 9 };
+
+    CHECK(gatt_attribute_shadow_set(10, 2, sample) == SL_STATUS_OK);
+  }
+  CHECK(!sli_gatt_attribute_shadow_is_ok_to_sleep());
+  CHECK(gatt_attribute_shadow_get(10, sizeof(value), &len, value) == SL_STATUS_OK);
+  CHECK(len == 2 && value[0] == 4);
+  CHECK(gatt_attribute_shadow_get(10, 1, &len, value) == SL_STATUS_WOULD_OVERFLOW);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(writes == 1 && db[10].data[0] == 4);
+  CHECK(sli_gatt_attribute_shadow_is_ok_to_sleep());
+
+  gatt_attribute_shadow_get_stats(&stats);
+  CHECK(stats.sets == 6 && stats.redundant == 1 && stats.coalesced == 4);
+  CHECK(stats.writes == 1 && stats.write_failures == 0);
+}
+
+// A new subscriber is sent the current value, even if it was set long before
+static void test_new_subscriber(void)
+{
+  static const uint8_t value[1] = { 5 };
+
+  reset();
+  CHECK(gatt_attribute_shadow_add(10, true) == SL_STATUS_OK);
+  CHECK(gatt_attribute_shadow_set(10, 1, value) == SL_STATUS_OK);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(writes == 1 && notifications == 0 && notify_alls == 0);
+
+  subscribe(1, 10, sl_bt_gatt_server_notification);
+  CHECK(changed_since(1, 10));
+  CHECK(!sli_gatt_attribute_shadow_is_ok_to_sleep());
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(writes == 1 && notifications == 1);
+  CHECK(same_value(&received[1][10], &db[10]));
+  CHECK(!changed_since(1, 10));
+
+  // Two new subscribers are reached by one call
+  subscribe(2, 10, sl_bt_gatt_server_notification);
+  subscribe(3, 10, sl_bt_gatt_server_notification);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notifications == 3 && notify_alls == 0);
+  CHECK(same_value(&received[2][10], &db[10]) && same_value(&received[3][10], &db[10]));
+
+  // All subscribers behind: one call
+  clear_counts();
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 6 }) == SL_STATUS_OK);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notify_alls == 1 && notifications == 0);
+
+  // Unknown connection
+  bool changed;
+  CHECK(gatt_attribute_shadow_changed_since(0, 10, &changed) == SL_STATUS_NOT_FOUND);
+}
+
+// A client write is taken into the shadow and sent to the others only
+static void test_client_write(void)
+{
+  reset();
+  CHECK(gatt_attribute_shadow_add(10, true) == SL_STATUS_OK);
+  CHECK(gatt_attribute_shadow_add(11, false) == SL_STATUS_OK);
+  subscribe(1, 10, sl_bt_gatt_server_notification);
+  subscribe(2, 10, sl_bt_gatt_server_notification);
+  subscribe(1, 11, sl_bt_gatt_server_notification);
+  sli_gatt_attribute_shadow_process_action();
+  clear_counts();
+
+  client_write(1, 10, 7);
+  CHECK(!changed_since(1, 10) && changed_since(2, 10));
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(writes == 0 && notify_alls == 0 && notifications == 1);
+  CHECK(received[2][10].data[0] == 7);
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 7 }) == SL_STATUS_OK);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(writes == 0);
+
+  // An attribute without notify is written, not sent
+  clear_counts();
+  CHECK(gatt_attribute_shadow_set(11, 1, (const uint8_t[]){ 3 }) == SL_STATUS_OK);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(writes == 1 && notifications == 0 && notify_alls == 0);
+  CHECK(changed_since(1, 11));
+}
+
+// An indicated subscriber gets the latest value once it confirms
+static void test_indications(void)
+{
+  reset();
+  CHECK(gatt_attribute_shadow_add(10, true) == SL_STATUS_OK);
+  subscribe(1, 10, sl_bt_gatt_server_notification);
+  subscribe(2, 10, sl_bt_gatt_server_indication);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notify_alls == 1);
+  clear_counts();
+
+  confirm(2, 10);
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 20 }) == SL_STATUS_OK);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notify_alls == 1 && notifications == 0 && indications == 0);
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 21 }) == SL_STATUS_OK);
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 22 }) == SL_STATUS_OK);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notifications == 1 && indications == 0);
+  CHECK(sli_gatt_attribute_shadow_is_ok_to_sleep());
+  confirm(2, 10);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(indications == 1 && received[2][10].data[0] == 22);
+  CHECK(overlapping_indications == 0);
+}
+
+// Notifications refused for lack of buffers are sent again later, other
+// errors of notify_all fall back to one call per subscriber
+static void test_refused_notifications(void)
+{
+  gatt_attribute_shadow_stats_t stats;
+
+  reset();
+  CHECK(gatt_attribute_shadow_add(10, true) == SL_STATUS_OK);
+  subscribe(1, 10, sl_bt_gatt_server_notification);
+  sli_gatt_attribute_shadow_process_action();
+  clear_counts();
+
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 30 }) == SL_STATUS_OK);
+  notify_error = SL_STATUS_NO_MORE_RESOURCE;
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notifications == 0 && sli_gatt_attribute_shadow_is_ok_to_sleep());
+  notify_error = SL_STATUS_OK;
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notifications == 1 && writes == 1 && received[1][10].data[0] == 30);
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notifications == 1);
+
+  subscribe(2, 10, sl_bt_gatt_server_notification);
+  sli_gatt_attribute_shadow_process_action();
+  clear_counts();
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 31 }) == SL_STATUS_OK);
+  notify_all_error = SL_STATUS_NO_MORE_RESOURCE;
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notify_alls == 0 && notifications == 0 && changed_since(1, 10));
+  notify_all_error = SL_STATUS_INVALID_STATE;
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(notify_alls == 0 && notifications == 2);
+  CHECK(received[1][10].data[0] == 31 && received[2][10].data[0] == 31);
+  gatt_attribute_shadow_get_stats(&stats);
+  CHECK(stats.retries == 2);
+}
+
+// A value the database refuses is kept, not sent, and written again
+static void test_refused_write(void)
+{
+  gatt_attribute_shadow_stats_t stats;
+
+  reset();
+  CHECK(gatt_attribute_shadow_add(10, true) == SL_STATUS_OK);
+  CHECK(gatt_attribute_shadow_add(11, true) == SL_STATUS_OK);
+  subscribe(1, 10, sl_bt_gatt_server_notification);
+  subscribe(1, 11, sl_bt_gatt_server_notification);
+  sli_gatt_attribute_shadow_process_action();
+  clear_counts();
+
+  CHECK(gatt_attribute_shadow_set(10, 1, (const uint8_t[]){ 40 }) == SL_STATUS_OK);
+  write_error = SL_STATUS_BT_ATT_INVALID_HANDLE;
+  CHECK(gatt_attribute_shadow_flush() == SL_STATUS_BT_ATT_INVALID_HANDLE);
+  CHECK(db[10].data[0] == 0 && notifications == 0 && changed_since(1, 10));
+  CHECK(sli_gatt_attribute_shadow_is_ok_to_sleep());
+  gatt_attribute_shadow_get_stats(&stats);
+  CHECK(stats.write_failures == 1);
+
+  write_error = SL_STATUS_OK;
+  sli_gatt_attribute_shadow_process_action();
+  CHECK(db[10].data[0] == 40 && received[1][10].data[0] == 40);
+  CHECK(gatt_attribute_shadow_flush() == SL_STATUS_OK);
+  CHECK(writes == 2 && notifications == 1);
+}
+
+// Random sets, subscriptions, confirmations, closes and refusals: once the
+// stack accepts everything again, every subscriber holds the current value
+static void test_random(void)
+{
+  uint16_t len;
+  uint8_t value[VALUE_LEN];
+
+  reset();
+  srand(1);
+  for (uint16_t a = 0; a < RANDOM_ATTRIBUTES; a++) {
+    CHECK(gatt_attribute_shadow_add((uint16_t)(20 + a), true) == SL_STATUS_OK);
+  }
+  for (unsigned step = 0; step < RANDOM_STEPS; step++) {
+    uint16_t a = (uint16_t)(20 + (unsigned)rand() % RANDOM_ATTRIBUTES);
+    uint8_t c = (uint8_t)((unsigned)rand() % CONNECTIONS);
+    unsigned action = (unsigned)rand() % 100;
+
+    if (action < 50) {
+      uint8_t sample[2] = { (uint8_t)((unsigned)rand() % 4), (uint8_t)c };
+
+      CHECK(gatt_attribute_shadow_set(a, 1 + (uint16_t)((unsigned)rand() % 2), sample) == SL_STATUS_OK);
+    } else if (action < 60) {
+      subscribe(c, a, (uint16_t)((unsigned)rand() % 3));
+    } else if (action < 70) {
+      if (confirming[c][a]) {
+        confirm(c, a);
+      }
+    } else if (action < 73) {
+      client_write(c, a, (uint8_t)((unsigned)rand() % 4));
+    } else if (action < 74) {
+      close_connection(c);
+    } else if (action < 80) {
+      write_error = (rand() % 2) ? SL_STATUS_NO_MORE_RESOURCE : SL_STATUS_OK;
+      notify_error = (rand() % 2) ? SL_STATUS_NO_MORE_RESOURCE : SL_STATUS_OK;
+      notify_all_error = (rand() % 3 == 0) ? SL_STATUS_INVALID_STATE
+                         : (rand() % 2) ? SL_STATUS_NO_MORE_RESOURCE : SL_STATUS_OK;
+    } else {
+      sli_gatt_attribute_shadow_process_action();
+    }
+  }
+
+  write_error = SL_STATUS_OK;
+  notify_error = SL_STATUS_OK;
+  notify_all_error = SL_STATUS_OK;
+  for (int i = 0; i < 3; i++) {
+    for (uint8_t c = 0; c < CONNECTIONS; c++) {
+      for (uint16_t a = 20; a < 20 + RANDOM_ATTRIBUTES; a++) {
+        if (confirming[c][a]) {
+          confirm(c, a);
+        }
+      }
+    }
+    sli_gatt_attribute_shadow_process_action();
+  }
+  for (uint16_t a = 20; a < 20 + RANDOM_ATTRIBUTES; a++) {
+    CHECK(gatt_attribute_shadow_get(a, sizeof(value), &len, value) == SL_STATUS_OK);
+    CHECK(len == db[a].len && memcmp(value, db[a].data, len) == 0);
+    for (uint8_t c = 0; c < CONNECTIONS; c++) {
+      if (cccd[c][a] != sl_bt_gatt_server_disable) {
+        CHECK(same_value(&received[c][a], &db[a]));
+        CHECK(!changed_since(c, a));
+      }
+    }
+  }
+  CHECK(overlapping_indications == 0);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+
+static void benchmark(void)
+{
+  gatt_attribute_shadow_stats_t stats;
+  int value[BENCH_ATTRIBUTES] = { 0 };
+  int last[BENCH_ATTRIBUTES];
+  unsigned naive_writes = 0;
+  unsigned naive_notifications = 0;
+
+  // A write per sample, and a notify_all per changed one
+  srand(1);
+  for (int a = 0; a < BENCH_ATTRIBUTES; a++) {
+    last[a] = -1;
+  }
+  for (int t = 0; t < BENCH_BURSTS; t++) {
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+      for (int a = 0; a < BENCH_ATTRIBUTES; a++) {
+        if (rand() % 4 == 0) {
+          value[a] += (rand() % 2) ? 1 : -1;
+        }
+        naive_writes++;
+        if (value[a] != last[a]) {
+          naive_notifications++;
+          last[a] = value[a];
+        }
+      }
+    }
+  }
+
+  // The same samples through the shadow, flushed at the end of each burst
+  reset();
+  for (uint16_t a = 0; a < BENCH_ATTRIBUTES; a++) {
+    db[40 + a].len = 2;
+    CHECK(gatt_attribute_shadow_add((uint16_t)(40 + a), true) == SL_STATUS_OK);
+    subscribe(1, (uint16_t)(40 + a), sl_bt_gatt_server_notification);
+    subscribe(2, (uint16_t)(40 + a), sl_bt_gatt_server_notification);
+  }
+  srand(1);
+  memset(value, 0, sizeof(value));
+  for (int t = 0; t < BENCH_BURSTS; t++) {
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+      for (int a = 0; a < BENCH_ATTRIBUTES; a++) {
+        uint8_t sample[2];
+
+        if (rand() % 4 == 0) {
+          value[a] += (rand() % 2) ? 1 : -1;
+        }
+        sample[0] = (uint8_t)value[a];
+        sample[1] = (uint8_t)(value[a] >> 8);
+        CHECK(gatt_attribute_shadow_set((uint16_t)(40 + a), 2, sample) == SL_STATUS_OK);
+      }
+    }
+    sli_gatt_attribute_shadow_process_action();
+  }
+  gatt_attribute_shadow_get_stats(&stats);
+  printf("%d attributes, 2 subscribers, %d bursts of %d samples\n",
+         BENCH_ATTRIBUTES, BENCH_BURSTS, BENCH_SAMPLES);
+  printf("write and notify each sample: %6u writes + %6u notify_all                      = %6u BGAPI calls\n",
+         naive_writes, naive_notifications, naive_writes + naive_notifications);
+  printf("shadow:                       %6u writes + %6u notify_all + %u notifications = %6u BGAPI calls\n",
+         writes, notify_alls, notifications, writes + notify_alls + notifications);
+  printf("(%lu sets, %lu redundant, %lu coalesced)\n",
+         (unsigned long)stats.sets, (unsigned long)stats.redundant, (unsigned long)stats.coalesced);
+}
+
+int main(void)
+{
+  test_sets();
+  test_new_subscriber();
+  test_client_write();
+  test_indications();
+  test_refused_notifications();
+  test_refused_write();
+  test_random();
+  benchmark();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,128 @@
+/***************************************************************************//**
+ * @file sl_bluetooth.h
+ * @brief Host stand-in for the Bluetooth API of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only what gatt_attribute_shadow.c uses, so it builds on a PC without the
+ * Simplicity SDK. The commands are implemented by the test. */
+
+#ifndef SL_BLUETOOTH_H
+#define SL_BLUETOOTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                  ((sl_status_t)0x0000)
+#define SL_STATUS_FAIL                ((sl_status_t)0x0001)
+#define SL_STATUS_INVALID_STATE       ((sl_status_t)0x0002)
+#define SL_STATUS_NOT_FOUND           ((sl_status_t)0x000C)
+#define SL_STATUS_NO_MORE_RESOURCE    ((sl_status_t)0x0019)
+#define SL_STATUS_INVALID_PARAMETER   ((sl_status_t)0x0021)
+#define SL_STATUS_WOULD_OVERFLOW      ((sl_status_t)0x0028)
+#define SL_STATUS_BT_ATT_INVALID_HANDLE ((sl_status_t)0x1101)
+
+#define SL_BT_MSG_ID(header)          ((header) & 0xffff00f8)
+
+#define sl_bt_evt_connection_closed_id                 0x010600a0
+#define sl_bt_evt_gatt_server_attribute_value_id       0x000a00a0
+#define sl_bt_evt_gatt_server_characteristic_status_id 0x030a00a0
+
+typedef enum {
+  sl_bt_gatt_server_disable      = 0x0,
+  sl_bt_gatt_server_notification = 0x1,
+  sl_bt_gatt_server_indication   = 0x2
+} sl_bt_gatt_server_client_configuration_t;
+
+typedef enum {
+  sl_bt_gatt_server_client_config = 0x1,
+  sl_bt_gatt_server_confirmation  = 0x2
+} sl_bt_gatt_server_characteristic_status_flag_t;
+
+typedef struct {
+  uint8_t len;
+  uint8_t data[255];
+} uint8array;
+
+typedef struct {
+  uint16_t reason;
+  uint8_t connection;
+} sl_bt_evt_connection_closed_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t attribute;
+  uint8_t att_opcode;
+  uint16_t offset;
+  uint8array value;
+} sl_bt_evt_gatt_server_attribute_value_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t characteristic;
+  uint8_t status_flags;
+  uint16_t client_config_flags;
+  uint16_t client_config;
+} sl_bt_evt_gatt_server_characteristic_status_t;
+
+typedef struct {
+  uint32_t header;
+  union {
+    sl_bt_evt_connection_closed_t evt_connection_closed;
+    sl_bt_evt_gatt_server_attribute_value_t evt_gatt_server_attribute_value;
+    sl_bt_evt_gatt_server_characteristic_status_t evt_gatt_server_characteristic_status;
+  } data;
+} sl_bt_msg_t;
+
+sl_status_t sl_bt_gatt_server_read_attribute_value(uint16_t attribute,
+                                                   uint16_t offset,
+                                                   size_t max_value_size,
+                                                   size_t *value_len,
+                                                   uint8_t *value);
+
+sl_status_t sl_bt_gatt_server_write_attribute_value(uint16_t attribute,
+                                                    uint16_t offset,
+                                                    size_t value_len,
+                                                    const uint8_t *value);
+
+sl_status_t sl_bt_gatt_server_send_notification(uint8_t connection,
+                                                uint16_t characteristic,
+                                                size_t value_len,
+                                                const uint8_t *value);
+
+sl_status_t sl_bt_gatt_server_send_indication(uint8_t connection,
+                                              uint16_t characteristic,
+                                              size_t value_len,
+                                              const uint8_t *value);
+
+sl_status_t sl_bt_gatt_server_notify_all(uint16_t characteristic,
+                                         size_t value_len,
+                                         const uint8_t *value);
+
+#endif // SL_BLUETOOTH_H
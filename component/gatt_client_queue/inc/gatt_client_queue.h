@@ -0,0 +1,250 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT Client Procedure Queue
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#ifndef GATT_CLIENT_QUEUE_H
+#define GATT_CLIENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Number of connections with a queue.
+#ifndef GATT_CLIENT_QUEUE_MAX_CONNECTIONS
+#ifdef SL_BT_CONFIG_MAX_CONNECTIONS
+#define GATT_CLIENT_QUEUE_MAX_CONNECTIONS   SL_BT_CONFIG_MAX_CONNECTIONS
+#else
+#define GATT_CLIENT_QUEUE_MAX_CONNECTIONS   4
+#endif
+#endif
+
+// Requests that can wait on a connection, including the running one.
+#ifndef GATT_CLIENT_QUEUE_DEPTH
+#define GATT_CLIENT_QUEUE_DEPTH             8
+#endif
+
+// Longest value a read can return. Longer values are truncated.
+#ifndef GATT_CLIENT_QUEUE_MAX_VALUE_LEN
+#define GATT_CLIENT_QUEUE_MAX_VALUE_LEN     256
+#endif
+
+/***************************************************************************//**
+ * @brief GATT client procedure of a request
+ ******************************************************************************/
+typedef enum {
+  GATT_CLIENT_QUEUE_READ,                     // Read a characteristic value
+  GATT_CLIENT_QUEUE_WRITE,                    // Write a characteristic value
+  GATT_CLIENT_QUEUE_DISCOVER_SERVICES,        // Discover the primary services
+  GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS, // Discover the characteristics of a service
+  GATT_CLIENT_QUEUE_DISCOVER_DESCRIPTORS,     // Discover the descriptors of a characteristic
+  GATT_CLIENT_QUEUE_SET_NOTIFICATION          // Write the CCCD of a characteristic
+} gatt_client_queue_op_t;
+
+/***************************************************************************//**
+ * @brief Priority of a request. Requests of the same priority are run in the
+ *        order they were enqueued.
+ ******************************************************************************/
+typedef enum {
+  GATT_CLIENT_QUEUE_PRIORITY_LOW,
+  GATT_CLIENT_QUEUE_PRIORITY_NORMAL,
+  GATT_CLIENT_QUEUE_PRIORITY_HIGH
+} gatt_client_queue_priority_t;
+
+/***************************************************************************//**
+ * @brief Result passed to the callback of a request
+ ******************************************************************************/
+typedef struct {
+  uint8_t connection;
+  gatt_client_queue_op_t op;
+  uint32_t target;          // Characteristic handle, or service of a characteristic discovery
+  sl_status_t status;       // Procedure result, or the close reason
+  const sl_bt_msg_t *evt;   // Service, characteristic or descriptor found by a
+                            // discovery, NULL when the request ends
+  const uint8_t *value;     // Value read, valid during the callback only
+  uint16_t len;
+  uint32_t latency_ms;      // Time from the enqueueing to the end
+} gatt_client_queue_result_t;
+
+/***************************************************************************//**
+ * @brief Called for each attribute found by a discovery, and once when a
+ *        request ends
+ *
+ * @param[in] result Result of the request
+ * @param[in] context Context given when enqueueing
+ ******************************************************************************/
+typedef void (*gatt_client_queue_callback_t)(const gatt_client_queue_result_t *result,
+                                             void *context);
+
+/***************************************************************************//**
+ * @brief Statistics of a connection
+ ******************************************************************************/
+typedef struct {
+  uint32_t enqueued;        // Requests accepted
+  uint32_t coalesced;       // Reads answered by another pending read
+  uint32_t procedures;      // Procedures run
+  uint32_t completed;       // Requests ended successfully
+  uint32_t failed;          // Requests failed or aborted by the close
+  uint8_t depth;            // Requests waiting or running now
+  uint8_t max_depth;
+  uint32_t total_latency_ms;  // Of the completed requests
+  uint32_t max_latency_ms;
+} gatt_client_queue_stats_t;
+
+void sli_gatt_client_queue_init(void);
+void sli_gatt_client_queue_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Enqueue a request. It is run at once if the connection has no procedure
+ * running, otherwise as soon as the ones before it have completed. The queue
+ * must run all GATT client procedures of the connection: the application
+ * must not start any itself.
+ *
+ * A read of a characteristic that another request is waiting to read is
+ * coalesced with it: both callbacks get the value of the single read, and
+ * the request gets the higher of the two priorities.
+ *
+ * The data of a write is not copied: it must stay valid and unchanged until
+ * the callback is called.
+ *
+ * SL_STATUS_NO_MORE_RESOURCE will be returned if the queue of the connection
+ * is full, or if all queues are used by other connections.
+ *
+ * @param[in] connection Connection handle
+ * @param[in] op Procedure to run
+ * @param[in] priority Priority of the request
+ * @param[in] target Characteristic handle, service handle for
+ *            GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS, unused for
+ *            GATT_CLIENT_QUEUE_DISCOVER_SERVICES
+ * @param[in] data Value of a write, sl_bt_gatt_client_config_flag_t of
+ *            GATT_CLIENT_QUEUE_SET_NOTIFICATION in its first byte
+ * @param[in] len Length of @p data
+ * @param[in] callback Function called with the results
+ * @param[in] context Passed to @p callback
+ *
+ * @return SL_STATUS_OK if the request was enqueued. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_client_queue_enqueue(uint8_t connection,
+                                      gatt_client_queue_op_t op,
+                                      gatt_client_queue_priority_t priority,
+                                      uint32_t target,
+                                      const uint8_t *data,
+                                      uint16_t len,
+                                      gatt_client_queue_callback_t callback,
+                                      void *context);
+
+/***************************************************************************//**
+ *
+ * Enqueue a read of a characteristic value.
+ *
+ * @param[in] connection Connection handle
+ * @param[in] characteristic Characteristic handle
+ * @param[in] priority Priority of the request
+ * @param[in] callback Function called with the value
+ * @param[in] context Passed to @p callback
+ *
+ * @return SL_STATUS_OK if the request was enqueued. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_client_queue_read(uint8_t connection,
+                                   uint16_t characteristic,
+                                   gatt_client_queue_priority_t priority,
+                                   gatt_client_queue_callback_t callback,
+                                   void *context);
+
+/***************************************************************************//**
+ *
+ * Enqueue a write of a characteristic value with response.
+ *
+ * @param[in] connection Connection handle
+ * @param[in] characteristic Characteristic handle
+ * @param[in] data Value, valid until the callback is called
+ * @param[in] len Length of the value
+ * @param[in] priority Priority of the request
+ * @param[in] callback Function called when the write ends
+ * @param[in] context Passed to @p callback
+ *
+ * @return SL_STATUS_OK if the request was enqueued. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_client_queue_write(uint8_t connection,
+                                    uint16_t characteristic,
+                                    const uint8_t *data,
+                                    uint16_t len,
+                                    gatt_client_queue_priority_t priority,
+                                    gatt_client_queue_callback_t callback,
+                                    void *context);
+
+/***************************************************************************//**
+ *
+ * Enqueue the enabling or disabling of notifications or indications.
+ *
+ * @param[in] connection Connection handle
+ * @param[in] characteristic Characteristic handle
+ * @param[in] flags Notification, indication or disable
+ * @param[in] priority Priority of the request
+ * @param[in] callback Function called when the CCCD is written
+ * @param[in] context Passed to @p callback
+ *
+ * @return SL_STATUS_OK if the request was enqueued. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_client_queue_set_notification(uint8_t connection,
+                                               uint16_t characteristic,
+                                               sl_bt_gatt_client_config_flag_t flags,
+                                               gatt_client_queue_priority_t priority,
+                                               gatt_client_queue_callback_t callback,
+                                               void *context);
+
+/***************************************************************************//**
+ *
+ * Drop the waiting requests of a connection, without calling their
+ * callbacks. The running one still ends with its callback.
+ *
+ * @param[in] connection Connection handle
+ *
+ ******************************************************************************/
+void gatt_client_queue_flush(uint8_t connection);
+
+/***************************************************************************//**
+ *
+ * Retrieve the statistics of a connection.
+ *
+ * SL_STATUS_NOT_FOUND will be returned if the connection has no queue.
+ *
+ * @param[in] connection Connection handle
+ * @param[out] stats Statistics
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_client_queue_get_stats(uint8_t connection,
+                                        gatt_client_queue_stats_t *stats);
+
+#endif // GATT_CLIENT_QUEUE_H
@@ -0,0 +1,501 @@
+/***************************************************************************//**
+ * @file
+ * @brief GATT Client Procedure Queue
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "sl_bluetooth.h"
+#include "sl_sleeptimer.h"
+#include "gatt_client_queue.h"
+
+#define NO_REQUEST  0xFF
+
+_Static_assert(GATT_CLIENT_QUEUE_DEPTH < NO_REQUEST, "Queue too deep");
+
+typedef struct {
+  bool used;
+  gatt_client_queue_op_t op;
+  gatt_client_queue_priority_t priority;
+  uint32_t target;
+  const uint8_t *data;
+  uint16_t len;
+  gatt_client_queue_callback_t callback;
+  void *context;
+  uint32_t seq;             // Order of enqueueing
+  uint8_t leader;           // Read this one is coalesced with, NO_REQUEST if none
+  uint64_t enqueue_tick;
+} request_t;
+
+typedef struct {
+  bool used;
+  bool closing;             // Requests are being aborted by the close
+  uint8_t connection;
+  uint8_t running;          // Request whose procedure runs, NO_REQUEST if none
+  uint32_t next_seq;
+  request_t requests[GATT_CLIENT_QUEUE_DEPTH];
+  uint8_t value[GATT_CLIENT_QUEUE_MAX_VALUE_LEN];
+  uint16_t value_len;
+  gatt_client_queue_stats_t stats;
+} connection_t;
+
+static connection_t connections[GATT_CLIENT_QUEUE_MAX_CONNECTIONS];
+
+static connection_t *find_connection(uint8_t connection)
+{
+  for (uint8_t i = 0; i < GATT_CLIENT_QUEUE_MAX_CONNECTIONS; i++) {
+    if (connections[i].used && connections[i].connection == connection) {
+      return &connections[i];
+    }
+  }
+  return NULL;
+}
+
+static connection_t *open_connection(uint8_t connection)
+{
+  connection_t *c = NULL;
+
+  for (uint8_t i = 0; c == NULL && i < GATT_CLIENT_QUEUE_MAX_CONNECTIONS; i++) {
+    if (!connections[i].used) {
+      c = &connections[i];
+    }
+  }
+  if (c != NULL) {
+    memset(c, 0, sizeof(*c));
+    c->used = true;
+    c->connection = connection;
+    c->running = NO_REQUEST;
+  }
+  return c;
+}
+
+static uint8_t find_free_request(connection_t *c)
+{
+  for (uint8_t i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    if (!c->requests[i].used) {
+      return i;
+    }
+  }
+  return NO_REQUEST;
+}
+
+// A read waiting for its procedure, which another read can join
+static uint8_t find_pending_read(connection_t *c, uint32_t target)
+{
+  for (uint8_t i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    request_t *r = &c->requests[i];
+
+    if (r->used && i != c->running && r->leader == NO_REQUEST
+        && r->op == GATT_CLIENT_QUEUE_READ && r->target == target) {
+      return i;
+    }
+  }
+  return NO_REQUEST;
+}
+
+// Highest priority first, then the oldest
+static uint8_t find_next_request(connection_t *c)
+{
+  uint8_t next = NO_REQUEST;
+
+  for (uint8_t i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    request_t *r = &c->requests[i];
+
+    if (!r->used || r->leader != NO_REQUEST) {
+      continue;
+    }
+    if (next == NO_REQUEST
+        || r->priority > c->requests[next].priority
+        || (r->priority == c->requests[next].priority
+            && (int32_t)(r->seq - c->requests[next].seq) < 0)) {
+      next = i;
+    }
+  }
+  return next;
+}
+
+static void call(connection_t *c, const request_t *r, sl_status_t status,
+                 const sl_bt_msg_t *evt)
+{
+  gatt_client_queue_result_t result;
+  uint64_t ms = 0;
+
+  if (r->callback == NULL) {
+    return;
+  }
+  if (evt == NULL) {
+    sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64() - r->enqueue_tick, &ms);
+  }
+  result.connection = c->connection;
+  result.op = r->op;
+  result.target = r->target;
+  result.status = status;
+  result.evt = evt;
+  result.value = NULL;
+  result.len = 0;
+  if (r->op == GATT_CLIENT_QUEUE_READ && evt == NULL && status == SL_STATUS_OK) {
+    result.value = c->value;
+    result.len = c->value_len;
+  }
+  result.latency_ms = (uint32_t)ms;
+  r->callback(&result, r->context);
+}
+
+static void update_stats(connection_t *c, const request_t *r, sl_status_t status)
+{
+  uint64_t ms;
+
+  if (status != SL_STATUS_OK) {
+    c->stats.failed++;
+    return;
+  }
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64() - r->enqueue_tick, &ms);
+  c->stats.completed++;
+  c->stats.total_latency_ms += (uint32_t)ms;
+  if (ms > c->stats.max_latency_ms) {
+    c->stats.max_latency_ms = (uint32_t)ms;
+  }
+}
+
+// End a request and the reads coalesced with it. The slots are freed before
+// the callbacks are called, which can thus enqueue new requests.
+static void complete(connection_t *c, uint8_t index, sl_status_t status)
+{
+  request_t done[GATT_CLIENT_QUEUE_DEPTH];
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    request_t *r = &c->requests[i];
+
+    if (r->used && (i == index || r->leader == index)) {
+      done[count++] = *r;
+      update_stats(c, r, status);
+      r->used = false;
+      c->stats.depth--;
+    }
+  }
+  if (c->running == index) {
+    c->running = NO_REQUEST;
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    call(c, &done[i], status, NULL);
+  }
+}
+
+static sl_status_t start_procedure(connection_t *c, const request_t *r)
+{
+  switch (r->op) {
+    case GATT_CLIENT_QUEUE_READ:
+      c->value_len = 0;
+      return sl_bt_gatt_read_characteristic_value(c->connection, (uint16_t)r->target);
+
+    case GATT_CLIENT_QUEUE_WRITE:
+      return sl_bt_gatt_write_characteristic_value(c->connection, (uint16_t)r->target,
+                                                   r->len, r->data);
+
+    case GATT_CLIENT_QUEUE_DISCOVER_SERVICES:
+      return sl_bt_gatt_discover_primary_services(c->connection);
+
+    case GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS:
+      return sl_bt_gatt_discover_characteristics(c->connection, r->target);
+
+    case GATT_CLIENT_QUEUE_DISCOVER_DESCRIPTORS:
+      return sl_bt_gatt_discover_descriptors(c->connection, (uint16_t)r->target);
+
+    case GATT_CLIENT_QUEUE_SET_NOTIFICATION:
+      return sl_bt_gatt_set_characteristic_notification(c->connection, (uint16_t)r->target,
+                                                        r->data[0]);
+
+    default:
+      return SL_STATUS_INVALID_PARAMETER;
+  }
+}
+
+// Start the next request, if no procedure is running. A request the stack
+// refuses ends with the error of the stack, and the one after it is tried.
+static void dispatch(connection_t *c)
+{
+  uint8_t next;
+  sl_status_t sc;
+
+  while (c->running == NO_REQUEST) {
+    next = find_next_request(c);
+    if (next == NO_REQUEST) {
+      return;
+    }
+    sc = start_procedure(c, &c->requests[next]);
+    if (sc != SL_STATUS_OK) {
+      complete(c, next, sc);
+      continue;
+    }
+    c->running = next;
+    c->stats.procedures++;
+  }
+}
+
+void sli_gatt_client_queue_init(void)
+{
+  memset(connections, 0, sizeof(connections));
+}
+
+sl_status_t gatt_client_queue_enqueue(uint8_t connection,
+                                      gatt_client_queue_op_t op,
+                                      gatt_client_queue_priority_t priority,
+                                      uint32_t target,
+                                      const uint8_t *data,
+                                      uint16_t len,
+                                      gatt_client_queue_callback_t callback,
+                                      void *context)
+{
+  connection_t *c = find_connection(connection);
+  request_t *r;
+  uint8_t index;
+  uint8_t leader = NO_REQUEST;
+
+  if (op > GATT_CLIENT_QUEUE_SET_NOTIFICATION
+      || priority > GATT_CLIENT_QUEUE_PRIORITY_HIGH
+      || (op == GATT_CLIENT_QUEUE_SET_NOTIFICATION && (data == NULL || len == 0))
+      || (op == GATT_CLIENT_QUEUE_WRITE && data == NULL && len != 0)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  // A connection opened before the queue was initialized
+  if (c == NULL) {
+    c = open_connection(connection);
+    if (c == NULL) {
+      return SL_STATUS_NO_MORE_RESOURCE;
+    }
+  }
+  if (c->closing) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  index = find_free_request(c);
+  if (index == NO_REQUEST) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  if (op == GATT_CLIENT_QUEUE_READ) {
+    leader = find_pending_read(c, target);
+    if (leader != NO_REQUEST) {
+      if (priority > c->requests[leader].priority) {
+        c->requests[leader].priority = priority;
+      }
+      c->stats.coalesced++;
+    }
+  }
+
+  r = &c->requests[index];
+  r->used = true;
+  r->op = op;
+  r->priority = priority;
+  r->target = target;
+  r->data = data;
+  r->len = len;
+  r->callback = callback;
+  r->context = context;
+  r->seq = c->next_seq++;
+  r->leader = leader;
+  r->enqueue_tick = sl_sleeptimer_get_tick_count64();
+
+  c->stats.enqueued++;
+  c->stats.depth++;
+  if (c->stats.depth > c->stats.max_depth) {
+    c->stats.max_depth = c->stats.depth;
+  }
+  dispatch(c);
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_client_queue_read(uint8_t connection,
+                                   uint16_t characteristic,
+                                   gatt_client_queue_priority_t priority,
+                                   gatt_client_queue_callback_t callback,
+                                   void *context)
+{
+  return gatt_client_queue_enqueue(connection, GATT_CLIENT_QUEUE_READ, priority,
+                                   characteristic, NULL, 0, callback, context);
+}
+
+sl_status_t gatt_client_queue_write(uint8_t connection,
+                                    uint16_t characteristic,
+                                    const uint8_t *data,
+                                    uint16_t len,
+                                    gatt_client_queue_priority_t priority,
+                                    gatt_client_queue_callback_t callback,
+                                    void *context)
+{
+  return gatt_client_queue_enqueue(connection, GATT_CLIENT_QUEUE_WRITE, priority,
+                                   characteristic, data, len, callback, context);
+}
+
+sl_status_t gatt_client_queue_set_notification(uint8_t connection,
+                                               uint16_t characteristic,
+                                               sl_bt_gatt_client_config_flag_t flags,
+                                               gatt_client_queue_priority_t priority,
+                                               gatt_client_queue_callback_t callback,
+                                               void *context)
+{
+  // Copied into the request, which does not copy its data
+  static const uint8_t flag_values[] = { sl_bt_gatt_disable, sl_bt_gatt_notification, sl_bt_gatt_indication };
+
+  if ((uint32_t)flags >= sizeof(flag_values)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  return gatt_client_queue_enqueue(connection, GATT_CLIENT_QUEUE_SET_NOTIFICATION, priority,
+                                   characteristic, &flag_values[flags], 1, callback, context);
+}
+
+void gatt_client_queue_flush(uint8_t connection)
+{
+  connection_t *c = find_connection(connection);
+
+  if (c == NULL) {
+    return;
+  }
+  for (uint8_t i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    request_t *r = &c->requests[i];
+
+    if (r->used && i != c->running
+        && (r->leader == NO_REQUEST || r->leader != c->running)) {
+      r->used = false;
+      c->stats.depth--;
+    }
+  }
+}
+
+sl_status_t gatt_client_queue_get_stats(uint8_t connection,
+                                        gatt_client_queue_stats_t *stats)
+{
+  connection_t *c = find_connection(connection);
+
+  if (c == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  *stats = c->stats;
+  return SL_STATUS_OK;
+}
+
+// Running request of a connection, if it is of the given procedure
+static request_t *running_request(connection_t *c, gatt_client_queue_op_t op)
+{
+  if (c == NULL || c->running == NO_REQUEST || c->requests[c->running].op != op) {
+    return NULL;
+  }
+  return &c->requests[c->running];
+}
+
+static void on_value(sl_bt_evt_gatt_characteristic_value_t *value)
+{
+  connection_t *c = find_connection(value->connection);
+  request_t *r = running_request(c, GATT_CLIENT_QUEUE_READ);
+  uint16_t len = value->value.len;
+
+  if (r == NULL || value->characteristic != r->target
+      || (value->att_opcode != sl_bt_gatt_read_response
+          && value->att_opcode != sl_bt_gatt_read_blob_response)) {
+    return;
+  }
+  // The rest of a longer value is dropped
+  if (value->offset >= GATT_CLIENT_QUEUE_MAX_VALUE_LEN) {
+    return;
+  }
+  if (len > GATT_CLIENT_QUEUE_MAX_VALUE_LEN - value->offset) {
+    len = GATT_CLIENT_QUEUE_MAX_VALUE_LEN - value->offset;
+  }
+  memcpy(&c->value[value->offset], value->value.data, len);
+  if (value->offset + len > c->value_len) {
+    c->value_len = value->offset + len;
+  }
+}
+
+static void on_discovered(uint8_t connection, gatt_client_queue_op_t op, sl_bt_msg_t *evt)
+{
+  connection_t *c = find_connection(connection);
+  request_t *r = running_request(c, op);
+
+  if (r != NULL) {
+    call(c, r, SL_STATUS_OK, evt);
+  }
+}
+
+void sli_gatt_client_queue_on_event(sl_bt_msg_t *evt)
+{
+  connection_t *c;
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_connection_opened_id:
+      c = find_connection(evt->data.evt_connection_opened.connection);
+      if (c == NULL) {
+        (void)open_connection(evt->data.evt_connection_opened.connection);
+      }
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      c = find_connection(evt->data.evt_connection_closed.connection);
+      if (c == NULL) {
+        break;
+      }
+      // The running request first, then the waiting ones in their order
+      c->closing = true;
+      if (c->running != NO_REQUEST) {
+        complete(c, c->running, evt->data.evt_connection_closed.reason);
+      }
+      for (uint8_t next = find_next_request(c); next != NO_REQUEST; next = find_next_request(c)) {
+        complete(c, next, evt->data.evt_connection_closed.reason);
+      }
+      c->used = false;
+      break;
+
+    case sl_bt_evt_gatt_characteristic_value_id:
+      on_value(&evt->data.evt_gatt_characteristic_value);
+      break;
+
+    case sl_bt_evt_gatt_service_id:
+      on_discovered(evt->data.evt_gatt_service.connection,
+                    GATT_CLIENT_QUEUE_DISCOVER_SERVICES, evt);
+      break;
+
+    case sl_bt_evt_gatt_characteristic_id:
+      on_discovered(evt->data.evt_gatt_characteristic.connection,
+                    GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS, evt);
+      break;
+
+    case sl_bt_evt_gatt_descriptor_id:
+      on_discovered(evt->data.evt_gatt_descriptor.connection,
+                    GATT_CLIENT_QUEUE_DISCOVER_DESCRIPTORS, evt);
+      break;
+
+    case sl_bt_evt_gatt_procedure_completed_id:
+      c = find_connection(evt->data.evt_gatt_procedure_completed.connection);
+      if (c != NULL && c->running != NO_REQUEST) {
+        complete(c, c->running, evt->data.evt_gatt_procedure_completed.result);
+        dispatch(c);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
@@ -0,0 +1,716 @@
+/***************************************************************************//**
+ * @file gatt_client_queue_test.c
+ * @brief Host test of the GATT Client Procedure Queue.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Feeds gatt_client_queue.c with a mocked stream of stack events: procedure
+ * completions, values, discovered attributes and closed connections. The
+ * stack commands are replaced by the functions below, which fail the test
+ * if a procedure is started while another one runs on the connection.
+ * Scenarios check the priorities, coalesced reads, discoveries, refused
+ * procedures, closes, flushes and statistics, then a long random stream on
+ * several connections is compared with a reference model of the queue.
+ * Build and run on a PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I. -I../inc gatt_client_queue_test.c ../src/gatt_client_queue.c -o gatt_client_queue_test
+ *   ./gatt_client_queue_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gatt_client_queue.h"
+
+#define MAX_CALLS         64
+#define RANDOM_STEPS      200000
+#define RANDOM_TARGETS    4     // Few, so that reads are often coalesced
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+// ---------------------------------------------------------------------------
+// Stack
+
+typedef struct {
+  gatt_client_queue_op_t op;
+  uint32_t target;
+  uint8_t flags;            // Of a notification
+} procedure_t;
+
+static uint64_t now_ms;
+static bool running[256];           // Procedure running on a connection
+static procedure_t started[256];    // Last procedure started on a connection
+static unsigned starts;
+static unsigned violations;         // Procedures started while one was running
+static sl_status_t refuse = SL_STATUS_OK;  // Error of the next command
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  return now_ms;
+}
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms)
+{
+  *ms = tick;
+  return SL_STATUS_OK;
+}
+
+static sl_status_t start(uint8_t connection, gatt_client_queue_op_t op,
+                         uint32_t target, uint8_t flags)
+{
+  sl_status_t sc = refuse;
+
+  if (sc != SL_STATUS_OK) {
+    refuse = SL_STATUS_OK;
+    return sc;
+  }
+  if (running[connection]) {
+    violations++;
+    return SL_STATUS_INVALID_STATE;
+  }
+  running[connection] = true;
+  started[connection].op = op;
+  started[connection].target = target;
+  started[connection].flags = flags;
+  starts++;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_read_characteristic_value(uint8_t connection,
+                                                 uint16_t characteristic)
+{
+  return start(connection, GATT_CLIENT_QUEUE_READ, characteristic, 0);
+}
+
+sl_status_t sl_bt_gatt_write_characteristic_value(uint8_t connection,
+                                                  uint16_t characteristic,
+                                                  size_t value_len,
+                                                  const uint8_t *value)
+{
+  (void)value_len;
+  (void)value;
+  return start(connection, GATT_CLIENT_QUEUE_WRITE, characteristic, 0);
+}
+
+sl_status_t sl_bt_gatt_discover_primary_services(uint8_t connection)
+{
+  return start(connection, GATT_CLIENT_QUEUE_DISCOVER_SERVICES, 0, 0);
+}
+
+sl_status_t sl_bt_gatt_discover_characteristics(uint8_t connection,
+                                                uint32_t service)
+{
+  return start(connection, GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS, service, 0);
+}
+
+sl_status_t sl_bt_gatt_discover_descriptors(uint8_t connection,
+                                            uint16_t characteristic)
+{
+  return start(connection, GATT_CLIENT_QUEUE_DISCOVER_DESCRIPTORS, characteristic, 0);
+}
+
+sl_status_t sl_bt_gatt_set_characteristic_notification(uint8_t connection,
+                                                       uint16_t characteristic,
+                                                       uint8_t flags)
+{
+  return start(connection, GATT_CLIENT_QUEUE_SET_NOTIFICATION, characteristic, flags);
+}
+
+// ---------------------------------------------------------------------------
+// Events
+
+static sl_bt_msg_t evt;
+
+static void open_connection(uint8_t connection)
+{
+  evt.header = sl_bt_evt_connection_opened_id;
+  evt.data.evt_connection_opened.connection = connection;
+  sli_gatt_client_queue_on_event(&evt);
+}
+
+static void close_connection(uint8_t connection, uint16_t reason)
+{
+  running[connection] = false;
+  evt.header = sl_bt_evt_connection_closed_id;
+  evt.data.evt_connection_closed.connection = connection;
+  evt.data.evt_connection_closed.reason = reason;
+  sli_gatt_client_queue_on_event(&evt);
+}
+
+static void complete(uint8_t connection, uint16_t result)
+{
+  running[connection] = false;
+  evt.header = sl_bt_evt_gatt_procedure_completed_id;
+  evt.data.evt_gatt_procedure_completed.connection = connection;
+  evt.data.evt_gatt_procedure_completed.result = result;
+  sli_gatt_client_queue_on_event(&evt);
+}
+
+static void value(uint8_t connection, uint16_t characteristic, uint8_t opcode,
+                  uint16_t offset, const uint8_t *data, uint8_t len)
+{
+  evt.header = sl_bt_evt_gatt_characteristic_value_id;
+  evt.data.evt_gatt_characteristic_value.connection = connection;
+  evt.data.evt_gatt_characteristic_value.characteristic = characteristic;
+  evt.data.evt_gatt_characteristic_value.att_opcode = opcode;
+  evt.data.evt_gatt_characteristic_value.offset = offset;
+  evt.data.evt_gatt_characteristic_value.value.len = len;
+  memcpy(evt.data.evt_gatt_characteristic_value.value.data, data, len);
+  sli_gatt_client_queue_on_event(&evt);
+}
+
+static void service(uint8_t connection, uint32_t handle)
+{
+  evt.header = sl_bt_evt_gatt_service_id;
+  evt.data.evt_gatt_service.connection = connection;
+  evt.data.evt_gatt_service.service = handle;
+  evt.data.evt_gatt_service.uuid.len = 2;
+  sli_gatt_client_queue_on_event(&evt);
+}
+
+// ---------------------------------------------------------------------------
+// Callbacks
+
+typedef struct {
+  intptr_t id;              // Context of the request
+  sl_status_t status;
+  bool attribute;           // Called for a discovered attribute
+  uint32_t service;         // Of the attribute
+  uint16_t len;
+  uint8_t value[GATT_CLIENT_QUEUE_MAX_VALUE_LEN];
+  uint32_t latency_ms;
+} call_t;
+
+static call_t calls[MAX_CALLS];
+static unsigned call_count;
+static sl_status_t reenqueue_status;  // Of an enqueue made from a callback
+static bool reenqueue = false;
+
+static void on_result(const gatt_client_queue_result_t *result, void *context)
+{
+  call_t *c = &calls[call_count % MAX_CALLS];
+
+  call_count++;
+  memset(c, 0, sizeof(*c));
+  c->id = (intptr_t)context;
+  c->status = result->status;
+  c->attribute = (result->evt != NULL);
+  if (c->attribute) {
+    c->service = result->evt->data.evt_gatt_service.service;
+  }
+  c->len = result->len;
+  if (result->value != NULL) {
+    memcpy(c->value, result->value, result->len);
+  }
+  c->latency_ms = result->latency_ms;
+  if (reenqueue) {
+    reenqueue_status = gatt_client_queue_read(result->connection, 0x99,
+                                              GATT_CLIENT_QUEUE_PRIORITY_NORMAL,
+                                              NULL, NULL);
+  }
+}
+
+static void reset(void)
+{
+  sli_gatt_client_queue_init();
+  memset(running, 0, sizeof(running));
+  call_count = 0;
+  starts = 0;
+  violations = 0;
+  refuse = SL_STATUS_OK;
+  reenqueue = false;
+}
+
+#define ID(n)  ((void *)(intptr_t)(n))
+
+// ---------------------------------------------------------------------------
+// Scenarios
+
+// Higher priorities first, the same priority in the order of enqueueing
+static void test_priorities(void)
+{
+  static const uint8_t data[2] = { 1, 2 };
+  static const struct {
+    uint32_t target;
+    intptr_t id;
+  } expected[] = { { 0x10, 1 }, { 0x14, 4 }, { 0x12, 3 }, { 0x15, 5 }, { 0x11, 2 } };
+
+  reset();
+  open_connection(1);
+  CHECK(gatt_client_queue_write(1, 0x10, data, 2, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(1)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(1, 0x11, GATT_CLIENT_QUEUE_PRIORITY_LOW, on_result, ID(2)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_write(1, 0x12, data, 2, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(3)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(1, 0x14, GATT_CLIENT_QUEUE_PRIORITY_HIGH, on_result, ID(4)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_set_notification(1, 0x15, sl_bt_gatt_indication,
+                                           GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(5)) == SL_STATUS_OK);
+  CHECK(starts == 1);
+  for (unsigned i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+    CHECK(started[1].target == expected[i].target);
+    complete(1, SL_STATUS_OK);
+    CHECK(call_count == i + 1 && calls[i].id == expected[i].id && calls[i].status == SL_STATUS_OK);
+  }
+  CHECK(starts == 5);
+  CHECK(violations == 0);
+}
+
+// Reads of the same characteristic share a procedure, and the value
+static void test_coalescing(void)
+{
+  static const uint8_t data[1] = { 0 };
+  uint8_t part[200];
+  gatt_client_queue_stats_t stats;
+
+  reset();
+  open_connection(1);
+  for (unsigned i = 0; i < sizeof(part); i++) {
+    part[i] = (uint8_t)i;
+  }
+  CHECK(gatt_client_queue_write(1, 0x10, data, 1, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(1)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(1, 0x20, GATT_CLIENT_QUEUE_PRIORITY_LOW, on_result, ID(2)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(1, 0x21, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(3)) == SL_STATUS_OK);
+  // Joins the low priority read, and raises it above the other one
+  CHECK(gatt_client_queue_read(1, 0x20, GATT_CLIENT_QUEUE_PRIORITY_HIGH, on_result, ID(4)) == SL_STATUS_OK);
+  complete(1, SL_STATUS_OK);
+  CHECK(started[1].op == GATT_CLIENT_QUEUE_READ && started[1].target == 0x20);
+
+  // A read of a characteristic being read waits for a new procedure
+  CHECK(gatt_client_queue_read(1, 0x20, GATT_CLIENT_QUEUE_PRIORITY_HIGH, on_result, ID(5)) == SL_STATUS_OK);
+
+  // 300 bytes in two parts, with a notification of the same characteristic
+  // in between, longer than the queue keeps
+  value(1, 0x20, sl_bt_gatt_read_response, 0, part, 200);
+  value(1, 0x20, sl_bt_gatt_handle_value_notification, 0, part + 50, 10);
+  value(1, 0x20, sl_bt_gatt_read_blob_response, 200, part, 100);
+  complete(1, SL_STATUS_OK);
+  CHECK(call_count == 3);
+  CHECK(calls[1].id == 2 && calls[2].id == 4);
+  for (unsigned i = 1; i <= 2; i++) {
+    CHECK(calls[i].len == GATT_CLIENT_QUEUE_MAX_VALUE_LEN);
+    CHECK(memcmp(calls[i].value, part, 200) == 0);
+    CHECK(memcmp(&calls[i].value[200], part, GATT_CLIENT_QUEUE_MAX_VALUE_LEN - 200) == 0);
+  }
+  CHECK(started[1].target == 0x20);
+  value(1, 0x20, sl_bt_gatt_read_response, 0, part + 7, 3);
+  complete(1, SL_STATUS_OK);
+  CHECK(call_count == 4 && calls[3].id == 5 && calls[3].len == 3 && calls[3].value[0] == 7);
+  CHECK(started[1].target == 0x21);
+  complete(1, SL_STATUS_OK);
+  CHECK(call_count == 5 && calls[4].id == 3 && calls[4].len == 0);
+
+  CHECK(gatt_client_queue_get_stats(1, &stats) == SL_STATUS_OK);
+  CHECK(stats.enqueued == 5 && stats.coalesced == 1 && stats.procedures == 4);
+  CHECK(stats.completed == 5 && stats.failed == 0 && stats.depth == 0 && stats.max_depth == 4);
+  CHECK(violations == 0);
+}
+
+// Attributes are passed one by one, then the end of the discovery
+static void test_discovery(void)
+{
+  reset();
+  open_connection(1);
+  open_connection(2);
+  CHECK(gatt_client_queue_enqueue(1, GATT_CLIENT_QUEUE_DISCOVER_SERVICES, GATT_CLIENT_QUEUE_PRIORITY_NORMAL,
+                                  0, NULL, 0, on_result, ID(1)) == SL_STATUS_OK);
+  service(1, 0x00010005);
+  service(2, 0x00060009);   // Another connection
+  service(1, 0x000A0010);
+  complete(1, SL_STATUS_OK);
+  CHECK(call_count == 3);
+  CHECK(calls[0].attribute && calls[0].service == 0x00010005);
+  CHECK(calls[1].attribute && calls[1].service == 0x000A0010);
+  CHECK(!calls[2].attribute && calls[2].status == SL_STATUS_OK);
+
+  CHECK(gatt_client_queue_enqueue(1, GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS, GATT_CLIENT_QUEUE_PRIORITY_NORMAL,
+                                  0x000A0010, NULL, 0, on_result, ID(2)) == SL_STATUS_OK);
+  CHECK(started[1].op == GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS && started[1].target == 0x000A0010);
+  complete(1, 0x0401);
+  CHECK(call_count == 4 && calls[3].status == 0x0401);
+}
+
+// A procedure the stack refuses ends at once, and the next one is started
+static void test_refused(void)
+{
+  static const uint8_t data[1] = { 0 };
+
+  reset();
+  open_connection(1);
+  refuse = SL_STATUS_NO_MORE_RESOURCE;
+  CHECK(gatt_client_queue_read(1, 0x20, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(1)) == SL_STATUS_OK);
+  CHECK(call_count == 1 && calls[0].status == SL_STATUS_NO_MORE_RESOURCE);
+
+  CHECK(gatt_client_queue_read(1, 0x20, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(2)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_write(1, 0x21, data, 1, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(3)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_write(1, 0x22, data, 1, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(4)) == SL_STATUS_OK);
+  refuse = SL_STATUS_FAIL;
+  complete(1, SL_STATUS_OK);
+  CHECK(call_count == 3 && calls[1].id == 2 && calls[2].id == 3 && calls[2].status == SL_STATUS_FAIL);
+  CHECK(running[1] && started[1].target == 0x22);
+
+  // Invalid requests
+  CHECK(gatt_client_queue_enqueue(1, GATT_CLIENT_QUEUE_SET_NOTIFICATION, GATT_CLIENT_QUEUE_PRIORITY_NORMAL,
+                                  0x20, NULL, 0, on_result, NULL) == SL_STATUS_INVALID_PARAMETER);
+  CHECK(gatt_client_queue_set_notification(1, 0x20, (sl_bt_gatt_client_config_flag_t)3,
+                                           GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, NULL) == SL_STATUS_INVALID_PARAMETER);
+  CHECK(gatt_client_queue_write(1, 0x20, NULL, 1, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, NULL) == SL_STATUS_INVALID_PARAMETER);
+  CHECK(violations == 0);
+}
+
+// A close ends the running request, then the waiting ones in their order,
+// and refuses new ones meanwhile
+static void test_close(void)
+{
+  gatt_client_queue_stats_t stats;
+
+  reset();
+  open_connection(3);
+  CHECK(gatt_client_queue_read(3, 0x20, GATT_CLIENT_QUEUE_PRIORITY_LOW, on_result, ID(1)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(3, 0x21, GATT_CLIENT_QUEUE_PRIORITY_LOW, on_result, ID(2)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(3, 0x22, GATT_CLIENT_QUEUE_PRIORITY_HIGH, on_result, ID(3)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(3, 0x21, GATT_CLIENT_QUEUE_PRIORITY_LOW, on_result, ID(4)) == SL_STATUS_OK);
+  reenqueue = true;
+  close_connection(3, 0x0213);
+  reenqueue = false;
+  CHECK(call_count == 4);
+  CHECK(calls[0].id == 1 && calls[1].id == 3 && calls[2].id == 2 && calls[3].id == 4);
+  for (unsigned i = 0; i < 4; i++) {
+    CHECK(calls[i].status == 0x0213);
+  }
+  CHECK(reenqueue_status == SL_STATUS_INVALID_STATE);
+  CHECK(gatt_client_queue_get_stats(3, &stats) == SL_STATUS_NOT_FOUND);
+
+  // The handle can be reused
+  open_connection(3);
+  CHECK(gatt_client_queue_read(3, 0x20, GATT_CLIENT_QUEUE_PRIORITY_LOW, on_result, ID(5)) == SL_STATUS_OK);
+  CHECK(running[3]);
+  CHECK(violations == 0);
+}
+
+// Callbacks can enqueue the next request, even into a full queue
+static void test_callback_enqueue(void)
+{
+  gatt_client_queue_stats_t stats;
+
+  reset();
+  open_connection(1);
+  for (unsigned i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    CHECK(gatt_client_queue_read(1, (uint16_t)(0x20 + i), GATT_CLIENT_QUEUE_PRIORITY_NORMAL,
+                                 on_result, ID(i)) == SL_STATUS_OK);
+  }
+  CHECK(gatt_client_queue_read(1, 0x40, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, NULL)
+        == SL_STATUS_NO_MORE_RESOURCE);
+  reenqueue = true;
+  complete(1, SL_STATUS_OK);
+  reenqueue = false;
+  CHECK(reenqueue_status == SL_STATUS_OK);
+  CHECK(gatt_client_queue_get_stats(1, &stats) == SL_STATUS_OK);
+  CHECK(stats.depth == GATT_CLIENT_QUEUE_DEPTH && stats.max_depth == GATT_CLIENT_QUEUE_DEPTH);
+
+  // All queues taken
+  reset();
+  for (unsigned i = 0; i < GATT_CLIENT_QUEUE_MAX_CONNECTIONS; i++) {
+    open_connection((uint8_t)(10 + i));
+  }
+  CHECK(gatt_client_queue_read(50, 0x20, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, NULL)
+        == SL_STATUS_NO_MORE_RESOURCE);
+}
+
+// A flush drops the waiting requests silently, the running one still ends
+static void test_flush(void)
+{
+  gatt_client_queue_stats_t stats;
+
+  reset();
+  open_connection(1);
+  CHECK(gatt_client_queue_read(1, 0x20, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(1)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(1, 0x21, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(2)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(1, 0x21, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(3)) == SL_STATUS_OK);
+  gatt_client_queue_flush(1);
+  complete(1, SL_STATUS_OK);
+  CHECK(call_count == 1 && calls[0].id == 1);
+  CHECK(!running[1]);
+  CHECK(gatt_client_queue_get_stats(1, &stats) == SL_STATUS_OK && stats.depth == 0);
+}
+
+// Latency from the enqueueing to the end
+static void test_latency(void)
+{
+  gatt_client_queue_stats_t stats;
+
+  reset();
+  open_connection(1);
+  now_ms = 1000;
+  CHECK(gatt_client_queue_read(1, 0x20, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(1)) == SL_STATUS_OK);
+  CHECK(gatt_client_queue_read(1, 0x21, GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_result, ID(2)) == SL_STATUS_OK);
+  now_ms += 30;
+  complete(1, SL_STATUS_OK);
+  now_ms += 45;
+  complete(1, SL_STATUS_OK);
+  CHECK(calls[0].latency_ms == 30 && calls[1].latency_ms == 75);
+  CHECK(gatt_client_queue_get_stats(1, &stats) == SL_STATUS_OK);
+  CHECK(stats.total_latency_ms == 105 && stats.max_latency_ms == 75);
+}
+
+// ---------------------------------------------------------------------------
+// Random stream against a reference model
+
+#define MODEL_CONNECTIONS  GATT_CLIENT_QUEUE_MAX_CONNECTIONS
+
+typedef struct {
+  bool used;
+  gatt_client_queue_op_t op;
+  gatt_client_queue_priority_t priority;
+  uint32_t target;
+  uint32_t seq;
+  int leader;               // Index of the read it is coalesced with, -1 if none
+  unsigned id;
+} model_request_t;
+
+static struct {
+  model_request_t requests[GATT_CLIENT_QUEUE_DEPTH];
+  int running;
+  uint32_t seq;
+  unsigned ended;           // Requests whose callback was called
+} model[MODEL_CONNECTIONS];
+
+static unsigned random_calls[RANDOM_STEPS + GATT_CLIENT_QUEUE_DEPTH];
+static unsigned random_call_count;
+static sl_status_t random_status;
+
+static void on_random_result(const gatt_client_queue_result_t *result, void *context)
+{
+  if (result->evt == NULL) {
+    random_calls[random_call_count++] = (unsigned)(intptr_t)context;
+    if (result->status != random_status) {
+      failures++;
+    }
+  }
+}
+
+static int model_next(unsigned m)
+{
+  int next = -1;
+
+  for (int i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    model_request_t *r = &model[m].requests[i];
+
+    if (!r->used || r->leader >= 0) {
+      continue;
+    }
+    if (next < 0 || r->priority > model[m].requests[next].priority
+        || (r->priority == model[m].requests[next].priority
+            && r->seq < model[m].requests[next].seq)) {
+      next = i;
+    }
+  }
+  return next;
+}
+
+// End a request of the model and the reads coalesced with it. Returns how
+// many there were, or -1 if one of them got no callback since first_call.
+static int model_end(unsigned m, int index, unsigned first_call)
+{
+  int ended = 0;
+
+  for (int i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+    model_request_t *r = &model[m].requests[i];
+
+    if (r->used && (i == index || r->leader == index)) {
+      bool found = false;
+
+      for (unsigned c = first_call; c < random_call_count; c++) {
+        found |= (random_calls[c] == r->id);
+      }
+      if (!found) {
+        return -1;
+      }
+      r->used = false;
+      ended++;
+    }
+  }
+  if (model[m].running == index) {
+    model[m].running = -1;
+  }
+  return ended;
+}
+
+// Start the next request of the model as the queue should, and compare
+static bool model_dispatch(unsigned m, uint8_t connection)
+{
+  if (model[m].running >= 0) {
+    return true;
+  }
+  model[m].running = model_next(m);
+  if (model[m].running < 0) {
+    return !running[connection];
+  }
+  return running[connection]
+         && started[connection].op == model[m].requests[model[m].running].op
+         && started[connection].target == model[m].requests[model[m].running].target;
+}
+
+static void test_random(void)
+{
+  static const uint8_t data[1] = { 0 };
+  unsigned id = 0;
+  unsigned enqueued = 0;
+  unsigned coalesced = 0;
+  unsigned mismatches = 0;
+
+  reset();
+  srand(1);
+  memset(model, 0, sizeof(model));
+  for (unsigned m = 0; m < MODEL_CONNECTIONS; m++) {
+    model[m].running = -1;
+    open_connection((uint8_t)(m + 1));
+  }
+
+  for (unsigned step = 0; step < RANDOM_STEPS; step++) {
+    unsigned m = (unsigned)rand() % MODEL_CONNECTIONS;
+    uint8_t connection = (uint8_t)(m + 1);
+    unsigned action = (unsigned)rand() % 100;
+    unsigned first_call = random_call_count;
+
+    if (action < 55) {
+      // Enqueue
+      gatt_client_queue_op_t op = (gatt_client_queue_op_t)((unsigned)rand() % 3);
+      gatt_client_queue_priority_t priority = (gatt_client_queue_priority_t)((unsigned)rand() % 3);
+      uint32_t target = 0x20 + (unsigned)rand() % RANDOM_TARGETS;
+      int free_index = -1;
+      int leader = -1;
+      sl_status_t sc;
+
+      if (op == GATT_CLIENT_QUEUE_DISCOVER_SERVICES) {
+        target = 0;
+      }
+      for (int i = GATT_CLIENT_QUEUE_DEPTH - 1; i >= 0; i--) {
+        model_request_t *r = &model[m].requests[i];
+
+        if (!r->used) {
+          free_index = i;
+        } else if (op == GATT_CLIENT_QUEUE_READ && r->op == GATT_CLIENT_QUEUE_READ
+                   && r->target == target && r->leader < 0 && i != model[m].running) {
+          leader = i;
+        }
+      }
+      id++;
+      sc = gatt_client_queue_enqueue(connection, op, priority, target, data, 1,
+                                     on_random_result, ID(id));
+      if (free_index < 0) {
+        mismatches += (sc != SL_STATUS_NO_MORE_RESOURCE);
+        continue;
+      }
+      if (sc != SL_STATUS_OK) {
+        mismatches++;
+        continue;
+      }
+      enqueued++;
+      if (leader >= 0) {
+        coalesced++;
+        if (priority > model[m].requests[leader].priority) {
+          model[m].requests[leader].priority = priority;
+        }
+      }
+      model[m].requests[free_index] = (model_request_t){
+        true, op, priority, target, model[m].seq++, leader, id
+      };
+      mismatches += !model_dispatch(m, connection);
+    } else if (action < 95) {
+      // Complete the running procedure
+      if (model[m].running < 0) {
+        continue;
+      }
+      random_status = ((unsigned)rand() % 8 == 0) ? 0x0401 : SL_STATUS_OK;
+      complete(connection, (uint16_t)random_status);
+      mismatches += (model_end(m, model[m].running, first_call)
+                     != (int)(random_call_count - first_call));
+      mismatches += !model_dispatch(m, connection);
+    } else if (action < 98) {
+      // Flush the waiting requests
+      gatt_client_queue_flush(connection);
+      for (int i = 0; i < GATT_CLIENT_QUEUE_DEPTH; i++) {
+        model_request_t *r = &model[m].requests[i];
+
+        if (r->used && i != model[m].running && r->leader != model[m].running) {
+          r->used = false;
+        }
+      }
+    } else {
+      int ended = 0;
+
+      // Close and open again
+      random_status = 0x0208;
+      close_connection(connection, (uint16_t)random_status);
+      for (int next = (model[m].running >= 0) ? model[m].running : model_next(m);
+           next >= 0 && ended >= 0;
+           next = model_next(m)) {
+        int group = model_end(m, next, first_call);
+
+        ended = (group < 0) ? -1 : ended + group;
+      }
+      mismatches += (ended != (int)(random_call_count - first_call));
+      open_connection(connection);
+    }
+    if (random_call_count > RANDOM_STEPS) {
+      random_call_count = 0;
+    }
+  }
+  CHECK(mismatches == 0);
+  CHECK(violations == 0);
+  printf("%u random steps on %u connections: %u requests, %u coalesced reads, %u procedures\n",
+         RANDOM_STEPS, MODEL_CONNECTIONS, enqueued, coalesced, starts);
+}
+
+int main(void)
+{
+  test_priorities();
+  test_coalescing();
+  test_discovery();
+  test_refused();
+  test_close();
+  test_callback_enqueue();
+  test_flush();
+  test_latency();
+  test_random();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
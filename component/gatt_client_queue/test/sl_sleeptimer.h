@@ -0,0 +1,44 @@
+/***************************************************************************//**
+ * @file sl_sleeptimer.h
+ * @brief Host stand-in for the sleeptimer of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only what gatt_client_queue.c uses, so it builds on a PC without the
+ * Simplicity SDK. The functions are implemented by the test. */
+
+#ifndef SL_SLEEPTIMER_H
+#define SL_SLEEPTIMER_H
+
+#include <stdint.h>
+#include "sl_bluetooth.h"
+
+uint64_t sl_sleeptimer_get_tick_count64(void);
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms);
+
+#endif // SL_SLEEPTIMER_H
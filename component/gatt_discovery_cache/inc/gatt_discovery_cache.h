@@ -0,0 +1,275 @@
+/***************************************************************************//**
+ * @file gatt_discovery_cache.h
+ * @brief GATT discovery and handle map cache of GATT servers.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef GATT_DISCOVERY_CACHE_H
+#define GATT_DISCOVERY_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Capacity of a handle map.
+#ifndef GATT_DISCOVERY_CACHE_MAX_SERVICES
+#define GATT_DISCOVERY_CACHE_MAX_SERVICES         8
+#endif
+#ifndef GATT_DISCOVERY_CACHE_MAX_CHARACTERISTICS
+#define GATT_DISCOVERY_CACHE_MAX_CHARACTERISTICS  16
+#endif
+#ifndef GATT_DISCOVERY_CACHE_MAX_DESCRIPTORS
+#define GATT_DISCOVERY_CACHE_MAX_DESCRIPTORS      16
+#endif
+
+// Number of handle maps kept in NVM3, across all peers. The least recently
+// used one is replaced when a new database is discovered.
+#ifndef GATT_DISCOVERY_CACHE_MAX_ENTRIES
+#define GATT_DISCOVERY_CACHE_MAX_ENTRIES          8
+#endif
+
+// First NVM3 key of the cache. Each entry uses
+// GATT_DISCOVERY_CACHE_NVM3_KEYS_PER_ENTRY consecutive keys.
+#ifndef GATT_DISCOVERY_CACHE_NVM3_KEY_BASE
+#define GATT_DISCOVERY_CACHE_NVM3_KEY_BASE        0x1000
+#endif
+#define GATT_DISCOVERY_CACHE_NVM3_KEYS_PER_ENTRY  0x10
+
+// Handle maps are stored in chunks no larger than the NVM3 object size.
+#ifndef GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE
+#define GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE      240
+#endif
+
+#define GATT_DISCOVERY_CACHE_HASH_LEN             16
+
+/***************************************************************************//**
+ * @brief 16-bit or 128-bit UUID, little endian as in the stack events
+ ******************************************************************************/
+typedef struct {
+  uint8_t len;
+  uint8_t data[16];
+} gatt_discovery_cache_uuid_t;
+
+typedef struct {
+  uint16_t start;           // Handle of the service declaration
+  uint16_t end;             // Last handle of the service
+  gatt_discovery_cache_uuid_t uuid;
+} gatt_discovery_cache_service_t;
+
+typedef struct {
+  uint16_t handle;          // Value handle
+  uint8_t properties;
+  uint8_t service;          // Index in services
+  gatt_discovery_cache_uuid_t uuid;
+} gatt_discovery_cache_characteristic_t;
+
+typedef struct {
+  uint16_t handle;
+  uint8_t characteristic;   // Index in characteristics
+  gatt_discovery_cache_uuid_t uuid;
+} gatt_discovery_cache_descriptor_t;
+
+/***************************************************************************//**
+ * @brief Handle map of a remote GATT database
+ ******************************************************************************/
+typedef struct {
+  uint8_t service_count;
+  uint8_t characteristic_count;
+  uint8_t descriptor_count;
+  gatt_discovery_cache_service_t services[GATT_DISCOVERY_CACHE_MAX_SERVICES];
+  gatt_discovery_cache_characteristic_t characteristics[GATT_DISCOVERY_CACHE_MAX_CHARACTERISTICS];
+  gatt_discovery_cache_descriptor_t descriptors[GATT_DISCOVERY_CACHE_MAX_DESCRIPTORS];
+} gatt_discovery_cache_map_t;
+
+/***************************************************************************//**
+ * @brief Called when a discovery started with gatt_discovery_cache_discover()
+ *        or gatt_discovery_cache_rediscover() ends
+ *
+ * @param[in] connection Connection handle
+ * @param[in] result SL_STATUS_OK, SL_STATUS_WOULD_OVERFLOW if the database
+ *            did not fit in the map, or the result of the failed procedure
+ ******************************************************************************/
+typedef void (*gatt_discovery_cache_callback_t)(uint8_t connection,
+                                                sl_status_t result);
+
+/***************************************************************************//**
+ * @brief Cache statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;       // Entries replaced by another database
+  uint32_t discoveries;     // Completed full discoveries
+  uint32_t rediscoveries;   // Completed rediscoveries of a handle range
+  uint32_t procedures;      // GATT procedures run by the discoveries
+  uint32_t nvm_errors;
+} gatt_discovery_cache_stats_t;
+
+/***************************************************************************//**
+ *
+ * Load the index of the cache from NVM3. Must be called after NVM3 is
+ * initialized.
+ *
+ ******************************************************************************/
+void gatt_discovery_cache_init(void);
+
+/***************************************************************************//**
+ *
+ * Look up the handle map of a database a peer was seen with.
+ *
+ * A server with GATT caching is identified by its Database Hash, and can have
+ * a map for each version of its database. A bonded server reports its changes
+ * with Service Changed indications instead: it has a single map, looked up
+ * and stored with a NULL @p hash.
+ *
+ * @param[in] peer Identity of the peer
+ * @param[in] hash Database Hash read from the peer, NULL for a bonded peer
+ * @param[out] map Handle map
+ *
+ * @return SL_STATUS_OK on a hit, SL_STATUS_NOT_FOUND otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_discovery_cache_lookup(const bd_addr *peer,
+                                        const uint8_t *hash,
+                                        gatt_discovery_cache_map_t *map);
+
+/***************************************************************************//**
+ * Look up the handle map of a database a peer was seen with, knowing only the
+ * first bytes of its hash, e.g. from an advertisement. Misses are not counted,
+ * as the hash is then read and looked up with gatt_discovery_cache_lookup().
+ * @param[in] peer Identity of the peer
+ * @param[in] prefix First bytes of the Database Hash
+ * @param[in] prefix_len Number of bytes in prefix, at most
+ *            GATT_DISCOVERY_CACHE_HASH_LEN
+ * @param[out] hash Whole Database Hash of the map found
+ * @param[out] map Handle map
+ * @return SL_STATUS_OK on a hit, SL_STATUS_NOT_FOUND if no map or several
+ *         maps of the peer match the prefix.
+ ******************************************************************************/
+sl_status_t gatt_discovery_cache_lookup_prefix(const bd_addr *peer,
+                                               const uint8_t *prefix,
+                                               uint8_t prefix_len,
+                                               uint8_t *hash,
+                                               gatt_discovery_cache_map_t *map);
+
+/***************************************************************************//**
+ *
+ * Store the handle map of a database of a peer, replacing the previous map of
+ * the same database, or the least recently used entry if the cache is full.
+ *
+ * @param[in] peer Identity of the peer
+ * @param[in] hash Database Hash the map belongs to, NULL for a bonded peer
+ * @param[in] map Handle map
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_FAIL if NVM3 failed.
+ *
+ ******************************************************************************/
+sl_status_t gatt_discovery_cache_store(const bd_addr *peer,
+                                       const uint8_t *hash,
+                                       const gatt_discovery_cache_map_t *map);
+
+/***************************************************************************//**
+ *
+ * Discover all services, characteristics and descriptors of a connection
+ * into a map. Descriptors are only discovered for the characteristics that
+ * have room for them between their value and the next declaration.
+ *
+ * @param[in] connection Connection handle
+ * @param[out] map Handle map, filled until the callback is called
+ * @param[in] callback Function called when the discovery ends
+ *
+ * @return SL_STATUS_OK if the discovery was started, SL_STATUS_BUSY if one
+ *         is running. Error code of the stack otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_discovery_cache_discover(uint8_t connection,
+                                          gatt_discovery_cache_map_t *map,
+                                          gatt_discovery_cache_callback_t callback);
+
+/***************************************************************************//**
+ *
+ * Rediscover the part of a map that a Service Changed indication reports as
+ * changed. The services overlapping the handle range are removed from the map
+ * together with their characteristics and descriptors, the others are kept.
+ * The primary services are discovered again, and only the ones overlapping
+ * the range get their characteristics and descriptors discovered.
+ *
+ * @param[in] connection Connection handle
+ * @param[in,out] map Handle map, updated until the callback is called
+ * @param[in] start First handle of the changed range
+ * @param[in] end Last handle of the changed range
+ * @param[in] callback Function called when the rediscovery ends
+ *
+ * @return SL_STATUS_OK if the rediscovery was started, SL_STATUS_BUSY if a
+ *         discovery is running, SL_STATUS_INVALID_RANGE if @p start is 0 or
+ *         above @p end. Error code of the stack otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_discovery_cache_rediscover(uint8_t connection,
+                                            gatt_discovery_cache_map_t *map,
+                                            uint16_t start,
+                                            uint16_t end,
+                                            gatt_discovery_cache_callback_t callback);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler. Must be called from sl_bt_on_event() before the
+ * application handles the event.
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ * @return true if the event belongs to a running discovery, which the
+ *         application must then ignore.
+ *
+ ******************************************************************************/
+bool gatt_discovery_cache_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Find a characteristic in a map.
+ *
+ * @param[in] map Handle map
+ * @param[in] uuid UUID of the characteristic
+ * @param[in] uuid_len Length of the UUID, 2 or 16
+ *
+ * @return Value handle of the first characteristic with this UUID, 0 if none.
+ *
+ ******************************************************************************/
+uint16_t gatt_discovery_cache_find_characteristic(const gatt_discovery_cache_map_t *map,
+                                                  const uint8_t *uuid,
+                                                  uint8_t uuid_len);
+
+/***************************************************************************//**
+ *
+ * Retrieve the cache statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void gatt_discovery_cache_get_stats(gatt_discovery_cache_stats_t *stats);
+
+#endif // GATT_DISCOVERY_CACHE_H
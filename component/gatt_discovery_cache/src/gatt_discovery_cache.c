@@ -0,0 +1,504 @@
+/***************************************************************************//**
+ * @file gatt_discovery_cache.c
+ * @brief GATT discovery and handle map cache of GATT servers.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "nvm3_default.h"
+#include "gatt_discovery_cache.h"
+
+#define MAP_CHUNKS  ((sizeof(gatt_discovery_cache_map_t) + GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE - 1) \
+                     / GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE)
+
+_Static_assert(MAP_CHUNKS < GATT_DISCOVERY_CACHE_NVM3_KEYS_PER_ENTRY,
+               "Handle map needs more NVM3 keys than an entry has");
+
+// Stored under the first key of an entry, the handle map under the next ones
+typedef struct {
+  uint16_t map_size;        // Layout check, sizeof(gatt_discovery_cache_map_t)
+  bd_addr peer;
+  uint8_t hash[GATT_DISCOVERY_CACHE_HASH_LEN]; // Zero for a bonded peer
+  uint32_t stamp;           // Last use, 0 if the entry is free
+} entry_t;
+
+typedef enum {
+  DISCOVERY_IDLE,
+  DISCOVERY_SERVICES,
+  DISCOVERY_CHARACTERISTICS,
+  DISCOVERY_DESCRIPTORS
+} discovery_state_t;
+
+static entry_t entries[GATT_DISCOVERY_CACHE_MAX_ENTRIES];
+static uint32_t last_stamp = 0;
+static gatt_discovery_cache_stats_t stats;
+
+static struct {
+  discovery_state_t state;
+  uint8_t connection;
+  gatt_discovery_cache_map_t *map;
+  gatt_discovery_cache_callback_t callback;
+  uint16_t start;           // Handle range whose services are discovered
+  uint16_t end;
+  uint8_t index;            // Service or characteristic being discovered
+  uint8_t first_characteristic; // First one whose descriptors are discovered
+  bool overflow;
+} discovery;
+
+static nvm3_ObjectKey_t entry_key(uint8_t entry, uint8_t chunk)
+{
+  return GATT_DISCOVERY_CACHE_NVM3_KEY_BASE
+         + entry * GATT_DISCOVERY_CACHE_NVM3_KEYS_PER_ENTRY + chunk;
+}
+
+static size_t chunk_len(uint8_t chunk)
+{
+  size_t left = sizeof(gatt_discovery_cache_map_t) - chunk * GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE;
+
+  return (left > GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE) ? GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE : left;
+}
+
+static void free_entry(uint8_t entry)
+{
+  (void)nvm3_deleteObject(nvm3_defaultHandle, entry_key(entry, 0));
+  memset(&entries[entry], 0, sizeof(entries[entry]));
+}
+
+// Key of the map of a bonded peer
+static const uint8_t no_hash[GATT_DISCOVERY_CACHE_HASH_LEN] = { 0 };
+
+static int8_t find_entry(const bd_addr *peer, const uint8_t *hash)
+{
+  if (hash == NULL) {
+    hash = no_hash;
+  }
+  for (uint8_t i = 0; i < GATT_DISCOVERY_CACHE_MAX_ENTRIES; i++) {
+    if (entries[i].stamp != 0
+        && memcmp(&entries[i].peer, peer, sizeof(bd_addr)) == 0
+        && memcmp(entries[i].hash, hash, GATT_DISCOVERY_CACHE_HASH_LEN) == 0) {
+      return (int8_t)i;
+    }
+  }
+  return -1;
+}
+
+void gatt_discovery_cache_init(void)
+{
+  memset(&stats, 0, sizeof(stats));
+  memset(&discovery, 0, sizeof(discovery));
+  last_stamp = 0;
+
+  for (uint8_t i = 0; i < GATT_DISCOVERY_CACHE_MAX_ENTRIES; i++) {
+    if (nvm3_readData(nvm3_defaultHandle, entry_key(i, 0), &entries[i], sizeof(entries[i])) != ECODE_NVM3_OK
+        || entries[i].map_size != sizeof(gatt_discovery_cache_map_t)) {
+      // Never written, or by a build with another map layout
+      memset(&entries[i], 0, sizeof(entries[i]));
+    }
+    if (entries[i].stamp > last_stamp) {
+      last_stamp = entries[i].stamp;
+    }
+  }
+}
+
+sl_status_t gatt_discovery_cache_lookup(const bd_addr *peer,
+                                        const uint8_t *hash,
+                                        gatt_discovery_cache_map_t *map)
+{
+  int8_t entry = find_entry(peer, hash);
+
+  if (entry < 0) {
+    stats.misses++;
+    return SL_STATUS_NOT_FOUND;
+  }
+  for (uint8_t chunk = 0; chunk < MAP_CHUNKS; chunk++) {
+    if (nvm3_readData(nvm3_defaultHandle,
+                      entry_key(entry, chunk + 1),
+                      (uint8_t *)map + chunk * GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE,
+                      chunk_len(chunk)) != ECODE_NVM3_OK) {
+      stats.nvm_errors++;
+      stats.misses++;
+      free_entry(entry);
+      return SL_STATUS_NOT_FOUND;
+    }
+  }
+
+  entries[entry].stamp = ++last_stamp;
+  if (nvm3_writeData(nvm3_defaultHandle, entry_key(entry, 0),
+                     &entries[entry], sizeof(entries[entry])) != ECODE_NVM3_OK) {
+    stats.nvm_errors++;
+  }
+  stats.hits++;
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_discovery_cache_lookup_prefix(const bd_addr *peer,
+                                               const uint8_t *prefix,
+                                               uint8_t prefix_len,
+                                               uint8_t *hash,
+                                               gatt_discovery_cache_map_t *map)
+{
+  int8_t entry = -1;
+
+  if (prefix_len > GATT_DISCOVERY_CACHE_HASH_LEN) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  for (uint8_t i = 0; i < GATT_DISCOVERY_CACHE_MAX_ENTRIES; i++) {
+    if (entries[i].stamp != 0
+        && memcmp(&entries[i].peer, peer, sizeof(bd_addr)) == 0
+        && memcmp(entries[i].hash, no_hash, GATT_DISCOVERY_CACHE_HASH_LEN) != 0
+        && memcmp(entries[i].hash, prefix, prefix_len) == 0) {
+      if (entry >= 0) {
+        // Ambiguous, only the whole hash tells
+        return SL_STATUS_NOT_FOUND;
+      }
+      entry = (int8_t)i;
+    }
+  }
+  if (entry < 0) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  memcpy(hash, entries[entry].hash, GATT_DISCOVERY_CACHE_HASH_LEN);
+  return gatt_discovery_cache_lookup(peer, hash, map);
+}
+
+sl_status_t gatt_discovery_cache_store(const bd_addr *peer,
+                                       const uint8_t *hash,
+                                       const gatt_discovery_cache_map_t *map)
+{
+  int8_t entry = find_entry(peer, hash);
+
+  // Otherwise a free entry, or the least recently used one
+  if (entry < 0) {
+    entry = 0;
+    for (uint8_t i = 1; i < GATT_DISCOVERY_CACHE_MAX_ENTRIES; i++) {
+      if (entries[i].stamp < entries[entry].stamp) {
+        entry = (int8_t)i;
+      }
+    }
+    if (entries[entry].stamp != 0) {
+      stats.evictions++;
+    }
+  }
+
+  // Without its header the entry is free until the map is written
+  free_entry(entry);
+  for (uint8_t chunk = 0; chunk < MAP_CHUNKS; chunk++) {
+    if (nvm3_writeData(nvm3_defaultHandle,
+                       entry_key(entry, chunk + 1),
+                       (const uint8_t *)map + chunk * GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE,
+                       chunk_len(chunk)) != ECODE_NVM3_OK) {
+      stats.nvm_errors++;
+      return SL_STATUS_FAIL;
+    }
+  }
+
+  entries[entry].map_size = sizeof(gatt_discovery_cache_map_t);
+  memcpy(&entries[entry].peer, peer, sizeof(bd_addr));
+  memcpy(entries[entry].hash, (hash != NULL) ? hash : no_hash, GATT_DISCOVERY_CACHE_HASH_LEN);
+  entries[entry].stamp = ++last_stamp;
+  if (nvm3_writeData(nvm3_defaultHandle, entry_key(entry, 0),
+                     &entries[entry], sizeof(entries[entry])) != ECODE_NVM3_OK) {
+    stats.nvm_errors++;
+    memset(&entries[entry], 0, sizeof(entries[entry]));
+    return SL_STATUS_FAIL;
+  }
+  return SL_STATUS_OK;
+}
+
+static void copy_uuid(gatt_discovery_cache_uuid_t *uuid, const uint8array *src)
+{
+  uuid->len = (src->len > sizeof(uuid->data)) ? sizeof(uuid->data) : src->len;
+  memcpy(uuid->data, src->data, uuid->len);
+}
+
+static void finish_discovery(sl_status_t result)
+{
+  if (result == SL_STATUS_OK && discovery.overflow) {
+    result = SL_STATUS_WOULD_OVERFLOW;
+  }
+  if (result == SL_STATUS_OK) {
+    if (discovery.start == 0x0001 && discovery.end == 0xFFFF) {
+      stats.discoveries++;
+    } else {
+      stats.rediscoveries++;
+    }
+  }
+  discovery.state = DISCOVERY_IDLE;
+  if (discovery.callback != NULL) {
+    discovery.callback(discovery.connection, result);
+  }
+}
+
+// A characteristic can only have descriptors if there are handles between
+// its value and the declaration of the next one, or the end of the service
+static bool has_descriptors(uint8_t index)
+{
+  const gatt_discovery_cache_map_t *map = discovery.map;
+  const gatt_discovery_cache_characteristic_t *c = &map->characteristics[index];
+
+  if (index + 1 < map->characteristic_count
+      && map->characteristics[index + 1].service == c->service) {
+    return c->handle + 2 < map->characteristics[index + 1].handle;
+  }
+  return c->handle < map->services[c->service].end;
+}
+
+// Start the next procedure, or end the discovery once all are done
+static void discover_next(void)
+{
+  gatt_discovery_cache_map_t *map = discovery.map;
+  sl_status_t sc = SL_STATUS_OK;
+
+  if (discovery.state == DISCOVERY_CHARACTERISTICS
+      && discovery.index < map->service_count) {
+    sc = sl_bt_gatt_discover_characteristics(discovery.connection,
+                                             ((uint32_t)map->services[discovery.index].start << 16)
+                                             | map->services[discovery.index].end);
+  } else {
+    if (discovery.state == DISCOVERY_CHARACTERISTICS) {
+      discovery.state = DISCOVERY_DESCRIPTORS;
+      discovery.index = discovery.first_characteristic;
+    }
+    while (discovery.index < map->characteristic_count && !has_descriptors(discovery.index)) {
+      discovery.index++;
+    }
+    if (discovery.index == map->characteristic_count) {
+      finish_discovery(SL_STATUS_OK);
+      return;
+    }
+    sc = sl_bt_gatt_discover_descriptors(discovery.connection,
+                                         map->characteristics[discovery.index].handle);
+  }
+  if (sc != SL_STATUS_OK) {
+    finish_discovery(sc);
+    return;
+  }
+  stats.procedures++;
+}
+
+static bool overlaps(uint16_t start, uint16_t end)
+{
+  return start <= discovery.end && end >= discovery.start;
+}
+
+// Remove the services overlapping the range, with their characteristics and
+// descriptors. The rest keeps its order, and thus the characteristics of a
+// service stay next to each other.
+static void invalidate(void)
+{
+  gatt_discovery_cache_map_t *map = discovery.map;
+  uint8_t service_index[GATT_DISCOVERY_CACHE_MAX_SERVICES];
+  uint8_t characteristic_index[GATT_DISCOVERY_CACHE_MAX_CHARACTERISTICS];
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < map->service_count; i++) {
+    service_index[i] = UINT8_MAX;
+    if (!overlaps(map->services[i].start, map->services[i].end)) {
+      service_index[i] = count;
+      map->services[count++] = map->services[i];
+    }
+  }
+  map->service_count = count;
+
+  count = 0;
+  for (uint8_t i = 0; i < map->characteristic_count; i++) {
+    characteristic_index[i] = UINT8_MAX;
+    if (service_index[map->characteristics[i].service] != UINT8_MAX) {
+      characteristic_index[i] = count;
+      map->characteristics[count] = map->characteristics[i];
+      map->characteristics[count++].service = service_index[map->characteristics[i].service];
+    }
+  }
+  map->characteristic_count = count;
+
+  count = 0;
+  for (uint8_t i = 0; i < map->descriptor_count; i++) {
+    if (characteristic_index[map->descriptors[i].characteristic] != UINT8_MAX) {
+      map->descriptors[count] = map->descriptors[i];
+      map->descriptors[count++].characteristic = characteristic_index[map->descriptors[i].characteristic];
+    }
+  }
+  map->descriptor_count = count;
+}
+
+static sl_status_t start_discovery(uint8_t connection,
+                                   gatt_discovery_cache_map_t *map,
+                                   uint16_t start,
+                                   uint16_t end,
+                                   gatt_discovery_cache_callback_t callback)
+{
+  sl_status_t sc;
+
+  if (discovery.state != DISCOVERY_IDLE) {
+    return SL_STATUS_BUSY;
+  }
+  sc = sl_bt_gatt_discover_primary_services(connection);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  discovery.state = DISCOVERY_SERVICES;
+  discovery.connection = connection;
+  discovery.map = map;
+  discovery.callback = callback;
+  discovery.start = start;
+  discovery.end = end;
+  discovery.overflow = false;
+  invalidate();
+  // The new services and characteristics are added after the kept ones
+  discovery.index = map->service_count;
+  discovery.first_characteristic = map->characteristic_count;
+  stats.procedures++;
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_discovery_cache_discover(uint8_t connection,
+                                          gatt_discovery_cache_map_t *map,
+                                          gatt_discovery_cache_callback_t callback)
+{
+  if (discovery.state == DISCOVERY_IDLE) {
+    memset(map, 0, sizeof(*map));
+  }
+  return start_discovery(connection, map, 0x0001, 0xFFFF, callback);
+}
+
+sl_status_t gatt_discovery_cache_rediscover(uint8_t connection,
+                                            gatt_discovery_cache_map_t *map,
+                                            uint16_t start,
+                                            uint16_t end,
+                                            gatt_discovery_cache_callback_t callback)
+{
+  if (start == 0 || start > end) {
+    return SL_STATUS_INVALID_RANGE;
+  }
+  return start_discovery(connection, map, start, end, callback);
+}
+
+bool gatt_discovery_cache_on_event(sl_bt_msg_t *evt)
+{
+  gatt_discovery_cache_map_t *map = discovery.map;
+
+  if (discovery.state == DISCOVERY_IDLE) {
+    return false;
+  }
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_gatt_service_id:
+      if (evt->data.evt_gatt_service.connection != discovery.connection) {
+        break;
+      }
+      // The services outside the range were kept
+      if (!overlaps((uint16_t)(evt->data.evt_gatt_service.service >> 16),
+                    (uint16_t)evt->data.evt_gatt_service.service)) {
+        return true;
+      }
+      if (map->service_count == GATT_DISCOVERY_CACHE_MAX_SERVICES) {
+        discovery.overflow = true;
+      } else {
+        gatt_discovery_cache_service_t *s = &map->services[map->service_count++];
+
+        s->start = (uint16_t)(evt->data.evt_gatt_service.service >> 16);
+        s->end = (uint16_t)evt->data.evt_gatt_service.service;
+        copy_uuid(&s->uuid, &evt->data.evt_gatt_service.uuid);
+      }
+      return true;
+
+    case sl_bt_evt_gatt_characteristic_id:
+      if (evt->data.evt_gatt_characteristic.connection != discovery.connection) {
+        break;
+      }
+      if (map->characteristic_count == GATT_DISCOVERY_CACHE_MAX_CHARACTERISTICS) {
+        discovery.overflow = true;
+      } else {
+        gatt_discovery_cache_characteristic_t *c = &map->characteristics[map->characteristic_count++];
+
+        c->handle = evt->data.evt_gatt_characteristic.characteristic;
+        c->properties = evt->data.evt_gatt_characteristic.properties;
+        c->service = discovery.index;
+        copy_uuid(&c->uuid, &evt->data.evt_gatt_characteristic.uuid);
+      }
+      return true;
+
+    case sl_bt_evt_gatt_descriptor_id:
+      if (evt->data.evt_gatt_descriptor.connection != discovery.connection) {
+        break;
+      }
+      if (map->descriptor_count == GATT_DISCOVERY_CACHE_MAX_DESCRIPTORS) {
+        discovery.overflow = true;
+      } else {
+        gatt_discovery_cache_descriptor_t *d = &map->descriptors[map->descriptor_count++];
+
+        d->handle = evt->data.evt_gatt_descriptor.descriptor;
+        d->characteristic = discovery.index;
+        copy_uuid(&d->uuid, &evt->data.evt_gatt_descriptor.uuid);
+      }
+      return true;
+
+    case sl_bt_evt_gatt_procedure_completed_id:
+      if (evt->data.evt_gatt_procedure_completed.connection != discovery.connection) {
+        break;
+      }
+      if (evt->data.evt_gatt_procedure_completed.result != SL_STATUS_OK) {
+        finish_discovery(evt->data.evt_gatt_procedure_completed.result);
+        return true;
+      }
+      if (discovery.state == DISCOVERY_SERVICES) {
+        discovery.state = DISCOVERY_CHARACTERISTICS;
+      } else {
+        discovery.index++;
+      }
+      discover_next();
+      return true;
+
+    case sl_bt_evt_connection_closed_id:
+      if (evt->data.evt_connection_closed.connection == discovery.connection) {
+        finish_discovery(evt->data.evt_connection_closed.reason);
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+uint16_t gatt_discovery_cache_find_characteristic(const gatt_discovery_cache_map_t *map,
+                                                  const uint8_t *uuid,
+                                                  uint8_t uuid_len)
+{
+  for (uint8_t i = 0; i < map->characteristic_count; i++) {
+    if (map->characteristics[i].uuid.len == uuid_len
+        && memcmp(map->characteristics[i].uuid.data, uuid, uuid_len) == 0) {
+      return map->characteristics[i].handle;
+    }
+  }
+  return 0;
+}
+
+void gatt_discovery_cache_get_stats(gatt_discovery_cache_stats_t *out)
+{
+  *out = stats;
+}
@@ -0,0 +1,916 @@
+/***************************************************************************//**
+ * @file gatt_discovery_cache_test.c
+ * @brief Host test of the GATT Discovery Cache.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Runs gatt_discovery_cache.c against a mocked GATT server and a mocked
+ * NVM3. The discovery commands are replaced by the functions below, which
+ * fail the test if a procedure is started while another one runs, and the
+ * events of the server database are fed back to the component. Scenarios
+ * check the storage of handle maps across a simulated reboot, several
+ * hashes per peer, prefix lookups, the least recently used eviction and
+ * NVM3 failures, then full discoveries and rediscoveries of a handle range.
+ * Random service toggles finally compare each rediscovered map with the
+ * database of the server. Build and run on a PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I. -I../inc gatt_discovery_cache_test.c ../src/gatt_discovery_cache.c -o gatt_discovery_cache_test
+ *   ./gatt_discovery_cache_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nvm3_default.h"
+#include "gatt_discovery_cache.h"
+
+#define CONNECTION      1
+#define NVM3_OBJECTS    256
+#define NVM3_OBJECT_MAX 256
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+// -----------------------------------------------------------------------------
+// Mocked NVM3
+
+static struct {
+  bool used;
+  nvm3_ObjectKey_t key;
+  size_t len;
+  uint8_t data[NVM3_OBJECT_MAX];
+} objects[NVM3_OBJECTS];
+
+static nvm3_Handle_t handle;
+nvm3_Handle_t *nvm3_defaultHandle = &handle;
+static unsigned writes = 0;
+static unsigned fail_write = 0;   // Number of the write that fails, 0 for none
+
+static int find_object(nvm3_ObjectKey_t key)
+{
+  for (int i = 0; i < NVM3_OBJECTS; i++) {
+    if (objects[i].used && objects[i].key == key) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, void *value, size_t maxLen)
+{
+  int i = find_object(key);
+
+  CHECK(h == nvm3_defaultHandle);
+  if (i < 0) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  memcpy(value, objects[i].data, (maxLen < objects[i].len) ? maxLen : objects[i].len);
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, const void *value, size_t len)
+{
+  int i = find_object(key);
+
+  CHECK(h == nvm3_defaultHandle);
+  CHECK(len <= GATT_DISCOVERY_CACHE_NVM3_CHUNK_SIZE);
+  if (++writes == fail_write) {
+    return ECODE_NVM3_ERR_WRITE_FAILED;
+  }
+  for (int j = 0; i < 0 && j < NVM3_OBJECTS; j++) {
+    if (!objects[j].used) {
+      i = j;
+    }
+  }
+  if (i < 0) {
+    return ECODE_NVM3_ERR_WRITE_FAILED;
+  }
+  objects[i].used = true;
+  objects[i].key = key;
+  objects[i].len = len;
+  memcpy(objects[i].data, value, len);
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_deleteObject(nvm3_Handle_t *h, nvm3_ObjectKey_t key)
+{
+  int i = find_object(key);
+
+  CHECK(h == nvm3_defaultHandle);
+  if (i < 0) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  objects[i].used = false;
+  return ECODE_NVM3_OK;
+}
+
+static void erase_nvm3(void)
+{
+  memset(objects, 0, sizeof(objects));
+}
+
+// -----------------------------------------------------------------------------
+// Mocked GATT server
+
+typedef enum {
+  ATTRIBUTE_SERVICE,
+  ATTRIBUTE_CHARACTERISTIC,   // Declaration, the value follows it
+  ATTRIBUTE_DESCRIPTOR
+} attribute_kind_t;
+
+typedef struct {
+  uint16_t handle;
+  attribute_kind_t kind;
+  uint16_t uuid;              // 0xFFFF for the 128-bit UUID below
+  uint8_t properties;
+  bool hidden;                // Service disabled, with all its attributes
+} attribute_t;
+
+#define MAX_ATTRIBUTES 64
+
+static attribute_t db[MAX_ATTRIBUTES];
+static uint8_t db_count;
+static uint16_t db_end;
+
+static const uint8_t uuid_128[16] = {
+  0x9e, 0xe4, 0xc7, 0x79, 0xcc, 0xbe, 0x22, 0xa1,
+  0x64, 0x4e, 0x81, 0xdd, 0xfd, 0xdb, 0x4e, 0x67
+};
+
+typedef enum {
+  PROCEDURE_NONE,
+  PROCEDURE_SERVICES,
+  PROCEDURE_CHARACTERISTICS,
+  PROCEDURE_DESCRIPTORS
+} procedure_t;
+
+static struct {
+  procedure_t procedure;
+  uint32_t range;
+  uint16_t characteristic;
+} pending;
+
+static unsigned procedures = 0;
+static unsigned fail_procedure = 0;   // Number of the procedure that fails
+static sl_status_t refuse = SL_STATUS_OK;
+static bool done = false;
+static sl_status_t done_result;
+
+static void add(attribute_kind_t kind, uint16_t uuid, uint8_t properties)
+{
+  attribute_t *a = &db[db_count++];
+
+  a->handle = ++db_end;
+  a->kind = kind;
+  a->uuid = uuid;
+  a->properties = properties;
+  a->hidden = false;
+  if (kind == ATTRIBUTE_CHARACTERISTIC) {
+    db_end++;
+  }
+}
+
+// Shaped like the database of the GATT caching example: Generic Access,
+// Generic Attribute, Device Information and two versions of the LED service.
+// The last two services are only there to be toggled.
+static void build_database(void)
+{
+  db_count = 0;
+  db_end = 0;
+  add(ATTRIBUTE_SERVICE, 0x1800, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A00, 0x0A);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A01, 0x02);
+  add(ATTRIBUTE_SERVICE, 0x1801, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A05, 0x20);
+  add(ATTRIBUTE_DESCRIPTOR, 0x2902, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2B29, 0x0A);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2B2A, 0x02);
+  add(ATTRIBUTE_SERVICE, 0x180A, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A29, 0x02);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A24, 0x02);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A23, 0x02);
+  add(ATTRIBUTE_SERVICE, 0xFFFF, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x5D00, 0x0A);
+  add(ATTRIBUTE_DESCRIPTOR, 0x2901, 0);
+  add(ATTRIBUTE_SERVICE, 0xFFFF, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x77DD, 0x0A);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x5D00, 0x1A);
+  add(ATTRIBUTE_DESCRIPTOR, 0x2902, 0);
+  add(ATTRIBUTE_DESCRIPTOR, 0x2901, 0);
+  add(ATTRIBUTE_SERVICE, 0x1815, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A56, 0x12);
+  add(ATTRIBUTE_DESCRIPTOR, 0x2902, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A58, 0x06);
+  add(ATTRIBUTE_SERVICE, 0x180F, 0);
+  add(ATTRIBUTE_CHARACTERISTIC, 0x2A19, 0x12);
+  add(ATTRIBUTE_DESCRIPTOR, 0x2902, 0);
+}
+
+static int8_t service_of(uint8_t attribute)
+{
+  int8_t service = -1;
+
+  for (uint8_t i = 0; i <= attribute; i++) {
+    if (db[i].kind == ATTRIBUTE_SERVICE) {
+      service++;
+    }
+  }
+  return service;
+}
+
+static uint8_t service_index(int8_t service)
+{
+  uint8_t i;
+
+  for (i = 0; i < db_count; i++) {
+    if (db[i].kind == ATTRIBUTE_SERVICE && service-- == 0) {
+      break;
+    }
+  }
+  return i;
+}
+
+static void set_hidden(int8_t service, bool hidden)
+{
+  for (uint8_t i = 0; i < db_count; i++) {
+    if (service_of(i) == service) {
+      db[i].hidden = hidden;
+    }
+  }
+}
+
+// Handles of a service: up to the next declaration of a service, visible or
+// not, as the handles of a hidden service stay allocated
+static void service_range(int8_t service, uint16_t *start, uint16_t *end)
+{
+  uint8_t i = service_index(service);
+
+  *start = db[i].handle;
+  *end = db_end;
+  for (i++; i < db_count; i++) {
+    if (db[i].kind == ATTRIBUTE_SERVICE) {
+      *end = db[i].handle - 1;
+      break;
+    }
+  }
+}
+
+// Last handle of the characteristic whose declaration is attribute i
+static uint16_t characteristic_end(uint8_t i)
+{
+  for (uint8_t j = i + 1; j < db_count; j++) {
+    if (db[j].kind != ATTRIBUTE_DESCRIPTOR) {
+      return db[j].handle - 1;
+    }
+  }
+  return db_end;
+}
+
+static void set_uuid(uint8array *array, uint16_t uuid)
+{
+  if (uuid == 0xFFFF) {
+    array->len = sizeof(uuid_128);
+    memcpy(array->data, uuid_128, sizeof(uuid_128));
+  } else {
+    array->len = 2;
+    array->data[0] = (uint8_t)uuid;
+    array->data[1] = (uint8_t)(uuid >> 8);
+  }
+}
+
+static void set_map_uuid(gatt_discovery_cache_uuid_t *map_uuid, uint16_t uuid)
+{
+  uint8array array;
+
+  set_uuid(&array, uuid);
+  map_uuid->len = array.len;
+  memset(map_uuid->data, 0, sizeof(map_uuid->data));
+  memcpy(map_uuid->data, array.data, array.len);
+}
+
+// The map a full discovery of the visible database must give
+static void expected_map(gatt_discovery_cache_map_t *map)
+{
+  memset(map, 0, sizeof(*map));
+  for (uint8_t i = 0; i < db_count; i++) {
+    if (db[i].hidden) {
+      continue;
+    }
+    if (db[i].kind == ATTRIBUTE_SERVICE) {
+      gatt_discovery_cache_service_t *s = &map->services[map->service_count++];
+
+      service_range(service_of(i), &s->start, &s->end);
+      set_map_uuid(&s->uuid, db[i].uuid);
+    } else if (db[i].kind == ATTRIBUTE_CHARACTERISTIC) {
+      gatt_discovery_cache_characteristic_t *c = &map->characteristics[map->characteristic_count++];
+
+      c->handle = db[i].handle + 1;
+      c->properties = db[i].properties;
+      c->service = map->service_count - 1;
+      set_map_uuid(&c->uuid, db[i].uuid);
+    } else {
+      gatt_discovery_cache_descriptor_t *d = &map->descriptors[map->descriptor_count++];
+
+      d->handle = db[i].handle;
+      d->characteristic = map->characteristic_count - 1;
+      set_map_uuid(&d->uuid, db[i].uuid);
+    }
+  }
+}
+
+sl_status_t sl_bt_gatt_discover_primary_services(uint8_t connection)
+{
+  CHECK(connection == CONNECTION);
+  CHECK(pending.procedure == PROCEDURE_NONE);
+  if (refuse != SL_STATUS_OK) {
+    return refuse;
+  }
+  pending.procedure = PROCEDURE_SERVICES;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_discover_characteristics(uint8_t connection, uint32_t service)
+{
+  CHECK(connection == CONNECTION);
+  CHECK(pending.procedure == PROCEDURE_NONE);
+  if (refuse != SL_STATUS_OK) {
+    return refuse;
+  }
+  pending.procedure = PROCEDURE_CHARACTERISTICS;
+  pending.range = service;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_discover_descriptors(uint8_t connection, uint16_t characteristic)
+{
+  CHECK(connection == CONNECTION);
+  CHECK(pending.procedure == PROCEDURE_NONE);
+  if (refuse != SL_STATUS_OK) {
+    return refuse;
+  }
+  pending.procedure = PROCEDURE_DESCRIPTORS;
+  pending.characteristic = characteristic;
+  return SL_STATUS_OK;
+}
+
+static void on_done(uint8_t connection, sl_status_t result)
+{
+  CHECK(connection == CONNECTION);
+  CHECK(!done);
+  done = true;
+  done_result = result;
+}
+
+static void send(sl_bt_msg_t *evt, bool consumed)
+{
+  CHECK(gatt_discovery_cache_on_event(evt) == consumed);
+}
+
+// The events the server answers the pending procedure with, each one also
+// sent for another connection first, which the component must ignore
+static void answer(void)
+{
+  sl_bt_msg_t evt;
+  uint16_t start = (uint16_t)(pending.range >> 16);
+  uint16_t end = (uint16_t)pending.range;
+
+  for (uint8_t i = 0; i < db_count; i++) {
+    memset(&evt, 0, sizeof(evt));
+    if (db[i].hidden) {
+      continue;
+    }
+    if (pending.procedure == PROCEDURE_SERVICES && db[i].kind == ATTRIBUTE_SERVICE) {
+      service_range(service_of(i), &start, &end);
+      evt.header = sl_bt_evt_gatt_service_id;
+      evt.data.evt_gatt_service.service = ((uint32_t)start << 16) | end;
+      set_uuid(&evt.data.evt_gatt_service.uuid, db[i].uuid);
+    } else if (pending.procedure == PROCEDURE_CHARACTERISTICS
+               && db[i].kind == ATTRIBUTE_CHARACTERISTIC
+               && db[i].handle >= start && db[i].handle <= end) {
+      evt.header = sl_bt_evt_gatt_characteristic_id;
+      evt.data.evt_gatt_characteristic.characteristic = db[i].handle + 1;
+      evt.data.evt_gatt_characteristic.properties = db[i].properties;
+      set_uuid(&evt.data.evt_gatt_characteristic.uuid, db[i].uuid);
+    } else if (pending.procedure == PROCEDURE_DESCRIPTORS
+               && db[i].kind == ATTRIBUTE_CHARACTERISTIC
+               && db[i].handle + 1 == pending.characteristic) {
+      // The value of the characteristic, then its descriptors
+      for (uint8_t j = i + 1; j < db_count && db[j].handle <= characteristic_end(i); j++) {
+        memset(&evt, 0, sizeof(evt));
+        evt.header = sl_bt_evt_gatt_descriptor_id;
+        evt.data.evt_gatt_descriptor.descriptor = db[j].handle;
+        set_uuid(&evt.data.evt_gatt_descriptor.uuid, db[j].uuid);
+        evt.data.evt_gatt_descriptor.connection = CONNECTION + 1;
+        send(&evt, false);
+        evt.data.evt_gatt_descriptor.connection = CONNECTION;
+        send(&evt, true);
+      }
+      continue;
+    } else {
+      continue;
+    }
+    // The connection is at the same offset in all the events
+    evt.data.evt_gatt_service.connection = CONNECTION + 1;
+    send(&evt, false);
+    evt.data.evt_gatt_service.connection = CONNECTION;
+    send(&evt, true);
+  }
+}
+
+// Answer the procedures until the discovery ends
+static void run(void)
+{
+  sl_bt_msg_t evt;
+
+  while (!done && pending.procedure != PROCEDURE_NONE) {
+    sl_status_t result = (++procedures == fail_procedure) ? 0x0401 : SL_STATUS_OK;
+
+    if (result == SL_STATUS_OK) {
+      answer();
+    }
+    pending.procedure = PROCEDURE_NONE;
+    memset(&evt, 0, sizeof(evt));
+    evt.header = sl_bt_evt_gatt_procedure_completed_id;
+    evt.data.evt_gatt_procedure_completed.connection = CONNECTION + 1;
+    send(&evt, false);
+    evt.data.evt_gatt_procedure_completed.connection = CONNECTION;
+    evt.data.evt_gatt_procedure_completed.result = (uint16_t)result;
+    send(&evt, true);
+  }
+  CHECK(done);
+  CHECK(pending.procedure == PROCEDURE_NONE);
+}
+
+static sl_status_t discover(gatt_discovery_cache_map_t *map, unsigned *count)
+{
+  unsigned before = procedures;
+
+  done = false;
+  CHECK(gatt_discovery_cache_discover(CONNECTION, map, on_done) == SL_STATUS_OK);
+  run();
+  *count = procedures - before;
+  return done_result;
+}
+
+static sl_status_t rediscover(gatt_discovery_cache_map_t *map, uint16_t start, uint16_t end,
+                              unsigned *count)
+{
+  unsigned before = procedures;
+
+  done = false;
+  CHECK(gatt_discovery_cache_rediscover(CONNECTION, map, start, end, on_done) == SL_STATUS_OK);
+  run();
+  *count = procedures - before;
+  return done_result;
+}
+
+// A discovered UUID does not clear the bytes beyond its length
+static bool same_uuid(const gatt_discovery_cache_uuid_t *a, const gatt_discovery_cache_uuid_t *b)
+{
+  return a->len == b->len && memcmp(a->data, b->data, a->len) == 0;
+}
+
+// Same services, characteristics and descriptors, in any order
+static bool same_database(const gatt_discovery_cache_map_t *a, const gatt_discovery_cache_map_t *b)
+{
+  if (a->service_count != b->service_count
+      || a->characteristic_count != b->characteristic_count
+      || a->descriptor_count != b->descriptor_count) {
+    return false;
+  }
+  for (uint8_t i = 0; i < a->service_count; i++) {
+    uint8_t j = 0;
+
+    while (j < b->service_count
+           && (b->services[j].start != a->services[i].start
+               || b->services[j].end != a->services[i].end
+               || !same_uuid(&b->services[j].uuid, &a->services[i].uuid))) {
+      j++;
+    }
+    if (j == b->service_count) {
+      return false;
+    }
+  }
+  for (uint8_t i = 0; i < a->characteristic_count; i++) {
+    const gatt_discovery_cache_characteristic_t *c = &a->characteristics[i];
+    uint8_t j = 0;
+
+    while (j < b->characteristic_count && b->characteristics[j].handle != c->handle) {
+      j++;
+    }
+    if (j == b->characteristic_count
+        || b->characteristics[j].properties != c->properties
+        || !same_uuid(&b->characteristics[j].uuid, &c->uuid)
+        || b->services[b->characteristics[j].service].start != a->services[c->service].start) {
+      return false;
+    }
+  }
+  for (uint8_t i = 0; i < a->descriptor_count; i++) {
+    const gatt_discovery_cache_descriptor_t *d = &a->descriptors[i];
+    uint8_t j = 0;
+
+    while (j < b->descriptor_count && b->descriptors[j].handle != d->handle) {
+      j++;
+    }
+    if (j == b->descriptor_count
+        || !same_uuid(&b->descriptors[j].uuid, &d->uuid)
+        || b->characteristics[b->descriptors[j].characteristic].handle
+        != a->characteristics[d->characteristic].handle) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// Scenarios
+
+static const bd_addr peer = { { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 } };
+
+static void fill_map(gatt_discovery_cache_map_t *map, uint8_t tag)
+{
+  memset(map, 0, sizeof(*map));
+  map->service_count = 1;
+  map->services[0].start = tag;
+  map->services[0].end = 0xFFFF;
+  map->characteristic_count = GATT_DISCOVERY_CACHE_MAX_CHARACTERISTICS;
+  map->characteristics[GATT_DISCOVERY_CACHE_MAX_CHARACTERISTICS - 1].handle = tag;
+  map->descriptor_count = GATT_DISCOVERY_CACHE_MAX_DESCRIPTORS;
+  map->descriptors[GATT_DISCOVERY_CACHE_MAX_DESCRIPTORS - 1].handle = tag;
+}
+
+static bool has_map(const bd_addr *address, const uint8_t *hash, uint8_t tag)
+{
+  gatt_discovery_cache_map_t expected;
+  gatt_discovery_cache_map_t map;
+
+  fill_map(&expected, tag);
+  return gatt_discovery_cache_lookup(address, hash, &map) == SL_STATUS_OK
+         && memcmp(&map, &expected, sizeof(map)) == 0;
+}
+
+// Maps of two database versions and of a bond survive a reboot, and are
+// found from the first bytes of the hash when only one matches
+static void test_storage(void)
+{
+  const uint8_t hash_1[GATT_DISCOVERY_CACHE_HASH_LEN] = { 0xA1, 0x10 };
+  const uint8_t hash_2[GATT_DISCOVERY_CACHE_HASH_LEN] = { 0xA1, 0x20 };
+  const uint8_t zero[2] = { 0 };
+  const bd_addr other = { { 0x01, 0x02, 0x03, 0x04, 0x05, 0x07 } };
+  gatt_discovery_cache_map_t map;
+  gatt_discovery_cache_stats_t stats;
+  uint8_t hash[GATT_DISCOVERY_CACHE_HASH_LEN];
+
+  erase_nvm3();
+  gatt_discovery_cache_init();
+  CHECK(gatt_discovery_cache_lookup(&peer, hash_1, &map) == SL_STATUS_NOT_FOUND);
+  fill_map(&map, 1);
+  CHECK(gatt_discovery_cache_store(&peer, hash_1, &map) == SL_STATUS_OK);
+  fill_map(&map, 2);
+  CHECK(gatt_discovery_cache_store(&peer, hash_2, &map) == SL_STATUS_OK);
+  fill_map(&map, 3);
+  CHECK(gatt_discovery_cache_store(&peer, NULL, &map) == SL_STATUS_OK);
+
+  gatt_discovery_cache_init();
+  CHECK(has_map(&peer, hash_1, 1));
+  CHECK(has_map(&peer, hash_2, 2));
+  CHECK(has_map(&peer, NULL, 3));
+  CHECK(!has_map(&other, hash_1, 1));
+
+  CHECK(gatt_discovery_cache_lookup_prefix(&peer, hash_1, 1, hash, &map) == SL_STATUS_NOT_FOUND);
+  CHECK(gatt_discovery_cache_lookup_prefix(&peer, hash_2, 2, hash, &map) == SL_STATUS_OK);
+  CHECK(memcmp(hash, hash_2, sizeof(hash)) == 0 && map.services[0].start == 2);
+  CHECK(gatt_discovery_cache_lookup_prefix(&peer, zero, sizeof(zero), hash, &map) == SL_STATUS_NOT_FOUND);
+  CHECK(gatt_discovery_cache_lookup_prefix(&other, hash_2, 2, hash, &map) == SL_STATUS_NOT_FOUND);
+  CHECK(gatt_discovery_cache_lookup_prefix(&peer, hash_2, GATT_DISCOVERY_CACHE_HASH_LEN + 1, hash, &map)
+        == SL_STATUS_NOT_FOUND);
+
+  // The map of the bond is replaced, not added
+  fill_map(&map, 4);
+  CHECK(gatt_discovery_cache_store(&peer, NULL, &map) == SL_STATUS_OK);
+  CHECK(has_map(&peer, NULL, 4));
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.hits == 5 && stats.misses == 1 && stats.evictions == 0 && stats.nvm_errors == 0);
+}
+
+// The least recently used map is replaced, also after a reboot
+static void test_eviction(void)
+{
+  gatt_discovery_cache_map_t map;
+  gatt_discovery_cache_stats_t stats;
+  bd_addr address = peer;
+
+  erase_nvm3();
+  gatt_discovery_cache_init();
+  for (uint8_t i = 0; i < GATT_DISCOVERY_CACHE_MAX_ENTRIES; i++) {
+    address.addr[0] = i;
+    fill_map(&map, i);
+    CHECK(gatt_discovery_cache_store(&address, NULL, &map) == SL_STATUS_OK);
+  }
+  address.addr[0] = 0;
+  CHECK(has_map(&address, NULL, 0));
+  address.addr[0] = GATT_DISCOVERY_CACHE_MAX_ENTRIES;
+  fill_map(&map, GATT_DISCOVERY_CACHE_MAX_ENTRIES);
+  CHECK(gatt_discovery_cache_store(&address, NULL, &map) == SL_STATUS_OK);
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.evictions == 1);
+
+  gatt_discovery_cache_init();
+  address.addr[0] = 1;
+  CHECK(!has_map(&address, NULL, 1));
+  address.addr[0] = 0;
+  CHECK(has_map(&address, NULL, 0));
+  address.addr[0] = GATT_DISCOVERY_CACHE_MAX_ENTRIES;
+  CHECK(has_map(&address, NULL, GATT_DISCOVERY_CACHE_MAX_ENTRIES));
+  address.addr[0] = GATT_DISCOVERY_CACHE_MAX_ENTRIES + 1;
+  fill_map(&map, GATT_DISCOVERY_CACHE_MAX_ENTRIES + 1);
+  CHECK(gatt_discovery_cache_store(&address, NULL, &map) == SL_STATUS_OK);
+  address.addr[0] = 2;
+  CHECK(!has_map(&address, NULL, 2));
+  for (uint8_t i = 3; i < GATT_DISCOVERY_CACHE_MAX_ENTRIES + 2; i++) {
+    address.addr[0] = i;
+    CHECK(has_map(&address, NULL, i));
+  }
+}
+
+// A failed or interrupted store leaves no entry, a lost chunk or another
+// map layout is a miss
+static void test_nvm3_errors(void)
+{
+  gatt_discovery_cache_map_t map;
+  gatt_discovery_cache_stats_t stats;
+  int header;
+
+  erase_nvm3();
+  gatt_discovery_cache_init();
+  fill_map(&map, 1);
+  for (unsigned n = 1; n <= 3; n++) {
+    writes = 0;
+    fail_write = n;
+    CHECK(gatt_discovery_cache_store(&peer, NULL, &map) == SL_STATUS_FAIL);
+    fail_write = 0;
+    CHECK(!has_map(&peer, NULL, 1));
+    gatt_discovery_cache_init();
+    CHECK(!has_map(&peer, NULL, 1));
+  }
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.nvm_errors == 0 && stats.misses == 1);
+
+  CHECK(gatt_discovery_cache_store(&peer, NULL, &map) == SL_STATUS_OK);
+  CHECK(nvm3_deleteObject(nvm3_defaultHandle, GATT_DISCOVERY_CACHE_NVM3_KEY_BASE + 1) == ECODE_NVM3_OK);
+  CHECK(!has_map(&peer, NULL, 1));
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.nvm_errors == 1);
+  gatt_discovery_cache_init();
+  CHECK(!has_map(&peer, NULL, 1));
+
+  CHECK(gatt_discovery_cache_store(&peer, NULL, &map) == SL_STATUS_OK);
+  header = find_object(GATT_DISCOVERY_CACHE_NVM3_KEY_BASE);
+  CHECK(header >= 0);
+  objects[header].data[0] ^= 0x01;
+  gatt_discovery_cache_init();
+  CHECK(!has_map(&peer, NULL, 1));
+}
+
+static void hide_led_2(void)
+{
+  build_database();
+  set_hidden(4, true);
+  set_hidden(5, true);
+  set_hidden(6, true);
+}
+
+// A miss takes a full discovery, a hit none
+static void test_discovery(void)
+{
+  static const uint8_t led_switch[2] = { 0x00, 0x5D };
+  const uint8_t hash[GATT_DISCOVERY_CACHE_HASH_LEN] = { 0x5A };
+  gatt_discovery_cache_map_t map;
+  gatt_discovery_cache_map_t expected;
+  gatt_discovery_cache_map_t cached;
+  gatt_discovery_cache_stats_t stats;
+  unsigned count;
+
+  erase_nvm3();
+  gatt_discovery_cache_init();
+  hide_led_2();
+  CHECK(gatt_discovery_cache_lookup(&peer, hash, &map) == SL_STATUS_NOT_FOUND);
+  CHECK(discover(&map, &count) == SL_STATUS_OK);
+  expected_map(&expected);
+  CHECK(memcmp(&map, &expected, sizeof(map)) == 0);
+  // Primary services, 4 services, Service Changed and LED Switch descriptors
+  CHECK(count == 7);
+  printf("full discovery of 4 services, %u characteristics, %u descriptors: %u procedures\n",
+         map.characteristic_count, map.descriptor_count, count);
+  CHECK(gatt_discovery_cache_find_characteristic(&map, led_switch, sizeof(led_switch)) == 23);
+  CHECK(gatt_discovery_cache_store(&peer, hash, &map) == SL_STATUS_OK);
+
+  gatt_discovery_cache_init();
+  CHECK(gatt_discovery_cache_lookup(&peer, hash, &cached) == SL_STATUS_OK);
+  CHECK(memcmp(&cached, &expected, sizeof(cached)) == 0);
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.procedures == 0 && stats.hits == 1);
+
+  // All 7 services, the second LED Switch characteristic comes first
+  build_database();
+  CHECK(discover(&map, &count) == SL_STATUS_OK);
+  expected_map(&expected);
+  CHECK(memcmp(&map, &expected, sizeof(map)) == 0);
+  CHECK(gatt_discovery_cache_find_characteristic(&map, led_switch, sizeof(led_switch)) == 23);
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.discoveries == 1 && stats.procedures == count);
+}
+
+static void test_discovery_errors(void)
+{
+  gatt_discovery_cache_map_t map;
+  gatt_discovery_cache_map_t other;
+  gatt_discovery_cache_stats_t stats;
+  sl_bt_msg_t evt;
+  unsigned count;
+
+  gatt_discovery_cache_init();
+  build_database();
+
+  // One discovery at a time, the events of none are consumed
+  memset(&evt, 0, sizeof(evt));
+  evt.header = sl_bt_evt_gatt_procedure_completed_id;
+  evt.data.evt_gatt_procedure_completed.connection = CONNECTION;
+  send(&evt, false);
+  done = false;
+  CHECK(gatt_discovery_cache_discover(CONNECTION, &map, on_done) == SL_STATUS_OK);
+  fill_map(&other, 1);
+  CHECK(gatt_discovery_cache_discover(CONNECTION, &other, on_done) == SL_STATUS_BUSY);
+  CHECK(gatt_discovery_cache_rediscover(CONNECTION, &other, 1, 2, on_done) == SL_STATUS_BUSY);
+  CHECK(other.services[0].start == 1 && other.service_count == 1);
+  run();
+  CHECK(done_result == SL_STATUS_OK);
+
+  // A procedure the stack refuses, fails, or a closed connection end it
+  refuse = SL_STATUS_BUSY;
+  CHECK(gatt_discovery_cache_discover(CONNECTION, &map, on_done) == SL_STATUS_BUSY);
+  refuse = SL_STATUS_OK;
+  fail_procedure = procedures + 3;
+  CHECK(discover(&map, &count) == 0x0401 && count == 3);
+  fail_procedure = 0;
+
+  done = false;
+  CHECK(gatt_discovery_cache_discover(CONNECTION, &map, on_done) == SL_STATUS_OK);
+  memset(&evt, 0, sizeof(evt));
+  evt.header = sl_bt_evt_connection_closed_id;
+  evt.data.evt_connection_closed.connection = CONNECTION;
+  evt.data.evt_connection_closed.reason = 0x0208;
+  send(&evt, false);
+  CHECK(done && done_result == 0x0208);
+  pending.procedure = PROCEDURE_NONE;
+
+  CHECK(gatt_discovery_cache_rediscover(CONNECTION, &map, 0, 10, on_done) == SL_STATUS_INVALID_RANGE);
+  CHECK(gatt_discovery_cache_rediscover(CONNECTION, &map, 11, 10, on_done) == SL_STATUS_INVALID_RANGE);
+
+  // More services than a map holds
+  for (uint8_t i = 0; i < GATT_DISCOVERY_CACHE_MAX_SERVICES; i++) {
+    add(ATTRIBUTE_SERVICE, 0x1900 + i, 0);
+  }
+  CHECK(discover(&map, &count) == SL_STATUS_WOULD_OVERFLOW);
+  CHECK(map.service_count == GATT_DISCOVERY_CACHE_MAX_SERVICES);
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.discoveries == 1);
+}
+
+// Toggling the second LED service rediscovers it alone, an empty range
+// only the primary services
+static void test_rediscovery(void)
+{
+  gatt_discovery_cache_map_t map;
+  gatt_discovery_cache_map_t expected;
+  gatt_discovery_cache_stats_t stats;
+  uint16_t start;
+  uint16_t end;
+  unsigned count;
+
+  gatt_discovery_cache_init();
+  hide_led_2();
+  CHECK(discover(&map, &count) == SL_STATUS_OK);
+  set_hidden(4, false);
+  service_range(4, &start, &end);
+  CHECK(rediscover(&map, start, end, &count) == SL_STATUS_OK);
+  expected_map(&expected);
+  CHECK(same_database(&map, &expected));
+  // Primary services, the characteristics of the service and the
+  // descriptors of the second LED Switch characteristic
+  CHECK(count == 3);
+  printf("rediscovery of an added service: %u procedures\n", count);
+
+  set_hidden(4, true);
+  CHECK(rediscover(&map, start, end, &count) == SL_STATUS_OK);
+  expected_map(&expected);
+  CHECK(same_database(&map, &expected));
+  CHECK(count == 1);
+  printf("rediscovery of a removed service: %u procedure\n", count);
+
+  CHECK(rediscover(&map, db_end + 1, 0xFFFF, &count) == SL_STATUS_OK);
+  CHECK(same_database(&map, &expected) && count == 1);
+
+  gatt_discovery_cache_get_stats(&stats);
+  CHECK(stats.discoveries == 1 && stats.rediscoveries == 3);
+}
+
+// Random services toggled at once, the range of a Service Changed
+// indication covering all of them
+static void test_random_rediscovery(void)
+{
+  gatt_discovery_cache_map_t map;
+  gatt_discovery_cache_map_t expected;
+  unsigned full;
+  unsigned count;
+  unsigned total = 0;
+  unsigned total_full = 0;
+  unsigned rounds = 20000;
+
+  srand(7);
+  gatt_discovery_cache_init();
+  build_database();
+  CHECK(discover(&map, &full) == SL_STATUS_OK);
+  for (unsigned round = 0; round < rounds; round++) {
+    int8_t first = (int8_t)(1 + rand() % 6);
+    int8_t last = (int8_t)(first + rand() % 2);
+    uint16_t start;
+    uint16_t end;
+    uint16_t unused;
+
+    if (last > 6) {
+      last = 6;
+    }
+    for (int8_t s = first; s <= last; s++) {
+      if (rand() % 2) {
+        set_hidden(s, !db[service_index(s)].hidden);
+      }
+    }
+    service_range(first, &start, &unused);
+    service_range(last, &unused, &end);
+    CHECK(rediscover(&map, start, end, &count) == SL_STATUS_OK);
+    expected_map(&expected);
+    if (!same_database(&map, &expected)) {
+      printf("round %u: rediscovered map differs from the database\n", round);
+      failures++;
+      break;
+    }
+    CHECK(discover(&expected, &full) == SL_STATUS_OK);
+    CHECK(count <= full);
+    total += count;
+    total_full += full;
+  }
+  printf("%u random rediscoveries: %.2f procedures on average, %.2f for full discoveries\n",
+         rounds, (double)total / rounds, (double)total_full / rounds);
+}
+
+int main(void)
+{
+  test_storage();
+  test_eviction();
+  test_nvm3_errors();
+  test_discovery();
+  test_discovery_errors();
+  test_rediscovery();
+  test_random_rediscovery();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
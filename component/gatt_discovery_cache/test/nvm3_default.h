@@ -0,0 +1,61 @@
+/***************************************************************************//**
+ * @file nvm3_default.h
+ * @brief Host stand-in for the default NVM3 instance of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only what gatt_discovery_cache.c uses, so it builds on a PC without the
+ * Simplicity SDK. The functions are implemented by the test. */
+
+#ifndef NVM3_DEFAULT_H
+#define NVM3_DEFAULT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t Ecode_t;
+typedef uint32_t nvm3_ObjectKey_t;
+
+typedef struct {
+  int unused;
+} nvm3_Handle_t;
+
+#define ECODE_NVM3_OK                 ((Ecode_t)0)
+#define ECODE_NVM3_ERR_KEY_NOT_FOUND  ((Ecode_t)0xF00E)
+#define ECODE_NVM3_ERR_WRITE_FAILED   ((Ecode_t)0xF010)
+
+extern nvm3_Handle_t *nvm3_defaultHandle;
+
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                      void *value, size_t maxLen);
+
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key,
+                       const void *value, size_t len);
+
+Ecode_t nvm3_deleteObject(nvm3_Handle_t *h, nvm3_ObjectKey_t key);
+
+#endif // NVM3_DEFAULT_H
@@ -0,0 +1,114 @@
+/***************************************************************************//**
+ * @file sl_bluetooth.h
+ * @brief Host stand-in for the Bluetooth API of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only what gatt_discovery_cache.c uses, so it builds on a PC without the
+ * Simplicity SDK. The commands are implemented by the test. */
+
+#ifndef SL_BLUETOOTH_H
+#define SL_BLUETOOTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                  ((sl_status_t)0x0000)
+#define SL_STATUS_FAIL                ((sl_status_t)0x0001)
+#define SL_STATUS_BUSY                ((sl_status_t)0x0004)
+#define SL_STATUS_NOT_FOUND           ((sl_status_t)0x000C)
+#define SL_STATUS_WOULD_OVERFLOW      ((sl_status_t)0x001D)
+#define SL_STATUS_INVALID_RANGE       ((sl_status_t)0x0028)
+
+#define SL_BT_MSG_ID(header)          ((header) & 0xffff00f8)
+
+#define sl_bt_evt_connection_closed_id              0x010600a0
+#define sl_bt_evt_gatt_service_id                   0x010900a0
+#define sl_bt_evt_gatt_characteristic_id            0x020900a0
+#define sl_bt_evt_gatt_descriptor_id                0x030900a0
+#define sl_bt_evt_gatt_procedure_completed_id       0x060900a0
+
+typedef struct {
+  uint8_t addr[6];
+} bd_addr;
+
+typedef struct {
+  uint8_t len;
+  uint8_t data[255];
+} uint8array;
+
+typedef struct {
+  uint16_t reason;
+  uint8_t connection;
+} sl_bt_evt_connection_closed_t;
+
+typedef struct {
+  uint8_t connection;
+  uint32_t service;
+  uint8array uuid;
+} sl_bt_evt_gatt_service_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t characteristic;
+  uint8_t properties;
+  uint8array uuid;
+} sl_bt_evt_gatt_characteristic_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t descriptor;
+  uint8array uuid;
+} sl_bt_evt_gatt_descriptor_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t result;
+} sl_bt_evt_gatt_procedure_completed_t;
+
+typedef struct {
+  uint32_t header;
+  union {
+    sl_bt_evt_connection_closed_t evt_connection_closed;
+    sl_bt_evt_gatt_service_t evt_gatt_service;
+    sl_bt_evt_gatt_characteristic_t evt_gatt_characteristic;
+    sl_bt_evt_gatt_descriptor_t evt_gatt_descriptor;
+    sl_bt_evt_gatt_procedure_completed_t evt_gatt_procedure_completed;
+  } data;
+} sl_bt_msg_t;
+
+sl_status_t sl_bt_gatt_discover_primary_services(uint8_t connection);
+
+sl_status_t sl_bt_gatt_discover_characteristics(uint8_t connection,
+                                                uint32_t service);
+
+sl_status_t sl_bt_gatt_discover_descriptors(uint8_t connection,
+                                            uint16_t characteristic);
+
+#endif // SL_BLUETOOTH_H
@@ -0,0 +1,136 @@
+/***************************************************************************//**
+ * @file gatt_user_read.h
+ * @brief Offset-correct reads of user-type characteristics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef GATT_USER_READ_H
+#define GATT_USER_READ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Number of user-type characteristics that can be served.
+#ifndef GATT_USER_READ_MAX_CHARACTERISTICS
+#define GATT_USER_READ_MAX_CHARACTERISTICS  8
+#endif
+
+// Number of connections tracked.
+#ifndef GATT_USER_READ_MAX_CONNECTIONS
+#ifdef SL_BT_CONFIG_MAX_CONNECTIONS
+#define GATT_USER_READ_MAX_CONNECTIONS      SL_BT_CONFIG_MAX_CONNECTIONS
+#else
+#define GATT_USER_READ_MAX_CONNECTIONS      4
+#endif
+#endif
+
+// Limit of the Bluetooth specification.
+#define GATT_USER_READ_MAX_VALUE_LEN        512
+
+// ATT errors returned to the client.
+#define GATT_USER_READ_ATT_INVALID_OFFSET   0x07
+#define GATT_USER_READ_ATT_UNLIKELY_ERROR   0x0E
+
+/***************************************************************************//**
+ * @brief Provide the value of a characteristic to a connection
+ *
+ * Called when the connection starts reading the value, at offset 0. The
+ * returned value is sent as is, without being copied, so it must stay
+ * unchanged until the callback is called again for the same connection and
+ * characteristic, or the connection is closed. Every part of a long read
+ * comes from it.
+ *
+ * @param[in] connection Connection handle
+ * @param[in] characteristic Characteristic handle
+ * @param[out] len Length of the value, at most GATT_USER_READ_MAX_VALUE_LEN
+ *
+ * @return Value, or NULL to reject the read
+ ******************************************************************************/
+typedef const uint8_t *(*gatt_user_read_callback_t)(uint8_t connection,
+                                                    uint16_t characteristic,
+                                                    uint16_t *len);
+
+/***************************************************************************//**
+ * @brief Read statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t reads;           // Requests at offset 0
+  uint32_t blob_reads;      // Requests at a non-zero offset
+  uint32_t restarts;        // Reads at an offset other than the expected one
+  uint32_t bytes;           // Value bytes sent
+  uint32_t errors;          // Requests answered with an ATT error
+  uint32_t failures;        // Responses the stack did not accept
+} gatt_user_read_stats_t;
+
+void sli_gatt_user_read_init(void);
+void sli_gatt_user_read_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Serve a characteristic from a buffer, or change the buffer of a served
+ * characteristic. The buffer is not copied: it must stay valid, and its
+ * content unchanged while a client reads it.
+ *
+ * @param[in] characteristic Characteristic handle
+ * @param[in] buffer Value
+ * @param[in] len Length of the value, at most GATT_USER_READ_MAX_VALUE_LEN
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_INVALID_PARAMETER if @p len
+ *         is too long, SL_STATUS_NO_MORE_RESOURCE if
+ *         GATT_USER_READ_MAX_CHARACTERISTICS characteristics are served.
+ *
+ ******************************************************************************/
+sl_status_t gatt_user_read_add_buffer(uint16_t characteristic,
+                                      const uint8_t *buffer,
+                                      uint16_t len);
+
+/***************************************************************************//**
+ *
+ * Serve a characteristic from a callback, or change the callback of a
+ * served characteristic.
+ *
+ * @param[in] characteristic Characteristic handle
+ * @param[in] callback Function providing the value
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NO_MORE_RESOURCE if
+ *         GATT_USER_READ_MAX_CHARACTERISTICS characteristics are served.
+ *
+ ******************************************************************************/
+sl_status_t gatt_user_read_add_callback(uint16_t characteristic,
+                                        gatt_user_read_callback_t callback);
+
+/***************************************************************************//**
+ *
+ * Retrieve the read statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void gatt_user_read_get_stats(gatt_user_read_stats_t *stats);
+
+#endif // GATT_USER_READ_H
@@ -0,0 +1,277 @@
+/***************************************************************************//**
+ * @file gatt_user_read.c
+ * @brief Offset-correct reads of user-type characteristics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "gatt_user_read.h"
+
+#define ATT_DEFAULT_MTU           23
+// A Read or Read Blob response carries the opcode besides the value, a
+// Read By Type response also the attribute handle and the pair length.
+#define READ_RESPONSE_OVERHEAD    1
+#define READ_BY_TYPE_OVERHEAD     4
+
+typedef struct {
+  uint16_t characteristic;          // 0 if the slot is free
+  const uint8_t *buffer;
+  uint16_t len;
+  gatt_user_read_callback_t callback;
+} characteristic_t;
+
+// Value a connection is reading from a characteristic
+typedef struct {
+  const uint8_t *value;             // NULL until read at offset 0
+  uint16_t len;
+  uint16_t next_offset;
+} read_t;
+
+typedef struct {
+  bool used;
+  uint8_t connection;
+  uint16_t mtu;
+  read_t reads[GATT_USER_READ_MAX_CHARACTERISTICS];
+} connection_t;
+
+static characteristic_t characteristics[GATT_USER_READ_MAX_CHARACTERISTICS];
+static connection_t connections[GATT_USER_READ_MAX_CONNECTIONS];
+static gatt_user_read_stats_t stats;
+
+static characteristic_t *find_characteristic(uint16_t characteristic)
+{
+  for (uint8_t i = 0; i < GATT_USER_READ_MAX_CHARACTERISTICS; i++) {
+    if (characteristics[i].characteristic == characteristic) {
+      return &characteristics[i];
+    }
+  }
+  return NULL;
+}
+
+static characteristic_t *add_characteristic(uint16_t characteristic)
+{
+  characteristic_t *c = find_characteristic(characteristic);
+
+  if (c == NULL) {
+    c = find_characteristic(0);
+  }
+  if (c != NULL) {
+    memset(c, 0, sizeof(*c));
+    c->characteristic = characteristic;
+    // A new value source invalidates the values being read
+    for (uint8_t i = 0; i < GATT_USER_READ_MAX_CONNECTIONS; i++) {
+      connections[i].reads[c - characteristics].value = NULL;
+    }
+  }
+  return c;
+}
+
+static connection_t *find_connection(uint8_t connection)
+{
+  for (uint8_t i = 0; i < GATT_USER_READ_MAX_CONNECTIONS; i++) {
+    if (connections[i].used && connections[i].connection == connection) {
+      return &connections[i];
+    }
+  }
+  return NULL;
+}
+
+static connection_t *open_connection(uint8_t connection)
+{
+  connection_t *c = find_connection(connection);
+
+  for (uint8_t i = 0; c == NULL && i < GATT_USER_READ_MAX_CONNECTIONS; i++) {
+    if (!connections[i].used) {
+      c = &connections[i];
+    }
+  }
+  if (c != NULL) {
+    memset(c, 0, sizeof(*c));
+    c->used = true;
+    c->connection = connection;
+    c->mtu = ATT_DEFAULT_MTU;
+  }
+  return c;
+}
+
+static void on_read_request(const sl_bt_evt_gatt_server_user_read_request_t *request,
+                            characteristic_t *c)
+{
+  connection_t *conn = find_connection(request->connection);
+  connection_t untracked;
+  read_t *read;
+  uint8_t error = 0;
+  const uint8_t *value = NULL;
+  uint16_t len = 0;
+  uint16_t max_len;
+  uint16_t mtu;
+  uint16_t sent_len = 0;
+
+  // A connection not tracked when it opened, beyond
+  // GATT_USER_READ_MAX_CONNECTIONS
+  if (conn == NULL) {
+    conn = open_connection(request->connection);
+    if (conn == NULL) {
+      conn = &untracked;
+      memset(conn, 0, sizeof(*conn));
+      conn->mtu = ATT_DEFAULT_MTU;
+    }
+    if (sl_bt_gatt_server_get_mtu(request->connection, &mtu) == SL_STATUS_OK
+        && mtu >= ATT_DEFAULT_MTU) {
+      conn->mtu = mtu;
+    }
+  }
+  read = &conn->reads[c - characteristics];
+
+  if (request->offset == 0) {
+    stats.reads++;
+  } else {
+    stats.blob_reads++;
+  }
+  if (request->offset == 0 || read->value == NULL) {
+    if (request->offset != 0) {
+      stats.restarts++;
+    }
+    if (c->callback != NULL) {
+      read->value = c->callback(request->connection, request->characteristic, &read->len);
+    } else {
+      read->value = c->buffer;
+      read->len = c->len;
+    }
+  } else if (request->offset != read->next_offset) {
+    stats.restarts++;
+  }
+
+  if (read->value == NULL || read->len > GATT_USER_READ_MAX_VALUE_LEN) {
+    read->value = NULL;
+    error = GATT_USER_READ_ATT_UNLIKELY_ERROR;
+  } else if (request->offset > read->len) {
+    error = GATT_USER_READ_ATT_INVALID_OFFSET;
+  } else {
+    max_len = conn->mtu - ((request->att_opcode == sl_bt_gatt_read_by_type_request)
+                           ? READ_BY_TYPE_OVERHEAD : READ_RESPONSE_OVERHEAD);
+    value = &read->value[request->offset];
+    len = read->len - request->offset;
+    if (len > max_len) {
+      len = max_len;
+    }
+  }
+
+  if (sl_bt_gatt_server_send_user_read_response(request->connection,
+                                                request->characteristic,
+                                                error,
+                                                len,
+                                                value,
+                                                &sent_len) != SL_STATUS_OK) {
+    stats.failures++;
+    return;
+  }
+  if (error != 0) {
+    stats.errors++;
+    return;
+  }
+  read->next_offset = request->offset + sent_len;
+  stats.bytes += sent_len;
+}
+
+void sli_gatt_user_read_init(void)
+{
+  memset(characteristics, 0, sizeof(characteristics));
+  memset(connections, 0, sizeof(connections));
+  memset(&stats, 0, sizeof(stats));
+}
+
+sl_status_t gatt_user_read_add_buffer(uint16_t characteristic,
+                                      const uint8_t *buffer,
+                                      uint16_t len)
+{
+  characteristic_t *c;
+
+  if (len > GATT_USER_READ_MAX_VALUE_LEN) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  c = add_characteristic(characteristic);
+  if (c == NULL) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  c->buffer = buffer;
+  c->len = len;
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_user_read_add_callback(uint16_t characteristic,
+                                        gatt_user_read_callback_t callback)
+{
+  characteristic_t *c = add_characteristic(characteristic);
+
+  if (c == NULL) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  c->callback = callback;
+  return SL_STATUS_OK;
+}
+
+void sli_gatt_user_read_on_event(sl_bt_msg_t *evt)
+{
+  connection_t *conn;
+  characteristic_t *c;
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_connection_opened_id:
+      (void)open_connection(evt->data.evt_connection_opened.connection);
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      conn = find_connection(evt->data.evt_connection_closed.connection);
+      if (conn != NULL) {
+        conn->used = false;
+      }
+      break;
+
+    case sl_bt_evt_gatt_mtu_exchanged_id:
+      conn = find_connection(evt->data.evt_gatt_mtu_exchanged.connection);
+      if (conn != NULL) {
+        conn->mtu = evt->data.evt_gatt_mtu_exchanged.mtu;
+      }
+      break;
+
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      c = find_characteristic(evt->data.evt_gatt_server_user_read_request.characteristic);
+      if (c != NULL && c->characteristic != 0) {
+        on_read_request(&evt->data.evt_gatt_server_user_read_request, c);
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void gatt_user_read_get_stats(gatt_user_read_stats_t *out)
+{
+  *out = stats;
+}
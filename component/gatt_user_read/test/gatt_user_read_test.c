@@ -0,0 +1,427 @@
+/***************************************************************************//**
+ * @file gatt_user_read_test.c
+ * @brief Host test of the offset-correct user reads.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Plays GATT clients against gatt_user_read.c, with the stack replaced by
+ * the functions below: long reads of every value length from 0 to 512 bytes
+ * at every ATT MTU from 23 to 247, Read By Type, offsets past the end,
+ * concurrent readers of a changing value, retried and restarted blobs, and
+ * failures. Build and run on a PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I. -I../inc gatt_user_read_test.c ../src/gatt_user_read.c -o gatt_user_read_test
+ *   ./gatt_user_read_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "gatt_user_read.h"
+
+#define CHARACTERISTIC        0x0020
+#define CALLBACK_CHARACTERISTIC 0x0030
+#define ATT_MIN_MTU           23
+#define ATT_MAX_MTU           247
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+// ---------------------------------------------------------------------------
+// Stack
+
+// Last response sent, and the ATT MTU the stack knows for each connection
+static struct {
+  uint8_t error;
+  uint16_t len;
+  uint8_t data[GATT_USER_READ_MAX_VALUE_LEN];
+} response;
+static uint32_t response_calls;   // Calls of the response command
+static uint16_t stack_mtu[8];
+static uint16_t response_limit;   // Longest response the stack accepts
+static bool stack_fails = false;
+
+sl_status_t sl_bt_gatt_server_get_mtu(uint8_t connection, uint16_t *mtu)
+{
+  *mtu = stack_mtu[connection];
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_send_user_read_response(uint8_t connection,
+                                                      uint16_t characteristic,
+                                                      uint8_t att_errorcode,
+                                                      size_t value_len,
+                                                      const uint8_t *value,
+                                                      uint16_t *sent_len)
+{
+  (void)connection;
+  (void)characteristic;
+  response_calls++;
+  if (stack_fails || value_len > response_limit) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  response.error = att_errorcode;
+  response.len = (uint16_t)value_len;
+  if (value_len > 0) {
+    memcpy(response.data, value, value_len);
+  }
+  *sent_len = (uint16_t)value_len;
+  return SL_STATUS_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Client
+
+static void open_connection(uint8_t connection, uint16_t mtu)
+{
+  sl_bt_msg_t evt;
+
+  evt.header = sl_bt_evt_connection_opened_id;
+  evt.data.evt_connection_opened.connection = connection;
+  sli_gatt_user_read_on_event(&evt);
+  stack_mtu[connection] = mtu;
+  if (mtu != ATT_MIN_MTU) {
+    evt.header = sl_bt_evt_gatt_mtu_exchanged_id;
+    evt.data.evt_gatt_mtu_exchanged.connection = connection;
+    evt.data.evt_gatt_mtu_exchanged.mtu = mtu;
+    sli_gatt_user_read_on_event(&evt);
+  }
+}
+
+static void close_connection(uint8_t connection)
+{
+  sl_bt_msg_t evt;
+
+  evt.header = sl_bt_evt_connection_closed_id;
+  evt.data.evt_connection_closed.connection = connection;
+  evt.data.evt_connection_closed.reason = 0;
+  sli_gatt_user_read_on_event(&evt);
+}
+
+// Send one request, return true if it was answered
+static bool request(uint8_t connection, uint16_t characteristic,
+                    uint8_t opcode, uint16_t offset)
+{
+  sl_bt_msg_t evt;
+  uint32_t calls = response_calls;
+
+  response.error = 0xFF;
+  response.len = 0;
+  evt.header = sl_bt_evt_gatt_server_user_read_request_id;
+  evt.data.evt_gatt_server_user_read_request.connection = connection;
+  evt.data.evt_gatt_server_user_read_request.characteristic = characteristic;
+  evt.data.evt_gatt_server_user_read_request.att_opcode = opcode;
+  evt.data.evt_gatt_server_user_read_request.offset = offset;
+  sli_gatt_user_read_on_event(&evt);
+  return response_calls != calls;
+}
+
+// Continue a long read from *len, as a client does: a part as long as the
+// response can carry is followed by a Read Blob at the next offset.
+// Returns false on an ATT error.
+static bool read_parts(uint8_t connection, uint16_t characteristic, uint16_t mtu,
+                       uint8_t *value, uint16_t *len, uint16_t max_parts)
+{
+  for (uint16_t part = 0; part < max_parts; part++) {
+    request(connection, characteristic,
+            (*len == 0) ? sl_bt_gatt_read_request : sl_bt_gatt_read_blob_request,
+            *len);
+    if (response.error != 0) {
+      return false;
+    }
+    memcpy(&value[*len], response.data, response.len);
+    *len += response.len;
+    if (response.len < mtu - 1) {
+      break;
+    }
+  }
+  return true;
+}
+
+static bool long_read(uint8_t connection, uint16_t characteristic, uint16_t mtu,
+                      uint8_t *value, uint16_t *len)
+{
+  *len = 0;
+  return read_parts(connection, characteristic, mtu, value, len, UINT16_MAX);
+}
+
+// ---------------------------------------------------------------------------
+// Values
+
+static uint8_t buffer[GATT_USER_READ_MAX_VALUE_LEN + 1];
+
+static void fill(uint8_t *value, uint16_t len, uint8_t seed)
+{
+  for (uint16_t i = 0; i < len; i++) {
+    value[i] = (uint8_t)(i * 7 + seed + (i >> 8));
+  }
+}
+
+// Callback value: a new version each time a read starts at offset 0
+static uint8_t versions[4][GATT_USER_READ_MAX_VALUE_LEN + 1];
+static uint16_t version_len = 300;
+static uint8_t version_count = 0;
+static bool callback_rejects = false;
+
+static const uint8_t *provide_value(uint8_t connection, uint16_t characteristic,
+                                    uint16_t *len)
+{
+  (void)connection;
+  (void)characteristic;
+  if (callback_rejects) {
+    return NULL;
+  }
+  *len = version_len;
+  return versions[version_count++ % 4];
+}
+
+static void reset(void)
+{
+  sli_gatt_user_read_init();
+  memset(stack_mtu, 0, sizeof(stack_mtu));
+  response_limit = ATT_MAX_MTU;
+  stack_fails = false;
+  callback_rejects = false;
+  version_len = 300;
+  version_count = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    fill(versions[i], sizeof(versions[i]), (uint8_t)(0x40 * i + 1));
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+
+// Every value length at every MTU, read back whole by a long read
+static void test_lengths_and_mtus(void)
+{
+  static uint8_t value[GATT_USER_READ_MAX_VALUE_LEN];
+  unsigned reads = 0;
+  uint16_t len;
+
+  reset();
+  for (uint16_t mtu = ATT_MIN_MTU; mtu <= ATT_MAX_MTU; mtu++) {
+    open_connection(1, mtu);
+    response_limit = mtu - 1;
+    for (uint16_t value_len = 0; value_len <= GATT_USER_READ_MAX_VALUE_LEN; value_len++) {
+      fill(buffer, value_len, (uint8_t)mtu);
+      CHECK(gatt_user_read_add_buffer(CHARACTERISTIC, buffer, value_len) == SL_STATUS_OK);
+      if (!long_read(1, CHARACTERISTIC, mtu, value, &len)
+          || len != value_len || memcmp(value, buffer, len) != 0) {
+        printf("long read of %u bytes at MTU %u failed\n", value_len, mtu);
+        failures++;
+      }
+      reads++;
+    }
+    close_connection(1);
+  }
+  printf("%u long reads, every length 0..%u at every MTU %u..%u\n",
+         reads, GATT_USER_READ_MAX_VALUE_LEN, ATT_MIN_MTU, ATT_MAX_MTU);
+}
+
+// A Read By Type response also carries a handle and a length
+static void test_read_by_type(void)
+{
+  reset();
+  fill(buffer, 100, 3);
+  (void)gatt_user_read_add_buffer(CHARACTERISTIC, buffer, 100);
+  for (uint16_t mtu = ATT_MIN_MTU; mtu <= ATT_MAX_MTU; mtu++) {
+    open_connection(2, mtu);
+    response_limit = mtu - 4;
+    CHECK(request(2, CHARACTERISTIC, sl_bt_gatt_read_by_type_request, 0));
+    CHECK(response.error == 0);
+    CHECK(response.len == ((mtu - 4 < 100) ? mtu - 4 : 100));
+    CHECK(memcmp(response.data, buffer, response.len) == 0);
+    close_connection(2);
+  }
+}
+
+// The end of the value is a valid offset, past it is not
+static void test_offsets(void)
+{
+  reset();
+  open_connection(1, ATT_MIN_MTU);
+  fill(buffer, 40, 5);
+  (void)gatt_user_read_add_buffer(CHARACTERISTIC, buffer, 40);
+  request(1, CHARACTERISTIC, sl_bt_gatt_read_request, 0);
+  request(1, CHARACTERISTIC, sl_bt_gatt_read_blob_request, 40);
+  CHECK(response.error == 0 && response.len == 0);
+  request(1, CHARACTERISTIC, sl_bt_gatt_read_blob_request, 41);
+  CHECK(response.error == GATT_USER_READ_ATT_INVALID_OFFSET);
+  request(1, CHARACTERISTIC, sl_bt_gatt_read_blob_request, 600);
+  CHECK(response.error == GATT_USER_READ_ATT_INVALID_OFFSET);
+
+  // Unknown characteristics are left to the application
+  CHECK(!request(1, 0x0099, sl_bt_gatt_read_request, 0));
+}
+
+// Readers of a value that changes with every read keep the version they
+// started with, and a retried or repeated blob gets the same bytes
+static void test_concurrent_readers(void)
+{
+  static uint8_t a[GATT_USER_READ_MAX_VALUE_LEN];
+  static uint8_t b[GATT_USER_READ_MAX_VALUE_LEN];
+  uint16_t a_len = 0;
+  uint16_t b_len = 0;
+  gatt_user_read_stats_t stats;
+  uint8_t retried[ATT_MIN_MTU];
+
+  reset();
+  (void)gatt_user_read_add_callback(CALLBACK_CHARACTERISTIC, provide_value);
+  open_connection(1, ATT_MIN_MTU);
+  open_connection(2, 100);
+
+  // A starts, B starts and reads half, A reads all, B finishes
+  CHECK(read_parts(1, CALLBACK_CHARACTERISTIC, ATT_MIN_MTU, a, &a_len, 2));
+  CHECK(read_parts(2, CALLBACK_CHARACTERISTIC, 100, b, &b_len, 2));
+  CHECK(read_parts(1, CALLBACK_CHARACTERISTIC, ATT_MIN_MTU, a, &a_len, UINT16_MAX));
+
+  // Retry the last blob of B twice
+  request(2, CALLBACK_CHARACTERISTIC, sl_bt_gatt_read_blob_request, b_len - 99);
+  memcpy(retried, response.data, sizeof(retried));
+  request(2, CALLBACK_CHARACTERISTIC, sl_bt_gatt_read_blob_request, b_len - 99);
+  CHECK(memcmp(retried, response.data, sizeof(retried)) == 0);
+  CHECK(read_parts(2, CALLBACK_CHARACTERISTIC, 100, b, &b_len, UINT16_MAX));
+
+  CHECK(a_len == version_len && memcmp(a, versions[0], a_len) == 0);
+  CHECK(b_len == version_len && memcmp(b, versions[1], b_len) == 0);
+  CHECK(version_count == 2);
+  gatt_user_read_get_stats(&stats);
+  CHECK(stats.reads == 2);
+  CHECK(stats.restarts == 2);
+
+  // A new read at offset 0 takes a new version
+  CHECK(long_read(1, CALLBACK_CHARACTERISTIC, ATT_MIN_MTU, a, &a_len));
+  CHECK(a_len == version_len && memcmp(a, versions[2], a_len) == 0);
+}
+
+// A blob with no read started, or after the value source changed, starts
+// the read over from the current value
+static void test_restarts(void)
+{
+  static uint8_t other[64];
+  gatt_user_read_stats_t stats;
+
+  reset();
+  open_connection(1, ATT_MIN_MTU);
+  fill(buffer, 64, 9);
+  fill(other, 64, 77);
+  (void)gatt_user_read_add_buffer(CHARACTERISTIC, buffer, 64);
+
+  request(1, CHARACTERISTIC, sl_bt_gatt_read_blob_request, 22);
+  CHECK(response.error == 0 && response.len == 22);
+  CHECK(memcmp(response.data, &buffer[22], 22) == 0);
+
+  request(1, CHARACTERISTIC, sl_bt_gatt_read_request, 0);
+  (void)gatt_user_read_add_buffer(CHARACTERISTIC, other, 64);
+  request(1, CHARACTERISTIC, sl_bt_gatt_read_blob_request, 22);
+  CHECK(memcmp(response.data, &other[22], 22) == 0);
+  gatt_user_read_get_stats(&stats);
+  CHECK(stats.restarts == 2);
+}
+
+// A connection not seen opening uses the MTU of the stack,
+// and a closed connection forgets its MTU
+static void test_connections(void)
+{
+  reset();
+  fill(buffer, 300, 11);
+  (void)gatt_user_read_add_buffer(CHARACTERISTIC, buffer, 300);
+
+  stack_mtu[3] = 150;
+  request(3, CHARACTERISTIC, sl_bt_gatt_read_request, 0);
+  CHECK(response.error == 0 && response.len == 149);
+
+  open_connection(4, 200);
+  close_connection(4);
+  open_connection(4, ATT_MIN_MTU);
+  request(4, CHARACTERISTIC, sl_bt_gatt_read_request, 0);
+  CHECK(response.error == 0 && response.len == ATT_MIN_MTU - 1);
+}
+
+// Values that cannot be served, and responses the stack refuses
+static void test_errors(void)
+{
+  gatt_user_read_stats_t stats;
+
+  reset();
+  open_connection(1, ATT_MIN_MTU);
+  CHECK(gatt_user_read_add_buffer(CHARACTERISTIC, buffer,
+                                  GATT_USER_READ_MAX_VALUE_LEN + 1)
+        == SL_STATUS_INVALID_PARAMETER);
+
+  (void)gatt_user_read_add_callback(CALLBACK_CHARACTERISTIC, provide_value);
+  callback_rejects = true;
+  request(1, CALLBACK_CHARACTERISTIC, sl_bt_gatt_read_request, 0);
+  CHECK(response.error == GATT_USER_READ_ATT_UNLIKELY_ERROR);
+  callback_rejects = false;
+  version_len = GATT_USER_READ_MAX_VALUE_LEN + 1;
+  request(1, CALLBACK_CHARACTERISTIC, sl_bt_gatt_read_request, 0);
+  CHECK(response.error == GATT_USER_READ_ATT_UNLIKELY_ERROR);
+
+  version_len = 10;
+  stack_fails = true;
+  request(1, CALLBACK_CHARACTERISTIC, sl_bt_gatt_read_request, 0);
+  gatt_user_read_get_stats(&stats);
+  CHECK(stats.errors == 2);
+  CHECK(stats.failures == 1);
+
+  // Table full
+  reset();
+  for (uint16_t i = 0; i < GATT_USER_READ_MAX_CHARACTERISTICS; i++) {
+    CHECK(gatt_user_read_add_buffer((uint16_t)(0x100 + i), buffer, 1) == SL_STATUS_OK);
+  }
+  CHECK(gatt_user_read_add_buffer(0x200, buffer, 1) == SL_STATUS_NO_MORE_RESOURCE);
+  CHECK(gatt_user_read_add_buffer(0x100, buffer, 2) == SL_STATUS_OK);
+}
+
+int main(void)
+{
+  test_lengths_and_mtus();
+  test_read_by_type();
+  test_offsets();
+  test_concurrent_readers();
+  test_restarts();
+  test_connections();
+  test_errors();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
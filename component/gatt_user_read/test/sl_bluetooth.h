@@ -0,0 +1,101 @@
+/***************************************************************************//**
+ * @file sl_bluetooth.h
+ * @brief Host stand-in for the Bluetooth API of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Only what gatt_user_read.c uses, so it builds on a PC without the
+ * Simplicity SDK. The commands are implemented by the test. */
+
+#ifndef SL_BLUETOOTH_H
+#define SL_BLUETOOTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                  ((sl_status_t)0x0000)
+#define SL_STATUS_FAIL                ((sl_status_t)0x0001)
+#define SL_STATUS_BUSY                ((sl_status_t)0x0004)
+#define SL_STATUS_INVALID_PARAMETER   ((sl_status_t)0x0021)
+#define SL_STATUS_NO_MORE_RESOURCE    ((sl_status_t)0x0019)
+
+#define SL_BT_MSG_ID(header)          ((header) & 0xffff00f8)
+
+#define sl_bt_evt_connection_opened_id              0x000600a0
+#define sl_bt_evt_connection_closed_id              0x010600a0
+#define sl_bt_evt_gatt_mtu_exchanged_id             0x000900a0
+#define sl_bt_evt_gatt_server_user_read_request_id  0x010a00a0
+
+typedef enum {
+  sl_bt_gatt_read_by_type_request = 0x08,
+  sl_bt_gatt_read_request         = 0x0a,
+  sl_bt_gatt_read_blob_request    = 0x0c
+} sl_bt_gatt_att_opcode_t;
+
+typedef struct {
+  uint8_t connection;
+} sl_bt_evt_connection_opened_t;
+
+typedef struct {
+  uint16_t reason;
+  uint8_t connection;
+} sl_bt_evt_connection_closed_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t mtu;
+} sl_bt_evt_gatt_mtu_exchanged_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t characteristic;
+  uint8_t att_opcode;
+  uint16_t offset;
+} sl_bt_evt_gatt_server_user_read_request_t;
+
+typedef struct {
+  uint32_t header;
+  union {
+    sl_bt_evt_connection_opened_t evt_connection_opened;
+    sl_bt_evt_connection_closed_t evt_connection_closed;
+    sl_bt_evt_gatt_mtu_exchanged_t evt_gatt_mtu_exchanged;
+    sl_bt_evt_gatt_server_user_read_request_t evt_gatt_server_user_read_request;
+  } data;
+} sl_bt_msg_t;
+
+sl_status_t sl_bt_gatt_server_get_mtu(uint8_t connection, uint16_t *mtu);
+
+sl_status_t sl_bt_gatt_server_send_user_read_response(uint8_t connection,
+                                                      uint16_t characteristic,
+                                                      uint8_t att_errorcode,
+                                                      size_t value_len,
+                                                      const uint8_t *value,
+                                                      uint16_t *sent_len);
+
+#endif // SL_BLUETOOTH_H
@@ -0,0 +1,83 @@
+/***************************************************************************//**
+ * @file
+ * @brief Periodic Advertising Sync Manager configuration
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef SYNC_MANAGER_CONFIG_H
+#define SYNC_MANAGER_CONFIG_H
+
+// <<< Use Configuration Wizard in Context Menu >>>
+
+// <h> Sync Manager
+
+// <o SYNC_MANAGER_MAX_SYNCS> Number of managed trains <1..64>
+// <i> Periodic advertising trains that can be managed concurrently. Should
+// <i> not exceed the maximum number of periodic advertising syncs of the stack.
+// <i> Default: 4
+#define SYNC_MANAGER_MAX_SYNCS          4
+
+// <o SYNC_MANAGER_WINDOW> Estimation window <2..255>
+// <i> Number of received reports the data change rate is estimated over
+// <i> before the skip is reconsidered.
+// <i> Default: 8
+#define SYNC_MANAGER_WINDOW             8
+
+// <o SYNC_MANAGER_TIMEOUT_EVENTS> Listened events per sync timeout <2..255>
+// <i> The sync timeout covers this many listened events, so that a few
+// <i> missed packets in a row do not lose the sync.
+// <i> Default: 6
+#define SYNC_MANAGER_TIMEOUT_EVENTS     6
+
+// <o SYNC_MANAGER_OPEN_TIMEOUT_MS> Sync establishment timeout [ms] <100..60000>
+// <i> Time allowed to (re)establish a sync.
+// <i> Default: 10000
+#define SYNC_MANAGER_OPEN_TIMEOUT_MS    10000
+
+// <o SYNC_MANAGER_OPEN_ATTEMPTS> Sync establishment attempts <1..255>
+// <i> Attempts to (re)establish a sync before the train is given up and
+// <i> reported as lost.
+// <i> Default: 3
+#define SYNC_MANAGER_OPEN_ATTEMPTS      3
+
+// <o SYNC_MANAGER_EVENT_OVERHEAD_US> Event overhead [us] <0..10000>
+// <i> Estimated radio-on time of a listened periodic event besides the
+// <i> packet itself: receive window widening, ramp-up and packet overhead.
+// <i> Default: 500
+#define SYNC_MANAGER_EVENT_OVERHEAD_US  500
+
+// <o SYNC_MANAGER_SIGNAL> External signal <f.h>
+// <i> External signal used by the establishment timeout. Must not collide
+// <i> with the signals of the application.
+// <i> Default: 0x40
+#define SYNC_MANAGER_SIGNAL             0x40
+
+// </h>
+
+// <<< end of configuration section >>>
+
+#endif // SYNC_MANAGER_CONFIG_H
@@ -0,0 +1,169 @@
+/***************************************************************************//**
+ * @file
+ * @brief Periodic Advertising Sync Manager
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef SYNC_MANAGER_H
+#define SYNC_MANAGER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+#include "sync_manager_config.h"
+
+// Limits of the Bluetooth specification.
+#define SYNC_MANAGER_MAX_SKIP           0x01F3
+#define SYNC_MANAGER_MAX_TIMEOUT_MS     163840
+
+/***************************************************************************//**
+ * @brief Called when a train is given up after SYNC_MANAGER_OPEN_ATTEMPTS
+ *        failed attempts to (re)establish its sync
+ ******************************************************************************/
+typedef void (*sync_manager_lost_callback_t)(const bd_addr *address,
+                                             uint8_t sid);
+
+/***************************************************************************//**
+ * @brief Current settings of a managed sync
+ ******************************************************************************/
+typedef struct {
+  uint16_t skip;            // Periodic events skipped between listened ones
+  uint32_t timeout_ms;      // Sync timeout
+  uint32_t interval_ms;     // Periodic advertising interval
+  uint32_t change_ms;       // Estimated data change period, 0 if unchanged
+} sync_manager_sync_info_t;
+
+/***************************************************************************//**
+ * @brief Statistics of all managed syncs
+ ******************************************************************************/
+typedef struct {
+  uint32_t events_received;   // Reports passed to sync_manager_report()
+  uint32_t events_skipped;    // Periodic events not listened to
+  uint32_t changes;           // Received reports with new data
+  uint32_t retunes;           // Syncs reopened with a new skip
+  uint32_t losses;            // Syncs lost
+  uint32_t lost;              // Trains given up
+  uint32_t radio_saved_ms;    // Estimated radio-on time of skipped events
+  uint32_t scan_ms;           // Scanning time spent on (re)establishing syncs
+} sync_manager_stats_t;
+
+void sli_sync_manager_init(void);
+void sli_sync_manager_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Set the function called when a train is given up.
+ *
+ * @param[in] lost_callback Function called when a train is given up, or NULL
+ *
+ ******************************************************************************/
+void sync_manager_set_lost_callback(sync_manager_lost_callback_t lost_callback);
+
+/***************************************************************************//**
+ *
+ * Manage a periodic advertising train and open a sync to it, listening to
+ * every event until the data change rate is known. Starts the scanner,
+ * which the application may stop once the sync is opened.
+ *
+ * The skip is then chosen so that the data is sampled twice per observed
+ * change, but not more often than every @p min_update_ms and not less often
+ * than every @p max_update_ms. A @p max_update_ms of 0 keeps the skip at 0,
+ * for data that must be received in every event, e.g. deltas against the
+ * previous event. Only the sync timeout is tuned then.
+ *
+ * A sync closed by the manager to change its skip, or lost, is reopened
+ * automatically. The application sees the sync_closed and
+ * periodic_sync_opened events as usual, with a new sync handle.
+ *
+ * SL_STATUS_ALREADY_EXISTS will be returned if the train is already managed,
+ * SL_STATUS_NO_MORE_RESOURCE if SYNC_MANAGER_MAX_SYNCS trains are managed.
+ *
+ * @param[in] address Address of the advertiser
+ * @param[in] address_type Address type of the advertiser
+ * @param[in] sid Advertising set ID
+ * @param[in] min_update_ms Shortest useful interval between updates
+ * @param[in] max_update_ms Longest acceptable interval between updates
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t sync_manager_add(bd_addr address,
+                             uint8_t address_type,
+                             uint8_t sid,
+                             uint32_t min_update_ms,
+                             uint32_t max_update_ms);
+
+/***************************************************************************//**
+ *
+ * Account a complete report of a managed sync.
+ *
+ * @p data_id identifies the content of the advertising data, e.g. the data
+ * ID (DID) of the advertiser or an update counter carried in the payload. It
+ * must change whenever the data changes.
+ *
+ * @param[in] sync Sync handle
+ * @param[in] data_id Identifier of the data
+ * @param[in] len Length of the data, for the radio-on time estimate
+ *
+ * @return true if the data changed since the previous report of the sync.
+ *
+ ******************************************************************************/
+bool sync_manager_report(uint16_t sync, uint16_t data_id, uint16_t len);
+
+/***************************************************************************//**
+ *
+ * Retrieve the current settings of a sync.
+ *
+ * @param[in] sync Sync handle
+ * @param[out] info Settings of the sync
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND otherwise.
+ *
+ ******************************************************************************/
+sl_status_t sync_manager_get_sync_info(uint16_t sync,
+                                       sync_manager_sync_info_t *info);
+
+/***************************************************************************//**
+ *
+ * Count the trains whose sync is being (re)established. The scanner must
+ * run while this is not 0.
+ *
+ * @return Number of syncs being opened or reopened.
+ *
+ ******************************************************************************/
+uint8_t sync_manager_get_opening(void);
+
+/***************************************************************************//**
+ *
+ * Retrieve the statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void sync_manager_get_stats(sync_manager_stats_t *stats);
+
+#endif // SYNC_MANAGER_H
@@ -0,0 +1,484 @@
+/***************************************************************************//**
+ * @file
+ * @brief Periodic Advertising Sync Manager
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgement in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "sync_manager.h"
+
+_Static_assert(SYNC_MANAGER_TIMEOUT_EVENTS >= 2,
+               "SYNC_MANAGER_TIMEOUT_EVENTS must be at least 2");
+
+// Sync timeout used while the periodic advertising interval is unknown,
+// the default of the stack.
+#define DEFAULT_TIMEOUT_MS    10000
+#define MIN_TIMEOUT_MS        100
+
+typedef enum {
+  target_free,
+  target_opening,    // Sync requested, scanning for the train
+  target_synced,
+  target_retuning    // Closed by the manager, reopened with next_skip
+} target_state_t;
+
+typedef struct {
+  target_state_t state;
+  bd_addr address;
+  uint8_t address_type;
+  uint8_t sid;
+  uint16_t sync;
+  uint32_t min_update_ms;
+  uint32_t max_update_ms;
+  uint16_t skip;
+  uint16_t next_skip;
+  uint32_t timeout_ms;
+  uint32_t interval_ms;
+  uint8_t phy;
+  uint8_t attempts;
+  uint32_t open_ms;         // Start of the current (re)establishment
+  // Current sync, for the radio-on time estimate
+  uint32_t first_report_ms;
+  uint32_t last_report_ms;
+  uint32_t received;
+  uint16_t average_len;
+  // Change rate estimate
+  bool id_valid;
+  uint16_t last_id;
+  uint8_t samples;
+  uint8_t changes;
+  uint32_t change_ms;
+} target_t;
+
+static target_t targets[SYNC_MANAGER_MAX_SYNCS];
+static sync_manager_lost_callback_t lost_cb = NULL;
+static sync_manager_stats_t stats;
+static uint64_t radio_saved_us = 0;
+static sl_sleeptimer_timer_handle_t open_timer;
+
+static uint32_t now_ms(void)
+{
+  uint64_t ms = 0;
+
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+  return (uint32_t)ms;
+}
+
+static void open_timer_callback(sl_sleeptimer_timer_handle_t *handle,
+                                void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(SYNC_MANAGER_SIGNAL);
+}
+
+static target_t *find_target(uint16_t sync)
+{
+  for (uint8_t i = 0; i < SYNC_MANAGER_MAX_SYNCS; i++) {
+    if (targets[i].state != target_free && targets[i].sync == sync) {
+      return &targets[i];
+    }
+  }
+  return NULL;
+}
+
+static uint32_t sync_timeout_ms(uint16_t skip, uint32_t interval_ms)
+{
+  uint32_t timeout;
+
+  if (interval_ms == 0) {
+    return DEFAULT_TIMEOUT_MS;
+  }
+  timeout = (skip + 1) * interval_ms * SYNC_MANAGER_TIMEOUT_EVENTS;
+  if (timeout < MIN_TIMEOUT_MS) {
+    return MIN_TIMEOUT_MS;
+  }
+  return (timeout > SYNC_MANAGER_MAX_TIMEOUT_MS) ? SYNC_MANAGER_MAX_TIMEOUT_MS : timeout;
+}
+
+// Airtime of a listened event, from the packet length and the PHY
+static uint32_t event_us(const target_t *t)
+{
+  uint32_t us_per_byte = 8;
+
+  if (t->phy == sl_bt_gap_phy_2m) {
+    us_per_byte = 4;
+  } else if (t->phy == sl_bt_gap_phy_coded) {
+    us_per_byte = 64;
+  }
+  return SYNC_MANAGER_EVENT_OVERHEAD_US + t->average_len * us_per_byte;
+}
+
+// Periodic events of the current sync that were not listened to
+static uint32_t skipped_events(const target_t *t)
+{
+  uint32_t events;
+
+  if (t->received == 0 || t->interval_ms == 0) {
+    return 0;
+  }
+  events = (t->last_report_ms - t->first_report_ms + t->interval_ms / 2)
+           / t->interval_ms + 1;
+  return (events > t->received) ? events - t->received : 0;
+}
+
+// Move the figures of the current sync to the totals
+static void account_sync(target_t *t)
+{
+  uint32_t skipped = skipped_events(t);
+
+  stats.events_skipped += skipped;
+  radio_saved_us += (uint64_t)skipped * event_us(t);
+  t->received = 0;
+  t->id_valid = false;
+  t->samples = 0;
+  t->changes = 0;
+}
+
+static void arm_open_timer(void)
+{
+  bool running = false;
+
+  sl_sleeptimer_is_timer_running(&open_timer, &running);
+  if (!running) {
+    sl_sleeptimer_start_timer_ms(&open_timer,
+                                 SYNC_MANAGER_OPEN_TIMEOUT_MS,
+                                 open_timer_callback,
+                                 NULL,
+                                 0,
+                                 0);
+  }
+}
+
+static sl_status_t open_target(target_t *t)
+{
+  sl_status_t sc;
+
+  t->skip = t->next_skip;
+  t->timeout_ms = sync_timeout_ms(t->skip, t->interval_ms);
+  sc = sl_bt_sync_scanner_set_sync_parameters(t->skip,
+                                              (uint16_t)((t->timeout_ms + 9) / 10),
+                                              sl_bt_sync_report_all);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  sc = sl_bt_sync_scanner_open(t->address, t->address_type, t->sid, &t->sync);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  // The sync is only established while scanning. Fails harmlessly if the
+  // application is already scanning.
+  (void)sl_bt_scanner_start(sl_bt_scanner_scan_phy_1m,
+                            sl_bt_scanner_discover_observation);
+  t->state = target_opening;
+  t->open_ms = now_ms();
+  arm_open_timer();
+  return SL_STATUS_OK;
+}
+
+static void give_up(target_t *t)
+{
+  t->state = target_free;
+  stats.lost++;
+  if (lost_cb != NULL) {
+    lost_cb(&t->address, t->sid);
+  }
+}
+
+static void reopen(target_t *t)
+{
+  if (open_target(t) != SL_STATUS_OK) {
+    give_up(t);
+  }
+}
+
+// Choose the skip from the change rate seen over the last window, and
+// reopen the sync if the skip or the timeout differs by a factor of 2 or
+// more.
+static void evaluate(target_t *t)
+{
+  uint32_t period_ms = (t->skip + 1) * t->interval_ms;
+  uint32_t target_ms;
+  uint32_t max_skip;
+  uint32_t skip;
+
+  if (t->changes == 0) {
+    t->change_ms = 0;
+    target_ms = t->max_update_ms;
+  } else {
+    // Every sample changing means the data may change even faster.
+    t->change_ms = period_ms * t->samples / t->changes;
+    target_ms = t->change_ms / 2;
+  }
+  if (target_ms < t->min_update_ms) {
+    target_ms = t->min_update_ms;
+  }
+  if (target_ms > t->max_update_ms) {
+    target_ms = t->max_update_ms;
+  }
+
+  skip = target_ms / t->interval_ms;
+  skip = (skip > 0) ? skip - 1 : 0;
+  max_skip = SYNC_MANAGER_MAX_TIMEOUT_MS
+             / (t->interval_ms * SYNC_MANAGER_TIMEOUT_EVENTS);
+  max_skip = (max_skip > 0) ? max_skip - 1 : 0;
+  if (max_skip > SYNC_MANAGER_MAX_SKIP) {
+    max_skip = SYNC_MANAGER_MAX_SKIP;
+  }
+  if (skip > max_skip) {
+    skip = max_skip;
+  }
+
+  if (skip + 1 >= 2u * (t->skip + 1) || 2 * (skip + 1) <= t->skip + 1u
+      || 2 * sync_timeout_ms((uint16_t)skip, t->interval_ms) <= t->timeout_ms) {
+    t->next_skip = (uint16_t)skip;
+    t->state = target_retuning;
+    stats.retunes++;
+    if (sl_bt_sync_close(t->sync) != SL_STATUS_OK) {
+      t->state = target_synced;
+    }
+  }
+}
+
+static void on_open_timeout(void)
+{
+  uint32_t now = now_ms();
+  bool pending = false;
+
+  for (uint8_t i = 0; i < SYNC_MANAGER_MAX_SYNCS; i++) {
+    if (targets[i].state != target_opening) {
+      continue;
+    }
+    if (now - targets[i].open_ms >= SYNC_MANAGER_OPEN_TIMEOUT_MS) {
+      // Counted as a failed attempt when the sync is closed
+      (void)sl_bt_sync_close(targets[i].sync);
+    } else {
+      pending = true;
+    }
+  }
+  if (pending) {
+    arm_open_timer();
+  }
+}
+
+void sli_sync_manager_init(void)
+{
+  memset(targets, 0, sizeof(targets));
+  memset(&stats, 0, sizeof(stats));
+  radio_saved_us = 0;
+  lost_cb = NULL;
+}
+
+void sync_manager_set_lost_callback(sync_manager_lost_callback_t lost_callback)
+{
+  lost_cb = lost_callback;
+}
+
+sl_status_t sync_manager_add(bd_addr address,
+                             uint8_t address_type,
+                             uint8_t sid,
+                             uint32_t min_update_ms,
+                             uint32_t max_update_ms)
+{
+  target_t *t = NULL;
+  sl_status_t sc;
+
+  if (min_update_ms > max_update_ms) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  for (uint8_t i = 0; i < SYNC_MANAGER_MAX_SYNCS; i++) {
+    if (targets[i].state == target_free) {
+      if (t == NULL) {
+        t = &targets[i];
+      }
+    } else if (targets[i].sid == sid
+               && memcmp(&targets[i].address, &address, sizeof(bd_addr)) == 0) {
+      return SL_STATUS_ALREADY_EXISTS;
+    }
+  }
+  if (t == NULL) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+
+  memset(t, 0, sizeof(*t));
+  t->address = address;
+  t->address_type = address_type;
+  t->sid = sid;
+  t->min_update_ms = min_update_ms;
+  t->max_update_ms = max_update_ms;
+  sc = open_target(t);
+  if (sc != SL_STATUS_OK) {
+    t->state = target_free;
+  }
+  return sc;
+}
+
+void sli_sync_manager_on_event(sl_bt_msg_t *evt)
+{
+  target_t *t;
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_periodic_sync_opened_id:
+      t = find_target(evt->data.evt_periodic_sync_opened.sync);
+      if (t == NULL) {
+        break;
+      }
+      t->state = target_synced;
+      t->attempts = 0;
+      t->phy = evt->data.evt_periodic_sync_opened.adv_phy;
+      stats.scan_ms += now_ms() - t->open_ms;
+      // The first sync runs with the default timeout. It is tightened by
+      // the first retune, now that the interval is known.
+      t->interval_ms = evt->data.evt_periodic_sync_opened.adv_interval * 5 / 4;
+      break;
+
+    case sl_bt_evt_sync_closed_id:
+      t = find_target(evt->data.evt_sync_closed.sync);
+      if (t == NULL) {
+        break;
+      }
+      switch (t->state) {
+        case target_retuning:
+          account_sync(t);
+          reopen(t);
+          break;
+
+        case target_synced:
+          // Lost: listen to every event again until the rate is re-learned
+          stats.losses++;
+          account_sync(t);
+          t->next_skip = 0;
+          reopen(t);
+          break;
+
+        case target_opening:
+          stats.scan_ms += now_ms() - t->open_ms;
+          if (++t->attempts >= SYNC_MANAGER_OPEN_ATTEMPTS) {
+            give_up(t);
+          } else {
+            reopen(t);
+          }
+          break;
+
+        default:
+          break;
+      }
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & SYNC_MANAGER_SIGNAL) {
+        on_open_timeout();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+bool sync_manager_report(uint16_t sync, uint16_t data_id, uint16_t len)
+{
+  target_t *t = find_target(sync);
+  bool changed;
+
+  if (t == NULL || t->state != target_synced) {
+    return true;
+  }
+
+  t->last_report_ms = now_ms();
+  if (t->received == 0) {
+    t->first_report_ms = t->last_report_ms;
+    t->average_len = len;
+  } else {
+    t->average_len = (uint16_t)((t->average_len * 7u + len) / 8);
+  }
+  t->received++;
+  stats.events_received++;
+
+  changed = !t->id_valid || data_id != t->last_id;
+  if (t->id_valid) {
+    t->samples++;
+    if (changed) {
+      t->changes++;
+      stats.changes++;
+    }
+  }
+  t->id_valid = true;
+  t->last_id = data_id;
+
+  if (t->samples >= SYNC_MANAGER_WINDOW) {
+    evaluate(t);
+    t->samples = 0;
+    t->changes = 0;
+  }
+  return changed;
+}
+
+sl_status_t sync_manager_get_sync_info(uint16_t sync,
+                                       sync_manager_sync_info_t *info)
+{
+  target_t *t = find_target(sync);
+
+  if (t == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  info->skip = t->skip;
+  info->timeout_ms = t->timeout_ms;
+  info->interval_ms = t->interval_ms;
+  info->change_ms = t->change_ms;
+  return SL_STATUS_OK;
+}
+
+uint8_t sync_manager_get_opening(void)
+{
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < SYNC_MANAGER_MAX_SYNCS; i++) {
+    if (targets[i].state == target_opening
+        || targets[i].state == target_retuning) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void sync_manager_get_stats(sync_manager_stats_t *out)
+{
+  uint64_t saved_us = radio_saved_us;
+
+  *out = stats;
+  // Include the syncs that are still running
+  for (uint8_t i = 0; i < SYNC_MANAGER_MAX_SYNCS; i++) {
+    if (targets[i].state == target_synced) {
+      uint32_t skipped = skipped_events(&targets[i]);
+
+      out->events_skipped += skipped;
+      saved_us += (uint64_t)skipped * event_us(&targets[i]);
+    }
+  }
+  out->radio_saved_ms = (uint32_t)(saved_us / 1000);
+}
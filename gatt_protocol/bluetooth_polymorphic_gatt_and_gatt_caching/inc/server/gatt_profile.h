@@ -0,0 +1,78 @@
+/***************************************************************************//**
+ * @file gatt_profile.h
+ * @brief Registry of the capability profiles of a polymorphic GATT database.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef GATT_PROFILE_H
+#define GATT_PROFILE_H
+
+#include <stdint.h>
+#include "sl_bluetooth.h"
+
+#define GATT_PROFILE_HASH_LEN  16
+
+/***************************************************************************//**
+ * Start with the profile the GATT configuration enables at boot. Its
+ * Database Hash is taken from the table generated by
+ * tools/gatt_db_hash/gatt_db_hash.py into gatt_profiles.h.
+ ******************************************************************************/
+void gatt_profile_init(void);
+
+/***************************************************************************//**
+ * Switch the GATT database to another profile.
+ * @param[in] capabilities Capabilities enabled by the profile, also its ID
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND if the profile is
+ *         not in the table. Error code of the stack otherwise.
+ ******************************************************************************/
+sl_status_t gatt_profile_select(uint16_t capabilities);
+
+/***************************************************************************//**
+ * Compare the precomputed Database Hash of the active profile with the one
+ * of the stack. The table is not changed: if they differ, gatt_profiles.h is
+ * stale and must be generated again.
+ * @param[out] stack_hash Database Hash of the stack, GATT_PROFILE_HASH_LEN
+ *             bytes, set if it could be read. May be NULL.
+ * @return SL_STATUS_OK if they match, SL_STATUS_FAIL if they differ,
+ *         SL_STATUS_NOT_SUPPORTED if the hash of the stack is not 16 bytes.
+ *         Error code of the stack if it could not be read.
+ ******************************************************************************/
+sl_status_t gatt_profile_verify(uint8_t *stack_hash);
+
+/***************************************************************************//**
+ * @return ID of the active profile, the capabilities it enables.
+ ******************************************************************************/
+uint16_t gatt_profile_get_active(void);
+
+/***************************************************************************//**
+ * @return Precomputed Database Hash of the active profile,
+ *         GATT_PROFILE_HASH_LEN bytes in the order they are read from the
+ *         Database Hash characteristic.
+ ******************************************************************************/
+const uint8_t *gatt_profile_get_hash(void);
+
+#endif // GATT_PROFILE_H
@@ -0,0 +1,22 @@
+/* Generated by tools/gatt_db_hash/gatt_db_hash.py from gatt_configuration.btconf. Do not edit. */
+
+#ifndef GATT_PROFILES_H
+#define GATT_PROFILES_H
+
+// Capabilities enabled at boot by the GATT configuration
+#define GATT_PROFILE_DEFAULT_CAPABILITIES  0x0001
+
+#define GATT_PROFILE_COUNT  4
+
+// { capabilities, Database Hash as read from the characteristic }
+#define GATT_PROFILE_TABLE \
+  /* none */ \
+  { 0x0000, { 0xfb, 0x4f, 0xa5, 0xa4, 0x42, 0x13, 0x5e, 0x60, 0x92, 0xdd, 0x72, 0xc2, 0xcd, 0x83, 0x56, 0x31 } }, \
+  /* Feature1 */ \
+  { 0x0001, { 0x14, 0x5a, 0x77, 0x05, 0x49, 0xd6, 0x96, 0x43, 0xef, 0x21, 0x98, 0x9a, 0x0c, 0xfb, 0xe8, 0x00 } }, \
+  /* Feature2 */ \
+  { 0x0002, { 0xc7, 0x40, 0x76, 0xec, 0x0b, 0x3e, 0x87, 0x9a, 0x3e, 0x9b, 0x84, 0x77, 0x92, 0xba, 0xe2, 0x87 } }, \
+  /* Feature1 | Feature2 */ \
+  { 0x0003, { 0x84, 0xcf, 0x34, 0x36, 0x29, 0xc4, 0xb0, 0x17, 0x74, 0x87, 0x49, 0xb8, 0x4f, 0x77, 0xc6, 0x44 } }
+
+#endif // GATT_PROFILES_H
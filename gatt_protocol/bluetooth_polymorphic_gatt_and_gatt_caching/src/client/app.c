@@ -33,43 +33,54 @@
 #include "gatt_db.h"
 #include "app.h"
 #include "app_log.h"
-#include "nvm3.h"
-
-#define NVM_KEY_HASH_1      0x01
-#define NVM_KEY_HASH_2      0x02
+#include "sl_sleeptimer.h"
+#include "gatt_discovery_cache.h"
 
 #define DATABASE_HASH_LENGTH   16
 
 #define WRITE_VALUE_TIMEOUT       1
 
+/* Manufacturer specific data in which the server advertises its active profile:
+ * company ID, profile ID and the first bytes of the Database Hash of the profile */
+#define PROFILE_AD_COMPANY_ID       0x02FF
+#define PROFILE_HASH_PREFIX_LENGTH  4
+
+typedef enum {
+  IDLE,
+  READING_HASH,
+  DISCOVERING,
+  ENABLING_ROBUST_CACHING,
+  READING_CHARACTERISTIC,
+  WRITING
+} client_state_t;
+
 sl_sleeptimer_timer_handle_t write_value_timeout_timer;
 
 /* UUID of the DB hash characteristic */
 static uint8_t db_hash_uuid[2] = { 0x2a, 0x2b };
 
-/* DB hash of the 1st version of the database */
-static uint8_t db_hash_version_1[DATABASE_HASH_LENGTH];
-
-/* DB hash of the 2nd version of the database */
-static uint8_t db_hash_version_2[DATABASE_HASH_LENGTH];
+/* UUID of the Client Supported Features characteristic */
+static const uint8_t client_supported_features_uuid[2] = { 0x29, 0x2b };
 
-/* characteristic handle of the Client Supported Features characteristic in version 1 of the GATT database */
-static uint16_t client_supported_features_handle_version_1 = 8;
+/* UUID of the LED Switch characteristic, the same in both versions of the database */
+static const uint8_t led_switch_uuid[16] = { 0x7a, 0xfd, 0x0e, 0x7e, 0xca, 0xea, 0x62, 0xbe,
+                                             0x60, 0x44, 0x85, 0x31, 0x00, 0x5d, 0x39, 0xa1 };
 
-/* characteristic handle of the Client Supported Features characteristic in version 2 of the GATT database */
-static uint16_t client_supported_features_handle_version_2 = 8;
+/* DB hash of the remote database */
+static uint8_t db_hash[DATABASE_HASH_LENGTH];
 
-/* characteristic handle of the custom characteristic in version 1 of the GATT database */
-static uint16_t char_handle_version_1 = 23;
+/* handle map of the remote database, from the cache or discovered */
+static gatt_discovery_cache_map_t db_map;
 
-/* characteristic handle of the custom characteristic in version 2 of the GATT database */
-static uint16_t char_handle_version_2 = 26;
+/* handles of the characteristics used, looked up in the handle map */
+static uint16_t client_supported_features_handle = 0;
+static uint16_t led_switch_handle = 0;
 
-/* version number of the remote DB. 0xFF means unknown version */
-static uint8_t db_version = 0xFF;
+static client_state_t state = IDLE;
 
-/* connection handle */
+/* connection handle and identity of the server */
 static uint8_t conn_handle = 0xFF;
+static bd_addr server_address;
 
 /* enable bit to be sent */
 static uint8_t enable_bit[1] = { 0x01 };
@@ -80,7 +91,19 @@ static uint8_t dummy_data[1] = { 0x01 };
 /* remember if we have already enabled robust caching */
 static uint8_t robust_caching_enabled = 0;
 
-static uint8_t valid_handles = 0;
+/* profile advertised by the server the connection was opened to */
+static bool adv_profile_valid = false;
+static uint16_t adv_profile_id;
+static uint8_t adv_hash_prefix[PROFILE_HASH_PREFIX_LENGTH];
+
+/* time the handles were needed at, on connection or out of sync, and whether the cache had them */
+static uint64_t sync_start_tick;
+static bool cache_hit;
+
+static void read_database_hash(void);
+static void on_database_hash(void);
+static void on_handles_known(void);
+static void on_discovery_done(uint8_t connection, sl_status_t result);
 
 /**************************************************************************//**
    Callback for the sleeptimer.
@@ -120,21 +143,45 @@ static uint8_t findDeviceByName(sl_bt_evt_scanner_legacy_advertisement_report_t
   }
   return 0;
 }
+
 /**************************************************************************//**
- * Application Init.
+ * Find the profile the server advertises in its manufacturer specific data.
+ *
+ * @param[in] pResp  Pointer to a scan report event
+ *
+ * @return 1 if the profile was found, 0 otherwise
  *****************************************************************************/
-void app_init(void)
+static uint8_t findProfile(sl_bt_evt_scanner_legacy_advertisement_report_t *pResp)
 {
-  Ecode_t ret_code;
-
-  ret_code = nvm3_readData(nvm3_defaultHandle, NVM_KEY_HASH_1, db_hash_version_1, DATABASE_HASH_LENGTH);
-  if (ret_code == ECODE_NVM3_OK) {
-    valid_handles++;
-    ret_code = nvm3_readData(nvm3_defaultHandle, NVM_KEY_HASH_2, db_hash_version_2, DATABASE_HASH_LENGTH);
-    if (ret_code == ECODE_NVM3_OK) {
-      valid_handles++;
+  uint8_t i = 0;
+  uint8_t ad_len, ad_type;
+
+  while (i < (pResp->data.len - 1)) {
+    ad_len  = pResp->data.data[i];
+    ad_type = pResp->data.data[i + 1];
+
+    // type 0xFF = Manufacturer Specific Data
+    if (ad_type == 0xFF
+        && ad_len >= 1 + 2 + 2 + PROFILE_HASH_PREFIX_LENGTH
+        && i + 1 + ad_len <= pResp->data.len
+        && pResp->data.data[i + 2] == (uint8_t)PROFILE_AD_COMPANY_ID
+        && pResp->data.data[i + 3] == (uint8_t)(PROFILE_AD_COMPANY_ID >> 8)) {
+      adv_profile_id = pResp->data.data[i + 4] | (pResp->data.data[i + 5] << 8);
+      memcpy(adv_hash_prefix, &pResp->data.data[i + 6], PROFILE_HASH_PREFIX_LENGTH);
+      return 1;
     }
+    //jump to next AD record
+    i = i + ad_len + 1;
   }
+  return 0;
+}
+
+/**************************************************************************//**
+ * Application Init.
+ *****************************************************************************/
+void app_init(void)
+{
+  gatt_discovery_cache_init();
 }
 
 /**************************************************************************//**
@@ -157,9 +204,14 @@ SL_WEAK void app_process_action(void)
  *****************************************************************************/
 void sl_bt_on_event(sl_bt_msg_t *evt)
 {
-  Ecode_t ret_code;
-  nvm3_ObjectKey_t key;
   sl_status_t sc;
+  uint64_t ms;
+
+  /* events of a running discovery are handled by the cache */
+  if (gatt_discovery_cache_on_event(evt)) {
+    return;
+  }
+
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
     // This event indicates the device has started and the radio is ready.
@@ -181,6 +233,8 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_scanner_legacy_advertisement_report_id:
       /* Find server by name */
       if (findDeviceByName(&evt->data.evt_scanner_legacy_advertisement_report, "GATT server")) {
+        /* remember the profile the server advertises, if any */
+        adv_profile_valid = findProfile(&evt->data.evt_scanner_legacy_advertisement_report);
         /* Connect to server */
         sc = sl_bt_connection_open(evt->data.evt_scanner_legacy_advertisement_report.address, evt->data.evt_scanner_legacy_advertisement_report.address_type, sl_bt_gap_1m_phy, &conn_handle);
         app_assert_status(sc);
@@ -189,120 +243,116 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 
     case sl_bt_evt_connection_opened_id:
       app_log("connection opened\r\n");
-      /* store connection handle for future use */
+      /* store connection handle and server address for future use */
       conn_handle = evt->data.evt_connection_opened.connection;
-      /* read database hash */
-      sc = sl_bt_gatt_read_characteristic_value_by_uuid(evt->data.evt_connection_opened.connection, 0x0001FFFF, sizeof(db_hash_uuid), &db_hash_uuid[0]);
-      app_assert_status(sc);
+      server_address = evt->data.evt_connection_opened.address;
+      sync_start_tick = sl_sleeptimer_get_tick_count64();
+
+      /* a profile seen before selects the handle map without reading the database hash */
+      if (adv_profile_valid
+          && gatt_discovery_cache_lookup_prefix(&server_address, adv_hash_prefix, PROFILE_HASH_PREFIX_LENGTH,
+                                                db_hash, &db_map) == SL_STATUS_OK) {
+        adv_profile_valid = false;
+        app_log("profile 0x%04x advertised, handle map found in the cache, skipping the database hash read\r\n",
+                adv_profile_id);
+        cache_hit = true;
+        on_handles_known();
+        break;
+      }
+      adv_profile_valid = false;
+      read_database_hash();
       break;
 
     case sl_bt_evt_gatt_characteristic_value_id:
       /* if a read_by_type response is received, then it will be the database hash,
        * as in this application this is the only value that we read by UUID and not by handle */
-      if (evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_read_by_type_response) {
-        /* print DB hash */
-        app_log("database hash: ");
-        for (uint8_t i = 0; i < 16; i++) {
-          app_log("%02X", evt->data.evt_gatt_characteristic_value.value.data[i]);
-        }
-        app_log("\r\n");
-
-        /* Let's compare the hash with the two version of the database we know from earlier observations */
-        if (memcmp(&evt->data.evt_gatt_characteristic_value.value.data[0], &db_hash_version_1[0], 16) == 0) {
-          db_version = 1;
-          app_log("version 1 detected\r\n");
-        } else
-        if (memcmp(&evt->data.evt_gatt_characteristic_value.value.data[0], &db_hash_version_2[0], 16) == 0) {
-          db_version = 2;
-          app_log("version 2 detected\r\n");
-        } else {
-          db_version = 0xFF;
-          app_log("unknown version detected, storing it to NVM\r\n");
-          if (valid_handles == 0) {
-            key = NVM_KEY_HASH_1;
-            memcpy(db_hash_version_1, evt->data.evt_gatt_characteristic_value.value.data, DATABASE_HASH_LENGTH);
-          } else {
-            key = NVM_KEY_HASH_2;
-            memcpy(db_hash_version_2, evt->data.evt_gatt_characteristic_value.value.data, DATABASE_HASH_LENGTH);
-          }
-          //store the value to the NVM
-          ret_code = nvm3_writeData(nvm3_defaultHandle, key, evt->data.evt_gatt_characteristic_value.value.data, DATABASE_HASH_LENGTH);
-          valid_handles++;
-          if (ret_code != ECODE_NVM3_OK) {
-            app_log("Error while storing data to the NVM: %x\r\n", ret_code);
-          }
-          db_version = valid_handles;
-        }
-
-        /* enable robust caching by writing 0x01 into the Client Supported Features characteristic */
-        if (robust_caching_enabled == 0) {
-          /* The handle of the Client Supported Features characteristic depends on a version of the remote GATT database.
-           * Here we assume, that we already know the handle for each version from earlier observations. */
-          if (db_version == 1) {
-            app_log("enable robust caching... ");
-            sc = sl_bt_gatt_write_characteristic_value(conn_handle, client_supported_features_handle_version_1, sizeof(enable_bit), &enable_bit[0]);
-            app_assert_status(sc);
-          } else
-          if (db_version == 2) {
-            app_log("enable robust caching... ");
-            sc = sl_bt_gatt_write_characteristic_value(conn_handle, client_supported_features_handle_version_2, sizeof(enable_bit), &enable_bit[0]);
-            app_assert_status(sc);
-          }
-          robust_caching_enabled = 1;
-        }
-
-        /* After detecting the database let's write a dummy value to the custom characteristic every second.
-         * Start a sleeptimer here that will trigger the write procedure */
-        sc = sl_sleeptimer_start_periodic_timer_ms(&write_value_timeout_timer, 1000, sleep_timer_callback, NULL, 0, 0);
-        app_assert_status(sc);
+      if (evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_read_by_type_response
+          && evt->data.evt_gatt_characteristic_value.value.len >= DATABASE_HASH_LENGTH) {
+        memcpy(db_hash, evt->data.evt_gatt_characteristic_value.value.data, DATABASE_HASH_LENGTH);
       }
       break;
 
     case sl_bt_evt_system_external_signal_id:
       if (evt->data.evt_system_external_signal.extsignals & WRITE_VALUE_TIMEOUT) {
-        /* Write a dummy value to the custom characteristic. The handle of the custom characteristic depends
-         * on a version of the remote GATT database. Here we assume, that we already know the handle for each
-         * version from earlier observations. */
-        if (db_version == 1) {
-          app_log("write to handle %d... ", char_handle_version_1);
-          sc = sl_bt_gatt_write_characteristic_value(conn_handle, char_handle_version_1, sizeof(dummy_data), &dummy_data[0]);
-          app_assert_status(sc);
-        } else
-        if (db_version == 2) {
-          app_log("write to handle %d... ", char_handle_version_2);
-          sc = sl_bt_gatt_write_characteristic_value(conn_handle, char_handle_version_2, sizeof(dummy_data), &dummy_data[0]);
+        /* Write a dummy value to the LED Switch characteristic, with the handle found in the handle map */
+        if (state == IDLE && led_switch_handle != 0) {
+          app_log("write to handle %d... ", led_switch_handle);
+          sc = sl_bt_gatt_write_characteristic_value(conn_handle, led_switch_handle, sizeof(dummy_data), &dummy_data[0]);
           app_assert_status(sc);
-        } else {
-          /* we do not know the handle for the characteristic, so we should discover it! This is outside of the scope
-           * of this example. Find an example for GATT discovery. */
+          state = WRITING;
         }
       }
       break;
 
     case sl_bt_evt_gatt_procedure_completed_id:
-      /* check the result of the read/write procedure */
-      if (evt->data.evt_gatt_procedure_completed.result == SL_STATUS_OK) {
-        app_log("OK\r\n");
-      } else
       /* check if out-of-sync error was received */
       if (evt->data.evt_gatt_procedure_completed.result == SL_STATUS_BT_ATT_OUT_OF_SYNC) {
         app_log("database has changed!\r\n");
 
         // Stop sleeptimer
         sc = sl_sleeptimer_stop_timer(&write_value_timeout_timer);
-        app_assert_status(sc);
+        if (sc != SL_STATUS_INVALID_STATE) {
+          app_assert_status(sc);
+        }
 
-        /* read database hash */
-        sc = sl_bt_gatt_read_characteristic_value_by_uuid(conn_handle, 0x0001FFFF, sizeof(db_hash_uuid), &db_hash_uuid[0]);
-        app_assert_status(sc);
-      } else {
-        app_log("ERROR: 0x%04x\r\n", evt->data.evt_gatt_procedure_completed.result);
+        /* the handles are unknown until the new database hash is looked up */
+        sync_start_tick = sl_sleeptimer_get_tick_count64();
+        read_database_hash();
+        break;
+      }
+
+      switch (state) {
+        case READING_HASH:
+          if (evt->data.evt_gatt_procedure_completed.result == SL_STATUS_OK) {
+            on_database_hash();
+          } else {
+            app_log("ERROR reading the database hash: 0x%04x\r\n", evt->data.evt_gatt_procedure_completed.result);
+            state = IDLE;
+          }
+          break;
+
+        case ENABLING_ROBUST_CACHING:
+          app_log("%s\r\n", (evt->data.evt_gatt_procedure_completed.result == SL_STATUS_OK) ? "OK" : "failed");
+          robust_caching_enabled = 1;
+          on_handles_known();
+          break;
+
+        case READING_CHARACTERISTIC:
+          state = IDLE;
+          if (evt->data.evt_gatt_procedure_completed.result != SL_STATUS_OK) {
+            app_log("ERROR: 0x%04x\r\n", evt->data.evt_gatt_procedure_completed.result);
+            break;
+          }
+          sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64() - sync_start_tick, &ms);
+          app_log("first read after %lu ms, cache %s\r\n", (unsigned long)ms, cache_hit ? "hit" : "miss");
+
+          /* Now let's write a dummy value to the LED Switch characteristic every second.
+           * Start a sleeptimer here that will trigger the write procedure */
+          sc = sl_sleeptimer_start_periodic_timer_ms(&write_value_timeout_timer, 1000, sleep_timer_callback, NULL, 0, 0);
+          app_assert_status(sc);
+          break;
+
+        case WRITING:
+          state = IDLE;
+          /* check the result of the write procedure */
+          if (evt->data.evt_gatt_procedure_completed.result == SL_STATUS_OK) {
+            app_log("OK\r\n");
+          } else {
+            app_log("ERROR: 0x%04x\r\n", evt->data.evt_gatt_procedure_completed.result);
+          }
+          break;
+
+        default:
+          break;
       }
       break;
     // -------------------------------
     // This event indicates that a connection was closed.
     case sl_bt_evt_connection_closed_id:
       robust_caching_enabled = 0;
+      state = IDLE;
+      led_switch_handle = 0;
+      client_supported_features_handle = 0;
       sc = sl_sleeptimer_stop_timer(&write_value_timeout_timer);
       if (sc != SL_STATUS_INVALID_STATE) {
         //SL_INVALID_STATE indicates that the timer was already stopped
@@ -320,3 +370,101 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       break;
   }
 }
+
+/**************************************************************************//**
+ * Read the database hash, which selects the handle map to use.
+ *****************************************************************************/
+static void read_database_hash(void)
+{
+  sl_status_t sc;
+
+  sc = sl_bt_gatt_read_characteristic_value_by_uuid(conn_handle, 0x0001FFFF, sizeof(db_hash_uuid), &db_hash_uuid[0]);
+  app_assert_status(sc);
+  state = READING_HASH;
+}
+
+/**************************************************************************//**
+ * Load the handle map of the database from the cache, or discover it if the
+ * hash was never seen with this server.
+ *****************************************************************************/
+static void on_database_hash(void)
+{
+  sl_status_t sc;
+
+  /* print DB hash */
+  app_log("database hash: ");
+  for (uint8_t i = 0; i < DATABASE_HASH_LENGTH; i++) {
+    app_log("%02X", db_hash[i]);
+  }
+  app_log("\r\n");
+
+  cache_hit = (gatt_discovery_cache_lookup(&server_address, db_hash, &db_map) == SL_STATUS_OK);
+  if (cache_hit) {
+    app_log("handle map found in the cache, skipping discovery\r\n");
+    on_handles_known();
+    return;
+  }
+
+  app_log("unknown database, discovering it... ");
+  sc = gatt_discovery_cache_discover(conn_handle, &db_map, on_discovery_done);
+  app_assert_status(sc);
+  state = DISCOVERING;
+}
+
+static void on_discovery_done(uint8_t connection, sl_status_t result)
+{
+  (void)connection;
+
+  if (result == SL_STATUS_BT_ATT_OUT_OF_SYNC) {
+    /* changed again while discovering */
+    app_log("database has changed!\r\n");
+    read_database_hash();
+    return;
+  }
+  if (result != SL_STATUS_OK && result != SL_STATUS_WOULD_OVERFLOW) {
+    app_log("ERROR: 0x%04x\r\n", result);
+    state = IDLE;
+    return;
+  }
+  app_log("%d services, %d characteristics, %d descriptors\r\n",
+          db_map.service_count, db_map.characteristic_count, db_map.descriptor_count);
+  if (result == SL_STATUS_OK
+      && gatt_discovery_cache_store(&server_address, db_hash, &db_map) != SL_STATUS_OK) {
+    app_log("Error while storing the handle map to the NVM\r\n");
+  }
+  on_handles_known();
+}
+
+/**************************************************************************//**
+ * Look up the handles in the handle map, enable robust caching once per
+ * connection, then read the LED Switch characteristic.
+ *****************************************************************************/
+static void on_handles_known(void)
+{
+  sl_status_t sc;
+
+  client_supported_features_handle = gatt_discovery_cache_find_characteristic(&db_map,
+                                                                              client_supported_features_uuid,
+                                                                              sizeof(client_supported_features_uuid));
+  led_switch_handle = gatt_discovery_cache_find_characteristic(&db_map,
+                                                               led_switch_uuid,
+                                                               sizeof(led_switch_uuid));
+
+  /* enable robust caching by writing 0x01 into the Client Supported Features characteristic */
+  if (robust_caching_enabled == 0 && client_supported_features_handle != 0) {
+    app_log("enable robust caching... ");
+    sc = sl_bt_gatt_write_characteristic_value(conn_handle, client_supported_features_handle, sizeof(enable_bit), &enable_bit[0]);
+    app_assert_status(sc);
+    state = ENABLING_ROBUST_CACHING;
+    return;
+  }
+
+  if (led_switch_handle == 0) {
+    app_log("LED Switch characteristic not found\r\n");
+    state = IDLE;
+    return;
+  }
+  sc = sl_bt_gatt_read_characteristic_value(conn_handle, led_switch_handle);
+  app_assert_status(sc);
+  state = READING_CHARACTERISTIC;
+}
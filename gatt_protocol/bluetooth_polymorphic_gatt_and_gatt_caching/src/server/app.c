@@ -27,6 +27,7 @@
  * 3. This notice may not be removed or altered from any source distribution.
  *
  ******************************************************************************/
+#include <string.h>
 #include "em_common.h"
 #include "app_assert.h"
 #include "sl_bluetooth.h"
@@ -34,6 +35,7 @@
 #include "app.h"
 #include "app_log.h"
 #include "sl_simple_button_instances.h"
+#include "gatt_profile.h"
 
 // The advertising set handle allocated from Bluetooth stack.
 static uint8_t advertising_set_handle = 0xff;
@@ -42,6 +44,22 @@ static uint8_t advertising_set_handle = 0xff;
 #define BUTTON0_PRESSED 0x00000001
 #define BUTTON1_PRESSED 0x00000002
 
+/* The client finds the server by its name */
+#define DEVICE_NAME "GATT server"
+
+/* Manufacturer specific data advertising the active profile: company ID,
+ * profile ID and the first bytes of the Database Hash of the profile */
+#define PROFILE_AD_COMPANY_ID       0x02FF
+#define PROFILE_HASH_PREFIX_LENGTH  4
+
+// The active profile is advertised only once its precomputed hash is found
+// to be the one of the stack
+static bool profile_verified = false;
+
+static void set_advertising_data(void);
+static void on_profile_selected(void);
+static void log_hash(const char *label, const uint8_t *hash);
+
 /**************************************************************************//**
  * Application Init.
  *****************************************************************************/
@@ -81,6 +99,8 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_system_boot_id:
       app_log("Boot event - starting advertising\r\n");
       app_log("GATT database version: 1\r\n");
+      gatt_profile_init();
+      on_profile_selected();
 
       /* Enable bondings in security manager (this is needed for Service Change Indications) */
       sc = sl_bt_sm_configure(2, sl_bt_sm_io_capability_noinputnooutput);
@@ -100,11 +120,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_assert_status(sc);
 
       // Start general advertising and enable connections.
-      sc = sl_bt_legacy_advertiser_generate_data(advertising_set_handle,
-                                                 sl_bt_advertiser_general_discoverable);
-      app_assert(sc == SL_STATUS_OK,
-                 "[E: 0x%04x] Failed to generate data\n",
-                 (int)sc);
+      set_advertising_data();
       sc = sl_bt_legacy_advertiser_start(advertising_set_handle,
                                          sl_bt_advertiser_connectable_scannable);
       app_assert(sc == SL_STATUS_OK,
@@ -137,11 +153,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_connection_closed_id:
       app_log("connection closed, reason: 0x%2.2x\r\n", evt->data.evt_connection_closed.reason);
       // Restart advertising after client has disconnected.
-      sc = sl_bt_legacy_advertiser_generate_data(advertising_set_handle,
-                                                 sl_bt_advertiser_general_discoverable);
-      app_assert(sc == SL_STATUS_OK,
-                 "[E: 0x%04x] Failed to generate data\n",
-                 (int)sc);
+      set_advertising_data();
       sc = sl_bt_legacy_advertiser_start(advertising_set_handle,
                                          sl_bt_advertiser_connectable_scannable);
       app_assert(sc == SL_STATUS_OK,
@@ -151,17 +163,19 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_system_external_signal_id:
       if (evt->data.evt_system_external_signal.extsignals & BUTTON0_PRESSED) {
         /* if button 0 was pressed, enable the first feature set in the GATT database */
-        sc = sl_bt_gatt_server_set_capabilities(Feature1, 0);
+        sc = gatt_profile_select(Feature1);
         app_assert_status(sc);
 
         app_log("GATT database version: 1\r\n");
+        on_profile_selected();
       }
       if (evt->data.evt_system_external_signal.extsignals & BUTTON1_PRESSED) {
         /* if button 1 was pressed, enable the second feature set in the GATT database */
-        sc = sl_bt_gatt_server_set_capabilities(Feature2, 0);
+        sc = gatt_profile_select(Feature2);
         app_assert_status(sc);
 
         app_log("GATT database version: 2\r\n");
+        on_profile_selected();
       }
       break;
 
@@ -176,6 +190,88 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   }
 }
 
+/**************************************************************************//**
+ * Put the name and the active profile into the advertising data. Clients that
+ * have seen the profile before use their cached handles without reading the
+ * Database Hash. An unverified profile is left out, and the clients read the
+ * Database Hash.
+ *****************************************************************************/
+static void set_advertising_data(void)
+{
+  sl_status_t sc;
+  uint8_t data[31];
+  uint8_t len = 0;
+  uint16_t profile = gatt_profile_get_active();
+
+  if (advertising_set_handle == 0xff) {
+    return;
+  }
+
+  /* Flags: LE General Discoverable, BR/EDR not supported */
+  data[len++] = 2;
+  data[len++] = 0x01;
+  data[len++] = 0x06;
+
+  /* Complete Local Name */
+  data[len++] = 1 + sizeof(DEVICE_NAME) - 1;
+  data[len++] = 0x09;
+  memcpy(&data[len], DEVICE_NAME, sizeof(DEVICE_NAME) - 1);
+  len += sizeof(DEVICE_NAME) - 1;
+
+  /* Manufacturer Specific Data: company ID, profile ID, Database Hash prefix */
+  if (profile_verified) {
+    data[len++] = 1 + 2 + 2 + PROFILE_HASH_PREFIX_LENGTH;
+    data[len++] = 0xFF;
+    data[len++] = (uint8_t)PROFILE_AD_COMPANY_ID;
+    data[len++] = (uint8_t)(PROFILE_AD_COMPANY_ID >> 8);
+    data[len++] = (uint8_t)profile;
+    data[len++] = (uint8_t)(profile >> 8);
+    memcpy(&data[len], gatt_profile_get_hash(), PROFILE_HASH_PREFIX_LENGTH);
+    len += PROFILE_HASH_PREFIX_LENGTH;
+  }
+
+  sc = sl_bt_legacy_advertiser_set_data(advertising_set_handle,
+                                        sl_bt_advertiser_advertising_data_packet,
+                                        len,
+                                        data);
+  app_assert(sc == SL_STATUS_OK,
+             "[E: 0x%04x] Failed to set advertising data\n",
+             (int)sc);
+}
+
+/**************************************************************************//**
+ * Check the precomputed hash of the new profile against the stack, and
+ * advertise it. The advertising data is updated even while advertising, so
+ * that the clients connecting next do not use the handles of the old profile.
+ *****************************************************************************/
+static void on_profile_selected(void)
+{
+  sl_status_t sc;
+  uint8_t stack_hash[GATT_PROFILE_HASH_LEN];
+
+  app_log("GATT profile 0x%04x\r\n", gatt_profile_get_active());
+  log_hash("precomputed database hash", gatt_profile_get_hash());
+  sc = gatt_profile_verify(stack_hash);
+  profile_verified = (sc == SL_STATUS_OK);
+  if (sc == SL_STATUS_FAIL) {
+    log_hash("differs from the stack's", stack_hash);
+    app_log("gatt_profiles.h is stale, generate it again; the profile is not advertised\r\n");
+  } else if (sc != SL_STATUS_OK) {
+    app_log("database hash not verified: 0x%04x; the profile is not advertised\r\n", (int)sc);
+  }
+
+  set_advertising_data();
+}
+
+static void log_hash(const char *label, const uint8_t *hash)
+{
+  app_log("%s: ", label);
+  for (uint8_t i = 0; i < GATT_PROFILE_HASH_LEN; i++) {
+    app_log("%02X", hash[i]);
+  }
+  app_log("\r\n");
+}
+
 /**************************************************************************//**
  * Button press event handler.
  * This overrides the dummy weak implementation.
@@ -0,0 +1,112 @@
+/***************************************************************************//**
+ * @file gatt_profile.c
+ * @brief Registry of the capability profiles of a polymorphic GATT database.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "gatt_db.h"
+#include "gatt_profiles.h"
+#include "gatt_profile.h"
+
+typedef struct {
+  uint16_t capabilities;
+  uint8_t hash[GATT_PROFILE_HASH_LEN];
+} profile_t;
+
+static const profile_t profiles[GATT_PROFILE_COUNT] = { GATT_PROFILE_TABLE };
+static const profile_t *active = NULL;
+
+static const profile_t *find_profile(uint16_t capabilities)
+{
+  for (uint8_t i = 0; i < GATT_PROFILE_COUNT; i++) {
+    if (profiles[i].capabilities == capabilities) {
+      return &profiles[i];
+    }
+  }
+  return NULL;
+}
+
+void gatt_profile_init(void)
+{
+  active = find_profile(GATT_PROFILE_DEFAULT_CAPABILITIES);
+}
+
+sl_status_t gatt_profile_select(uint16_t capabilities)
+{
+  const profile_t *profile = find_profile(capabilities);
+  sl_status_t sc;
+
+  if (profile == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  sc = sl_bt_gatt_server_set_capabilities(capabilities, 0);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  active = profile;
+  return SL_STATUS_OK;
+}
+
+sl_status_t gatt_profile_verify(uint8_t *stack_hash)
+{
+  uint8_t hash[GATT_PROFILE_HASH_LEN];
+  size_t len = 0;
+  sl_status_t sc;
+
+  if (active == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  sc = sl_bt_gatt_server_read_attribute_value(gattdb_database_hash, 0,
+                                              sizeof(hash), &len, hash);
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  if (len != sizeof(hash)) {
+    return SL_STATUS_NOT_SUPPORTED;
+  }
+  if (stack_hash != NULL) {
+    memcpy(stack_hash, hash, sizeof(hash));
+  }
+  // The table is left as generated: a wrong hash is a stale gatt_profiles.h
+  if (memcmp(active->hash, hash, sizeof(hash)) != 0) {
+    return SL_STATUS_FAIL;
+  }
+  return SL_STATUS_OK;
+}
+
+uint16_t gatt_profile_get_active(void)
+{
+  return (active != NULL) ? active->capabilities : 0;
+}
+
+const uint8_t *gatt_profile_get_hash(void)
+{
+  static const uint8_t unknown[GATT_PROFILE_HASH_LEN] = { 0 };
+
+  return (active != NULL) ? active->hash : unknown;
+}
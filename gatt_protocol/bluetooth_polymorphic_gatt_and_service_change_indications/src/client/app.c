@@ -32,38 +32,48 @@
 #include "sl_bluetooth.h"
 #include "gatt_db.h"
 #include "app.h"
-#include "nvm3.h"
+#include "app_log.h"
+#include "sl_sleeptimer.h"
+#include "gatt_discovery_cache.h"
 
-/* First NVM key used for storing database caches */
-#define NVM_KEY_DATABASE_CACHE_BASE    0x00001
-
-/* Maximum number of stored database caches */
-#define MAX_NUM_OF_CACHES           5
-
-/* UUID of the Generic Attribute Service */
-static uint8_t generic_access_uuid[2] = { 0x01, 0x18 };
+typedef enum {
+  IDLE,
+  DISCOVERING,
+  SUBSCRIBING
+} client_state_t;
 
 /* UUID of the Service Changed characteristic */
-static uint8_t service_changed_uuid[2] = { 0x05, 0x2a };
+static const uint8_t service_changed_uuid[2] = { 0x05, 0x2a };
 
 /* connection handle */
 static uint8_t conn_handle = 0xFF;
 static uint8_t bonding_handle = 0xFF;
 static bd_addr server_address;
 
-typedef struct {
-  bd_addr  address;                   /* address of the GATT server for which this database is stored */
-  uint32_t generic_attribute_handle;  /* Generic Attribute service handle */
-  uint16_t service_changed_handle;    /* Service Changed characteristic handle */
-  /* add here additional handles used by application */
-} db_cache_t;
+/* handle map of the server database, from the cache or discovered */
+static gatt_discovery_cache_map_t db_map;
+
+/* Service Changed characteristic handle, looked up in the handle map */
+static uint16_t service_changed_handle = 0;
+
+static client_state_t state = IDLE;
+
+/* handle range changed while a discovery or subscription was running, 0 if none */
+static uint16_t pending_start = 0;
+static uint16_t pending_end = 0;
+
+/* range being discovered, the whole database for a full discovery */
+static uint16_t sync_start = 0;
+static uint16_t sync_end = 0;
 
-/* database cache in which handles are stored */
-static db_cache_t db_cache = { { { 0, 0, 0, 0, 0, 0 } }, 0xFFFFFFFF, 0xFFFF };
+/* time and procedure count at the start of the discovery */
+static uint64_t sync_start_tick;
+static uint32_t sync_start_procedures;
 
-/* state variables */
-static uint8_t waiting_for_service_discovery_to_finish = 0;
-static uint8_t waiting_for_characteristic_discovery_to_finish = 0;
+static void discover_database(void);
+static void rediscover_range(uint16_t start, uint16_t end);
+static void on_discovery_done(uint8_t connection, sl_status_t result);
+static void on_idle(void);
 
 /**************************************************************************//**
  * decoding advertising packets is done here. The list of AD types can be found
@@ -94,88 +104,12 @@ static uint8_t findDeviceByName(sl_bt_evt_scanner_legacy_advertisement_report_t
   return 0;
 }
 
-/**************************************************************************//**
- * Loads cached service and characteristic handles
- * The function will loop through the reserved NVM keys, and will copy
- * the database cache to the input pointer if found, otherwise returns 0
- *
- * @param[in] address     BLE address of the remote device
- * @param[in] p_db_cache  Pointer to the database cache
- *****************************************************************************/
-static uint8_t loadDatabaseCache(bd_addr address, db_cache_t* p_db_cache)
-{
-  uint8_t result = 0;
-  uint16_t key;
-  Ecode_t ret_code;
-  db_cache_t temp;
-
-  /* iterate through user keys in the NVM */
-  for (key = NVM_KEY_DATABASE_CACHE_BASE; key < (NVM_KEY_DATABASE_CACHE_BASE + MAX_NUM_OF_CACHES); key++) {
-    ret_code = nvm3_readData(nvm3_defaultHandle, key, &temp, sizeof(db_cache_t));
-    /* if loading error, return false */
-    if (ret_code != ECODE_NVM3_OK) {
-      result = 0;
-      break;
-    } else {
-      /* check device address, if it matches the required address, load the DB cache */
-      if (memcmp(&temp.address.addr[0], &address.addr[0], 6) == 0) {
-        memcpy(p_db_cache, &temp, sizeof(db_cache_t));
-        app_log("database cache loaded from key 0x%04X\r\n", key);
-        result = 1;
-      }
-    }
-  }
-  return result;
-}
-
-/**************************************************************************//**
- * Saves cached service and characteristic handles
- * The function will loop through the reserved NVM keys, and will either
- *  - store the data to the first empty key
- *  - or will overwrite the already saved one if an entry with the same address is found
- *
- * @param[in] address     BLE address of the remote device
- * @param[in] p_db_cache  Pointer to the database cache
- *****************************************************************************/
-static uint8_t storeDatabaseCache(bd_addr address, db_cache_t* p_db_cache)
-{
-  uint8_t result;
-  Ecode_t ret_code;
-  uint16_t key;
-  db_cache_t temp;
-
-  /* iterate through user keys in the NVM */
-  for (key = NVM_KEY_DATABASE_CACHE_BASE; key < (NVM_KEY_DATABASE_CACHE_BASE + MAX_NUM_OF_CACHES); key++) {
-    ret_code = nvm3_readData(nvm3_defaultHandle, key, &temp, sizeof(db_cache_t));
-    if (ret_code == ECODE_NVM3_ERR_KEY_NOT_FOUND) {
-      /* if key not found then it's the end of existing keys, store new data here */
-      break;
-    }
-    /* check device address, if it matches the required address, store new data here */
-    if (memcmp(&temp.address, &address.addr[0], 6) == 0) {
-      break;
-    }
-  }
-  ret_code = nvm3_writeData(nvm3_defaultHandle, key, p_db_cache, sizeof(db_cache_t));
-
-  if (ret_code != ECODE_NVM3_OK) {
-    result = 0;
-  } else {
-    result = 1;
-    app_log("database cache stored to key 0x%04X\r\n", key);
-  }
-  return result;
-}
-
 /**************************************************************************//**
  * Application Init.
  *****************************************************************************/
-SL_WEAK void app_init(void)
+void app_init(void)
 {
-  /////////////////////////////////////////////////////////////////////////////
-  // Put your additional application init code here!                         //
-  // This is called once during start-up.                                    //
-  /////////////////////////////////////////////////////////////////////////////
+  gatt_discovery_cache_init();
 }
 
 /**************************************************************************//**
@@ -199,6 +133,12 @@ SL_WEAK void app_process_action(void)
 void sl_bt_on_event(sl_bt_msg_t *evt)
 {
   sl_status_t sc;
+  uint16_t start, end;
+
+  /* events of a running discovery are handled by the cache */
+  if (gatt_discovery_cache_on_event(evt)) {
+    return;
+  }
 
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
@@ -232,12 +172,17 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       if (bonding_handle == 0xFF) {
         sc = sl_bt_sm_increase_security(evt->data.evt_connection_opened.connection);
         app_log("initialize bonding, %x\r\n", sc);
-      }/* otherwise, if bonding already exists, we can load the stored database cache */
+      }/* otherwise, if bonding already exists, we can load the stored handle map */
       else {
         app_log("device is already bonded\r\n");
-        if (!loadDatabaseCache(server_address, &db_cache)) {
+        if (gatt_discovery_cache_lookup(&server_address, NULL, &db_map) == SL_STATUS_OK) {
+          app_log("handle map loaded from the cache\r\n");
+          service_changed_handle = gatt_discovery_cache_find_characteristic(&db_map,
+                                                                            service_changed_uuid,
+                                                                            sizeof(service_changed_uuid));
+        } else {
           /* if loading failed, discover the database again. */
-          sl_bt_gatt_discover_primary_services(conn_handle);
+          discover_database();
         }
       }
       break;
@@ -245,69 +190,42 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_sm_bonded_id:
       app_log("bonding created\r\n");
       /* if bonding is successful, start discovering services */
-      sl_bt_gatt_discover_primary_services(conn_handle);
-      break;
-
-    case sl_bt_evt_gatt_service_id:
-      /* if we found the Generic Attribute Service */
-      if (memcmp(evt->data.evt_gatt_service.uuid.data, generic_access_uuid, sizeof(generic_access_uuid)) == 0) {
-        /* save handle and wait for process to be finished */
-        db_cache.generic_attribute_handle = evt->data.evt_gatt_service.service;
-        waiting_for_service_discovery_to_finish = 1;
-      }
-      break;
-
-    case sl_bt_evt_gatt_characteristic_id:
-      /* if we found the Service Changed characteristic */
-      if (memcmp(evt->data.evt_gatt_characteristic.uuid.data, service_changed_uuid, sizeof(service_changed_uuid)) == 0) {
-        /* save handle and wait for process to be finished */
-        db_cache.service_changed_handle = evt->data.evt_gatt_characteristic.characteristic;
-        waiting_for_characteristic_discovery_to_finish = 1;
-      }
+      discover_database();
       break;
 
     case sl_bt_evt_gatt_procedure_completed_id:
-      /* if service discovery finished */
-      if (waiting_for_service_discovery_to_finish) {
-        app_log("service discovery finished\r\n");
-        waiting_for_service_discovery_to_finish = 0;
-        /* discover service changed characteristic */
-        sl_bt_gatt_discover_characteristics_by_uuid(evt->data.evt_gatt_procedure_completed.connection,
-                                                    db_cache.generic_attribute_handle,
-                                                    sizeof(service_changed_uuid),
-                                                    service_changed_uuid);
-      }
-
-      /* if characteristic discovery finished */
-      if (waiting_for_characteristic_discovery_to_finish) {
-        app_log("characteristic discovery finished\r\n");
-        waiting_for_characteristic_discovery_to_finish = 0;
-        /* store database cache */
-        db_cache.address = server_address;
-        storeDatabaseCache(server_address, &db_cache);
-        /* subscribe for indications */
-        sl_bt_gatt_set_characteristic_notification(evt->data.evt_gatt_procedure_completed.connection,
-                                                   db_cache.service_changed_handle,
-                                                   sl_bt_gatt_indication);
+      /* subscription finished */
+      if (state == SUBSCRIBING) {
+        app_log("subscribed for service change indications\r\n");
+        state = IDLE;
+        on_idle();
       }
-
       break;
 
     case sl_bt_evt_gatt_characteristic_value_id:
       /* if we got a service changed indication */
-      if (evt->data.evt_gatt_characteristic_value.characteristic == db_cache.service_changed_handle) {
+      if (service_changed_handle != 0
+          && evt->data.evt_gatt_characteristic_value.characteristic == service_changed_handle
+          && evt->data.evt_gatt_characteristic_value.value.len >= 4) {
+        start = evt->data.evt_gatt_characteristic_value.value.data[0]
+                | (evt->data.evt_gatt_characteristic_value.value.data[1] << 8);
+        end = evt->data.evt_gatt_characteristic_value.value.data[2]
+              | (evt->data.evt_gatt_characteristic_value.value.data[3] << 8);
         app_log("Service Change Indication received. Changes are in the range: 0x%04X - 0x%04X\r\n",
-                *((uint16_t*)&evt->data.evt_gatt_characteristic_value.value.data[0]),
-                *((uint16_t*)&evt->data.evt_gatt_characteristic_value.value.data[2]));
+                start, end);
         /* send back confirmation */
         sl_bt_gatt_send_characteristic_confirmation(evt->data.evt_gatt_characteristic_value.connection);
-        /* and initiate new database discovery */
-        sl_bt_gatt_discover_primary_services(conn_handle);
+        /* and rediscover the services in the range only */
+        rediscover_range(start, end);
       }
       break;
     // -------------------------------
     // This event indicates that a connection was closed.
     case sl_bt_evt_connection_closed_id:
+      state = IDLE;
+      service_changed_handle = 0;
+      pending_start = 0;
+      pending_end = 0;
       break;
 
     ///////////////////////////////////////////////////////////////////////////
@@ -320,3 +238,118 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       break;
   }
 }
+
+static void start_sync(uint16_t start, uint16_t end)
+{
+  gatt_discovery_cache_stats_t stats;
+
+  gatt_discovery_cache_get_stats(&stats);
+  sync_start_procedures = stats.procedures;
+  sync_start_tick = sl_sleeptimer_get_tick_count64();
+  sync_start = start;
+  sync_end = end;
+  state = DISCOVERING;
+}
+
+/**************************************************************************//**
+ * Discover the whole database of the server.
+ *****************************************************************************/
+static void discover_database(void)
+{
+  sl_status_t sc;
+
+  start_sync(0x0001, 0xFFFF);
+  sc = gatt_discovery_cache_discover(conn_handle, &db_map, on_discovery_done);
+  app_assert_status(sc);
+}
+
+/**************************************************************************//**
+ * Rediscover the services in a changed handle range, or remember the range
+ * until the running procedure ends.
+ *
+ * @param[in] start First handle of the changed range
+ * @param[in] end   Last handle of the changed range
+ *****************************************************************************/
+static void rediscover_range(uint16_t start, uint16_t end)
+{
+  sl_status_t sc;
+
+  if (state != IDLE) {
+    /* the map may already be outdated by this change, rediscover the range when done */
+    if (pending_start == 0 || start < pending_start) {
+      pending_start = start;
+    }
+    if (end > pending_end) {
+      pending_end = end;
+    }
+    return;
+  }
+  start_sync(start, end);
+  sc = gatt_discovery_cache_rediscover(conn_handle, &db_map, start, end, on_discovery_done);
+  if (sc == SL_STATUS_INVALID_RANGE) {
+    app_log("invalid range, discovering the whole database\r\n");
+    discover_database();
+    return;
+  }
+  app_assert_status(sc);
+}
+
+static void on_discovery_done(uint8_t connection, sl_status_t result)
+{
+  gatt_discovery_cache_stats_t stats;
+  uint16_t handle;
+  uint64_t ms;
+
+  state = IDLE;
+  if (result != SL_STATUS_OK && result != SL_STATUS_WOULD_OVERFLOW) {
+    app_log("discovery failed: 0x%04x\r\n", result);
+    return;
+  }
+
+  gatt_discovery_cache_get_stats(&stats);
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64() - sync_start_tick, &ms);
+  if (sync_start == 0x0001 && sync_end == 0xFFFF) {
+    app_log("database discovered");
+  } else {
+    app_log("range 0x%04X - 0x%04X rediscovered", sync_start, sync_end);
+  }
+  app_log(" in %lu ms with %lu procedures: %d services, %d characteristics, %d descriptors\r\n",
+          (unsigned long)ms, (unsigned long)(stats.procedures - sync_start_procedures),
+          db_map.service_count, db_map.characteristic_count, db_map.descriptor_count);
+
+  /* store handle map */
+  if (result == SL_STATUS_OK
+      && gatt_discovery_cache_store(&server_address, NULL, &db_map) != SL_STATUS_OK) {
+    app_log("Error while storing the handle map to the NVM\r\n");
+  }
+
+  /* subscribe for indications, unless the Service Changed characteristic was kept */
+  handle = gatt_discovery_cache_find_characteristic(&db_map,
+                                                    service_changed_uuid,
+                                                    sizeof(service_changed_uuid));
+  if (handle != 0 && handle != service_changed_handle) {
+    service_changed_handle = handle;
+    if (sl_bt_gatt_set_characteristic_notification(connection,
+                                                   service_changed_handle,
+                                                   sl_bt_gatt_indication) == SL_STATUS_OK) {
+      state = SUBSCRIBING;
+      return;
+    }
+  }
+  on_idle();
+}
+
+/**************************************************************************//**
+ * Rediscover a range changed while the client was busy.
+ *****************************************************************************/
+static void on_idle(void)
+{
+  uint16_t start = pending_start;
+  uint16_t end = pending_end;
+
+  if (start != 0) {
+    pending_start = 0;
+    pending_end = 0;
+    rediscover_range(start, end);
+  }
+}
@@ -43,7 +43,7 @@ typedef enum {
   DISCOVERING_SERVICES,
   DISCOVERING_CHARACTERISTICS,
   READING_CHARACTERISTIC,
-  READING_CHARACTERISTIC_DONE
+  DISCONNECTING
 } gatt_state_t;
 
 #define PAYLOAD_SIZE  330
@@ -52,24 +52,38 @@ typedef enum {
 typedef struct {
   uint8_t connection;
   uint32_t service;
+  uint16_t characteristic;
   gatt_state_t gatt_state;
+  uint16_t read_offset;     // Offset the running read procedure started at
+  uint16_t received;        // Bytes of the payload received so far
   uint8_t payload[PAYLOAD_SIZE];
 } node_t;
 
 #define NO_CALLBACK_DATA  (void *)NULL
 #define PERIPHERAL_COUNT  SL_BT_CONFIG_MAX_CONNECTIONS
+#define NO_NODE           0xFF
 #define BUTTON_0          0
-#define APP_CHARACTERISTIC_READING_TIMER_TIMEOUT       100
+#define APP_THROUGHPUT_TIMER_TIMEOUT       1000
 
-static node_t empty_node = { 0, 0, IDLE, {} };
+static node_t empty_node = { 0, 0, 0, IDLE, 0, 0, {} };
 static node_t nodes[PERIPHERAL_COUNT];
+// Index in nodes of each connection handle, NO_NODE if none
+static uint8_t node_index[UINT8_MAX + 1];
+
+// Reads completed since the last throughput report
+static uint32_t bytes_read = 0;
+static uint32_t payloads_read = 0;
 
 static char peripheral_name[] = "Demo Peripheral";
-static app_timer_t app_characteristic_reading_timer;
+static app_timer_t app_throughput_timer;
 
 static uint8_t find_name_in_advertisement(uint8_t *data, uint8_t len);
-static void app_characteristic_reading_timer_cb(app_timer_t *handle, void *data);
-static uint8_t get_peripheral_by_connection(uint8_t connection);
+static void app_throughput_timer_cb(app_timer_t *handle, void *data);
+static uint8_t get_free_node(void);
+static node_t *get_node(uint8_t connection);
+static sl_status_t read_payload(node_t *node);
+static void read_next(node_t *node);
+static void on_read_completed(node_t *node, uint16_t result);
 
 static const uint8_t service_uuid[2] = { 0xAA, 0xAA };
 static const uint8_t characteristics_uuid[2] = { 0xBB, 0xBB };
@@ -95,6 +109,7 @@ SL_WEAK void app_init(void)
   for (uint8_t i = 0; i < PERIPHERAL_COUNT; i++) {
     nodes[i] = empty_node;
   }
+  memset(node_index, NO_NODE, sizeof(node_index));
 }
 
 /**************************************************************************//**
@@ -119,6 +134,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 {
   sl_status_t sc;
   uint8_t index;
+  node_t *node;
 
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
@@ -128,9 +144,9 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       // Reduce MTU to avoid package splitting
       sc = sl_bt_gatt_set_max_mtu(MTU_SIZE, NULL);
 
-      sc = app_timer_start(&app_characteristic_reading_timer,
-                           APP_CHARACTERISTIC_READING_TIMER_TIMEOUT,
-                           app_characteristic_reading_timer_cb,
+      sc = app_timer_start(&app_throughput_timer,
+                           APP_THROUGHPUT_TIMER_TIMEOUT,
+                           app_throughput_timer_cb,
                            NO_CALLBACK_DATA,
                            true);
       app_assert_status(sc);
@@ -150,13 +166,18 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
                                      evt->data.evt_scanner_legacy_advertisement_report.data.len)) {
         sl_bt_scanner_stop();
 
-        index = get_peripheral_by_connection(0);
+        index = get_free_node();
+        if (index == NO_NODE) {
+          app_log("Peripherals pool exhausted!\r\n");
+          break;
+        }
 
         sc = sl_bt_connection_open(evt->data.evt_scanner_legacy_advertisement_report.address,
                                    evt->data.evt_scanner_legacy_advertisement_report.address_type,
                                    sl_bt_gap_phy_1m, &nodes[index].connection);
         app_assert_status(sc);
         nodes[index].gatt_state = CONNECTING;
+        node_index[nodes[index].connection] = index;
       }
 
       break;
@@ -166,48 +187,45 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_connection_opened_id:
       app_log("Connected\r\n");
 
-      index = get_peripheral_by_connection(evt->data.evt_connection_opened.connection);
+      node = get_node(evt->data.evt_connection_opened.connection);
+      if (node == NULL) {
+        break;
+      }
 
-      sc = sl_bt_gatt_discover_primary_services_by_uuid(nodes[index].connection, sizeof(service_uuid), service_uuid);
+      sc = sl_bt_gatt_discover_primary_services_by_uuid(node->connection, sizeof(service_uuid), service_uuid);
       app_assert_status(sc);
-      nodes[index].gatt_state = DISCOVERING_SERVICES;
+      node->gatt_state = DISCOVERING_SERVICES;
       break;
 
     case sl_bt_evt_gatt_service_id:
       app_log("Services\r\n");
 
-      index = get_peripheral_by_connection(evt->data.evt_gatt_service.connection);
-
-      nodes[index].service = evt->data.evt_gatt_service.service;
-      //app_log("UUID: %X %X\r\n", evt->data.evt_gatt_service.uuid.data[0], evt->data.evt_gatt_service.uuid.data[1]);
+      node = get_node(evt->data.evt_gatt_service.connection);
+      if (node != NULL) {
+        node->service = evt->data.evt_gatt_service.service;
+      }
       break;
 
     case sl_bt_evt_gatt_procedure_completed_id:
-      //app_log("Procedure: %X\r\n", evt->data.evt_gatt_procedure_completed.result);
-
-      index = get_peripheral_by_connection(evt->data.evt_gatt_procedure_completed.connection);
+      node = get_node(evt->data.evt_gatt_procedure_completed.connection);
+      if (node == NULL) {
+        break;
+      }
 
-      switch (nodes[index].gatt_state) {
+      switch (node->gatt_state) {
         case DISCOVERING_SERVICES: {
-          app_log("Service Request: %ld\r\n", nodes[index].service);
-          sc = sl_bt_gatt_discover_characteristics_by_uuid(nodes[index].connection, nodes[index].service, sizeof(characteristics_uuid), characteristics_uuid);
+          app_log("Service Request: %ld\r\n", node->service);
+          sc = sl_bt_gatt_discover_characteristics_by_uuid(node->connection, node->service, sizeof(characteristics_uuid), characteristics_uuid);
           app_assert_status(sc);
-          nodes[index].gatt_state = DISCOVERING_CHARACTERISTICS;
+          node->gatt_state = DISCOVERING_CHARACTERISTICS;
         }; break;
         case DISCOVERING_CHARACTERISTICS: {
-          sc = sl_bt_gatt_read_characteristic_value_by_uuid(nodes[index].connection, nodes[index].service, sizeof(characteristics_uuid), characteristics_uuid);
-          app_assert_status(sc);
-          nodes[index].gatt_state = READING_CHARACTERISTIC;
+          node->received = 0;
+          read_next(node);
         }; break;
         case READING_CHARACTERISTIC: {
-          //app_log("READING_CHARACTERISTIC_DONE\r\n");
-          nodes[index].gatt_state = READING_CHARACTERISTIC_DONE;
-
-          app_log("Node Read: %d\r\n", index);
-          /*for (uint16_t i = 0; i < PAYLOAD_SIZE; i++) {
-             app_log("%X", nodes[index].payload[i]);
-             }
-             app_log("\r\n");*/
+          // Go on with this peripheral right away, whatever the others do
+          on_read_completed(node, evt->data.evt_gatt_procedure_completed.result);
         }; break;
         default: break;
       }
@@ -215,21 +233,27 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 
     case sl_bt_evt_gatt_characteristic_id:
       app_log("Characteristics\r\n");
+
+      node = get_node(evt->data.evt_gatt_characteristic.connection);
+      if (node != NULL) {
+        node->characteristic = evt->data.evt_gatt_characteristic.characteristic;
+      }
       break;
 
     case sl_bt_evt_gatt_characteristic_value_id:
-      //app_log("Offset %d\r\n", evt->data.evt_gatt_characteristic_value.offset);
-      //app_log("Length %d\r\n", evt->data.evt_gatt_characteristic_value.value.len);
-      //app_log("Characteristic Value: %X\r\n", evt->data.evt_gatt_characteristic_value.value.data[0]);
-
-      index = get_peripheral_by_connection(evt->data.evt_gatt_characteristic_value.connection);
+      node = get_node(evt->data.evt_gatt_characteristic_value.connection);
+      if (node == NULL
+          || evt->data.evt_gatt_characteristic_value.offset
+          + evt->data.evt_gatt_characteristic_value.value.len > PAYLOAD_SIZE) {
+        break;
+      }
 
-      memcpy(&nodes[index].payload[evt->data.evt_gatt_characteristic_value.offset],
+      memcpy(&node->payload[evt->data.evt_gatt_characteristic_value.offset],
              evt->data.evt_gatt_characteristic_value.value.data,
              evt->data.evt_gatt_characteristic_value.value.len);
-
-      //app_log("Characteristic Value: %X %X\r\n", nodes[index].payload[evt->data.evt_gatt_characteristic_value.offset], nodes[index].payload[evt->data.evt_gatt_characteristic_value.value.len - 1]);
-
+      node->received = evt->data.evt_gatt_characteristic_value.offset
+                       + evt->data.evt_gatt_characteristic_value.value.len;
+      bytes_read += evt->data.evt_gatt_characteristic_value.value.len;
       break;
 
     // -------------------------------
@@ -237,8 +261,11 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_connection_closed_id:
       app_log("Disconnected: %d\r\n", evt->data.evt_connection_closed.connection);
 
-      index = get_peripheral_by_connection(evt->data.evt_connection_closed.connection);
-      nodes[index].connection = 0;
+      node = get_node(evt->data.evt_connection_closed.connection);
+      if (node != NULL) {
+        *node = empty_node;
+        node_index[evt->data.evt_connection_closed.connection] = NO_NODE;
+      }
       break;
 
     ///////////////////////////////////////////////////////////////////////////
@@ -254,6 +281,57 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   }
 }
 
+/***************************************************************************//**
+ * Read the payload from where the previous read procedure stopped. The stack
+ * continues with Read Blob requests until the server sends a short response
+ * or the rest of the payload is received.
+ ******************************************************************************/
+static sl_status_t read_payload(node_t *node)
+{
+  sl_status_t sc;
+
+  sc = sl_bt_gatt_read_characteristic_value_from_offset(node->connection,
+                                                        node->characteristic,
+                                                        node->received,
+                                                        PAYLOAD_SIZE - node->received);
+  if (sc == SL_STATUS_OK) {
+    node->read_offset = node->received;
+    node->gatt_state = READING_CHARACTERISTIC;
+  }
+  return sc;
+}
+
+/***************************************************************************//**
+ * Start the next read of a node. If it cannot be started, no procedure
+ * completion would ever come to start it again, so the connection is closed
+ * and the node freed once it is closed.
+ ******************************************************************************/
+static void read_next(node_t *node)
+{
+  sl_status_t sc = read_payload(node);
+
+  if (sc == SL_STATUS_OK) {
+    return;
+  }
+  app_log("Read of node %d not started: 0x%04lx\r\n", node_index[node->connection], sc);
+  node->gatt_state = DISCONNECTING;
+  // Fails if the connection is already closing
+  (void)sl_bt_connection_close(node->connection);
+}
+
+static void on_read_completed(node_t *node, uint16_t result)
+{
+  if (result != SL_STATUS_OK) {
+    app_log("Read of node %d failed: 0x%04x\r\n", node_index[node->connection], result);
+    node->received = 0;
+  } else if (node->received == PAYLOAD_SIZE || node->received == node->read_offset) {
+    // Complete, or the value is shorter than the payload
+    payloads_read++;
+    node->received = 0;
+  }
+  read_next(node);
+}
+
 static uint8_t find_name_in_advertisement(uint8_t *data, uint8_t len)
 {
   uint8_t ad_field_length;
@@ -286,19 +364,25 @@ static uint8_t find_name_in_advertisement(uint8_t *data, uint8_t len)
 /***************************************************************************//**
  * Timer Callbacks
  ******************************************************************************/
-static void app_characteristic_reading_timer_cb(app_timer_t *handle, void *data)
+static void app_throughput_timer_cb(app_timer_t *handle, void *data)
 {
   (void)data;
   (void)handle;
-  sl_status_t sc;
+  uint8_t reading = 0;
 
   for (uint8_t index = 0; index < PERIPHERAL_COUNT; index++) {
-    if (nodes[index].gatt_state == READING_CHARACTERISTIC_DONE) {
-      sc = sl_bt_gatt_read_characteristic_value_by_uuid(nodes[index].connection, nodes[index].service, sizeof(characteristics_uuid), characteristics_uuid);
-      app_assert_status(sc);
-      nodes[index].gatt_state = READING_CHARACTERISTIC;
+    if (nodes[index].gatt_state == READING_CHARACTERISTIC) {
+      reading++;
     }
   }
+  if (reading > 0) {
+    app_log("%d peripherals: %lu B/s, %lu payloads/s\r\n",
+            reading,
+            bytes_read * 1000 / APP_THROUGHPUT_TIMER_TIMEOUT,
+            payloads_read * 1000 / APP_THROUGHPUT_TIMER_TIMEOUT);
+  }
+  bytes_read = 0;
+  payloads_read = 0;
 }
 
 void app_button_press_cb(uint8_t button, uint8_t duration)
@@ -309,9 +393,7 @@ void app_button_press_cb(uint8_t button, uint8_t duration)
     case APP_BUTTON_PRESS_DURATION_LONG:
       // Handling of button press greater than 1s and less than 5s
       if (button == BUTTON_0) {
-        uint8_t index = get_peripheral_by_connection(0);
-
-        if (index == 6) {
+        if (get_free_node() == NO_NODE) {
           app_log("Peripherals pool exhausted!\r\n");
           return;
         }
@@ -325,14 +407,19 @@ void app_button_press_cb(uint8_t button, uint8_t duration)
   }
 }
 
-static uint8_t get_peripheral_by_connection(uint8_t connection)
+static uint8_t get_free_node(void)
 {
-  uint8_t index = 0;
-  while (index < PERIPHERAL_COUNT) {
-    if (nodes[index].connection == connection) {
-      break;
+  for (uint8_t index = 0; index < PERIPHERAL_COUNT; index++) {
+    if (nodes[index].gatt_state == IDLE) {
+      return index;
     }
-    index++;
   }
-  return index;
+  return NO_NODE;
+}
+
+static node_t *get_node(uint8_t connection)
+{
+  uint8_t index = node_index[connection];
+
+  return (index == NO_NODE) ? NULL : &nodes[index];
 }
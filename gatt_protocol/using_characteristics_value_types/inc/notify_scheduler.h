@@ -0,0 +1,150 @@
+/***************************************************************************//**
+ * @file notify_scheduler.h
+ * @brief Notification scheduler sharing one timer between characteristics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef NOTIFY_SCHEDULER_H
+#define NOTIFY_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Number of characteristics that can be scheduled.
+#ifndef NOTIFY_SCHEDULER_MAX_CHARACTERISTICS
+#define NOTIFY_SCHEDULER_MAX_CHARACTERISTICS  24
+#endif
+
+// Longest value sent. Notifications are limited to ATT_MTU - 3 bytes anyway.
+#ifndef NOTIFY_SCHEDULER_MAX_VALUE_LEN
+#define NOTIFY_SCHEDULER_MAX_VALUE_LEN        64
+#endif
+
+// External signal raised by the timer. Must not be used by the application.
+#ifndef NOTIFY_SCHEDULER_SIGNAL
+#define NOTIFY_SCHEDULER_SIGNAL               0x80000000
+#endif
+
+// Delay before a value is sent again when the stack is out of buffers.
+#ifndef NOTIFY_SCHEDULER_RETRY_MS
+#define NOTIFY_SCHEDULER_RETRY_MS             10
+#endif
+
+/***************************************************************************//**
+ * @brief Called when a characteristic is sent, to get its current value
+ *
+ * It is called again for the same value when the stack has no buffer for it,
+ * so it must not change the value. This is done by the sent callback.
+ *
+ * @param[in] characteristic Characteristic handle
+ * @param[out] value Buffer of NOTIFY_SCHEDULER_MAX_VALUE_LEN bytes
+ *
+ * @return Length of the value
+ ******************************************************************************/
+typedef uint16_t (*notify_scheduler_value_callback_t)(uint16_t characteristic,
+                                                      uint8_t *value);
+
+/***************************************************************************//**
+ * @brief Called when the stack accepted a value for sending
+ *
+ * @param[in] characteristic Characteristic handle
+ * @param[in] value Value sent
+ * @param[in] len Length of the value
+ ******************************************************************************/
+typedef void (*notify_scheduler_sent_callback_t)(uint16_t characteristic,
+                                                 const uint8_t *value,
+                                                 uint16_t len);
+
+/***************************************************************************//**
+ * @brief Scheduler statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t wakeups;         // Timer expiries and signals handled
+  uint32_t batches;         // Wakeups that sent at least one value
+  uint32_t notifications;   // Values given to the stack
+  uint32_t deliveries;      // Values times the connections subscribed to them
+  uint32_t retries;         // Values delayed for lack of stack buffers
+} notify_scheduler_stats_t;
+
+/***************************************************************************//**
+ *
+ * Forget all characteristics and subscriptions.
+ *
+ * @param[in] value_callback Function called to get the values to send
+ * @param[in] sent_callback Function called when a value was sent, or NULL
+ *
+ ******************************************************************************/
+void notify_scheduler_init(notify_scheduler_value_callback_t value_callback,
+                           notify_scheduler_sent_callback_t sent_callback);
+
+/***************************************************************************//**
+ *
+ * Schedule the notifications or indications of a characteristic.
+ *
+ * A changed value is sent once at least @p min_interval_ms have passed since
+ * the last one, and before @p max_interval_ms have passed. Within this window
+ * it is sent together with the other characteristics that are due, so that
+ * they share a wakeup and a connection event. A periodic characteristic is
+ * changed again each time it is sent, and is thus sent in every window while
+ * a client is subscribed.
+ *
+ * @param[in] characteristic Characteristic handle
+ * @param[in] min_interval_ms Shortest time between two values
+ * @param[in] max_interval_ms Longest time a changed value waits for the
+ *            others, no less than @p min_interval_ms
+ * @param[in] periodic Send the value in every window, changed or not
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_INVALID_PARAMETER if the
+ *         intervals are reversed, SL_STATUS_NO_MORE_RESOURCE if
+ *         NOTIFY_SCHEDULER_MAX_CHARACTERISTICS are already scheduled.
+ *
+ ******************************************************************************/
+sl_status_t notify_scheduler_add(uint16_t characteristic,
+                                 uint32_t min_interval_ms,
+                                 uint32_t max_interval_ms,
+                                 bool periodic);
+
+/***************************************************************************//**
+ *
+ * Mark the value of a characteristic as changed. It is sent at the end of
+ * its window, or earlier together with other characteristics.
+ *
+ * @param[in] characteristic Characteristic handle
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND if the
+ *         characteristic is not scheduled.
+ *
+ ******************************************************************************/
+sl_status_t notify_scheduler_set_changed(uint16_t characteristic);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler. Must be called from sl_bt_on_event().
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ ******************************************************************************/
+void notify_scheduler_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Retrieve the scheduler statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void notify_scheduler_get_stats(notify_scheduler_stats_t *stats);
+
+#endif // NOTIFY_SCHEDULER_H
@@ -20,11 +20,12 @@
 #include "gatt_db.h"
 #include "app.h"
 #include "app_log.h"
+#include "notify_scheduler.h"
 
-#define SIGNAL_NOTIFY_HEX    1
-#define SIGNAL_NOTIFY_USER   2
-
-#define TICKS_PER_SECOND    32768
+/* Notifications are sent every 2.5 to 3 seconds, in the same connection
+ * event when the windows of the two characteristics overlap */
+#define NOTIFY_MIN_INTERVAL_MS    2500
+#define NOTIFY_MAX_INTERVAL_MS    3000
 
 // The advertising set handle allocated from Bluetooth stack.
 static uint8_t advertising_set_handle = 0xff;
@@ -32,20 +33,22 @@ static uint8_t conn_handle = 0xff;
 /* Allocate buffer to store the ut_user characteristic value */
 static uint8_t user_char_buf[4] = { 0x02, 0x04, 0x08, 0x0A };
 
-static void notify(uint16_t which);
-
-sl_sleeptimer_timer_handle_t timer_handle_user, timer_handle_hex;
-void sleeptimer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static uint16_t notify_value(uint16_t characteristic, uint8_t *value);
+static void notify_sent(uint16_t characteristic, const uint8_t *value, uint16_t len);
 
 /**************************************************************************//**
  * Application Init.
  *****************************************************************************/
-SL_WEAK void app_init(void)
+void app_init(void)
 {
-  /////////////////////////////////////////////////////////////////////////////
-  // Put your additional application init code here!                         //
-  // This is called once during start-up.                                    //
-  /////////////////////////////////////////////////////////////////////////////
+  sl_status_t sc;
+
+  /* TAG: a single scheduler times the notifications of all characteristics */
+  notify_scheduler_init(notify_value, notify_sent);
+  sc = notify_scheduler_add(gattdb_vt_hex, NOTIFY_MIN_INTERVAL_MS, NOTIFY_MAX_INTERVAL_MS, true);
+  app_assert_status(sc);
+  sc = notify_scheduler_add(gattdb_vt_user, NOTIFY_MIN_INTERVAL_MS, NOTIFY_MAX_INTERVAL_MS, true);
+  app_assert_status(sc);
 }
 
 /**************************************************************************//**
@@ -72,6 +75,9 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   bd_addr address;
   uint8_t address_type;
   uint8_t system_id[8];
+  notify_scheduler_stats_t stats;
+
+  notify_scheduler_on_event(evt);
 
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
@@ -152,8 +158,11 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_connection_closed_id:
       app_log_info("connection closed, reason: 0x%2.2x\r\r\n", evt->data.evt_connection_closed.reason);
       conn_handle = 0xff;
-      sl_sleeptimer_stop_timer(&timer_handle_hex);
-      sl_sleeptimer_stop_timer(&timer_handle_user);
+      notify_scheduler_get_stats(&stats);
+      app_log_info("%lu notifications sent in %lu batches, %lu wakeups\r\n",
+                   (unsigned long)stats.notifications,
+                   (unsigned long)stats.batches,
+                   (unsigned long)stats.wakeups);
       // Restart advertising after client has disconnected.
       sc = sl_bt_legacy_advertiser_start(
         advertising_set_handle,
@@ -161,45 +170,8 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_assert_status(sc);
       break;
 
-    /* TAG: when the remote device subscribes for notification,
-     * start a timer to send out notifications periodically */
-    case sl_bt_evt_gatt_server_characteristic_status_id:
-      if (evt->data.evt_gatt_server_characteristic_status.status_flags
-          != sl_bt_gatt_server_client_config) {
-        break;
-      }
-      if (!(evt->data.evt_gatt_server_characteristic_status.characteristic
-            == gattdb_vt_hex
-            || evt->data.evt_gatt_server_characteristic_status.characteristic
-            == gattdb_vt_user)) {
-        break;
-      }
-      /* use the gattdb handle as the timer handle here */
-      if (evt->data.evt_gatt_server_characteristic_status.client_config_flags) {
-        if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_vt_user) {
-          sl_sleeptimer_start_periodic_timer(&timer_handle_user,
-                                             3 * TICKS_PER_SECOND, sleeptimer_callback, (void*)NULL, 0, 0);
-        } else if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_vt_hex) {
-          sl_sleeptimer_start_periodic_timer(&timer_handle_hex,
-                                             3 * TICKS_PER_SECOND, sleeptimer_callback, (void*)NULL, 0, 0);
-        }
-      } else {
-        if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_vt_user) {
-          sl_sleeptimer_stop_timer(&timer_handle_user);
-        } else if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_vt_hex) {
-          sl_sleeptimer_stop_timer(&timer_handle_hex);
-        }
-      }
-      break;
-
-    case sl_bt_evt_system_external_signal_id:
-      if (evt->data.evt_system_external_signal.extsignals & SIGNAL_NOTIFY_HEX) {
-        notify(gattdb_vt_hex);
-      }
-      if (evt->data.evt_system_external_signal.extsignals & SIGNAL_NOTIFY_USER) {
-        notify(gattdb_vt_user);
-      }
-      break;
+    /* TAG: subscriptions are tracked by notify_scheduler_on_event(), which
+     * sends the values of the subscribed characteristics periodically */
 
     /* TAG: When a "hex" type characteristic is written, the Bluetooth stack
      * stores the value and notifies the application about the change with this event */
@@ -207,6 +179,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       if (evt->data.evt_gatt_server_attribute_value.attribute == gattdb_vt_hex) {
         app_log_info("Characteristic <%u> value changed by a remote request.\r\n"
                      "Application callback here\r\n", gattdb_vt_hex);
+        notify_scheduler_set_changed(gattdb_vt_hex);
       }
       break;
 
@@ -244,6 +217,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
             evt->data.evt_gatt_server_user_write_request.characteristic,
             (uint8_t)SL_STATUS_OK);
           app_assert_status(sc);
+          notify_scheduler_set_changed(gattdb_vt_user);
         } else {
           sc = sl_bt_gatt_server_send_user_write_response(
             evt->data.evt_gatt_server_user_write_request.connection,
@@ -266,65 +240,51 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 }
 
 /*
- * For simplicity and demonstration the change, the function will increment
- * the first byte of the characteristic value and send.
+ * Called by the notification scheduler to get the value to send.
  */
-static void notify(uint16_t which)
+static uint16_t notify_value(uint16_t characteristic, uint8_t *value)
 {
   sl_status_t sc;
-  size_t len;
-  uint8_t data[4];
-
-  if (which == gattdb_vt_user) {
-    /* TAG: Example of sending notification for a "user" characteristic value
-     * and modify the value */
-    sc = sl_bt_gatt_server_send_notification(conn_handle,
-                                             which,
-                                             sizeof(user_char_buf),
-                                             user_char_buf);
-    app_assert_status(sc);
-    user_char_buf[0]++;
-  } else if (which  == gattdb_vt_hex) {
-    /* TAG: Example of sending notification for a "hex" characteristic value and
-     * modify the value */
-    uint8_t tmp[4] = { 0 };
-    sc = sl_bt_gatt_server_read_attribute_value(which,
+  size_t len = 0;
+
+  if (characteristic == gattdb_vt_user) {
+    /* TAG: Example of sending notification for a "user" characteristic value */
+    memcpy(value, user_char_buf, sizeof(user_char_buf));
+    return sizeof(user_char_buf);
+  } else if (characteristic == gattdb_vt_hex) {
+    /* TAG: Example of sending notification for a "hex" characteristic value */
+    sc = sl_bt_gatt_server_read_attribute_value(characteristic,
                                                 0,
                                                 4,
                                                 &len,
-                                                data);
+                                                value);
     app_assert_status(sc);
-    memcpy(tmp, data, 4);
+  }
+  return (uint16_t)len;
+}
 
-    sc = sl_bt_gatt_server_send_notification(conn_handle,
-                                             which,
-                                             4,
-                                             tmp);
-    app_assert_status(sc);
+/*
+ * Called by the notification scheduler once the stack accepted a value. For
+ * simplicity and demonstration the change, the function will increment the
+ * first byte of the characteristic value. A value the stack had no buffer
+ * for is sent again unchanged.
+ */
+static void notify_sent(uint16_t characteristic, const uint8_t *value, uint16_t len)
+{
+  sl_status_t sc;
+  uint8_t tmp[4] = { 0 };
+
+  if (characteristic == gattdb_vt_user) {
+    /* TAG: modify the "user" characteristic value */
+    user_char_buf[0]++;
+  } else if (characteristic == gattdb_vt_hex && len > 0) {
+    /* TAG: modify the "hex" characteristic value */
+    memcpy(tmp, value, len < sizeof(tmp) ? len : sizeof(tmp));
     tmp[0]++;
-    sc = sl_bt_gatt_server_write_attribute_value(which,
+    sc = sl_bt_gatt_server_write_attribute_value(characteristic,
                                                  0,
                                                  1,
                                                  tmp);
     app_assert_status(sc);
   }
 }
-
-/***************************************************************************//**
- * Sleeptimer callback
- *
- * Note: This function is called from interrupt context
- *
- * @param[in] handle Handle of the sleeptimer instance
- * @param[in] data  Callback data
- ******************************************************************************/
-void sleeptimer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
-{
-  (void)data;
-
-  if (handle == &timer_handle_hex) {
-    sl_bt_external_signal(SIGNAL_NOTIFY_HEX);
-  } else {
-    sl_bt_external_signal(SIGNAL_NOTIFY_USER);
-  }
-}
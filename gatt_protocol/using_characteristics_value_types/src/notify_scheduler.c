@@ -0,0 +1,283 @@
+/***************************************************************************//**
+ * @file notify_scheduler.c
+ * @brief Notification scheduler sharing one timer between characteristics.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "notify_scheduler.h"
+
+typedef struct {
+  uint16_t characteristic;
+  uint32_t min_interval_ms;
+  uint32_t max_interval_ms;
+  bool periodic;
+  bool changed;             // Value to send
+  bool sent;                // last_ms is valid
+  uint32_t subscribers;     // Bit of each subscribed connection handle
+  uint64_t last_ms;         // Time of the last value sent
+  uint64_t retry_ms;        // Not sent before, after a lack of buffers
+} characteristic_t;
+
+static characteristic_t characteristics[NOTIFY_SCHEDULER_MAX_CHARACTERISTICS];
+static uint8_t characteristic_count = 0;
+static notify_scheduler_value_callback_t value_callback = NULL;
+static notify_scheduler_sent_callback_t sent_callback = NULL;
+static notify_scheduler_stats_t stats;
+
+static sl_sleeptimer_timer_handle_t timer;
+static bool timer_running = false;
+static bool signal_pending = false;
+static uint64_t timer_expiry_ms;
+
+static uint64_t now_ms(void)
+{
+  uint64_t ms;
+
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+  return ms;
+}
+
+static characteristic_t *find_characteristic(uint16_t characteristic)
+{
+  for (uint8_t i = 0; i < characteristic_count; i++) {
+    if (characteristics[i].characteristic == characteristic) {
+      return &characteristics[i];
+    }
+  }
+  return NULL;
+}
+
+static uint32_t connection_bit(uint8_t connection)
+{
+  return 1UL << (connection % 32);
+}
+
+static uint8_t count_subscribers(uint32_t subscribers)
+{
+  uint8_t count = 0;
+
+  for (; subscribers != 0; subscribers &= subscribers - 1) {
+    count++;
+  }
+  return count;
+}
+
+static bool is_pending(const characteristic_t *c)
+{
+  return c->changed && c->subscribers != 0;
+}
+
+// Time from which the value may be sent
+static uint64_t earliest_ms(const characteristic_t *c)
+{
+  uint64_t ms = c->sent ? c->last_ms + c->min_interval_ms : 0;
+
+  return (ms > c->retry_ms) ? ms : c->retry_ms;
+}
+
+// Time by which the value must be sent
+static uint64_t deadline_ms(const characteristic_t *c)
+{
+  uint64_t ms = c->sent ? c->last_ms + c->max_interval_ms : 0;
+
+  return (ms > c->retry_ms) ? ms : c->retry_ms;
+}
+
+static void timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(NOTIFY_SCHEDULER_SIGNAL);
+}
+
+// Wake up at the first deadline, or at once if it has passed
+static void schedule(void)
+{
+  uint64_t next = UINT64_MAX;
+  uint64_t now;
+
+  for (uint8_t i = 0; i < characteristic_count; i++) {
+    if (is_pending(&characteristics[i]) && deadline_ms(&characteristics[i]) < next) {
+      next = deadline_ms(&characteristics[i]);
+    }
+  }
+  if (timer_running && (next == UINT64_MAX || next != timer_expiry_ms)) {
+    (void)sl_sleeptimer_stop_timer(&timer);
+    timer_running = false;
+  }
+  if (next == UINT64_MAX || timer_running || signal_pending) {
+    return;
+  }
+
+  now = now_ms();
+  if (next <= now) {
+    signal_pending = true;
+    sl_bt_external_signal(NOTIFY_SCHEDULER_SIGNAL);
+  } else if (sl_sleeptimer_start_timer_ms(&timer, (uint32_t)(next - now),
+                                          timer_callback, NULL, 0, 0) == SL_STATUS_OK) {
+    timer_running = true;
+    timer_expiry_ms = next;
+  }
+}
+
+// Send every changed value whose minimum interval has passed
+static void send_due(void)
+{
+  uint8_t value[NOTIFY_SCHEDULER_MAX_VALUE_LEN];
+  uint64_t now = now_ms();
+  bool batch = false;
+  uint16_t len;
+  sl_status_t sc;
+
+  stats.wakeups++;
+  for (uint8_t i = 0; i < characteristic_count; i++) {
+    characteristic_t *c = &characteristics[i];
+
+    if (!is_pending(c) || earliest_ms(c) > now) {
+      continue;
+    }
+    len = value_callback(c->characteristic, value);
+    // One send reaches all subscribed connections
+    sc = sl_bt_gatt_server_notify_all(c->characteristic, len, value);
+    if (sc == SL_STATUS_NO_MORE_RESOURCE) {
+      c->retry_ms = now + NOTIFY_SCHEDULER_RETRY_MS;
+      stats.retries++;
+      continue;
+    }
+    if (sc == SL_STATUS_OK) {
+      stats.notifications++;
+      stats.deliveries += count_subscribers(c->subscribers);
+      batch = true;
+      if (sent_callback != NULL) {
+        sent_callback(c->characteristic, value, len);
+      }
+    }
+    c->sent = true;
+    c->last_ms = now;
+    c->changed = c->periodic;
+  }
+  if (batch) {
+    stats.batches++;
+  }
+}
+
+void notify_scheduler_init(notify_scheduler_value_callback_t value_cb,
+                           notify_scheduler_sent_callback_t sent_cb)
+{
+  if (timer_running) {
+    (void)sl_sleeptimer_stop_timer(&timer);
+  }
+  memset(characteristics, 0, sizeof(characteristics));
+  memset(&stats, 0, sizeof(stats));
+  characteristic_count = 0;
+  value_callback = value_cb;
+  sent_callback = sent_cb;
+  timer_running = false;
+  signal_pending = false;
+}
+
+sl_status_t notify_scheduler_add(uint16_t characteristic,
+                                 uint32_t min_interval_ms,
+                                 uint32_t max_interval_ms,
+                                 bool periodic)
+{
+  characteristic_t *c = find_characteristic(characteristic);
+
+  if (min_interval_ms > max_interval_ms) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (c == NULL) {
+    if (characteristic_count == NOTIFY_SCHEDULER_MAX_CHARACTERISTICS) {
+      return SL_STATUS_NO_MORE_RESOURCE;
+    }
+    c = &characteristics[characteristic_count++];
+    memset(c, 0, sizeof(*c));
+    c->characteristic = characteristic;
+  }
+  c->min_interval_ms = min_interval_ms;
+  c->max_interval_ms = max_interval_ms;
+  c->periodic = periodic;
+  c->changed = periodic;
+  schedule();
+  return SL_STATUS_OK;
+}
+
+sl_status_t notify_scheduler_set_changed(uint16_t characteristic)
+{
+  characteristic_t *c = find_characteristic(characteristic);
+
+  if (c == NULL) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  if (!c->changed) {
+    c->changed = true;
+    schedule();
+  }
+  return SL_STATUS_OK;
+}
+
+void notify_scheduler_on_event(sl_bt_msg_t *evt)
+{
+  characteristic_t *c;
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_gatt_server_characteristic_status_id:
+      if (evt->data.evt_gatt_server_characteristic_status.status_flags
+          != sl_bt_gatt_server_client_config) {
+        break;
+      }
+      c = find_characteristic(evt->data.evt_gatt_server_characteristic_status.characteristic);
+      if (c == NULL) {
+        break;
+      }
+      if (evt->data.evt_gatt_server_characteristic_status.client_config_flags) {
+        // A new subscriber gets the current value
+        c->subscribers |= connection_bit(evt->data.evt_gatt_server_characteristic_status.connection);
+        c->changed = true;
+      } else {
+        c->subscribers &= ~connection_bit(evt->data.evt_gatt_server_characteristic_status.connection);
+      }
+      schedule();
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      for (uint8_t i = 0; i < characteristic_count; i++) {
+        characteristics[i].subscribers &= ~connection_bit(evt->data.evt_connection_closed.connection);
+      }
+      schedule();
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & NOTIFY_SCHEDULER_SIGNAL) {
+        // The signal may come from a timer restarted since
+        if (sl_sleeptimer_is_timer_running(&timer, &timer_running) != SL_STATUS_OK) {
+          timer_running = false;
+        }
+        signal_pending = false;
+        send_due();
+        schedule();
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void notify_scheduler_get_stats(notify_scheduler_stats_t *out)
+{
+  *out = stats;
+}
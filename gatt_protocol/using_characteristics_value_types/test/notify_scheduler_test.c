@@ -0,0 +1,419 @@
+/***************************************************************************//**
+ * @file notify_scheduler_test.c
+ * @brief Host test and benchmark of the notification scheduler.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/* Runs notify_scheduler.c in virtual time, with the sleeptimer, the external
+ * signals and the main loop replaced by the test. A notification given to the
+ * stack goes out in the next connection event.
+ *
+ * The benchmark schedules 20 periodic characteristics of 1 to 2.9 s periods
+ * for 10 minutes, and compares the wakeups and the connection events used
+ * with those of one periodic timer per characteristic. Every value must be
+ * sent within its window. The checks then cover several subscribers,
+ * characteristics sent on change, a stack out of buffers and the sent
+ * callback, which must see every value once and in order. Build and run on a
+ * PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I. -I../inc notify_scheduler_test.c ../src/notify_scheduler.c -o notify_scheduler_test
+ *   ./notify_scheduler_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "notify_scheduler.h"
+
+#define CHARACTERISTICS   20
+#define FIRST_HANDLE      10
+#define MAX_HANDLE        (FIRST_HANDLE + CHARACTERISTICS)
+#define CONN_INTERVAL_MS  30
+#define DURATION_MS       600000
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+// ---------------------------------------------------------------------------
+// Sleeptimer and signals
+
+static uint64_t now;
+static bool timer_running;
+static uint64_t timer_expiry;
+static sl_sleeptimer_timer_callback_t timer_callback;
+static unsigned timer_starts;
+static uint32_t signals;
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  return now;
+}
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms)
+{
+  *ms = tick;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle,
+                                         uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback,
+                                         void *callback_data,
+                                         uint8_t priority,
+                                         uint16_t option_flags)
+{
+  (void)handle;
+  (void)callback_data;
+  (void)priority;
+  (void)option_flags;
+  if (timer_running) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  timer_running = true;
+  timer_expiry = now + timeout_ms;
+  timer_callback = callback;
+  timer_starts++;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  (void)handle;
+  if (!timer_running) {
+    return SL_STATUS_INVALID_STATE;
+  }
+  timer_running = false;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle,
+                                           bool *running)
+{
+  (void)handle;
+  *running = timer_running;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_external_signal(uint32_t s)
+{
+  signals |= s;
+  return SL_STATUS_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Stack and application
+
+static sl_status_t refuse[4];       // Errors of the next sends, in order
+static unsigned refuse_count;
+static uint8_t conn_events[DURATION_MS / CONN_INTERVAL_MS + 2];
+static uint64_t last_sent[MAX_HANDLE + 1];
+static unsigned sends[MAX_HANDLE + 1];
+static uint32_t min_interval[MAX_HANDLE + 1];
+static uint32_t max_interval[MAX_HANDLE + 1];
+static uint8_t app_value[MAX_HANDLE + 1];     // Changed by the sent callback
+static uint8_t stack_value[MAX_HANDLE + 1];   // Last value the stack accepted
+static unsigned out_of_window;
+static unsigned skipped_values;
+
+sl_status_t sl_bt_gatt_server_notify_all(uint16_t characteristic,
+                                         size_t value_len,
+                                         const uint8_t *value)
+{
+  uint64_t event = (now + CONN_INTERVAL_MS - 1) / CONN_INTERVAL_MS;
+
+  if (refuse_count > 0) {
+    sl_status_t sc = refuse[0];
+
+    memmove(refuse, refuse + 1, sizeof(refuse) - sizeof(refuse[0]));
+    refuse_count--;
+    return sc;
+  }
+  if (sends[characteristic] > 0) {
+    uint64_t interval = now - last_sent[characteristic];
+
+    // A retry may end its window late, by the retry delay at most
+    if (interval < min_interval[characteristic]
+        || interval > max_interval[characteristic] + NOTIFY_SCHEDULER_RETRY_MS) {
+      out_of_window++;
+    }
+    if (value_len != 1 || value[0] != (uint8_t)(stack_value[characteristic] + 1)) {
+      skipped_values++;
+    }
+  }
+  stack_value[characteristic] = value[0];
+  last_sent[characteristic] = now;
+  sends[characteristic]++;
+  if (event < sizeof(conn_events)) {
+    conn_events[event] = 1;
+  }
+  return SL_STATUS_OK;
+}
+
+static uint16_t get_value(uint16_t characteristic, uint8_t *value)
+{
+  value[0] = app_value[characteristic];
+  return 1;
+}
+
+static void on_sent(uint16_t characteristic, const uint8_t *value, uint16_t len)
+{
+  CHECK(len == 1 && value[0] == app_value[characteristic]);
+  app_value[characteristic]++;
+}
+
+static void subscribe(uint8_t connection, uint16_t characteristic, uint16_t flags)
+{
+  sl_bt_msg_t evt;
+
+  memset(&evt, 0, sizeof(evt));
+  evt.header = sl_bt_evt_gatt_server_characteristic_status_id;
+  evt.data.evt_gatt_server_characteristic_status.connection = connection;
+  evt.data.evt_gatt_server_characteristic_status.characteristic = characteristic;
+  evt.data.evt_gatt_server_characteristic_status.status_flags = sl_bt_gatt_server_client_config;
+  evt.data.evt_gatt_server_characteristic_status.client_config_flags = flags;
+  notify_scheduler_on_event(&evt);
+}
+
+static void close_connection(uint8_t connection)
+{
+  sl_bt_msg_t evt;
+
+  memset(&evt, 0, sizeof(evt));
+  evt.header = sl_bt_evt_connection_closed_id;
+  evt.data.evt_connection_closed.connection = connection;
+  notify_scheduler_on_event(&evt);
+}
+
+// Main loop: handle the signals, else sleep until the timer or the end
+static void run_until(uint64_t end)
+{
+  sl_bt_msg_t evt;
+
+  for (;; ) {
+    if (signals != 0) {
+      memset(&evt, 0, sizeof(evt));
+      evt.header = sl_bt_evt_system_external_signal_id;
+      evt.data.evt_system_external_signal.extsignals = signals;
+      signals = 0;
+      notify_scheduler_on_event(&evt);
+    } else if (timer_running && timer_expiry <= end) {
+      now = timer_expiry;
+      timer_running = false;
+      timer_callback(NULL, NULL);
+    } else {
+      now = end;
+      return;
+    }
+  }
+}
+
+static void reset(void)
+{
+  now = 0;
+  timer_running = false;
+  timer_starts = 0;
+  signals = 0;
+  refuse_count = 0;
+  out_of_window = 0;
+  skipped_values = 0;
+  memset(conn_events, 0, sizeof(conn_events));
+  memset(sends, 0, sizeof(sends));
+  memset(app_value, 0, sizeof(app_value));
+  memset(stack_value, 0, sizeof(stack_value));
+  notify_scheduler_init(get_value, on_sent);
+}
+
+static unsigned count_conn_events(void)
+{
+  unsigned count = 0;
+
+  for (unsigned i = 0; i < sizeof(conn_events); i++) {
+    count += conn_events[i];
+  }
+  return count;
+}
+
+static uint32_t period_ms(unsigned i)
+{
+  return 1000 + 100 * i;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+
+// One periodic timer per characteristic
+static void benchmark_timers(void)
+{
+  unsigned wakeups = 0;
+
+  memset(conn_events, 0, sizeof(conn_events));
+  for (unsigned i = 0; i < CHARACTERISTICS; i++) {
+    for (uint64_t t = period_ms(i); t <= DURATION_MS; t += period_ms(i)) {
+      wakeups++;
+      conn_events[(t + CONN_INTERVAL_MS - 1) / CONN_INTERVAL_MS] = 1;
+    }
+  }
+  printf("%u timers:                   %5u wakeups, %5u connection events\n",
+         CHARACTERISTICS, wakeups, count_conn_events());
+}
+
+// The scheduler, with [min_percent * period, period] windows
+static void benchmark_scheduler(unsigned min_percent)
+{
+  notify_scheduler_stats_t stats;
+
+  reset();
+  for (unsigned i = 0; i < CHARACTERISTICS; i++) {
+    uint16_t handle = (uint16_t)(FIRST_HANDLE + i);
+
+    min_interval[handle] = period_ms(i) * min_percent / 100;
+    max_interval[handle] = period_ms(i);
+    CHECK(notify_scheduler_add(handle, min_interval[handle], max_interval[handle], true)
+          == SL_STATUS_OK);
+  }
+  // Nobody subscribed yet
+  CHECK(!timer_running && signals == 0);
+  for (unsigned i = 0; i < CHARACTERISTICS; i++) {
+    subscribe(1, (uint16_t)(FIRST_HANDLE + i), sl_bt_gatt_server_client_config);
+  }
+  run_until(DURATION_MS);
+  notify_scheduler_get_stats(&stats);
+  printf("scheduler, [0.%02u p, p] window: %5lu wakeups, %5u connection events, %5lu notifications\n",
+         min_percent, (unsigned long)stats.wakeups, count_conn_events(),
+         (unsigned long)stats.notifications);
+  CHECK(stats.wakeups == stats.batches);
+  CHECK(out_of_window == 0);
+  CHECK(skipped_values == 0);
+}
+
+// ---------------------------------------------------------------------------
+// Checks
+
+static void test_subscribers(void)
+{
+  notify_scheduler_stats_t before;
+  notify_scheduler_stats_t after;
+
+  benchmark_scheduler(75);
+  notify_scheduler_get_stats(&before);
+
+  // A second connection is reached by the same sends
+  for (unsigned i = 0; i < CHARACTERISTICS; i++) {
+    subscribe(2, (uint16_t)(FIRST_HANDLE + i), sl_bt_gatt_server_client_config);
+  }
+  run_until(now + 60000);
+  notify_scheduler_get_stats(&after);
+  CHECK(after.deliveries - before.deliveries == 2 * (after.notifications - before.notifications));
+
+  // The timer stops when nobody is subscribed
+  close_connection(2);
+  for (unsigned i = 0; i < CHARACTERISTICS; i++) {
+    subscribe(1, (uint16_t)(FIRST_HANDLE + i), 0);
+  }
+  CHECK(!timer_running);
+  CHECK(notify_scheduler_add(1, 10, 5, true) == SL_STATUS_INVALID_PARAMETER);
+  CHECK(notify_scheduler_set_changed(99) == SL_STATUS_NOT_FOUND);
+  CHECK(out_of_window == 0 && skipped_values == 0);
+}
+
+// A changed value waits for the window of a periodic one, and rides along
+static void test_on_change(void)
+{
+  uint64_t start;
+
+  reset();
+  min_interval[1] = 100;
+  max_interval[1] = 5000;
+  min_interval[2] = 1000;
+  max_interval[2] = 1000;
+  CHECK(notify_scheduler_add(1, 100, 5000, false) == SL_STATUS_OK);
+  CHECK(notify_scheduler_add(2, 1000, 1000, true) == SL_STATUS_OK);
+
+  // A new subscriber gets the current values
+  subscribe(1, 1, sl_bt_gatt_server_client_config);
+  subscribe(1, 2, sl_bt_gatt_server_client_config);
+  run_until(now + 1);
+  CHECK(sends[1] == 1 && sends[2] == 1);
+
+  start = now;
+  run_until(now + 300);
+  CHECK(notify_scheduler_set_changed(1) == SL_STATUS_OK);
+  run_until(now + 1);
+  CHECK(sends[1] == 1);
+  run_until(start + 1000);
+  CHECK(sends[1] == 2 && sends[2] == 2 && last_sent[1] == last_sent[2]);
+  CHECK(out_of_window == 0 && skipped_values == 0);
+}
+
+// A value the stack has no buffer for is sent again shortly after, unchanged,
+// and a value the stack refuses otherwise is dropped, unchanged
+static void test_refused(void)
+{
+  notify_scheduler_stats_t stats;
+
+  reset();
+  min_interval[2] = 1000;
+  max_interval[2] = 1000;
+  CHECK(notify_scheduler_add(2, 1000, 1000, true) == SL_STATUS_OK);
+  subscribe(1, 2, sl_bt_gatt_server_client_config);
+  run_until(now + 1);
+  CHECK(sends[2] == 1 && stack_value[2] == 0 && app_value[2] == 1);
+
+  refuse[0] = SL_STATUS_NO_MORE_RESOURCE;
+  refuse[1] = SL_STATUS_NO_MORE_RESOURCE;
+  refuse_count = 2;
+  run_until(now + 1000);
+  CHECK(sends[2] == 1 && app_value[2] == 1);
+  run_until(now + 2 * NOTIFY_SCHEDULER_RETRY_MS);
+  CHECK(sends[2] == 2 && stack_value[2] == 1 && app_value[2] == 2);
+
+  refuse[0] = SL_STATUS_FAIL;
+  refuse_count = 1;
+  run_until(last_sent[2] + 1000);
+  CHECK(sends[2] == 2 && app_value[2] == 2);
+  run_until(now + 1000);
+  CHECK(sends[2] == 3 && stack_value[2] == 2 && app_value[2] == 3);
+
+  notify_scheduler_get_stats(&stats);
+  CHECK(stats.retries == 2 && stats.notifications == 3);
+  CHECK(skipped_values == 0);
+}
+
+int main(void)
+{
+  printf("%u characteristics over %u s, %u ms connection interval\n",
+         CHARACTERISTICS, DURATION_MS / 1000, CONN_INTERVAL_MS);
+  benchmark_timers();
+  benchmark_scheduler(90);
+  test_subscribers();
+  test_on_change();
+  test_refused();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,79 @@
+/***************************************************************************//**
+ * @file sl_bluetooth.h
+ * @brief Host stand-in for the Bluetooth API of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/* Only what notify_scheduler.c uses, so it builds on a PC without the
+ * Simplicity SDK. The commands are implemented by the test. */
+
+#ifndef SL_BLUETOOTH_H
+#define SL_BLUETOOTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                  ((sl_status_t)0x0000)
+#define SL_STATUS_FAIL                ((sl_status_t)0x0001)
+#define SL_STATUS_INVALID_STATE       ((sl_status_t)0x0002)
+#define SL_STATUS_NOT_FOUND           ((sl_status_t)0x000C)
+#define SL_STATUS_NO_MORE_RESOURCE    ((sl_status_t)0x0019)
+#define SL_STATUS_INVALID_PARAMETER   ((sl_status_t)0x0021)
+
+#define SL_BT_MSG_ID(header)          ((header) & 0xffff00f8)
+
+#define sl_bt_evt_connection_closed_id                0x010600a0
+#define sl_bt_evt_gatt_server_characteristic_status_id 0x030a00a0
+#define sl_bt_evt_system_external_signal_id           0x030100a0
+
+typedef enum {
+  sl_bt_gatt_server_client_config = 0x1,
+  sl_bt_gatt_server_confirmation  = 0x2
+} sl_bt_gatt_server_characteristic_status_flag_t;
+
+typedef struct {
+  uint16_t reason;
+  uint8_t connection;
+} sl_bt_evt_connection_closed_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t characteristic;
+  uint8_t status_flags;
+  uint16_t client_config_flags;
+  uint16_t client_config;
+} sl_bt_evt_gatt_server_characteristic_status_t;
+
+typedef struct {
+  uint32_t extsignals;
+} sl_bt_evt_system_external_signal_t;
+
+typedef struct {
+  uint32_t header;
+  union {
+    sl_bt_evt_connection_closed_t evt_connection_closed;
+    sl_bt_evt_gatt_server_characteristic_status_t evt_gatt_server_characteristic_status;
+    sl_bt_evt_system_external_signal_t evt_system_external_signal;
+  } data;
+} sl_bt_msg_t;
+
+sl_status_t sl_bt_gatt_server_notify_all(uint16_t characteristic,
+                                         size_t value_len,
+                                         const uint8_t *value);
+
+sl_status_t sl_bt_external_signal(uint32_t signals);
+
+#endif // SL_BLUETOOTH_H
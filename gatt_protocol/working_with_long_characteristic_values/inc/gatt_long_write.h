@@ -0,0 +1,162 @@
+/***************************************************************************//**
+ * @file gatt_long_write.h
+ * @brief MTU-aware long characteristic writes of a GATT client.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef GATT_LONG_WRITE_H
+#define GATT_LONG_WRITE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bluetooth.h"
+
+// Number of connections that can write at the same time.
+#ifndef GATT_LONG_WRITE_MAX_CONNECTIONS
+#ifdef SL_BT_CONFIG_MAX_CONNECTIONS
+#define GATT_LONG_WRITE_MAX_CONNECTIONS     SL_BT_CONFIG_MAX_CONNECTIONS
+#else
+#define GATT_LONG_WRITE_MAX_CONNECTIONS     4
+#endif
+#endif
+
+// Limit of the Bluetooth specification. Longer data is streamed.
+#define GATT_LONG_WRITE_MAX_VALUE_LEN       512
+
+// Longest value a single stack command accepts.
+#define GATT_LONG_WRITE_MAX_COMMAND_LEN     255
+
+// Write flags
+#define GATT_LONG_WRITE_FLAG_VERIFY         0x01  // Verify the echo of every prepared write
+
+/***************************************************************************//**
+ * @brief Procedure used for a write
+ ******************************************************************************/
+typedef enum {
+  GATT_LONG_WRITE_MODE_FAST,      // One command, split by the stack if needed
+  GATT_LONG_WRITE_MODE_PREPARED,  // Prepared writes without echo verification
+  GATT_LONG_WRITE_MODE_RELIABLE,  // Prepared writes with echo verification
+  GATT_LONG_WRITE_MODE_STREAM,    // Writes without response
+  GATT_LONG_WRITE_MODE_COUNT
+} gatt_long_write_mode_t;
+
+/***************************************************************************//**
+ * @brief Outcome of a write
+ ******************************************************************************/
+typedef struct {
+  uint8_t connection;
+  uint16_t characteristic;
+  gatt_long_write_mode_t mode;
+  sl_status_t status;       // Procedure result, or the close reason
+  uint32_t len;             // Bytes written
+  uint32_t elapsed_ms;      // Until the last request was answered
+} gatt_long_write_result_t;
+
+/***************************************************************************//**
+ * @brief Called when a write is completed, has failed or its connection was
+ *        closed
+ ******************************************************************************/
+typedef void (*gatt_long_write_callback_t)(const gatt_long_write_result_t *result);
+
+/***************************************************************************//**
+ * @brief Statistics of one write mode
+ ******************************************************************************/
+typedef struct {
+  uint32_t writes;          // Completed writes
+  uint32_t failures;        // Failed or aborted writes
+  uint32_t bytes;           // Bytes of the completed writes
+  uint32_t ms;              // Time spent on the completed writes
+} gatt_long_write_stats_t;
+
+/***************************************************************************//**
+ *
+ * Forget all connections and writes.
+ *
+ * @param[in] callback Function called when a write ends
+ *
+ ******************************************************************************/
+void gatt_long_write_init(gatt_long_write_callback_t callback);
+
+/***************************************************************************//**
+ *
+ * Start writing a characteristic. The data is not copied: it must stay
+ * valid and unchanged until the callback is called.
+ *
+ * The mode is chosen from the length and @p flags:
+ * - Up to GATT_LONG_WRITE_MAX_COMMAND_LEN bytes without
+ *   GATT_LONG_WRITE_FLAG_VERIFY are given to the stack in one command. It
+ *   sends a single Write Request if they fit in ATT_MTU - 3 bytes, and
+ *   chains the prepared writes itself otherwise.
+ * - Up to GATT_LONG_WRITE_MAX_VALUE_LEN bytes are written with ATT_MTU - 5
+ *   byte prepared writes, each sent as soon as the previous one is
+ *   answered, and executed at once. With GATT_LONG_WRITE_FLAG_VERIFY the
+ *   echo of each one is verified, and the write is cancelled on a mismatch.
+ * - Longer data is streamed in ATT_MTU - 3 byte writes without response,
+ *   the stack queue being kept full from gatt_long_write_process_action().
+ *   The last part is a Write Request, so the write ends when the server
+ *   has received all of it. The characteristic must accept both. The
+ *   server gets no value, only the sequence of parts.
+ *
+ * SL_STATUS_BUSY will be returned if the connection is writing,
+ * SL_STATUS_INVALID_PARAMETER if @p len is 0, or above
+ * GATT_LONG_WRITE_MAX_VALUE_LEN with GATT_LONG_WRITE_FLAG_VERIFY.
+ *
+ * @param[in] connection Connection handle
+ * @param[in] characteristic Characteristic handle
+ * @param[in] data Data to write
+ * @param[in] len Length of the data
+ * @param[in] flags GATT_LONG_WRITE_FLAG_* bits
+ *
+ * @return SL_STATUS_OK if the write was started. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t gatt_long_write_start(uint8_t connection,
+                                  uint16_t characteristic,
+                                  const uint8_t *data,
+                                  uint32_t len,
+                                  uint8_t flags);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler. Must be called from sl_bt_on_event() before the
+ * application handles the event.
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ * @return true if the event was the completion of a procedure of the
+ *         engine, which the application must then ignore.
+ *
+ ******************************************************************************/
+bool gatt_long_write_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Queue the next parts of the streamed writes. Must be called from
+ * app_process_action().
+ *
+ ******************************************************************************/
+void gatt_long_write_process_action(void);
+
+/***************************************************************************//**
+ *
+ * Retrieve the statistics of a write mode.
+ *
+ * @param[in] mode Write mode
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void gatt_long_write_get_stats(gatt_long_write_mode_t mode,
+                               gatt_long_write_stats_t *stats);
+
+#endif // GATT_LONG_WRITE_H
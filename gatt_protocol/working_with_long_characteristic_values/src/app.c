@@ -20,6 +20,8 @@
 #include "gatt_db.h"
 #include "app.h"
 #include "app_log.h"
+#include "gatt_user_read.h"
+#include "gatt_long_write.h"
 #include "sl_simple_button_instances.h"
 
 #define BTN0_IRQ_EVENT  0x1
@@ -27,16 +29,8 @@
 
 static uint8_t find_service_in_advertisement(uint8_t *data,
                                              uint8_t len);
-static uint16_t queue_characteristic_chunk(uint8_t * data,
-                                           uint16_t len,
-                                           uint8_t connection,
-                                           uint16_t characteristic,
-                                           uint16_t offset);
-static uint16_t write_characteristic(uint8_t *data,
-                                     uint16_t len,
-                                     uint8_t connection,
-                                     uint16_t characteristic,
-                                     uint16_t offset);
+static void write_test_data(void);
+static void on_write_done(const gatt_long_write_result_t *result);
 static void set_mode(void);
 
 typedef enum {
@@ -46,15 +40,30 @@ typedef enum {
   DISCOVERING_SERVICES,
   DISCOVERING_CHARACTERISTICS,
   READING_CHARACTERISTIC,
-  PREPARING_LONG_WRITE,
-  EXECUTING_LONG_WRITE
+  WRITING
 } gatt_state_t;
 
-static uint16_t att_mtu = 0;
-
 static volatile bool is_central = false;
 static uint8_t long_data_buffer[512];
 static uint8_t test_data_to_write[512] = { 0xff, 0xfe };
+static uint8_t test_blob[4096];
+
+// Writes done on successive presses of PB1, one per write mode. Data longer
+// than test_data_to_write is taken from test_blob and streamed.
+static const struct {
+  uint32_t len;
+  uint8_t flags;
+} test_writes[] = {
+  { 20, 0 },                                                   // Single Write Request
+  { 200, 0 },                                                  // Long write by the stack
+  { sizeof(test_data_to_write), 0 },                           // Prepared writes
+  { sizeof(test_data_to_write), GATT_LONG_WRITE_FLAG_VERIFY }, // Verified prepared writes
+  { sizeof(test_blob), 0 },                                    // Stream
+};
+static const char *mode_names[GATT_LONG_WRITE_MODE_COUNT] = {
+  "fast", "prepared", "reliable", "stream"
+};
+static uint8_t write_step = 0;
 
 static const uint8_t advertised_service_uuid[16] = { 0x77,
                                                      0x23,
@@ -76,7 +85,8 @@ static gatt_state_t gatt_state;
 static uint8_t connection_handle = 0xff;
 static uint32_t service_handle = 0xffffffff;
 static uint16_t characteristic_handle = 0xffff;
-static uint16_t write_offset = 0;
+static uint16_t stream_handle = 0xffff;
+static uint32_t stream_bytes_received = 0;
 
 // The advertising set handle allocated from Bluetooth stack.
 static uint8_t advertising_set_handle = 0xff;
@@ -86,10 +96,23 @@ static uint8_t advertising_set_handle = 0xff;
  *****************************************************************************/
 SL_WEAK void app_init(void)
 {
+  sl_status_t sc;
+
   // Fill test data buffer
   for (uint16_t i = 0; i < sizeof(long_data_buffer); i++) {
     long_data_buffer[i] = i;
   }
+  for (uint16_t i = 0; i < sizeof(test_blob); i++) {
+    test_blob[i] = (uint8_t)(i * 7);
+  }
+  // Serve reads of the long characteristic from the buffer
+  sc = gatt_user_read_add_buffer(gattdb_long_data,
+                                 long_data_buffer,
+                                 sizeof(long_data_buffer));
+  app_assert(sc == SL_STATUS_OK,
+             "[E: 0x%04x] Failed to serve the long characteristic\n",
+             (int)sc);
+  gatt_long_write_init(on_write_done);
   /////////////////////////////////////////////////////////////////////////////
   // Put your additional application init code here!                         //
   // This is called once during start-up.                                    //
@@ -101,6 +124,9 @@ SL_WEAK void app_init(void)
  *****************************************************************************/
 SL_WEAK void app_process_action(void)
 {
+  // Keep the streamed writes going
+  gatt_long_write_process_action();
+
   /////////////////////////////////////////////////////////////////////////////
   // Put your additional application code here!                              //
   // This is called infinitely.                                              //
@@ -121,6 +147,13 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   uint8_t address_type;
   uint8_t system_id[8];
 
+  // The procedures of the writes of the central are handled here, the
+  // user reads of the served characteristics by the GATT Server User Read
+  // component
+  if (gatt_long_write_on_event(evt)) {
+    return;
+  }
+
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
     // This event indicates the device has started and the radio is ready.
@@ -227,6 +260,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_connection_opened_id:
       app_log("connection opened\r\n");
       connection_handle = evt->data.evt_connection_opened.connection;
+      stream_bytes_received = 0;
       if (is_central) {
         // Discover the service on the peripheral device
         sc = sl_bt_gatt_discover_primary_services(connection_handle);
@@ -264,22 +298,12 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
         set_mode();
       } else if (BTN1_IRQ_EVENT & evt->data.evt_system_external_signal.extsignals) {
         app_log("test data write.\r\n");
-        if ((connection_handle > 0) && (characteristic_handle == gattdb_long_data)) {
-          write_offset = write_characteristic(test_data_to_write,
-                                              sizeof(test_data_to_write),
-                                              connection_handle,
-                                              characteristic_handle,
-                                              write_offset);
+        if ((connection_handle != 0xff) && (characteristic_handle == gattdb_long_data)) {
+          write_test_data();
         }
       }
       break;
 
-    // -------------------------------
-    //  Indicates that an ATT_MTU exchange procedure is completed
-    case sl_bt_evt_gatt_mtu_exchanged_id:
-      att_mtu = evt->data.evt_gatt_mtu_exchanged.mtu;
-      break;
-
     // -------------------------------
     // This event is generated when a new service is discovered
     case sl_bt_evt_gatt_service_id:
@@ -301,6 +325,10 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
         // Save characteristic handle for future reference
         characteristic_handle = evt->data.evt_gatt_characteristic.characteristic;
       }
+      if ((evt->data.evt_gatt_characteristic.characteristic == gattdb_stream_data)
+          && is_central) {
+        stream_handle = evt->data.evt_gatt_characteristic.characteristic;
+      }
       break;
 
     // -------------------------------
@@ -340,27 +368,6 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
         app_log("Connected. Press PB1 on central to write test data\r\n");
         break;
       }
-      // If writing to the queue finished
-      if (gatt_state == PREPARING_LONG_WRITE) {
-        if (write_offset == (sizeof(test_data_to_write) - 1)) {
-          gatt_state = EXECUTING_LONG_WRITE;
-        } else {
-          write_offset += queue_characteristic_chunk(&test_data_to_write[write_offset],
-                                                     sizeof(test_data_to_write) - write_offset,
-                                                     connection_handle,
-                                                     characteristic_handle,
-                                                     write_offset);
-        }
-        break;
-      }
-
-      if (gatt_state == EXECUTING_LONG_WRITE) {
-        /* Procedure completed in this state means
-         * that the execute write is done,
-         * so go to idle mode */
-        gatt_state = IDLE;
-        break;
-      }
       break;
 
     // -------------------------------
@@ -373,36 +380,28 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
               evt->data.evt_gatt_characteristic_value.offset);
       break;
 
-    // -------------------------------
-    case sl_bt_evt_gatt_server_user_read_request_id:
-      if (evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_long_data) {
-        uint8_t offset = evt->data.evt_gatt_server_user_read_request.offset;
-        static uint16_t bytes_left_to_send = sizeof(long_data_buffer);
-        uint8_t bytes_in_this_tx = 0;
-        uint16_t sent_len;
-
-        if (bytes_left_to_send > att_mtu - 1) {
-          bytes_in_this_tx = att_mtu - 1;
-          bytes_left_to_send -= bytes_in_this_tx;
-        } else {
-          bytes_in_this_tx = bytes_left_to_send;
-          bytes_left_to_send = 0;     // reset for next time
-        }
+    case sl_bt_evt_gatt_server_user_write_request_id:
+      if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_stream_data) {
+        // Writes without response, and a Write Request for the last part
+        uint32_t previous = stream_bytes_received;
 
-        sc = sl_bt_gatt_server_send_user_read_response(
-          evt->data.evt_gatt_server_user_read_request.connection,
-          evt->data.evt_gatt_server_user_read_request.characteristic,
-          (uint8_t)SL_STATUS_OK,
-          bytes_in_this_tx,
-          &long_data_buffer[offset],
-          &sent_len);
-        app_assert(sc == SL_STATUS_OK,
-                   "[E: 0x%04x] Failed to send a response\n",
-                   (int)sc);
+        stream_bytes_received += evt->data.evt_gatt_server_user_write_request.value.len;
+        if (stream_bytes_received / 1024 != previous / 1024) {
+          app_log("Streamed %lu bytes\r\n", (unsigned long)stream_bytes_received);
+        }
+        if (evt->data.evt_gatt_server_user_write_request.att_opcode == sl_bt_gatt_write_request) {
+          app_log("Stream of %lu bytes ended\r\n", (unsigned long)stream_bytes_received);
+          stream_bytes_received = 0;
+          sc = sl_bt_gatt_server_send_user_write_response(
+            evt->data.evt_gatt_server_user_write_request.connection,
+            evt->data.evt_gatt_server_user_write_request.characteristic,
+            (uint8_t)SL_STATUS_OK);
+          app_assert(sc == SL_STATUS_OK,
+                     "[E: 0x%04x] Failed to send a write response\n",
+                     (int)sc);
+        }
+        break;
       }
-      break;
-
-    case sl_bt_evt_gatt_server_user_write_request_id:
       if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_long_data) {
         app_log_info("gatt_write_request opcode %2X, %d bytes at offset %d\r\n",
                      evt->data.evt_gatt_server_user_write_request.att_opcode,
@@ -500,77 +499,49 @@ static uint8_t find_service_in_advertisement(uint8_t *data, uint8_t len)
   return 0;
 }
 
-/*
- * @return number of bytes queued up
- */
-static uint16_t queue_characteristic_chunk(uint8_t * data,
-                                           uint16_t len,
-                                           uint8_t connection,
-                                           uint16_t characteristic,
-                                           uint16_t offset)
+// Write the test data with the next write mode
+static void write_test_data(void)
 {
-  uint8_t max_tx_size = att_mtu - 5;
-  uint16_t sent_len;
+  uint32_t len = test_writes[write_step].len;
   sl_status_t sc;
 
-  if (len > max_tx_size) {
-    sc = sl_bt_gatt_prepare_characteristic_value_write(connection,
-                                                       characteristic,
-                                                       offset,
-                                                       max_tx_size,
-                                                       data,
-                                                       &sent_len);
-    app_assert(sc == SL_STATUS_OK,
-               "[E: 0x%04x] Failed to prepare write\n",
-               (int)sc);
-    app_log("Wrote %d bytes to remote\r\n", sent_len);
-    return sent_len;
-  } else if (len) {
-    /* check to see if there is any data smaller than max_tx_size to be sent*/
-    sc = sl_bt_gatt_prepare_characteristic_value_write(connection,
-                                                       characteristic,
-                                                       offset,
-                                                       len,
-                                                       data,
-                                                       &sent_len);
-    app_assert(sc == SL_STATUS_OK,
-               "[E: 0x%04x] Failed to prepare write\n",
-               (int)sc);
-    app_log("Wrote %d bytes to remote\r\n", sent_len);
-    return sent_len;
-  } else { /* len == 0*/
-    /* part 3 executing the write*/
-    /* send all the queued blocks */
-    gatt_state = EXECUTING_LONG_WRITE;
-    sc = sl_bt_gatt_execute_characteristic_value_write(connection,
-                                                       (uint8_t)sl_bt_gatt_commit);
-    app_log("exec_result = 0x%X\r\n", sc);
+  if (gatt_state != CONNECTED) {
+    app_log("GATT busy, please try again later\r\n");
+    return;
   }
-
-  return 0;
+  if (len > sizeof(test_data_to_write)) {
+    sc = gatt_long_write_start(connection_handle, stream_handle, test_blob, len,
+                               test_writes[write_step].flags);
+  } else {
+    sc = gatt_long_write_start(connection_handle, characteristic_handle,
+                               test_data_to_write, len,
+                               test_writes[write_step].flags);
+  }
+  if (sc != SL_STATUS_OK) {
+    app_log("Failed to start the write: 0x%04x\r\n", (int)sc);
+    return;
+  }
+  gatt_state = WRITING;
+  write_step = (write_step + 1) % (sizeof(test_writes) / sizeof(test_writes[0]));
 }
 
-static uint16_t write_characteristic(uint8_t *data,
-                                     uint16_t len,
-                                     uint8_t connection,
-                                     uint16_t characteristic,
-                                     uint16_t offset)
+static void on_write_done(const gatt_long_write_result_t *result)
 {
-  /* Need to split this function into three parts
-   * so that the gatt_procedure_completed event can handle it. */
-  /* part 1 initiate the process */
-  if (gatt_state == CONNECTED) {
-    gatt_state = PREPARING_LONG_WRITE;
-    return queue_characteristic_chunk(data,
-                                      len,
-                                      connection,
-                                      characteristic,
-                                      offset);
-  } else {
-    app_log("GATT busy, please try again later\r\n");
-    return -1;
+  if (gatt_state == WRITING) {
+    gatt_state = CONNECTED;
+  }
+  if (result->status != SL_STATUS_OK) {
+    app_log("%s write of %lu bytes failed: 0x%04x\r\n",
+            mode_names[result->mode],
+            (unsigned long)result->len,
+            (int)result->status);
+    return;
   }
-  return SL_STATUS_OK;
+  app_log("%s write of %lu bytes: %lu ms, %lu ms/KB\r\n",
+          mode_names[result->mode],
+          (unsigned long)result->len,
+          (unsigned long)result->elapsed_ms,
+          (unsigned long)(((uint64_t)result->elapsed_ms * 1024) / result->len));
 }
 
 /*
@@ -0,0 +1,352 @@
+/***************************************************************************//**
+ * @file gatt_long_write.c
+ * @brief MTU-aware long characteristic writes of a GATT client.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "gatt_long_write.h"
+
+#define ATT_DEFAULT_MTU           23
+// A Write Command carries the opcode and the handle besides the value, a
+// Prepare Write Request also the offset.
+#define WRITE_COMMAND_OVERHEAD    3
+#define PREPARE_WRITE_OVERHEAD    5
+
+typedef enum {
+  WRITE_IDLE,
+  WRITE_FAST,               // Waiting for the stack to complete the command
+  WRITE_PREPARING,          // Waiting for the answer to a prepared write
+  WRITE_EXECUTING,          // Waiting for the answer to the execute request
+  WRITE_CANCELLING,         // Waiting for the prepared writes to be dropped
+  WRITE_STREAMING,          // Waiting for room in the stack queue
+  WRITE_STREAM_ENDING       // Waiting for the answer to the last part
+} write_state_t;
+
+typedef struct {
+  bool used;
+  uint8_t connection;
+  uint16_t mtu;
+  write_state_t state;
+  gatt_long_write_mode_t mode;
+  uint16_t characteristic;
+  const uint8_t *data;
+  uint32_t len;
+  uint32_t offset;          // Next byte to send
+  sl_status_t status;       // Failure reported once the write is cancelled
+  uint64_t start_tick;
+} connection_t;
+
+static connection_t connections[GATT_LONG_WRITE_MAX_CONNECTIONS];
+static gatt_long_write_callback_t done_callback = NULL;
+static gatt_long_write_stats_t stats[GATT_LONG_WRITE_MODE_COUNT];
+
+static connection_t *find_connection(uint8_t connection)
+{
+  for (uint8_t i = 0; i < GATT_LONG_WRITE_MAX_CONNECTIONS; i++) {
+    if (connections[i].used && connections[i].connection == connection) {
+      return &connections[i];
+    }
+  }
+  return NULL;
+}
+
+static connection_t *open_connection(uint8_t connection)
+{
+  connection_t *c = find_connection(connection);
+
+  for (uint8_t i = 0; c == NULL && i < GATT_LONG_WRITE_MAX_CONNECTIONS; i++) {
+    if (!connections[i].used) {
+      c = &connections[i];
+    }
+  }
+  if (c != NULL) {
+    memset(c, 0, sizeof(*c));
+    c->used = true;
+    c->connection = connection;
+    c->mtu = ATT_DEFAULT_MTU;
+  }
+  return c;
+}
+
+static void finish(connection_t *c, sl_status_t status)
+{
+  gatt_long_write_result_t result;
+  uint64_t ms;
+
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64() - c->start_tick, &ms);
+  result.connection = c->connection;
+  result.characteristic = c->characteristic;
+  result.mode = c->mode;
+  result.status = status;
+  result.len = c->len;
+  result.elapsed_ms = (uint32_t)ms;
+
+  if (status == SL_STATUS_OK) {
+    stats[c->mode].writes++;
+    stats[c->mode].bytes += c->len;
+    stats[c->mode].ms += result.elapsed_ms;
+  } else {
+    stats[c->mode].failures++;
+  }
+  // Idle before the callback, which may start the next write
+  c->state = WRITE_IDLE;
+  if (done_callback != NULL) {
+    done_callback(&result);
+  }
+}
+
+// Send the next prepared write, or the execute request once all are sent
+static sl_status_t send_prepared(connection_t *c)
+{
+  uint32_t len = c->len - c->offset;
+  uint16_t max_len = c->mtu - PREPARE_WRITE_OVERHEAD;
+  uint16_t sent_len = 0;
+  sl_status_t sc;
+
+  if (len == 0) {
+    c->state = WRITE_EXECUTING;
+    return sl_bt_gatt_execute_characteristic_value_write(c->connection,
+                                                         (uint8_t)sl_bt_gatt_commit);
+  }
+  if (len > max_len) {
+    len = max_len;
+  }
+  if (c->mode == GATT_LONG_WRITE_MODE_RELIABLE) {
+    sc = sl_bt_gatt_prepare_characteristic_value_reliable_write(c->connection,
+                                                                c->characteristic,
+                                                                (uint16_t)c->offset,
+                                                                len,
+                                                                &c->data[c->offset],
+                                                                &sent_len);
+  } else {
+    sc = sl_bt_gatt_prepare_characteristic_value_write(c->connection,
+                                                       c->characteristic,
+                                                       (uint16_t)c->offset,
+                                                       len,
+                                                       &c->data[c->offset],
+                                                       &sent_len);
+  }
+  if (sc == SL_STATUS_OK) {
+    c->offset += sent_len;
+  }
+  return sc;
+}
+
+// Drop the prepared writes the server has queued, then report the failure
+static void cancel(connection_t *c, sl_status_t status)
+{
+  c->status = status;
+  c->state = WRITE_CANCELLING;
+  if (sl_bt_gatt_execute_characteristic_value_write(c->connection,
+                                                    (uint8_t)sl_bt_gatt_cancel) != SL_STATUS_OK) {
+    finish(c, status);
+  }
+}
+
+// Fill the stack queue with writes without response. The last part is a
+// Write Request: the server answers it after all the previous parts, so its
+// completion is the end of the stream, not the queueing of the last part.
+static void stream(connection_t *c)
+{
+  uint32_t len;
+  uint16_t max_len = c->mtu - WRITE_COMMAND_OVERHEAD;
+  uint16_t sent_len;
+  sl_status_t sc;
+
+  while (c->offset < c->len) {
+    len = c->len - c->offset;
+    if (len <= max_len) {
+      sc = sl_bt_gatt_write_characteristic_value(c->connection,
+                                                 c->characteristic,
+                                                 len,
+                                                 &c->data[c->offset]);
+      if (sc == SL_STATUS_NO_MORE_RESOURCE) {
+        return;
+      }
+      if (sc != SL_STATUS_OK) {
+        finish(c, sc);
+        return;
+      }
+      c->offset = c->len;
+      c->state = WRITE_STREAM_ENDING;
+      return;
+    }
+    sent_len = 0;
+    sc = sl_bt_gatt_write_characteristic_value_without_response(c->connection,
+                                                                c->characteristic,
+                                                                max_len,
+                                                                &c->data[c->offset],
+                                                                &sent_len);
+    if (sc == SL_STATUS_NO_MORE_RESOURCE || (sc == SL_STATUS_OK && sent_len == 0)) {
+      // Retried from gatt_long_write_process_action()
+      return;
+    }
+    if (sc != SL_STATUS_OK) {
+      finish(c, sc);
+      return;
+    }
+    c->offset += sent_len;
+  }
+}
+
+static bool on_procedure_completed(connection_t *c, sl_status_t result)
+{
+  sl_status_t sc;
+
+  switch (c->state) {
+    case WRITE_FAST:
+    case WRITE_EXECUTING:
+    case WRITE_STREAM_ENDING:
+      finish(c, result);
+      return true;
+
+    case WRITE_PREPARING:
+      if (result != SL_STATUS_OK) {
+        cancel(c, result);
+        return true;
+      }
+      sc = send_prepared(c);
+      if (sc != SL_STATUS_OK) {
+        cancel(c, sc);
+      }
+      return true;
+
+    case WRITE_CANCELLING:
+      finish(c, c->status);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+void gatt_long_write_init(gatt_long_write_callback_t callback)
+{
+  memset(connections, 0, sizeof(connections));
+  memset(stats, 0, sizeof(stats));
+  done_callback = callback;
+}
+
+sl_status_t gatt_long_write_start(uint8_t connection,
+                                  uint16_t characteristic,
+                                  const uint8_t *data,
+                                  uint32_t len,
+                                  uint8_t flags)
+{
+  connection_t *c = find_connection(connection);
+  uint16_t mtu;
+  sl_status_t sc;
+
+  if (len == 0
+      || (len > GATT_LONG_WRITE_MAX_VALUE_LEN && (flags & GATT_LONG_WRITE_FLAG_VERIFY))) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (c != NULL && c->state != WRITE_IDLE) {
+    return SL_STATUS_BUSY;
+  }
+  // A connection opened before the engine was initialized
+  if (c == NULL) {
+    c = open_connection(connection);
+    if (c == NULL) {
+      return SL_STATUS_NO_MORE_RESOURCE;
+    }
+    if (sl_bt_gatt_server_get_mtu(connection, &mtu) == SL_STATUS_OK
+        && mtu >= ATT_DEFAULT_MTU) {
+      c->mtu = mtu;
+    }
+  }
+
+  c->characteristic = characteristic;
+  c->data = data;
+  c->len = len;
+  c->offset = 0;
+  c->start_tick = sl_sleeptimer_get_tick_count64();
+
+  if (len > GATT_LONG_WRITE_MAX_VALUE_LEN) {
+    c->mode = GATT_LONG_WRITE_MODE_STREAM;
+    c->state = WRITE_STREAMING;
+    stream(c);
+    return SL_STATUS_OK;
+  }
+  if (len <= GATT_LONG_WRITE_MAX_COMMAND_LEN && !(flags & GATT_LONG_WRITE_FLAG_VERIFY)) {
+    c->mode = GATT_LONG_WRITE_MODE_FAST;
+    c->state = WRITE_FAST;
+    sc = sl_bt_gatt_write_characteristic_value(connection, characteristic, len, data);
+  } else {
+    c->mode = (flags & GATT_LONG_WRITE_FLAG_VERIFY)
+              ? GATT_LONG_WRITE_MODE_RELIABLE : GATT_LONG_WRITE_MODE_PREPARED;
+    c->state = WRITE_PREPARING;
+    sc = send_prepared(c);
+  }
+  if (sc != SL_STATUS_OK) {
+    c->state = WRITE_IDLE;
+  }
+  return sc;
+}
+
+bool gatt_long_write_on_event(sl_bt_msg_t *evt)
+{
+  connection_t *c;
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_connection_opened_id:
+      (void)open_connection(evt->data.evt_connection_opened.connection);
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      c = find_connection(evt->data.evt_connection_closed.connection);
+      if (c != NULL) {
+        c->used = false;
+        if (c->state != WRITE_IDLE) {
+          finish(c, evt->data.evt_connection_closed.reason);
+        }
+      }
+      break;
+
+    case sl_bt_evt_gatt_mtu_exchanged_id:
+      c = find_connection(evt->data.evt_gatt_mtu_exchanged.connection);
+      if (c != NULL) {
+        c->mtu = evt->data.evt_gatt_mtu_exchanged.mtu;
+      }
+      break;
+
+    case sl_bt_evt_gatt_procedure_completed_id:
+      c = find_connection(evt->data.evt_gatt_procedure_completed.connection);
+      if (c != NULL) {
+        return on_procedure_completed(c, evt->data.evt_gatt_procedure_completed.result);
+      }
+      break;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+void gatt_long_write_process_action(void)
+{
+  for (uint8_t i = 0; i < GATT_LONG_WRITE_MAX_CONNECTIONS; i++) {
+    if (connections[i].used && connections[i].state == WRITE_STREAMING) {
+      stream(&connections[i]);
+    }
+  }
+}
+
+void gatt_long_write_get_stats(gatt_long_write_mode_t mode,
+                               gatt_long_write_stats_t *out)
+{
+  *out = stats[mode];
+}
@@ -0,0 +1,605 @@
+/***************************************************************************//**
+ * @file gatt_long_write_test.c
+ * @brief Host test of the long characteristic writes.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/* Runs gatt_long_write.c against a simulated connection: the client stack,
+ * the link and a GATT server. Every length from 1 to 1100 bytes, 4096 and
+ * 8192 bytes are written in every mode that takes them, at every ATT MTU
+ * from 23 to 247, and the server must end with the data. A write must not
+ * be reported done before the server has received all of it, nor a request
+ * sent while another one is outstanding. Failed verification, refused
+ * commands and a connection lost in the middle of a stream are checked too.
+ * Build and run on a PC:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I. -I../inc gatt_long_write_test.c ../src/gatt_long_write.c -o gatt_long_write_test
+ *   ./gatt_long_write_test
+ *
+ * The program prints the time per KB of each mode, and the failed checks.
+ * It exits with a non-zero status if there are any.
+ *
+ * Link model: a connection event every CONNECTION_INTERVAL_US, in which the
+ * client sends up to PACKETS_PER_EVENT PDUs, each in one packet. A request
+ * is answered in the next connection event. The client stack holds up to
+ * TX_QUEUE_LEN writes without response.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "sl_sleeptimer.h"
+#include "gatt_long_write.h"
+
+#define CONNECTION            1
+#define VALUE_CHARACTERISTIC  0x0020
+#define STREAM_CHARACTERISTIC 0x0030
+#define ATT_MIN_MTU           23
+#define ATT_MAX_MTU           247
+#define CONNECTION_INTERVAL_US 15000
+#define PACKETS_PER_EVENT     4
+#define TX_QUEUE_LEN          8
+#define MAX_DATA_LEN          8192
+#define MAX_EVENTS            100000
+#define ATT_ERROR             0x0401  // Result of a failed procedure
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+// ---------------------------------------------------------------------------
+// Client stack and link
+
+typedef enum {
+  PDU_WRITE_COMMAND,
+  PDU_WRITE_REQUEST,
+  PDU_PREPARE_WRITE,
+  PDU_EXECUTE_WRITE
+} pdu_type_t;
+
+typedef struct {
+  pdu_type_t type;
+  uint16_t characteristic;
+  uint16_t offset;
+  uint8_t flags;
+  uint16_t len;
+  uint8_t data[ATT_MAX_MTU];
+} pdu_t;
+
+static uint64_t now_us;
+static uint16_t mtu;
+
+// PDUs not sent yet, in order
+static pdu_t queue[TX_QUEUE_LEN + 2];
+static uint8_t queue_len;
+static uint8_t queued_commands;
+
+// The GATT procedure of the client: a single request, or the prepared
+// writes of a long write chained by the stack, sent one after the other
+static struct {
+  bool active;
+  bool awaiting_response;
+  bool response_due;        // Answered in the next connection event
+  bool reliable;
+  uint16_t result;
+  uint16_t characteristic;
+  const uint8_t *data;      // Long write by the stack
+  uint16_t len;
+  uint16_t offset;
+  bool executing;
+} procedure;
+
+static bool completion_pending;
+static uint16_t completion_result;
+static unsigned violations;  // Requests sent while another was outstanding
+static bool refuse_commands; // Writes without response refused as invalid
+static int corrupt_prepare = -1; // Offset of the prepared write to corrupt
+
+// ---------------------------------------------------------------------------
+// Server
+
+static uint8_t server_value[MAX_DATA_LEN];
+static uint32_t server_len;
+static uint8_t prepared_value[GATT_LONG_WRITE_MAX_VALUE_LEN];
+static uint32_t prepared_len;
+static uint64_t server_last_us;  // Time the last data was received
+
+static void server_receive(const pdu_t *pdu)
+{
+  server_last_us = now_us;
+  switch (pdu->type) {
+    case PDU_WRITE_COMMAND:
+      memcpy(&server_value[server_len], pdu->data, pdu->len);
+      server_len += pdu->len;
+      break;
+
+    case PDU_WRITE_REQUEST:
+      if (pdu->characteristic == STREAM_CHARACTERISTIC) {
+        memcpy(&server_value[server_len], pdu->data, pdu->len);
+        server_len += pdu->len;
+      } else {
+        memcpy(server_value, pdu->data, pdu->len);
+        server_len = pdu->len;
+      }
+      break;
+
+    case PDU_PREPARE_WRITE:
+      memcpy(&prepared_value[pdu->offset], pdu->data, pdu->len);
+      if (pdu->offset + pdu->len > prepared_len) {
+        prepared_len = pdu->offset + pdu->len;
+      }
+      break;
+
+    case PDU_EXECUTE_WRITE:
+      if (pdu->flags == sl_bt_gatt_commit) {
+        memcpy(server_value, prepared_value, prepared_len);
+        server_len = prepared_len;
+      }
+      prepared_len = 0;
+      break;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Stack commands
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  return now_us;
+}
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms)
+{
+  *ms = tick / 1000;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_server_get_mtu(uint8_t connection, uint16_t *out)
+{
+  (void)connection;
+  *out = mtu;
+  return SL_STATUS_OK;
+}
+
+static pdu_t *queue_pdu(pdu_type_t type, uint16_t characteristic,
+                        uint16_t offset, size_t len, const uint8_t *data)
+{
+  pdu_t *pdu = &queue[queue_len++];
+
+  pdu->type = type;
+  pdu->characteristic = characteristic;
+  pdu->offset = offset;
+  pdu->flags = 0;
+  pdu->len = (uint16_t)len;
+  if (len > 0) {
+    memcpy(pdu->data, data, len);
+  }
+  return pdu;
+}
+
+static sl_status_t start_procedure(void)
+{
+  if (procedure.active) {
+    violations++;
+    return SL_STATUS_BUSY;
+  }
+  memset(&procedure, 0, sizeof(procedure));
+  procedure.active = true;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_write_characteristic_value(uint8_t connection,
+                                                  uint16_t characteristic,
+                                                  size_t value_len,
+                                                  const uint8_t *value)
+{
+  sl_status_t sc;
+
+  (void)connection;
+  if (value_len > GATT_LONG_WRITE_MAX_COMMAND_LEN) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  sc = start_procedure();
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  if (value_len <= (size_t)(mtu - 3)) {
+    (void)queue_pdu(PDU_WRITE_REQUEST, characteristic, 0, value_len, value);
+  } else {
+    // The stack chains the prepared writes itself
+    procedure.characteristic = characteristic;
+    procedure.data = value;
+    procedure.len = (uint16_t)value_len;
+    procedure.offset = (uint16_t)((value_len < (size_t)(mtu - 5)) ? value_len : (size_t)(mtu - 5));
+    (void)queue_pdu(PDU_PREPARE_WRITE, characteristic, 0, procedure.offset, value);
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_write_characteristic_value_without_response(uint8_t connection,
+                                                                   uint16_t characteristic,
+                                                                   size_t value_len,
+                                                                   const uint8_t *value,
+                                                                   uint16_t *sent_len)
+{
+  (void)connection;
+  if (refuse_commands) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (value_len > (size_t)(mtu - 3)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  if (queued_commands == TX_QUEUE_LEN) {
+    return SL_STATUS_NO_MORE_RESOURCE;
+  }
+  (void)queue_pdu(PDU_WRITE_COMMAND, characteristic, 0, value_len, value);
+  queued_commands++;
+  *sent_len = (uint16_t)value_len;
+  return SL_STATUS_OK;
+}
+
+static sl_status_t prepare(uint16_t characteristic, uint16_t offset,
+                           size_t value_len, const uint8_t *value,
+                           uint16_t *sent_len, bool reliable)
+{
+  sl_status_t sc;
+  pdu_t *pdu;
+
+  if (value_len > (size_t)(mtu - 5)) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  sc = start_procedure();
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  procedure.reliable = reliable;
+  pdu = queue_pdu(PDU_PREPARE_WRITE, characteristic, offset, value_len, value);
+  if (reliable && corrupt_prepare == (int)offset) {
+    // Received differently than sent, so the echo does not match
+    pdu->data[0] ^= 0xFF;
+    procedure.result = ATT_ERROR;
+  }
+  *sent_len = (uint16_t)value_len;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_gatt_prepare_characteristic_value_write(uint8_t connection,
+                                                          uint16_t characteristic,
+                                                          uint16_t offset,
+                                                          size_t value_len,
+                                                          const uint8_t *value,
+                                                          uint16_t *sent_len)
+{
+  (void)connection;
+  return prepare(characteristic, offset, value_len, value, sent_len, false);
+}
+
+sl_status_t sl_bt_gatt_prepare_characteristic_value_reliable_write(uint8_t connection,
+                                                                   uint16_t characteristic,
+                                                                   uint16_t offset,
+                                                                   size_t value_len,
+                                                                   const uint8_t *value,
+                                                                   uint16_t *sent_len)
+{
+  (void)connection;
+  return prepare(characteristic, offset, value_len, value, sent_len, true);
+}
+
+sl_status_t sl_bt_gatt_execute_characteristic_value_write(uint8_t connection,
+                                                          uint8_t flags)
+{
+  sl_status_t sc;
+
+  (void)connection;
+  sc = start_procedure();
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  queue_pdu(PDU_EXECUTE_WRITE, 0, 0, 0, NULL)->flags = flags;
+  return SL_STATUS_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Link
+
+static gatt_long_write_result_t result;
+static bool done;
+
+static void on_done(const gatt_long_write_result_t *r)
+{
+  result = *r;
+  done = true;
+}
+
+static void deliver(sl_bt_msg_t *evt)
+{
+  (void)gatt_long_write_on_event(evt);
+}
+
+// The response to the request of the previous event, then the PDUs of
+// this event
+static void connection_event(void)
+{
+  uint8_t sent = 0;
+
+  if (procedure.response_due) {
+    procedure.response_due = false;
+    procedure.awaiting_response = false;
+    if (procedure.data != NULL && !procedure.executing && procedure.result == 0) {
+      // Next part of a long write by the stack, or its execution
+      uint16_t len = procedure.len - procedure.offset;
+
+      if (len == 0) {
+        procedure.executing = true;
+        queue_pdu(PDU_EXECUTE_WRITE, 0, 0, 0, NULL)->flags = sl_bt_gatt_commit;
+      } else {
+        if (len > mtu - 5) {
+          len = mtu - 5;
+        }
+        (void)queue_pdu(PDU_PREPARE_WRITE, procedure.characteristic,
+                        procedure.offset, len, &procedure.data[procedure.offset]);
+        procedure.offset += len;
+      }
+    } else {
+      procedure.active = false;
+      completion_pending = true;
+      completion_result = procedure.result;
+    }
+  }
+
+  while (queue_len > 0 && sent < PACKETS_PER_EVENT) {
+    if (queue[0].type != PDU_WRITE_COMMAND) {
+      if (procedure.awaiting_response) {
+        break;
+      }
+      procedure.awaiting_response = true;
+      procedure.response_due = true;
+    } else {
+      queued_commands--;
+    }
+    server_receive(&queue[0]);
+    memmove(&queue[0], &queue[1], --queue_len * sizeof(queue[0]));
+    sent++;
+  }
+}
+
+static void open_link(uint16_t link_mtu)
+{
+  sl_bt_msg_t evt;
+
+  memset(&procedure, 0, sizeof(procedure));
+  queue_len = 0;
+  queued_commands = 0;
+  completion_pending = false;
+  mtu = link_mtu;
+  evt.header = sl_bt_evt_connection_opened_id;
+  evt.data.evt_connection_opened.connection = CONNECTION;
+  deliver(&evt);
+  evt.header = sl_bt_evt_gatt_mtu_exchanged_id;
+  evt.data.evt_gatt_mtu_exchanged.connection = CONNECTION;
+  evt.data.evt_gatt_mtu_exchanged.mtu = link_mtu;
+  deliver(&evt);
+}
+
+static void close_link(uint16_t reason)
+{
+  sl_bt_msg_t evt;
+
+  memset(&procedure, 0, sizeof(procedure));
+  queue_len = 0;
+  queued_commands = 0;
+  completion_pending = false;
+  evt.header = sl_bt_evt_connection_closed_id;
+  evt.data.evt_connection_closed.connection = CONNECTION;
+  evt.data.evt_connection_closed.reason = reason;
+  deliver(&evt);
+}
+
+// Run connection events, with the main loop in between, until the write is
+// done or max_events have passed
+static void run(unsigned max_events)
+{
+  sl_bt_msg_t evt;
+
+  for (unsigned i = 0; i < max_events && !done; i++) {
+    now_us += CONNECTION_INTERVAL_US;
+    connection_event();
+    if (completion_pending) {
+      completion_pending = false;
+      evt.header = sl_bt_evt_gatt_procedure_completed_id;
+      evt.data.evt_gatt_procedure_completed.connection = CONNECTION;
+      evt.data.evt_gatt_procedure_completed.result = completion_result;
+      deliver(&evt);
+    }
+    gatt_long_write_process_action();
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Tests
+
+static uint8_t data[MAX_DATA_LEN];
+
+static bool write(uint16_t characteristic, uint32_t len, uint8_t flags)
+{
+  server_len = 0;
+  prepared_len = 0;
+  done = false;
+  if (gatt_long_write_start(CONNECTION, characteristic, data, len, flags) != SL_STATUS_OK) {
+    return false;
+  }
+  run(MAX_EVENTS);
+  return done;
+}
+
+// Every length in every mode at every MTU. A write is reported done once
+// the server has the data, and not before it received the last of it.
+static void test_modes(void)
+{
+  static const uint32_t long_lens[] = { 4096, MAX_DATA_LEN };
+  unsigned writes = 0;
+  uint64_t start;
+
+  for (uint32_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 7 + (i >> 8));
+  }
+  gatt_long_write_init(on_done);
+  for (uint16_t link_mtu = ATT_MIN_MTU; link_mtu <= ATT_MAX_MTU; link_mtu++) {
+    open_link(link_mtu);
+    for (uint32_t len = 1; len <= 1100 + 2; len++) {
+      uint32_t write_len = (len <= 1100) ? len : long_lens[len - 1101];
+
+      for (uint8_t flags = 0; flags <= GATT_LONG_WRITE_FLAG_VERIFY; flags++) {
+        uint16_t characteristic = (write_len > GATT_LONG_WRITE_MAX_VALUE_LEN)
+                                  ? STREAM_CHARACTERISTIC : VALUE_CHARACTERISTIC;
+
+        if (flags && write_len > GATT_LONG_WRITE_MAX_VALUE_LEN) {
+          continue;
+        }
+        start = now_us;
+        if (!write(characteristic, write_len, flags)
+            || result.status != SL_STATUS_OK
+            || result.len != write_len
+            || server_len != write_len
+            || memcmp(server_value, data, write_len) != 0
+            || result.elapsed_ms < (server_last_us - start) / 1000) {
+          printf("write of %lu bytes with flags %u at MTU %u failed\n",
+                 (unsigned long)write_len, flags, link_mtu);
+          failures++;
+        }
+        writes++;
+      }
+    }
+    close_link(0);
+  }
+  CHECK(violations == 0);
+  printf("%u writes, lengths 1..1100, 4096 and %u at every MTU %u..%u\n",
+         writes, MAX_DATA_LEN, ATT_MIN_MTU, ATT_MAX_MTU);
+}
+
+// Time per KB of the writes the example does
+static void test_speed(void)
+{
+  static const struct {
+    uint32_t len;
+    uint8_t flags;
+  } writes[] = {
+    { 200, 0 },
+    { GATT_LONG_WRITE_MAX_VALUE_LEN, 0 },
+    { GATT_LONG_WRITE_MAX_VALUE_LEN, GATT_LONG_WRITE_FLAG_VERIFY },
+    { 4096, 0 },
+  };
+  static const char *names[] = { "fast", "prepared", "reliable", "stream" };
+  static const uint16_t mtus[] = { ATT_MIN_MTU, ATT_MAX_MTU };
+
+  printf("ms/KB at a %u ms interval, %u packets per event:\n",
+         CONNECTION_INTERVAL_US / 1000, PACKETS_PER_EVENT);
+  gatt_long_write_init(on_done);
+  for (uint8_t m = 0; m < sizeof(mtus) / sizeof(mtus[0]); m++) {
+    open_link(mtus[m]);
+    printf("  MTU %3u:", mtus[m]);
+    for (uint8_t w = 0; w < sizeof(writes) / sizeof(writes[0]); w++) {
+      uint16_t characteristic = (writes[w].len > GATT_LONG_WRITE_MAX_VALUE_LEN)
+                                ? STREAM_CHARACTERISTIC : VALUE_CHARACTERISTIC;
+
+      CHECK(write(characteristic, writes[w].len, writes[w].flags));
+      CHECK(result.mode == (gatt_long_write_mode_t)w);
+      printf(" %s %lu", names[w],
+             (unsigned long)(((uint64_t)result.elapsed_ms * 1024) / result.len));
+    }
+    printf("\n");
+    close_link(0);
+  }
+}
+
+// A prepared write received wrong is cancelled on the server
+static void test_verify_failure(void)
+{
+  gatt_long_write_stats_t stats;
+
+  gatt_long_write_init(on_done);
+  open_link(ATT_MIN_MTU);
+  memset(server_value, 0, sizeof(server_value));
+  corrupt_prepare = 3 * (ATT_MIN_MTU - 5);
+  CHECK(write(VALUE_CHARACTERISTIC, 300, GATT_LONG_WRITE_FLAG_VERIFY));
+  corrupt_prepare = -1;
+  CHECK(result.status == ATT_ERROR);
+  CHECK(result.mode == GATT_LONG_WRITE_MODE_RELIABLE);
+  CHECK(server_len == 0);
+  CHECK(prepared_len == 0);
+  gatt_long_write_get_stats(GATT_LONG_WRITE_MODE_RELIABLE, &stats);
+  CHECK(stats.failures == 1 && stats.writes == 0);
+
+  // The connection is free for the next write
+  CHECK(write(VALUE_CHARACTERISTIC, 300, GATT_LONG_WRITE_FLAG_VERIFY));
+  CHECK(result.status == SL_STATUS_OK && server_len == 300);
+  close_link(0);
+}
+
+// Streams that end early
+static void test_stream_failures(void)
+{
+  gatt_long_write_stats_t stats;
+
+  gatt_long_write_init(on_done);
+  open_link(ATT_MAX_MTU);
+
+  // Commands refused by the stack
+  refuse_commands = true;
+  done = false;
+  CHECK(gatt_long_write_start(CONNECTION, STREAM_CHARACTERISTIC, data, 4096, 0) == SL_STATUS_OK);
+  refuse_commands = false;
+  CHECK(done && result.status == SL_STATUS_INVALID_PARAMETER);
+
+  // Connection lost in the middle
+  done = false;
+  server_len = 0;
+  CHECK(gatt_long_write_start(CONNECTION, STREAM_CHARACTERISTIC, data, 4096, 0) == SL_STATUS_OK);
+  CHECK(gatt_long_write_start(CONNECTION, VALUE_CHARACTERISTIC, data, 10, 0) == SL_STATUS_BUSY);
+  run(3);
+  CHECK(!done && server_len > 0 && server_len < 4096);
+  close_link(0x0208);
+  CHECK(done && result.status == 0x0208);
+  gatt_long_write_get_stats(GATT_LONG_WRITE_MODE_STREAM, &stats);
+  CHECK(stats.failures == 2 && stats.writes == 0);
+
+  // Invalid writes
+  open_link(ATT_MAX_MTU);
+  CHECK(gatt_long_write_start(CONNECTION, VALUE_CHARACTERISTIC, data, 0, 0)
+        == SL_STATUS_INVALID_PARAMETER);
+  CHECK(gatt_long_write_start(CONNECTION, STREAM_CHARACTERISTIC, data, 600,
+                              GATT_LONG_WRITE_FLAG_VERIFY)
+        == SL_STATUS_INVALID_PARAMETER);
+  close_link(0);
+}
+
+int main(void)
+{
+  test_modes();
+  test_speed();
+  test_verify_failure();
+  test_stream_failures();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,106 @@
+/***************************************************************************//**
+ * @file sl_bluetooth.h
+ * @brief Host stand-in for the Bluetooth API of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/* Only what gatt_long_write.c uses, so it builds on a PC without the
+ * Simplicity SDK. The commands are implemented by the test. */
+
+#ifndef SL_BLUETOOTH_H
+#define SL_BLUETOOTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t sl_status_t;
+
+#define SL_STATUS_OK                  ((sl_status_t)0x0000)
+#define SL_STATUS_FAIL                ((sl_status_t)0x0001)
+#define SL_STATUS_BUSY                ((sl_status_t)0x0004)
+#define SL_STATUS_INVALID_PARAMETER   ((sl_status_t)0x0021)
+#define SL_STATUS_NO_MORE_RESOURCE    ((sl_status_t)0x0019)
+
+#define SL_BT_MSG_ID(header)          ((header) & 0xffff00f8)
+
+#define sl_bt_evt_connection_opened_id              0x000600a0
+#define sl_bt_evt_connection_closed_id              0x010600a0
+#define sl_bt_evt_gatt_mtu_exchanged_id             0x000900a0
+#define sl_bt_evt_gatt_procedure_completed_id       0x060900a0
+
+typedef enum {
+  sl_bt_gatt_cancel = 0x0,
+  sl_bt_gatt_commit = 0x1
+} sl_bt_gatt_execute_write_flag_t;
+
+typedef struct {
+  uint8_t connection;
+} sl_bt_evt_connection_opened_t;
+
+typedef struct {
+  uint16_t reason;
+  uint8_t connection;
+} sl_bt_evt_connection_closed_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t mtu;
+} sl_bt_evt_gatt_mtu_exchanged_t;
+
+typedef struct {
+  uint8_t connection;
+  uint16_t result;
+} sl_bt_evt_gatt_procedure_completed_t;
+
+typedef struct {
+  uint32_t header;
+  union {
+    sl_bt_evt_connection_opened_t evt_connection_opened;
+    sl_bt_evt_connection_closed_t evt_connection_closed;
+    sl_bt_evt_gatt_mtu_exchanged_t evt_gatt_mtu_exchanged;
+    sl_bt_evt_gatt_procedure_completed_t evt_gatt_procedure_completed;
+  } data;
+} sl_bt_msg_t;
+
+sl_status_t sl_bt_gatt_server_get_mtu(uint8_t connection, uint16_t *mtu);
+
+sl_status_t sl_bt_gatt_write_characteristic_value(uint8_t connection,
+                                                  uint16_t characteristic,
+                                                  size_t value_len,
+                                                  const uint8_t *value);
+
+sl_status_t sl_bt_gatt_write_characteristic_value_without_response(uint8_t connection,
+                                                                   uint16_t characteristic,
+                                                                   size_t value_len,
+                                                                   const uint8_t *value,
+                                                                   uint16_t *sent_len);
+
+sl_status_t sl_bt_gatt_prepare_characteristic_value_write(uint8_t connection,
+                                                          uint16_t characteristic,
+                                                          uint16_t offset,
+                                                          size_t value_len,
+                                                          const uint8_t *value,
+                                                          uint16_t *sent_len);
+
+sl_status_t sl_bt_gatt_prepare_characteristic_value_reliable_write(uint8_t connection,
+                                                                   uint16_t characteristic,
+                                                                   uint16_t offset,
+                                                                   size_t value_len,
+                                                                   const uint8_t *value,
+                                                                   uint16_t *sent_len);
+
+sl_status_t sl_bt_gatt_execute_characteristic_value_write(uint8_t connection,
+                                                          uint8_t flags);
+
+#endif // SL_BLUETOOTH_H
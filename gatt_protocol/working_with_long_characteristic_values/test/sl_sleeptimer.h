@@ -0,0 +1,31 @@
+/***************************************************************************//**
+ * @file sl_sleeptimer.h
+ * @brief Host stand-in for the sleeptimer of the SDK.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/* Only what gatt_long_write.c uses, so it builds on a PC without the
+ * Simplicity SDK. The functions are implemented by the test. */
+
+#ifndef SL_SLEEPTIMER_H
+#define SL_SLEEPTIMER_H
+
+#include <stdint.h>
+#include "sl_bluetooth.h"
+
+uint64_t sl_sleeptimer_get_tick_count64(void);
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms);
+
+#endif // SL_SLEEPTIMER_H
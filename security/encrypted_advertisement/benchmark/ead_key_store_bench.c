@@ -0,0 +1,409 @@
+/***************************************************************************//**
+ * @file ead_key_store_bench.c
+ * @brief Host benchmark of the EAD key store.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Feeds reports of many encrypted advertisers to the key store and compares
+ * it with a scanner that searches its keys linearly and decrypts every
+ * report. The EAD core API is replaced by a software AES-CCM, so the
+ * absolute figures are those of the PC. Build and run on a PC:
+ *
+ *   gcc -O2 -std=gnu11 -I. -I../inc/scanner \
+ *       ead_key_store_bench.c ../src/scanner/ead_key_store.c -o ead_key_store_bench
+ *   ./ead_key_store_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ead_key_store.h"
+
+#define ADVERTISERS             EAD_KEY_STORE_MAX_KEYS
+#define REPORTS                 2000000
+// An advertiser refreshing its data every 500 ms, heard every 50 ms
+#define REPORTS_PER_CHANGE      10
+#define VERSIONS                8
+#define DATA_LEN                12
+#define AD_LEN                  (DATA_LEN + 2 + SL_BT_EAD_RANDOMIZER_SIZE + SL_BT_EAD_MIC_SIZE)
+
+// -----------------------------------------------------------------------------
+// AES-128, encryption only, which is all CCM needs
+
+static const uint8_t sbox[256] = {
+  0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+  0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+  0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+  0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+  0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+  0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+  0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+  0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+  0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+  0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+  0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+  0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+  0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+  0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+  0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+  0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static uint8_t xtime(uint8_t x)
+{
+  return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+static void aes128_expand_key(const uint8_t *key, uint8_t *round_keys)
+{
+  uint8_t rcon = 1;
+
+  memcpy(round_keys, key, 16);
+  for (int i = 16; i < 176; i += 4) {
+    uint8_t t[4];
+
+    memcpy(t, &round_keys[i - 4], 4);
+    if (i % 16 == 0) {
+      uint8_t first = t[0];
+
+      t[0] = sbox[t[1]] ^ rcon;
+      t[1] = sbox[t[2]];
+      t[2] = sbox[t[3]];
+      t[3] = sbox[first];
+      rcon = xtime(rcon);
+    }
+    for (int j = 0; j < 4; j++) {
+      round_keys[i + j] = round_keys[i - 16 + j] ^ t[j];
+    }
+  }
+}
+
+static void aes128_encrypt(const uint8_t *round_keys, const uint8_t *in, uint8_t *out)
+{
+  uint8_t s[16];
+
+  for (int i = 0; i < 16; i++) {
+    s[i] = in[i] ^ round_keys[i];
+  }
+  for (int round = 1; round <= 10; round++) {
+    uint8_t t[16];
+
+    // SubBytes and ShiftRows; the state is stored column by column
+    for (int c = 0; c < 4; c++) {
+      for (int r = 0; r < 4; r++) {
+        t[4 * c + r] = sbox[s[4 * ((c + r) % 4) + r]];
+      }
+    }
+    if (round < 10) {
+      for (int c = 0; c < 4; c++) {
+        uint8_t *col = &t[4 * c];
+        uint8_t all = col[0] ^ col[1] ^ col[2] ^ col[3];
+        uint8_t first = col[0];
+
+        col[0] ^= all ^ xtime(col[0] ^ col[1]);
+        col[1] ^= all ^ xtime(col[1] ^ col[2]);
+        col[2] ^= all ^ xtime(col[2] ^ col[3]);
+        col[3] ^= all ^ xtime(col[3] ^ first);
+      }
+    }
+    for (int i = 0; i < 16; i++) {
+      s[i] = t[i] ^ round_keys[16 * round + i];
+    }
+  }
+  memcpy(out, s, 16);
+}
+
+// -----------------------------------------------------------------------------
+// CCM as used by EAD: 13-byte nonce (randomizer, IV), 4-byte MIC and the
+// one byte of additional data 0xEA
+
+#define EAD_AAD   0xEA
+
+static void ccm_block(uint8_t *block, uint8_t flags, const struct sl_bt_ead_nonce_s *nonce, uint16_t value)
+{
+  block[0] = flags;
+  memcpy(&block[1], nonce->randomizer, SL_BT_EAD_RANDOMIZER_SIZE);
+  memcpy(&block[1 + SL_BT_EAD_RANDOMIZER_SIZE], nonce->iv, SL_BT_EAD_IV_SIZE);
+  block[14] = (uint8_t)(value >> 8);
+  block[15] = (uint8_t)value;
+}
+
+// CBC-MAC of the plaintext, then CTR over the plaintext and the MAC
+static void ccm_mac(const uint8_t *round_keys, const struct sl_bt_ead_nonce_s *nonce,
+                    const uint8_t *plain, uint8_t len, uint8_t *mac)
+{
+  uint8_t x[16];
+  uint8_t b[16];
+
+  ccm_block(b, 0x49, nonce, len); // Adata, M = 4, L = 2
+  aes128_encrypt(round_keys, b, x);
+  memset(b, 0, sizeof(b));
+  b[1] = 1;
+  b[2] = EAD_AAD;
+  for (int i = 0; i < 16; i++) {
+    x[i] ^= b[i];
+  }
+  aes128_encrypt(round_keys, x, x);
+  for (uint8_t i = 0; i < len; i += 16) {
+    for (uint8_t j = 0; j < 16 && i + j < len; j++) {
+      x[j] ^= plain[i + j];
+    }
+    aes128_encrypt(round_keys, x, x);
+  }
+  memcpy(mac, x, SL_BT_EAD_MIC_SIZE);
+}
+
+static void ccm_ctr(const uint8_t *round_keys, const struct sl_bt_ead_nonce_s *nonce,
+                    uint8_t *data, uint8_t len, uint8_t *mic)
+{
+  uint8_t a[16];
+  uint8_t s[16];
+
+  ccm_block(a, 0x01, nonce, 0);
+  aes128_encrypt(round_keys, a, s);
+  for (int i = 0; i < SL_BT_EAD_MIC_SIZE; i++) {
+    mic[i] ^= s[i];
+  }
+  for (uint8_t i = 0; i < len; i += 16) {
+    ccm_block(a, 0x01, nonce, (uint16_t)(i / 16 + 1));
+    aes128_encrypt(round_keys, a, s);
+    for (uint8_t j = 0; j < 16 && i + j < len; j++) {
+      data[i + j] ^= s[j];
+    }
+  }
+}
+
+sl_status_t sl_bt_ead_encrypt(sl_bt_ead_key_material_p key_material,
+                              sl_bt_ead_nonce_p nonce,
+                              uint8_t length,
+                              void *data,
+                              sl_bt_ead_mic_t mic)
+{
+  uint8_t round_keys[176];
+
+  aes128_expand_key(key_material->key, round_keys);
+  ccm_mac(round_keys, nonce, data, length, mic);
+  ccm_ctr(round_keys, nonce, data, length, mic);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_bt_ead_decrypt(sl_bt_ead_key_material_p key_material,
+                              sl_bt_ead_nonce_p nonce,
+                              sl_bt_ead_mic_t mic,
+                              uint8_t length,
+                              void *data)
+{
+  uint8_t round_keys[176];
+  uint8_t expected[SL_BT_EAD_MIC_SIZE];
+  uint8_t received[SL_BT_EAD_MIC_SIZE];
+
+  aes128_expand_key(key_material->key, round_keys);
+  memcpy(received, mic, SL_BT_EAD_MIC_SIZE);
+  ccm_ctr(round_keys, nonce, data, length, received);
+  ccm_mac(round_keys, nonce, data, length, expected);
+  return memcmp(expected, received, SL_BT_EAD_MIC_SIZE) == 0
+         ? SL_STATUS_OK : SL_STATUS_SECURITY_DECRYPT_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// Benchmark
+
+typedef struct {
+  uint8_t address[EAD_KEY_STORE_ADDRESS_LEN];
+  struct sl_bt_ead_key_material_s key_material;
+  uint8_t ad[VERSIONS][AD_LEN];
+  uint8_t plain[VERSIONS][DATA_LEN];
+  uint32_t heard;
+  uint8_t last[DATA_LEN];       // Data the scanner holds
+} advertiser_t;
+
+static advertiser_t advertisers[ADVERTISERS];
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static double now_s(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static void setup(void)
+{
+  for (int i = 0; i < ADVERTISERS; i++) {
+    advertiser_t *a = &advertisers[i];
+
+    for (int j = 0; j < EAD_KEY_STORE_ADDRESS_LEN; j++) {
+      a->address[j] = (uint8_t)rng();
+    }
+    for (int j = 0; j < SL_BT_EAD_SESSION_KEY_SIZE; j++) {
+      a->key_material.key[j] = (uint8_t)rng();
+    }
+    for (int j = 0; j < SL_BT_EAD_IV_SIZE; j++) {
+      a->key_material.iv[j] = (uint8_t)rng();
+    }
+    // Successive versions of the data, each with its own randomizer
+    for (int v = 0; v < VERSIONS; v++) {
+      struct sl_bt_ead_nonce_s nonce;
+      uint8_t *ad = a->ad[v];
+
+      for (int j = 0; j < DATA_LEN; j++) {
+        a->plain[v][j] = (uint8_t)rng();
+      }
+      for (int j = 0; j < SL_BT_EAD_RANDOMIZER_SIZE; j++) {
+        nonce.randomizer[j] = (uint8_t)rng();
+      }
+      memcpy(nonce.iv, a->key_material.iv, SL_BT_EAD_IV_SIZE);
+      ad[0] = AD_LEN - 1;
+      ad[1] = SL_BT_ENCRYPTED_DATA_AD_TYPE;
+      memcpy(&ad[2], nonce.randomizer, SL_BT_EAD_RANDOMIZER_SIZE);
+      memcpy(&ad[7], a->plain[v], DATA_LEN);
+      sl_bt_ead_encrypt(&a->key_material, &nonce, DATA_LEN, &ad[7], &ad[7 + DATA_LEN]);
+    }
+  }
+}
+
+// Next report: a random advertiser, with the data version it sends now
+static advertiser_t *next_report(const uint8_t **ad, int *version)
+{
+  advertiser_t *a = &advertisers[rng() % ADVERTISERS];
+
+  *version = (a->heard++ / REPORTS_PER_CHANGE) % VERSIONS;
+  *ad = a->ad[*version];
+  return a;
+}
+
+static void reset_reports(void)
+{
+  rng_state = 0xCAFEBABE;
+  for (int i = 0; i < ADVERTISERS; i++) {
+    advertisers[i].heard = 0;
+  }
+}
+
+// The scanner before the key store: a linear search for the key and a
+// decryption of every report
+static double run_linear(uint32_t *errors)
+{
+  double start = now_s();
+
+  for (uint32_t r = 0; r < REPORTS; r++) {
+    const uint8_t *ad;
+    int version;
+    advertiser_t *a = next_report(&ad, &version);
+    struct sl_bt_ead_nonce_s nonce;
+    sl_bt_ead_mic_t mic;
+    uint8_t data[DATA_LEN];
+    int k;
+
+    for (k = 0; k < ADVERTISERS; k++) {
+      if (memcmp(advertisers[k].address, a->address, EAD_KEY_STORE_ADDRESS_LEN) == 0) {
+        break;
+      }
+    }
+    memcpy(nonce.randomizer, &ad[2], SL_BT_EAD_RANDOMIZER_SIZE);
+    memcpy(nonce.iv, advertisers[k].key_material.iv, SL_BT_EAD_IV_SIZE);
+    memcpy(mic, &ad[7 + DATA_LEN], SL_BT_EAD_MIC_SIZE);
+    memcpy(data, &ad[7], DATA_LEN);
+    if (sl_bt_ead_decrypt(&advertisers[k].key_material, &nonce, mic, DATA_LEN, data) != SL_STATUS_OK
+        || memcmp(data, a->plain[version], DATA_LEN) != 0) {
+      (*errors)++;
+    }
+  }
+  return now_s() - start;
+}
+
+static double run_store(uint32_t *errors)
+{
+  double start = now_s();
+
+  for (uint32_t r = 0; r < REPORTS; r++) {
+    const uint8_t *ad;
+    int version;
+    advertiser_t *a = next_report(&ad, &version);
+    uint8_t data[DATA_LEN];
+    uint8_t len = sizeof(data);
+
+    switch (ead_key_store_decrypt(a->address, 0, ad, AD_LEN, data, &len)) {
+      case ead_key_store_decrypted:
+        memcpy(a->last, data, DATA_LEN);
+        break;
+      case ead_key_store_unchanged:
+        break;
+      default:
+        (*errors)++;
+        continue;
+    }
+    if (memcmp(a->last, a->plain[version], DATA_LEN) != 0) {
+      (*errors)++;
+    }
+  }
+  return now_s() - start;
+}
+
+int main(void)
+{
+  ead_key_store_stats_t stats;
+  uint32_t linear_errors = 0;
+  uint32_t store_errors = 0;
+  double linear_s;
+  double store_s;
+
+  setup();
+  ead_key_store_init();
+  for (int i = 0; i < ADVERTISERS; i++) {
+    if (ead_key_store_add(advertisers[i].address, 0, &advertisers[i].key_material) != SL_STATUS_OK) {
+      printf("failed to store key %d\n", i);
+      return 1;
+    }
+  }
+
+  reset_reports();
+  linear_s = run_linear(&linear_errors);
+  reset_reports();
+  store_s = run_store(&store_errors);
+  ead_key_store_get_stats(&stats);
+
+  printf("%d advertisers, %d reports, data changing every %d reports\n",
+         ADVERTISERS, REPORTS, REPORTS_PER_CHANGE);
+  printf("linear search, decrypt every report: %7.1f ns/report, %u errors\n",
+         linear_s * 1e9 / REPORTS, linear_errors);
+  printf("key store, decrypt on change:        %7.1f ns/report, %u errors\n",
+         store_s * 1e9 / REPORTS, store_errors);
+  printf("  %u decrypted, %u unchanged, %.2f probes per lookup\n",
+         stats.decrypted, stats.unchanged, (double)stats.probes / stats.lookups);
+  return (linear_errors || store_errors) ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+/***************************************************************************//**
+ * @file sl_bt_ead_core.h
+ * @brief Host stand-in for the EAD core API, backed by a software AES-CCM.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+/* Types and the decryption function of the EAD core API that
+ * ead_key_store.c uses. The implementation is in ead_key_store_bench.c. */
+
+#ifndef SL_BT_EAD_CORE_H
+#define SL_BT_EAD_CORE_H
+
+#include <stdint.h>
+#include "sl_status.h"
+
+#define SL_BT_ENCRYPTED_DATA_AD_TYPE  0x31
+#define SL_BT_EAD_SESSION_KEY_SIZE    16
+#define SL_BT_EAD_IV_SIZE             8
+#define SL_BT_EAD_RANDOMIZER_SIZE     5
+#define SL_BT_EAD_MIC_SIZE            4
+
+typedef uint8_t sl_bt_ead_session_key_t[SL_BT_EAD_SESSION_KEY_SIZE];
+typedef uint8_t sl_bt_ead_iv_t[SL_BT_EAD_IV_SIZE];
+typedef uint8_t sl_bt_ead_randomizer_t[SL_BT_EAD_RANDOMIZER_SIZE];
+typedef uint8_t sl_bt_ead_mic_t[SL_BT_EAD_MIC_SIZE];
+
+struct sl_bt_ead_key_material_s {
+  sl_bt_ead_session_key_t key;
+  sl_bt_ead_iv_t iv;
+};
+typedef struct sl_bt_ead_key_material_s *sl_bt_ead_key_material_p;
+
+struct sl_bt_ead_nonce_s {
+  sl_bt_ead_randomizer_t randomizer;
+  sl_bt_ead_iv_t iv;
+};
+typedef struct sl_bt_ead_nonce_s *sl_bt_ead_nonce_p;
+
+sl_status_t sl_bt_ead_encrypt(sl_bt_ead_key_material_p key_material,
+                              sl_bt_ead_nonce_p nonce,
+                              uint8_t length,
+                              void *data,
+                              sl_bt_ead_mic_t mic);
+
+sl_status_t sl_bt_ead_decrypt(sl_bt_ead_key_material_p key_material,
+                              sl_bt_ead_nonce_p nonce,
+                              sl_bt_ead_mic_t mic,
+                              uint8_t length,
+                              void *data);
+
+#endif
@@ -0,0 +1,126 @@
+/***************************************************************************//**
+ * @file ead_key_rotation.h
+ * @brief Key epochs and batched key distribution of the encrypted advertiser.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef EAD_KEY_ROTATION_H
+#define EAD_KEY_ROTATION_H
+
+#include <stdint.h>
+#include "sl_bt_api.h"
+#include "sl_bt_ead_core.h"
+
+// Length of a key epoch. The key material of the next epoch is generated
+// and distributed when an epoch begins, so scanners can fetch it at any
+// time during the epoch.
+#ifndef EAD_KEY_ROTATION_EPOCH_S
+#define EAD_KEY_ROTATION_EPOCH_S          600
+#endif
+
+// Connections that can read the key distribution record at the same time.
+#ifndef EAD_KEY_ROTATION_MAX_READERS
+#define EAD_KEY_ROTATION_MAX_READERS      4
+#endif
+
+// External signal of the rollover timer. Must not collide with the signals
+// of the application.
+#ifndef EAD_KEY_ROTATION_SIGNAL
+#define EAD_KEY_ROTATION_SIGNAL           0x10
+#endif
+
+// Key distribution record, all fields little endian:
+//   version (1) | key count (1) | epoch of the first key (2) |
+//   time to the next rollover in ms (4) | epoch length in s (4) |
+//   key material of the epoch (24) | key material of the next epoch (24)
+// The key count is 1 while the key material of the next epoch could not be
+// generated.
+#define EAD_KEY_ROTATION_RECORD_VERSION   1
+#define EAD_KEY_ROTATION_HEADER_LEN       12
+#define EAD_KEY_ROTATION_RECORD_LEN       (EAD_KEY_ROTATION_HEADER_LEN + 2 * SL_BT_EAD_KEY_MATERIAL_SIZE)
+
+/***************************************************************************//**
+ * @brief Called at a rollover with the key material of the new epoch
+ ******************************************************************************/
+typedef void (*ead_key_rotation_callback_t)(sl_bt_ead_key_material_p key_material,
+                                            uint16_t epoch);
+
+/***************************************************************************//**
+ * @brief Rotation statistics
+ ******************************************************************************/
+typedef struct {
+  uint16_t epoch;          // Current epoch
+  uint32_t rollovers;
+  uint32_t postponed;      // Rollovers postponed by a missing next key
+  uint32_t reads;          // Key distribution records read from offset 0
+  uint32_t blob_reads;     // Following parts of long reads
+  uint32_t failures;       // Key generation or response failures
+} ead_key_rotation_stats_t;
+
+/***************************************************************************//**
+ *
+ * Generate the key material of the first two epochs, publish the first one
+ * in the Encrypted Data Key Material characteristic and start the epoch
+ * timer.
+ *
+ * @param[in] rollover_callback Function called at every rollover
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t ead_key_rotation_init(ead_key_rotation_callback_t rollover_callback);
+
+/***************************************************************************//**
+ *
+ * Retrieve the key material of the current epoch.
+ *
+ * @return Key material, valid until the next rollover.
+ *
+ ******************************************************************************/
+sl_bt_ead_key_material_p ead_key_rotation_get_key(void);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler of the rotation: the rollover signal, the user
+ * read requests of the key distribution characteristic and the closed
+ * connections. Must be called from sl_bt_on_event().
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ ******************************************************************************/
+void ead_key_rotation_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Retrieve the rotation statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void ead_key_rotation_get_stats(ead_key_rotation_stats_t *stats);
+
+#endif // EAD_KEY_ROTATION_H
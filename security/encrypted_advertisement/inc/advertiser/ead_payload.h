@@ -0,0 +1,154 @@
+/***************************************************************************//**
+ * @file ead_payload.h
+ * @brief Allocation-free, double-buffered encrypted advertising payload.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef EAD_PAYLOAD_H
+#define EAD_PAYLOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_bt_api.h"
+#include "sl_bt_ead_core.h"
+
+// Largest extended advertising data the payload is built in.
+#ifndef EAD_PAYLOAD_MAX_LEN
+#define EAD_PAYLOAD_MAX_LEN     0xBF
+#endif
+
+// Bytes the Encrypted Data AD structure adds to the encrypted AD structure:
+// length, AD type, randomizer and MIC.
+#define EAD_PAYLOAD_OVERHEAD    (2 + SL_BT_EAD_RANDOMIZER_SIZE + SL_BT_EAD_MIC_SIZE)
+
+/***************************************************************************//**
+ * @brief Payload statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t refreshes;        // Payloads swapped in
+  uint32_t address_changes;  // Refreshes that also changed the RPA
+  uint32_t failures;         // Refreshes that kept the previous payload
+} ead_payload_stats_t;
+
+/***************************************************************************//**
+ *
+ * Prepare both payload buffers of an advertising set: the unencrypted AD
+ * structures, which never change, and the position of the Encrypted Data AD
+ * structure behind them.
+ *
+ * @param[in] advertising_set Advertising set handle
+ * @param[in] key_material Key material, must stay valid
+ * @param[in] nonce Initial nonce, holding the IV of the key material
+ * @param[in] plain Unencrypted AD structures, e.g. flags and name
+ * @param[in] plain_len Length of @p plain
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_WOULD_OVERFLOW if @p plain
+ *         leaves no room for an encrypted AD structure.
+ *
+ ******************************************************************************/
+sl_status_t ead_payload_init(uint8_t advertising_set,
+                             sl_bt_ead_key_material_p key_material,
+                             const struct sl_bt_ead_nonce_s *nonce,
+                             const uint8_t *plain,
+                             uint8_t plain_len);
+
+/***************************************************************************//**
+ *
+ * Build the next payload in the inactive buffer and swap it in.
+ *
+ * A new randomizer is drawn and @p ad is encrypted directly into the
+ * Encrypted Data AD structure of the inactive buffer. The buffer is then
+ * set as advertising data; with @p change_address, the advertiser is
+ * stopped, given a new resolvable private address and restarted around it,
+ * so the address and the randomizer always change together. While the set
+ * is not advertising, e.g. during a connection, it is never restarted: the
+ * new address is used from the next ead_payload_start(). If any step fails,
+ * the previous payload and randomizer stay in use.
+ *
+ * @param[in] ad AD structure to encrypt, e.g. manufacturer specific data
+ * @param[in] len Length of @p ad
+ * @param[in] change_address Also change the resolvable private address
+ *
+ * @return SL_STATUS_OK if successful. Error code otherwise.
+ *
+ ******************************************************************************/
+sl_status_t ead_payload_refresh(const uint8_t *ad, uint8_t len, bool change_address);
+
+/***************************************************************************//**
+ *
+ * Encrypt the following payloads with new key material, e.g. at a key
+ * rollover. The advertised payload keeps the previous key until the next
+ * refresh.
+ *
+ * @param[in] key_material Key material, must stay valid
+ *
+ ******************************************************************************/
+void ead_payload_set_key(sl_bt_ead_key_material_p key_material);
+
+/***************************************************************************//**
+ *
+ * Start connectable extended advertising with the active payload, e.g.
+ * at boot or when a connection is closed.
+ *
+ * @return SL_STATUS_OK if successful or already advertising. Error code
+ *         otherwise.
+ *
+ ******************************************************************************/
+sl_status_t ead_payload_start(void);
+
+/***************************************************************************//**
+ *
+ * Bluetooth event handler of the payload: notes that the stack stopped the
+ * advertising set when a connection was opened from it. Must be called from
+ * sl_bt_on_event().
+ *
+ * @param[in] evt Event coming from the Bluetooth stack
+ *
+ ******************************************************************************/
+void ead_payload_on_event(sl_bt_msg_t *evt);
+
+/***************************************************************************//**
+ *
+ * Retrieve the payload currently advertised.
+ *
+ * @param[out] len Length of the payload
+ *
+ * @return Payload, valid until the next successful refresh.
+ *
+ ******************************************************************************/
+const uint8_t *ead_payload_get(uint8_t *len);
+
+/***************************************************************************//**
+ *
+ * Retrieve the payload statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void ead_payload_get_stats(ead_payload_stats_t *stats);
+
+#endif // EAD_PAYLOAD_H
@@ -34,6 +34,9 @@
 #include <stdbool.h>
 
 enum {
+  ROTATION_SERVICE_DISCOVERY,
+  ROTATION_CHARACTERISTIC_DISCOVERY,
+  ROTATION_READ,
   SERVICE_DISCOVERY,
   CHARACHTERISTIC_DISCOVERY,
   CHARACHTERISTIC_READ
@@ -0,0 +1,192 @@
+/***************************************************************************//**
+ * @file ead_key_store.h
+ * @brief Key material of many encrypted advertisers, with decrypt-on-change.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#ifndef EAD_KEY_STORE_H
+#define EAD_KEY_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sl_status.h"
+#include "sl_bt_ead_core.h"
+
+// The store has no dependencies on the Bluetooth stack besides the EAD
+// core API, so it can be benchmarked on a PC with a software AES-CCM.
+
+// Number of hash table slots, a power of 2. At most 3/4 of them are used.
+// A full table takes about 2.7 probes per lookup on average, 2.68 in the
+// benchmark with 192 keys, and fewer with fewer keys.
+#ifndef EAD_KEY_STORE_SLOTS
+#define EAD_KEY_STORE_SLOTS       256
+#endif
+
+#define EAD_KEY_STORE_MAX_KEYS    (EAD_KEY_STORE_SLOTS * 3 / 4)
+
+// Length of a Bluetooth device address. An address resolved from an RPA
+// matches the identity address it was resolved to.
+#define EAD_KEY_STORE_ADDRESS_LEN 6
+
+/***************************************************************************//**
+ * @brief Outcome of ead_key_store_decrypt()
+ ******************************************************************************/
+typedef enum {
+  ead_key_store_decrypted,  // New data decrypted into the output buffer
+  ead_key_store_unchanged,  // Same randomizer and ciphertext as the last
+                            // decrypted data, the output buffer is untouched
+  ead_key_store_no_key,     // No key material for the advertiser
+  ead_key_store_failed      // Malformed structure or authentication failed
+} ead_key_store_result_t;
+
+/***************************************************************************//**
+ * @brief Store statistics
+ ******************************************************************************/
+typedef struct {
+  uint32_t keys;        // Key material stored
+  uint32_t lookups;     // Calls to ead_key_store_decrypt()
+  uint32_t probes;      // Hash table slots compared by the lookups
+  uint32_t decrypted;
+  uint32_t rollovers;   // Decryptions that switched to the next key
+  uint32_t unchanged;   // Decryptions skipped
+  uint32_t no_key;
+  uint32_t failed;
+} ead_key_store_stats_t;
+
+/***************************************************************************//**
+ *
+ * Remove all key material.
+ *
+ ******************************************************************************/
+void ead_key_store_init(void);
+
+/***************************************************************************//**
+ *
+ * Store the key material of an advertiser, replacing its previous key
+ * material if any, including the key material of its next key epoch.
+ *
+ * @param[in] address Identity address of the advertiser
+ * @param[in] address_type Address type of the advertiser
+ * @param[in] key_material Key material read from the advertiser
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NO_MORE_RESOURCE if
+ *         EAD_KEY_STORE_MAX_KEYS advertisers are stored.
+ *
+ ******************************************************************************/
+sl_status_t ead_key_store_add(const uint8_t *address,
+                              uint8_t address_type,
+                              const struct sl_bt_ead_key_material_s *key_material);
+
+/***************************************************************************//**
+ *
+ * Add the key material of the next key epoch of an advertiser, and the
+ * time its key material should be read again.
+ *
+ * Both key materials are then accepted: the decryption is attempted with
+ * the one that succeeded last, then with the other one, so the advertiser
+ * can roll over to the next epoch at any time.
+ *
+ * @param[in] address Identity address of the advertiser
+ * @param[in] address_type Address type of the advertiser
+ * @param[in] next_key_material Key material of the next epoch, NULL if the
+ *            advertiser has not published it yet
+ * @param[in] refresh_ms Time to read the key material again, on the clock
+ *            passed to ead_key_store_refresh_due()
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND if the advertiser
+ *         has no key material.
+ *
+ ******************************************************************************/
+sl_status_t ead_key_store_set_next(const uint8_t *address,
+                                   uint8_t address_type,
+                                   const struct sl_bt_ead_key_material_s *next_key_material,
+                                   uint32_t refresh_ms);
+
+/***************************************************************************//**
+ *
+ * Check whether the key material of an advertiser should be read again.
+ *
+ * @param[in] address Address of the advertiser, resolved from its RPA
+ * @param[in] address_type Address type of the advertiser
+ * @param[in] now_ms Current time in ms, wrapping around
+ *
+ * @return true if the refresh time set by ead_key_store_set_next() is
+ *         reached.
+ *
+ ******************************************************************************/
+bool ead_key_store_refresh_due(const uint8_t *address,
+                               uint8_t address_type,
+                               uint32_t now_ms);
+
+/***************************************************************************//**
+ *
+ * Remove the key material of an advertiser, e.g. when it has been renewed.
+ *
+ * @param[in] address Identity address of the advertiser
+ * @param[in] address_type Address type of the advertiser
+ *
+ * @return SL_STATUS_OK if successful, SL_STATUS_NOT_FOUND otherwise.
+ *
+ ******************************************************************************/
+sl_status_t ead_key_store_remove(const uint8_t *address, uint8_t address_type);
+
+/***************************************************************************//**
+ *
+ * Decrypt an Encrypted Data AD structure of an advertiser.
+ *
+ * The key material is found with one hash lookup on the address. If the
+ * randomizer and the ciphertext equal those of the last structure
+ * decrypted for the advertiser, the decryption is skipped.
+ *
+ * @param[in] address Address of the advertiser, resolved from its RPA
+ * @param[in] address_type Address type of the advertiser
+ * @param[in] ad Encrypted Data AD structure, starting with its length
+ * @param[in] ad_size Bytes of the report from @p ad on, the structure must
+ *            fit in them
+ * @param[out] data Decrypted data
+ * @param[in,out] len Size of @p data in, length of the decrypted data out
+ *
+ * @return Outcome of the decryption
+ *
+ ******************************************************************************/
+ead_key_store_result_t ead_key_store_decrypt(const uint8_t *address,
+                                             uint8_t address_type,
+                                             const uint8_t *ad,
+                                             uint8_t ad_size,
+                                             uint8_t *data,
+                                             uint8_t *len);
+
+/***************************************************************************//**
+ *
+ * Retrieve the store statistics.
+ *
+ * @param[out] stats Statistics
+ *
+ ******************************************************************************/
+void ead_key_store_get_stats(ead_key_store_stats_t *stats);
+
+#endif // EAD_KEY_STORE_H
@@ -33,15 +33,18 @@
 #include "app.h"
 #include "sl_bt_ead_core.h"
 #include <stdio.h>
-#include "psa/crypto_values.h"
-#include "psa/crypto.h"
-#include "sl_memory_manager.h"
 #include "gatt_db.h"
 #include "sl_sleeptimer.h"
 #include "sl_simple_button_instances.h"
+#include "ead_payload.h"
+#include "ead_key_rotation.h"
 
-#define BLE_EA_ADV_DATA_LEN 0xBF
+// The encrypted data is refreshed every PAYLOAD_REFRESH_PERIOD_MS, the
+// resolvable private address every ADDRESS_CHANGE_PERIOD_MS, together with
+// one of the refreshes.
+#define PAYLOAD_REFRESH_PERIOD_MS 500
 #define ADDRESS_CHANGE_PERIOD_MS 20000
+#define REFRESHES_PER_ADDRESS_CHANGE (ADDRESS_CHANGE_PERIOD_MS / PAYLOAD_REFRESH_PERIOD_MS)
 #define BTN_CONFIRM_PERIOD_MS 2000
 
 #define CONFIRM_BTN 0
@@ -52,7 +55,6 @@ uint8_t btn_count = 0;
 
 // The advertising set handle allocated from Bluetooth stack.
 static uint8_t advertising_set_handle = 0xff;
-uint8_t advertisement_buffer[BLE_EA_ADV_DATA_LEN];
 
 sl_sleeptimer_timer_handle_t periodic_timer_handle;
 sl_sleeptimer_timer_handle_t oneshot_btn_timer_handle;
@@ -61,6 +63,11 @@ char name[] = "Encrypted Advertiser";
 char secret_data[10];
 uint8_t secret_number = 0;
 
+// The advertising set is stopped while a connection is open. An address
+// change due meanwhile is done when advertising restarts.
+static bool connected = false;
+static bool address_change_pending = false;
+
 void oneshot_sleeptimer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
 {
   (void)handle;
@@ -82,84 +89,97 @@ void sl_button_on_change(const sl_button_t *handle)
   }
 }
 
-sl_status_t initialize_and_store_key_material(sl_bt_ead_key_material_p key_material, psa_key_id_t key_id)
+void log_key_material(sl_bt_ead_key_material_p key_material)
 {
-  sl_status_t sc = SL_STATUS_FAIL;
-  // generate the session key and the IV needed to create the key material
-  sl_bt_ead_session_key_t session_key;
-  sl_bt_ead_iv_t initialization_vector;
-  if (psa_generate_random(session_key, SL_BT_EAD_SESSION_KEY_SIZE) != PSA_SUCCESS || psa_generate_random(initialization_vector, SL_BT_EAD_IV_SIZE) != PSA_SUCCESS) {
-    return sc;
-  }
-  memcpy(key_material->key, session_key, SL_BT_EAD_SESSION_KEY_SIZE);
-  memcpy(key_material->iv, initialization_vector, SL_BT_EAD_IV_SIZE);
   app_log("session key: ");
-  for (uint8_t i = 0; i < 16; i++) {
+  for (uint8_t i = 0; i < SL_BT_EAD_SESSION_KEY_SIZE; i++) {
     app_log("%02X:", key_material->key[i]);
   }
   app_log("\r\ninitiazation vector: ");
-  for (uint8_t i = 0; i < 8; i++) {
+  for (uint8_t i = 0; i < SL_BT_EAD_IV_SIZE; i++) {
     app_log("%02X:", key_material->iv[i]);
   }
   app_log("\r\n");
-  // set the key material Gatt characteristic to the key material value
-  sc = sl_bt_gatt_server_write_attribute_value(gattdb_Encrypted_Data_Key_Material, 0, SL_BT_EAD_KEY_MATERIAL_SIZE, (uint8_t *)key_material);
-  app_assert_status(sc);
-  // store the key material and flush the input buffer
-  sc = sl_bt_ead_store_key(PSA_KEY_USAGE_ENCRYPT, PSA_KEY_LIFETIME_VOLATILE, key_material, &key_id);
-  app_assert_status(sc);
-  return sc;
 }
 
-sl_status_t construct_advertisement_payload(sl_bt_ead_key_material_p key_material, sl_bt_ead_nonce_p nonce, uint8_t *index)
+// Build the unencrypted part of the advertisement, flags and complete local
+// name. It is written once into the payload buffers.
+static uint8_t build_plain_ad_structures(uint8_t *buffer)
 {
-  sl_status_t sc = SL_STATUS_FAIL;
-  *index = 0;
-  // refresh the secret part of the advertisement
-  secret_number++;
-  sprintf(secret_data, "secret%02d", secret_number);
-  // add an optional unencrypted part e.g flags and complete local name
+  uint8_t index = 0;
+
   // add flags
-  advertisement_buffer[(*index)++] = 0x02; // Ad structure len
-  advertisement_buffer[(*index)++] = 0x01; // Ad structure type
-  advertisement_buffer[(*index)++] = 0x06; // Ad structure data
+  buffer[index++] = 0x02; // Ad structure len
+  buffer[index++] = 0x01; // Ad structure type
+  buffer[index++] = 0x06; // Ad structure data
   // add complete local name
-  advertisement_buffer[(*index)++] = strlen(name) + 1;       // Ad structure len
-  advertisement_buffer[(*index)++] = 0x09;                   // Ad structure type
-  memcpy(advertisement_buffer + *index, name, strlen(name)); // Ad structure data
-  *index += strlen(name);
-  // Note: any part of the advertisement or all can be encrypted including the above
+  buffer[index++] = strlen(name) + 1;       // Ad structure len
+  buffer[index++] = 0x09;                   // Ad structure type
+  memcpy(buffer + index, name, strlen(name)); // Ad structure data
+  index += strlen(name);
+  return index;
+}
+
+// Prepare the payload buffers of the advertising set.
+sl_status_t init_advertisement_payload(sl_bt_ead_key_material_p key_material, sl_bt_ead_nonce_p nonce)
+{
+  uint8_t plain[EAD_PAYLOAD_MAX_LEN];
+
+  return ead_payload_init(advertising_set_handle, key_material, nonce,
+                          plain, build_plain_ad_structures(plain));
+}
+
+// Encrypt the latest secret into the next advertisement and swap it in.
+sl_status_t refresh_advertisement_payload(bool change_address)
+{
+  sl_status_t sc;
+  uint8_t ad[2 + sizeof(secret_data)];
+  uint8_t secret_len;
+  const uint8_t *payload;
+  uint8_t payload_len;
+
+  // refresh the secret part of the advertisement
+  secret_number++;
+  secret_len = (uint8_t)snprintf(secret_data, sizeof(secret_data), "secret%02d", secret_number);
+  // Note: any part of the advertisement or all can be encrypted including the flags and the name
   // add an encrypted part e.g manufacturer specific data
-  uint8_t manufactuer_data_buf[BLE_EA_ADV_DATA_LEN];
-  size_t manufactuer_data_len = (size_t)(2 + strlen(secret_data)); // len+type+data
-  sl_bt_ead_mic_t message_integraty_check;
-  manufactuer_data_buf[0] = strlen(secret_data) + 1;                  // Ad structure len
-  manufactuer_data_buf[1] = 0xFF;                                     // Ad structure type
-  memcpy(manufactuer_data_buf + 2, secret_data, strlen(secret_data)); // Ad structure data
-  sc = sl_bt_ead_encrypt(key_material, nonce, manufactuer_data_len, manufactuer_data_buf, message_integraty_check);
-  app_assert_status(sc);
-  sl_bt_ead_ad_structure_p encrypted_ad_structure = (sl_bt_ead_ad_structure_p)sl_malloc(sizeof(struct sl_bt_ead_ad_structure_s));
-  uint8_t *encrypted_data_length = &(uint8_t){BLE_EA_ADV_DATA_LEN };
-  encrypted_ad_structure->length = manufactuer_data_len;
-  encrypted_ad_structure->ad_type = SL_BT_ENCRYPTED_DATA_AD_TYPE;
-  encrypted_ad_structure->ad_data = manufactuer_data_buf;
-  encrypted_ad_structure->randomizer = &(nonce->randomizer);
-  encrypted_ad_structure->mic = &message_integraty_check;
-  sc = sl_bt_ead_pack_ad_data(encrypted_ad_structure, encrypted_data_length, advertisement_buffer + *index);
-  app_log("--------------------------------------------------------------------------\n\r");
-  app_log("Information before encryption: %s \n\r", secret_data);
-  app_log("Information after encryption:\n\r");
-  for (uint8_t i = *index; i < *index + *encrypted_data_length; i++) {
-    app_log("%02X", advertisement_buffer[i]);
+  ad[0] = secret_len + 1;                  // Ad structure len
+  ad[1] = 0xFF;                            // Ad structure type
+  memcpy(ad + 2, secret_data, secret_len); // Ad structure data
+  sc = ead_payload_refresh(ad, 2 + secret_len, change_address);
+  if (sc != SL_STATUS_OK) {
+    app_log("payload refresh failed, previous payload kept: 0x%04lx\r\n", (unsigned long)sc);
+    return sc;
   }
-  printf("\n\r");
-  app_assert_status(sc);
-  free(encrypted_ad_structure);
-  (*index) += *encrypted_data_length;
 
+  // Logging every sub-second refresh would flood the console
+  if (change_address) {
+    payload = ead_payload_get(&payload_len);
+    app_log("--------------------------------------------------------------------------\n\r");
+    app_log("Address changed\n\r");
+    app_log("Information before encryption: %s \n\r", secret_data);
+    app_log("Advertisement after encryption:\n\r");
+    for (uint8_t i = 0; i < payload_len; i++) {
+      app_log("%02X", payload[i]);
+    }
+    app_log("\n\r");
+  }
   return sc;
 }
 
+// Switch the advertisement to the key material of the new epoch, together
+// with a new resolvable private address. During a connection only the data
+// is swapped, the address changes when the connection is closed.
+void on_key_rollover(sl_bt_ead_key_material_p key_material, uint16_t epoch)
+{
+  app_log("--------------------------------------------------------------------------\n\r");
+  app_log("key epoch %u\r\n", epoch);
+  log_key_material(key_material);
+  ead_payload_set_key(key_material);
+  address_change_pending = connected;
+  (void)refresh_advertisement_payload(!connected);
+}
+
 // Application Init.
 SL_WEAK void app_init(void)
 {
@@ -168,7 +188,7 @@ SL_WEAK void app_init(void)
   // This is called once during start-up.                                    //
   /////////////////////////////////////////////////////////////////////////////
   sl_status_t sc;
-  sc = sl_sleeptimer_start_periodic_timer_ms(&periodic_timer_handle, ADDRESS_CHANGE_PERIOD_MS, periodic_sleeptimer_callback, (void *)NULL, 0, 0);
+  sc = sl_sleeptimer_start_periodic_timer_ms(&periodic_timer_handle, PAYLOAD_REFRESH_PERIOD_MS, periodic_sleeptimer_callback, (void *)NULL, 0, 0);
   app_assert_status(sc);
 }
 
@@ -193,13 +213,15 @@ SL_WEAK void app_process_action(void)
 void sl_bt_on_event(sl_bt_msg_t *evt)
 {
   sl_status_t sc;
-  static struct sl_bt_ead_key_material_s key_material;
+  sl_bt_ead_key_material_p key_material;
   static struct sl_bt_ead_nonce_s nonce;
-  static psa_key_id_t key_id = PSA_KEY_ID_NULL;
-  static uint8_t index;
+  static uint32_t refreshes = 0;
   static uint8_t connection_handle = SL_BT_INVALID_CONNECTION_HANDLE;
   static uint8_t pairing_state;
 
+  ead_payload_on_event(evt);
+  ead_key_rotation_on_event(evt);
+
   switch (SL_BT_MSG_ID(evt->header)) {
     // -------------------------------
     // This event indicates the device has started and the radio is ready.
@@ -211,20 +233,21 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       app_assert_status(sc);
       sc = sl_bt_sm_configure(SL_BT_SM_CONFIGURATION_MITM_REQUIRED | SL_BT_SM_CONFIGURATION_BONDING_REQUIRED | SL_BT_SM_CONFIGURATION_SC_ONLY | SL_BT_SM_CONFIGURATION_BONDING_REQUEST_REQUIRED, sl_bt_sm_io_capability_displayyesno);
       app_assert_status(sc);
-      // initializes the key material
-      initialize_and_store_key_material(&key_material, key_id);
+      // generates the key material of the first two epochs and publishes them
+      sc = ead_key_rotation_init(on_key_rollover);
+      app_assert_status(sc);
+      key_material = ead_key_rotation_get_key();
+      log_key_material(key_material);
       // initializes the nonce
-      sl_bt_ead_session_init(&key_material, NULL, &nonce);
+      sl_bt_ead_session_init(key_material, NULL, &nonce);
       // Create an advertising set.
       sc = sl_bt_advertiser_create_set(&advertising_set_handle);
       app_assert_status(sc);
-      bd_addr random_address;
-      sc = sl_bt_advertiser_set_random_address(advertising_set_handle, sl_bt_gap_random_resolvable_address, (bd_addr){0 }, &random_address);
-      app_assert_status(sc);
-      // fill the advertisement with encrypted and unencrypted data
-      sc = construct_advertisement_payload(&key_material, &nonce, &index);
+      // prepare the payload buffers, then fill the advertisement with encrypted
+      // and unencrypted data and set the first resolvable private address
+      sc = init_advertisement_payload(key_material, &nonce);
       app_assert_status(sc);
-      sc = sl_bt_extended_advertiser_set_data(advertising_set_handle, index, advertisement_buffer);
+      sc = refresh_advertisement_payload(true);
       app_assert_status(sc);
       // Set advertising interval to 100ms.
       sc = sl_bt_advertiser_set_timing(
@@ -235,8 +258,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
         0);  // max. num. adv. events
       app_assert_status(sc);
       // Start advertising and enable connections.
-      sc = sl_bt_extended_advertiser_start(advertising_set_handle,
-                                           sl_bt_extended_advertiser_connectable, 0);
+      sc = ead_payload_start();
       app_assert_status(sc);
       app_log("started advertisement\r\n");
       break;
@@ -246,6 +268,7 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       sc = sl_sleeptimer_stop_timer(&periodic_timer_handle);
       app_assert_status(sc);
       connection_handle = evt->data.evt_connection_opened.connection;
+      connected = true;
       break;
 
     case sl_bt_evt_connection_parameters_id:
@@ -269,10 +292,14 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_connection_closed_id:
       app_log("closed connection reason: 0x%4X\r\n", evt->data.evt_connection_closed.reason);
       connection_handle = SL_BT_INVALID_CONNECTION_HANDLE;
-      sc = sl_sleeptimer_start_periodic_timer_ms(&periodic_timer_handle, ADDRESS_CHANGE_PERIOD_MS, periodic_sleeptimer_callback, (void *)NULL, 0, 0);
+      connected = false;
+      if (address_change_pending) {
+        // the key rolled over during the connection
+        address_change_pending = (refresh_advertisement_payload(true) != SL_STATUS_OK);
+      }
+      sc = sl_sleeptimer_start_periodic_timer_ms(&periodic_timer_handle, PAYLOAD_REFRESH_PERIOD_MS, periodic_sleeptimer_callback, (void *)NULL, 0, 0);
       app_assert_status(sc);
-      sc = sl_bt_extended_advertiser_start(advertising_set_handle,
-                                           sl_bt_extended_advertiser_connectable, 0);
+      sc = ead_payload_start();
       app_assert_status(sc);
       break;
 
@@ -301,21 +328,11 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 
     case sl_bt_evt_system_external_signal_id:
       if (evt->data.evt_system_external_signal.extsignals == PERIODIC_TIMER_CALLBACK) {
-        // stop advertising, change resolvable private address and update the randomizer according to
-        //  the Supplement to the Bluetooth Core Specification v11 Part A, Section 1.23.4
-        sc = sl_bt_advertiser_stop(advertising_set_handle);
-        app_assert_status(sc);
-        sc = sl_bt_advertiser_set_random_address(advertising_set_handle, sl_bt_gap_random_resolvable_address, (bd_addr){0 }, &random_address);
-        app_assert_status(sc);
-        sc = sl_bt_ead_randomizer_update(&nonce);
-        app_assert_status(sc);
-        sc = construct_advertisement_payload(&key_material, &nonce, &index);
-        app_assert_status(sc);
-        sc = sl_bt_extended_advertiser_set_data(advertising_set_handle, index, advertisement_buffer);
-        app_assert_status(sc);
-        sc = sl_bt_extended_advertiser_start(advertising_set_handle,
-                                             sl_bt_extended_advertiser_connectable, 0);
-        app_assert_status(sc);
+        // encrypt the new data with a new randomizer; the resolvable private address changes
+        // together with the randomizer according to the Supplement to the Bluetooth Core
+        // Specification v11 Part A, Section 1.23.4
+        refreshes++;
+        (void)refresh_advertisement_payload(refreshes % REFRESHES_PER_ADDRESS_CHANGE == 0);
         break;
       }
       if (pairing_state == 0) {
@@ -0,0 +1,272 @@
+/***************************************************************************//**
+ * @file ead_key_rotation.c
+ * @brief Key epochs and batched key distribution of the encrypted advertiser.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <string.h>
+#include "psa/crypto.h"
+#include "gatt_db.h"
+#include "sl_sleeptimer.h"
+#include "ead_key_rotation.h"
+
+#define ATT_ERR_INVALID_OFFSET            0x07
+#define ATT_ERR_INSUFFICIENT_RESOURCES    0x11
+
+// Key material of the current epoch and of the next one
+static struct sl_bt_ead_key_material_s keys[2];
+static uint8_t current = 0;
+static bool next_valid = false;
+
+static sl_sleeptimer_timer_handle_t epoch_timer;
+static ead_key_rotation_callback_t callback = NULL;
+static ead_key_rotation_stats_t stats;
+
+// Record sent to each reader, taken when it reads offset 0, so that all
+// parts of a long read belong to the same record
+static struct {
+  uint8_t connection;
+  uint8_t record[EAD_KEY_ROTATION_RECORD_LEN];
+} readers[EAD_KEY_ROTATION_MAX_READERS];
+
+static void epoch_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  sl_bt_external_signal(EAD_KEY_ROTATION_SIGNAL);
+}
+
+static bool generate(sl_bt_ead_key_material_p key_material)
+{
+  return psa_generate_random(key_material->key, SL_BT_EAD_SESSION_KEY_SIZE) == PSA_SUCCESS
+         && psa_generate_random(key_material->iv, SL_BT_EAD_IV_SIZE) == PSA_SUCCESS;
+}
+
+// Scanners without key rotation read the current key material from the
+// Encrypted Data Key Material characteristic.
+static sl_status_t publish(void)
+{
+  return sl_bt_gatt_server_write_attribute_value(gattdb_Encrypted_Data_Key_Material,
+                                                 0,
+                                                 SL_BT_EAD_KEY_MATERIAL_SIZE,
+                                                 (uint8_t *)&keys[current]);
+}
+
+static void put_le16(uint8_t *p, uint16_t value)
+{
+  p[0] = (uint8_t)value;
+  p[1] = (uint8_t)(value >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t value)
+{
+  put_le16(p, (uint16_t)value);
+  put_le16(p + 2, (uint16_t)(value >> 16));
+}
+
+static void put_key_material(uint8_t *p, const struct sl_bt_ead_key_material_s *key_material)
+{
+  memcpy(p, key_material->key, SL_BT_EAD_SESSION_KEY_SIZE);
+  memcpy(p + SL_BT_EAD_SESSION_KEY_SIZE, key_material->iv, SL_BT_EAD_IV_SIZE);
+}
+
+static void build_record(uint8_t *record)
+{
+  uint32_t remaining = 0;
+  uint32_t to_rollover_ms = 0;
+
+  if (sl_sleeptimer_get_timer_time_remaining(&epoch_timer, &remaining) == SL_STATUS_OK) {
+    to_rollover_ms = sl_sleeptimer_tick_to_ms(remaining);
+  }
+  record[0] = EAD_KEY_ROTATION_RECORD_VERSION;
+  record[1] = next_valid ? 2 : 1;
+  put_le16(&record[2], stats.epoch);
+  put_le32(&record[4], to_rollover_ms);
+  put_le32(&record[8], EAD_KEY_ROTATION_EPOCH_S);
+  put_key_material(&record[EAD_KEY_ROTATION_HEADER_LEN], &keys[current]);
+  if (next_valid) {
+    put_key_material(&record[EAD_KEY_ROTATION_HEADER_LEN + SL_BT_EAD_KEY_MATERIAL_SIZE],
+                     &keys[current ^ 1]);
+  } else {
+    memset(&record[EAD_KEY_ROTATION_HEADER_LEN + SL_BT_EAD_KEY_MATERIAL_SIZE],
+           0,
+           SL_BT_EAD_KEY_MATERIAL_SIZE);
+  }
+}
+
+static void rollover(void)
+{
+  if (!next_valid) {
+    // The RNG failed to generate the key material of the next epoch, so no
+    // scanner has it. The epoch is extended by one, in which it is generated
+    // again and can be read by the scanners before it is used.
+    next_valid = generate(&keys[current ^ 1]);
+    if (!next_valid) {
+      stats.failures++;
+    }
+    stats.postponed++;
+    return;
+  }
+
+  current ^= 1;
+  stats.epoch++;
+  stats.rollovers++;
+  if (publish() != SL_STATUS_OK) {
+    stats.failures++;
+  }
+  if (callback != NULL) {
+    callback(&keys[current], stats.epoch);
+  }
+
+  // The previous key material is only overwritten once the callback has
+  // switched the payload to the new one.
+  next_valid = generate(&keys[current ^ 1]);
+  if (!next_valid) {
+    stats.failures++;
+  }
+}
+
+static void on_read_request(const sl_bt_evt_gatt_server_user_read_request_t *request)
+{
+  uint8_t error = 0;
+  const uint8_t *value = NULL;
+  uint16_t len = 0;
+  uint16_t mtu;
+  uint16_t sent_len;
+  uint8_t reader = EAD_KEY_ROTATION_MAX_READERS;
+
+  for (uint8_t i = 0; i < EAD_KEY_ROTATION_MAX_READERS; i++) {
+    if (readers[i].connection == request->connection) {
+      reader = i;
+      break;
+    }
+    if (reader == EAD_KEY_ROTATION_MAX_READERS
+        && readers[i].connection == SL_BT_INVALID_CONNECTION_HANDLE) {
+      reader = i;
+    }
+  }
+
+  if (reader == EAD_KEY_ROTATION_MAX_READERS) {
+    error = ATT_ERR_INSUFFICIENT_RESOURCES;
+  } else if (request->offset > EAD_KEY_ROTATION_RECORD_LEN) {
+    error = ATT_ERR_INVALID_OFFSET;
+  } else {
+    if (request->offset == 0 || readers[reader].connection != request->connection) {
+      readers[reader].connection = request->connection;
+      build_record(readers[reader].record);
+    }
+    if (request->offset == 0) {
+      stats.reads++;
+    } else {
+      stats.blob_reads++;
+    }
+    value = &readers[reader].record[request->offset];
+    len = EAD_KEY_ROTATION_RECORD_LEN - request->offset;
+    if (sl_bt_gatt_server_get_mtu(request->connection, &mtu) == SL_STATUS_OK
+        && len > mtu - 1) {
+      len = mtu - 1;
+    }
+  }
+
+  if (sl_bt_gatt_server_send_user_read_response(request->connection,
+                                                request->characteristic,
+                                                error,
+                                                len,
+                                                value,
+                                                &sent_len) != SL_STATUS_OK) {
+    stats.failures++;
+  }
+}
+
+sl_status_t ead_key_rotation_init(ead_key_rotation_callback_t rollover_callback)
+{
+  sl_status_t sc;
+
+  callback = rollover_callback;
+  current = 0;
+  memset(&stats, 0, sizeof(stats));
+  for (uint8_t i = 0; i < EAD_KEY_ROTATION_MAX_READERS; i++) {
+    readers[i].connection = SL_BT_INVALID_CONNECTION_HANDLE;
+  }
+
+  if (!generate(&keys[current])) {
+    return SL_STATUS_FAIL;
+  }
+  next_valid = generate(&keys[current ^ 1]);
+  if (!next_valid) {
+    stats.failures++;
+  }
+  sc = publish();
+  if (sc != SL_STATUS_OK) {
+    return sc;
+  }
+  return sl_sleeptimer_start_periodic_timer_ms(&epoch_timer,
+                                               EAD_KEY_ROTATION_EPOCH_S * 1000,
+                                               epoch_timer_callback,
+                                               NULL,
+                                               0,
+                                               0);
+}
+
+sl_bt_ead_key_material_p ead_key_rotation_get_key(void)
+{
+  return &keys[current];
+}
+
+void ead_key_rotation_on_event(sl_bt_msg_t *evt)
+{
+  switch (SL_BT_MSG_ID(evt->header)) {
+    case sl_bt_evt_system_external_signal_id:
+      if (evt->data.evt_system_external_signal.extsignals & EAD_KEY_ROTATION_SIGNAL) {
+        rollover();
+      }
+      break;
+
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      if (evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_ead_key_distribution) {
+        on_read_request(&evt->data.evt_gatt_server_user_read_request);
+      }
+      break;
+
+    case sl_bt_evt_connection_closed_id:
+      for (uint8_t i = 0; i < EAD_KEY_ROTATION_MAX_READERS; i++) {
+        if (readers[i].connection == evt->data.evt_connection_closed.connection) {
+          readers[i].connection = SL_BT_INVALID_CONNECTION_HANDLE;
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+void ead_key_rotation_get_stats(ead_key_rotation_stats_t *out)
+{
+  *out = stats;
+}
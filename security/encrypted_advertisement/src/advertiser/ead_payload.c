@@ -0,0 +1,178 @@
+/***************************************************************************//**
+ * @file ead_payload.c
+ * @brief Allocation-free, double-buffered encrypted advertising payload.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "ead_payload.h"
+
+// Offsets within the Encrypted Data AD structure
+#define RANDOMIZER_OFFSET   2
+#define DATA_OFFSET         (RANDOMIZER_OFFSET + SL_BT_EAD_RANDOMIZER_SIZE)
+
+static uint8_t advertising_handle = 0xff;
+static sl_bt_ead_key_material_p key;
+static bool advertising = false;
+
+// The advertised payload and its nonce, and the one being built. The
+// unencrypted AD structures are written once, at encrypted_offset begins
+// the Encrypted Data AD structure.
+static uint8_t buffers[2][EAD_PAYLOAD_MAX_LEN];
+static uint8_t lengths[2];
+static struct sl_bt_ead_nonce_s nonces[2];
+static uint8_t active = 0;
+static uint8_t encrypted_offset = 0;
+
+static ead_payload_stats_t stats;
+
+sl_status_t ead_payload_init(uint8_t advertising_set,
+                             sl_bt_ead_key_material_p key_material,
+                             const struct sl_bt_ead_nonce_s *nonce,
+                             const uint8_t *plain,
+                             uint8_t plain_len)
+{
+  if (plain_len + EAD_PAYLOAD_OVERHEAD + 1 > EAD_PAYLOAD_MAX_LEN) {
+    return SL_STATUS_WOULD_OVERFLOW;
+  }
+
+  advertising_handle = advertising_set;
+  key = key_material;
+  advertising = false;
+  active = 0;
+  encrypted_offset = plain_len;
+  memset(&stats, 0, sizeof(stats));
+
+  for (uint8_t i = 0; i < 2; i++) {
+    memcpy(buffers[i], plain, plain_len);
+    buffers[i][encrypted_offset + 1] = SL_BT_ENCRYPTED_DATA_AD_TYPE;
+    lengths[i] = plain_len;
+    nonces[i] = *nonce;
+  }
+  return SL_STATUS_OK;
+}
+
+sl_status_t ead_payload_refresh(const uint8_t *ad, uint8_t len, bool change_address)
+{
+  uint8_t next = active ^ 1;
+  uint8_t *encrypted = &buffers[next][encrypted_offset];
+  bool stopped = false;
+  bd_addr address;
+  sl_status_t sc;
+
+  if (len == 0 || encrypted_offset + EAD_PAYLOAD_OVERHEAD + len > EAD_PAYLOAD_MAX_LEN) {
+    return SL_STATUS_WOULD_OVERFLOW;
+  }
+
+  // Build the next payload without touching the advertised one
+  nonces[next] = nonces[active];
+  sc = sl_bt_ead_randomizer_update(&nonces[next]);
+  if (sc == SL_STATUS_OK) {
+    encrypted[0] = (uint8_t)(EAD_PAYLOAD_OVERHEAD - 1 + len);
+    memcpy(&encrypted[RANDOMIZER_OFFSET], nonces[next].randomizer, SL_BT_EAD_RANDOMIZER_SIZE);
+    memcpy(&encrypted[DATA_OFFSET], ad, len);
+    sc = sl_bt_ead_encrypt(key, &nonces[next], len, &encrypted[DATA_OFFSET],
+                           &encrypted[DATA_OFFSET + len]);
+  }
+  lengths[next] = (uint8_t)(encrypted_offset + EAD_PAYLOAD_OVERHEAD + len);
+
+  // Swap it in. The address may only change while the set is stopped. A
+  // set the stack stopped for a connection is not restarted here, it gets
+  // the address when ead_payload_start() restarts it.
+  if (sc == SL_STATUS_OK && change_address && advertising) {
+    sc = sl_bt_advertiser_stop(advertising_handle);
+    stopped = (sc == SL_STATUS_OK);
+  }
+  if (sc == SL_STATUS_OK && change_address) {
+    sc = sl_bt_advertiser_set_random_address(advertising_handle,
+                                             sl_bt_gap_random_resolvable_address,
+                                             (bd_addr){ 0 },
+                                             &address);
+  }
+  if (sc == SL_STATUS_OK) {
+    sc = sl_bt_extended_advertiser_set_data(advertising_handle, lengths[next], buffers[next]);
+  }
+  if (stopped) {
+    sl_status_t start_sc = sl_bt_extended_advertiser_start(advertising_handle,
+                                                           sl_bt_extended_advertiser_connectable,
+                                                           0);
+    if (sc == SL_STATUS_OK) {
+      sc = start_sc;
+    }
+  }
+
+  if (sc != SL_STATUS_OK) {
+    stats.failures++;
+    return sc;
+  }
+  active = next;
+  stats.refreshes++;
+  if (change_address) {
+    stats.address_changes++;
+  }
+  return SL_STATUS_OK;
+}
+
+void ead_payload_set_key(sl_bt_ead_key_material_p key_material)
+{
+  // The nonce of the next payload is derived from the active one
+  key = key_material;
+  memcpy(nonces[active].iv, key_material->iv, SL_BT_EAD_IV_SIZE);
+}
+
+sl_status_t ead_payload_start(void)
+{
+  sl_status_t sc;
+
+  if (advertising) {
+    return SL_STATUS_OK;
+  }
+  sc = sl_bt_extended_advertiser_start(advertising_handle,
+                                       sl_bt_extended_advertiser_connectable,
+                                       0);
+  advertising = (sc == SL_STATUS_OK);
+  return sc;
+}
+
+void ead_payload_on_event(sl_bt_msg_t *evt)
+{
+  // The stack stops a connectable set when a connection is opened from it
+  if (SL_BT_MSG_ID(evt->header) == sl_bt_evt_connection_opened_id
+      && evt->data.evt_connection_opened.advertiser == advertising_handle) {
+    advertising = false;
+  }
+}
+
+const uint8_t *ead_payload_get(uint8_t *len)
+{
+  *len = lengths[active];
+  return buffers[active];
+}
+
+void ead_payload_get_stats(ead_payload_stats_t *out)
+{
+  *out = stats;
+}
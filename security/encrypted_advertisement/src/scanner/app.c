@@ -34,8 +34,7 @@
 #include "sl_sleeptimer.h"
 #include "sl_simple_button_instances.h"
 #include "sl_bt_ead_core.h"
-#include "psa/crypto_values.h"
-#include "psa/crypto.h"
+#include "ead_key_store.h"
 
 #define ADVERTISEMENT_READ_PERIOD_MS 5000
 #define BTN_CONFIRM_PERIOD_MS 2000
@@ -54,6 +53,21 @@ char remote_name[] = "Encrypted Advertiser";
 const uint8_t Gap_service_uuid[] = { 0x00, 0x18 };
 // key material UUID
 const uint8_t key_material_char_uuid[] = { 0x88, 0X2b };
+// EAD Key Rotation service and EAD Key Distribution characteristic UUIDs
+const uint8_t key_rotation_service_uuid[] = { 0x70, 0x4a, 0x0f, 0x1e, 0x9d, 0x2c, 0x6b, 0x8a,
+                                              0x3e, 0x4f, 0x1a, 0x7d, 0x40, 0x9c, 0x2e, 0x5b };
+const uint8_t key_distribution_char_uuid[] = { 0x70, 0x4a, 0x0f, 0x1e, 0x9d, 0x2c, 0x6b, 0x8a,
+                                               0x3e, 0x4f, 0x1a, 0x7d, 0x41, 0x9c, 0x2e, 0x5b };
+
+// Key distribution record of the advertiser: version, key count, epoch,
+// time to the next rollover in ms, epoch length in s, then the key material
+// of the epoch and of the next epoch, little endian.
+#define KEY_RECORD_VERSION 1
+#define KEY_RECORD_HEADER_LEN 12
+#define KEY_RECORD_LEN (KEY_RECORD_HEADER_LEN + 2 * SL_BT_EAD_KEY_MATERIAL_SIZE)
+
+uint8_t key_record[KEY_RECORD_LEN];
+uint16_t key_record_len = 0;
 
 void oneshot_sleeptimer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
 
@@ -85,9 +99,15 @@ sl_status_t find_advertiser_by_local_name(sl_bt_evt_scanner_extended_advertiseme
   uint8_t i = 0;
   while (i < adv_report->data.len) {
     ad_len = adv_report->data.data[i];
+    // The length comes from the air: skip the packet if it is empty or
+    // runs past the end of the report
+    if (ad_len == 0 || i + ad_len + 1 > adv_report->data.len) {
+      break;
+    }
     ad_type = adv_report->data.data[i + 1];
     if (ad_type == 0x09) {
-      if (memcmp(remote_name, &(adv_report->data.data[i + 2]), ad_len - 1) == 0) {
+      if (ad_len == strlen(remote_name) + 1
+          && memcmp(remote_name, &(adv_report->data.data[i + 2]), ad_len - 1) == 0) {
         return SL_STATUS_OK;
       }
     }
@@ -96,53 +116,117 @@ sl_status_t find_advertiser_by_local_name(sl_bt_evt_scanner_extended_advertiseme
   return sc;
 }
 
-sl_status_t extract_and_deycrypt(sl_bt_evt_scanner_extended_advertisement_report_t *adv_report,
-                                 sl_bt_ead_key_material_p key_material,
-                                 sl_bt_ead_nonce_p nonce)
+// Decrypt the Encrypted Data AD structure of a report with the key material
+// of its advertiser. The data is only logged when new and when log is set.
+ead_key_store_result_t decrypt_advertisement(sl_bt_evt_scanner_extended_advertisement_report_t *adv_report,
+                                             bool log)
 {
-  sl_status_t sc = SL_STATUS_FAIL;
+  ead_key_store_result_t result = ead_key_store_failed;
+  uint8_t data[UINT8_MAX];
+  uint8_t len = sizeof(data);
   uint8_t ad_len;
   uint8_t ad_type;
   uint8_t i = 0;
-  struct sl_bt_ead_ad_structure_s advertisement_info;
-  sl_bt_ead_randomizer_t randomizer;
-  uint8_t encrypted_data_buffer[30];
-  sl_bt_ead_mic_t mic;
-
-  app_log("--------------------------------------------------------------------------\n\r");
-  app_log("Decrypting\r\n");
-
-  advertisement_info.length = sizeof(encrypted_data_buffer);
-  advertisement_info.randomizer = &randomizer;
-  advertisement_info.ad_data = encrypted_data_buffer;
-  advertisement_info.mic = &mic;
 
   while (i < adv_report->data.len) {
     ad_len = adv_report->data.data[i];
+    // The length comes from the air: skip the packet if it is empty or
+    // runs past the end of the report
+    if (ad_len == 0 || i + ad_len + 1 > adv_report->data.len) {
+      break;
+    }
     ad_type = adv_report->data.data[i + 1];
     if (ad_type == SL_BT_ENCRYPTED_DATA_AD_TYPE) {
-      app_log("secret information encrypted:\r\n");
-      for (uint8_t j = 0; j < ad_len + 1; j++) {
-        app_log("%02X", adv_report->data.data[i + j]);
-      }
-      sc = sl_bt_ead_unpack_ad_data(&adv_report->data.data[i], &advertisement_info);
-      if (sc != 0) {
-        app_log("unpacking unsuccessful with rc %08lX\r\n", sc);
-      }
-      memcpy(nonce->randomizer, advertisement_info.randomizer, SL_BT_EAD_RANDOMIZER_SIZE);
-      sc = sl_bt_ead_decrypt(key_material, nonce, (uint8_t *)advertisement_info.mic, advertisement_info.length, advertisement_info.ad_data);
-      if (sc != 0) {
-        app_log("decrypting unsuccessful with rc %08lX\r\n", sc);
-      } else {
+      result = ead_key_store_decrypt(adv_report->address.addr,
+                                     adv_report->address_type,
+                                     &adv_report->data.data[i],
+                                     ad_len + 1,
+                                     data,
+                                     &len);
+      if (result == ead_key_store_decrypted && log) {
+        app_log("--------------------------------------------------------------------------\n\r");
+        app_log("secret information encrypted:\r\n");
+        for (uint8_t j = 0; j < ad_len + 1; j++) {
+          app_log("%02X", adv_report->data.data[i + j]);
+        }
         app_log("\r\nDecrypted information:\r\n");
-        for (int i = 0; i < advertisement_info.length; i++) {
-          app_log("%c", advertisement_info.ad_data[i]);
+        for (uint8_t j = 0; j < len; j++) {
+          app_log("%c", data[j]);
         }
         app_log("\r\n");
       }
+      break;
     }
     i = i + ad_len + 1;
   }
+  return result;
+}
+
+// Reports of a bonded advertiser carry the identity address its RPA
+// resolves to, so its key material is stored under that address.
+static void get_identity_address(uint8_t bonding, bd_addr *address, uint8_t *address_type)
+{
+  sl_status_t sc;
+  uint8_t security_mode;
+  uint8_t key_size;
+
+  if (bonding != SL_BT_INVALID_BONDING_HANDLE) {
+    sc = sl_bt_sm_get_bonding_details(bonding, address, address_type, &security_mode, &key_size);
+    app_assert_status(sc);
+  }
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t now_ms(void)
+{
+  uint64_t ms = 0;
+
+  sl_sleeptimer_tick64_to_ms(sl_sleeptimer_get_tick_count64(), &ms);
+  return (uint32_t)ms;
+}
+
+// Store the key material of a key distribution record. The next read is
+// scheduled at a random time of the next epoch, away from its rollovers,
+// so that the scanners of an advertiser spread their reads over the epoch
+// instead of all reconnecting at the rollover.
+sl_status_t store_key_record(const bd_addr *address, uint8_t address_type)
+{
+  sl_status_t sc;
+  struct sl_bt_ead_key_material_s key_material[2];
+  uint8_t key_count = key_record[1];
+  uint32_t epoch_ms = get_le32(&key_record[8]) * 1000;
+  uint32_t delay_ms = get_le32(&key_record[4]) + epoch_ms / 10;
+  uint32_t random = 0;
+  size_t random_len;
+
+  if (key_record_len < KEY_RECORD_LEN || key_record[0] != KEY_RECORD_VERSION
+      || key_count < 1 || key_count > 2) {
+    return SL_STATUS_INVALID_PARAMETER;
+  }
+  for (uint8_t i = 0; i < key_count; i++) {
+    const uint8_t *p = &key_record[KEY_RECORD_HEADER_LEN + i * SL_BT_EAD_KEY_MATERIAL_SIZE];
+
+    memcpy(key_material[i].key, p, SL_BT_EAD_SESSION_KEY_SIZE);
+    memcpy(key_material[i].iv, p + SL_BT_EAD_SESSION_KEY_SIZE, SL_BT_EAD_IV_SIZE);
+  }
+  if (epoch_ms * 8 / 10 != 0
+      && sl_bt_system_get_random_data(sizeof(random), sizeof(random), &random_len, (uint8_t *)&random) == SL_STATUS_OK) {
+    delay_ms += random % (epoch_ms * 8 / 10);
+  }
+
+  sc = ead_key_store_add(address->addr, address_type, &key_material[0]);
+  if (sc == SL_STATUS_OK) {
+    sc = ead_key_store_set_next(address->addr,
+                                address_type,
+                                key_count == 2 ? &key_material[1] : NULL,
+                                now_ms() + delay_ms);
+  }
+  app_log("key epoch %u, %u key(s), next read in %lu s\r\n",
+          key_record[2] | (key_record[3] << 8), key_count, delay_ms / 1000);
   return sc;
 }
 
@@ -180,14 +264,14 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 {
   sl_status_t sc;
   static uint8_t connection_handle = SL_BT_INVALID_CONNECTION_HANDLE;
-  static uint8_t key_need_update;
+  static uint8_t bonding_handle = SL_BT_INVALID_BONDING_HANDLE;
+  static bd_addr peer_address;
+  static uint8_t peer_address_type;
   static uint8_t pairing_state;
-  static uint32_t gap_service_handle;
+  static uint32_t service_handle;
   static uint32_t key_material_char_handle;
   static uint8_t Gatt_procedure;
   static struct sl_bt_ead_key_material_s key_material;
-  static struct sl_bt_ead_nonce_s nonce;
-  static psa_key_id_t key_id = PSA_KEY_ID_NULL;
   static uint8_t decrypt_adv;
 
   switch (SL_BT_MSG_ID(evt->header)) {
@@ -196,8 +280,8 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     // Do not call any stack command before receiving this boot event!
     case sl_bt_evt_system_boot_id:
       pairing_state = 0;
-      key_need_update = 1;
       decrypt_adv = 1;
+      ead_key_store_init();
       app_log("boot\r\n");
       sc = sl_bt_sm_set_bondable_mode(1);
       app_assert_status(sc);
@@ -212,21 +296,33 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     case sl_bt_evt_scanner_extended_advertisement_report_id:
       sl_bt_evt_scanner_extended_advertisement_report_t *adv_report = &evt->data.evt_scanner_extended_advertisement_report;
       if (find_advertiser_by_local_name(adv_report) == 0) {
-        if (key_need_update == 1) {
-          sc = sl_bt_scanner_stop();
-          app_assert_status(sc);
-          sc = sl_bt_connection_open(adv_report->address,
-                                     adv_report->address_type,
-                                     adv_report->primary_phy,
-                                     &connection_handle);
-          app_assert_status(sc);
-        } else if (decrypt_adv) { // decrypt advertisemnt
-          decrypt_adv = 0;
-          sc = extract_and_deycrypt(adv_report, &key_material, &nonce);
-          if (sc != 0) {
+        switch (decrypt_advertisement(adv_report, decrypt_adv)) {
+          case ead_key_store_decrypted:
+            decrypt_adv = 0;
+          // Fall through
+          case ead_key_store_unchanged:
+            // Fetch the key material of the next epoch when scheduled
+            if (!ead_key_store_refresh_due(adv_report->address.addr, adv_report->address_type, now_ms())) {
+              break;
+            }
+          // Fall through
+          case ead_key_store_no_key:
+            // Fetch the key material, one advertiser at a time
+            if (connection_handle != SL_BT_INVALID_CONNECTION_HANDLE) {
+              break;
+            }
+            sc = sl_bt_scanner_stop();
+            app_assert_status(sc);
+            sc = sl_bt_connection_open(adv_report->address,
+                                       adv_report->address_type,
+                                       adv_report->primary_phy,
+                                       &connection_handle);
+            app_assert_status(sc);
+            break;
+          case ead_key_store_failed:
             app_log("failed to decrypt the message, fetching new key\r\n");
-            key_need_update = 1;
-          }
+            ead_key_store_remove(adv_report->address.addr, adv_report->address_type);
+            break;
         }
       }
       break;
@@ -238,12 +334,18 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       sl_bt_evt_connection_opened_t connection_data = evt->data.evt_connection_opened;
       app_log("connection opened\r\n");
       connection_handle = connection_data.connection;
+      bonding_handle = connection_data.bonding;
+      peer_address = connection_data.address;
+      peer_address_type = connection_data.address_type;
       if (connection_data.bonding == SL_BT_INVALID_BONDING_HANDLE) {
         sl_bt_sm_increase_security(connection_handle);
       } else {
         app_log("discovering services\r\n");
-        Gatt_procedure = SERVICE_DISCOVERY;
-        sc = sl_bt_gatt_discover_primary_services_by_uuid(connection_handle, sizeof(Gap_service_uuid), Gap_service_uuid);
+        Gatt_procedure = ROTATION_SERVICE_DISCOVERY;
+        // Handles of a previous connection must not be taken for found ones
+        service_handle = 0;
+        key_material_char_handle = 0;
+        sc = sl_bt_gatt_discover_primary_services_by_uuid(connection_handle, sizeof(key_rotation_service_uuid), key_rotation_service_uuid);
         app_assert_status(sc);
       }
       break;
@@ -275,12 +377,12 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 
     case sl_bt_evt_gatt_service_id:
       app_log("Service discovery using UUID: ");
-      gap_service_handle = evt->data.evt_gatt_service.service;
+      service_handle = evt->data.evt_gatt_service.service;
       for (int i = 0; i < evt->data.evt_gatt_service.uuid.len; i++) {
         app_log("%02X", evt->data.evt_gatt_service.uuid.data[i]);
       }
 
-      app_log("\r\nresulted in the handle: %08lX\r\n", gap_service_handle);
+      app_log("\r\nresulted in the handle: %08lX\r\n", service_handle);
       break;
 
     case sl_bt_evt_gatt_characteristic_id:
@@ -293,11 +395,20 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
       break;
 
     case sl_bt_evt_gatt_characteristic_value_id:
+      if (Gatt_procedure == ROTATION_READ) {
+        // The record is longer than the ATT MTU, it arrives in parts
+        uint16_t offset = evt->data.evt_gatt_characteristic_value.offset;
+        uint8_t len = evt->data.evt_gatt_characteristic_value.value.len;
+
+        if (offset + len <= sizeof(key_record)) {
+          memcpy(&key_record[offset], evt->data.evt_gatt_characteristic_value.value.data, len);
+          key_record_len = offset + len;
+        }
+        break;
+      }
       // copy received Gatt value to the key material
       memcpy(key_material.key, evt->data.evt_gatt_characteristic_value.value.data, SL_BT_EAD_SESSION_KEY_SIZE);
       memcpy(key_material.iv, evt->data.evt_gatt_characteristic_value.value.data + SL_BT_EAD_SESSION_KEY_SIZE, SL_BT_EAD_IV_SIZE);
-      // copy iv to the nonce struct
-      memcpy(nonce.iv, key_material.iv, SL_BT_EAD_IV_SIZE);
       app_log("key material: ");
       for (uint8_t i = 0; i < SL_BT_EAD_SESSION_KEY_SIZE; i++) {
         app_log("%02X:", key_material.key[i]);
@@ -307,17 +418,45 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
         app_log("%02X:", key_material.iv[i]);
       }
       app_log("\r\n");
-      sc = sl_bt_ead_store_key(PSA_KEY_USAGE_DECRYPT, PSA_KEY_LIFETIME_VOLATILE, &key_material, &key_id);
-      app_assert_status(sc);
-      key_need_update = 0;
+      get_identity_address(bonding_handle, &peer_address, &peer_address_type);
+      sc = ead_key_store_add(peer_address.addr, peer_address_type, &key_material);
+      if (sc != SL_STATUS_OK) {
+        app_log("key material not stored, rc %08lX\r\n", sc);
+      }
       sl_bt_connection_close(connection_handle);
       break;
 
     case sl_bt_evt_gatt_procedure_completed_id:
       app_log("Gatt procedure result:  0x%04X \r\n", evt->data.evt_gatt_procedure_completed.result);
-      if (Gatt_procedure == SERVICE_DISCOVERY) {
+      if (Gatt_procedure == ROTATION_SERVICE_DISCOVERY) {
+        if (service_handle != 0) {
+          Gatt_procedure = ROTATION_CHARACTERISTIC_DISCOVERY;
+          sc = sl_bt_gatt_discover_characteristics_by_uuid(connection_handle, service_handle, sizeof(key_distribution_char_uuid), key_distribution_char_uuid);
+        } else {
+          // Advertiser without key rotation: read its current key material
+          Gatt_procedure = SERVICE_DISCOVERY;
+          sc = sl_bt_gatt_discover_primary_services_by_uuid(connection_handle, sizeof(Gap_service_uuid), Gap_service_uuid);
+        }
+      } else if (key_material_char_handle == 0
+                 && (Gatt_procedure == ROTATION_CHARACTERISTIC_DISCOVERY
+                     || Gatt_procedure == CHARACHTERISTIC_DISCOVERY)) {
+        app_log("key material characteristic not found\r\n");
+        sl_bt_connection_close(connection_handle);
+      } else if (Gatt_procedure == ROTATION_CHARACTERISTIC_DISCOVERY) {
+        Gatt_procedure = ROTATION_READ;
+        key_record_len = 0;
+        sl_bt_sm_increase_security(connection_handle);
+        sl_bt_gatt_read_characteristic_value(connection_handle, key_material_char_handle);
+      } else if (Gatt_procedure == ROTATION_READ) {
+        get_identity_address(bonding_handle, &peer_address, &peer_address_type);
+        sc = store_key_record(&peer_address, peer_address_type);
+        if (sc != SL_STATUS_OK) {
+          app_log("key record not stored, rc %08lX\r\n", sc);
+        }
+        sl_bt_connection_close(connection_handle);
+      } else if (Gatt_procedure == SERVICE_DISCOVERY) {
         Gatt_procedure = CHARACHTERISTIC_DISCOVERY;
-        sc = sl_bt_gatt_discover_characteristics_by_uuid(connection_handle, gap_service_handle, sizeof(key_material_char_uuid), key_material_char_uuid);
+        sc = sl_bt_gatt_discover_characteristics_by_uuid(connection_handle, service_handle, sizeof(key_material_char_uuid), key_material_char_uuid);
       } else if (Gatt_procedure == CHARACHTERISTIC_DISCOVERY) {
         Gatt_procedure = CHARACHTERISTIC_READ;
         sl_bt_sm_increase_security(connection_handle);
@@ -347,7 +486,12 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
 
     case sl_bt_evt_system_external_signal_id:
       if (evt->data.evt_system_external_signal.extsignals == PERIODIC_TIMER_CALLBACK) {
+        ead_key_store_stats_t stats;
+
         decrypt_adv = 1;
+        ead_key_store_get_stats(&stats);
+        app_log("key store: %lu keys, %lu decrypted, %lu unchanged, %lu rollovers, %lu without key, %lu failed\r\n",
+                stats.keys, stats.decrypted, stats.unchanged, stats.rollovers, stats.no_key, stats.failed);
         break;
       }
       if (pairing_state == 0) {
@@ -0,0 +1,260 @@
+/***************************************************************************//**
+ * @file ead_key_store.c
+ * @brief Key material of many encrypted advertisers, with decrypt-on-change.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * SPDX-License-Identifier: Zlib
+ *
+ * The licensor of this software is Silicon Laboratories Inc.
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software. If you use this software
+ *    in a product, an acknowledgment in the product documentation would be
+ *    appreciated but is not required.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "ead_key_store.h"
+
+_Static_assert((EAD_KEY_STORE_SLOTS & (EAD_KEY_STORE_SLOTS - 1)) == 0,
+               "EAD_KEY_STORE_SLOTS must be a power of 2");
+
+// Offsets within the Encrypted Data AD structure
+#define RANDOMIZER_OFFSET   2
+#define DATA_OFFSET         (RANDOMIZER_OFFSET + SL_BT_EAD_RANDOMIZER_SIZE)
+#define MIN_AD_LEN          (1 + SL_BT_EAD_RANDOMIZER_SIZE + 1 + SL_BT_EAD_MIC_SIZE)
+
+typedef struct {
+  bool used;
+  bool cached;
+  uint8_t address_type;
+  uint8_t address[EAD_KEY_STORE_ADDRESS_LEN];
+  bool refresh_scheduled;
+  uint8_t key_count;
+  uint8_t preferred;        // Key material that succeeded last
+  uint32_t refresh_ms;
+  // Key material of the current and of the next key epoch
+  struct sl_bt_ead_key_material_s key_material[2];
+  // Last structure decrypted for the advertiser: its randomizer, and a
+  // digest of its ciphertext and MIC
+  sl_bt_ead_randomizer_t randomizer;
+  uint32_t digest;
+} entry_t;
+
+static entry_t entries[EAD_KEY_STORE_SLOTS];
+static ead_key_store_stats_t stats;
+
+// FNV-1a
+static uint32_t fnv1a(uint32_t hash, const uint8_t *data, uint8_t len)
+{
+  for (uint8_t i = 0; i < len; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// Public and static identity addresses, resolved or not
+static uint8_t identity_type(uint8_t address_type)
+{
+  return address_type & 0x01;
+}
+
+static uint32_t home_slot(const uint8_t *address, uint8_t type)
+{
+  return fnv1a(fnv1a(2166136261u, &type, 1), address, EAD_KEY_STORE_ADDRESS_LEN)
+         & (EAD_KEY_STORE_SLOTS - 1);
+}
+
+// Slot of an address, or the free slot that ends its probe sequence
+static uint32_t find_slot(const uint8_t *address, uint8_t type, uint32_t *probes)
+{
+  uint32_t slot = home_slot(address, type);
+
+  for (;;) {
+    (*probes)++;
+    if (!entries[slot].used
+        || (entries[slot].address_type == type
+            && memcmp(entries[slot].address, address, EAD_KEY_STORE_ADDRESS_LEN) == 0)) {
+      return slot;
+    }
+    slot = (slot + 1) & (EAD_KEY_STORE_SLOTS - 1);
+  }
+}
+
+void ead_key_store_init(void)
+{
+  memset(entries, 0, sizeof(entries));
+  memset(&stats, 0, sizeof(stats));
+}
+
+sl_status_t ead_key_store_add(const uint8_t *address,
+                              uint8_t address_type,
+                              const struct sl_bt_ead_key_material_s *key_material)
+{
+  uint8_t type = identity_type(address_type);
+  uint32_t probes = 0;
+  uint32_t slot = find_slot(address, type, &probes);
+  entry_t *e = &entries[slot];
+
+  if (!e->used) {
+    if (stats.keys >= EAD_KEY_STORE_MAX_KEYS) {
+      return SL_STATUS_NO_MORE_RESOURCE;
+    }
+    e->used = true;
+    e->address_type = type;
+    memcpy(e->address, address, EAD_KEY_STORE_ADDRESS_LEN);
+    stats.keys++;
+  }
+  e->key_material[0] = *key_material;
+  e->key_count = 1;
+  e->preferred = 0;
+  e->refresh_scheduled = false;
+  e->cached = false;
+  return SL_STATUS_OK;
+}
+
+sl_status_t ead_key_store_set_next(const uint8_t *address,
+                                   uint8_t address_type,
+                                   const struct sl_bt_ead_key_material_s *next_key_material,
+                                   uint32_t refresh_ms)
+{
+  uint32_t probes = 0;
+  entry_t *e = &entries[find_slot(address, identity_type(address_type), &probes)];
+
+  if (!e->used) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  if (next_key_material != NULL) {
+    e->key_material[e->preferred ^ 1] = *next_key_material;
+    e->key_count = 2;
+  }
+  e->refresh_ms = refresh_ms;
+  e->refresh_scheduled = true;
+  return SL_STATUS_OK;
+}
+
+bool ead_key_store_refresh_due(const uint8_t *address,
+                               uint8_t address_type,
+                               uint32_t now_ms)
+{
+  uint32_t probes = 0;
+  entry_t *e = &entries[find_slot(address, identity_type(address_type), &probes)];
+
+  return e->used && e->refresh_scheduled && (int32_t)(now_ms - e->refresh_ms) >= 0;
+}
+
+sl_status_t ead_key_store_remove(const uint8_t *address, uint8_t address_type)
+{
+  uint32_t probes = 0;
+  uint32_t hole = find_slot(address, identity_type(address_type), &probes);
+  uint32_t slot = hole;
+
+  if (!entries[hole].used) {
+    return SL_STATUS_NOT_FOUND;
+  }
+  entries[hole].used = false;
+  stats.keys--;
+
+  // Backward shift: move up the entries of the cluster that can no longer
+  // be reached past the hole, so lookups never need tombstones.
+  for (;;) {
+    uint32_t home;
+
+    slot = (slot + 1) & (EAD_KEY_STORE_SLOTS - 1);
+    if (!entries[slot].used) {
+      return SL_STATUS_OK;
+    }
+    home = home_slot(entries[slot].address, entries[slot].address_type);
+    if (((slot - home) & (EAD_KEY_STORE_SLOTS - 1))
+        >= ((slot - hole) & (EAD_KEY_STORE_SLOTS - 1))) {
+      entries[hole] = entries[slot];
+      entries[slot].used = false;
+      hole = slot;
+    }
+  }
+}
+
+ead_key_store_result_t ead_key_store_decrypt(const uint8_t *address,
+                                             uint8_t address_type,
+                                             const uint8_t *ad,
+                                             uint8_t ad_size,
+                                             uint8_t *data,
+                                             uint8_t *len)
+{
+  entry_t *e;
+  struct sl_bt_ead_nonce_s nonce;
+  sl_bt_ead_mic_t mic;
+  uint8_t data_len;
+  uint32_t digest;
+
+  stats.lookups++;
+  e = &entries[find_slot(address, identity_type(address_type), &stats.probes)];
+  if (!e->used) {
+    stats.no_key++;
+    return ead_key_store_no_key;
+  }
+
+  // The length comes from the air, the structure must be in the report
+  if (ad_size < 2 || ad[0] < MIN_AD_LEN || ad[0] + 1 > ad_size
+      || ad[1] != SL_BT_ENCRYPTED_DATA_AD_TYPE) {
+    stats.failed++;
+    return ead_key_store_failed;
+  }
+  data_len = ad[0] + 1 - DATA_OFFSET - SL_BT_EAD_MIC_SIZE;
+  if (data_len > *len) {
+    stats.failed++;
+    return ead_key_store_failed;
+  }
+
+  digest = fnv1a(2166136261u, &ad[DATA_OFFSET], data_len + SL_BT_EAD_MIC_SIZE);
+  if (e->cached && e->digest == digest
+      && memcmp(e->randomizer, &ad[RANDOMIZER_OFFSET], SL_BT_EAD_RANDOMIZER_SIZE) == 0) {
+    stats.unchanged++;
+    return ead_key_store_unchanged;
+  }
+
+  memcpy(nonce.randomizer, &ad[RANDOMIZER_OFFSET], SL_BT_EAD_RANDOMIZER_SIZE);
+  for (uint8_t k = 0; k < e->key_count; k++) {
+    uint8_t index = e->preferred ^ k;
+
+    // A failed attempt leaves garbage in the buffers
+    memcpy(nonce.iv, e->key_material[index].iv, SL_BT_EAD_IV_SIZE);
+    memcpy(mic, &ad[DATA_OFFSET + data_len], SL_BT_EAD_MIC_SIZE);
+    memcpy(data, &ad[DATA_OFFSET], data_len);
+    if (sl_bt_ead_decrypt(&e->key_material[index], &nonce, mic, data_len, data) == SL_STATUS_OK) {
+      if (index != e->preferred) {
+        e->preferred = index;
+        stats.rollovers++;
+      }
+      memcpy(e->randomizer, nonce.randomizer, SL_BT_EAD_RANDOMIZER_SIZE);
+      e->digest = digest;
+      e->cached = true;
+      *len = data_len;
+      stats.decrypted++;
+      return ead_key_store_decrypted;
+    }
+  }
+
+  // A forged structure does not replace the cached one
+  stats.failed++;
+  return ead_key_store_failed;
+}
+
+void ead_key_store_get_stats(ead_key_store_stats_t *out)
+{
+  *out = stats;
+}
@@ -20,6 +20,7 @@
 #include "gatt_db.h"
 #include "app.h"
 #include "app_log.h"
+#include "gatt_client_queue.h"
 
 #define TIMER_TIMEOUT 3000
 
@@ -92,6 +93,7 @@ static uint32_t _service_handle;
 static uint16_t ntf_char_handle;
 static uint16_t wrt_char_handle;
 static uint8_t writeBuf[21] = {0};
+static bool write_pending = false;
 
 static aes_key_128 key_random, key_confirm;
 
@@ -106,6 +108,7 @@ void Reset_variables()
   ntf_char_handle = 0;
   wrt_char_handle = 0;
   memset(writeBuf, '0', 20);
+  write_pending = false;
 }
 
 uint8_t Process_scan_response(sl_bt_evt_scanner_legacy_advertisement_report_t *pResp)
@@ -143,10 +146,26 @@ uint8_t Process_scan_response(sl_bt_evt_scanner_legacy_advertisement_report_t *p
   return (ad_match_found);
 }
 
+static void on_written(const gatt_client_queue_result_t *result, void *context)
+{
+  (void)context;
+
+  write_pending = false;
+  if (result->status != SL_STATUS_OK)
+  {
+    app_log_info("Write failed: 0x%04lx\r\n", result->status);
+  }
+}
+
 static void writeToPeripheral()
 {
   sl_status_t ret;
 
+  // writeBuf is not copied by the queue, keep it until the write is done
+  if (write_pending)
+  {
+    return;
+  }
   uint8_t i = writeBuf[0];
   if (i == '9')
   {
@@ -157,8 +176,112 @@ static void writeToPeripheral()
   {
     memset(writeBuf, i + 1, 20);
   }
-  ret = sl_bt_gatt_write_characteristic_value(_conn_handle, wrt_char_handle, 20, writeBuf);
-  app_assert_status(ret);
+  ret = gatt_client_queue_write(_conn_handle, wrt_char_handle, writeBuf, 20,
+                                GATT_CLIENT_QUEUE_PRIORITY_LOW, on_written, NULL);
+  if (ret == SL_STATUS_OK)
+  {
+    write_pending = true;
+  }
+}
+
+static void on_notification_enabled(const gatt_client_queue_result_t *result, void *context)
+{
+  sl_status_t sc;
+  (void)context;
+
+  if (result->status != SL_STATUS_OK)
+  {
+    return;
+  }
+  _main_state = DATA_MODE;
+  sc = sl_sleeptimer_start_periodic_timer_ms(&sleep_timer_handle,
+                                             TIMER_TIMEOUT,
+                                             sleeptimer_callback,
+                                             (void *)NULL,
+                                             0,
+                                             0);
+  app_assert_status(sc);
+}
+
+static void on_characteristics(const gatt_client_queue_result_t *result, void *context)
+{
+  sl_status_t sc;
+  (void)context;
+
+  if (result->evt != NULL)
+  {
+    const sl_bt_evt_gatt_characteristic_t *characteristic = &result->evt->data.evt_gatt_characteristic;
+
+    if (characteristic->uuid.len == 16)
+    {
+      if (memcmp(Ntf_uuid, characteristic->uuid.data, 16) == 0)
+      {
+        ntf_char_handle = characteristic->characteristic;
+      }
+      else if (memcmp(Wrt_uuid, characteristic->uuid.data, 16) == 0)
+      {
+        wrt_char_handle = characteristic->characteristic;
+      }
+    }
+    return;
+  }
+  // Failed, or the connection was closed
+  if (result->status != SL_STATUS_OK)
+  {
+    return;
+  }
+  if (ntf_char_handle && wrt_char_handle)
+  {
+    // Char found, turn on notifications
+    sc = gatt_client_queue_set_notification(_conn_handle, ntf_char_handle, sl_bt_gatt_notification,
+                                            GATT_CLIENT_QUEUE_PRIORITY_NORMAL, on_notification_enabled, NULL);
+    app_assert_status(sc);
+    _main_state = ENABLE_NOTIF;
+  }
+  else
+  {
+    // no characteristic found? -> disconnect
+    sc = sl_bt_connection_close(_conn_handle);
+    app_assert_status(sc);
+  }
+}
+
+static void on_services(const gatt_client_queue_result_t *result, void *context)
+{
+  sl_status_t sc;
+  (void)context;
+
+  if (result->evt != NULL)
+  {
+    const sl_bt_evt_gatt_service_t *service = &result->evt->data.evt_gatt_service;
+
+    if (service->uuid.len == 16 && memcmp(Svc_uuid, service->uuid.data, 16) == 0)
+    {
+      // Service Found.
+      app_log_info("Specified Service Found.\r\n");
+      _service_handle = service->service;
+    }
+    return;
+  }
+  if (result->status != SL_STATUS_OK)
+  {
+    return;
+  }
+  if (_service_handle != 0)
+  {
+    // Service found, next search for characteristics
+    sc = gatt_client_queue_enqueue(_conn_handle, GATT_CLIENT_QUEUE_DISCOVER_CHARACTERISTICS,
+                                   GATT_CLIENT_QUEUE_PRIORITY_NORMAL, _service_handle, NULL, 0,
+                                   on_characteristics, NULL);
+    app_assert_status(sc);
+    _main_state = FIND_CHAR;
+  }
+  else
+  {
+    // no service found -> disconnect
+    sc = sl_bt_connection_close(_conn_handle);
+    app_assert_status(sc);
+  }
 }
 /**************************************************************************/ /**
  * Application Init.
@@ -282,9 +405,12 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
   // -------------------------------
   // This event indicates that a new connection was opened.
   case sl_bt_evt_connection_opened_id:
-    // Start service discovery (we are only interested in one UUID)
+    // Start service discovery, the GATT client procedures of the connection
+    // are run one after the other by the queue
     app_log_info("Connected\r\n");
-    sc = sl_bt_gatt_discover_primary_services_by_uuid(_conn_handle, 16, Svc_uuid);
+    sc = gatt_client_queue_enqueue(_conn_handle, GATT_CLIENT_QUEUE_DISCOVER_SERVICES,
+                                   GATT_CLIENT_QUEUE_PRIORITY_NORMAL, 0, NULL, 0,
+                                   on_services, NULL);
     app_assert_status(sc);
     _main_state = FIND_SERVICE;
     break;
@@ -297,84 +423,6 @@ void sl_bt_on_event(sl_bt_msg_t *evt)
     app_assert_status(sc);
     break;
 
-  case sl_bt_evt_gatt_service_id:
-    if (evt->data.evt_gatt_service.uuid.len == 16)
-    {
-      if (memcmp(Svc_uuid, evt->data.evt_gatt_service.uuid.data, 16) == 0)
-      {
-        // Service Found.
-        app_log_info("Specified Service Found.\r\n");
-        _service_handle = evt->data.evt_gatt_service.service;
-      }
-    }
-    break;
-
-  case sl_bt_evt_gatt_characteristic_id:
-    if (evt->data.evt_gatt_characteristic.uuid.len == 16)
-    {
-      if (memcmp(Ntf_uuid, evt->data.evt_gatt_characteristic.uuid.data, 16) == 0)
-      {
-        ntf_char_handle = evt->data.evt_gatt_characteristic.characteristic;
-      }
-      else if (memcmp(Wrt_uuid, evt->data.evt_gatt_characteristic.uuid.data, 16) == 0)
-      {
-        wrt_char_handle = evt->data.evt_gatt_characteristic.characteristic;
-      }
-    }
-    break;
-
-  case sl_bt_evt_gatt_procedure_completed_id:
-    switch (_main_state)
-    {
-    case FIND_SERVICE:
-
-      if (_service_handle != 0)
-      {
-        // Service found, next search for characteristics
-        sc = sl_bt_gatt_discover_characteristics(_conn_handle, _service_handle);
-        app_assert_status(sc);
-        _main_state = FIND_CHAR;
-      }
-      else
-      {
-        // no service found -> disconnect
-        sc = sl_bt_connection_close(_conn_handle);
-        app_assert_status(sc);
-      }
-      break;
-
-    case FIND_CHAR:
-      if (ntf_char_handle && wrt_char_handle)
-      {
-        // Char found, turn on indications
-        sc = sl_bt_gatt_set_characteristic_notification(_conn_handle, ntf_char_handle, sl_bt_gatt_notification);
-        app_assert_status(sc);
-        _main_state = ENABLE_NOTIF;
-      }
-      else
-      {
-        // no characteristic found? -> disconnect
-        sc = sl_bt_connection_close(_conn_handle);
-        app_assert_status(sc);
-      }
-      break;
-
-    case ENABLE_NOTIF:
-      _main_state = DATA_MODE;
-      sc = sl_sleeptimer_start_periodic_timer_ms(&sleep_timer_handle,
-                                                       TIMER_TIMEOUT,
-                                                       sleeptimer_callback,
-                                                       (void *)NULL,
-                                                       0,
-                                                       0);
-      app_assert_status(sc);
-      break;
-
-    default:
-      break;
-    }
-    break;
-
   case sl_bt_evt_gatt_characteristic_value_id:
     if ((evt->data.evt_gatt_characteristic_value.att_opcode == sl_bt_gatt_handle_value_notification) && (evt->data.evt_gatt_characteristic_value.characteristic == ntf_char_handle))
     {
@@ -0,0 +1,219 @@
+/***************************************************************************//**
+ * @file throughput_meter.h
+ * @brief Measurement core of the GATT throughput benchmark.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#ifndef THROUGHPUT_METER_H
+#define THROUGHPUT_METER_H
+
+// This module uses no SDK header, so that it can be built and tested on a PC.
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Latencies kept to compute the percentiles from.
+#ifndef THROUGHPUT_METER_LATENCY_SAMPLES
+#define THROUGHPUT_METER_LATENCY_SAMPLES  512
+#endif
+
+// Sequence number and send time at the start of each packet.
+#define THROUGHPUT_HEADER_LEN             8
+
+// Length of an encoded result.
+#define THROUGHPUT_RESULT_LEN             38
+
+// Length of the control message starting a test.
+#define THROUGHPUT_CONTROL_LEN            7
+
+// PHYs, with the values of sl_bt_gap_phy_t.
+#define THROUGHPUT_PHY_1M                 1
+#define THROUGHPUT_PHY_2M                 2
+#define THROUGHPUT_PHY_CODED              4
+
+/***************************************************************************//**
+ * @brief How the data is sent
+ ******************************************************************************/
+typedef enum {
+  THROUGHPUT_MODE_STOP = 0,                  // End the test
+  THROUGHPUT_MODE_NOTIFY = 1,                // Server to client notifications
+  THROUGHPUT_MODE_INDICATE = 2,              // Server to client indications
+  THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE = 3 // Client to server writes
+} throughput_mode_t;
+
+/***************************************************************************//**
+ * @brief Control message written by the client to start or stop a test
+ ******************************************************************************/
+typedef struct {
+  throughput_mode_t mode;
+  uint16_t payload_len;     // Length of each packet, header included
+  uint32_t duration_ms;     // Time the server sends for
+} throughput_control_t;
+
+/***************************************************************************//**
+ * @brief Test point of a sweep
+ ******************************************************************************/
+typedef struct {
+  uint8_t phy;              // THROUGHPUT_PHY_x
+  uint16_t mtu;             // ATT MTU of the connection
+  uint32_t interval_us;     // Connection interval
+  throughput_mode_t mode;
+  uint16_t payload_len;
+} throughput_point_t;
+
+/***************************************************************************//**
+ * @brief Result of a test, as measured by the receiver
+ ******************************************************************************/
+typedef struct {
+  uint32_t bytes;           // Payload received, headers included
+  uint32_t packets;
+  uint32_t lost;            // Sequence numbers never received
+  uint32_t duration_us;     // From the first to the last packet
+  uint32_t events;          // Connection events with at least one packet
+  uint16_t max_packets_per_event;
+  uint32_t latency_p50_us;  // Latency percentiles, above the minimum
+  uint32_t latency_p90_us;
+  uint32_t latency_p99_us;
+  uint32_t latency_max_us;
+} throughput_result_t;
+
+/***************************************************************************//**
+ * @brief Receiver state. All fields are private.
+ ******************************************************************************/
+typedef struct {
+  uint32_t interval_us;
+  throughput_result_t result;
+  uint32_t first_rx_us;
+  uint32_t last_rx_us;
+  uint32_t event_start_us;  // Start of the current connection event
+  uint16_t event_packets;
+  uint32_t next_seq;
+  uint32_t first_delay_us;  // Delay of the first packet, the others are relative to it
+  int32_t min_delay_us;
+  int32_t max_delay_us;
+  uint32_t seen;            // Latencies offered to the reservoir
+  uint32_t random;
+  int32_t latencies[THROUGHPUT_METER_LATENCY_SAMPLES];
+} throughput_meter_t;
+
+/***************************************************************************//**
+ *
+ * Start measuring a test.
+ *
+ * @param[out] meter Receiver state
+ * @param[in] interval_us Connection interval, to group the packets by
+ *            connection event
+ *
+ ******************************************************************************/
+void throughput_meter_start(throughput_meter_t *meter, uint32_t interval_us);
+
+/***************************************************************************//**
+ *
+ * Account for a packet received.
+ *
+ * Packets are grouped into connection events by their arrival times, on a
+ * grid of the connection interval anchored on the first packet of each
+ * event. An eighth of the interval is allowed for jitter and drift, so events
+ * longer than 7/8 of the interval are counted as two.
+ *
+ * The latency is the arrival time minus the send time in the header. The two
+ * devices do not share a clock, so only the latency above the smallest one
+ * of the test is reported, i.e. the time packets waited in the queues.
+ *
+ * @param[in] meter Receiver state
+ * @param[in] rx_us Arrival time, in microseconds of the receiver clock
+ * @param[in] data Packet, starting with the header
+ * @param[in] len Length of the packet
+ *
+ ******************************************************************************/
+void throughput_meter_on_packet(throughput_meter_t *meter,
+                                uint32_t rx_us,
+                                const uint8_t *data,
+                                uint16_t len);
+
+/***************************************************************************//**
+ *
+ * End a test and compute its result.
+ *
+ * @param[in] meter Receiver state
+ * @param[out] result Result of the test
+ *
+ ******************************************************************************/
+void throughput_meter_finish(throughput_meter_t *meter, throughput_result_t *result);
+
+/***************************************************************************//**
+ *
+ * Fill a packet with its header and a pattern.
+ *
+ * @param[out] data Packet of at least THROUGHPUT_HEADER_LEN bytes
+ * @param[in] len Length of the packet
+ * @param[in] seq Sequence number, counted from 0 in each test
+ * @param[in] tx_us Send time, in microseconds of the sender clock
+ *
+ ******************************************************************************/
+void throughput_packet_fill(uint8_t *data, uint16_t len, uint32_t seq, uint32_t tx_us);
+
+/***************************************************************************//**
+ *
+ * Encode and decode a control message.
+ *
+ * @return Length encoded, or whether @p data holds a valid control message.
+ *
+ ******************************************************************************/
+size_t throughput_control_encode(const throughput_control_t *control, uint8_t *data);
+bool throughput_control_decode(const uint8_t *data, size_t len, throughput_control_t *control);
+
+/***************************************************************************//**
+ *
+ * Encode and decode a result, to send it from the server to the client.
+ *
+ * @return Length encoded, or whether @p data holds a valid result.
+ *
+ ******************************************************************************/
+size_t throughput_result_encode(const throughput_result_t *result, uint8_t *data);
+bool throughput_result_decode(const uint8_t *data, size_t len, throughput_result_t *result);
+
+/***************************************************************************//**
+ *
+ * Goodput of a test, in bits per second.
+ *
+ ******************************************************************************/
+uint32_t throughput_result_goodput_bps(const throughput_result_t *result);
+
+/***************************************************************************//**
+ *
+ * Name of a PHY, as printed in the results.
+ *
+ ******************************************************************************/
+const char *throughput_phy_name(uint8_t phy);
+
+/***************************************************************************//**
+ *
+ * Format a test point and its result as a line of JSON, without floating
+ * point numbers, so that the output can be parsed by a script.
+ *
+ * @param[out] buf Buffer
+ * @param[in] size Size of @p buf
+ * @param[in] point Test point
+ * @param[in] result Result of the test
+ *
+ * @return Length of the line, as snprintf().
+ *
+ ******************************************************************************/
+int throughput_result_format(char *buf,
+                             size_t size,
+                             const throughput_point_t *point,
+                             const throughput_result_t *result);
+
+#endif // THROUGHPUT_METER_H
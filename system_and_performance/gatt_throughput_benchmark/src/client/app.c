@@ -0,0 +1,661 @@
+/***************************************************************************//**
+ * @file
+ * @brief Core application logic of the throughput benchmark client.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include <string.h>
+#include "em_common.h"
+#include "app_assert.h"
+#include "sl_bluetooth.h"
+#include "sl_sleeptimer.h"
+#include "app.h"
+#include "app_log.h"
+#include "throughput_meter.h"
+
+// Time data is sent for in each test
+#define TEST_DURATION_MS        5000
+
+// Time left after the duration for the last packets to arrive
+#define TEST_SETTLE_MS          500
+
+// Largest ATT MTU of the sweep
+#define MAX_MTU                 247
+
+// Supervision timeout of the connection, in 10 ms units
+#define SUPERVISION_TIMEOUT     500
+
+// Time allowed for a PHY or a connection interval update. The peer may
+// reject it, or the stack may keep the current PHY, without an event.
+#define UPDATE_TIMEOUT_MS       3000
+
+#define TIMER_EXPIRED           1
+
+// Name advertised by the server
+static const char server_name[] = "Throughput";
+
+// Points of the sweep. The connection is opened again for each MTU, the
+// other parameters are changed on the connection.
+static const uint16_t mtus[] = { 23, 131, MAX_MTU };
+static const uint8_t phys[] = { THROUGHPUT_PHY_1M, THROUGHPUT_PHY_2M, THROUGHPUT_PHY_CODED };
+static const uint16_t intervals[] = { 6, 24, 80 }; // 7.5, 30 and 100 ms, in 1.25 ms units
+static const throughput_mode_t modes[] = { THROUGHPUT_MODE_NOTIFY,
+                                           THROUGHPUT_MODE_INDICATE,
+                                           THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE };
+
+#define COUNT(a)  (sizeof(a) / sizeof((a)[0]))
+
+// UUIDs of the benchmark service and its characteristics, little endian
+static const uint8_t service_uuid[16] = { 0x60, 0x5a, 0x4f, 0x3e, 0x2d, 0x1c, 0x6a, 0x9b,
+                                          0x8e, 0x4f, 0x21, 0x3d, 0x7c, 0x0b, 0x5e, 0x4a };
+static const uint8_t data_uuid[16] = { 0x61, 0x5a, 0x4f, 0x3e, 0x2d, 0x1c, 0x6a, 0x9b,
+                                       0x8e, 0x4f, 0x21, 0x3d, 0x7c, 0x0b, 0x5e, 0x4a };
+static const uint8_t control_uuid[16] = { 0x62, 0x5a, 0x4f, 0x3e, 0x2d, 0x1c, 0x6a, 0x9b,
+                                          0x8e, 0x4f, 0x21, 0x3d, 0x7c, 0x0b, 0x5e, 0x4a };
+static const uint8_t result_uuid[16] = { 0x63, 0x5a, 0x4f, 0x3e, 0x2d, 0x1c, 0x6a, 0x9b,
+                                         0x8e, 0x4f, 0x21, 0x3d, 0x7c, 0x0b, 0x5e, 0x4a };
+
+typedef enum {
+  SCANNING,
+  CONNECTING,
+  DISCOVERING_SERVICE,
+  DISCOVERING_CHARACTERISTICS,
+  SETTING_PHY,
+  SETTING_INTERVAL,
+  SUBSCRIBING,
+  STARTING,
+  RUNNING,
+  STOPPING,
+  READING_RESULT,
+  DISCONNECTING,
+  DONE
+} client_state_t;
+
+static client_state_t state = SCANNING;
+static sl_sleeptimer_timer_handle_t timer;
+
+static uint8_t connection_handle = 0xff;
+static uint32_t service_handle = 0;
+static uint16_t data_handle = 0;
+static uint16_t control_handle = 0;
+static uint16_t result_handle = 0;
+
+// Parameters of the connection, as reported by the stack
+static uint8_t phy = THROUGHPUT_PHY_1M;
+static uint16_t mtu = 23;
+static uint16_t interval = 0;
+
+// Position in the sweep
+static uint8_t mtu_index = 0;
+static uint8_t phy_index = 0;
+static uint8_t interval_index = 0;
+static uint8_t mode_index = 0;
+static uint16_t points = 0;
+
+static throughput_point_t point;
+static throughput_meter_t meter;
+static throughput_result_t result;
+// Encoded result, read in parts when it is longer than ATT_MTU - 1
+static uint8_t result_data[THROUGHPUT_RESULT_LEN];
+static uint16_t result_len;
+static bool result_overflow;
+static uint64_t end_tick;
+static uint32_t seq;
+static uint8_t packet[MAX_MTU - 3];
+
+static void start_scanning(void);
+static void start_point(void);
+static void skip_phy(void);
+static void set_interval(void);
+static void skip_interval(void);
+static void subscribe(void);
+static void start_test(void);
+static void stop_test(void);
+static void report(void);
+static void next_point(void);
+static void send_packets(void);
+
+/**************************************************************************//**
+ * Current time in microseconds, wrapping every 71 minutes.
+ *****************************************************************************/
+static uint32_t now_us(void)
+{
+  return (uint32_t)(sl_sleeptimer_get_tick_count64() * 1000000
+                    / sl_sleeptimer_get_timer_frequency());
+}
+
+/**************************************************************************//**
+   Callback for the sleeptimer.
+ *****************************************************************************/
+static void timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)data;
+  (void)handle;
+  sl_bt_external_signal(TIMER_EXPIRED);
+}
+
+/**************************************************************************//**
+ * Wait for a PHY or a connection interval update, for at most
+ * UPDATE_TIMEOUT_MS.
+ *****************************************************************************/
+static void start_update_timer(void)
+{
+  sl_status_t sc;
+
+  sc = sl_sleeptimer_restart_timer_ms(&timer, UPDATE_TIMEOUT_MS,
+                                      timer_callback, NULL, 0, 0);
+  app_assert_status(sc);
+}
+
+/**************************************************************************//**
+ * Tell whether the timer expired, rather than being restarted since its
+ * signal was raised.
+ *****************************************************************************/
+static bool timer_expired(void)
+{
+  bool running = false;
+
+  (void)sl_sleeptimer_is_timer_running(&timer, &running);
+  return !running;
+}
+
+/**************************************************************************//**
+ * decoding advertising packets is done here. The list of AD types can be found
+ * at: https://www.bluetooth.com/specifications/assigned-numbers/Generic-Access-Profile
+ *
+ * @param[in] pReso  Pointer to a scan report event
+ * @param[in] name   Pointer to the name which is looked for
+ *****************************************************************************/
+static uint8_t findDeviceByName(sl_bt_evt_scanner_legacy_advertisement_report_t *pResp, const char* name)
+{
+  uint8_t i = 0;
+  uint8_t ad_len, ad_type;
+
+  while (i < (pResp->data.len - 1)) {
+    ad_len  = pResp->data.data[i];
+    ad_type = pResp->data.data[i + 1];
+
+    if (ad_type == 0x08 || ad_type == 0x09 ) {
+      // type 0x08 = Shortened Local Name
+      // type 0x09 = Complete Local Name
+      if ((size_t)(ad_len - 1) == strlen(name) && memcmp(name, &(pResp->data.data[i + 2]), ad_len - 1) == 0) {
+        return 1;
+      }
+    }
+    //jump to next AD record
+    i = i + ad_len + 1;
+  }
+  return 0;
+}
+
+/**************************************************************************//**
+ * Application Init.
+ *****************************************************************************/
+SL_WEAK void app_init(void)
+{
+  /////////////////////////////////////////////////////////////////////////////
+  // Put your additional application init code here!                         //
+  // This is called once during start-up.                                    //
+  /////////////////////////////////////////////////////////////////////////////
+}
+
+/**************************************************************************//**
+ * Application Process Action.
+ *****************************************************************************/
+void app_process_action(void)
+{
+  if (state == RUNNING && point.mode == THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE) {
+    send_packets();
+  }
+}
+
+/**************************************************************************//**
+ * Bluetooth stack event handler.
+ * This overrides the dummy weak implementation.
+ *
+ * @param[in] evt Event coming from the Bluetooth stack.
+ *****************************************************************************/
+void sl_bt_on_event(sl_bt_msg_t *evt)
+{
+  sl_status_t sc;
+  sl_bt_evt_gatt_characteristic_value_t *value;
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    // -------------------------------
+    // This event indicates the device has started and the radio is ready.
+    // Do not call any stack command before receiving this boot event!
+    case sl_bt_evt_system_boot_id:
+      app_log("Boot event\r\n");
+      /* 10ms scan interval, 100% duty cycle*/
+      sc = sl_bt_scanner_set_parameters(sl_bt_scanner_scan_mode_passive, 16, 16);
+      app_assert_status(sc);
+      start_scanning();
+      break;
+
+    case sl_bt_evt_scanner_legacy_advertisement_report_id:
+      if (state == SCANNING
+          && findDeviceByName(&evt->data.evt_scanner_legacy_advertisement_report, server_name)) {
+        sc = sl_bt_scanner_stop();
+        app_assert_status(sc);
+        sc = sl_bt_connection_open(evt->data.evt_scanner_legacy_advertisement_report.address,
+                                   evt->data.evt_scanner_legacy_advertisement_report.address_type,
+                                   sl_bt_gap_phy_1m,
+                                   &connection_handle);
+        app_assert_status(sc);
+        state = CONNECTING;
+      }
+      break;
+
+    case sl_bt_evt_connection_opened_id:
+      connection_handle = evt->data.evt_connection_opened.connection;
+      phy = THROUGHPUT_PHY_1M;
+      mtu = 23;
+      sc = sl_bt_gatt_discover_primary_services_by_uuid(connection_handle,
+                                                        sizeof(service_uuid),
+                                                        service_uuid);
+      app_assert_status(sc);
+      state = DISCOVERING_SERVICE;
+      break;
+
+    case sl_bt_evt_connection_parameters_id:
+      // The event is also raised by other changes, e.g. of the security
+      // mode: the point is only run once the interval requested is reported
+      interval = evt->data.evt_connection_parameters.interval;
+      if (state == SETTING_INTERVAL && interval == intervals[interval_index]) {
+        (void)sl_sleeptimer_stop_timer(&timer);
+        subscribe();
+      }
+      break;
+
+    case sl_bt_evt_connection_phy_status_id:
+      phy = evt->data.evt_connection_phy_status.phy;
+      if (state != SETTING_PHY) {
+        break;
+      }
+      (void)sl_sleeptimer_stop_timer(&timer);
+      if (phy != phys[phy_index]) {
+        skip_phy();
+      } else {
+        set_interval();
+      }
+      break;
+
+    case sl_bt_evt_gatt_mtu_exchanged_id:
+      mtu = evt->data.evt_gatt_mtu_exchanged.mtu;
+      break;
+
+    case sl_bt_evt_gatt_service_id:
+      if (evt->data.evt_gatt_service.uuid.len == sizeof(service_uuid)
+          && memcmp(evt->data.evt_gatt_service.uuid.data, service_uuid, sizeof(service_uuid)) == 0) {
+        service_handle = evt->data.evt_gatt_service.service;
+      }
+      break;
+
+    case sl_bt_evt_gatt_characteristic_id:
+      if (evt->data.evt_gatt_characteristic.uuid.len != 16) {
+        break;
+      }
+      if (memcmp(evt->data.evt_gatt_characteristic.uuid.data, data_uuid, 16) == 0) {
+        data_handle = evt->data.evt_gatt_characteristic.characteristic;
+      } else if (memcmp(evt->data.evt_gatt_characteristic.uuid.data, control_uuid, 16) == 0) {
+        control_handle = evt->data.evt_gatt_characteristic.characteristic;
+      } else if (memcmp(evt->data.evt_gatt_characteristic.uuid.data, result_uuid, 16) == 0) {
+        result_handle = evt->data.evt_gatt_characteristic.characteristic;
+      }
+      break;
+
+    case sl_bt_evt_gatt_characteristic_value_id:
+      value = &evt->data.evt_gatt_characteristic_value;
+      if (value->characteristic == data_handle) {
+        if (state == STARTING || state == RUNNING) {
+          throughput_meter_on_packet(&meter, now_us(), value->value.data, value->value.len);
+        }
+        if (value->att_opcode == sl_bt_gatt_handle_value_indication) {
+          sc = sl_bt_gatt_send_characteristic_confirmation(connection_handle);
+          app_assert_status(sc);
+        }
+      } else if (value->characteristic == result_handle && state == READING_RESULT) {
+        // Parts of a long read, decoded once the procedure completes
+        if (value->offset <= sizeof(result_data)
+            && value->value.len <= sizeof(result_data) - value->offset) {
+          memcpy(&result_data[value->offset], value->value.data, value->value.len);
+          if (value->offset + value->value.len > result_len) {
+            result_len = value->offset + value->value.len;
+          }
+        } else {
+          result_overflow = true;
+        }
+      }
+      break;
+
+    case sl_bt_evt_gatt_procedure_completed_id:
+      if (evt->data.evt_gatt_procedure_completed.result != SL_STATUS_OK) {
+        app_log("{\"error\":\"procedure failed\",\"state\":%d,\"result\":%u}\r\n",
+                (int)state, (unsigned)evt->data.evt_gatt_procedure_completed.result);
+      }
+      switch (state) {
+        case DISCOVERING_SERVICE:
+          app_assert(service_handle != 0, "Benchmark service not found\n");
+          sc = sl_bt_gatt_discover_characteristics(connection_handle, service_handle);
+          app_assert_status(sc);
+          state = DISCOVERING_CHARACTERISTICS;
+          break;
+
+        case DISCOVERING_CHARACTERISTICS:
+          app_assert(data_handle != 0 && control_handle != 0 && result_handle != 0,
+                     "Benchmark characteristics not found\n");
+          start_point();
+          break;
+
+        case SUBSCRIBING:
+          start_test();
+          break;
+
+        case STARTING:
+          state = RUNNING;
+          sc = sl_sleeptimer_start_timer_ms(&timer,
+                                            point.mode == THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE
+                                            ? TEST_DURATION_MS
+                                            : TEST_DURATION_MS + TEST_SETTLE_MS,
+                                            timer_callback, NULL, 0, 0);
+          app_assert_status(sc);
+          break;
+
+        case STOPPING:
+          result_len = 0;
+          result_overflow = false;
+          sc = sl_bt_gatt_read_characteristic_value(connection_handle, result_handle);
+          app_assert_status(sc);
+          state = READING_RESULT;
+          break;
+
+        case READING_RESULT:
+          if (evt->data.evt_gatt_procedure_completed.result != SL_STATUS_OK
+              || result_overflow
+              || !throughput_result_decode(result_data, result_len, &result)) {
+            memset(&result, 0, sizeof(result));
+          }
+          report();
+          next_point();
+          break;
+
+        default:
+          break;
+      }
+      break;
+
+    case sl_bt_evt_system_external_signal_id:
+      if ((evt->data.evt_system_external_signal.extsignals & TIMER_EXPIRED) == 0
+          || !timer_expired()) {
+        break;
+      }
+      if (state == RUNNING) {
+        stop_test();
+      } else if (state == SETTING_PHY) {
+        // No PHY update completed: the PHY stayed unchanged
+        skip_phy();
+      } else if (state == SETTING_INTERVAL) {
+        skip_interval();
+      }
+      break;
+
+    // -------------------------------
+    // This event indicates that a connection was closed.
+    case sl_bt_evt_connection_closed_id:
+      (void)sl_sleeptimer_stop_timer(&timer);
+      connection_handle = 0xff;
+      service_handle = 0;
+      data_handle = 0;
+      control_handle = 0;
+      result_handle = 0;
+      interval = 0;
+      if (state == DONE) {
+        app_log("{\"done\":true,\"points\":%u}\r\n", points);
+        break;
+      }
+      if (state != DISCONNECTING) {
+        // The point is run again on the next connection
+        app_log("{\"error\":\"connection closed\",\"reason\":%u}\r\n",
+                (unsigned)evt->data.evt_connection_closed.reason);
+      }
+      start_scanning();
+      break;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Add additional event handlers here as your application requires!      //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // -------------------------------
+    // Default event handler.
+    default:
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * Look for the server, with the ATT MTU of the next points.
+ *****************************************************************************/
+static void start_scanning(void)
+{
+  sl_status_t sc;
+  uint16_t max_mtu;
+
+  sc = sl_bt_gatt_set_max_mtu(mtus[mtu_index], &max_mtu);
+  app_assert_status(sc);
+  sc = sl_bt_scanner_start(sl_bt_gap_phy_1m, sl_bt_scanner_discover_observation);
+  app_assert_status(sc);
+  state = SCANNING;
+}
+
+/**************************************************************************//**
+ * Switch to the PHY of the point, then to its connection interval.
+ *****************************************************************************/
+static void start_point(void)
+{
+  sl_status_t sc;
+
+  if (phy == phys[phy_index]) {
+    set_interval();
+    return;
+  }
+  sc = sl_bt_connection_set_preferred_phy(connection_handle, phys[phy_index], phys[phy_index]);
+  app_assert_status(sc);
+  start_update_timer();
+  state = SETTING_PHY;
+}
+
+/**************************************************************************//**
+ * The PHY is not supported by one of the devices: skip all its points.
+ *****************************************************************************/
+static void skip_phy(void)
+{
+  app_log("{\"phy\":\"%s\",\"skipped\":\"phy not supported\"}\r\n",
+          throughput_phy_name(phys[phy_index]));
+  interval_index = COUNT(intervals) - 1;
+  mode_index = COUNT(modes) - 1;
+  next_point();
+}
+
+static void set_interval(void)
+{
+  sl_status_t sc;
+
+  if (interval == intervals[interval_index]) {
+    subscribe();
+    return;
+  }
+  sc = sl_bt_connection_set_parameters(connection_handle,
+                                       intervals[interval_index],
+                                       intervals[interval_index],
+                                       0,
+                                       SUPERVISION_TIMEOUT,
+                                       0,
+                                       0xffff);
+  app_assert_status(sc);
+  start_update_timer();
+  state = SETTING_INTERVAL;
+}
+
+/**************************************************************************//**
+ * The interval was not granted: skip all its points, as they would be
+ * measured at another interval than the one reported.
+ *****************************************************************************/
+static void skip_interval(void)
+{
+  app_log("{\"phy\":\"%s\",\"interval_us\":%lu,\"skipped\":\"interval not granted\",\"granted_us\":%lu}\r\n",
+          throughput_phy_name(phy),
+          (unsigned long)intervals[interval_index] * 1250UL,
+          (unsigned long)interval * 1250UL);
+  mode_index = COUNT(modes) - 1;
+  next_point();
+}
+
+/**************************************************************************//**
+ * Enable the notifications or indications of the mode, disable them for
+ * writes.
+ *****************************************************************************/
+static void subscribe(void)
+{
+  sl_status_t sc;
+  uint8_t flags = sl_bt_gatt_disable;
+
+  if (modes[mode_index] == THROUGHPUT_MODE_NOTIFY) {
+    flags = sl_bt_gatt_notification;
+  } else if (modes[mode_index] == THROUGHPUT_MODE_INDICATE) {
+    flags = sl_bt_gatt_indication;
+  }
+  sc = sl_bt_gatt_set_characteristic_notification(connection_handle, data_handle, flags);
+  app_assert_status(sc);
+  state = SUBSCRIBING;
+}
+
+/**************************************************************************//**
+ * Tell the server to start the test, with packets as long as the MTU allows.
+ *****************************************************************************/
+static void start_test(void)
+{
+  sl_status_t sc;
+  throughput_control_t control;
+  uint8_t data[THROUGHPUT_CONTROL_LEN];
+  uint32_t ticks;
+
+  point.phy = phy;
+  point.mtu = mtu;
+  point.interval_us = interval * 1250UL;
+  point.mode = modes[mode_index];
+  point.payload_len = mtu - 3;
+
+  control.mode = point.mode;
+  control.payload_len = point.payload_len;
+  control.duration_ms = TEST_DURATION_MS;
+  (void)throughput_control_encode(&control, data);
+
+  // Notifications may arrive as soon as the server has the control message
+  throughput_meter_start(&meter, point.interval_us);
+  seq = 0;
+  sc = sl_sleeptimer_ms32_to_tick(TEST_DURATION_MS, &ticks);
+  app_assert_status(sc);
+  end_tick = sl_sleeptimer_get_tick_count64() + ticks;
+
+  sc = sl_bt_gatt_write_characteristic_value(connection_handle, control_handle, sizeof(data), data);
+  app_assert_status(sc);
+  state = STARTING;
+}
+
+/**************************************************************************//**
+ * End the test: the client measured the notifications and indications, the
+ * server the writes.
+ *****************************************************************************/
+static void stop_test(void)
+{
+  sl_status_t sc;
+  throughput_control_t control = { THROUGHPUT_MODE_STOP, 0, 0 };
+  uint8_t data[THROUGHPUT_CONTROL_LEN];
+
+  if (point.mode != THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE) {
+    throughput_meter_finish(&meter, &result);
+    report();
+    next_point();
+    return;
+  }
+  // The stop is received after all writes, the server result is then complete
+  (void)throughput_control_encode(&control, data);
+  sc = sl_bt_gatt_write_characteristic_value(connection_handle, control_handle, sizeof(data), data);
+  app_assert_status(sc);
+  state = STOPPING;
+}
+
+/**************************************************************************//**
+ * Print the result of the point as a line of JSON.
+ *****************************************************************************/
+static void report(void)
+{
+  char line[384];
+
+  (void)throughput_result_format(line, sizeof(line), &point, &result);
+  app_log("%s\r\n", line);
+  points++;
+}
+
+/**************************************************************************//**
+ * Move to the next point of the sweep: mode first, then interval, PHY, and
+ * MTU, which needs a new connection.
+ *****************************************************************************/
+static void next_point(void)
+{
+  sl_status_t sc;
+
+  if (++mode_index < COUNT(modes)) {
+    start_point();
+    return;
+  }
+  mode_index = 0;
+  if (++interval_index < COUNT(intervals)) {
+    start_point();
+    return;
+  }
+  interval_index = 0;
+  if (++phy_index < COUNT(phys)) {
+    start_point();
+    return;
+  }
+  phy_index = 0;
+  state = (++mtu_index < COUNT(mtus)) ? DISCONNECTING : DONE;
+  sc = sl_bt_connection_close(connection_handle);
+  app_assert_status(sc);
+}
+
+/**************************************************************************//**
+ * Queue as many writes without response as the stack takes, until the
+ * duration of the test has passed.
+ *****************************************************************************/
+static void send_packets(void)
+{
+  sl_status_t sc;
+  uint16_t sent_len;
+
+  if (sl_sleeptimer_get_tick_count64() >= end_tick) {
+    return;
+  }
+  do {
+    throughput_packet_fill(packet, point.payload_len, seq, now_us());
+    sc = sl_bt_gatt_write_characteristic_value_without_response(connection_handle,
+                                                                data_handle,
+                                                                point.payload_len,
+                                                                packet,
+                                                                &sent_len);
+    if (sc == SL_STATUS_OK) {
+      seq++;
+    }
+  } while (sc == SL_STATUS_OK);
+}
@@ -0,0 +1,308 @@
+/***************************************************************************//**
+ * @file
+ * @brief Core application logic of the throughput benchmark server.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+#include "em_common.h"
+#include "app_assert.h"
+#include "sl_bluetooth.h"
+#include "sl_sleeptimer.h"
+#include "gatt_db.h"
+#include "app.h"
+#include "app_log.h"
+#include "throughput_meter.h"
+
+// Largest ATT MTU supported by the stack
+#define MAX_MTU                 250
+
+// ATT error returned for a control message that cannot be decoded
+#define ATT_ERROR_INVALID_CONTROL  0x80
+
+// The advertising set handle allocated from Bluetooth stack.
+static uint8_t advertising_set_handle = 0xff;
+
+static uint8_t connection_handle = 0xff;
+static uint16_t mtu = 23;
+static uint32_t interval_us = 0;
+
+// Test run by the server: sending for notifications and indications,
+// receiving for writes without response
+static throughput_control_t control = { THROUGHPUT_MODE_STOP, 0, 0 };
+static bool sending = false;
+static bool receiving = false;
+static bool indication_pending = false;
+static uint32_t seq = 0;
+static uint64_t end_tick = 0;
+static uint8_t packet[MAX_MTU - 3];
+
+static throughput_meter_t meter;
+static throughput_result_t result;
+
+static void start_advertising(void);
+static void on_control(uint8_t *data, uint8_t len);
+static void send_packets(void);
+
+/**************************************************************************//**
+ * Current time in microseconds, wrapping every 71 minutes.
+ *****************************************************************************/
+static uint32_t now_us(void)
+{
+  return (uint32_t)(sl_sleeptimer_get_tick_count64() * 1000000
+                    / sl_sleeptimer_get_timer_frequency());
+}
+
+/**************************************************************************//**
+ * Application Init.
+ *****************************************************************************/
+SL_WEAK void app_init(void)
+{
+  /////////////////////////////////////////////////////////////////////////////
+  // Put your additional application init code here!                         //
+  // This is called once during start-up.                                    //
+  /////////////////////////////////////////////////////////////////////////////
+}
+
+/**************************************************************************//**
+ * Application Process Action.
+ *****************************************************************************/
+void app_process_action(void)
+{
+  if (sending) {
+    send_packets();
+  }
+}
+
+/**************************************************************************//**
+ * Bluetooth stack event handler.
+ * This overrides the dummy weak implementation.
+ *
+ * @param[in] evt Event coming from the Bluetooth stack.
+ *****************************************************************************/
+void sl_bt_on_event(sl_bt_msg_t *evt)
+{
+  sl_status_t sc;
+  uint16_t max_mtu;
+  uint16_t sent_len;
+  uint8_t encoded[THROUGHPUT_RESULT_LEN];
+
+  switch (SL_BT_MSG_ID(evt->header)) {
+    // -------------------------------
+    // This event indicates the device has started and the radio is ready.
+    // Do not call any stack command before receiving this boot event!
+    case sl_bt_evt_system_boot_id:
+      // Allow the largest packets, the client sets the MTU of each test.
+      sc = sl_bt_gatt_server_set_max_mtu(MAX_MTU, &max_mtu);
+      app_assert_status(sc);
+
+      // Create an advertising set.
+      sc = sl_bt_advertiser_create_set(&advertising_set_handle);
+      app_assert_status(sc);
+      // Set advertising interval to 100ms.
+      sc = sl_bt_advertiser_set_timing(
+        advertising_set_handle,
+        160,       // min. adv. interval (milliseconds * 1.6)
+        160,       // max. adv. interval (milliseconds * 1.6)
+        0,         // adv. duration
+        0);        // max. num. adv. events
+      app_assert_status(sc);
+      start_advertising();
+      app_log("boot event - starting advertising\r\n");
+      break;
+
+    // -------------------------------
+    // This event indicates that a new connection was opened.
+    case sl_bt_evt_connection_opened_id:
+      app_log("connection opened\r\n");
+      connection_handle = evt->data.evt_connection_opened.connection;
+      mtu = 23;
+      break;
+
+    case sl_bt_evt_connection_parameters_id:
+      interval_us = evt->data.evt_connection_parameters.interval * 1250UL;
+      break;
+
+    case sl_bt_evt_gatt_mtu_exchanged_id:
+      mtu = evt->data.evt_gatt_mtu_exchanged.mtu;
+      break;
+
+    case sl_bt_evt_gatt_server_user_write_request_id:
+      if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_throughput_data) {
+        // Write without response, no answer to send
+        if (receiving) {
+          throughput_meter_on_packet(&meter,
+                                     now_us(),
+                                     evt->data.evt_gatt_server_user_write_request.value.data,
+                                     evt->data.evt_gatt_server_user_write_request.value.len);
+        }
+      } else if (evt->data.evt_gatt_server_user_write_request.characteristic == gattdb_throughput_control) {
+        on_control(evt->data.evt_gatt_server_user_write_request.value.data,
+                   evt->data.evt_gatt_server_user_write_request.value.len);
+      }
+      break;
+
+    case sl_bt_evt_gatt_server_user_read_request_id:
+      if (evt->data.evt_gatt_server_user_read_request.characteristic == gattdb_throughput_result) {
+        // The result is longer than ATT_MTU - 1 at the default MTU, and is
+        // then read with read blob requests from the offset of the next part
+        uint16_t offset = evt->data.evt_gatt_server_user_read_request.offset;
+
+        (void)throughput_result_encode(&result, encoded);
+        if (offset > sizeof(encoded)) {
+          sc = sl_bt_gatt_server_send_user_read_response(connection_handle,
+                                                         gattdb_throughput_result,
+                                                         (uint8_t)SL_STATUS_BT_ATT_INVALID_OFFSET,
+                                                         0,
+                                                         NULL,
+                                                         &sent_len);
+        } else {
+          sc = sl_bt_gatt_server_send_user_read_response(connection_handle,
+                                                         gattdb_throughput_result,
+                                                         0,
+                                                         sizeof(encoded) - offset,
+                                                         encoded + offset,
+                                                         &sent_len);
+        }
+        app_assert_status(sc);
+      }
+      break;
+
+    case sl_bt_evt_gatt_server_characteristic_status_id:
+      if (evt->data.evt_gatt_server_characteristic_status.characteristic == gattdb_throughput_data
+          && evt->data.evt_gatt_server_characteristic_status.status_flags == sl_bt_gatt_server_confirmation) {
+        indication_pending = false;
+      }
+      break;
+
+    // -------------------------------
+    // This event indicates that a connection was closed.
+    case sl_bt_evt_connection_closed_id:
+      app_log("connection closed, reason: 0x%2.2x\r\n",
+              evt->data.evt_connection_closed.reason);
+      connection_handle = 0xff;
+      sending = false;
+      receiving = false;
+      indication_pending = false;
+      // Restart advertising after client has disconnected.
+      start_advertising();
+      break;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Add additional event handlers here as your application requires!      //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // -------------------------------
+    // Default event handler.
+    default:
+      break;
+  }
+}
+
+/**************************************************************************//**
+ * Start connectable advertising, with the name and the service UUID.
+ *****************************************************************************/
+static void start_advertising(void)
+{
+  sl_status_t sc;
+
+  sc = sl_bt_legacy_advertiser_generate_data(advertising_set_handle,
+                                             sl_bt_advertiser_general_discoverable);
+  app_assert_status(sc);
+  sc = sl_bt_legacy_advertiser_start(advertising_set_handle,
+                                     sl_bt_advertiser_connectable_scannable);
+  app_assert_status(sc);
+}
+
+/**************************************************************************//**
+ * Start or stop a test, as written by the client. The write is answered after
+ * the test is set up, so that the client knows the server is ready.
+ *****************************************************************************/
+static void on_control(uint8_t *data, uint8_t len)
+{
+  sl_status_t sc;
+  uint8_t att_error = 0;
+  uint32_t ticks;
+
+  if (!throughput_control_decode(data, len, &control)) {
+    att_error = ATT_ERROR_INVALID_CONTROL;
+  } else if (control.mode == THROUGHPUT_MODE_STOP) {
+    // The data written without response before was received before this
+    // write, the result is thus complete
+    if (receiving) {
+      throughput_meter_finish(&meter, &result);
+    }
+    sending = false;
+    receiving = false;
+  } else if (control.mode == THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE) {
+    sending = false;
+    receiving = true;
+    throughput_meter_start(&meter, interval_us);
+  } else if (sl_sleeptimer_ms32_to_tick(control.duration_ms, &ticks) != SL_STATUS_OK) {
+    att_error = ATT_ERROR_INVALID_CONTROL;
+  } else {
+    // Notifications carry at most ATT_MTU - 3 bytes
+    if (control.payload_len > mtu - 3) {
+      control.payload_len = mtu - 3;
+    }
+    end_tick = sl_sleeptimer_get_tick_count64() + ticks;
+    seq = 0;
+    indication_pending = false;
+    receiving = false;
+    sending = true;
+  }
+
+  sc = sl_bt_gatt_server_send_user_write_response(connection_handle,
+                                                  gattdb_throughput_control,
+                                                  att_error);
+  app_assert_status(sc);
+}
+
+/**************************************************************************//**
+ * Queue as many notifications as the stack takes, or one indication at a
+ * time, until the duration of the test has passed.
+ *****************************************************************************/
+static void send_packets(void)
+{
+  sl_status_t sc;
+
+  if (sl_sleeptimer_get_tick_count64() >= end_tick) {
+    sending = false;
+    return;
+  }
+  if (control.mode == THROUGHPUT_MODE_INDICATE) {
+    if (indication_pending) {
+      return;
+    }
+    throughput_packet_fill(packet, control.payload_len, seq, now_us());
+    sc = sl_bt_gatt_server_send_indication(connection_handle,
+                                           gattdb_throughput_data,
+                                           control.payload_len,
+                                           packet);
+    if (sc == SL_STATUS_OK) {
+      seq++;
+      indication_pending = true;
+    }
+    return;
+  }
+
+  do {
+    throughput_packet_fill(packet, control.payload_len, seq, now_us());
+    sc = sl_bt_gatt_server_send_notification(connection_handle,
+                                             gattdb_throughput_data,
+                                             control.payload_len,
+                                             packet);
+    if (sc == SL_STATUS_OK) {
+      seq++;
+    }
+  } while (sc == SL_STATUS_OK);
+}
@@ -0,0 +1,289 @@
+/***************************************************************************//**
+ * @file throughput_meter.c
+ * @brief Measurement core of the GATT throughput benchmark.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "throughput_meter.h"
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+  put_u16(p, (uint16_t)v);
+  put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+  return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+// xorshift32, enough to pick the latencies kept
+static uint32_t next_random(throughput_meter_t *meter)
+{
+  uint32_t x = meter->random;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  meter->random = x;
+  return x;
+}
+
+// Keep a uniform sample of all latencies (reservoir sampling)
+static void add_latency(throughput_meter_t *meter, int32_t latency)
+{
+  uint32_t slot;
+
+  if (meter->seen < THROUGHPUT_METER_LATENCY_SAMPLES) {
+    meter->latencies[meter->seen] = latency;
+  } else {
+    slot = next_random(meter) % (meter->seen + 1);
+    if (slot < THROUGHPUT_METER_LATENCY_SAMPLES) {
+      meter->latencies[slot] = latency;
+    }
+  }
+  meter->seen++;
+}
+
+static int compare_latencies(const void *a, const void *b)
+{
+  int32_t x = *(const int32_t *)a;
+  int32_t y = *(const int32_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+void throughput_meter_start(throughput_meter_t *meter, uint32_t interval_us)
+{
+  memset(meter, 0, sizeof(*meter));
+  meter->interval_us = interval_us;
+  meter->random = 0x2545F491;
+}
+
+void throughput_meter_on_packet(throughput_meter_t *meter,
+                                uint32_t rx_us,
+                                const uint8_t *data,
+                                uint16_t len)
+{
+  throughput_result_t *r = &meter->result;
+  uint32_t seq;
+  uint32_t guard = meter->interval_us / 8;
+  uint32_t elapsed;
+  uint32_t grid;
+  int32_t delay;
+
+  if (len < THROUGHPUT_HEADER_LEN) {
+    return;
+  }
+  seq = get_u32(data);
+  // Relative to the first packet, so that the clock offset cancels out
+  if (r->packets == 0) {
+    meter->first_rx_us = rx_us;
+    meter->event_start_us = rx_us;
+    meter->first_delay_us = rx_us - get_u32(data + 4);
+    delay = 0;
+    r->events = 1;
+  } else {
+    delay = (int32_t)(rx_us - get_u32(data + 4) - meter->first_delay_us);
+    elapsed = rx_us - meter->event_start_us + guard;
+    if (meter->interval_us != 0 && elapsed >= meter->interval_us) {
+      // Follow the grid of the connection interval, so that an event whose
+      // first packet is late is not merged with the next one. A packet close
+      // to the grid becomes the new anchor, which absorbs the clock drift.
+      grid = meter->event_start_us + elapsed - elapsed % meter->interval_us;
+      meter->event_start_us = (rx_us - grid + guard < 2 * guard) ? rx_us : grid;
+      meter->event_packets = 0;
+      r->events++;
+    }
+  }
+  meter->event_packets++;
+  if (meter->event_packets > r->max_packets_per_event) {
+    r->max_packets_per_event = meter->event_packets;
+  }
+
+  if (seq >= meter->next_seq) {
+    r->lost += seq - meter->next_seq;
+    meter->next_seq = seq + 1;
+  }
+  if (r->packets == 0 || delay < meter->min_delay_us) {
+    meter->min_delay_us = delay;
+  }
+  if (r->packets == 0 || delay > meter->max_delay_us) {
+    meter->max_delay_us = delay;
+  }
+  add_latency(meter, delay);
+
+  r->packets++;
+  r->bytes += len;
+  meter->last_rx_us = rx_us;
+}
+
+void throughput_meter_finish(throughput_meter_t *meter, throughput_result_t *result)
+{
+  throughput_result_t *r = &meter->result;
+  uint32_t count = meter->seen;
+
+  if (count > THROUGHPUT_METER_LATENCY_SAMPLES) {
+    count = THROUGHPUT_METER_LATENCY_SAMPLES;
+  }
+  if (r->packets != 0) {
+    r->duration_us = meter->last_rx_us - meter->first_rx_us;
+    qsort(meter->latencies, count, sizeof(meter->latencies[0]), compare_latencies);
+    r->latency_p50_us = (uint32_t)(meter->latencies[(count - 1) * 50 / 100] - meter->min_delay_us);
+    r->latency_p90_us = (uint32_t)(meter->latencies[(count - 1) * 90 / 100] - meter->min_delay_us);
+    r->latency_p99_us = (uint32_t)(meter->latencies[(count - 1) * 99 / 100] - meter->min_delay_us);
+    r->latency_max_us = (uint32_t)(meter->max_delay_us - meter->min_delay_us);
+  }
+  *result = *r;
+}
+
+void throughput_packet_fill(uint8_t *data, uint16_t len, uint32_t seq, uint32_t tx_us)
+{
+  put_u32(data, seq);
+  put_u32(data + 4, tx_us);
+  for (uint16_t i = THROUGHPUT_HEADER_LEN; i < len; i++) {
+    data[i] = (uint8_t)i;
+  }
+}
+
+size_t throughput_control_encode(const throughput_control_t *control, uint8_t *data)
+{
+  data[0] = (uint8_t)control->mode;
+  put_u16(data + 1, control->payload_len);
+  put_u32(data + 3, control->duration_ms);
+  return THROUGHPUT_CONTROL_LEN;
+}
+
+bool throughput_control_decode(const uint8_t *data, size_t len, throughput_control_t *control)
+{
+  if (len < THROUGHPUT_CONTROL_LEN || data[0] > THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE) {
+    return false;
+  }
+  control->mode = (throughput_mode_t)data[0];
+  control->payload_len = get_u16(data + 1);
+  control->duration_ms = get_u32(data + 3);
+  return control->mode == THROUGHPUT_MODE_STOP
+         || control->payload_len >= THROUGHPUT_HEADER_LEN;
+}
+
+size_t throughput_result_encode(const throughput_result_t *result, uint8_t *data)
+{
+  put_u32(data, result->bytes);
+  put_u32(data + 4, result->packets);
+  put_u32(data + 8, result->lost);
+  put_u32(data + 12, result->duration_us);
+  put_u32(data + 16, result->events);
+  put_u16(data + 20, result->max_packets_per_event);
+  put_u32(data + 22, result->latency_p50_us);
+  put_u32(data + 26, result->latency_p90_us);
+  put_u32(data + 30, result->latency_p99_us);
+  put_u32(data + 34, result->latency_max_us);
+  return THROUGHPUT_RESULT_LEN;
+}
+
+bool throughput_result_decode(const uint8_t *data, size_t len, throughput_result_t *result)
+{
+  if (len < THROUGHPUT_RESULT_LEN) {
+    return false;
+  }
+  result->bytes = get_u32(data);
+  result->packets = get_u32(data + 4);
+  result->lost = get_u32(data + 8);
+  result->duration_us = get_u32(data + 12);
+  result->events = get_u32(data + 16);
+  result->max_packets_per_event = get_u16(data + 20);
+  result->latency_p50_us = get_u32(data + 22);
+  result->latency_p90_us = get_u32(data + 26);
+  result->latency_p99_us = get_u32(data + 30);
+  result->latency_max_us = get_u32(data + 34);
+  return true;
+}
+
+uint32_t throughput_result_goodput_bps(const throughput_result_t *result)
+{
+  if (result->duration_us == 0) {
+    return 0;
+  }
+  // The first packet arrives at the start of the duration, it is not counted
+  return (uint32_t)((uint64_t)result->bytes * (result->packets - 1) / result->packets
+                    * 8 * 1000000 / result->duration_us);
+}
+
+const char *throughput_phy_name(uint8_t phy)
+{
+  switch (phy) {
+    case THROUGHPUT_PHY_1M:
+      return "1M";
+    case THROUGHPUT_PHY_2M:
+      return "2M";
+    case THROUGHPUT_PHY_CODED:
+      return "coded";
+    default:
+      return "unknown";
+  }
+}
+
+static const char *mode_name(throughput_mode_t mode)
+{
+  switch (mode) {
+    case THROUGHPUT_MODE_NOTIFY:
+      return "notify";
+    case THROUGHPUT_MODE_INDICATE:
+      return "indicate";
+    case THROUGHPUT_MODE_WRITE_WITHOUT_RESPONSE:
+      return "write_without_response";
+    default:
+      return "stop";
+  }
+}
+
+int throughput_result_format(char *buf,
+                             size_t size,
+                             const throughput_point_t *point,
+                             const throughput_result_t *result)
+{
+  // Packets per event in hundredths, printf of embedded targets lacks %f
+  uint32_t per_event = result->events ? (uint32_t)((uint64_t)result->packets * 100 / result->events) : 0;
+
+  return snprintf(buf, size,
+                  "{\"phy\":\"%s\",\"mtu\":%u,\"interval_us\":%lu,\"mode\":\"%s\","
+                  "\"payload\":%u,\"bytes\":%lu,\"packets\":%lu,\"lost\":%lu,"
+                  "\"duration_us\":%lu,\"goodput_bps\":%lu,\"events\":%lu,"
+                  "\"packets_per_event_x100\":%lu,\"packets_per_event_max\":%u,"
+                  "\"latency_p50_us\":%lu,\"latency_p90_us\":%lu,"
+                  "\"latency_p99_us\":%lu,\"latency_max_us\":%lu}",
+                  throughput_phy_name(point->phy), point->mtu, (unsigned long)point->interval_us,
+                  mode_name(point->mode), point->payload_len,
+                  (unsigned long)result->bytes, (unsigned long)result->packets,
+                  (unsigned long)result->lost, (unsigned long)result->duration_us,
+                  (unsigned long)throughput_result_goodput_bps(result),
+                  (unsigned long)result->events, (unsigned long)per_event,
+                  result->max_packets_per_event,
+                  (unsigned long)result->latency_p50_us, (unsigned long)result->latency_p90_us,
+                  (unsigned long)result->latency_p99_us, (unsigned long)result->latency_max_us);
+}
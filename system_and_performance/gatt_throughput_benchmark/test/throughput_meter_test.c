@@ -0,0 +1,232 @@
+/***************************************************************************//**
+ * @file throughput_meter_test.c
+ * @brief Host test of the measurement core of the GATT throughput benchmark.
+ *******************************************************************************
+ * # License
+ * <b>Copyright 2026 Silicon Laboratories Inc. www.silabs.com</b>
+ *******************************************************************************
+ *
+ * The licensor of this software is Silicon Laboratories Inc. Your use of this
+ * software is governed by the terms of Silicon Labs Master Software License
+ * Agreement (MSLA) available at
+ * www.silabs.com/about-us/legal/master-software-license-agreement. This
+ * software is distributed to you in Source Code format and is governed by the
+ * sections of the MSLA applicable to Source Code.
+ *
+ ******************************************************************************/
+
+/* Feeds throughput_meter.c with synthetic packet arrival times: connection
+ * events with jitter, a receiver clock drifting by 80 ppm, an unrelated
+ * sender clock, queueing delays and a lost packet. Checks the grouping into
+ * connection events, the goodput, the latency percentiles, the reservoir
+ * beyond its size, the encoding of control messages and results, including
+ * a result read in parts as at the default ATT MTU, and the JSON line.
+ * Build and run on Linux:
+ *
+ *   gcc -Wall -Wextra -std=gnu11 -I../inc throughput_meter_test.c ../src/throughput_meter.c -o throughput_meter_test
+ *   ./throughput_meter_test
+ *
+ * The program prints the failed checks and exits with a non-zero status if
+ * there are any.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "throughput_meter.h"
+
+#define DRIFT_PPM       80
+#define SENDER_OFFSET   12345678
+
+static unsigned failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+static throughput_meter_t meter;
+static uint8_t packet[244];
+
+static void receive(uint32_t seq, uint32_t tx_us, uint32_t rx_us, uint16_t len)
+{
+  throughput_packet_fill(packet, len, seq, tx_us);
+  throughput_meter_on_packet(&meter, rx_us, packet, len);
+}
+
+// 1000 events of 7.5 ms with 6 packets each, 350 us apart. Packet k waited
+// k * 1250 us in the queue of the sender. The 3rd packet of event 500 is lost.
+static void test_events(void)
+{
+  const uint32_t interval_us = 7500;
+  throughput_result_t result;
+  uint32_t goodput;
+  uint32_t seq = 0;
+
+  srand(3);
+  throughput_meter_start(&meter, interval_us);
+  for (uint32_t e = 0; e < 1000; e++) {
+    uint64_t anchor = 1000000 + (uint64_t)e * interval_us;
+    uint32_t jitter = (uint32_t)rand() % 200;
+
+    for (uint32_t k = 0; k < 6; k++) {
+      uint64_t rx = anchor + jitter + k * 350;
+      uint64_t tx = rx - 600 - k * 1250;
+
+      if (e == 500 && k == 2) {
+        seq++;
+        continue;
+      }
+      rx += rx * DRIFT_PPM / 1000000;
+      receive(seq++, (uint32_t)(tx + SENDER_OFFSET), (uint32_t)rx, sizeof(packet));
+    }
+  }
+  throughput_meter_finish(&meter, &result);
+  CHECK(result.events == 1000 && result.max_packets_per_event == 6);
+  CHECK(result.packets == 5999 && result.lost == 1);
+  CHECK(result.bytes == 5999 * sizeof(packet));
+
+  // 6 packets of 244 bytes per 7.5 ms is 1.5616 Mbit/s
+  goodput = throughput_result_goodput_bps(&result);
+  CHECK(goodput > 1550000 && goodput < 1575000);
+
+  // Latencies of 0 to 6250 us above the minimum, evenly spread
+  CHECK(result.latency_p50_us >= 2400 && result.latency_p50_us <= 3200);
+  CHECK(result.latency_p90_us >= 6100 && result.latency_p90_us <= 6900);
+  CHECK(result.latency_max_us >= 6200 && result.latency_max_us <= 6900);
+}
+
+// A late first packet starts an event of its own, an event without packets
+// keeps the grid
+static void test_grid(void)
+{
+  static const uint32_t late[] = { 0, 500, 1000, 50000, 50500, 60000, 60400, 90100, 120050 };
+  static const uint32_t skipped[] = { 0, 100, 50050, 50200, 50300, 99990 };
+  throughput_result_t result;
+
+  throughput_meter_start(&meter, 30000);
+  for (uint32_t i = 0; i < sizeof(late) / sizeof(late[0]); i++) {
+    receive(i, late[i], late[i] + 7, 20);
+  }
+  throughput_meter_finish(&meter, &result);
+  CHECK(result.events == 5 && result.max_packets_per_event == 3 && result.lost == 0);
+
+  throughput_meter_start(&meter, 10000);
+  for (uint32_t i = 0; i < sizeof(skipped) / sizeof(skipped[0]); i++) {
+    receive(i, 0, skipped[i], 20);
+  }
+  throughput_meter_finish(&meter, &result);
+  CHECK(result.events == 3 && result.max_packets_per_event == 3);
+
+  // Packets shorter than the header are ignored, a test without packets
+  // reports zeros
+  throughput_meter_start(&meter, 10000);
+  throughput_meter_on_packet(&meter, 5, packet, THROUGHPUT_HEADER_LEN - 1);
+  throughput_meter_finish(&meter, &result);
+  CHECK(result.packets == 0 && result.events == 0);
+  CHECK(throughput_result_goodput_bps(&result) == 0);
+}
+
+// 100000 latencies of 0 to 99999 us, far more than the reservoir keeps
+static void test_reservoir(void)
+{
+  throughput_result_t result;
+
+  throughput_meter_start(&meter, 1000);
+  for (uint32_t i = 0; i < 100000; i++) {
+    receive(i, 0, (i * 7919) % 100000, THROUGHPUT_HEADER_LEN);
+  }
+  throughput_meter_finish(&meter, &result);
+  CHECK(result.packets == 100000 && result.lost == 0);
+  CHECK(result.latency_p50_us > 45000 && result.latency_p50_us < 55000);
+  CHECK(result.latency_p90_us > 87000 && result.latency_p90_us < 93000);
+  CHECK(result.latency_p99_us > 96000);
+  CHECK(result.latency_max_us == 99999);
+}
+
+static bool same_result(const throughput_result_t *a, const throughput_result_t *b)
+{
+  return a->bytes == b->bytes && a->packets == b->packets && a->lost == b->lost
+         && a->duration_us == b->duration_us && a->events == b->events
+         && a->max_packets_per_event == b->max_packets_per_event
+         && a->latency_p50_us == b->latency_p50_us && a->latency_p90_us == b->latency_p90_us
+         && a->latency_p99_us == b->latency_p99_us && a->latency_max_us == b->latency_max_us;
+}
+
+static void test_encoding(void)
+{
+  throughput_result_t result = { 1464000, 6000, 2, 7496000, 1000, 6, 2500, 6250, 6800, 6900 };
+  throughput_result_t decoded;
+  throughput_control_t control = { THROUGHPUT_MODE_INDICATE, 244, 5000 };
+  throughput_control_t control_decoded;
+  uint8_t data[THROUGHPUT_RESULT_LEN];
+  uint8_t parts[THROUGHPUT_RESULT_LEN];
+  uint16_t offset;
+
+  CHECK(throughput_result_encode(&result, data) == THROUGHPUT_RESULT_LEN);
+  CHECK(!throughput_result_decode(data, THROUGHPUT_RESULT_LEN - 1, &decoded));
+  CHECK(throughput_result_decode(data, THROUGHPUT_RESULT_LEN, &decoded));
+  CHECK(same_result(&result, &decoded));
+
+  // At an ATT MTU of 23, a read returns 22 bytes and read blobs the rest,
+  // each from the offset the server was asked for
+  memset(parts, 0, sizeof(parts));
+  for (offset = 0; offset < THROUGHPUT_RESULT_LEN; offset += 22) {
+    uint16_t len = THROUGHPUT_RESULT_LEN - offset;
+
+    memcpy(&parts[offset], &data[offset], len < 22 ? len : 22);
+  }
+  memset(&decoded, 0, sizeof(decoded));
+  CHECK(throughput_result_decode(parts, sizeof(parts), &decoded));
+  CHECK(same_result(&result, &decoded));
+  // The first part alone is not a result
+  CHECK(!throughput_result_decode(parts, 22, &decoded));
+
+  CHECK(throughput_control_encode(&control, data) == THROUGHPUT_CONTROL_LEN);
+  CHECK(throughput_control_decode(data, THROUGHPUT_CONTROL_LEN, &control_decoded));
+  CHECK(control_decoded.mode == control.mode && control_decoded.payload_len == 244
+        && control_decoded.duration_ms == 5000);
+  CHECK(!throughput_control_decode(data, THROUGHPUT_CONTROL_LEN - 1, &control_decoded));
+  data[0] = 9;
+  CHECK(!throughput_control_decode(data, THROUGHPUT_CONTROL_LEN, &control_decoded));
+  control.payload_len = THROUGHPUT_HEADER_LEN - 1;
+  (void)throughput_control_encode(&control, data);
+  CHECK(!throughput_control_decode(data, THROUGHPUT_CONTROL_LEN, &control_decoded));
+}
+
+static void test_format(void)
+{
+  throughput_point_t point = { THROUGHPUT_PHY_2M, 247, 7500, THROUGHPUT_MODE_NOTIFY, 244 };
+  throughput_result_t result;
+  char line[384];
+  int len;
+
+  throughput_meter_start(&meter, 7500);
+  receive(0, 0, 0, sizeof(packet));
+  receive(1, 0, 1000, sizeof(packet));
+  throughput_meter_finish(&meter, &result);
+  len = throughput_result_format(line, sizeof(line), &point, &result);
+  CHECK(len > 0 && (size_t)len < sizeof(line));
+  CHECK(strstr(line, "\"phy\":\"2M\"") != NULL);
+  CHECK(strstr(line, "\"goodput_bps\":1952000") != NULL);
+  CHECK(strstr(line, "\"packets_per_event_x100\":200") != NULL);
+  CHECK(strcmp(throughput_phy_name(THROUGHPUT_PHY_CODED), "coded") == 0);
+}
+
+int main(void)
+{
+  test_events();
+  test_grid();
+  test_reservoir();
+  test_encoding();
+  test_format();
+  if (failures != 0) {
+    printf("%u checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
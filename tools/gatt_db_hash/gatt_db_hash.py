@@ -0,0 +1,516 @@
+#!/usr/bin/env python3
+################################################################################
+# GATT Database Hash calculator
+################################################################################
+# License
+# Copyright 2026 Silicon Laboratories Inc. www.silabs.com
+################################################################################
+#
+# SPDX-License-Identifier: Zlib
+#
+# The licensor of this software is Silicon Laboratories Inc.
+#
+# This software is provided 'as-is', without any express or implied
+# warranty. In no event will the authors be held liable for any damages
+# arising from the use of this software.
+#
+# Permission is granted to anyone to use this software for any purpose,
+# including commercial applications, and to alter it and redistribute it
+# freely, subject to the following restrictions:
+#
+# 1. The origin of this software must not be misrepresented; you must not
+#    claim that you wrote the original software. If you use this software
+#    in a product, an acknowledgment in the product documentation would be
+#    appreciated but is not required.
+# 2. Altered source versions must be plainly marked as such, and must not be
+#    misrepresented as being the original software.
+# 3. This notice may not be removed or altered from any source distribution.
+#
+################################################################################
+
+"""Compute the GATT Database Hash of every capability combination of a GATT
+configuration (.btconf / gatt.xml) and write them as a C header.
+
+The hash is the one of the Bluetooth Core Specification, Vol 3, Part G,
+7.3.1: AES-CMAC with a zero key over the handle, type and, for declarations
+and Characteristic Extended Properties, the value of the attributes a client
+can see. Attributes hidden by the capabilities keep their handles.
+"""
+
+import argparse
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+UUID_PRIMARY_SERVICE = 0x2800
+UUID_SECONDARY_SERVICE = 0x2801
+UUID_INCLUDE = 0x2802
+UUID_CHARACTERISTIC = 0x2803
+UUID_EXTENDED_PROPERTIES = 0x2900
+UUID_USER_DESCRIPTION = 0x2901
+UUID_CLIENT_CONFIGURATION = 0x2902
+
+# Attributes hashed with their handle, type and value
+HASHED_WITH_VALUE = (UUID_PRIMARY_SERVICE, UUID_SECONDARY_SERVICE, UUID_INCLUDE,
+                     UUID_CHARACTERISTIC, UUID_EXTENDED_PROPERTIES)
+
+# Descriptors hashed with their handle and type only
+HASHED_WITHOUT_VALUE = (0x2901, 0x2902, 0x2903, 0x2904, 0x2905)
+
+PROPERTY_BITS = {
+    "broadcast": 0x01,
+    "read": 0x02,
+    "write_no_response": 0x04,
+    "write": 0x08,
+    "notify": 0x10,
+    "indicate": 0x20,
+    "authenticated_write": 0x40,
+}
+
+# Largest number of capabilities whose combinations are all listed
+MAX_ALL_COMBINATIONS = 8
+
+################################################################################
+# AES-128 and AES-CMAC (RFC 4493), to depend on nothing but the standard library
+################################################################################
+
+def _xtime(a):
+    a <<= 1
+    return (a ^ 0x11B) if a & 0x100 else a
+
+
+def _make_sbox():
+    sbox = [0] * 256
+    p = q = 1
+    while True:
+        # p runs through the multiplicative group, q = 1 / p
+        p = p ^ _xtime(p)
+        q ^= q << 1
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        x = q ^ ((q << 1) | (q >> 7)) ^ ((q << 2) | (q >> 6)) \
+            ^ ((q << 3) | (q >> 5)) ^ ((q << 4) | (q >> 4))
+        sbox[p] = (x ^ 0x63) & 0xFF
+        if p == 1:
+            break
+    sbox[0] = 0x63
+    return sbox
+
+
+SBOX = _make_sbox()
+
+
+def _expand_key(key):
+    words = [list(key[i:i + 4]) for i in range(0, 16, 4)]
+    rcon = 1
+    for i in range(4, 44):
+        w = list(words[i - 1])
+        if i % 4 == 0:
+            w = [SBOX[b] for b in w[1:] + w[:1]]
+            w[0] ^= rcon
+            rcon = _xtime(rcon)
+        words.append([a ^ b for a, b in zip(words[i - 4], w)])
+    return [sum(words[r * 4:r * 4 + 4], []) for r in range(11)]
+
+
+def aes128_encrypt(key, block):
+    round_keys = _expand_key(key)
+    s = [a ^ b for a, b in zip(block, round_keys[0])]
+    for r in range(1, 11):
+        s = [SBOX[b] for b in s]
+        # ShiftRows, the state being column major
+        s = [s[(i + 4 * (i % 4)) % 16] for i in range(16)]
+        if r != 10:
+            mixed = []
+            for c in range(4):
+                a = s[c * 4:c * 4 + 4]
+                t = a[0] ^ a[1] ^ a[2] ^ a[3]
+                mixed += [a[i] ^ t ^ _xtime(a[i] ^ a[(i + 1) % 4]) for i in range(4)]
+            s = [b & 0xFF for b in mixed]
+        s = [a ^ b for a, b in zip(s, round_keys[r])]
+    return bytes(s)
+
+
+def _shift_left(block):
+    value = (int.from_bytes(block, "big") << 1) & ((1 << 128) - 1)
+    return value.to_bytes(16, "big")
+
+
+def aes_cmac(key, message):
+    k1 = _shift_left(aes128_encrypt(key, bytes(16)))
+    if aes128_encrypt(key, bytes(16))[0] & 0x80:
+        k1 = k1[:15] + bytes([k1[15] ^ 0x87])
+    k2 = _shift_left(k1)
+    if k1[0] & 0x80:
+        k2 = k2[:15] + bytes([k2[15] ^ 0x87])
+
+    blocks = max(1, (len(message) + 15) // 16)
+    last = message[(blocks - 1) * 16:]
+    if len(last) == 16:
+        last = bytes(a ^ b for a, b in zip(last, k1))
+    else:
+        last = last + b"\x80" + bytes(15 - len(last))
+        last = bytes(a ^ b for a, b in zip(last, k2))
+
+    x = bytes(16)
+    for i in range(blocks - 1):
+        x = aes128_encrypt(key, bytes(a ^ b for a, b in zip(x, message[i * 16:i * 16 + 16])))
+    return aes128_encrypt(key, bytes(a ^ b for a, b in zip(x, last)))
+
+
+# Examples 1 to 4 of RFC 4493: one key, and the first 0, 16, 40 and 64 bytes
+# of one message
+RFC_4493_KEY = bytes.fromhex("2b7e151628aed2a6abf7158809cf4f3c")
+RFC_4493_MESSAGE = bytes.fromhex(
+    "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+    "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710")
+RFC_4493_EXAMPLES = [
+    (0, "bb1d6929e95937287fa37d129b756746"),
+    (16, "070a16b46b4d4144f79bdd9dd04a287c"),
+    (40, "dfa66747de9ae63030ca32611497c827"),
+    (64, "51f0bebf7e3b9d92fc49741779363cfe"),
+]
+
+
+# Example database of the Core Specification, Vol 3, Part G, Appendix B:
+# (handle, type, value) of the hashed attributes, and its Database Hash as
+# the CMAC output. The Generic Attribute service has Client Supported Features
+# before Database Hash, and the Battery Level has an extended properties
+# descriptor after its Client Characteristic Configuration, so the table is
+# given as is rather than as a GATT configuration.
+CORE_SPEC_DATABASE = [
+    (1, 0x2800, "0018"),
+    (2, 0x2803, "0a0300002a"),
+    (4, 0x2803, "020500012a"),
+    (6, 0x2800, "0118"),
+    (7, 0x2803, "200800052a"),
+    (9, 0x2902, ""),
+    (10, 0x2803, "0a0b00292b"),
+    (12, 0x2803, "020d002a2b"),
+    (14, 0x2800, "0818"),
+    (15, 0x2802, "140016000f18"),
+    (16, 0x2803, "a21100182a"),
+    (18, 0x2902, ""),
+    (19, 0x2900, "0000"),
+    (20, 0x2801, "0f18"),
+    (21, 0x2803, "021600192a"),
+]
+CORE_SPEC_HASH = "f1ca2d48ecf58bac8a8830bbb9fba990"
+
+# GATT configuration covering what the stack adds and the descriptors, with
+# the bytes the tool must hash for it
+PARSER_EXAMPLE = """<gatt generic_attribute_service="true" gatt_caching="true">
+  <service uuid="180F">
+    <characteristic uuid="2A19">
+      <description>Battery Level</description>
+      <properties read="true" notify="true"/>
+      <descriptor uuid="0f1e2d3c-4b5a-6978-8796-a5b4c3d2e1f0">
+        <value>00</value>
+      </descriptor>
+      <descriptor uuid="2904">
+        <value>04</value>
+      </descriptor>
+    </characteristic>
+  </service>
+</gatt>"""
+PARSER_EXAMPLE_INPUT = (
+    "010000280118"              # Generic Attribute service
+    "02000328200300052a"        # Service Changed, indicate
+    "04000229"                  # its Client Characteristic Configuration
+    "050003280206002a2b"        # Database Hash, read
+    "070003280a0800292b"        # Client Supported Features, read and write
+    "090000280f18"              # Battery service
+    "0a000328120b00192a"        # Battery Level, read and notify
+    "0c000229"                  # its Client Characteristic Configuration
+    "0d000129"                  # User Description from <description>
+    "0f000429"                  # Presentation Format; handle 14 is 128-bit
+)
+
+
+def self_test():
+    """Check AES-128 against FIPS-197, AES-CMAC against RFC 4493, the hash of
+    the Core Specification example database, and the attributes the parser
+    lays out for PARSER_EXAMPLE."""
+    ok = aes128_encrypt(bytes(range(16)), bytes.fromhex("00112233445566778899aabbccddeeff")) \
+        == bytes.fromhex("69c4e0d86a7b0430d8cdb78070b4c55a")
+    for length, mac in RFC_4493_EXAMPLES:
+        ok = ok and aes_cmac(RFC_4493_KEY, RFC_4493_MESSAGE[:length]) == bytes.fromhex(mac)
+    message = b"".join(hashed_bytes(handle, uuid_type, bytes.fromhex(value))
+                       for handle, uuid_type, value in CORE_SPEC_DATABASE)
+    ok = ok and aes_cmac(bytes(16), message) == bytes.fromhex(CORE_SPEC_HASH)
+    db = GattDatabase(ET.fromstring(PARSER_EXAMPLE))
+    ok = ok and db.hash_input(db.all) == bytes.fromhex(PARSER_EXAMPLE_INPUT)
+    return ok
+
+################################################################################
+# GATT configuration
+################################################################################
+
+class Attribute:
+    def __init__(self, uuid_type, value, capabilities):
+        self.handle = 0
+        self.type = uuid_type
+        self.value = value              # bytes, or a callable once handles are known
+        self.capabilities = capabilities  # Visible if one is enabled, always if None
+
+
+def uuid_bytes(text):
+    """UUID as written in the configuration, little endian as on air"""
+    digits = text.replace("-", "").strip()
+    if len(digits) not in (4, 32):
+        raise ValueError("invalid UUID '%s'" % text)
+    return bytes.fromhex(digits)[::-1]
+
+
+def is_true(value):
+    return value is not None and value.lower() == "true"
+
+
+def properties_of(characteristic):
+    """Characteristic properties and extended properties"""
+    properties = 0
+    extended = 0
+    element = characteristic.find("properties")
+    if element is None:
+        return properties, extended
+    # Either attributes (<properties read="true"/>) or children (<read/>)
+    names = [name for name, value in element.attrib.items() if is_true(value)]
+    names += [child.tag for child in element]
+    for name in names:
+        properties |= PROPERTY_BITS.get(name, 0)
+        if name == "reliable_write":
+            extended |= 0x01
+        elif name == "writable_auxiliaries":
+            extended |= 0x02
+    if extended:
+        properties |= 0x80
+    return properties, extended
+
+
+def hashed_bytes(handle, uuid_type, value):
+    """Part of the hashed message for one attribute, empty if it is not hashed"""
+    # A 128-bit descriptor type is never hashed
+    if not isinstance(uuid_type, int):
+        return b""
+    if uuid_type in HASHED_WITH_VALUE:
+        return handle.to_bytes(2, "little") + uuid_type.to_bytes(2, "little") + value
+    if uuid_type in HASHED_WITHOUT_VALUE:
+        return handle.to_bytes(2, "little") + uuid_type.to_bytes(2, "little")
+    return b""
+
+
+class GattDatabase:
+    def __init__(self, root):
+        self.capabilities = [c.text.strip() for c in root.iterfind("capabilities_declare/capability")]
+        self.default = 0
+        for bit, c in enumerate(root.iterfind("capabilities_declare/capability")):
+            if is_true(c.get("enable", "true")):
+                self.default |= 1 << bit
+        self.all = (1 << len(self.capabilities)) - 1 if self.capabilities else 0
+        self.attributes = []
+        self.services = {}              # id -> (declaration, end attribute, uuid)
+
+        if is_true(root.get("generic_attribute_service")):
+            self._add_generic_attribute_service(is_true(root.get("gatt_caching")))
+        for service in root.iterfind("service"):
+            self._add_service(service)
+
+        for handle, attribute in enumerate(self.attributes, start=1):
+            attribute.handle = handle
+        for attribute in self.attributes:
+            if callable(attribute.value):
+                attribute.value = attribute.value()
+
+    def _capabilities_of(self, element, inherited):
+        names = [c.text.strip() for c in element.iterfind("capabilities/capability")]
+        if not names:
+            return inherited
+        mask = 0
+        for name in names:
+            if name not in self.capabilities:
+                raise ValueError("capability '%s' is not declared" % name)
+            mask |= 1 << self.capabilities.index(name)
+        return mask & inherited
+
+    def _add_characteristic(self, uuid, properties, capabilities, extended=0):
+        value = Attribute(uuid, b"", capabilities)
+        self.attributes.append(Attribute(UUID_CHARACTERISTIC,
+                                         lambda: bytes([properties])
+                                         + value.handle.to_bytes(2, "little")
+                                         + uuid,
+                                         capabilities))
+        self.attributes.append(value)
+        if extended:
+            self.attributes.append(Attribute(UUID_EXTENDED_PROPERTIES,
+                                             extended.to_bytes(2, "little"),
+                                             capabilities))
+        if properties & (PROPERTY_BITS["notify"] | PROPERTY_BITS["indicate"]):
+            self.attributes.append(Attribute(UUID_CLIENT_CONFIGURATION, b"", capabilities))
+
+    def _add_generic_attribute_service(self, caching):
+        # Added by the stack, visible whatever the capabilities
+        self.attributes.append(Attribute(UUID_PRIMARY_SERVICE, uuid_bytes("1801"), None))
+        self._add_characteristic(uuid_bytes("2A05"), PROPERTY_BITS["indicate"], None)
+        if caching:
+            self._add_characteristic(uuid_bytes("2B2A"), PROPERTY_BITS["read"], None)
+            self._add_characteristic(uuid_bytes("2B29"),
+                                     PROPERTY_BITS["read"] | PROPERTY_BITS["write"],
+                                     None)
+
+    def _add_service(self, service):
+        capabilities = self._capabilities_of(service, self.all)
+        uuid = uuid_bytes(service.get("uuid"))
+        kind = UUID_SECONDARY_SERVICE if service.get("type") == "secondary" else UUID_PRIMARY_SERVICE
+        declaration = Attribute(kind, uuid, capabilities)
+        self.attributes.append(declaration)
+
+        for include in service.iterfind("include"):
+            self.attributes.append(Attribute(UUID_INCLUDE, self._include_value(include.get("id")),
+                                             capabilities))
+
+        for characteristic in service.iterfind("characteristic"):
+            char_capabilities = self._capabilities_of(characteristic, capabilities)
+            properties, extended = properties_of(characteristic)
+            self._add_characteristic(uuid_bytes(characteristic.get("uuid")),
+                                     properties, char_capabilities, extended)
+            if characteristic.find("description") is not None:
+                self.attributes.append(Attribute(UUID_USER_DESCRIPTION, b"", char_capabilities))
+            for descriptor in characteristic.iterfind("descriptor"):
+                descriptor_uuid = uuid_bytes(descriptor.get("uuid"))
+                self.attributes.append(Attribute(int.from_bytes(descriptor_uuid, "little")
+                                                 if len(descriptor_uuid) == 2 else descriptor_uuid,
+                                                 b"",
+                                                 self._capabilities_of(descriptor, char_capabilities)))
+
+        if service.get("id") is not None:
+            self.services[service.get("id")] = (declaration, self.attributes[-1], uuid)
+
+    def _include_value(self, service_id):
+        def value():
+            if service_id not in self.services:
+                raise ValueError("included service '%s' is not defined" % service_id)
+            declaration, end, uuid = self.services[service_id]
+            return (declaration.handle.to_bytes(2, "little") + end.handle.to_bytes(2, "little")
+                    + (uuid if len(uuid) == 2 else b""))
+        return value
+
+    def hash_input(self, capabilities):
+        message = b""
+        for attribute in self.attributes:
+            if (self.capabilities and attribute.capabilities is not None
+                    and not attribute.capabilities & capabilities):
+                continue
+            message += hashed_bytes(attribute.handle, attribute.type, attribute.value)
+        return message
+
+    def database_hash(self, capabilities):
+        """Hash as read from the Database Hash characteristic, little endian"""
+        return aes_cmac(bytes(16), self.hash_input(capabilities))[::-1]
+
+################################################################################
+# Output
+################################################################################
+
+def capability_names(db, mask):
+    names = [name for bit, name in enumerate(db.capabilities) if mask & (1 << bit)]
+    return " | ".join(names) if names else "none"
+
+
+def render_header(name, db, profiles, source):
+    guard = os.path.splitext(os.path.basename(name))[0].upper() + "_H"
+    lines = ["/* Generated by tools/gatt_db_hash/gatt_db_hash.py from %s. Do not edit. */"
+             % os.path.basename(source),
+             "",
+             "#ifndef %s" % guard,
+             "#define %s" % guard,
+             "",
+             "// Capabilities enabled at boot by the GATT configuration",
+             "#define GATT_PROFILE_DEFAULT_CAPABILITIES  0x%04x" % db.default,
+             "",
+             "#define GATT_PROFILE_COUNT  %d" % len(profiles),
+             "",
+             "// { capabilities, Database Hash as read from the characteristic }",
+             "#define GATT_PROFILE_TABLE \\"]
+    for i, mask in enumerate(profiles):
+        digest = db.database_hash(mask)
+        lines.append("  /* %s */ \\" % capability_names(db, mask))
+        lines.append("  { 0x%04x, { %s } }%s"
+                     % (mask, ", ".join("0x%02x" % b for b in digest),
+                        ", \\" if i + 1 < len(profiles) else ""))
+    lines += ["", "#endif // %s" % guard]
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        prog="gatt_db_hash",
+        description="Compute the GATT Database Hash of every capability combination "
+                    "of a GATT configuration",
+    )
+    parser.add_argument("gatt", nargs="?", help="GATT configuration, .btconf or gatt.xml")
+    parser.add_argument("-o", "--output", help="C header to write the profile table to")
+    parser.add_argument("-p", "--profile", action="append", default=[],
+                        help="capability mask to list, e.g. 0x3; repeat for several "
+                             "(default: all combinations)")
+    parser.add_argument("-v", "--verbose", action="store_true",
+                        help="print the hashed bytes of each profile")
+    parser.add_argument("--check", action="store_true",
+                        help="do not write the header, fail if it differs from the one "
+                             "that would be written")
+    parser.add_argument("--self-test", action="store_true",
+                        help="check the tool against the FIPS-197, RFC 4493 and Core "
+                             "Specification examples, then exit")
+    args = parser.parse_args()
+
+    if args.self_test:
+        if not self_test():
+            sys.exit("self-test failed")
+        print("self-test passed")
+        return
+    if args.gatt is None:
+        parser.error("the GATT configuration is required")
+    if args.check and not args.output:
+        parser.error("--check needs the header to check, given with --output")
+
+    try:
+        db = GattDatabase(ET.parse(args.gatt).getroot())
+    except (ET.ParseError, ValueError, OSError) as e:
+        sys.exit("%s: %s" % (args.gatt, e))
+
+    if args.profile:
+        profiles = sorted({int(p, 0) for p in args.profile})
+        for mask in profiles:
+            if mask & ~db.all:
+                sys.exit("profile 0x%x enables undeclared capabilities" % mask)
+    elif len(db.capabilities) > MAX_ALL_COMBINATIONS:
+        sys.exit("%d capabilities, select the profiles with --profile" % len(db.capabilities))
+    else:
+        profiles = list(range(db.all + 1))
+
+    for mask in profiles:
+        print("0x%04x  %s  %s" % (mask, db.database_hash(mask).hex(), capability_names(db, mask)))
+        if args.verbose:
+            print("        " + db.hash_input(mask).hex())
+
+    if args.output:
+        header = render_header(args.output, db, profiles, args.gatt)
+        if args.check:
+            try:
+                with open(args.output, newline="") as f:
+                    current = f.read()
+            except OSError as e:
+                sys.exit("%s: %s" % (args.output, e))
+            if current != header:
+                sys.exit("%s is out of date, generate it again from %s"
+                         % (args.output, args.gatt))
+            print("%s is up to date" % args.output)
+        else:
+            with open(args.output, "w", newline="\n") as out:
+                out.write(header)
+
+
+if __name__ == "__main__":
+    main()